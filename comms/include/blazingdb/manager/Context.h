@@ -1,8 +1,10 @@
 #pragma once
 
+#include <memory>
 #include <vector>
 
 #include <vector>
+#include "blazingdb/manager/MemoryTracker.h"
 #include "blazingdb/transport/Node.h"
 
 namespace blazingdb {
@@ -48,6 +50,9 @@ public:
   int getNodeIndex(const Node& node) const;
   bool isMasterNode(const Node& node) const;
 
+  /// Memory accounting of the query, shared by every copy of this context
+  const std::shared_ptr<MemoryTracker>& getMemoryTracker() const;
+
 private:
   const uint32_t token_;
   uint32_t query_step;
@@ -55,6 +60,7 @@ private:
   const std::vector<std::shared_ptr<Node>> taskNodes_;
   const std::shared_ptr<Node> masterNode_;
   const std::string logicalPlan_;
+  std::shared_ptr<MemoryTracker> memoryTracker_;
 };
 
 }  // namespace manager
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace blazingdb {
+namespace manager {
+
+/// \brief Memory accounting of one query
+///
+/// Counts the bytes a query holds, in total and per operator, against an
+/// optional budget. The allocator reserves every allocation of the query here
+/// first, so a query that would go over its budget fails or spills instead of
+/// running the whole node out of memory.
+class MemoryTracker {
+public:
+  struct OperatorUsage {
+    std::size_t current;
+    std::size_t peak;
+    std::size_t total;  ///< every byte the operator allocated, freed or not
+  };
+
+  /// A budget of 0 means the query is not bounded
+  explicit MemoryTracker(std::size_t budget = 0);
+
+  /// Accounts size bytes to the operator, unless they would take the query
+  /// over its budget. Returns whether they were accounted.
+  bool tryReserve(std::size_t size, const std::string& operatorName);
+
+  /// Accounts size bytes that are already allocated, like columns adopted
+  /// from a library that does not allocate through the query, even past the
+  /// budget. The next reservation of the query is then refused.
+  void reserve(std::size_t size, const std::string& operatorName);
+
+  /// Gives back bytes reserved by tryReserve for the same operator
+  void release(std::size_t size, const std::string& operatorName);
+
+  /// Whether size more bytes fit in the budget right now, for operators that
+  /// can choose a path that uses less memory
+  bool fits(std::size_t size) const;
+
+  void setBudget(std::size_t budget);
+
+  std::size_t getBudget() const;
+  std::size_t getCurrent() const;
+  std::size_t getPeak() const;
+
+  std::map<std::string, OperatorUsage> getOperatorUsage() const;
+
+private:
+  void accountOperator(std::size_t size, std::size_t updated,
+                       const std::string& operatorName);
+
+  std::atomic<std::size_t> budget_;
+  std::atomic<std::size_t> current_;
+  std::atomic<std::size_t> peak_;
+
+  mutable std::mutex operatorsMutex_;
+  std::map<std::string, OperatorUsage> operators_;
+};
+
+}  // namespace manager
+}  // namespace blazingdb
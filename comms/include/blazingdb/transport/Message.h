@@ -16,10 +16,20 @@ namespace transport {
 /// instances and between the RAL's and the Orchestrator
 class Message {
 public:
+  /// Where the message is in the trace of its query, all zero when the query
+  /// is not traced. The times are microseconds since the epoch.
+  struct TraceMetaData {
+    uint64_t spanId{};          // of the send, set by the sender
+    int64_t receiveBeginUs{};   // set by the server that reads the message
+    int64_t receiveEndUs{};
+    uint64_t receivedBytes{};
+  };
+
   struct MetaData {
     char messageToken[128]{};  // use  uses '\0' for string ending
     uint32_t contextToken{};
     int32_t total_row_size{};  // used by SampleToNodeMasterMessage
+    TraceMetaData trace{};
 
     //    int32_t num_columns{}; // used by: writeBuffersFromGPUTCP,
     //    readBuffersIntoGPUTCP, update everywhere! int32_t num_buffers{};
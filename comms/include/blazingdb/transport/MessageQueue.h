@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <condition_variable>
 #include <mutex>
 #include <string>
@@ -26,9 +27,15 @@ public:
 public:
   std::shared_ptr<GPUMessage> getMessage(const std::string& messageToken);
 
+  /// Like getMessage, but gives up after timeout and returns nullptr
+  std::shared_ptr<GPUMessage> getMessage(const std::string& messageToken,
+                                         std::chrono::milliseconds timeout);
+
   void putMessage(std::shared_ptr<GPUMessage>& message);
 
 private:
+  bool hasMessage(const std::string& messageToken) const;
+
   std::shared_ptr<GPUMessage> getMessageQueue(const std::string& messageToken);
 
   void putMessageQueue(std::shared_ptr<GPUMessage>& message);
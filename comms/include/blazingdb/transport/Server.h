@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <functional>
 #include <map>
 #include <memory>
@@ -19,6 +20,11 @@ public:
       const Message::MetaData &, const Address::MetaData &,
       const std::vector<ColumnTransport> &, const std::vector<char *> &)>;
 
+  /**
+   * Called with the bytes of the column buffers of every message received.
+   */
+  using ReceiveCallback = std::function<void(std::size_t)>;
+
 public:
   virtual ~Server() = default;
 
@@ -91,6 +97,15 @@ public:
   virtual std::shared_ptr<GPUMessage> getMessage(
       const uint32_t context_token, const std::string &messageToken);
 
+  /**
+   * Like getMessage, but it gives up after timeout.
+   *
+   * @return               the message, or nullptr when none arrived in time.
+   */
+  virtual std::shared_ptr<GPUMessage> getMessage(
+      const uint32_t context_token, const std::string &messageToken,
+      std::chrono::milliseconds timeout);
+
   /**
    * It stores the message in the message queue and it uses the ContextToken to
    * select the queue. Each message queue works independently. Whether multiple
@@ -105,6 +120,19 @@ public:
   virtual void putMessage(const uint32_t context_token,
                           std::shared_ptr<GPUMessage> &message);
 
+  /**
+   * It sets the function called for every message received. It must be set
+   * before the server is started.
+   *
+   * @param callback  called with the bytes of the columns of the message.
+   */
+  void setReceiveCallback(ReceiveCallback callback);
+
+  /**
+   * It calls the receive callback, if any, with the bytes of a message.
+   */
+  void notifyReceived(std::size_t bytes) const;
+
   //
   Server::MakeCallback getDeserializationFunction(const std::string &endpoint);
 
@@ -131,6 +159,11 @@ protected:
    */
   std::map<std::string, MakeCallback> deserializer_;
 
+  /**
+   * It is called by the connection handlers, empty when nobody listens.
+   */
+  ReceiveCallback receive_callback_;
+
 public:
   /**
    * Static function that creates a TCP server.
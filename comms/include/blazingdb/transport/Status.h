@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <string>
 
 namespace blazingdb {
@@ -7,11 +8,17 @@ namespace transport {
 
 class Status {
 public:
-  Status(bool ok = false) : ok_{ok} {}
+  Status(bool ok = false, std::size_t bytes = 0) : ok_{ok}, bytes_{bytes} {}
   inline bool IsOk() const noexcept { return ok_; }
 
+  /**
+   * Bytes of the column buffers the message carried, 0 when it was not sent.
+   */
+  inline std::size_t Bytes() const noexcept { return bytes_; }
+
 private:
   bool ok_{false};
+  std::size_t bytes_{0};
 };
 
 }  // namespace transport
@@ -19,7 +19,8 @@ Context::Context(const uint32_t token,
       masterNode_{masterNode},
       logicalPlan_{logicalPlan},
       query_step{0},
-      query_substep{0} {}
+      query_substep{0},
+      memoryTracker_{std::make_shared<MemoryTracker>()} {}
 
 int Context::getTotalNodes() const { return taskNodes_.size(); }
 
@@ -81,5 +82,9 @@ bool Context::isMasterNode(const Node &node) const {
   return *masterNode_ == node;
 }
 
+const std::shared_ptr<MemoryTracker> &Context::getMemoryTracker() const {
+  return memoryTracker_;
+}
+
 }  // namespace manager
 }  // namespace blazingdb
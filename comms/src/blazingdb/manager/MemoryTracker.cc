@@ -0,0 +1,73 @@
+#include "blazingdb/manager/MemoryTracker.h"
+
+namespace blazingdb {
+namespace manager {
+
+MemoryTracker::MemoryTracker(std::size_t budget)
+    : budget_{budget}, current_{0}, peak_{0} {}
+
+bool MemoryTracker::tryReserve(std::size_t size,
+                               const std::string& operatorName) {
+  std::size_t current = current_.load();
+  std::size_t updated;
+  do {
+    updated = current + size;
+    const std::size_t budget = budget_.load();
+    if (budget != 0 && updated > budget) {
+      return false;
+    }
+  } while (!current_.compare_exchange_weak(current, updated));
+
+  accountOperator(size, updated, operatorName);
+  return true;
+}
+
+void MemoryTracker::reserve(std::size_t size,
+                            const std::string& operatorName) {
+  accountOperator(size, current_ += size, operatorName);
+}
+
+void MemoryTracker::accountOperator(std::size_t size, std::size_t updated,
+                                    const std::string& operatorName) {
+  std::size_t peak = peak_.load();
+  while (updated > peak && !peak_.compare_exchange_weak(peak, updated)) {
+  }
+
+  std::lock_guard<std::mutex> lock(operatorsMutex_);
+  OperatorUsage& usage = operators_[operatorName];
+  usage.current += size;
+  usage.total += size;
+  if (usage.current > usage.peak) {
+    usage.peak = usage.current;
+  }
+}
+
+void MemoryTracker::release(std::size_t size,
+                            const std::string& operatorName) {
+  current_ -= size;
+
+  std::lock_guard<std::mutex> lock(operatorsMutex_);
+  operators_[operatorName].current -= size;
+}
+
+bool MemoryTracker::fits(std::size_t size) const {
+  const std::size_t budget = budget_.load();
+  return budget == 0 || current_.load() + size <= budget;
+}
+
+void MemoryTracker::setBudget(std::size_t budget) { budget_ = budget; }
+
+std::size_t MemoryTracker::getBudget() const { return budget_; }
+
+std::size_t MemoryTracker::getCurrent() const { return current_; }
+
+std::size_t MemoryTracker::getPeak() const { return peak_; }
+
+std::map<std::string, MemoryTracker::OperatorUsage>
+MemoryTracker::getOperatorUsage() const {
+  std::lock_guard<std::mutex> lock(operatorsMutex_);
+  return operators_;
+}
+
+}  // namespace manager
+}  // namespace blazingdb
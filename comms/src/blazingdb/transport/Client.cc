@@ -93,7 +93,8 @@ public:
     std::string end_message(static_cast<char*>(local_message.data()),
                             local_message.size());
     assert(end_message == "END");
-    return Status{true};
+    return Status{true, std::accumulate(buffer_sizes.begin(),
+                                        buffer_sizes.end(), std::size_t{0})};
   }
 
 protected:
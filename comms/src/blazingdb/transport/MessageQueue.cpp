@@ -8,12 +8,19 @@ namespace transport {
 std::shared_ptr<GPUMessage> MessageQueue::getMessage(
     const std::string &messageToken) {
   std::unique_lock<std::mutex> lock(mutex_);
-  condition_variable_.wait(lock, [&, this] {
-    return std::any_of(this->message_queue_.cbegin(),
-                       this->message_queue_.cend(), [&](const auto &e) {
-                         return e->getMessageTokenValue() == messageToken;
-                       });
-  });
+  condition_variable_.wait(lock,
+                           [&, this] { return hasMessage(messageToken); });
+
+  return getMessageQueue(messageToken);
+}
+
+std::shared_ptr<GPUMessage> MessageQueue::getMessage(
+    const std::string &messageToken, std::chrono::milliseconds timeout) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (!condition_variable_.wait_for(
+          lock, timeout, [&, this] { return hasMessage(messageToken); })) {
+    return nullptr;
+  }
 
   return getMessageQueue(messageToken);
 }
@@ -22,7 +29,15 @@ void MessageQueue::putMessage(std::shared_ptr<GPUMessage> &message) {
   std::unique_lock<std::mutex> lock(mutex_);
   putMessageQueue(message);
   lock.unlock();
-  condition_variable_.notify_one();
+  // the threads waiting may wait for different messages, every one checks
+  condition_variable_.notify_all();
+}
+
+bool MessageQueue::hasMessage(const std::string &messageToken) const {
+  return std::any_of(message_queue_.cbegin(), message_queue_.cend(),
+                     [&](const auto &e) {
+                       return e->getMessageTokenValue() == messageToken;
+                     });
 }
 
 std::shared_ptr<GPUMessage> MessageQueue::getMessageQueue(
@@ -4,6 +4,7 @@
 #include "blazingdb/transport/io/reader_writer.h"
 
 #include <cuda_runtime_api.h>
+#include <chrono>
 #include <condition_variable>
 #include <deque>
 #include <map>
@@ -51,6 +52,14 @@ std::shared_ptr<GPUMessage> Server::getMessage(
   return message_queue.getMessage(messageToken);
 }
 
+std::shared_ptr<GPUMessage> Server::getMessage(
+    const uint32_t context_token, const std::string &messageToken,
+    std::chrono::milliseconds timeout) {
+  std::shared_lock<std::shared_timed_mutex> lock(context_messages_mutex_);
+  MessageQueue &message_queue = context_messages_map_.at(context_token);
+  return message_queue.getMessage(messageToken, timeout);
+}
+
 void Server::putMessage(const uint32_t context_token,
                         std::shared_ptr<GPUMessage> &message) {
   std::shared_lock<std::shared_timed_mutex> lock(context_messages_mutex_);
@@ -84,6 +93,16 @@ MetadataType read_metadata(void *fd) {
   return metadata;
 }
 
+void Server::setReceiveCallback(ReceiveCallback callback) {
+  receive_callback_ = std::move(callback);
+}
+
+void Server::notifyReceived(std::size_t bytes) const {
+  if (receive_callback_) {
+    receive_callback_(bytes);
+  }
+}
+
 namespace {
 
 class ServerTCP : public Server {
@@ -109,6 +128,12 @@ private:
   int gpuId{0};
 };
 
+int64_t nowMicroseconds() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
 void connectionHandler(ServerTCP *server, void *socket, int gpuId) {
   try {
     // use io reader to read the message
@@ -121,6 +146,7 @@ void connectionHandler(ServerTCP *server, void *socket, int gpuId) {
         read_metadata<Message::MetaData>(socket);
     Address::MetaData address_metadata =
         read_metadata<Address::MetaData>(socket);
+    message_metadata.trace.receiveBeginUs = nowMicroseconds();
 
     // read columns (gpu buffers)
     auto column_offset_size = read_metadata<int32_t>(socket);
@@ -137,6 +163,10 @@ void connectionHandler(ServerTCP *server, void *socket, int gpuId) {
     std::vector<char *> raw_columns;
     raw_columns = blazingdb::transport::io::readBuffersIntoGPUTCP(
         buffer_sizes, socket, gpuId);
+    message_metadata.trace.receiveEndUs = nowMicroseconds();
+    message_metadata.trace.receivedBytes = std::accumulate(
+        buffer_sizes.begin(), buffer_sizes.end(), std::size_t{0});
+    server->notifyReceived(message_metadata.trace.receivedBytes);
     zmq::socket_t *socket_ptr = (zmq::socket_t *)socket;
 
     int data_past_topic{0};
@@ -166,6 +196,7 @@ void connectionHandler(ServerTCP *server, void *socket, int gpuId) {
     std::shared_ptr<GPUMessage> message = deserialize_function(
         message_metadata, address_metadata, column_offsets, raw_columns);
     assert(message != nullptr);
+    message->metadata().trace = message_metadata.trace;
     server->putMessage(message->metadata().contextToken, message);
 
     // TODO: write success
@@ -0,0 +1,88 @@
+#include <blazingdb/manager/Context.h>
+#include <blazingdb/manager/MemoryTracker.h>
+
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+namespace blazingdb {
+namespace manager {
+
+TEST(TestMemoryTracker, CountsPerOperator) {
+  MemoryTracker tracker;
+
+  EXPECT_TRUE(tracker.tryReserve(100, "scan"));
+  EXPECT_TRUE(tracker.tryReserve(50, "join"));
+  tracker.release(100, "scan");
+  EXPECT_TRUE(tracker.tryReserve(30, "join"));
+
+  EXPECT_EQ(tracker.getCurrent(), 80);
+  EXPECT_EQ(tracker.getPeak(), 150);
+
+  auto usage = tracker.getOperatorUsage();
+  EXPECT_EQ(usage["scan"].current, 0);
+  EXPECT_EQ(usage["scan"].peak, 100);
+  EXPECT_EQ(usage["join"].current, 80);
+  EXPECT_EQ(usage["join"].total, 80);
+}
+
+TEST(TestMemoryTracker, RefusesWhatGoesOverTheBudget) {
+  MemoryTracker tracker(1000);
+
+  EXPECT_TRUE(tracker.tryReserve(600, "scan"));
+  EXPECT_FALSE(tracker.fits(500));
+  EXPECT_FALSE(tracker.tryReserve(500, "join"));
+  EXPECT_EQ(tracker.getCurrent(), 600);
+  EXPECT_EQ(tracker.getOperatorUsage().count("join"), 0);
+
+  tracker.release(600, "scan");
+  EXPECT_TRUE(tracker.tryReserve(1000, "join"));
+}
+
+TEST(TestMemoryTracker, AdoptedMemoryGoesPastTheBudget) {
+  MemoryTracker tracker(1000);
+
+  EXPECT_TRUE(tracker.tryReserve(600, "scan"));
+  tracker.reserve(600, "scan");
+  EXPECT_EQ(tracker.getCurrent(), 1200);
+  EXPECT_EQ(tracker.getPeak(), 1200);
+  EXPECT_EQ(tracker.getOperatorUsage()["scan"].current, 1200);
+  EXPECT_FALSE(tracker.tryReserve(1, "join"));
+
+  tracker.release(1200, "scan");
+  EXPECT_TRUE(tracker.tryReserve(1000, "join"));
+}
+
+TEST(TestMemoryTracker, ConcurrentReservationsStayWithinTheBudget) {
+  MemoryTracker tracker(64 * 1000);
+
+  std::vector<std::thread> threads;
+  for (int thread = 0; thread < 8; thread++) {
+    threads.emplace_back([&tracker, thread]() {
+      const std::string name = "operator " + std::to_string(thread % 2);
+      for (int i = 0; i < 10000; i++) {
+        if (tracker.tryReserve(1000, name)) {
+          EXPECT_LE(tracker.getCurrent(), tracker.getBudget());
+          tracker.release(1000, name);
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(tracker.getCurrent(), 0);
+  EXPECT_LE(tracker.getPeak(), tracker.getBudget());
+}
+
+TEST(TestMemoryTracker, CopiesOfAContextShareTheTracker) {
+  Context context{1, {}, nullptr, ""};
+  Context copy = context;
+
+  copy.getMemoryTracker()->tryReserve(10, "scan");
+  EXPECT_EQ(context.getMemoryTracker()->getCurrent(), 10);
+}
+
+}  // namespace manager
+}  // namespace blazingdb
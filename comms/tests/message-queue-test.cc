@@ -0,0 +1,74 @@
+#include <blazingdb/transport/MessageQueue.h>
+
+#include <gtest/gtest.h>
+#include <thread>
+
+namespace blazingdb {
+namespace transport {
+
+class TestMessage : public GPUMessage {
+public:
+  TestMessage(const std::string &messageToken,
+              std::shared_ptr<Node> &sender_node)
+      : GPUMessage{messageToken, 0, sender_node} {}
+
+  raw_buffer GetRawColumns() override { return raw_buffer{}; }
+};
+
+std::shared_ptr<GPUMessage> makeMessage(const std::string &messageToken) {
+  std::shared_ptr<Node> node = Node::Make(Address::TCP("1.2.3.4", 9999, 1234));
+  return std::make_shared<TestMessage>(messageToken, node);
+}
+
+TEST(MessageQueueTest, GivesUpAfterTheTimeout) {
+  MessageQueue queue;
+  std::shared_ptr<GPUMessage> other = makeMessage("other");
+  queue.putMessage(other);
+
+  auto start = std::chrono::steady_clock::now();
+  EXPECT_EQ(queue.getMessage("trace", std::chrono::milliseconds(50)),
+            nullptr);
+  EXPECT_GE(std::chrono::steady_clock::now() - start,
+            std::chrono::milliseconds(50));
+  EXPECT_EQ(queue.getMessage("other", std::chrono::milliseconds(0)), other);
+}
+
+TEST(MessageQueueTest, MessageArrivingInTimeIsReturned) {
+  MessageQueue queue;
+  std::shared_ptr<GPUMessage> message = makeMessage("trace");
+  std::thread sender([&queue, message]() mutable {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    queue.putMessage(message);
+  });
+
+  EXPECT_EQ(queue.getMessage("trace", std::chrono::seconds(10)), message);
+  sender.join();
+}
+
+// every thread waiting is woken up, not only one that waits for another
+// message
+TEST(MessageQueueTest, WaitersForDifferentMessagesAllGetTheirs) {
+  MessageQueue queue;
+  std::shared_ptr<GPUMessage> first;
+  std::shared_ptr<GPUMessage> second;
+  std::thread first_waiter([&queue, &first]() {
+    first = queue.getMessage("first", std::chrono::seconds(10));
+  });
+  std::thread second_waiter([&queue, &second]() {
+    second = queue.getMessage("second", std::chrono::seconds(10));
+  });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  std::shared_ptr<GPUMessage> second_message = makeMessage("second");
+  queue.putMessage(second_message);
+  std::shared_ptr<GPUMessage> first_message = makeMessage("first");
+  queue.putMessage(first_message);
+  first_waiter.join();
+  second_waiter.join();
+
+  EXPECT_EQ(first, first_message);
+  EXPECT_EQ(second, second_message);
+}
+
+}  // namespace transport
+}  // namespace blazingdb
@@ -0,0 +1,56 @@
+#include "GDFColumn.cuh"
+#include <benchmark/benchmark.h>
+#include <vector>
+
+static const int COLUMNS_PER_TABLE = 16;
+
+// Columns allocated on the host without data so only the reference counting is measured, freeing one just deletes
+// the gdf_column.
+static std::vector<gdf_column_cpp> host_table() {
+	std::vector<gdf_column_cpp> table(COLUMNS_PER_TABLE);
+	for(gdf_column_cpp & column : table) {
+		gdf_column * host_column = new gdf_column{};
+		host_column->dtype = GDF_INT64;
+		host_column->size = 1000;
+		column.create_gdf_column(host_column);
+	}
+	return table;
+}
+
+// Every thread copies the columns of its own table around, like concurrent queries passing frames between operators
+static void BM_copy_own_tables(benchmark::State & state) {
+	std::vector<gdf_column_cpp> table = host_table();
+	for(auto _ : state) {
+		std::vector<gdf_column_cpp> copy = table;
+		benchmark::DoNotOptimize(copy.data());
+	}
+	state.SetItemsProcessed(state.iterations() * COLUMNS_PER_TABLE);
+}
+BENCHMARK(BM_copy_own_tables)->ThreadRange(1, 16)->UseRealTime();
+
+// Every thread copies the columns of the same table, like the partitions of one query
+static void BM_copy_shared_table(benchmark::State & state) {
+	static std::vector<gdf_column_cpp> table;
+	if(state.thread_index == 0) {
+		table = host_table();
+	}
+	for(auto _ : state) {
+		std::vector<gdf_column_cpp> copy = table;
+		benchmark::DoNotOptimize(copy.data());
+	}
+	state.SetItemsProcessed(state.iterations() * COLUMNS_PER_TABLE);
+	if(state.thread_index == 0) {
+		table.clear();
+	}
+}
+BENCHMARK(BM_copy_shared_table)->ThreadRange(1, 16)->UseRealTime();
+
+// Columns created and dropped by every thread, this still goes through the registry
+static void BM_create_and_drop_tables(benchmark::State & state) {
+	for(auto _ : state) {
+		std::vector<gdf_column_cpp> table = host_table();
+		benchmark::DoNotOptimize(table.data());
+	}
+	state.SetItemsProcessed(state.iterations() * COLUMNS_PER_TABLE);
+}
+BENCHMARK(BM_create_and_drop_tables)->ThreadRange(1, 16)->UseRealTime();
@@ -0,0 +1,131 @@
+#include "io/data_parser/CSVByteRanges.h"
+#include "io/data_parser/RowGroupDecoder.h"
+#include <arrow/io/file.h>
+#include <benchmark/benchmark.h>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+static const int NUM_ROWS = 2000000;
+static const int DECODE_THREADS = 8;
+
+// a single csv of about 100MB where one row in four has a quoted field with a line terminator in it
+static const std::string & test_file() {
+	static std::string path;
+	if(path.empty()) {
+		path = "/tmp/csv_byte_ranges_benchmark.csv";
+		std::ofstream file(path, std::ios::binary);
+		file << "id,comment,value\n";
+		for(int row = 0; row < NUM_ROWS; row++) {
+			if(row % 4 == 1) {
+				file << row << ",\"first line\nsecond, \"\"quoted\"\" line\"," << row % 1000 << "\n";
+			} else {
+				file << row << ",plain comment of a row," << row % 1000 << "\n";
+			}
+		}
+		std::atexit([]() { std::remove(path.c_str()); });
+	}
+	return path;
+}
+
+static std::shared_ptr<arrow::io::RandomAccessFile> open_test_file() {
+	std::shared_ptr<arrow::io::ReadableFile> file;
+	arrow::io::ReadableFile::Open(test_file(), &file);
+	return file;
+}
+
+// host stand-in for the GPU parse of a range: reads it and sums the last field of every row
+static int64_t parse_on_host(const std::shared_ptr<arrow::io::RandomAccessFile> & file,
+	const ral::io::csv_byte_range & range) {
+	std::vector<char> buffer(range.end - range.start);
+	int64_t bytes_read = 0;
+	file->ReadAt(range.start, buffer.size(), &bytes_read, buffer.data());
+
+	int64_t sum = 0;
+	int64_t field = 0;
+	bool quoted = false;
+	for(char c : buffer) {
+		if(c == '"') {
+			quoted = !quoted;
+		} else if(quoted) {
+			continue;
+		} else if(c == ',') {
+			field = 0;
+		} else if(c == '\n') {
+			sum += field;
+			field = 0;
+		} else if(c >= '0' && c <= '9') {
+			field = field * 10 + (c - '0');
+		}
+	}
+	return sum;
+}
+
+static void count_rows(benchmark::State & state) {
+	state.SetItemsProcessed(state.iterations() * int64_t(NUM_ROWS));
+}
+
+// arg 0: number of ranges the file is split in, 1 is the whole file parsed as a unit
+static void BM_parse_ranges(benchmark::State & state) {
+	std::shared_ptr<arrow::io::RandomAccessFile> file = open_test_file();
+	int64_t file_size;
+	file->GetSize(&file_size);
+	const int64_t range_size = (file_size + state.range(0) - 1) / state.range(0);
+	ThreadPool decode_pool(DECODE_THREADS);
+
+	for(auto _ : state) {
+		const int num_ranges = ral::io::get_num_csv_byte_ranges(file_size, range_size);
+		std::vector<ral::io::csv_byte_range> ranges = ral::io::get_csv_byte_ranges(
+			file, range_size, ral::io::get_row_groups_to_decode({}, num_ranges), {}, decode_pool);
+		std::vector<int> range_indices(ranges.size());
+		for(size_t i = 0; i < ranges.size(); i++) {
+			range_indices[i] = i;
+		}
+		auto sums = ral::io::decode_row_groups(
+			range_indices, [&](int range_index) { return parse_on_host(file, ranges[range_index]); }, decode_pool);
+		benchmark::DoNotOptimize(sums);
+	}
+	count_rows(state);
+}
+BENCHMARK(BM_parse_ranges)
+	->Arg(1)
+	->Arg(2)
+	->Arg(4)
+	->Arg(8)
+	->Arg(16)
+	->Arg(64)
+	->Unit(benchmark::kMillisecond)
+	->UseRealTime();
+
+// arg 0: number of ranges, only the cost of finding where their rows start
+static void BM_find_ranges(benchmark::State & state) {
+	std::shared_ptr<arrow::io::RandomAccessFile> file = open_test_file();
+	int64_t file_size;
+	file->GetSize(&file_size);
+	const int64_t range_size = (file_size + state.range(0) - 1) / state.range(0);
+	ThreadPool decode_pool(DECODE_THREADS);
+
+	for(auto _ : state) {
+		const int num_ranges = ral::io::get_num_csv_byte_ranges(file_size, range_size);
+		benchmark::DoNotOptimize(ral::io::get_csv_byte_ranges(
+			file, range_size, ral::io::get_row_groups_to_decode({}, num_ranges), {}, decode_pool));
+	}
+	count_rows(state);
+}
+BENCHMARK(BM_find_ranges)->Arg(8)->Arg(64)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// arg 0: number of ranges, only the last one is found as a node given the end of the file would
+static void BM_find_last_range(benchmark::State & state) {
+	std::shared_ptr<arrow::io::RandomAccessFile> file = open_test_file();
+	int64_t file_size;
+	file->GetSize(&file_size);
+	const int64_t range_size = (file_size + state.range(0) - 1) / state.range(0);
+	ThreadPool decode_pool(DECODE_THREADS);
+
+	for(auto _ : state) {
+		const int num_ranges = ral::io::get_num_csv_byte_ranges(file_size, range_size);
+		benchmark::DoNotOptimize(ral::io::get_csv_byte_ranges(file, range_size, {num_ranges - 1}, {}, decode_pool));
+	}
+}
+BENCHMARK(BM_find_last_range)->Arg(8)->Arg(64)->Unit(benchmark::kMillisecond)->UseRealTime();
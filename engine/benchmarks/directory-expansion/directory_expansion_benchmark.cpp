@@ -0,0 +1,63 @@
+#include "io/data_provider/DirectoryExpander.h"
+#include <benchmark/benchmark.h>
+#include <cstdlib>
+#include <fstream>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// A hive layout of 10 years, 10 months and 100 days, 10k leaf partitions with one small file each
+static const std::string & test_table() {
+	static std::string root;
+	if(root.empty()) {
+		char name[] = "/tmp/directory_expansion_benchmarkXXXXXX";
+		root = mkdtemp(name);
+
+		for(int year = 0; year < 10; year++) {
+			const std::string year_directory = root + "/year=" + std::to_string(2010 + year);
+			mkdir(year_directory.c_str(), 0700);
+			for(int month = 0; month < 10; month++) {
+				const std::string month_directory = year_directory + "/month=" + std::to_string(month);
+				mkdir(month_directory.c_str(), 0700);
+				for(int day = 0; day < 100; day++) {
+					const std::string day_directory = month_directory + "/day=" + std::to_string(day);
+					mkdir(day_directory.c_str(), 0700);
+					std::ofstream(day_directory + "/part-0.parquet") << day;
+				}
+			}
+		}
+		std::atexit([]() { std::system(("rm -rf " + root).c_str()); });
+	}
+	return root;
+}
+
+// arg 0: listings in flight, 1 lists one directory at a time
+static void BM_expand_partitions(benchmark::State & state) {
+	const Uri uri{test_table() + "/"};
+	auto io_pool = std::make_shared<ThreadPool>(state.range(0));
+	ral::io::directory_expansion_options options;
+	options.max_listings_in_flight = state.range(0);
+
+	size_t num_files = 0;
+	for(auto _ : state) {
+		num_files = ral::io::directory_expander::expand(uri, io_pool, options).size();
+	}
+	state.counters["files"] = num_files;
+	state.SetItemsProcessed(state.iterations() * num_files);
+}
+BENCHMARK(BM_expand_partitions)->Arg(1)->Arg(4)->Arg(16)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// How long the loader waits before it can start opening and parsing files
+static void BM_first_file(benchmark::State & state) {
+	const Uri uri{test_table() + "/"};
+	auto io_pool = std::make_shared<ThreadPool>(state.range(0));
+	ral::io::directory_expansion_options options;
+	options.max_listings_in_flight = state.range(0);
+
+	for(auto _ : state) {
+		ral::io::directory_expander expander(uri, io_pool, options);
+		std::vector<ral::io::expanded_file> files;
+		expander.next(files, true);
+		benchmark::DoNotOptimize(files);
+	}
+}
+BENCHMARK(BM_first_file)->Arg(1)->Arg(16)->Unit(benchmark::kMicrosecond)->UseRealTime();
@@ -0,0 +1,131 @@
+#include "Config/BlazingContext.h"
+#include "io/data_parser/ParquetFooterCache.h"
+#include <arrow/io/file.h>
+#include <benchmark/benchmark.h>
+#include <cstdlib>
+#include <map>
+#include <parquet/api/reader.h>
+#include <parquet/api/writer.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+static const int ROW_GROUPS_PER_FILE = 4;
+
+// A table of many small local parquet files, like the output of a job with many tasks. Every file stays open like
+// in a registration, so the tables are kept under the usual limit of 1024 open files.
+static const std::vector<std::string> & test_files(int num_files) {
+	static std::map<int, std::vector<std::string>> files_per_table;
+	std::vector<std::string> & files = files_per_table[num_files];
+	if(files.empty()) {
+		char name[] = "/tmp/footer_cache_benchmarkXXXXXX";
+		const std::string directory = mkdtemp(name);
+
+		auto schema = std::static_pointer_cast<parquet::schema::GroupNode>(parquet::schema::GroupNode::Make("schema",
+			parquet::Repetition::REQUIRED,
+			parquet::schema::NodeVector{
+				parquet::schema::PrimitiveNode::Make(
+					"key", parquet::Repetition::REQUIRED, parquet::Type::INT64, parquet::ConvertedType::NONE),
+				parquet::schema::PrimitiveNode::Make(
+					"value", parquet::Repetition::REQUIRED, parquet::Type::DOUBLE, parquet::ConvertedType::NONE)}));
+
+		for(int file_index = 0; file_index < num_files; file_index++) {
+			files.push_back(directory + "/part_" + std::to_string(file_index) + ".parquet");
+			std::shared_ptr<arrow::io::FileOutputStream> stream;
+			PARQUET_THROW_NOT_OK(arrow::io::FileOutputStream::Open(files.back(), &stream));
+			std::shared_ptr<parquet::ParquetFileWriter> file_writer =
+				parquet::ParquetFileWriter::Open(stream, schema, parquet::WriterProperties::Builder().build());
+
+			for(int row_group = 0; row_group < ROW_GROUPS_PER_FILE; row_group++) {
+				parquet::RowGroupWriter * row_group_writer = file_writer->AppendRowGroup(100);
+				auto * key_writer = static_cast<parquet::Int64Writer *>(row_group_writer->NextColumn());
+				for(int64_t row = 0; row < 100; row++) {
+					key_writer->WriteBatch(1, nullptr, nullptr, &row);
+				}
+				auto * value_writer = static_cast<parquet::DoubleWriter *>(row_group_writer->NextColumn());
+				for(int row = 0; row < 100; row++) {
+					double value = row * 0.5;
+					value_writer->WriteBatch(1, nullptr, nullptr, &value);
+				}
+			}
+			file_writer->Close();
+			PARQUET_THROW_NOT_OK(stream->Close());
+		}
+		std::atexit([]() {
+			for(auto & table : files_per_table) {
+				for(const std::string & file : table.second) {
+					std::remove(file.c_str());
+				}
+			}
+		});
+	}
+	return files;
+}
+
+static std::vector<std::shared_ptr<arrow::io::RandomAccessFile>> open_all(const std::vector<std::string> & paths) {
+	std::vector<std::shared_ptr<arrow::io::RandomAccessFile>> files;
+	for(const std::string & path : paths) {
+		files.push_back(BlazingContext::getInstance()->getFileSystemManager()->openReadable(Uri{path}));
+	}
+	return files;
+}
+
+// What registering a table did: a thread per file to count the row groups for the schema, then another thread per
+// file reading the footers again for the skip-data metadata
+static void BM_register_thread_per_file(benchmark::State & state) {
+	const std::vector<std::string> & paths = test_files(state.range(0));
+	const auto files = open_all(paths);
+
+	for(auto _ : state) {
+		for(int pass = 0; pass < 2; pass++) {
+			std::vector<size_t> num_row_groups(files.size());
+			std::vector<std::thread> threads;
+			for(size_t file_index = 0; file_index < files.size(); file_index++) {
+				threads.emplace_back([&, file_index]() {
+					std::unique_ptr<parquet::ParquetFileReader> parquet_reader =
+						parquet::ParquetFileReader::Open(files[file_index]);
+					num_row_groups[file_index] = parquet_reader->metadata()->num_row_groups();
+					parquet_reader->Close();
+				});
+			}
+			for(auto & thread : threads) {
+				thread.join();
+			}
+			benchmark::DoNotOptimize(num_row_groups);
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * paths.size());
+}
+BENCHMARK(BM_register_thread_per_file)->Arg(100)->Arg(900)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// One pass on a bounded pool for the schema, the metadata pass is served from the cache
+static void BM_register_footer_cache(benchmark::State & state) {
+	const std::vector<std::string> & paths = test_files(state.range(0));
+	const auto files = open_all(paths);
+	ThreadPool io_pool(16);
+	ral::io::parquet_footer_cache cache;
+
+	for(auto _ : state) {
+		cache.clear();
+		for(int pass = 0; pass < 2; pass++) {
+			benchmark::DoNotOptimize(cache.get_footers(paths, files, io_pool));
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * paths.size());
+}
+BENCHMARK(BM_register_footer_cache)->Arg(100)->Arg(900)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// Registering the same files again, e.g. after the table is dropped and created with other options
+static void BM_register_again_footer_cache(benchmark::State & state) {
+	const std::vector<std::string> & paths = test_files(state.range(0));
+	const auto files = open_all(paths);
+	ThreadPool io_pool(16);
+	ral::io::parquet_footer_cache cache;
+	cache.get_footers(paths, files, io_pool);
+
+	for(auto _ : state) {
+		benchmark::DoNotOptimize(cache.get_footers(paths, files, io_pool));
+	}
+	state.SetItemsProcessed(state.iterations() * paths.size());
+}
+BENCHMARK(BM_register_again_footer_cache)->Arg(100)->Arg(900)->Unit(benchmark::kMillisecond)->UseRealTime();
@@ -0,0 +1,118 @@
+#include "CalciteExpressionParsing.h"
+#include "utilities/InList.h"
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+// WHERE $0 IN (...) the way Calcite hands it out, OR(=($0, lit1), =($0, lit2), ...)
+static std::string make_in_list_expression(const std::vector<int64_t> & literals) {
+	std::string expression = "OR(";
+	for(size_t i = 0; i < literals.size(); i++) {
+		expression += (i > 0 ? ", =($0, " : "=($0, ") + std::to_string(literals[i]) + ")";
+	}
+	return expression + ")";
+}
+
+static std::vector<int64_t> generate_values(size_t num_values, int64_t max_value) {
+	std::vector<int64_t> values(num_values);
+	for(auto & value : values) {
+		value = std::rand() % max_value;
+	}
+	return values;
+}
+
+static void PlanArguments(benchmark::internal::Benchmark * b) {
+	for(int64_t num_literals = 10; num_literals <= 10000; num_literals *= 10)
+		b->Args({num_literals});
+}
+
+static void ExecutionArguments(benchmark::internal::Benchmark * b) {
+	for(int64_t num_literals = 10; num_literals <= 10000; num_literals *= 10)
+		b->Args({num_literals, 1 << 16});
+}
+
+// What planning an IN list did: expand the OR chain, tokenize it and parse every literal into a scalar
+static void BM_in_list_plan_or_chain(benchmark::State & state) {
+	std::srand(42);
+	std::string expression = make_in_list_expression(generate_values(state.range(0), 1 << 20));
+
+	for(auto _ : state) {
+		std::vector<std::string> tokens = get_tokens_in_reverse_order(clean_calcite_expression(expression));
+		size_t num_scalars = 0;
+		for(const std::string & token : tokens) {
+			if(!is_operator_token(token) && is_literal(token)) {
+				gdf_scalar scalar = get_scalar_from_string(token, get_type_from_string(token), gdf_dtype_extra_info{});
+				num_scalars += scalar.is_valid;
+			}
+		}
+		benchmark::DoNotOptimize(num_scalars);
+	}
+
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_in_list_plan_or_chain)->Apply(PlanArguments)->Unit(benchmark::kMicrosecond);
+
+// Rewriting the list into one membership lookup and parsing its literals once into a sorted array
+static void BM_in_list_plan_rewrite(benchmark::State & state) {
+	std::srand(42);
+	std::string expression = make_in_list_expression(generate_values(state.range(0), 1 << 20));
+
+	for(auto _ : state) {
+		std::vector<int64_t> values;
+		std::string rewritten = ral::utilities::rewrite_in_lists(expression, [&values](const ral::utilities::in_list & list) {
+			return ral::utilities::parse_in_list_values(list.literals, values) ? std::string("$1") : std::string();
+		});
+		benchmark::DoNotOptimize(rewritten.data());
+		benchmark::DoNotOptimize(values.data());
+	}
+
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_in_list_plan_rewrite)->Apply(PlanArguments)->Unit(benchmark::kMicrosecond);
+
+// Host replay of the interpreter evaluating the OR chain, one comparison per literal for every row
+static void BM_in_list_execute_or_chain(benchmark::State & state) {
+	std::srand(42);
+	std::vector<int64_t> literals = generate_values(state.range(0), 1 << 20);
+	std::vector<int64_t> column = generate_values(state.range(1), 1 << 20);
+	std::vector<char> results(column.size());
+
+	for(auto _ : state) {
+		for(size_t row = 0; row < column.size(); row++) {
+			bool found = false;
+			for(int64_t literal : literals) {
+				found = found || column[row] == literal;
+			}
+			results[row] = found;
+		}
+		benchmark::DoNotOptimize(results.data());
+	}
+
+	state.SetItemsProcessed(state.iterations() * column.size());
+}
+BENCHMARK(BM_in_list_execute_or_chain)->Apply(ExecutionArguments)->Unit(benchmark::kMicrosecond);
+
+// The membership lookup of evaluate_in_list, a binary search over the sorted literals for every row
+static void BM_in_list_execute_sorted(benchmark::State & state) {
+	std::srand(42);
+	std::vector<int64_t> values;
+	std::vector<std::string> literals;
+	for(int64_t literal : generate_values(state.range(0), 1 << 20)) {
+		literals.push_back(std::to_string(literal));
+	}
+	ral::utilities::parse_in_list_values(literals, values);
+	std::vector<int64_t> column = generate_values(state.range(1), 1 << 20);
+	std::vector<char> results(column.size());
+
+	for(auto _ : state) {
+		for(size_t row = 0; row < column.size(); row++) {
+			results[row] = std::binary_search(values.begin(), values.end(), column[row]);
+		}
+		benchmark::DoNotOptimize(results.data());
+	}
+
+	state.SetItemsProcessed(state.iterations() * column.size());
+}
+BENCHMARK(BM_in_list_execute_sorted)->Apply(ExecutionArguments)->Unit(benchmark::kMicrosecond);
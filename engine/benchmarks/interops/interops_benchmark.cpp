@@ -92,17 +92,7 @@ BENCHMARK_TEMPLATE_DEFINE_F(InterOpsBench, SimpleBench, 4)
 			break;
 		}
 
-		perform_operation(params.output_columns,
-			params.input_columns,
-			params.left_inputs,
-			params.right_inputs,
-			params.outputs,
-			params.final_output_positions,
-			params.operators,
-			params.unary_operators,
-			params.left_scalars,
-			params.right_scalars,
-			params.new_column_indices);
+		perform_project_plan(params);
 
 		bz_out.clear();
 		bz_out.add_table(params.columns);
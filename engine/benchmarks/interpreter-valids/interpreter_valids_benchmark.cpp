@@ -0,0 +1,128 @@
+#include "Interpreter/interpreter_valids.h"
+#include <benchmark/benchmark.h>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// Host replay of the validity handling of the interpreter kernel over 64 row blocks. A plan adds up all the
+// inputs, so there are num_inputs - 1 operations and the last one writes the only output.
+struct valids_plan {
+	int num_inputs;
+	std::vector<column_index_type> left_inputs;
+	std::vector<column_index_type> right_inputs;
+	std::vector<column_index_type> outputs;
+	std::vector<gdf_binary_operator_exp> operators;
+	std::vector<gdf_unary_operator> unary_operators;
+	column_index_type final_output_position;
+	std::vector<std::vector<int64_t>> input_valids;
+
+	valids_plan(int num_inputs, size_t num_rows) : num_inputs{num_inputs} {
+		column_index_type output_position = num_inputs;
+		column_index_type temp_position = num_inputs + 1;
+		column_index_type previous = 0;
+		for(int input = 1; input < num_inputs; input++) {
+			column_index_type output = input == num_inputs - 1 ? output_position : temp_position;
+			left_inputs.push_back(previous);
+			right_inputs.push_back(input);
+			outputs.push_back(output);
+			operators.push_back(BLZ_ADD);
+			unary_operators.push_back(BLZ_INVALID_UNARY);
+			previous = output;
+		}
+		final_output_position = output_position;
+
+		std::srand(42);
+		size_t num_words = (num_rows + 63) / 64;
+		input_valids.resize(num_inputs, std::vector<int64_t>(num_words));
+		for(auto & valids : input_valids) {
+			for(auto & word : valids) {
+				word = ~(static_cast<int64_t>(1) << (std::rand() % 64));
+			}
+		}
+	}
+};
+
+static void CustomArguments(benchmark::internal::Benchmark * b) {
+	for(int64_t num_inputs = 2; num_inputs <= 16; num_inputs *= 2)
+		for(int64_t num_rows = 1 << 16; num_rows <= 1 << 22; num_rows *= 8)
+			b->Args({num_inputs, num_rows});
+}
+
+static inline bool get_bit(int64_t word, int bit) { return (word >> bit) & 1; }
+
+static inline void set_bit(int64_t & word, int bit, bool value) {
+	word ^= ((-static_cast<int64_t>(value)) ^ word) & (static_cast<int64_t>(1) << bit);
+}
+
+// What the kernel did for every plan: transpose the input words into one bit per register and row
+static void BM_valids_per_row(benchmark::State & state) {
+	valids_plan plan(state.range(0), state.range(1));
+	size_t num_rows = state.range(1);
+	std::vector<int64_t> output_valids((num_rows + 63) / 64);
+
+	for(auto _ : state) {
+		for(size_t block = 0; block < output_valids.size(); block++) {
+			int64_t output_word = 0;
+			for(int row = 0; row < 64; row++) {
+				int64_t row_valids = 0;
+				for(int input = 0; input < plan.num_inputs; input++) {
+					set_bit(row_valids, input, get_bit(plan.input_valids[input][block], row));
+				}
+				for(size_t op_index = 0; op_index < plan.operators.size(); op_index++) {
+					set_bit(row_valids,
+						plan.outputs[op_index],
+						get_bit(row_valids, plan.left_inputs[op_index]) && get_bit(row_valids, plan.right_inputs[op_index]));
+				}
+				set_bit(output_word, row, get_bit(row_valids, plan.final_output_position));
+			}
+			output_valids[block] = output_word;
+		}
+		benchmark::DoNotOptimize(output_valids.data());
+	}
+
+	state.SetItemsProcessed(state.iterations() * num_rows);
+}
+BENCHMARK(BM_valids_per_row)->Apply(CustomArguments);
+
+// WORDWISE mode: one AND per operation for every 64 rows
+static void BM_valids_wordwise(benchmark::State & state) {
+	valids_plan plan(state.range(0), state.range(1));
+	size_t num_rows = state.range(1);
+	std::vector<int64_t> output_valids((num_rows + 63) / 64);
+	std::vector<int64_t> valid_words(plan.num_inputs + 2);
+
+	for(auto _ : state) {
+		for(size_t block = 0; block < output_valids.size(); block++) {
+			for(int input = 0; input < plan.num_inputs; input++) {
+				valid_words[input] = plan.input_valids[input][block];
+			}
+			process_valid_words(plan.operators.size(),
+				plan.left_inputs.data(),
+				plan.right_inputs.data(),
+				plan.outputs.data(),
+				plan.operators.data(),
+				plan.unary_operators.data(),
+				valid_words.data());
+			output_valids[block] = valid_words[plan.final_output_position];
+		}
+		benchmark::DoNotOptimize(output_valids.data());
+	}
+
+	state.SetItemsProcessed(state.iterations() * num_rows);
+}
+BENCHMARK(BM_valids_wordwise)->Apply(CustomArguments);
+
+// ALL_VALID mode: the inputs are never looked at and the output bitmap is filled once
+static void BM_valids_all_valid(benchmark::State & state) {
+	valids_plan plan(state.range(0), state.range(1));
+	size_t num_rows = state.range(1);
+	std::vector<int64_t> output_valids((num_rows + 63) / 64);
+
+	for(auto _ : state) {
+		std::memset(output_valids.data(), 0xff, output_valids.size() * sizeof(int64_t));
+		benchmark::DoNotOptimize(output_valids.data());
+	}
+
+	state.SetItemsProcessed(state.iterations() * num_rows);
+}
+BENCHMARK(BM_valids_all_valid)->Apply(CustomArguments);
@@ -0,0 +1,82 @@
+#include "utilities/LikePattern.h"
+#include <benchmark/benchmark.h>
+#include <cstdlib>
+#include <regex>
+#include <string>
+#include <vector>
+
+// Host string buffers with the same layout NVStrings hands out: one contiguous char buffer plus offsets
+struct host_strings {
+	std::vector<char> chars;
+	std::vector<size_t> offsets;
+
+	size_t size() const { return offsets.size() - 1; }
+	const char * data(size_t i) const { return chars.data() + offsets[i]; }
+	size_t length(size_t i) const { return offsets[i + 1] - offsets[i]; }
+};
+
+static host_strings generate_strings(size_t num_strings) {
+	static const std::vector<std::string> words = {
+		"PROMO", "STANDARD", "SMALL", "BRUSHED", "TIN", "BRASS", "green", "forest", "lace", "POLISHED"};
+
+	host_strings strings;
+	strings.offsets.push_back(0);
+	std::srand(42);
+	for(size_t i = 0; i < num_strings; i++) {
+		int num_words = 2 + std::rand() % 4;
+		for(int w = 0; w < num_words; w++) {
+			const std::string & word = words[std::rand() % words.size()];
+			if(w > 0) {
+				strings.chars.push_back(' ');
+			}
+			strings.chars.insert(strings.chars.end(), word.begin(), word.end());
+		}
+		strings.offsets.push_back(strings.chars.size());
+	}
+	return strings;
+}
+
+static const std::vector<std::string> LIKE_PATTERNS = {"PROMO%", "%BRASS", "%green%", "STANDARD TIN", "%PROMO_%BRASS"};
+
+static void CustomArguments(benchmark::internal::Benchmark * b) {
+	for(int i = 0; i < LIKE_PATTERNS.size(); ++i)
+		for(int64_t j = 1 << 10; j <= 1 << 20; j *= 32)
+			b->Args({i, j});
+}
+
+static void BM_like_compiled(benchmark::State & state) {
+	ral::utilities::like_pattern pattern = ral::utilities::compile_like_pattern(LIKE_PATTERNS[state.range(0)]);
+	host_strings strings = generate_strings(state.range(1));
+	std::vector<char> results(strings.size());
+
+	for(auto _ : state) {
+		for(size_t i = 0; i < strings.size(); i++) {
+			results[i] = pattern.matches(strings.data(i), strings.length(i));
+		}
+		benchmark::DoNotOptimize(results.data());
+	}
+
+	state.SetLabel(ral::utilities::like_pattern_kind_to_string(pattern.kind));
+	state.SetItemsProcessed(state.iterations() * strings.size());
+	state.SetBytesProcessed(state.iterations() * strings.chars.size());
+}
+BENCHMARK(BM_like_compiled)->Apply(CustomArguments);
+
+static void BM_like_regex(benchmark::State & state) {
+	ral::utilities::like_pattern pattern = ral::utilities::compile_like_pattern(LIKE_PATTERNS[state.range(0)]);
+	std::regex re(pattern.regex, std::regex::optimize);
+	host_strings strings = generate_strings(state.range(1));
+	std::vector<char> results(strings.size());
+
+	for(auto _ : state) {
+		for(size_t i = 0; i < strings.size(); i++) {
+			results[i] = std::regex_search(strings.data(i), strings.data(i) + strings.length(i), re);
+		}
+		benchmark::DoNotOptimize(results.data());
+	}
+
+	state.SetLabel("REGEX " + pattern.regex);
+	state.SetItemsProcessed(state.iterations() * strings.size());
+	state.SetBytesProcessed(state.iterations() * strings.chars.size());
+}
+BENCHMARK(BM_like_regex)->Apply(CustomArguments);
@@ -0,0 +1,81 @@
+#include "CodeTimer.h"
+#include <benchmark/benchmark.h>
+#include <blazingdb/io/Library/Logging/AsyncOutput.h>
+#include <blazingdb/io/Library/Logging/CoutOutput.h>
+#include <blazingdb/io/Library/Logging/FileOutput.h>
+#include <blazingdb/io/Library/Logging/Logger.h>
+#include <blazingdb/io/Library/Logging/ServiceLogging.h>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+using Library::Logging::BlazingLogger;
+using Library::Logging::LoggingLevel;
+using Library::Logging::ServiceLogging;
+
+static const char * LOG_FILE = "/tmp/blazing_logging_benchmark.log";
+
+enum output_mode { sync_file, async_file, level_disabled };
+
+static void set_output(benchmark::State & state, output_mode mode) {
+	if(mode == async_file) {
+		ServiceLogging::getInstance().setLogOutput(
+			new Library::Logging::AsyncOutput(new Library::Logging::FileOutput(LOG_FILE, true)));
+	} else {
+		ServiceLogging::getInstance().setLogOutput(new Library::Logging::FileOutput(LOG_FILE, true));
+	}
+	BlazingLogger::setMinimumLevel(mode == level_disabled ? LoggingLevel::WARN : LoggingLevel::TRACE);
+	state.SetLabel(mode == sync_file ? "sync file" : mode == async_file ? "async file" : "level disabled");
+}
+
+// writes what an asynchronous output still holds, outside of the measured loop
+static void reset_output() {
+	ServiceLogging::getInstance().setLogOutput(new Library::Logging::CoutOutput());
+	BlazingLogger::setMinimumLevel(LoggingLevel::TRACE);
+}
+
+// Time the logging thread spends in one call, with a line like the operators log
+static void BM_log_call(benchmark::State & state) {
+	if(state.thread_index == 0) {
+		set_output(state, static_cast<output_mode>(state.range(0)));
+	}
+	CodeTimer timer;
+	for(auto _ : state) {
+		Library::Logging::Logger().logInfo(timer.logDuration(1, 2, 3, "evaluate_split_query process_filter"));
+	}
+	state.SetItemsProcessed(state.iterations());
+	if(state.thread_index == 0) {
+		reset_output();
+	}
+}
+BENCHMARK(BM_log_call)->Arg(sync_file)->Arg(async_file)->Arg(level_disabled)->ThreadRange(1, 16)->UseRealTime();
+
+// A query of 20 operators each working through 64K rows and logging its duration, run by several threads at once like
+// concurrent queries. The latency of a query is the time per iteration.
+static void BM_query_with_logging(benchmark::State & state) {
+	const int num_operators = 20;
+	if(state.thread_index == 0) {
+		set_output(state, static_cast<output_mode>(state.range(0)));
+	}
+	std::vector<int64_t> rows(64 * 1024);
+	std::iota(rows.begin(), rows.end(), 0);
+	for(auto _ : state) {
+		for(int op = 0; op < num_operators; op++) {
+			CodeTimer timer;
+			int64_t sum = std::accumulate(rows.begin(), rows.end(), int64_t(op));
+			benchmark::DoNotOptimize(sum);
+			Library::Logging::Logger().logInfo(
+				timer.logDuration(1, op, 0, "evaluate_split_query operator", "num rows", rows.size()));
+		}
+	}
+	state.SetItemsProcessed(state.iterations());
+	if(state.thread_index == 0) {
+		reset_output();
+	}
+}
+BENCHMARK(BM_query_with_logging)
+	->Arg(sync_file)
+	->Arg(async_file)
+	->Arg(level_disabled)
+	->ThreadRange(1, 16)
+	->UseRealTime();
@@ -0,0 +1,94 @@
+#include <FileSystem/MappedReadableFile.h>
+#include <arrow/buffer.h>
+#include <arrow/io/file.h>
+#include <benchmark/benchmark.h>
+#include <cstdio>
+#include <fstream>
+#include <unistd.h>
+#include <vector>
+
+static const int64_t FILE_SIZE = 256 << 20;
+
+// Written once, the scans run over the page cache like a hot local data lake does
+static const std::string & test_file() {
+	static std::string path;
+	if(path.empty()) {
+		char name[] = "/tmp/mapped_read_benchmarkXXXXXX";
+		close(mkstemp(name));
+		path = name;
+
+		std::vector<char> block(1 << 20);
+		for(size_t i = 0; i < block.size(); i++) {
+			block[i] = static_cast<char>(i * 31);
+		}
+		std::ofstream file(path, std::ios::binary);
+		for(int64_t written = 0; written < FILE_SIZE; written += block.size()) {
+			file.write(block.data(), block.size());
+		}
+		std::atexit([]() { std::remove(path.c_str()); });
+	}
+	return path;
+}
+
+// What the parsers do with a column chunk: read it into a buffer and go over its bytes
+static int64_t consume(const arrow::Buffer & buffer) {
+	int64_t sum = 0;
+	for(int64_t i = 0; i < buffer.size(); i += 64) {
+		sum += buffer.data()[i];
+	}
+	return sum;
+}
+
+// arg 0: bytes per read (a column chunk), arg 1: stride between reads, a stride larger than the read size is a
+// projection that skips the chunks of the other columns
+static void CustomArguments(benchmark::internal::Benchmark * b) {
+	for(int64_t read_size : {64 << 10, 1 << 20, 8 << 20})
+		for(int64_t columns : {1, 4})
+			b->Args({read_size, read_size * columns});
+}
+
+static void BM_scan_readable_file(benchmark::State & state) {
+	std::shared_ptr<arrow::io::ReadableFile> file;
+	arrow::io::ReadableFile::Open(test_file(), &file);
+
+	int64_t sum = 0;
+	for(auto _ : state) {
+		for(int64_t position = 0; position + state.range(0) <= FILE_SIZE; position += state.range(1)) {
+			std::shared_ptr<arrow::Buffer> buffer;
+			file->ReadAt(position, state.range(0), &buffer);
+			sum += consume(*buffer);
+		}
+	}
+	benchmark::DoNotOptimize(sum);
+
+	state.SetBytesProcessed(state.iterations() * (FILE_SIZE / state.range(1)) * state.range(0));
+}
+BENCHMARK(BM_scan_readable_file)->Apply(CustomArguments)->Unit(benchmark::kMillisecond);
+
+static void BM_scan_mapped_file(benchmark::State & state) {
+	std::shared_ptr<MappedReadableFile> file;
+	MappedReadableFile::Open(test_file(), MappedFileAdvice::NORMAL, &file);
+
+	// what the parquet parser does for a projection
+	if(state.range(1) > state.range(0)) {
+		file->Advise(0, FILE_SIZE, MappedFileAdvice::RANDOM);
+		for(int64_t position = 0; position + state.range(0) <= FILE_SIZE; position += state.range(1)) {
+			file->Advise(position, state.range(0), MappedFileAdvice::WILLNEED);
+		}
+	} else {
+		file->Advise(0, FILE_SIZE, MappedFileAdvice::SEQUENTIAL);
+	}
+
+	int64_t sum = 0;
+	for(auto _ : state) {
+		for(int64_t position = 0; position + state.range(0) <= FILE_SIZE; position += state.range(1)) {
+			std::shared_ptr<arrow::Buffer> buffer;
+			file->ReadAt(position, state.range(0), &buffer);
+			sum += consume(*buffer);
+		}
+	}
+	benchmark::DoNotOptimize(sum);
+
+	state.SetBytesProcessed(state.iterations() * (FILE_SIZE / state.range(1)) * state.range(0));
+}
+BENCHMARK(BM_scan_mapped_file)->Apply(CustomArguments)->Unit(benchmark::kMillisecond);
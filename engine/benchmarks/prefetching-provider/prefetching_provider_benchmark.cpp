@@ -0,0 +1,97 @@
+#include "io/data_provider/PrefetchingDataProvider.h"
+#include "io/data_provider/UriDataProvider.h"
+#include <benchmark/benchmark.h>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+static const int64_t FILE_SIZE = 4 << 10;
+
+// A local directory of many small files, like a table written by many small tasks
+static const std::string & test_directory(int num_files) {
+	static std::map<int, std::string> directories;
+	std::string & directory = directories[num_files];
+	if(directory.empty()) {
+		char name[] = "/tmp/prefetching_provider_benchmarkXXXXXX";
+		directory = mkdtemp(name);
+
+		std::vector<char> content(FILE_SIZE, 'x');
+		for(int i = 0; i < num_files; i++) {
+			std::ofstream file(directory + "/part_" + std::to_string(i) + ".psv", std::ios::binary);
+			file.write(content.data(), content.size());
+		}
+		std::atexit([]() {
+			for(auto & entry : directories) {
+				std::system(("rm -rf " + entry.second).c_str());
+			}
+		});
+	}
+	return directory;
+}
+
+// What a parser does with a small file: read it whole and go over its bytes
+static int64_t parse(ral::io::data_handle handle) {
+	std::vector<uint8_t> data(FILE_SIZE);
+	int64_t bytes_read = 0;
+	handle.fileHandle->ReadAt(0, FILE_SIZE, &bytes_read, data.data());
+
+	int64_t sum = 0;
+	for(int64_t i = 0; i < bytes_read; i++) {
+		sum += data[i];
+	}
+	return sum;
+}
+
+// What data_loader did before: open every file serially, then one thread per file
+static void BM_serial_open_thread_per_file(benchmark::State & state) {
+	const std::vector<Uri> uris = {Uri{test_directory(state.range(0)) + "/"}};
+
+	for(auto _ : state) {
+		ral::io::uri_data_provider provider(uris);
+		std::vector<ral::io::data_handle> files;
+		while(provider.has_next()) {
+			files.push_back(provider.get_next());
+		}
+
+		std::vector<int64_t> sums(files.size());
+		std::vector<std::thread> threads;
+		for(size_t i = 0; i < files.size(); i++) {
+			threads.push_back(std::thread([&, i]() { sums[i] = parse(files[i]); }));
+		}
+		for(std::thread & thread : threads) {
+			thread.join();
+		}
+		benchmark::DoNotOptimize(sums);
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_serial_open_thread_per_file)->Arg(500)->Arg(5000)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// arg 1: files in flight
+static void BM_prefetching_parse_pool(benchmark::State & state) {
+	const std::vector<Uri> uris = {Uri{test_directory(state.range(0)) + "/"}};
+	auto parse_pool = std::make_shared<ThreadPool>(std::max(std::thread::hardware_concurrency(), 1u));
+
+	for(auto _ : state) {
+		ral::io::prefetching_data_provider provider(uris, {}, {}, {}, state.range(1));
+		std::vector<std::future<int64_t>> sums;
+		while(provider.has_next()) {
+			ral::io::data_handle file = provider.get_next();
+			sums.push_back(parse_pool->submit([file]() { return parse(file); }));
+		}
+		for(auto & sum : sums) {
+			benchmark::DoNotOptimize(sum.get());
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_prefetching_parse_pool)
+	->Args({500, 16})
+	->Args({500, 64})
+	->Args({5000, 16})
+	->Args({5000, 64})
+	->Unit(benchmark::kMillisecond)
+	->UseRealTime();
@@ -0,0 +1,98 @@
+#include <FileSystem/private/RangeReader.h>
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+// Object store stand-in: every range request pays a fixed latency plus its transfer time at the bandwidth of one
+// connection, so parallel requests scale until the pool runs out of workers
+struct simulated_object {
+	std::vector<uint8_t> data;
+	int64_t latency_us;
+	int64_t bytes_per_us;
+
+	simulated_object(int64_t size, int64_t latency_us) : data(size, 1), latency_us{latency_us}, bytes_per_us{100} {}
+
+	arrow::Status fetch(int64_t position, int64_t nbytes, int64_t * bytes_read, uint8_t * out) const {
+		std::this_thread::sleep_for(std::chrono::microseconds(latency_us + nbytes / bytes_per_us));
+		*bytes_read = std::min<int64_t>(nbytes, data.size() - position);
+		std::copy(data.begin() + position, data.begin() + position + *bytes_read, out);
+		return arrow::Status::OK();
+	}
+};
+
+static const int64_t OBJECT_SIZE = 16 << 20;
+
+static void CustomArguments(benchmark::internal::Benchmark * b) {
+	for(int64_t read_size = 16 << 10; read_size <= OBJECT_SIZE; read_size *= 8)
+		for(int64_t latency_us : {1000, 10000})
+			b->Args({read_size, latency_us});
+}
+
+// What S3ReadableFile did: one synchronous request per read
+static void BM_sequential_scan_one_request_per_read(benchmark::State & state) {
+	simulated_object object(OBJECT_SIZE, state.range(1));
+	std::vector<uint8_t> buffer(state.range(0));
+
+	for(auto _ : state) {
+		for(int64_t position = 0; position < OBJECT_SIZE; position += buffer.size()) {
+			int64_t bytes_read;
+			object.fetch(position, buffer.size(), &bytes_read, buffer.data());
+		}
+		benchmark::DoNotOptimize(buffer.data());
+	}
+
+	state.SetBytesProcessed(state.iterations() * OBJECT_SIZE);
+}
+BENCHMARK(BM_sequential_scan_one_request_per_read)->Apply(CustomArguments)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+static void BM_sequential_scan_range_reader(benchmark::State & state) {
+	simulated_object object(OBJECT_SIZE, state.range(1));
+	std::vector<uint8_t> buffer(state.range(0));
+	auto fetch = [&object](int64_t position, int64_t nbytes, int64_t * bytes_read, uint8_t * out) {
+		return object.fetch(position, nbytes, bytes_read, out);
+	};
+
+	int64_t num_requests = 0;
+	for(auto _ : state) {
+		RangeReader reader(fetch, OBJECT_SIZE, RangeReader::getDefaultIoPool());
+		for(int64_t position = 0; position < OBJECT_SIZE; position += buffer.size()) {
+			int64_t bytes_read;
+			reader.ReadAt(position, buffer.size(), &bytes_read, buffer.data());
+		}
+		benchmark::DoNotOptimize(buffer.data());
+		num_requests += reader.getNumRequests();
+	}
+
+	state.counters["requests"] = benchmark::Counter(num_requests, benchmark::Counter::kAvgIterations);
+	state.SetBytesProcessed(state.iterations() * OBJECT_SIZE);
+}
+BENCHMARK(BM_sequential_scan_range_reader)->Apply(CustomArguments)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// Column chunk reads of a parquet file: small reads scattered over the object, some of them close to each other
+static void BM_scattered_reads_range_reader(benchmark::State & state) {
+	simulated_object object(OBJECT_SIZE, state.range(1));
+	std::vector<uint8_t> buffer(state.range(0));
+	auto fetch = [&object](int64_t position, int64_t nbytes, int64_t * bytes_read, uint8_t * out) {
+		return object.fetch(position, nbytes, bytes_read, out);
+	};
+
+	std::vector<int64_t> positions;
+	for(int64_t position = 0; position + state.range(0) <= OBJECT_SIZE; position += 4 * state.range(0)) {
+		positions.push_back(position);
+		positions.push_back(position + state.range(0) / 2);
+	}
+
+	for(auto _ : state) {
+		RangeReader reader(fetch, OBJECT_SIZE, RangeReader::getDefaultIoPool());
+		for(int64_t position : positions) {
+			int64_t bytes_read;
+			reader.ReadAt(position, std::min<int64_t>(buffer.size(), OBJECT_SIZE - position), &bytes_read, buffer.data());
+		}
+		benchmark::DoNotOptimize(buffer.data());
+	}
+
+	state.SetBytesProcessed(state.iterations() * positions.size() * state.range(0));
+}
+BENCHMARK(BM_scattered_reads_range_reader)->Apply(CustomArguments)->Unit(benchmark::kMillisecond)->UseRealTime();
@@ -0,0 +1,143 @@
+#include "io/data_parser/RowGroupDecoder.h"
+#include <algorithm>
+#include <arrow/io/file.h>
+#include <benchmark/benchmark.h>
+#include <cstdlib>
+#include <map>
+#include <parquet/api/reader.h>
+#include <parquet/api/writer.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+static const int TOTAL_ROW_GROUPS = 32;
+static const int ROWS_PER_GROUP = 1 << 20;
+// the default of the engine decode pool
+static const int DECODE_THREADS = std::max(std::thread::hardware_concurrency(), 1u);
+
+// The same 32 row groups of snappy compressed int64 values, in 1 large file or spread over several files
+static const std::vector<std::string> & test_files(int num_files) {
+	static std::map<int, std::vector<std::string>> files_per_layout;
+	std::vector<std::string> & files = files_per_layout[num_files];
+	if(files.empty()) {
+		char name[] = "/tmp/row_group_decoding_benchmarkXXXXXX";
+		const std::string directory = mkdtemp(name);
+
+		auto schema = std::static_pointer_cast<parquet::schema::GroupNode>(parquet::schema::GroupNode::Make("schema",
+			parquet::Repetition::REQUIRED,
+			parquet::schema::NodeVector{parquet::schema::PrimitiveNode::Make(
+				"value", parquet::Repetition::REQUIRED, parquet::Type::INT64, parquet::ConvertedType::NONE)}));
+		std::shared_ptr<parquet::WriterProperties> properties =
+			parquet::WriterProperties::Builder().compression(parquet::Compression::SNAPPY)->build();
+
+		std::vector<int64_t> values(ROWS_PER_GROUP);
+		for(int file_index = 0; file_index < num_files; file_index++) {
+			files.push_back(directory + "/part_" + std::to_string(file_index) + ".parquet");
+			std::shared_ptr<arrow::io::FileOutputStream> stream;
+			PARQUET_THROW_NOT_OK(arrow::io::FileOutputStream::Open(files.back(), &stream));
+			std::shared_ptr<parquet::ParquetFileWriter> file_writer =
+				parquet::ParquetFileWriter::Open(stream, schema, properties);
+
+			for(int row_group = 0; row_group < TOTAL_ROW_GROUPS / num_files; row_group++) {
+				auto * int64_writer =
+					static_cast<parquet::Int64Writer *>(file_writer->AppendRowGroup(ROWS_PER_GROUP)->NextColumn());
+				for(int row = 0; row < ROWS_PER_GROUP; row++) {
+					values[row] = (row_group * ROWS_PER_GROUP + row) % 1000;
+				}
+				int64_writer->WriteBatch(ROWS_PER_GROUP, nullptr, nullptr, values.data());
+			}
+			file_writer->Close();
+			PARQUET_THROW_NOT_OK(stream->Close());
+		}
+		std::atexit([]() {
+			for(auto & layout : files_per_layout) {
+				for(const std::string & file : layout.second) {
+					std::remove(file.c_str());
+				}
+			}
+		});
+	}
+	return files;
+}
+
+// host stand-in for the GPU decode of a row group
+static std::vector<int64_t> decode_on_host(const std::string & path, int row_group) {
+	std::unique_ptr<parquet::ParquetFileReader> reader = parquet::ParquetFileReader::OpenFile(path, false);
+	auto column = std::static_pointer_cast<parquet::Int64Reader>(reader->RowGroup(row_group)->Column(0));
+
+	std::vector<int64_t> values(reader->metadata()->RowGroup(row_group)->num_rows());
+	size_t num_values = 0;
+	while(column->HasNext() && num_values < values.size()) {
+		int64_t values_read = 0;
+		column->ReadBatch(values.size() - num_values, nullptr, nullptr, values.data() + num_values, &values_read);
+		num_values += values_read;
+	}
+	return values;
+}
+
+static int num_row_groups(const std::string & path) {
+	return parquet::ParquetFileReader::OpenFile(path, false)->metadata()->num_row_groups();
+}
+
+// arg 0: number of files, the parallelism the parser had when it read each file as a unit
+static void BM_decode_file_per_task(benchmark::State & state) {
+	const std::vector<std::string> & files = test_files(state.range(0));
+	ThreadPool decode_pool(DECODE_THREADS);
+
+	for(auto _ : state) {
+		std::vector<std::future<size_t>> decoding;
+		for(const std::string & file : files) {
+			// the whole file is decoded before it is handed over, like read_all() did
+			decoding.push_back(decode_pool.submit([file]() {
+				std::vector<std::vector<int64_t>> row_groups;
+				for(int row_group = 0; row_group < num_row_groups(file); row_group++) {
+					row_groups.push_back(decode_on_host(file, row_group));
+				}
+				size_t num_rows = 0;
+				for(const auto & row_group : row_groups) {
+					num_rows += row_group.size();
+				}
+				return num_rows;
+			}));
+		}
+		size_t num_rows = 0;
+		for(auto & file : decoding) {
+			num_rows += file.get();
+		}
+		benchmark::DoNotOptimize(num_rows);
+	}
+	state.SetItemsProcessed(state.iterations() * int64_t(TOTAL_ROW_GROUPS) * ROWS_PER_GROUP);
+}
+BENCHMARK(BM_decode_file_per_task)->Arg(1)->Arg(8)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// arg 0: number of files, every file split by row group across the decode pool
+static void BM_decode_row_group_per_task(benchmark::State & state) {
+	const std::vector<std::string> & files = test_files(state.range(0));
+	ThreadPool file_pool(files.size());
+	ThreadPool decode_pool(DECODE_THREADS);
+
+	for(auto _ : state) {
+		// the files are parsed on their own pool, like the loader does, and only wait on the decode pool
+		std::vector<std::future<size_t>> decoding;
+		for(const std::string & file : files) {
+			decoding.push_back(file_pool.submit([file, &decode_pool]() {
+				auto row_groups = ral::io::decode_row_groups(
+					ral::io::get_row_groups_to_decode({}, num_row_groups(file)),
+					[file](int row_group) { return decode_on_host(file, row_group); },
+					decode_pool);
+				size_t num_rows = 0;
+				for(const auto & row_group : row_groups) {
+					num_rows += row_group.size();
+				}
+				return num_rows;
+			}));
+		}
+		size_t num_rows = 0;
+		for(auto & file : decoding) {
+			num_rows += file.get();
+		}
+		benchmark::DoNotOptimize(num_rows);
+	}
+	state.SetItemsProcessed(state.iterations() * int64_t(TOTAL_ROW_GROUPS) * ROWS_PER_GROUP);
+}
+BENCHMARK(BM_decode_row_group_per_task)->Arg(1)->Arg(8)->Unit(benchmark::kMillisecond)->UseRealTime();
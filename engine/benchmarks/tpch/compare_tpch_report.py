@@ -0,0 +1,117 @@
+#!/usr/bin/env python3
+"""Compares a tpch_benchmark report with a baseline report, both written with
+--benchmark_out_format=json, and exits with 1 when a query or one of its
+operators got slower than the threshold allows, or a query of the baseline is
+missing from the report. Needs no GPU, so the reports of a GPU runner can be
+checked anywhere.
+
+    compare_tpch_report.py baseline.json tpch.json [--threshold 0.10]
+"""
+
+import argparse
+import json
+import statistics
+import sys
+
+
+def load_report(path):
+    """The times of every query by name, the median of its repetitions: its
+    real time and the self time of every operator, in milliseconds."""
+    with open(path) as report_file:
+        report = json.load(report_file)
+
+    runs = {}
+    for benchmark in report['benchmarks']:
+        if benchmark.get('run_type') == 'aggregate':
+            continue
+        name = benchmark.get('run_name', benchmark['name'])
+        runs.setdefault(name, []).append(benchmark)
+
+    queries = {}
+    for name, repetitions in runs.items():
+        times = {'real_time': statistics.median(
+            to_milliseconds(run['real_time'], run['time_unit'])
+            for run in repetitions)}
+        for counter in repetitions[0]:
+            if counter.startswith('op') and counter.endswith('_ms'):
+                times[counter] = statistics.median(
+                    run.get(counter, 0.0) for run in repetitions)
+        queries[name] = {'scale': repetitions[0].get('scale'), 'times': times}
+    return queries
+
+
+def to_milliseconds(time, unit):
+    return time * {'ns': 1e-6, 'us': 1e-3, 'ms': 1.0, 's': 1e3}[unit]
+
+
+def compare(baseline, current, threshold, operator_threshold, min_ms,
+            allow_missing=False):
+    """The lines of the comparison and whether there is a regression. Operators
+    faster than min_ms in both reports are not compared, their noise is larger
+    than their time. A query of the baseline that is missing from the report,
+    one that failed or was filtered out, is a regression unless allow_missing."""
+    lines = []
+    regressed = False
+    for name in sorted(set(baseline) | set(current)):
+        if name not in current:
+            lines.append('{}: missing from the report{}'.format(
+                name, '' if allow_missing else '  REGRESSION'))
+            regressed = regressed or not allow_missing
+            continue
+        if name not in baseline:
+            lines.append('{}: new, not in the baseline'.format(name))
+            continue
+        if baseline[name]['scale'] != current[name]['scale']:
+            lines.append('{}: scale {} against a baseline at scale {}'.format(
+                name, current[name]['scale'], baseline[name]['scale']))
+            regressed = True
+            continue
+
+        times = sorted(current[name]['times'].items(),
+                       key=lambda item: (item[0] != 'real_time', item[0]))
+        for key, current_ms in times:
+            baseline_ms = baseline[name]['times'].get(key)
+            if baseline_ms is None:
+                continue
+            if key != 'real_time' and max(baseline_ms, current_ms) < min_ms:
+                continue
+            change = 0.0
+            if baseline_ms > 0:
+                change = (current_ms - baseline_ms) / baseline_ms
+            limit = threshold if key == 'real_time' else operator_threshold
+            flag = ''
+            if change > limit:
+                flag = '  REGRESSION'
+                regressed = True
+            elif change < -limit:
+                flag = '  improvement'
+            lines.append('{} {}: {:.3f} ms -> {:.3f} ms ({:+.1%}){}'.format(
+                name, key, baseline_ms, current_ms, change, flag))
+    return lines, regressed
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n\n')[0])
+    parser.add_argument('baseline', help='the report to compare against')
+    parser.add_argument('current', help='the report of the change')
+    parser.add_argument('--threshold', type=float, default=0.10,
+                        help='slowdown of a query that is a regression')
+    parser.add_argument('--operator-threshold', type=float, default=0.25,
+                        help='slowdown of an operator that is a regression')
+    parser.add_argument('--min-ms', type=float, default=1.0,
+                        help='operators faster than this are not compared')
+    parser.add_argument('--allow-missing', action='store_true',
+                        help='queries of the baseline missing from the report '
+                             'are not a regression')
+    args = parser.parse_args()
+
+    lines, regressed = compare(load_report(args.baseline),
+                               load_report(args.current), args.threshold,
+                               args.operator_threshold, args.min_ms,
+                               args.allow_missing)
+    print('\n'.join(lines))
+    return 1 if regressed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
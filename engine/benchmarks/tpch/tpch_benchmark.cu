@@ -0,0 +1,351 @@
+/*
+ * TPC-H like queries run through evaluate_split_query over tables generated on the GPU: the scan, filter and aggregate
+ * queries (Q1, Q6, Q18) as micro benchmarks of a few operators, the join queries (Q3, Q5) as macro benchmarks of whole
+ * plans. Every query runs BLAZING_TPCH_WARMUP times (1 by default) before it is timed. The self time of every operator
+ * of its plan is reported as an op<index>_<operator>_ms counter, the index being its position in the plan from the
+ * top. BLAZING_TPCH_SCALE is the scale factor (0.01 by default), 1 generates 6M lineitem rows. The tables are the same
+ * from run to run, their values are uniform and not those of dbgen. BM_selection_vectors reports the bytes_copied by
+ * the filters of Q1 and of a filter, project, filter plan, with selection vectors off (/0) and on (/1).
+ *
+ *   tpch_benchmark --benchmark_repetitions=5 --benchmark_out=tpch.json --benchmark_out_format=json
+ *   compare_tpch_report.py baseline.json tpch.json
+ */
+
+#include "CalciteInterpreter.h"
+#include "DataFrame.h"
+#include "GDFColumn.cuh"
+#include "Traits/RuntimeTraits.h"
+#include "cuDF/generator/random_generator.cuh"
+#include "profile/QueryProfile.h"
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include <blazingdb/io/Library/Logging/CoutOutput.h>
+#include <blazingdb/io/Library/Logging/Logger.h>
+#include <blazingdb/io/Library/Logging/ServiceLogging.h>
+#include <blazingdb/io/Util/StringUtil.h>
+#include <blazingdb/manager/Context.h>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <rmm/rmm.h>
+#include <string>
+#include <vector>
+
+using blazingdb::manager::Context;
+using blazingdb::transport::Node;
+
+// days since the epoch
+static const int32_t FIRST_ORDER_DATE = 8035;  // 1992-01-01
+static const int32_t LAST_ORDER_DATE = 10440;  // 1998-08-02
+static const int32_t LAST_SHIP_DATE = 10561;   // 1998-12-01
+
+struct tpch_table {
+	std::string name;
+	std::vector<std::string> column_names;
+	std::vector<gdf_column_cpp> columns;
+
+	template <typename T>
+	void add_column(const std::string & column_name, gdf_dtype dtype, std::vector<T> values) {
+		gdf_column_cpp column;
+		column.create_gdf_column(dtype,
+			gdf_dtype_extra_info{TIME_UNIT_NONE, nullptr},
+			values.size(),
+			values.data(),
+			ral::traits::get_dtype_size_in_bytes(dtype),
+			column_name);
+		column_names.push_back(column_name);
+		columns.push_back(column);
+	}
+};
+
+struct tpch_database {
+	double scale;
+	std::size_t num_lineitems;
+	std::vector<tpch_table> tables;
+};
+
+static double get_env_double(const char * name, double default_value) {
+	const char * value = std::getenv(name);
+	return value != nullptr && std::string(value) != "" ? std::atof(value) : default_value;
+}
+
+static std::size_t get_num_rows(std::size_t rows_at_scale_1, double scale) {
+	return std::max<std::size_t>(rows_at_scale_1 * scale, 1);
+}
+
+// in [min_value, max_value), the same values every time
+static std::vector<int32_t> random_ints(int32_t min_value, int32_t max_value, std::size_t size) {
+	return cudf::generator::RandomVectorGenerator<int32_t>(min_value, max_value)(size);
+}
+
+// with two decimals, like the prices and discounts of the specification
+static std::vector<double> random_decimals(int64_t min_cents, int64_t max_cents, std::size_t size) {
+	std::vector<int64_t> cents = cudf::generator::RandomVectorGenerator<int64_t>(min_cents, max_cents)(size);
+	std::vector<double> values(size);
+	std::transform(cents.begin(), cents.end(), values.begin(), [](int64_t value) { return value / 100.0; });
+	return values;
+}
+
+// 1 to size, in order
+static std::vector<int32_t> keys(std::size_t size) {
+	std::vector<int32_t> values(size);
+	std::iota(values.begin(), values.end(), 1);
+	return values;
+}
+
+// Only the columns the queries use, with the cardinalities of the specification. Strings the queries compare to a
+// literal are ints here, a market segment of 1 stands for 'BUILDING'.
+static tpch_database generate_database(double scale) {
+	const std::size_t num_customers = get_num_rows(150000, scale);
+	const std::size_t num_orders = get_num_rows(1500000, scale);
+	const std::size_t num_lineitems = get_num_rows(6000000, scale);
+	tpch_database database{scale, num_lineitems};
+
+	tpch_table nation{"main.nation"};
+	std::vector<int32_t> region_keys(25);
+	for(std::size_t i = 0; i < region_keys.size(); i++) {
+		region_keys[i] = i % 5;
+	}
+	std::vector<int32_t> nation_keys(25);
+	std::iota(nation_keys.begin(), nation_keys.end(), 0);
+	nation.add_column("n_nationkey", GDF_INT32, nation_keys);
+	nation.add_column("n_regionkey", GDF_INT32, region_keys);
+	database.tables.push_back(nation);
+
+	tpch_table customer{"main.customer"};
+	customer.add_column("c_custkey", GDF_INT32, keys(num_customers));
+	customer.add_column("c_nationkey", GDF_INT32, random_ints(0, 25, num_customers));
+	customer.add_column("c_acctbal", GDF_FLOAT64, random_decimals(-99999, 1000000, num_customers));
+	customer.add_column("c_mktsegment", GDF_INT32, random_ints(0, 5, num_customers));
+	database.tables.push_back(customer);
+
+	tpch_table orders{"main.orders"};
+	orders.add_column("o_orderkey", GDF_INT32, keys(num_orders));
+	orders.add_column("o_custkey", GDF_INT32, random_ints(1, num_customers + 1, num_orders));
+	orders.add_column("o_totalprice", GDF_FLOAT64, random_decimals(90000, 50000000, num_orders));
+	orders.add_column("o_orderdate", GDF_INT32, random_ints(FIRST_ORDER_DATE, LAST_ORDER_DATE + 1, num_orders));
+	orders.add_column("o_shippriority", GDF_INT32, std::vector<int32_t>(num_orders, 0));
+	database.tables.push_back(orders);
+
+	tpch_table lineitem{"main.lineitem"};
+	lineitem.add_column("l_orderkey", GDF_INT32, random_ints(1, num_orders + 1, num_lineitems));
+	lineitem.add_column("l_partkey", GDF_INT32, random_ints(1, get_num_rows(200000, scale) + 1, num_lineitems));
+	lineitem.add_column("l_suppkey", GDF_INT32, random_ints(1, get_num_rows(10000, scale) + 1, num_lineitems));
+	lineitem.add_column("l_linenumber", GDF_INT32, random_ints(1, 8, num_lineitems));
+	lineitem.add_column("l_quantity", GDF_FLOAT64, random_decimals(100, 5100, num_lineitems));
+	lineitem.add_column("l_extendedprice", GDF_FLOAT64, random_decimals(90000, 10500000, num_lineitems));
+	lineitem.add_column("l_discount", GDF_FLOAT64, random_decimals(0, 11, num_lineitems));
+	lineitem.add_column("l_tax", GDF_FLOAT64, random_decimals(0, 9, num_lineitems));
+	lineitem.add_column("l_returnflag", GDF_INT32, random_ints(0, 3, num_lineitems));
+	lineitem.add_column("l_linestatus", GDF_INT32, random_ints(0, 2, num_lineitems));
+	lineitem.add_column("l_shipdate", GDF_INT32, random_ints(FIRST_ORDER_DATE + 1, LAST_SHIP_DATE + 1, num_lineitems));
+	database.tables.push_back(lineitem);
+
+	return database;
+}
+
+// generated once, by the first query that runs
+static tpch_database & get_database() {
+	static tpch_database database = [] {
+		rmmInitialize(nullptr);
+		Library::Logging::ServiceLogging::getInstance().setLogOutput(new Library::Logging::CoutOutput());
+		Library::Logging::BlazingLogger::setMinimumLevel(Library::Logging::LoggingLevel::WARN);
+		return generate_database(get_env_double("BLAZING_TPCH_SCALE", 0.01));
+	}();
+	return database;
+}
+
+// Runs the plan the way the evaluate_query tests do, on a context of this node alone. The operators are profiled into
+// profile when there is one.
+static void run_query(
+	const tpch_database & database, const std::string & logical_plan, ral::profile::query_profile * profile) {
+	std::vector<std::vector<gdf_column_cpp>> input_tables;
+	std::vector<std::string> table_names;
+	std::vector<std::vector<std::string>> column_names;
+	for(const tpch_table & table : database.tables) {
+		input_tables.push_back(table.columns);
+		table_names.push_back(table.name);
+		column_names.push_back(table.column_names);
+	}
+
+	std::vector<std::shared_ptr<Node>> nodes{Node::Make(blazingdb::transport::Address::TCP("127.0.0.1", 8001, 1234))};
+	Context context{0, nodes, nodes[0], ""};
+	std::unique_ptr<ral::profile::query_scope> profile_scope;
+	if(profile != nullptr) {
+		profile_scope.reset(new ral::profile::query_scope(*profile, context.getMemoryTracker()));
+	}
+	blazing_frame output_frame = evaluate_split_query(
+		input_tables, table_names, column_names, StringUtil::split(logical_plan, "\n"), &context);
+	cudaDeviceSynchronize();
+	benchmark::DoNotOptimize(output_frame);
+}
+
+// "LogicalJoin" for "  LogicalJoin(condition=[=($0, $5)], joinType=[inner])"
+static std::string get_operator_name(const std::string & relational_expression) {
+	std::string name = relational_expression.substr(0, relational_expression.find('('));
+	name.erase(0, name.find_first_not_of(' '));
+	return name;
+}
+
+static void add_self_times(
+	const ral::profile::operator_profile & profile, std::map<std::string, double> & self_times, int & index) {
+	self_times["op" + std::to_string(index) + "_" + get_operator_name(profile.relational_expression) + "_ms"] +=
+		profile.self_time_ms;
+	index++;
+	for(const std::unique_ptr<ral::profile::operator_profile> & child : profile.children) {
+		add_self_times(*child, self_times, index);
+	}
+}
+
+static void BM_tpch_query(benchmark::State & state, const char * logical_plan) {
+	const tpch_database & database = get_database();
+	const int warmup_runs = get_env_double("BLAZING_TPCH_WARMUP", 1);
+	for(int i = 0; i < warmup_runs; i++) {
+		run_query(database, logical_plan, nullptr);
+	}
+
+	std::map<std::string, double> self_times;
+	for(auto _ : state) {
+		ral::profile::query_profile profile(0);
+		run_query(database, logical_plan, &profile);
+		int index = 0;
+		if(profile.get_root() != nullptr) {
+			add_self_times(*profile.get_root(), self_times, index);
+		}
+	}
+
+	for(const auto & self_time : self_times) {
+		state.counters[self_time.first] = benchmark::Counter(self_time.second, benchmark::Counter::kAvgIterations);
+	}
+	state.counters["scale"] = database.scale;
+	state.SetItemsProcessed(state.iterations() * database.num_lineitems);
+}
+
+static std::size_t get_bytes_copied(const ral::profile::operator_profile & profile) {
+	std::size_t bytes_copied = profile.bytes_copied;
+	for(const std::unique_ptr<ral::profile::operator_profile> & child : profile.children) {
+		bytes_copied += get_bytes_copied(*child);
+	}
+	return bytes_copied;
+}
+
+// The bytes the filters of a plan copy, with their rows left as a selection (1) or gathered right away (0)
+static void BM_selection_vectors(benchmark::State & state, const char * logical_plan) {
+	const tpch_database & database = get_database();
+	const bool selection_vectors = get_filter_selection_vectors();
+	set_filter_selection_vectors(state.range(0) != 0);
+	const int warmup_runs = get_env_double("BLAZING_TPCH_WARMUP", 1);
+	for(int i = 0; i < warmup_runs; i++) {
+		run_query(database, logical_plan, nullptr);
+	}
+
+	std::size_t bytes_copied = 0;
+	for(auto _ : state) {
+		ral::profile::query_profile profile(0);
+		run_query(database, logical_plan, &profile);
+		if(profile.get_root() != nullptr) {
+			bytes_copied += get_bytes_copied(*profile.get_root());
+		}
+	}
+	set_filter_selection_vectors(selection_vectors);
+
+	state.counters["bytes_copied"] = benchmark::Counter(bytes_copied, benchmark::Counter::kAvgIterations);
+	state.counters["scale"] = database.scale;
+	state.SetItemsProcessed(state.iterations() * database.num_lineitems);
+}
+
+// Pricing summary report: a filter and a grouped aggregation over all of lineitem
+BENCHMARK_CAPTURE(BM_tpch_query,
+	q1,
+	"LogicalSort(sort0=[$0], sort1=[$1], dir0=[ASC], dir1=[ASC])\n"
+	"  LogicalAggregate(group=[{0, 1}], sum_qty=[SUM($2)], sum_base_price=[SUM($3)], sum_disc_price=[SUM($4)], "
+	"sum_charge=[SUM($5)], avg_qty=[AVG($2)], avg_price=[AVG($3)], avg_disc=[AVG($6)], count_order=[COUNT()])\n"
+	"    LogicalProject(l_returnflag=[$8], l_linestatus=[$9], l_quantity=[$4], l_extendedprice=[$5], "
+	"$f4=[*($5, -(1, $6))], $f5=[*(*($5, -(1, $6)), +(1, $7))], l_discount=[$6])\n"
+	"      LogicalFilter(condition=[<=($10, 10471)])\n"
+	"        LogicalTableScan(table=[[main, lineitem]])")
+	->Unit(benchmark::kMillisecond)
+	->UseRealTime();
+
+// Forecasting revenue change: a selective filter and an aggregation without groups
+BENCHMARK_CAPTURE(BM_tpch_query,
+	q6,
+	"LogicalAggregate(group=[{}], revenue=[SUM($0)])\n"
+	"  LogicalProject($f0=[*($5, $6)])\n"
+	"    LogicalFilter(condition=[AND(>=($10, 8766), <($10, 9131), >=($6, 0.05), <=($6, 0.07), <($4, 24))])\n"
+	"      LogicalTableScan(table=[[main, lineitem]])")
+	->Unit(benchmark::kMillisecond)
+	->UseRealTime();
+
+// Large volume customer, without its joins: a group by with one group per order and a filter on the groups
+BENCHMARK_CAPTURE(BM_tpch_query,
+	q18,
+	"LogicalSort(sort0=[$1], dir0=[DESC], fetch=[100])\n"
+	"  LogicalFilter(condition=[>($1, 150)])\n"
+	"    LogicalAggregate(group=[{0}], sum_qty=[SUM($1)])\n"
+	"      LogicalProject(l_orderkey=[$0], l_quantity=[$4])\n"
+	"        LogicalTableScan(table=[[main, lineitem]])")
+	->Unit(benchmark::kMillisecond)
+	->UseRealTime();
+
+// Shipping priority: customer, orders and lineitem joined after their filters, the top 10 orders by revenue
+BENCHMARK_CAPTURE(BM_tpch_query,
+	q3,
+	"LogicalSort(sort0=[$1], sort1=[$2], dir0=[DESC], dir1=[ASC], fetch=[10])\n"
+	"  LogicalProject(l_orderkey=[$0], revenue=[$3], o_orderdate=[$1], o_shippriority=[$2])\n"
+	"    LogicalAggregate(group=[{0, 1, 2}], revenue=[SUM($3)])\n"
+	"      LogicalProject(l_orderkey=[$9], o_orderdate=[$7], o_shippriority=[$8], $f3=[*($14, -(1, $15))])\n"
+	"        LogicalJoin(condition=[=($9, $4)], joinType=[inner])\n"
+	"          LogicalJoin(condition=[=($0, $5)], joinType=[inner])\n"
+	"            LogicalFilter(condition=[=($3, 1)])\n"
+	"              LogicalTableScan(table=[[main, customer]])\n"
+	"            LogicalFilter(condition=[<($3, 9204)])\n"
+	"              LogicalTableScan(table=[[main, orders]])\n"
+	"          LogicalFilter(condition=[>($10, 9204)])\n"
+	"            LogicalTableScan(table=[[main, lineitem]])")
+	->Unit(benchmark::kMillisecond)
+	->UseRealTime();
+
+// Local supplier volume, by region and without supplier: four tables joined over a year of orders
+BENCHMARK_CAPTURE(BM_tpch_query,
+	q5,
+	"LogicalSort(sort0=[$1], dir0=[DESC])\n"
+	"  LogicalAggregate(group=[{0}], revenue=[SUM($1)])\n"
+	"    LogicalProject(n_regionkey=[$5], $f1=[*($16, -(1, $17))])\n"
+	"      LogicalJoin(condition=[=($11, $6)], joinType=[inner])\n"
+	"        LogicalJoin(condition=[=($0, $7)], joinType=[inner])\n"
+	"          LogicalJoin(condition=[=($1, $4)], joinType=[inner])\n"
+	"            LogicalTableScan(table=[[main, customer]])\n"
+	"            LogicalTableScan(table=[[main, nation]])\n"
+	"          LogicalFilter(condition=[AND(>=($3, 8766), <($3, 9131))])\n"
+	"            LogicalTableScan(table=[[main, orders]])\n"
+	"        LogicalTableScan(table=[[main, lineitem]])")
+	->Unit(benchmark::kMillisecond)
+	->UseRealTime();
+
+// Q6 with its quantity predicate moved above the projection, so the filters are split by a computed column
+BENCHMARK_CAPTURE(BM_selection_vectors,
+	filter_project_filter,
+	"LogicalAggregate(group=[{}], revenue=[SUM($0)])\n"
+	"  LogicalFilter(condition=[<($1, 24)])\n"
+	"    LogicalProject($f0=[*($5, $6)], l_quantity=[$4])\n"
+	"      LogicalFilter(condition=[AND(>=($10, 8766), <($10, 9131), >=($6, 0.05), <=($6, 0.07))])\n"
+	"        LogicalTableScan(table=[[main, lineitem]])")
+	->Arg(0)
+	->Arg(1)
+	->Unit(benchmark::kMillisecond)
+	->UseRealTime();
+
+BENCHMARK_CAPTURE(BM_selection_vectors,
+	q1,
+	"LogicalAggregate(group=[{0, 1}], sum_qty=[SUM($2)], sum_base_price=[SUM($3)], sum_disc_price=[SUM($4)], "
+	"sum_charge=[SUM($5)], avg_qty=[AVG($2)], avg_price=[AVG($3)], avg_disc=[AVG($6)], count_order=[COUNT()])\n"
+	"  LogicalProject(l_returnflag=[$8], l_linestatus=[$9], l_quantity=[$4], l_extendedprice=[$5], "
+	"$f4=[*($5, -(1, $6))], $f5=[*(*($5, -(1, $6)), +(1, $7))], l_discount=[$6])\n"
+	"    LogicalFilter(condition=[<=($10, 10471)])\n"
+	"      LogicalTableScan(table=[[main, lineitem]])")
+	->Arg(0)
+	->Arg(1)
+	->Unit(benchmark::kMillisecond)
+	->UseRealTime();
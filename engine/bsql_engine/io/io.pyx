@@ -324,10 +324,10 @@ cpdef runQueryCaller(int masterIndex,  tcpMetadata,  tables,  vector[int] fileTy
           tableSchemaCppArgKeys[tableIndex].push_back(str.encode(key))
           tableSchemaCppArgValues[tableIndex].push_back(str.encode(str(value)))
  
-      # if table.row_groups_ids is not None:
-      #   currentTableSchemaCpp.row_groups_ids = table.row_groups_ids
-      # else:
-      #   currentTableSchemaCpp.row_groups_ids = []
+      if table.row_groups_ids is not None:
+        currentTableSchemaCpp.row_groups_ids = table.row_groups_ids
+      else:
+        currentTableSchemaCpp.row_groups_ids = []
 
       tableSchemaCpp.push_back(currentTableSchemaCpp);
       tableIndex = tableIndex + 1
@@ -6,6 +6,7 @@
 struct ResultSet {
 	std::vector<gdf_column *> columns;
 	std::vector<std::string> names;
+	std::string profile;  // what every operator of the query did, as JSON
 };
 
 struct SkipDataResultSet {
@@ -4,6 +4,7 @@
 #include <blazingdb/io/Util/StringUtil.h>
 
 #include <algorithm>
+#include <atomic>
 #include <regex>
 #include <set>
 #include <string>
@@ -18,10 +19,13 @@
 #include "ResultSetRepository.h"
 #include "Traits/RuntimeTraits.h"
 #include "Utils.cuh"
+#include "communication/CommunicationData.h"
 #include "communication/network/Server.h"
 #include "config/GPUManager.cuh"
+#include "cuDF/Allocator.h"
 #include "cuDF/safe_nvcategory_gather.hpp"
 #include "cudf/legacy/binaryop.hpp"
+#include "distribution/primitives.h"
 #include "io/DataLoader.h"
 #include "legacy/groupby.hpp"
 #include "legacy/reduction.hpp"
@@ -36,6 +40,8 @@
 #include <cudf/legacy/table.hpp>
 #include <rmm/thrust_rmm_allocator.h>
 #include "parser/expression_tree.hpp"
+#include "profile/QueryProfile.h"
+#include "profile/QueryTrace.h"
 
 const std::string LOGICAL_JOIN_TEXT = "LogicalJoin";
 const std::string LOGICAL_UNION_TEXT = "LogicalUnion";
@@ -76,6 +82,23 @@ int count_string_occurrence(std::string haystack, std::string needle) {
 	return count;
 }
 
+// The relational operator of a line of the plan, "LogicalJoin" for "  LogicalJoin(condition=[...])". The memory of the
+// query is accounted to it together with its depth in the plan.
+std::string get_operator_name(const std::string & query_part, int call_depth) {
+	size_t start = query_part.find_first_not_of(' ');
+	if(start == std::string::npos) {
+		start = 0;
+	}
+	return query_part.substr(start, query_part.find('(', start) - start) + " (depth " + std::to_string(call_depth) +
+		   ")";
+}
+
+// the relational expression of a line of the plan, without the indentation of its depth
+std::string get_relational_expression(const std::string & query_part) {
+	size_t start = query_part.find_first_not_of(' ');
+	return start == std::string::npos ? "" : query_part.substr(start);
+}
+
 bool is_double_input(std::string query_part) {
 	if(ral::operators::is_join(query_part)) {
 		return true;
@@ -113,6 +136,92 @@ std::string extract_table_name(std::string query_part) {
 	return table_name;
 }
 
+namespace {
+
+// An expression of a projection that has to be computed by the interpreter
+struct project_expression {
+	size_t position;
+	std::string expression;
+	std::string name;
+	gdf_dtype output_type;
+	std::vector<size_t> inputs;
+	expression_register_usage registers;
+};
+
+// Packs the expressions into as few interpreter kernels as the register budget allows. Inputs are loaded once per
+// kernel, so each kernel greedily takes the expression that adds the fewest inputs it is not already loading.
+std::vector<std::vector<size_t>> schedule_project_passes(
+	const std::vector<project_expression> & expressions, size_t num_frame_columns) {
+	std::vector<std::vector<size_t>> passes;
+	std::vector<bool> scheduled(expressions.size(), false);
+	size_t num_scheduled = 0;
+
+	while(num_scheduled < expressions.size()) {
+		std::vector<size_t> pass;
+		std::vector<bool> pass_inputs(num_frame_columns, false);
+		size_t num_pass_inputs = 0;
+		size_t num_new_inputs = 0;
+		size_t max_temp_registers = 0;
+
+		while(true) {
+			size_t best = expressions.size();
+			size_t best_added_inputs = 0;
+			for(size_t i = 0; i < expressions.size(); i++) {
+				if(scheduled[i]) {
+					continue;
+				}
+
+				const project_expression & expression = expressions[i];
+				size_t added_inputs = 0;
+				for(size_t input_index : expression.inputs) {
+					if(!pass_inputs[input_index]) {
+						added_inputs++;
+					}
+				}
+
+				// registers are laid out as inputs, then one per output, then temps which every expression reuses
+				size_t registers = num_pass_inputs + added_inputs + num_new_inputs + expression.registers.new_inputs +
+								   pass.size() + 1 +
+								   std::max(max_temp_registers, static_cast<size_t>(expression.registers.temp_registers));
+				if(registers <= static_cast<size_t>(MAX_INTERPRETER_REGISTERS) &&
+					(best == expressions.size() || added_inputs < best_added_inputs)) {
+					best = i;
+					best_added_inputs = added_inputs;
+				}
+			}
+			if(best == expressions.size()) {
+				break;
+			}
+
+			const project_expression & expression = expressions[best];
+			for(size_t input_index : expression.inputs) {
+				if(!pass_inputs[input_index]) {
+					pass_inputs[input_index] = true;
+					num_pass_inputs++;
+				}
+			}
+			num_new_inputs += expression.registers.new_inputs;
+			max_temp_registers = std::max(max_temp_registers, static_cast<size_t>(expression.registers.temp_registers));
+			pass.push_back(best);
+			scheduled[best] = true;
+			num_scheduled++;
+		}
+
+		if(pass.empty()) {
+			size_t unscheduled = std::find(scheduled.begin(), scheduled.end(), false) - scheduled.begin();
+			throw std::runtime_error("In parse_project_plan function: expression " +
+									 expressions[unscheduled].expression +
+									 " needs more registers than the interpreter supports");
+		}
+		std::sort(pass.begin(), pass.end());
+		passes.push_back(pass);
+	}
+
+	return passes;
+}
+
+}  // namespace
+
 project_plan_params parse_project_plan(blazing_frame & input, std::string query_part) {
 	gdf_error err = GDF_SUCCESS;
 
@@ -127,26 +236,15 @@ project_plan_params parse_project_plan(blazing_frame & input, std::string query_
 
 	// now we have a vector
 	// x=[$0
-	std::vector<bool> input_used_in_output(input.get_width(), false);
-
 	std::vector<gdf_column_cpp> columns(expressions.size());
-	std::vector<std::string> names(expressions.size());
-
-
-	std::vector<column_index_type> final_output_positions;
-	std::vector<gdf_column *> output_columns;
-	std::vector<gdf_column *> input_columns;
 
 	// TODO: some of this code could be used to extract columns
 	// that will be projected to make the csv and parquet readers
 	// be able to ignore columns that are not
 	gdf_dtype max_temp_type = GDF_invalid;
-	std::vector<gdf_dtype> output_type_expressions(
-		expressions.size());  // contains output types for columns that are expressions, if they are not expressions we
-							  // skip over it
 
-	size_t num_expressions_out = 0;
-	std::vector<bool> input_used_in_expression(input.get_size_column(), false);
+	std::vector<project_expression> computed_expressions;
+	bool only_pass_through = true;
 
 	for(int i = 0; i < expressions.size(); i++) {  // last not an expression
 		std::string expression = expressions[i].substr(
@@ -155,7 +253,22 @@ project_plan_params parse_project_plan(blazing_frame & input, std::string query_
 		std::string name = expressions[i].substr(0, expressions[i].find("=["));
 
 		if(contains_evaluation(expression)) {
-			output_type_expressions[i] = get_output_type_expression(&input, &max_temp_type, expression);
+			// IN lists are evaluated up front so they don't take registers as long chains of comparisons
+			expression = evaluate_in_lists(input, expression);
+			if(!contains_evaluation(expression)) {
+				// the whole expression was an IN list, its result is already a column
+				gdf_column_cpp output = input.get_column(get_index(expression));
+				if(input.has_selection()) {
+					output = input.gather_selected(output);
+				}
+				output.set_name(name);
+				columns[i] = output;
+				only_pass_through = false;
+				continue;
+			}
+
+			project_expression computed{static_cast<size_t>(i), expression, name};
+			computed.output_type = get_output_type_expression(&input, &max_temp_type, expression);
 
 			// todo put this into its own function
 			std::string clean_expression = clean_calcite_expression(expression);
@@ -165,172 +278,205 @@ project_plan_params parse_project_plan(blazing_frame & input, std::string query_
 			for(std::string token : tokens) {
 				if(!is_operator_token(token) && !is_literal(token)) {
 					size_t index = get_index(token);
-					input_used_in_expression[index] = true;
+					if(std::find(computed.inputs.begin(), computed.inputs.end(), index) == computed.inputs.end()) {
+						computed.inputs.push_back(index);
+					}
 				}
 			}
-			num_expressions_out++;
+			computed.registers = get_expression_register_usage(tokens);
+			computed_expressions.push_back(computed);
+			only_pass_through = false;
+		} else if(is_literal(clean_calcite_expression(expression))) {
+			only_pass_through = false;
 		}
 	}
 
-	// create allocations for output on seperate thread
+	// literals and pass through columns never go through the interpreter
+	for(int i = 0; i < expressions.size(); i++) {
+		std::string expression = expressions[i].substr(
+			expressions[i].find("=[") + 2, (expressions[i].size() - expressions[i].find("=[")) - 3);
+
+		std::string name = expressions[i].substr(0, expressions[i].find("=["));
 
-	std::vector<column_index_type> new_column_indices(input_used_in_expression.size());
-	for(int i = 0; i < input_used_in_expression.size(); i++) {
-		if(input_used_in_expression[i]) {
-			new_column_indices[i] = input_columns.size();
-			input_columns.push_back(input.get_column(i).get_gdf_column());
-		} else {
-			new_column_indices[i] = -1;  // won't be uesd anyway
+		if(contains_evaluation(expression)) {
+			continue;
 		}
-	}
 
-	// TODO: this shit is all super hacky in here we should clean it up
-	std::vector<column_index_type> left_inputs;
-	std::vector<column_index_type> right_inputs;
-	std::vector<column_index_type> outputs;
+		// TODO percy this code is duplicated inside get_index, refactor get_index
+		const std::string cleaned_expression = clean_calcite_expression(expression);
+		const bool is_literal_col = is_literal(cleaned_expression);
 
-	std::vector<gdf_binary_operator_exp> operators;
-	std::vector<gdf_unary_operator> unary_operators;
+		if(is_literal_col) {
+			gdf_dtype col_type = infer_dtype_from_literal(cleaned_expression);
+			gdf_column_cpp output;
 
+			if(col_type == GDF_STRING_CATEGORY) {
+				const std::string literal_expression = cleaned_expression.substr(1, cleaned_expression.size() - 2);
+				NVCategory * new_category = repeated_string_category(literal_expression, size);
+				output.create_gdf_column(new_category, size, name);
+			} else {
+				// TODO Percy Rommel Jean Pierre improve timestamp resolution
+				gdf_dtype_extra_info extra_info;
+				extra_info.category = nullptr;
+				extra_info.time_unit = (col_type == GDF_DATE64 || col_type == GDF_TIMESTAMP
+											? TIME_UNIT_ms
+											: TIME_UNIT_NONE);  // TODO this should not be hardcoded
+
+				int column_width = ral::traits::get_dtype_size_in_bytes(col_type);
+				output.create_gdf_column(col_type, extra_info, size, nullptr, column_width);
+				gdf_scalar literal_scalar = get_scalar_from_string(cleaned_expression, col_type, extra_info);
+				output.set_name(name);
+				cudf::fill(output.get_gdf_column(), literal_scalar, 0, size);
+			}
 
-	std::vector<gdf_scalar> left_scalars;
-	std::vector<gdf_scalar> right_scalars;
-	size_t cur_expression_out = 0;
-	for(int i = 0; i < expressions.size(); i++) {  // last not an expression
-		std::string expression = expressions[i].substr(
-			expressions[i].find("=[") + 2, (expressions[i].size() - expressions[i].find("=[")) - 3);
+			columns[i] = output;
+		} else {
+			// pass through columns share the input buffers instead of being cloned
+			int index = get_index(expression);
+			gdf_column_cpp output = input.get_column(index);
+			if(input.has_selection() && !only_pass_through) {
+				// computed columns only have the selected rows so this one has to line up with them
+				output = input.gather_selected(output);
+			}
+			output.set_name(name);
+			columns[i] = output;
+		}
+	}
 
-		std::string name = expressions[i].substr(0, expressions[i].find("=["));
+	std::vector<project_plan_pass> passes;
+	for(const std::vector<size_t> & pass_expressions :
+		schedule_project_passes(computed_expressions, input.get_size_column())) {
+		project_plan_pass pass;
 
-		if(contains_evaluation(expression)) {
-			final_output_positions.push_back(input_columns.size() + final_output_positions.size());
+		// the frame grows with the string columns materialized by add_expression_to_plan
+		std::vector<bool> input_used_in_pass(input.get_size_column(), false);
+		for(size_t expression_index : pass_expressions) {
+			for(size_t input_index : computed_expressions[expression_index].inputs) {
+				input_used_in_pass[input_index] = true;
+			}
+		}
+
+		pass.new_column_indices.resize(input_used_in_pass.size());
+		for(int i = 0; i < input_used_in_pass.size(); i++) {
+			if(input_used_in_pass[i]) {
+				pass.new_column_indices[i] = pass.input_columns.size();
+				pass.input_columns.push_back(input.get_column(i).get_gdf_column());
+			} else {
+				pass.new_column_indices[i] = -1;  // won't be uesd anyway
+			}
+		}
+
+		for(size_t cur_expression_out = 0; cur_expression_out < pass_expressions.size(); cur_expression_out++) {
+			const project_expression & computed = computed_expressions[pass_expressions[cur_expression_out]];
+			pass.final_output_positions.push_back(pass.input_columns.size() + pass.final_output_positions.size());
 
 			// TODO Percy Rommel Jean Pierre improve timestamp resolution
 			gdf_dtype_extra_info extra_info;
 			extra_info.category = nullptr;
 			extra_info.time_unit =
-				(output_type_expressions[i] == GDF_TIMESTAMP ? TIME_UNIT_ms
-															 : TIME_UNIT_NONE);  // TODO this should not be hardcoded
+				(computed.output_type == GDF_TIMESTAMP ? TIME_UNIT_ms
+													   : TIME_UNIT_NONE);  // TODO this should not be hardcoded
 
 			// assumes worst possible case allocation for output
 			// TODO: find a way to know what our output size will be
 			gdf_column_cpp output;
-			output.create_gdf_column(output_type_expressions[i],
+			output.create_gdf_column(computed.output_type,
 				extra_info,
 				size,
 				nullptr,
-				ral::traits::get_dtype_size_in_bytes(output_type_expressions[i]),
-				name);
+				ral::traits::get_dtype_size_in_bytes(computed.output_type),
+				computed.name);
 
-			output_columns.push_back(output.get_gdf_column());
+			pass.output_columns.push_back(output.get_gdf_column());
 
 			add_expression_to_plan(input,
-				input_columns,
-				expression,
+				pass.input_columns,
+				computed.expression,
 				cur_expression_out,
-				num_expressions_out,
-				input_columns.size(),
-				left_inputs,
-				right_inputs,
-				outputs,
-				operators,
-				unary_operators,
-				left_scalars,
-				right_scalars,
-				new_column_indices,
-				final_output_positions,
+				pass_expressions.size(),
+				pass.input_columns.size(),
+				pass.left_inputs,
+				pass.right_inputs,
+				pass.outputs,
+				pass.operators,
+				pass.unary_operators,
+				pass.left_scalars,
+				pass.right_scalars,
+				pass.new_column_indices,
+				pass.final_output_positions,
 				output.get_gdf_column());
-			cur_expression_out++;
-			columns[i] = output;
-		} else {
-			// TODO percy this code is duplicated inside get_index, refactor get_index
-			const std::string cleaned_expression = clean_calcite_expression(expression);
-			const bool is_literal_col = is_literal(cleaned_expression);
+			columns[computed.position] = output;
+		}
 
-			if(is_literal_col) {
-				int index = i;
-				gdf_dtype col_type = infer_dtype_from_literal(cleaned_expression);
+		passes.push_back(pass);
+	}
 
-				// NOTE percy this is a literal so the extra info it doesnt matters
-				gdf_dtype_extra_info extra_info;
-				extra_info.time_unit = TIME_UNIT_ms;
-
-				output_type_expressions[i] = col_type;
-				gdf_column_cpp output;
-
-				if(col_type == GDF_STRING_CATEGORY) {
-					const std::string literal_expression = cleaned_expression.substr(1, cleaned_expression.size() - 2);
-					NVCategory * new_category = repeated_string_category(literal_expression, size);
-					output.create_gdf_column(new_category, size, name);
-				} else {
-					// TODO Percy Rommel Jean Pierre improve timestamp resolution
-					gdf_dtype_extra_info extra_info;
-					extra_info.category = nullptr;
-					extra_info.time_unit = (col_type == GDF_DATE64 || col_type == GDF_TIMESTAMP
-												? TIME_UNIT_ms
-												: TIME_UNIT_NONE);  // TODO this should not be hardcoded
-
-					int column_width = ral::traits::get_dtype_size_in_bytes(col_type);
-					output.create_gdf_column(col_type, extra_info, size, nullptr, column_width);
-					gdf_scalar literal_scalar = get_scalar_from_string(cleaned_expression, col_type, extra_info);
-					output.set_name(name);
-					cudf::fill(output.get_gdf_column(), literal_scalar, 0, size);
-				}
+	// free_gdf_column(&temp);
+	return project_plan_params{computed_expressions.size(), passes, columns, only_pass_through, err};
+}
 
-				output_columns.push_back(output.get_gdf_column());
-				input_used_in_output[index] = false;
-				columns[i] = output;
-			} else {
-				int index = get_index(expression);
-				gdf_column_cpp output = input.get_column(index);
-				output.set_name(name);
-				input_used_in_output[index] = true;
-				columns[i] = output;
+size_t perform_project_plan(project_plan_params & params, gdf_column * input_selection) {
+	size_t bytes_read = 0;
+	for(project_plan_pass & pass : params.passes) {
+		perform_operation(pass.output_columns,
+			pass.input_columns,
+			pass.left_inputs,
+			pass.right_inputs,
+			pass.outputs,
+			pass.final_output_positions,
+			pass.operators,
+			pass.unary_operators,
+			pass.left_scalars,
+			pass.right_scalars,
+			pass.new_column_indices,
+			input_selection);
+
+		gdf_size_type num_rows = input_selection != nullptr ? input_selection->size : pass.input_columns[0]->size;
+		for(gdf_column * column : pass.input_columns) {
+			bytes_read += num_rows * ral::traits::get_dtype_size_in_bytes(column);
+			if(column->valid != nullptr) {
+				bytes_read += ral::traits::get_bitmask_size_in_bytes(num_rows);
 			}
 		}
+		if(input_selection != nullptr) {
+			bytes_read += num_rows * ral::traits::get_dtype_size_in_bytes(input_selection);
+		}
 	}
-
-	// free_gdf_column(&temp);
-	return project_plan_params{num_expressions_out,
-		output_columns,
-		input_columns,
-		left_inputs,
-		right_inputs,
-		outputs,
-		final_output_positions,
-		operators,
-		unary_operators,
-		left_scalars,
-		right_scalars,
-		new_column_indices,
-		columns,
-		err};
+	return bytes_read;
 }
 
-void execute_project_plan(blazing_frame & input, std::string query_part) {
+void execute_project_plan(blazing_frame & input, std::string query_part, Context * context) {
+	CodeTimer timer;
 	project_plan_params params = parse_project_plan(input, query_part);
 
+	// a projection that only reorders columns keeps the selection pending, otherwise its outputs are already dense
+	gdf_column_cpp selection = input.get_selection();
+	bool keep_selection = input.has_selection() && params.only_pass_through;
+
 	// perform operations
+	size_t bytes_read = 0;
 	if(params.num_expressions_out > 0) {
-		size_t size = params.input_columns[0]->size;
+		size_t size = input.get_num_rows_in_table(0);
 
 		if(size > 0) {
-			perform_operation(params.output_columns,
-				params.input_columns,
-				params.left_inputs,
-				params.right_inputs,
-				params.outputs,
-				params.final_output_positions,
-				params.operators,
-				params.unary_operators,
-				params.left_scalars,
-				params.right_scalars,
-				params.new_column_indices);
+			bytes_read = perform_project_plan(params, input.has_selection() ? selection.get_gdf_column() : nullptr);
 		}
 	}
 
+	if(context != nullptr && params.num_expressions_out > 0) {
+		Library::Logging::Logger().logInfo(timer.logDuration(*context,
+			"Project interpreter passes",
+			"passes",
+			params.passes.size(),
+			"bytes read",
+			bytes_read));
+	}
+
 	input.clear();
 	input.add_table(params.columns);
+	if(keep_selection) {
+		input.set_selection(selection);
+	}
 
 	for(size_t i = 0; i < input.get_width(); i++) {
 		input.get_column(i).update_null_count();
@@ -452,10 +598,31 @@ void split_inequality_join_into_join_and_filter(const std::string & join_stateme
 }
 
 
-//TODO: this does not compact the allocations which would be nice if it could
+// Gathers the rows still selected by earlier filters before handing the frame to an operator that needs dense columns
+void materialize_selection(Context * context, blazing_frame & input, const std::string & consumer) {
+	if(!input.has_selection()) {
+		return;
+	}
+
+	CodeTimer timer;
+	size_t bytes_copied = input.materialize();
+	Library::Logging::Logger().logInfo(timer.logDuration(*context,
+		"materialize selection for " + consumer,
+		"num rows",
+		input.get_num_rows_in_table(0),
+		"bytes copied",
+		bytes_copied));
+}
+
+static std::atomic<bool> filter_selection_vectors{true};
+
+void set_filter_selection_vectors(bool enabled) { filter_selection_vectors = enabled; }
+
+bool get_filter_selection_vectors() { return filter_selection_vectors; }
+
+// Leaves the filtered rows as a selection on the frame instead of copying every column
 void process_filter(Context * context, blazing_frame & input, std::string query_part){
-	static CodeTimer timer;
-	timer.reset();
+	CodeTimer timer;
 
 	size_t size = input.get_num_rows_in_table(0);
 	if(size <= 0) {
@@ -486,32 +653,34 @@ void process_filter(Context * context, blazing_frame & input, std::string query_
 		timer.logDuration(*context, "Filter part 2 evaluate expression", "num rows", input.get_num_rows_in_table(0)));
 	timer.reset();
 
-	gdf_column_cpp index_col;
-	std::string empty = "";
-	index_col.create_gdf_column(GDF_INT32,
+	// Only the row indices that pass the filter are kept, the columns themselves are gathered once by whichever
+	// operator needs them dense (see materialize_selection)
+	gdf_column_cpp selection;
+	selection.create_gdf_column(GDF_INT32,
 		gdf_dtype_extra_info{TIME_UNIT_NONE, nullptr},
-		input.get_num_rows_in_table(0),
+		stencil.size(),
 		nullptr,
 		ral::traits::get_dtype_size_in_bytes(GDF_INT32),
-		empty);
-	gdf_sequence(static_cast<int32_t *>(index_col.get_gdf_column()->data), input.get_num_rows_in_table(0), 0);
-
-	std::vector<gdf_column_cpp> intputToFilterTemp = input.get_table(0);
-	cudf::table inputToFilter = ral::utilities::create_table(intputToFilterTemp);
-	cudf::table filteredData = cudf::apply_boolean_mask(inputToFilter, *(stencil.get_gdf_column()));
-	ral::init_string_category_if_null(filteredData);
-
-	for(int i = 0; i < input.get_width(); i++) {
-		gdf_column * temp_col_view = filteredData.get_column(i);
-		gdf_column_cpp temp;
-		temp.create_gdf_column(filteredData.get_column(i));
-		temp.set_name(input.get_column(i).name());
-		input.set_column(i, temp);
-	}
-
-	Library::Logging::Logger().logInfo(
-		timer.logDuration(*context, "Filter part 3 apply_boolean_mask", "num rows", input.get_num_rows_in_table(0)));
+		"");
+	gdf_size_type num_selected_rows = compact_selection(stencil.get_gdf_column(),
+		input.has_selection() ? input.get_selection().get_gdf_column() : nullptr,
+		selection.get_gdf_column());
+	selection.resize(num_selected_rows);
+	input.set_selection(selection);
+
+	Library::Logging::Logger().logInfo(timer.logDuration(*context,
+		"Filter part 3 compact selection",
+		"num rows",
+		input.get_num_rows_in_table(0),
+		"bytes copied",
+		num_selected_rows * ral::traits::get_dtype_size_in_bytes(GDF_INT32)));
 	timer.reset();
+
+	if(get_filter_selection_vectors()) {
+		ral::profile::add_bytes_copied(num_selected_rows * ral::traits::get_dtype_size_in_bytes(GDF_INT32));
+	} else {
+		materialize_selection(context, input, "filter");
+	}
 }
 
 // Returns the index from table if exists
@@ -528,10 +697,8 @@ size_t get_table_index(std::vector<std::string> table_names, std::string table_n
 	}
 }
 
-// TODO: if a table needs to be used more than once you need to include it twice
-// i know that kind of sucks, its for the 0 copy stuff, this can easily be remedied
-// by changings scan to make copies
-blazing_frame evaluate_split_query(std::vector<std::vector<gdf_column_cpp>> input_tables,
+// Runs the operator on top of query, evaluating its inputs through evaluate_split_query
+blazing_frame evaluate_operator(std::vector<std::vector<gdf_column_cpp>> input_tables,
 	std::vector<std::string> table_names,
 	std::vector<std::vector<std::string>> column_names,
 	std::vector<std::string> query,
@@ -549,6 +716,7 @@ blazing_frame evaluate_split_query(std::vector<std::vector<gdf_column_cpp>> inpu
 			blazing_frame scan_frame;
 			// EnumerableTableScan(table=[[hr, joiner]])
 			scan_frame.add_table(input_tables[get_table_index(table_names, extract_table_name(query[0]))]);
+			ral::profile::add_rows_in(scan_frame.get_num_rows_in_table(0));
 			return scan_frame;
 		} else {
 			// i dont think there are any other type of end nodes at the moment
@@ -589,6 +757,8 @@ blazing_frame evaluate_split_query(std::vector<std::vector<gdf_column_cpp>> inpu
 		if(ral::operators::is_join(query[0])) {
 			// we know that left and right are dataframes we want to join together
 			blazing_timer.reset();  // doing a reset before to not include other calls to evaluate_split_query
+			materialize_selection(queryContext, left_frame, "join");
+			materialize_selection(queryContext, right_frame, "join");
 			int numLeft = left_frame.get_num_rows_in_table(0);
 			int numRight = right_frame.get_num_rows_in_table(0);
 			left_frame.add_table(right_frame.get_table(0));
@@ -607,6 +777,8 @@ blazing_frame evaluate_split_query(std::vector<std::vector<gdf_column_cpp>> inpu
 			// TODO: append the frames to each other
 			// return right_frame;//!!
 			blazing_timer.reset();  // doing a reset before to not include other calls to evaluate_split_query
+			materialize_selection(queryContext, left_frame, "union");
+			materialize_selection(queryContext, right_frame, "union");
 			int numLeft = left_frame.get_num_rows_in_table(0);
 			int numRight = right_frame.get_num_rows_in_table(0);
 			result_frame = process_union(left_frame, right_frame, query[0]);
@@ -634,15 +806,19 @@ blazing_frame evaluate_split_query(std::vector<std::vector<gdf_column_cpp>> inpu
 		// process self
 		if(is_project(query[0])) {
 			blazing_timer.reset();  // doing a reset before to not include other calls to evaluate_split_query
-			execute_project_plan(child_frame, query[0]);
+			execute_project_plan(child_frame, query[0], queryContext);
 			Library::Logging::Logger().logInfo(blazing_timer.logDuration(*queryContext,
 				"evaluate_split_query process_project",
 				"num rows",
 				child_frame.get_num_rows_in_table(0)));
 			blazing_timer.reset();
+			if(call_depth == 0) {
+				materialize_selection(queryContext, child_frame, "result");
+			}
 			return child_frame;
 		} else if(ral::operators::is_aggregate(query[0])) {
 			blazing_timer.reset();  // doing a reset before to not include other calls to evaluate_split_query
+			materialize_selection(queryContext, child_frame, "aggregate");
 			ral::operators::process_aggregate(child_frame, query[0], queryContext);
 			Library::Logging::Logger().logInfo(blazing_timer.logDuration(*queryContext,
 				"evaluate_split_query process_aggregate",
@@ -652,6 +828,7 @@ blazing_frame evaluate_split_query(std::vector<std::vector<gdf_column_cpp>> inpu
 			return child_frame;
 		} else if(ral::operators::is_sort(query[0])) {
 			blazing_timer.reset();  // doing a reset before to not include other calls to evaluate_split_query
+			materialize_selection(queryContext, child_frame, "sort");
 			ral::operators::process_sort(child_frame, query[0], queryContext);
 			Library::Logging::Logger().logInfo(blazing_timer.logDuration(
 				*queryContext, "evaluate_split_query process_sort", "num rows", child_frame.get_num_rows_in_table(0)));
@@ -665,6 +842,9 @@ blazing_frame evaluate_split_query(std::vector<std::vector<gdf_column_cpp>> inpu
 				"num rows",
 				child_frame.get_num_rows_in_table(0)));
 			blazing_timer.reset();
+			if(call_depth == 0) {
+				materialize_selection(queryContext, child_frame, "result");
+			}
 			return child_frame;
 		} else {
 			throw std::runtime_error{"In evaluate_split_query function: unsupported query operator"};
@@ -673,12 +853,43 @@ blazing_frame evaluate_split_query(std::vector<std::vector<gdf_column_cpp>> inpu
 	}
 }
 
+// TODO: if a table needs to be used more than once you need to include it twice
+// i know that kind of sucks, its for the 0 copy stuff, this can easily be remedied
+// by changings scan to make copies
+blazing_frame evaluate_split_query(std::vector<std::vector<gdf_column_cpp>> input_tables,
+	std::vector<std::string> table_names,
+	std::vector<std::vector<std::string>> column_names,
+	std::vector<std::string> query,
+	Context * queryContext,
+	int call_depth) {
+	// the children open their own scopes while they run, what this operator allocates and spends afterwards is
+	// accounted to it
+	cuDF::Allocator::memory_scope operator_scope(
+		queryContext->getMemoryTracker(), get_operator_name(query[0], call_depth));
+	ral::profile::operator_scope profile_scope(get_relational_expression(query[0]));
+	ral::profile::trace_scope operator_span(
+		queryContext->getContextToken(), ral::profile::span_kind::OPERATOR, get_operator_name(query[0], call_depth));
+
+	blazing_frame output_frame =
+		evaluate_operator(input_tables, table_names, column_names, query, queryContext, call_depth);
+	profile_scope.set_rows_out(output_frame.get_num_rows_in_table(0));
+	return output_frame;
+}
+
 blazing_frame evaluate_split_query(std::vector<ral::io::data_loader> input_loaders,
 	std::vector<ral::io::Schema> schemas,
 	std::vector<std::string> table_names,
 	std::vector<std::string> query,
 	Context * queryContext,
-	int call_depth = 0) {
+	int call_depth = 0);
+
+// Runs the operator on top of query, evaluating its inputs through evaluate_split_query
+blazing_frame evaluate_operator(std::vector<ral::io::data_loader> input_loaders,
+	std::vector<ral::io::Schema> schemas,
+	std::vector<std::string> table_names,
+	std::vector<std::string> query,
+	Context * queryContext,
+	int call_depth) {
 	assert(input_loaders.size() == table_names.size());
 
 	CodeTimer blazing_timer;
@@ -723,6 +934,7 @@ blazing_frame evaluate_split_query(std::vector<ral::io::data_loader> input_loade
 					}
 				}
 				int num_rows = input_table.size() > 0 ? input_table[0].size() : 0;
+				ral::profile::add_rows_in(num_rows);
 				Library::Logging::Logger().logInfo(
 					blazing_timer.logDuration(*queryContext, "evaluate_split_query load_data", "num rows", num_rows));
 				blazing_timer.reset();
@@ -736,12 +948,16 @@ blazing_frame evaluate_split_query(std::vector<ral::io::data_loader> input_loade
 						scan_frame.get_num_rows_in_table(0)));
 					blazing_timer.reset();
 					queryContext->incrementQueryStep();
+					if(call_depth == 0) {
+						materialize_selection(queryContext, scan_frame, "result");
+					}
 					return scan_frame;
 				}
 			} else {
 				blazing_timer.reset();  // doing a reset before to not include other calls to evaluate_split_query
 				input_loaders[table_index].load_data(*queryContext, input_table, {}, schemas[table_index]);
 				int num_rows = input_table.size() > 0 ? input_table[0].size() : 0;
+				ral::profile::add_rows_in(num_rows);
 				Library::Logging::Logger().logInfo(
 					blazing_timer.logDuration(*queryContext, "evaluate_split_query load_data", "num rows", num_rows));
 				blazing_timer.reset();
@@ -790,6 +1006,8 @@ blazing_frame evaluate_split_query(std::vector<ral::io::data_loader> input_loade
 		if(ral::operators::is_join(query[0])) {
 			blazing_timer.reset();  // doing a reset before to not include other calls to evaluate_split_query
 			// we know that left and right are dataframes we want to join together
+			materialize_selection(queryContext, left_frame, "join");
+			materialize_selection(queryContext, right_frame, "join");
 			int numLeft = left_frame.get_num_rows_in_table(0);
 			int numRight = right_frame.get_num_rows_in_table(0);
 			left_frame.add_table(right_frame.get_table(0));
@@ -806,12 +1024,17 @@ blazing_frame evaluate_split_query(std::vector<ral::io::data_loader> input_loade
 				Library::Logging::Logger().logInfo(blazing_timer.logDuration(*queryContext, "evaluate_split_query inequality join process_filter", "num rows", result_frame.get_num_rows_in_table(0)));
 				blazing_timer.reset();
 				queryContext->incrementQueryStep();
+				if(call_depth == 0) {
+					materialize_selection(queryContext, result_frame, "result");
+				}
 			}
 			return result_frame;
 		} else if(is_union(query[0])) {
 			blazing_timer.reset();  // doing a reset before to not include other calls to evaluate_split_query
 			// TODO: append the frames to each other
 			// return right_frame;//!!
+			materialize_selection(queryContext, left_frame, "union");
+			materialize_selection(queryContext, right_frame, "union");
 			int numLeft = left_frame.get_num_rows_in_table(0);
 			int numRight = right_frame.get_num_rows_in_table(0);
 			result_frame = process_union(left_frame, right_frame, query[0]);
@@ -840,16 +1063,20 @@ blazing_frame evaluate_split_query(std::vector<ral::io::data_loader> input_loade
 		// process self
 		if(is_project(query[0])) {
 			blazing_timer.reset();  // doing a reset before to not include other calls to evaluate_split_query
-			execute_project_plan(child_frame, query[0]);
+			execute_project_plan(child_frame, query[0], queryContext);
 			Library::Logging::Logger().logInfo(blazing_timer.logDuration(*queryContext,
 				"evaluate_split_query process_project",
 				"num rows",
 				child_frame.get_num_rows_in_table(0)));
 			blazing_timer.reset();
 			queryContext->incrementQueryStep();
+			if(call_depth == 0) {
+				materialize_selection(queryContext, child_frame, "result");
+			}
 			return child_frame;
 		} else if(ral::operators::is_aggregate(query[0])) {
 			blazing_timer.reset();  // doing a reset before to not include other calls to evaluate_split_query
+			materialize_selection(queryContext, child_frame, "aggregate");
 			ral::operators::process_aggregate(child_frame, query[0], queryContext);
 			Library::Logging::Logger().logInfo(blazing_timer.logDuration(*queryContext,
 				"evaluate_split_query process_aggregate",
@@ -860,6 +1087,7 @@ blazing_frame evaluate_split_query(std::vector<ral::io::data_loader> input_loade
 			return child_frame;
 		} else if(ral::operators::is_sort(query[0])) {
 			blazing_timer.reset();  // doing a reset before to not include other calls to evaluate_split_query
+			materialize_selection(queryContext, child_frame, "sort");
 			ral::operators::process_sort(child_frame, query[0], queryContext);
 			Library::Logging::Logger().logInfo(blazing_timer.logDuration(
 				*queryContext, "evaluate_split_query process_sort", "num rows", child_frame.get_num_rows_in_table(0)));
@@ -875,6 +1103,9 @@ blazing_frame evaluate_split_query(std::vector<ral::io::data_loader> input_loade
 				child_frame.get_num_rows_in_table(0)));
 			blazing_timer.reset();
 			queryContext->incrementQueryStep();
+			if(call_depth == 0) {
+				materialize_selection(queryContext, child_frame, "result");
+			}
 			return child_frame;
 		} else {
 			throw std::runtime_error{"In evaluate_split_query function: unsupported query operator"};
@@ -883,6 +1114,84 @@ blazing_frame evaluate_split_query(std::vector<ral::io::data_loader> input_loade
 	}
 }
 
+blazing_frame evaluate_split_query(std::vector<ral::io::data_loader> input_loaders,
+	std::vector<ral::io::Schema> schemas,
+	std::vector<std::string> table_names,
+	std::vector<std::string> query,
+	Context * queryContext,
+	int call_depth) {
+	// the children open their own scopes while they run, what this operator allocates and spends afterwards is
+	// accounted to it
+	cuDF::Allocator::memory_scope operator_scope(
+		queryContext->getMemoryTracker(), get_operator_name(query[0], call_depth));
+	ral::profile::operator_scope profile_scope(get_relational_expression(query[0]));
+	ral::profile::trace_scope operator_span(
+		queryContext->getContextToken(), ral::profile::span_kind::OPERATOR, get_operator_name(query[0], call_depth));
+
+	blazing_frame output_frame =
+		evaluate_operator(input_loaders, schemas, table_names, query, queryContext, call_depth);
+	profile_scope.set_rows_out(output_frame.get_num_rows_in_table(0));
+	return output_frame;
+}
+
+// the profile of a failed query is written too, a profile that could not be written does not fail its query
+void write_query_profile(const Context & context, const ral::profile::query_profile & profile) {
+	try {
+		ral::profile::write_profile(profile);
+	} catch(const std::exception & e) {
+		Library::Logging::Logger().logError(ral::utilities::buildLogString(std::to_string(context.getContextToken()),
+			std::to_string(context.getQueryStep()),
+			std::to_string(context.getQuerySubstep()),
+			std::string("ERROR: ") + e.what()));
+	}
+}
+
+// Traces the query on this node when there is a trace directory
+void start_query_trace(const Context & context) {
+	if(!ral::profile::get_trace_directory().empty()) {
+		using ral::communication::CommunicationData;
+		ral::profile::start_trace(
+			context.getContextToken(), context.getNodeIndex(CommunicationData::getInstance().getSelfNode()));
+	}
+}
+
+// The other nodes send their traces to the master, which writes the trace of the whole query. Called whether the query
+// succeeded or not, the master waits for the trace of every node up to the trace wait.
+void finish_query_trace(const Context & context) {
+	std::shared_ptr<ral::profile::query_trace> trace = ral::profile::end_trace(context.getContextToken());
+	if(trace == nullptr) {
+		return;
+	}
+	try {
+		using ral::communication::CommunicationData;
+		if(context.getTotalNodes() > 1 && !context.isMasterNode(CommunicationData::getInstance().getSelfNode())) {
+			ral::distribution::sendTraceToMaster(context, trace->serialize());
+			return;
+		}
+		if(context.getTotalNodes() > 1) {
+			std::vector<std::vector<char>> node_traces =
+				ral::distribution::collectTraces(context, ral::profile::get_trace_wait());
+			for(const std::vector<char> & node_trace : node_traces) {
+				trace->merge(node_trace.data(), node_trace.size());
+			}
+			if(node_traces.size() < context.getTotalNodes() - 1) {
+				Library::Logging::Logger().logWarn(
+					ral::utilities::buildLogString(std::to_string(context.getContextToken()),
+						std::to_string(context.getQueryStep()),
+						std::to_string(context.getQuerySubstep()),
+						"the trace is missing " + std::to_string(context.getTotalNodes() - 1 - node_traces.size()) +
+							" nodes that did not send theirs in time"));
+			}
+		}
+		ral::profile::write_trace(*trace);
+	} catch(const std::exception & e) {
+		Library::Logging::Logger().logError(ral::utilities::buildLogString(std::to_string(context.getContextToken()),
+			std::to_string(context.getQueryStep()),
+			std::to_string(context.getQuerySubstep()),
+			std::string("ERROR: ") + e.what()));
+	}
+}
+
 query_token_t evaluate_query(std::vector<ral::io::data_loader> input_loaders,
 	std::vector<ral::io::Schema> schemas,
 	std::vector<std::string> table_names,
@@ -898,9 +1207,19 @@ query_token_t evaluate_query(std::vector<ral::io::data_loader> input_loaders,
 			splitted.erase(splitted.end() - 1);
 		}
 
+		Context context = queryContext;
+		if(context.getMemoryTracker()->getBudget() == 0) {
+			context.getMemoryTracker()->setBudget(cuDF::Allocator::get_default_query_memory_budget());
+		}
+
+		start_query_trace(context);
+		auto profile = std::make_shared<ral::profile::query_profile>(context.getContextToken());
 		try {
-			Context context = queryContext;
-			blazing_frame output_frame = evaluate_split_query(input_loaders, schemas, table_names, splitted, &context);
+			blazing_frame output_frame;
+			{
+				ral::profile::query_scope profile_scope(*profile, context.getMemoryTracker());
+				output_frame = evaluate_split_query(input_loaders, schemas, table_names, splitted, &context);
+			}
 
 			// REMOVE any columns that were ipcd to put into the result set
 			for(size_t index = 0; index < output_frame.get_size_column(); index++) {
@@ -913,17 +1232,21 @@ query_token_t evaluate_query(std::vector<ral::io::data_loader> input_loaders,
 			double duration = blazing_timer.getDuration();
 			Library::Logging::Logger().logInfo(blazing_timer.logDuration(queryContext, "Query Execution Done"));
 
-			result_set_repository::get_instance().update_token(token, output_frame, duration);
+			result_set_repository::get_instance().update_token(
+				token, output_frame, duration, "", context.getMemoryTracker(), profile);
 
 			Library::Logging::Logger().logInfo(blazing_timer.logDuration(queryContext, "Query Done"));
 		} catch(const std::exception & e) {
 			std::cerr << "evaluate_split_query error => " << e.what() << '\n';
 			try {
-				result_set_repository::get_instance().update_token(token, blazing_frame{}, 0.0, e.what());
+				result_set_repository::get_instance().update_token(
+					token, blazing_frame{}, 0.0, e.what(), context.getMemoryTracker(), profile);
 			} catch(const std::exception & e) {
 				std::cerr << "error => " << e.what() << '\n';
 			}
 		}
+		write_query_profile(context, *profile);
+		finish_query_trace(context);
 
 		ral::communication::network::Server::getInstance().deregisterContext(queryContext.getContextToken());
 	});
@@ -942,7 +1265,8 @@ blazing_frame evaluate_query(
 		std::vector<std::string> table_names,
 		std::string logicalPlan,
 		connection_id_t connection,
-		Context& queryContext
+		Context& queryContext,
+		std::shared_ptr<const ral::profile::query_profile> * profile_out
 		){
 
 		CodeTimer blazing_timer;
@@ -954,8 +1278,23 @@ blazing_frame evaluate_query(
 			splitted.erase(splitted.end() -1);
 		}
 
+		if (queryContext.getMemoryTracker()->getBudget() == 0) {
+			queryContext.getMemoryTracker()->setBudget(cuDF::Allocator::get_default_query_memory_budget());
+		}
+
+		auto profile = std::make_shared<ral::profile::query_profile>(queryContext.getContextToken());
+		start_query_trace(queryContext);
 		try {
-			blazing_frame output_frame = evaluate_split_query(input_loaders, schemas,table_names, splitted, &queryContext);
+			blazing_frame output_frame;
+			{
+				ral::profile::query_scope profile_scope(*profile, queryContext.getMemoryTracker());
+				output_frame = evaluate_split_query(input_loaders, schemas,table_names, splitted, &queryContext);
+			}
+			write_query_profile(queryContext, *profile);
+			if (profile_out != nullptr) {
+				*profile_out = profile;
+			}
+			finish_query_trace(queryContext);
 			output_frame.deduplicate();
 			for (size_t i=0;i<output_frame.get_width();i++) {
 				if (output_frame.get_column(i).dtype() == GDF_STRING_CATEGORY) {
@@ -984,6 +1323,8 @@ blazing_frame evaluate_query(
 		} catch(const std::exception& e) {
 			std::string err = "ERROR: in evaluate_split_query " + std::string(e.what());
 			Library::Logging::Logger().logError(ral::utilities::buildLogString(std::to_string(queryContext.getContextToken()), std::to_string(queryContext.getQueryStep()), std::to_string(queryContext.getQuerySubstep()), err));
+			write_query_profile(queryContext, *profile);
+			finish_query_trace(queryContext);
 			throw;
 		}
 }
@@ -7,6 +7,7 @@
 #include "Types.h"
 #include "cudf/legacy/binaryop.hpp"
 #include "io/DataLoader.h"
+#include "profile/QueryProfile.h"
 #include <iostream>
 #include <string>
 #include <vector>
@@ -14,8 +15,8 @@
 #include <blazingdb/manager/Context.h>
 using blazingdb::manager::Context;
 
-struct project_plan_params {
-	size_t num_expressions_out;
+// One interpreter kernel of a projection, all its outputs are computed from a single load of its inputs
+struct project_plan_pass {
 	std::vector<gdf_column *> output_columns;
 	std::vector<gdf_column *> input_columns;
 	std::vector<column_index_type> left_inputs;
@@ -27,7 +28,13 @@ struct project_plan_params {
 	std::vector<gdf_scalar> left_scalars;
 	std::vector<gdf_scalar> right_scalars;
 	std::vector<column_index_type> new_column_indices;
+};
+
+struct project_plan_params {
+	size_t num_expressions_out;
+	std::vector<project_plan_pass> passes;  // as few as the interpreter register budget allows
 	std::vector<gdf_column_cpp> columns;
+	bool only_pass_through;  // every output column aliases an input column
 	gdf_error error;
 };
 
@@ -41,18 +48,38 @@ blazing_frame evaluate_split_query(std::vector<std::vector<gdf_column_cpp>> inpu
 
 std::string get_named_expression(std::string query_part, std::string expression_name);
 
-void execute_project_plan(blazing_frame & input, std::string query_part);
+void execute_project_plan(blazing_frame & input, std::string query_part, Context * context = nullptr);
+
+// Whether filters leave the rows they keep as a selection on the frame, the default, or gather every column right away
+// like they did before selections. Only there to measure the bytes each way copies.
+void set_filter_selection_vectors(bool enabled);
+
+bool get_filter_selection_vectors();
 
 project_plan_params parse_project_plan(blazing_frame & input, std::string query_part);
 
+// Runs every pass of the plan and returns the number of input bytes they read
+size_t perform_project_plan(project_plan_params & params, gdf_column * input_selection = nullptr);
+
 void process_project(blazing_frame & input, std::string query_part);
 
+// Runs the query on this thread, what every operator of it did is handed back in profile when it is set
 blazing_frame evaluate_query(std::vector<ral::io::data_loader> input_loaders,
 	std::vector<ral::io::Schema> schemas,
 	std::vector<std::string> table_names,
 	std::string logicalPlan,
 	connection_id_t connection,
-	Context & queryContext);
+	Context & queryContext,
+	std::shared_ptr<const ral::profile::query_profile> * profile = nullptr);
+
+// Runs the query on its own thread and hands its result to the result set repository under token
+query_token_t evaluate_query(std::vector<ral::io::data_loader> input_loaders,
+	std::vector<ral::io::Schema> schemas,
+	std::vector<std::string> table_names,
+	std::string logicalPlan,
+	connection_id_t connection,
+	Context & queryContext,
+	query_token_t token);
 
 void split_inequality_join_into_join_and_filter(const std::string & join_statement, 
  					std::string & new_join_statement, std::string & filter_statement);
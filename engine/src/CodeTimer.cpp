@@ -7,6 +7,7 @@
 
 #include "CodeTimer.h"
 
+#include <blazingdb/io/Library/Logging/BlazingLogger.h>
 #include <iostream>
 
 namespace {
@@ -56,6 +57,10 @@ std::string CodeTimer::logDuration(uint32_t contextToken,
 	int measure,
 	std::string eventExtraInfo2,
 	int measure2) {
+	// every duration is logged as info, nothing to build when info is not logged
+	if(!Library::Logging::BlazingLogger::isEnabled(Library::Logging::LoggingLevel::INFO)) {
+		return std::string();
+	}
 	if(eventExtraInfo != "") {
 		if(eventExtraInfo2 != "")
 			return std::to_string(contextToken) + "|" + std::to_string(query_step) + "|" +
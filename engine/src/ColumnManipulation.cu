@@ -4,12 +4,18 @@
 
 #include "ColumnManipulation.cuh"
 
+#include <algorithm>
+#include <vector>
+
 #include <thrust/functional.h>
 #include <thrust/device_ptr.h>
 #include <thrust/device_vector.h>
 #include <thrust/copy.h>
 #include <thrust/gather.h>
 #include <thrust/remove.h>
+#include <thrust/binary_search.h>
+#include <thrust/fill.h>
+#include <thrust/transform.h>
 #include <thrust/iterator/counting_iterator.h>
 
 #include <thrust/execution_policy.h>
@@ -19,7 +25,10 @@
 #include "Utils.cuh"
 #include "cuDF/safe_nvcategory_gather.hpp"
 #include <cudf/legacy/bitmask.hpp>
+#include <rmm/thrust_rmm_allocator.h>
 #include "Traits/RuntimeTraits.h"
+#include "CalciteExpressionParsing.h"
+#include <nvstrings/NVCategory.h>
 
 
 const size_t NUM_ELEMENTS_PER_THREAD_GATHER_BITS = 32;
@@ -154,3 +163,138 @@ void materialize_column(gdf_column * input, gdf_column * output, gdf_column * ro
 
 	throw std::runtime_error("In materialize_column function: unsupported type");
 }
+
+gdf_size_type compact_selection(gdf_column * stencil, gdf_column * selection_in, gdf_column * selection_out){
+	if(stencil->size == 0){
+		return 0;
+	}
+
+	const bool * stencil_data = static_cast<const bool *>(stencil->data);
+	const gdf_valid_type * stencil_valid = stencil->valid;
+	auto is_selected = [stencil_data, stencil_valid] __device__ (const gdf_index_type i) {
+		return stencil_data[i] &&
+			(stencil_valid == nullptr || ((stencil_valid[i / GDF_VALID_BITSIZE] >> (i % GDF_VALID_BITSIZE)) & 1));
+	};
+
+	gdf_index_type * output_iter = static_cast<gdf_index_type *>(selection_out->data);
+	gdf_index_type * output_end;
+	if(selection_in == nullptr){
+		thrust::counting_iterator<gdf_index_type> row_iter(0);
+		output_end = thrust::copy_if(rmm::exec_policy()->on(0),
+			row_iter, row_iter + stencil->size,
+			row_iter,
+			output_iter,
+			is_selected);
+	}else{
+		const gdf_index_type * selection_data = static_cast<const gdf_index_type *>(selection_in->data);
+		thrust::counting_iterator<gdf_index_type> row_iter(0);
+		output_end = thrust::copy_if(rmm::exec_policy()->on(0),
+			selection_data, selection_data + selection_in->size,
+			row_iter,
+			output_iter,
+			is_selected);
+	}
+	CheckCudaErrors(cudaGetLastError());
+
+	return static_cast<gdf_size_type>(output_end - output_iter);
+}
+
+template <typename T>
+void in_list_membership(gdf_column * input, const std::vector<T> & values, bool negated, gdf_column * output){
+	const T * input_data = static_cast<const T *>(input->data);
+	bool * output_data = static_cast<bool *>(output->data);
+
+	if(values.empty()){
+		thrust::fill(rmm::exec_policy()->on(0), output_data, output_data + input->size, negated);
+	}else{
+		rmm::device_vector<T> sorted_values(values);
+		thrust::binary_search(rmm::exec_policy()->on(0),
+			sorted_values.begin(), sorted_values.end(),
+			input_data, input_data + input->size,
+			output_data);
+		if(negated){
+			thrust::transform(rmm::exec_policy()->on(0),
+				output_data, output_data + input->size,
+				output_data,
+				thrust::logical_not<bool>());
+		}
+	}
+	CheckCudaErrors(cudaGetLastError());
+}
+
+template <typename T>
+bool evaluate_in_list_templated(gdf_column * input, const ral::utilities::in_list & list, gdf_column * output){
+	std::vector<T> values;
+	if(!ral::utilities::parse_in_list_values(list.literals, values)){
+		return false;
+	}
+	in_list_membership(input, values, list.negated, output);
+	return true;
+}
+
+// the category indices of the strings in the list, strings that are not in the category can never match
+bool evaluate_in_list_category(gdf_column * input, const ral::utilities::in_list & list, gdf_column * output){
+	NVCategory * category = static_cast<NVCategory *>(input->dtype_info.category);
+
+	std::vector<nv_category_index_type> values;
+	values.reserve(list.literals.size());
+	for(const std::string & literal : list.literals){
+		if(literal.size() < 2 || literal.front() != '\'' || literal.back() != '\''){
+			return false;
+		}
+		int index = category->get_value(literal.substr(1, literal.size() - 2).c_str());
+		if(index != -1){
+			values.push_back(index);
+		}
+	}
+	std::sort(values.begin(), values.end());
+	values.erase(std::unique(values.begin(), values.end()), values.end());
+
+	in_list_membership(input, values, list.negated, output);
+	return true;
+}
+
+// dates and timestamps are looked up by the values their literals parse to in the comparisons of the interpreter
+bool evaluate_in_list_datetime(gdf_column * input, const ral::utilities::in_list & list, gdf_column * output){
+	const gdf_dtype_extra_info extra_info = input->dtype_info;
+	std::vector<int64_t> values;
+	bool parsed = ral::utilities::parse_in_list_datetimes(list.literals, [&extra_info](const std::string & literal){
+		gdf_scalar scalar = get_scalar_from_string(literal, get_type_from_string(literal), extra_info);
+		return scalar.dtype == GDF_TIMESTAMP ? scalar.data.tmst : scalar.data.dt64;
+	}, values);
+	if(!parsed){
+		return false;
+	}
+	in_list_membership(input, values, list.negated, output);
+	return true;
+}
+
+bool evaluate_in_list(gdf_column * input, const ral::utilities::in_list & list, gdf_column * output){
+	bool evaluated;
+	switch(input->dtype){
+		case GDF_INT8: evaluated = evaluate_in_list_templated<int8_t>(input, list, output); break;
+		case GDF_INT16: evaluated = evaluate_in_list_templated<int16_t>(input, list, output); break;
+		case GDF_INT32: evaluated = evaluate_in_list_templated<int32_t>(input, list, output); break;
+		case GDF_INT64: evaluated = evaluate_in_list_templated<int64_t>(input, list, output); break;
+		case GDF_FLOAT32: evaluated = evaluate_in_list_templated<float>(input, list, output); break;
+		case GDF_FLOAT64: evaluated = evaluate_in_list_templated<double>(input, list, output); break;
+		case GDF_DATE64:
+		case GDF_TIMESTAMP: evaluated = evaluate_in_list_datetime(input, list, output); break;
+		case GDF_STRING_CATEGORY: evaluated = evaluate_in_list_category(input, list, output); break;
+		default: evaluated = false;
+	}
+	if(!evaluated){
+		return false;
+	}
+
+	if(output->valid != nullptr){
+		if(input->valid != nullptr){
+			CheckCudaErrors(cudaMemcpy(output->valid, input->valid, gdf_valid_allocation_size(input->size), cudaMemcpyDeviceToDevice));
+			output->null_count = input->null_count;
+		}else{
+			CheckCudaErrors(cudaMemset(output->valid, 0xff, gdf_valid_allocation_size(input->size)));
+			output->null_count = 0;
+		}
+	}
+	return true;
+}
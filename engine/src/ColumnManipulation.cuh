@@ -9,6 +9,7 @@
 #define COLUMNMANIPULATION_CUH_
 
 #include "gdf_wrapper/gdf_wrapper.cuh"
+#include "utilities/InList.h"
 
 //TODO: in theory  we want to get rid of this
 // we should be using permutation iterators when we can
@@ -17,4 +18,19 @@ void materialize_column(gdf_column * input,
 		gdf_column * output,
 		gdf_column * row_indeces);
 
+// Writes to selection_out the indices of the rows where stencil is true and valid. When selection_in is not null the
+// stencil is relative to it and the selected entries of selection_in are written instead, so that consecutive filters
+// never copy the filtered columns. Returns the number of selected rows.
+gdf_size_type compact_selection(gdf_column * stencil,
+		gdf_column * selection_in,
+		gdf_column * selection_out);
+
+// Writes to the GDF_BOOL8 output whether every row of input is in the list, with the validity of input. The literals
+// are parsed once into a sorted array of the column type and every row is looked up with a binary search. Returns
+// false without touching output when the list can't be evaluated this way, i.e. DATE32 columns or literals of another
+// type.
+bool evaluate_in_list(gdf_column * input,
+		const ral::utilities::in_list & list,
+		gdf_column * output);
+
 #endif /* COLUMNMANIPULATION_CUH_ */
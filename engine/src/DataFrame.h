@@ -9,8 +9,11 @@
 #define DATAFRAME_H_
 
 
+#include "ColumnManipulation.cuh"
+#include "Traits/RuntimeTraits.h"
 #include "Utils.cuh"
 #include "gdf_wrapper/gdf_wrapper.cuh"
+#include "profile/QueryProfile.h"
 #include <GDFColumn.cuh>
 #include <vector>
 typedef struct blazing_frame {
@@ -18,22 +21,27 @@ public:
 	// @todo: constructor copia, operator =
 	blazing_frame() : columns{} {}
 
-	blazing_frame(const blazing_frame & other) : columns{other.columns} {}
+	blazing_frame(const blazing_frame & other) : columns{other.columns}, selection{other.selection} {}
 
-	blazing_frame(blazing_frame && other) : columns{std::move(other.columns)} {}
+	blazing_frame(blazing_frame && other) : columns{std::move(other.columns)}, selection{other.selection} {}
 
 	blazing_frame & operator=(const blazing_frame & other) {
 		this->columns = other.columns;
+		this->selection = other.selection;
 		return *this;
 	}
 
 	blazing_frame & operator=(blazing_frame && other) {
 		this->columns = std::move(other.columns);
+		this->selection = other.selection;
 		return *this;
 	}
 
+	// when a selection is pending the number of rows is the number of selected rows, not the size of the columns
 	gdf_size_type get_num_rows_in_table(int table_index) {
-		if(table_index >= this->columns.size())
+		if(has_selection())
+			return this->selection.size();
+		else if(table_index >= this->columns.size())
 			return 0;
 		else if(this->columns[table_index].size() == 0)
 			return 0;
@@ -115,7 +123,56 @@ public:
 		}
 	}
 
-	void clear() { this->columns.resize(0); }
+	void clear() {
+		this->columns.resize(0);
+		clear_selection();
+	}
+
+	// The selection is a GDF_INT32 column of row indices into every column of the frame. Filters produce it instead of
+	// copying every column, the interpreter reads through it and operators that need dense columns call materialize()
+	bool has_selection() const { return this->selection.get_gdf_column() != nullptr; }
+
+	gdf_column_cpp & get_selection() { return this->selection; }
+
+	void set_selection(gdf_column_cpp new_selection) { this->selection = new_selection; }
+
+	void clear_selection() { this->selection = gdf_column_cpp{}; }
+
+	// gathers a single column of this frame through the pending selection, counted as bytes copied by the operator
+	gdf_column_cpp gather_selected(gdf_column_cpp & column) {
+		gdf_column_cpp output;
+		int column_width = ral::traits::get_dtype_size_in_bytes(column.get_gdf_column());
+		output.create_gdf_column(column.dtype(),
+			column.dtype_info(),
+			this->selection.size(),
+			nullptr,
+			column_width,
+			column.name(),
+			column.valid() != nullptr);
+
+		::materialize_column(column.get_gdf_column(), output.get_gdf_column(), this->selection.get_gdf_column());
+		output.update_null_count();
+		ral::profile::add_bytes_copied(get_gathered_bytes(output));
+		return output;
+	}
+
+	// replaces every column by its selected rows and drops the selection, returns the number of bytes copied
+	size_t materialize() {
+		if(!has_selection()) {
+			return 0;
+		}
+
+		size_t bytes_copied = 0;
+		for(std::size_t table_index = 0; table_index < columns.size(); table_index++) {
+			for(std::size_t column_index = 0; column_index < columns[table_index].size(); column_index++) {
+				gdf_column_cpp & column = columns[table_index][column_index];
+				column = gather_selected(column);
+				bytes_copied += get_gathered_bytes(column);
+			}
+		}
+		clear_selection();
+		return bytes_copied;
+	}
 
 	void empty_columns() {
 		for(std::size_t i = 0; i < columns.size(); i++) {
@@ -162,12 +219,18 @@ public:
 			}
 			new_frame.add_table(table_columns);
 		}
+		new_frame.selection = this->selection;
 		return new_frame;
 	}
 
 private:
+	static size_t get_gathered_bytes(gdf_column_cpp & column) {
+		return column.size() * ral::traits::get_dtype_size_in_bytes(column.get_gdf_column()) +
+			   (column.valid() != nullptr ? column.get_valid_size() : 0);
+	}
+
 	std::vector<std::vector<gdf_column_cpp>> columns;
-	// std::vector<gdf_column *> row_indeces; //per table row indexes used for materializing
+	gdf_column_cpp selection;  // row indexes used for materializing, shared by all tables
 } blazing_frame;
 
 
@@ -37,7 +37,8 @@ gdf_column_cpp::gdf_column_cpp(const gdf_column_cpp& col)
     this->set_name(col.column_name);
     this->is_ipc_column = col.is_ipc_column;
     this->column_token = col.column_token;
-    GDFRefCounter::getInstance()->increment(const_cast<gdf_column*>(col.column));
+    this->ref = col.ref;
+    GDFRefCounter::increment(this->ref);
 
 }
 
@@ -102,7 +103,7 @@ gdf_column_cpp gdf_column_cpp::clone(std::string name, bool register_column)
 	}
 
     if (register_column){
-	    GDFRefCounter::getInstance()->register_column(col1.column);
+	    col1.ref = GDFRefCounter::getInstance()->register_column(col1.column);
     }
 
 	return col1;
@@ -113,7 +114,7 @@ void gdf_column_cpp::operator=(const gdf_column_cpp& col)
     if (column == col.column) {
         return;
     }
-    decrement_counter(column);
+    decrement_counter();
 
 	column = col.column;
     this->allocated_size_data = col.allocated_size_data;
@@ -121,7 +122,8 @@ void gdf_column_cpp::operator=(const gdf_column_cpp& col)
     this->set_name(col.column_name);
     this->is_ipc_column = col.is_ipc_column;
     this->column_token = col.column_token;
-    GDFRefCounter::getInstance()->increment(const_cast<gdf_column*>(col.column));
+    this->ref = col.ref;
+    GDFRefCounter::increment(this->ref);
 
 }
 
@@ -168,7 +170,7 @@ gdf_valid_type * gdf_column_cpp::allocate_valid(){
 
 void gdf_column_cpp::create_gdf_column_for_ipc(gdf_dtype type, gdf_dtype_extra_info dtype_info, void * col_data,gdf_valid_type * valid_data, gdf_size_type num_values, gdf_size_type null_count, std::string column_name){
     assert(type != GDF_invalid);
-    decrement_counter(column);
+    decrement_counter();
 
     //TODO crate column here
     this->column = new gdf_column{};
@@ -197,7 +199,7 @@ void gdf_column_cpp::create_gdf_column_for_ipc(gdf_dtype type, gdf_dtype_extra_i
 
 void gdf_column_cpp::create_gdf_column(NVCategory* category, size_t num_values,std::string column_name){
 
-    decrement_counter(column);
+    decrement_counter();
 
     //TODO crate column here
     this->column = new gdf_column{};
@@ -228,12 +230,12 @@ void gdf_column_cpp::create_gdf_column(NVCategory* category, size_t num_values,s
     this->column_token = 0;
     this->set_name(column_name);
 
-    GDFRefCounter::getInstance()->register_column(this->column);
+    this->ref = GDFRefCounter::getInstance()->register_column(this->column);
 
 }
 
 void gdf_column_cpp::create_gdf_column(NVStrings* strings, size_t num_values, std::string column_name) {
-    decrement_counter(column);
+    decrement_counter();
 
     //TODO crate column here
     this->column = new gdf_column{};
@@ -246,13 +248,13 @@ void gdf_column_cpp::create_gdf_column(NVStrings* strings, size_t num_values, st
     this->column_token = 0;
     this->set_name(column_name);
 
-    GDFRefCounter::getInstance()->register_column(this->column);
+    this->ref = GDFRefCounter::getInstance()->register_column(this->column);
 }
 
 void gdf_column_cpp::create_gdf_column(gdf_dtype type, gdf_dtype_extra_info dtype_info, size_t num_values, void * input_data, gdf_valid_type * host_valids, size_t width_per_value, const std::string &column_name)
 {
     assert(type != GDF_invalid);
-    decrement_counter(column);
+    decrement_counter();
 
     this->column = new gdf_column{};
 
@@ -289,14 +291,14 @@ void gdf_column_cpp::create_gdf_column(gdf_dtype type, gdf_dtype_extra_info dtyp
         this->update_null_count();
     }
 
-    GDFRefCounter::getInstance()->register_column(this->column);
+    this->ref = GDFRefCounter::getInstance()->register_column(this->column);
 }
 
 //Todo: Verificar que al llamar mas de una vez al create_gdf_column se desaloque cualquier memoria alocada anteriormente
 void gdf_column_cpp::create_gdf_column(gdf_dtype type, gdf_dtype_extra_info dtype_info, size_t num_values, void * input_data, size_t width_per_value, const std::string &column_name, bool allocate_valid_buffer )
 {
     assert(type != GDF_invalid);
-    decrement_counter(column);
+    decrement_counter();
 
     this->column = new gdf_column{};
 
@@ -331,13 +333,13 @@ void gdf_column_cpp::create_gdf_column(gdf_dtype type, gdf_dtype_extra_info dtyp
         CheckCudaErrors(cudaMemcpy(data, input_data, num_values * width_per_value, cudaMemcpyHostToDevice));
     }
 
-    GDFRefCounter::getInstance()->register_column(this->column);
+    this->ref = GDFRefCounter::getInstance()->register_column(this->column);
 }
 
 void gdf_column_cpp::create_gdf_column(gdf_column * column, bool registerColumn){
 
     if (column != this->column) { // if this gdf_column_cpp already represented this gdf_column, we dont want to do anything. Especially do decrement_counter, since it might actually free the gdf_column we are trying to use
-        decrement_counter(this->column);
+        decrement_counter();
 
         this->column = column;
 
@@ -359,7 +361,10 @@ void gdf_column_cpp::create_gdf_column(gdf_column * column, bool registerColumn)
         if (column->col_name)
             this->set_name(std::string(column->col_name));
 				if(registerColumn){
-        	GDFRefCounter::getInstance()->register_column(this->column);
+        	this->ref = GDFRefCounter::getInstance()->register_column(this->column);
+            // columns from cudf were not allocated through the query, charge them now that it owns them
+            cuDF::Allocator::adopt(this->column->data, this->allocated_size_data);
+            cuDF::Allocator::adopt(this->column->valid, this->allocated_size_valid);
 				}
 
     }
@@ -367,7 +372,7 @@ void gdf_column_cpp::create_gdf_column(gdf_column * column, bool registerColumn)
 
 void gdf_column_cpp::create_gdf_column(const gdf_scalar & scalar, const std::string &column_name){
     assert(scalar.dtype != GDF_invalid);
-    decrement_counter(column);
+    decrement_counter();
 
     this->column = new gdf_column{};
 
@@ -421,7 +426,7 @@ void gdf_column_cpp::create_gdf_column(const gdf_scalar & scalar, const std::str
         }
     }
 
-    GDFRefCounter::getInstance()->register_column(this->column);
+    this->ref = GDFRefCounter::getInstance()->register_column(this->column);
 }
 
 void gdf_column_cpp::create_empty(const gdf_dtype     dtype,
@@ -441,7 +446,7 @@ void gdf_column_cpp::create_empty(const gdf_dtype dtype) {
 }
 
 void gdf_column_cpp::allocate_like(const gdf_column_cpp& other){
-    decrement_counter(column);
+    decrement_counter();
 
     this->column = new gdf_column{};
 
@@ -467,7 +472,7 @@ void gdf_column_cpp::allocate_like(const gdf_column_cpp& other){
 
     this->set_name("");
 
-    GDFRefCounter::getInstance()->register_column(this->column);
+    this->ref = GDFRefCounter::getInstance()->register_column(this->column);
 }
 
 /*
@@ -490,13 +495,10 @@ gdf_error gdf_column_cpp::gdf_column_view(gdf_column *column, void *data, gdf_va
 
 gdf_column_cpp::~gdf_column_cpp()
 {
-	if(this->is_ipc_column){
-		//TODO: this is a big memory leak. we probably just need to have anothe reference
-		//counter, the valid pointer was allocated on our side
-		//we cant free it here because we dont know if this ipc column is used somewhere else
-	}else{
-	    GDFRefCounter::getInstance()->decrement(this->column);
-	}
+	//TODO: ipc columns are a big memory leak. we probably just need to have anothe reference
+	//counter, the valid pointer was allocated on our side
+	//we cant free it here because we dont know if this ipc column is used somewhere else
+	decrement_counter();
 
 }
 bool gdf_column_cpp::is_ipc() const {
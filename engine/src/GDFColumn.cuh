@@ -86,10 +86,10 @@ class gdf_column_cpp
 public:
     std::size_t get_valid_size() const;
 
-    inline void decrement_counter(gdf_column* column) {
-        if ((column != nullptr) && (is_ipc_column == false)) {
-            GDFRefCounter::getInstance()->decrement(column);
-        }
+    // drops the reference to the column this wraps, freeing it when it was the last one
+    inline void decrement_counter() {
+        GDFRefCounter::getInstance()->decrement(ref);
+        ref = nullptr;
     }
 
 protected:
@@ -98,6 +98,7 @@ protected:
 
 private:
     gdf_column* column{};
+    column_ref* ref{}; // nullptr for ipc columns and columns this does not own
     std::size_t allocated_size_data{};
     std::size_t allocated_size_valid{};
     std::string column_name{};
@@ -6,52 +6,65 @@
  */
 
 #include "GDFCounter.cuh"
+#include <cstdint>
 #include <iostream>
 #include "cuDF/Allocator.h"
 #include <nvstrings/NVCategory.h>
 #include <nvstrings/NVStrings.h>
 
 
-GDFRefCounter* GDFRefCounter::Instance=0;
-
-void GDFRefCounter::register_column(gdf_column* col_ptr){
+GDFRefCounter::shard & GDFRefCounter::get_shard(gdf_column * col_ptr)
+{
+    // columns are heap allocated, the low bits of their address carry no information
+    return shards[(reinterpret_cast<std::uintptr_t>(col_ptr) >> 4) % NUM_SHARDS];
+}
 
-    if(col_ptr != nullptr){
-        std::lock_guard<std::mutex> lock(gc_mutex);
-        gdf_column * map_key = {col_ptr};
+column_ref * GDFRefCounter::register_column(gdf_column* col_ptr){
 
-        if(map.find(map_key) == map.end()){
-            map[map_key]=1;
-        }
+    if(col_ptr == nullptr){
+        return nullptr;
     }
-}
 
-void GDFRefCounter::deregister_column(gdf_column* col_ptr)
-{
-    if (col_ptr != nullptr) {  // TODO: use exceptions instead jump nulls
-        std::lock_guard<std::mutex> lock(gc_mutex);
-        gdf_column * map_key = {col_ptr};
+    shard & col_shard = get_shard(col_ptr);
+    std::lock_guard<std::mutex> lock(col_shard.gc_mutex);
+
+    if(col_shard.deregistered.find(col_ptr) != col_shard.deregistered.end()){
+        return nullptr;
+    }
 
-        if(map.find(map_key) != map.end()){
-            map[map_key]=0; //deregistering
+    auto it = col_shard.registered.find(col_ptr);
+    if(it != col_shard.registered.end()){
+        // another gdf_column_cpp already wraps this column, share its references unless the last one is going away
+        column_ref * ref = it->second;
+        size_t count = ref->count.load();
+        while(count != 0){
+            if(ref->count.compare_exchange_weak(count, count + 1)){
+                return ref;
+            }
         }
+        return nullptr;
     }
+
+    column_ref * ref = new column_ref{col_ptr, {1}, true};
+    col_shard.registered[col_ptr] = ref;
+    return ref;
 }
 
-void GDFRefCounter::increment(gdf_column* col_ptr)
+void GDFRefCounter::deregister_column(gdf_column* col_ptr)
 {
-    std::lock_guard<std::mutex> lock(gc_mutex);
-    gdf_column * map_key = {col_ptr};
-
-    if(map.find(map_key)!=map.end()){
-        if(map[map_key]!=0){ //is already deregistered
-            map[map_key]++;
+    if (col_ptr != nullptr) {  // TODO: use exceptions instead jump nulls
+        shard & col_shard = get_shard(col_ptr);
+        std::lock_guard<std::mutex> lock(col_shard.gc_mutex);
+
+        auto it = col_shard.registered.find(col_ptr);
+        if(it != col_shard.registered.end()){
+            it->second->owned = false; //deregistering
+            col_shard.registered.erase(it);
+            col_shard.deregistered.insert(col_ptr);
         }
     }
 }
 
-
-
 void deallocate(gdf_column* col_ptr){
 
     if (col_ptr->data != nullptr){
@@ -73,64 +86,83 @@ void deallocate(gdf_column* col_ptr){
 
 void GDFRefCounter::free(gdf_column* col_ptr)
 {
-    std::lock_guard<std::mutex> lock(gc_mutex);
-    gdf_column * map_key = {col_ptr};
+    if (col_ptr == nullptr) {
+        return;
+    }
 
-    if(map.find(map_key)!=map.end()){
-        map.erase(map_key);
+    {
+        shard & col_shard = get_shard(col_ptr);
+        std::lock_guard<std::mutex> lock(col_shard.gc_mutex);
 
-        try {
-            deallocate(map_key);
-        }
-        catch (const std::exception& e) {
-            delete map_key;
-            throw;
+        if(col_shard.deregistered.erase(col_ptr) == 0){
+            auto it = col_shard.registered.find(col_ptr);
+            if(it == col_shard.registered.end()){
+                return;
+            }
+            // the references left do not own the column anymore
+            it->second->owned = false;
+            col_shard.registered.erase(it);
         }
+    }
 
-        delete map_key;
+    try {
+        deallocate(col_ptr);
+    }
+    catch (const std::exception& e) {
+        delete col_ptr;
+        throw;
     }
+
+    delete col_ptr;
 }
 
-void GDFRefCounter::decrement(gdf_column* col_ptr)
+void GDFRefCounter::release_last(column_ref * ref)
 {
-    std::lock_guard<std::mutex> lock(gc_mutex);
-    gdf_column * map_key = {col_ptr};
-
-    if(map.find(map_key)!=map.end()){
-        if(map[map_key]>0){
-            map[map_key]--;
-
-            if(map[map_key]==0){
-                map.erase(map_key);
+    bool owned;
+    {
+        shard & col_shard = get_shard(ref->column);
+        std::lock_guard<std::mutex> lock(col_shard.gc_mutex);
+        owned = ref->owned;
+        if(owned){
+            col_shard.registered.erase(ref->column);
+        }
+    }
 
-                try {
-                    deallocate(map_key);
-                }
-                catch (const std::exception& e) {
-                    delete map_key;
-                    throw;
-                }
+    gdf_column * col_ptr = ref->column;
+    delete ref;
 
-                delete map_key;
-            }
+    if(owned){
+        try {
+            deallocate(col_ptr);
+        }
+        catch (const std::exception& e) {
+            delete col_ptr;
+            throw;
         }
+
+        delete col_ptr;
     }
 }
 
 bool GDFRefCounter::contains_column(gdf_column * ptrs){
-	if(this->map.find(ptrs) == this->map.end()){
-		return false;
-	}
-	return true;
+    shard & col_shard = get_shard(ptrs);
+    std::lock_guard<std::mutex> lock(col_shard.gc_mutex);
+    return col_shard.registered.find(ptrs) != col_shard.registered.end() ||
+        col_shard.deregistered.find(ptrs) != col_shard.deregistered.end();
 }
 
 void GDFRefCounter::show_summary()
 {
     std::cout<<"--------------------- RefCounter Summary -------------------------\n";
 
-    for (auto& iter : this->map)
-        std::cout << "Ptr: " << iter.first << " count: " << iter.second <<"\n";
-    
+    for (auto& col_shard : this->shards) {
+        std::lock_guard<std::mutex> lock(col_shard.gc_mutex);
+        for (auto& iter : col_shard.registered)
+            std::cout << "Ptr: " << iter.first << " count: " << iter.second->count <<"\n";
+        for (auto& iter : col_shard.deregistered)
+            std::cout << "Ptr: " << iter << " count: 0\n";
+    }
+
     std::cout<<"Size: "<<get_map_size()<<"\n";
 
     std::cout<<"------------------ End RefCounter Summary -------------------------\n";
@@ -144,21 +176,26 @@ GDFRefCounter::GDFRefCounter()
 // Testing purposes
 size_t GDFRefCounter::get_map_size()
 {
-    return map.size();
+    size_t size = 0;
+    for (auto& col_shard : this->shards) {
+        std::lock_guard<std::mutex> lock(col_shard.gc_mutex);
+        size += col_shard.registered.size() + col_shard.deregistered.size();
+    }
+    return size;
 }
 
 GDFRefCounter* GDFRefCounter::getInstance()
 {
-    if(!Instance)
-        Instance=new GDFRefCounter();
-    return Instance;
+    static GDFRefCounter* instance = new GDFRefCounter();
+    return instance;
 }
 
 std::size_t GDFRefCounter::column_ref_value(gdf_column* column) {
-    std::lock_guard<std::mutex> lock(gc_mutex);
-    auto it = map.find(column);
-    if (it == map.end()) {
+    shard & col_shard = get_shard(column);
+    std::lock_guard<std::mutex> lock(col_shard.gc_mutex);
+    auto it = col_shard.registered.find(column);
+    if (it == col_shard.registered.end()) {
         return 0;
     }
-    return it->second;
+    return it->second->count;
 }
@@ -9,32 +9,63 @@
 #define GDFCOUNTER_H_
 
 #include "gdf_wrapper/gdf_wrapper.cuh"
-#include <map>
+#include <array>
+#include <atomic>
 #include <mutex>
-
+#include <unordered_map>
+#include <unordered_set>
+
+// The references to a registered gdf_column, shared by every gdf_column_cpp that wraps it. Copying or destroying a
+// gdf_column_cpp only touches the atomic count, the registry is locked once the last reference goes away.
+struct column_ref {
+	gdf_column * column;
+	std::atomic<size_t> count;
+	bool owned; // false once the column was deregistered or freed, guarded by the mutex of its shard
+};
 
 class GDFRefCounter
 {
 	private:
 		GDFRefCounter();
 
-		static GDFRefCounter* Instance;
+		static const size_t NUM_SHARDS = 64;
 
-		std::mutex gc_mutex;
+		// the registry is split by column pointer so columns created and dropped by concurrent queries rarely share a lock
+		struct shard {
+			std::mutex gc_mutex;
+			std::unordered_map<gdf_column *, column_ref *> registered;
+			std::unordered_set<gdf_column *> deregistered; // owned by whoever deregistered them, waiting for free
+		};
 
-		std::map<gdf_column *, size_t> map; // std::map<key_ptr, ref_counter>
+		shard & get_shard(gdf_column * col_ptr);
 
-	public:
-		void increment(gdf_column* col_ptr);
+		// the last reference went away
+		void release_last(column_ref * ref);
 
-		void decrement(gdf_column* col_ptr);
+		std::array<shard, NUM_SHARDS> shards;
+
+	public:
+		// Returns a reference to col_ptr, registering it when it is new. Returns nullptr when the column was
+		// deregistered, the gdf_column_cpp wrapping it does not own it then.
+		column_ref * register_column(gdf_column* col_ptr);
+
+		inline static void increment(column_ref * ref) {
+			if (ref != nullptr) {
+				ref->count.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+
+		inline void decrement(column_ref * ref) {
+			if (ref != nullptr && ref->count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+				release_last(ref);
+			}
+		}
 
 		//Deallocating memory from the resultset repository
-		//Used by decrement and for freeing data that has been deregistered previously
+		//Used for freeing data that has been deregistered previously
 		void free(gdf_column* col_ptr);
 
-		void register_column(gdf_column* col_ptr);
-
+		// Hands the column over to the caller (IPC, the result set repository), dropping the references no longer frees it
 		void deregister_column(gdf_column* col_ptr);
 
 		size_t get_map_size();
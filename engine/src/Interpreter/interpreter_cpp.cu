@@ -5,6 +5,8 @@
 #include "cuDF/Allocator.h"
 #include "../Utils.cuh"
 #include "cudf/legacy/binaryop.hpp"
+#include <stdexcept>
+#include <string>
 
 //TODO: a better way to handle all this thread block size is
 //to get the amount of shared memory from the device and figure it out that way
@@ -228,7 +230,8 @@ void perform_operation(	std::vector<gdf_column *> output_columns,
 
 		std::vector<gdf_scalar> & left_scalars,
 		std::vector<gdf_scalar> & right_scalars,
-		std::vector<column_index_type> new_input_indices){
+		std::vector<column_index_type> new_input_indices,
+		gdf_column * input_selection){
 
 	//find maximum register used
 	column_index_type max_output = 0;
@@ -239,9 +242,18 @@ void perform_operation(	std::vector<gdf_column *> output_columns,
 	}
 
 
+	if(max_output + 1 > MAX_INTERPRETER_REGISTERS){
+		throw std::runtime_error("In perform_operation: plan needs " + std::to_string(max_output + 1) +
+			" registers but the interpreter supports " + std::to_string(MAX_INTERPRETER_REGISTERS));
+	}
+
 	char * temp_space;
 
-	gdf_size_type num_rows = input_columns[0]->size;
+	//with a selection the inputs are read through it and the outputs are as long as the selection
+	gdf_size_type num_rows = input_selection != nullptr ? input_selection->size : input_columns[0]->size;
+	if(num_rows == 0){
+		return;
+	}
 
 	cudaStream_t stream;
 	CheckCudaErrors(cudaStreamCreate(&stream));
@@ -257,12 +269,20 @@ void perform_operation(	std::vector<gdf_column *> output_columns,
 
 	cuDF::Allocator::allocate((void **)&temp_space,temp_size, stream);
 
-	int64_t * temp_valids_in_buffer, *temp_valids_out_buffer;
-	size_t temp_valids_in_size = min_grid_size * block_size * input_columns.size() * sizeof(int64_t);
-	size_t temp_valids_out_size = min_grid_size * block_size * final_output_positions.size() * sizeof(int64_t);
+	interpreter_valid_mode valid_mode = get_interpreter_valid_mode(input_columns, left_inputs, right_inputs, operators, unary_operators);
 
-	cuDF::Allocator::allocate((void **)&temp_valids_in_buffer,temp_valids_in_size, stream);
-	cuDF::Allocator::allocate((void **)&temp_valids_out_buffer,temp_valids_out_size, stream);
+	int64_t * temp_valids_in_buffer = nullptr, *temp_valids_out_buffer = nullptr;
+	size_t temp_valids_in_size = min_grid_size * block_size * sizeof(int64_t) *
+		interpreter_functor_8::get_num_valid_words(valid_mode, input_columns.size(), max_output);
+	size_t temp_valids_out_size = min_grid_size * block_size * sizeof(int64_t) *
+		interpreter_functor_8::get_num_valid_outputs(valid_mode, final_output_positions.size());
+
+	if(temp_valids_in_size > 0){
+		cuDF::Allocator::allocate((void **)&temp_valids_in_buffer,temp_valids_in_size, stream);
+	}
+	if(temp_valids_out_size > 0){
+		cuDF::Allocator::allocate((void **)&temp_valids_out_buffer,temp_valids_out_size, stream);
+	}
 
 	interpreter_functor_8 op(input_columns,
 			output_columns,
@@ -278,7 +298,9 @@ void perform_operation(	std::vector<gdf_column *> output_columns,
 			,stream,
 			temp_space,
 			max_output,
-			block_size);
+			block_size,
+			input_selection != nullptr ? static_cast<gdf_index_type *>(input_selection->data) : nullptr,
+			valid_mode);
 
 	transformKernel<<<min_grid_size
 					,block_size,
@@ -290,11 +312,25 @@ void perform_operation(	std::vector<gdf_column *> output_columns,
 
 	// op.update_columns_null_count(output_columns);
 
+	//the kernel never touched the output valids, every row is valid
+	if(valid_mode == interpreter_valid_mode::ALL_VALID){
+		for(gdf_column * output_column : output_columns){
+			if(output_column->valid != nullptr){
+				CheckCudaErrors(cudaMemsetAsync(output_column->valid, 0xff, gdf_valid_allocation_size(output_column->size), stream));
+			}
+			output_column->null_count = 0;
+		}
+	}
+
 	CheckCudaErrors(cudaStreamSynchronize(stream));
 
 	cuDF::Allocator::deallocate(temp_space,stream);
-	cuDF::Allocator::deallocate(temp_valids_in_buffer,stream);
-	cuDF::Allocator::deallocate(temp_valids_out_buffer,stream);
+	if(temp_valids_in_buffer != nullptr){
+		cuDF::Allocator::deallocate(temp_valids_in_buffer,stream);
+	}
+	if(temp_valids_out_buffer != nullptr){
+		cuDF::Allocator::deallocate(temp_valids_out_buffer,stream);
+	}
 
 	CheckCudaErrors(cudaGetLastError());
 
@@ -21,6 +21,10 @@ typedef short column_index_type;
 static const short SCALAR_INDEX = -2;
 static const short SCALAR_NULL_INDEX = -3;
 
+// calculate_grid only has occupancy configurations up to this many registers per thread, plans that need more
+// registers have to be split across several perform_operation calls
+static const short MAX_INTERPRETER_REGISTERS = 64;
+
 
 void perform_operation(std::vector<gdf_column *> output_columns,
 	std::vector<gdf_column *> input_columns,
@@ -34,7 +38,8 @@ void perform_operation(std::vector<gdf_column *> output_columns,
 
 	std::vector<gdf_scalar> & left_scalars,
 	std::vector<gdf_scalar> & right_scalars,
-	std::vector<column_index_type> new_input_indices);
+	std::vector<column_index_type> new_input_indices,
+	gdf_column * input_selection = nullptr);  // optional GDF_INT32 row indices, outputs get one row per index
 
 
 #endif /* INTERPRETER_CPP_H_ */
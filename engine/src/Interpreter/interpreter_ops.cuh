@@ -17,6 +17,7 @@
 #include "helper_cuda.h"
 #include "cudf/legacy/binaryop.hpp"
 #include "CalciteExpressionParsing.h"
+#include "interpreter_valids.h"
 
 typedef int64_t temp_gdf_valid_type; //until its an int32 in cudf
 
@@ -250,6 +251,8 @@ class InterpreterFunctor {
 public:
 		size_t num_columns;
 		short num_final_outputs;
+		short num_valid_words; //per thread words of temp_valids_in_buffer
+		short num_valid_outputs; //per thread words of temp_valids_out_buffer
 private:
 	void  **column_data; //these are device side pointers to the device pointer found in gdf_column.data
 	void ** output_data;
@@ -280,6 +283,10 @@ private:
 
 	gdf_size_type * null_counts_inputs;
 	gdf_size_type * null_counts_outputs;
+
+	const gdf_index_type * selection; //device, optional row indices into the input columns, one per output row
+
+	interpreter_valid_mode valid_mode;
 	
 
 	template<typename LocalStorageType, typename BufferType>
@@ -402,9 +409,8 @@ private:
 
 	}
 
-	//TODO: a clever person would make this something that gets passed into this function so that we can do more clever things than just read
-	//data from some grumpy old buffer, like read in from another one of these that does read from a boring buffer, or from some perumtation iterartor
-	//hmm in fact if it could read permuted data you could avoi dmaterializing intermeidate filter steps
+	//row_index is the row in the input columns, when there is a selection the caller has already mapped the output row
+	//through it with get_input_row so reading permuted data avoids materializing intermediate filter steps
 	template<typename BufferType>
 	__device__
 	__forceinline__ void read_data(column_index_type cur_column,  BufferType * buffer,const size_t & row_index){
@@ -501,12 +507,21 @@ private:
 		return (OutputType)value;
 	}
 
-	/*
 	__device__
-	__forceinline__ void read_permuted_data(column_index_type cur_column,  int64_t * buffer,const size_t & row_index){
-		//put permuted data here
+	__forceinline__ IndexT get_input_row(const IndexT & row_index){
+		return this->selection == nullptr ? row_index : this->selection[row_index];
+	}
+
+	//the selected rows are not contiguous in the input so the valid word for the 64 output rows starting at row_index
+	//has to be assembled bit by bit
+	__device__
+	__forceinline__ void read_permuted_valid_data(column_index_type cur_column, int64_t * buffer, const size_t & row_index, gdf_size_type size){
+		int64_t valid_data = 0;
+		for(gdf_size_type row = 0; row < 64 && row_index + row < size; row++){
+			setColumnValid(valid_data, row, gdf_is_valid_32(this->valid_ptrs[cur_column], this->selection[row_index + row]));
+		}
+		buffer[cur_column] = valid_data;
 	}
-	 */
 	template<typename BufferType>
 	__device__
 	__forceinline__ void process_operator(size_t op_index,  BufferType * buffer, const IndexT &row_index,int64_t & row_valids){
@@ -964,6 +979,20 @@ public:
 		return space;
 	}
 
+	//PER_ROW keeps a word per input column, WORDWISE a word per register and ALL_VALID needs nothing
+	static short get_num_valid_words(interpreter_valid_mode valid_mode, short num_inputs, short max_output){
+		if(valid_mode == interpreter_valid_mode::PER_ROW){
+			return num_inputs;
+		}else if(valid_mode == interpreter_valid_mode::WORDWISE){
+			return max_output + 1;
+		}
+		return 0;
+	}
+
+	static short get_num_valid_outputs(interpreter_valid_mode valid_mode, short num_final_outputs){
+		return valid_mode == interpreter_valid_mode::PER_ROW ? num_final_outputs : 0;
+	}
+
 	// DO NOT USE THIS. This is currently not working due to strange race condition
 	// void update_columns_null_count(std::vector<gdf_column *> output_columns){
 	// 	gdf_size_type * outputs = new gdf_size_type[output_columns.size()];
@@ -1031,7 +1060,9 @@ public:
 			std::vector<gdf_scalar> & right_scalars//,
 			,cudaStream_t stream,
 			char * temp_space,
-			int BufferSize, int ThreadBlockSize
+			int BufferSize, int ThreadBlockSize,
+			const gdf_index_type * selection = nullptr,
+			interpreter_valid_mode valid_mode = interpreter_valid_mode::PER_ROW
 			//char * temp_space
 	){
 
@@ -1044,7 +1075,11 @@ public:
 		this->num_operations = _num_operations;
 		this->maxPosition = final_output_positions_vec[final_output_positions_vec.size()-1];
 		this->stream = stream;
+		this->selection = selection;
+		this->valid_mode = valid_mode;
 		num_columns = columns.size();
+		this->num_valid_words = get_num_valid_words(valid_mode, columns.size(), BufferSize);
+		this->num_valid_outputs = get_num_valid_outputs(valid_mode, this->num_final_outputs);
 		num_rows = columns[0]->size;
 
 		//added this to class
@@ -1362,27 +1397,52 @@ void load_cur_row_valids(int64_t valids_in_buffer[],gdf_size_type row,int64_t &
 	__device__ __forceinline__ void operator()(const IndexT row_index, int64_t total_buffer[], int64_t * valids_in_buffer, int64_t * valids_out_buffer, gdf_size_type size) {
 		//		__shared__ char buffer[BufferSize * THREADBLOCK_SIZE];
 
-		int64_t cur_row_valids;
+		//stays all valid unless validity is tracked per row
+		int64_t cur_row_valids = -1;
 //TODO: enable when we process null counts in this kernel
 //		gdf_size_type null_counts[this->num_final_outputs];
 
-		for(column_index_type cur_column = 0; cur_column < this->num_columns; cur_column++ ){
+		if(this->valid_mode != interpreter_valid_mode::ALL_VALID){
+			for(column_index_type cur_column = 0; cur_column < this->num_columns; cur_column++ ){
 
-			if(this->valid_ptrs[cur_column] == nullptr || this->null_counts_inputs[cur_column] == 0){
+				if(this->valid_ptrs[cur_column] == nullptr || this->null_counts_inputs[cur_column] == 0){
+
+					valids_in_buffer[cur_column] = -1;
+				}else if(this->selection != nullptr){
+					read_permuted_valid_data(cur_column, valids_in_buffer, row_index, size);
+				}else{
+					read_valid_data(cur_column, valids_in_buffer, row_index);
+				}
 
-				valids_in_buffer[cur_column] = -1;
-			}else{
-				read_valid_data(cur_column, valids_in_buffer, row_index);
 			}
+		}
 
+		if(this->valid_mode == interpreter_valid_mode::WORDWISE){
+			//the validity of the 64 rows of every output is known before looking at any value
+			process_valid_words(this->num_operations,
+				this->left_input_positions,
+				this->right_input_positions,
+				this->output_positions,
+				this->binary_operations,
+				this->unary_operations,
+				valids_in_buffer);
+
+			for(column_index_type out_index = 0; out_index < this->num_final_outputs; out_index++ ){
+				if(this->valid_ptrs_out[out_index] != nullptr){
+					write_valid_data(out_index, valids_in_buffer[this->final_output_positions[out_index]], row_index);
+				}
+			}
 		}
 
 		for(gdf_size_type row = 0; row < 64 && row_index + row < size; row++){
 
-			load_cur_row_valids(valids_in_buffer,row,cur_row_valids,this->num_columns);
+			if(this->valid_mode == interpreter_valid_mode::PER_ROW){
+				load_cur_row_valids(valids_in_buffer,row,cur_row_valids,this->num_columns);
+			}
 
+			IndexT input_row = get_input_row(row_index + row);
 			for(short cur_column = 0; cur_column < this->num_columns; cur_column++ ){
-				read_data(cur_column,total_buffer, row_index + row);
+				read_data(cur_column,total_buffer, input_row);
 			}
 
 
@@ -1395,11 +1455,15 @@ void load_cur_row_valids(int64_t valids_in_buffer[],gdf_size_type row,int64_t &
 				write_data(out_index,this->final_output_positions[out_index],total_buffer,row_index + row);
 			}
 
-			copyRowValidsIntoBuffer(cur_row_valids,valids_out_buffer,row);
+			if(this->valid_mode == interpreter_valid_mode::PER_ROW){
+				copyRowValidsIntoBuffer(cur_row_valids,valids_out_buffer,row);
+			}
 		}
 
 		//write out valids here
-		copyRowValidsIntoGlobal(valids_out_buffer, row_index);
+		if(this->valid_mode == interpreter_valid_mode::PER_ROW){
+			copyRowValidsIntoGlobal(valids_out_buffer, row_index);
+		}
 	}
 
 };
@@ -1444,16 +1508,15 @@ gdf_column create_gdf_column(gdf_dtype type, size_t num_values, void * input_dat
  */
 
 
-//TODO: consider running valids at the same time as the normal
-// operations to increase throughput
+//valids are only moved through the temp buffers for the modes that need them, see interpreter_valid_mode
 template<typename interpreted_operator>
 __global__ void transformKernel(interpreted_operator op, gdf_size_type size, int64_t* temp_valids_in_buffer, int64_t* temp_valids_out_buffer)
 {
 
 	extern __shared__  int64_t  total_buffer[];
 
-	int64_t * valids_in_buffer = temp_valids_in_buffer + (blockIdx.x * blockDim.x + threadIdx.x) * op.num_columns;
-	int64_t * valids_out_buffer = temp_valids_out_buffer + (blockIdx.x * blockDim.x + threadIdx.x) * op.num_final_outputs;
+	int64_t * valids_in_buffer = temp_valids_in_buffer + (blockIdx.x * blockDim.x + threadIdx.x) * op.num_valid_words;
+	int64_t * valids_out_buffer = temp_valids_out_buffer + (blockIdx.x * blockDim.x + threadIdx.x) * op.num_valid_outputs;
 
 	for (gdf_size_type i = (blockIdx.x * blockDim.x + threadIdx.x) * 64;
 			i < size;
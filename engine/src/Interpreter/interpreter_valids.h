@@ -0,0 +1,117 @@
+#ifndef _BLAZINGDB_RAL_INTERPRETER_VALIDS_H
+#define _BLAZINGDB_RAL_INTERPRETER_VALIDS_H
+
+#include "gdf_wrapper/gdf_wrapper.cuh"
+#include <cstdint>
+#include <vector>
+
+// Shared by the interpreter kernel and host code so the validity rules can be tested and benchmarked without a device
+#ifdef __CUDACC__
+#define INTERPRETER_HOST_DEVICE __host__ __device__ __forceinline__
+#else
+#define INTERPRETER_HOST_DEVICE inline
+#endif
+
+typedef short column_index_type;
+
+/**
+ * How the interpreter has to track validity for a plan, decided once before the kernel is launched.
+ */
+enum class interpreter_valid_mode {
+	ALL_VALID,  // no input has nulls and no operand is a null literal, outputs are all valid
+	WORDWISE,   // validity of every operation only depends on the validity of its operands, so it is combined
+				// with AND/OR over 64 row words once per block
+	PER_ROW		// some operation reads the validity of a row to pick its value, i.e. COALESCE or IS NULL
+};
+
+// Operations whose value depends on whether its operands are null, they need one validity bit per row
+INTERPRETER_HOST_DEVICE bool reads_row_validity(gdf_binary_operator_exp binary_operation, gdf_unary_operator unary_operation) {
+	return binary_operation == BLZ_COALESCE || binary_operation == BLZ_LOGICAL_OR ||
+		   binary_operation == BLZ_MAGIC_IF_NOT || binary_operation == BLZ_FIRST_NON_MAGIC ||
+		   unary_operation == BLZ_IS_NULL || unary_operation == BLZ_IS_NOT_NULL;
+}
+
+// String operations are computed before the kernel and their right operand is only a placeholder
+INTERPRETER_HOST_DEVICE bool ignores_right_validity(gdf_binary_operator_exp binary_operation) {
+	return binary_operation == BLZ_STR_LIKE || binary_operation == BLZ_STR_SUBSTRING ||
+		   binary_operation == BLZ_STR_CONCAT;
+}
+
+// Validity word of the operand at position for 64 rows, literals are always valid and null literals never are
+INTERPRETER_HOST_DEVICE int64_t get_operand_valid_word(const int64_t * valid_words, column_index_type position) {
+	if(position >= 0) {
+		return valid_words[position];
+	}
+	return position == -3 ? 0 : -1;
+}
+
+// Validity of the output of an operation for 64 rows at once
+INTERPRETER_HOST_DEVICE int64_t combine_valid_words(gdf_binary_operator_exp binary_operation,
+	gdf_unary_operator unary_operation,
+	int64_t left_valid,
+	int64_t right_valid) {
+	if(unary_operation == BLZ_IS_NULL || unary_operation == BLZ_IS_NOT_NULL) {
+		return -1;
+	}
+	if(binary_operation == BLZ_INVALID_BINARY || ignores_right_validity(binary_operation)) {
+		return left_valid;
+	}
+	if(binary_operation == BLZ_COALESCE) {
+		return left_valid | right_valid;
+	}
+	return left_valid & right_valid;
+}
+
+/**
+ * Runs the validity side of a plan over 64 row words. valid_words holds one word per register with the inputs
+ * already loaded, the words of every operation output are written in place.
+ */
+INTERPRETER_HOST_DEVICE void process_valid_words(short num_operations,
+	const column_index_type * left_input_positions,
+	const column_index_type * right_input_positions,
+	const column_index_type * output_positions,
+	const gdf_binary_operator_exp * binary_operations,
+	const gdf_unary_operator * unary_operations,
+	int64_t * valid_words) {
+	for(short op_index = 0; op_index < num_operations; op_index++) {
+		int64_t left_valid = get_operand_valid_word(valid_words, left_input_positions[op_index]);
+		int64_t right_valid = right_input_positions[op_index] == -1
+								  ? -1
+								  : get_operand_valid_word(valid_words, right_input_positions[op_index]);
+		valid_words[output_positions[op_index]] =
+			combine_valid_words(binary_operations[op_index], unary_operations[op_index], left_valid, right_valid);
+	}
+}
+
+/**
+ * Picks the cheapest validity tracking that is still exact for the plan.
+ */
+inline interpreter_valid_mode get_interpreter_valid_mode(const std::vector<gdf_column *> & input_columns,
+	const std::vector<column_index_type> & left_inputs,
+	const std::vector<column_index_type> & right_inputs,
+	const std::vector<gdf_binary_operator_exp> & operators,
+	const std::vector<gdf_unary_operator> & unary_operators) {
+	bool has_nulls = false;
+	for(gdf_column * column : input_columns) {
+		if(column->valid != nullptr && column->null_count > 0) {
+			has_nulls = true;
+		}
+	}
+
+	bool reads_validity = false;
+	for(std::size_t op_index = 0; op_index < operators.size(); op_index++) {
+		if(left_inputs[op_index] == -3 || (right_inputs[op_index] == -3 && !ignores_right_validity(operators[op_index]))) {
+			has_nulls = true;
+		}
+		if(reads_row_validity(operators[op_index], unary_operators[op_index])) {
+			reads_validity = true;
+		}
+	}
+
+	if(!has_nulls) {
+		return interpreter_valid_mode::ALL_VALID;
+	}
+	return reads_validity ? interpreter_valid_mode::PER_ROW : interpreter_valid_mode::WORDWISE;
+}
+
+#endif  //_BLAZINGDB_RAL_INTERPRETER_VALIDS_H
@@ -5,9 +5,9 @@
  *      Author: felipe
  */
 
+#include <algorithm>
 #include <deque>
 #include <iostream>
-#include <regex>
 #include <vector>
 
 #include "LogicalFilter.h"
@@ -17,8 +17,11 @@
 #include <nvstrings/NVStrings.h>
 
 #include "CodeTimer.h"
+#include "ColumnManipulation.cuh"
 #include "Traits/RuntimeTraits.h"
 #include "gdf_wrapper/gdf_wrapper.cuh"
+#include "utilities/InList.h"
+#include "utilities/LikePattern.h"
 #include <blazingdb/io/Library/Logging/Logger.h>
 
 #include "Interpreter/interpreter_cpp.h"
@@ -40,6 +43,50 @@ column_index_type get_first_open_position(std::vector<bool> & open_positions, co
 	return -1;
 }
 
+expression_register_usage get_expression_register_usage(const std::vector<std::string> & tokens) {
+	expression_register_usage usage{0, 0};
+
+	std::vector<bool> operand_is_temp;
+	column_index_type live_temps = 0;
+	for(size_t token_ind = 0; token_ind < tokens.size(); token_ind++) {
+		const std::string & token = tokens[token_ind];
+		if(!is_operator_token(token)) {
+			operand_is_temp.push_back(false);
+			continue;
+		}
+
+		bool is_binary = is_binary_operator_token(token);
+		size_t num_operands = is_binary ? 2 : 1;
+		for(size_t i = 0; i < num_operands && !operand_is_temp.empty(); i++) {
+			if(operand_is_temp.back()) {
+				live_temps--;
+			}
+			operand_is_temp.pop_back();
+		}
+
+		// string functions and casts are computed outside the kernel and handed back as extra inputs
+		if(is_binary) {
+			gdf_binary_operator_exp operation = get_binary_operation(token);
+			if(operation == BLZ_STR_LIKE || operation == BLZ_STR_SUBSTRING || operation == BLZ_STR_CONCAT) {
+				usage.new_inputs++;
+			}
+		} else {
+			gdf_unary_operator operation = get_unary_operation(token);
+			if(operation >= BLZ_CAST_INTEGER && operation <= BLZ_CAST_VARCHAR) {
+				usage.new_inputs++;
+			}
+		}
+
+		// the last operator writes straight into the output register
+		if(token_ind != tokens.size() - 1) {
+			operand_is_temp.push_back(true);
+			live_temps++;
+			usage.temp_registers = std::max(usage.temp_registers, live_temps);
+		}
+	}
+	return usage;
+}
+
 gdf_column_cpp handle_cast_from_string(gdf_unary_operator operation, gdf_column * input_col) {
 	NVCategory * nv_category = static_cast<NVCategory *>(input_col->dtype_info.category);
 	NVStrings * nv_strings =
@@ -163,28 +210,32 @@ int insert_string_into_column_nvcategory(gdf_column * col, const std::string & s
 	return new_category->get_value(str.c_str());
 }
 
-std::string like_expression_to_regex_str(const std::string & like_exp) {
-	if(like_exp.empty()) {
-		return like_exp;
-	}
+gdf_column_cpp handle_match_regex(gdf_column * input_col, const std::string & re) {
+	NVCategory * nv_category = static_cast<NVCategory *>(input_col->dtype_info.category);
+	NVStrings * nv_strings =
+		nv_category->gather_strings(static_cast<nv_category_index_type *>(input_col->data), input_col->size);
 
-	bool match_start = like_exp[0] != '%';
-	bool match_end = like_exp[like_exp.size() - 1] != '%';
+	gdf_column_cpp new_input_col;
+	new_input_col.create_gdf_column(GDF_BOOL8,
+		gdf_dtype_extra_info{TIME_UNIT_NONE, nullptr},
+		input_col->size,
+		nullptr,
+		nullptr,
+		ral::traits::get_dtype_size_in_bytes(GDF_BOOL8));
 
-	std::string re = like_exp;
-	static const std::regex any_string_re{R"(([^\\]?|\\{2})%)"};
-	re = std::regex_replace(re, any_string_re, "$1(?:.*?)");
+	nv_strings->contains_re(re.c_str(), static_cast<bool *>(new_input_col.data()));
 
-	static const std::regex any_char_re{R"(([^\\]?|\\{2})_)"};
-	re = std::regex_replace(re, any_char_re, "$1(?:.)");
+	NVStrings::destroy(nv_strings);
 
-	return (match_start ? "^" : "") + re + (match_end ? "$" : "");
+	return new_input_col;
 }
 
-gdf_column_cpp handle_match_regex(gdf_column * input_col, const std::string & re) {
-	NVCategory * nv_category = static_cast<NVCategory *>(input_col->dtype_info.category);
-	NVStrings * nv_strings =
-		nv_category->gather_strings(static_cast<nv_category_index_type *>(input_col->data), input_col->size);
+gdf_column_cpp handle_like(gdf_column * input_col, const ral::utilities::like_pattern & pattern) {
+	using ral::utilities::like_pattern_kind;
+
+	if(pattern.kind == like_pattern_kind::EXACT || pattern.kind == like_pattern_kind::REGEX) {
+		return handle_match_regex(input_col, pattern.regex);
+	}
 
 	gdf_column_cpp new_input_col;
 	new_input_col.create_gdf_column(GDF_BOOL8,
@@ -193,8 +244,32 @@ gdf_column_cpp handle_match_regex(gdf_column * input_col, const std::string & re
 		nullptr,
 		nullptr,
 		ral::traits::get_dtype_size_in_bytes(GDF_BOOL8));
+	bool * results = static_cast<bool *>(new_input_col.data());
+
+	if(pattern.kind == like_pattern_kind::MATCH_ALL) {
+		CheckCudaErrors(cudaMemset(results, 1, input_col->size * sizeof(bool)));
+		if(input_col->valid != nullptr && input_col->null_count > 0) {
+			// a null string matches no pattern, the result is null where the input is
+			new_input_col.allocate_set_valid();
+			CheckCudaErrors(cudaMemcpy(new_input_col.valid(),
+				input_col->valid,
+				ral::traits::get_bitmask_size_in_bytes(input_col->size),
+				cudaMemcpyDeviceToDevice));
+			new_input_col.get_gdf_column()->null_count = input_col->null_count;
+		}
+		return new_input_col;
+	}
 
-	nv_strings->contains_re(re.c_str(), static_cast<bool *>(new_input_col.data()));
+	NVCategory * nv_category = static_cast<NVCategory *>(input_col->dtype_info.category);
+	NVStrings * nv_strings =
+		nv_category->gather_strings(static_cast<nv_category_index_type *>(input_col->data), input_col->size);
+
+	switch(pattern.kind) {
+	case like_pattern_kind::PREFIX: nv_strings->startswith(pattern.literal.c_str(), results); break;
+	case like_pattern_kind::SUFFIX: nv_strings->endswith(pattern.literal.c_str(), results); break;
+	case like_pattern_kind::CONTAINS: nv_strings->contains(pattern.literal.c_str(), results); break;
+	default: assert(false);
+	}
 
 	NVStrings::destroy(nv_strings);
 
@@ -392,9 +467,19 @@ void add_expression_to_plan(blazing_frame & inputs,
 					assert(mapped_index != -1);
 					gdf_column * left_column = input_columns[mapped_index];
 
+					ral::utilities::like_pattern like_pattern;
+					if(operation == BLZ_STR_LIKE) {
+						like_pattern = ral::utilities::compile_like_pattern(literal_operand);
+						if(like_pattern.kind == ral::utilities::like_pattern_kind::EXACT) {
+							// a LIKE without wildcards is an equality, which compares category indices instead of strings
+							operation = BLZ_EQUAL;
+							operators.back() = BLZ_EQUAL;
+							literal_operand = like_pattern.literal;
+						}
+					}
+
 					if(operation == BLZ_STR_LIKE) {
-						std::string regex = like_expression_to_regex_str(literal_operand);
-						gdf_column_cpp new_input_col = handle_match_regex(left_column, regex);
+						gdf_column_cpp new_input_col = handle_like(left_column, like_pattern);
 
 						inputs.add_column(new_input_col);
 						input_columns.push_back(new_input_col.get_gdf_column());
@@ -638,17 +723,47 @@ void add_expression_to_plan(blazing_frame & inputs,
 }
 
 
+std::string evaluate_in_lists(blazing_frame & inputs, const std::string & expression) {
+	if(expression.find("OR(") == std::string::npos && expression.find("AND(") == std::string::npos) {
+		return expression;
+	}
+
+	return ral::utilities::rewrite_in_lists(
+		replace_calcite_regex(expression), [&inputs](const ral::utilities::in_list & list) {
+			gdf_column * input_col = inputs.get_column(get_index(list.column)).get_gdf_column();
+
+			gdf_column_cpp new_input_col;
+			new_input_col.create_gdf_column(GDF_BOOL8,
+				gdf_dtype_extra_info{TIME_UNIT_NONE, nullptr},
+				input_col->size,
+				nullptr,
+				ral::traits::get_dtype_size_in_bytes(GDF_BOOL8),
+				"",
+				input_col->valid != nullptr);
+			if(!evaluate_in_list(input_col, list, new_input_col.get_gdf_column())) {
+				return std::string();
+			}
+
+			inputs.add_column(new_input_col);
+			return "$" + std::to_string(inputs.get_size_column() - 1);
+		});
+}
+
 // processing in reverse we never need to have more than TWO spaces to work in
-void evaluate_expression(blazing_frame & inputs, const std::string & expression, gdf_column_cpp & output) {
+void evaluate_expression(blazing_frame & inputs, const std::string & calcite_expression, gdf_column_cpp & output) {
 	// make temp a column of size 8 bytes so it can accomodate the largest possible size
 
 	size_t num_columns = inputs.get_size_column();
 
+	std::string expression = evaluate_in_lists(inputs, calcite_expression);
+
 	// special case when there is nothing to evaluate in the condition expression i.e. LogicalFilter(condition=[$16])
 	if(expression[0] == '$') {
 		size_t index = get_index(expression);
 		if(index >= 0) {
-			output = inputs.get_column(index).clone();
+			output = inputs.has_selection() ? inputs.gather_selected(inputs.get_column(index))
+											: inputs.get_column(index).clone();
+			inputs.resize_num_columns(num_columns);
 			return;
 		}
 	}
@@ -729,7 +844,8 @@ void evaluate_expression(blazing_frame & inputs, const std::string & expression,
 		unary_operators,
 		left_scalars,
 		right_scalars,
-		new_column_indices);
+		new_column_indices,
+		inputs.has_selection() ? inputs.get_selection().get_gdf_column() : nullptr);
 
 	// Remove any temp column added by add_expression_to_plan
 	inputs.resize_num_columns(num_columns);
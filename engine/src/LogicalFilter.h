@@ -19,6 +19,24 @@ typedef short column_index_type;
 
 void evaluate_expression(blazing_frame & inputs, const std::string & expression, gdf_column_cpp & output);
 
+/**
+ * Evaluates the large IN lists of expression with a membership lookup instead of a chain of comparisons. The results
+ * are added to inputs as boolean columns and the returned expression refers to them, callers drop them from inputs
+ * once the expression has been evaluated.
+ */
+std::string evaluate_in_lists(blazing_frame & inputs, const std::string & expression);
+
+struct expression_register_usage {
+	column_index_type temp_registers;  // intermediate results that are alive at the same time
+	column_index_type new_inputs;	  // upper bound of the string columns add_expression_to_plan may materialize
+};
+
+/**
+ * Replays the register allocation of add_expression_to_plan without building anything so callers can
+ * tell how many expressions fit in one interpreter kernel. tokens come from get_tokens_in_reverse_order.
+ */
+expression_register_usage get_expression_register_usage(const std::vector<std::string> & tokens);
+
 
 void add_expression_to_plan(blazing_frame & inputs,
 	std::vector<gdf_column *> & input_columns,
@@ -6,10 +6,48 @@
  */
 
 #include "ResultSetRepository.h"
+#include "Traits/RuntimeTraits.h"
 #include "cuDF/Allocator.h"
 #include <algorithm>
+#include <blazingdb/io/Library/Metrics/MetricsRegistry.h>
 #include <random>
 
+namespace {
+
+Library::Metrics::Gauge & get_result_sets_gauge() {
+	static Library::Metrics::Gauge & gauge = Library::Metrics::MetricsRegistry::getInstance().getGauge(
+		"blazing_result_sets", "Results of queries held for their clients, finished or not");
+	return gauge;
+}
+
+Library::Metrics::Gauge & get_result_bytes_gauge() {
+	static Library::Metrics::Gauge & gauge = Library::Metrics::MetricsRegistry::getInstance().getGauge(
+		"blazing_result_bytes_held", "Device memory held by the columns of the results");
+	return gauge;
+}
+
+int64_t get_column_bytes(gdf_column_cpp & column) {
+	if(column.get_gdf_column() == nullptr) {
+		return 0;
+	}
+	if(column.dtype() == GDF_STRING) {
+		return column.data() != nullptr ? static_cast<NVStrings *>(column.data())->memsize() : 0;
+	}
+	int64_t bytes = ral::traits::get_data_size_in_bytes(column);
+	if(column.valid() != nullptr) {
+		bytes += ral::traits::get_bitmask_size_in_bytes(column.size());
+	}
+	return bytes;
+}
+
+}  // namespace
+
+std::atomic<int64_t> result_set_repository::result_ttl_seconds{600};
+
+void result_set_repository::set_result_ttl(std::chrono::seconds ttl) { result_ttl_seconds = ttl.count(); }
+
+std::chrono::seconds result_set_repository::get_result_ttl() { return std::chrono::seconds(result_ttl_seconds); }
+
 result_set_repository::result_set_repository() {
 	// nothing really has to be instantiated
 }
@@ -18,17 +56,38 @@ result_set_repository::~result_set_repository() {
 	// nothing needs to be destroyed
 }
 
+std::shared_ptr<result_set_repository::token_state> result_set_repository::find_token(query_token_t token) {
+	token_shard & shard = get_shard(this->token_shards, token);
+	std::lock_guard<std::mutex> guard(shard.mutex);
+	auto state = shard.tokens.find(token);
+	return state != shard.tokens.end() ? state->second : nullptr;
+}
+
+bool result_set_repository::has_connection(connection_id_t connection) {
+	connection_shard & shard = get_shard(this->connection_shards, connection);
+	std::lock_guard<std::mutex> guard(shard.mutex);
+	return shard.tokens.find(connection) != shard.tokens.end();
+}
+
 void result_set_repository::add_token(query_token_t token, connection_id_t connection) {
-	std::lock_guard<std::mutex> guard(this->repo_mutex);
-	blazing_frame temp;
-	this->result_sets[token] = {false, temp, 0.0, "", 0};
+	auto state = std::make_shared<token_state>();
+	state->result = {false, blazing_frame{}, 0.0, "", 0, nullptr, nullptr};
+	state->connection = connection;
+	state->last_update = std::chrono::steady_clock::now();
 
-	if(this->connection_result_sets.find(connection) == this->connection_result_sets.end()) {
-		std::vector<query_token_t> empty_tokens;
-		this->connection_result_sets[connection] = empty_tokens;
+	{
+		token_shard & shard = get_shard(this->token_shards, token);
+		std::lock_guard<std::mutex> guard(shard.mutex);
+		if(shard.tokens.find(token) == shard.tokens.end()) {
+			get_result_sets_gauge().add(1);
+		}
+		shard.tokens[token] = state;
+	}
+	{
+		connection_shard & shard = get_shard(this->connection_shards, connection);
+		std::lock_guard<std::mutex> guard(shard.mutex);
+		shard.tokens[connection].push_back(token);
 	}
-
-	this->connection_result_sets[connection].push_back(token);
 }
 
 query_token_t result_set_repository::register_query(connection_id_t connection, query_token_t token) {
@@ -36,25 +95,39 @@ query_token_t result_set_repository::register_query(connection_id_t connection,
 	this->connection_result_sets.end()){ throw std::runtime_error{"Connection does not exist"};
 	}*/
 
-
+	this->maybe_evict_expired_results();
 	this->add_token(token, connection);
 	return token;
 }
 
 void result_set_repository::update_token(
-	query_token_t token, blazing_frame frame, double duration, std::string errorMsg) {
-	if(this->result_sets.find(token) == this->result_sets.end()) {
+	query_token_t token,
+	blazing_frame frame,
+	double duration,
+	std::string errorMsg,
+	std::shared_ptr<blazingdb::manager::MemoryTracker> memory,
+	std::shared_ptr<const ral::profile::query_profile> profile) {
+	std::shared_ptr<token_state> state = this->find_token(token);
+	if(state == nullptr) {
 		throw std::runtime_error{"Token does not exist"};
 	}
 
-	// std::cout<<"Beginning of update token"<<std::endl;
-	// for(size_t i = 0; i < frame.get_width(); i++){
-	// 	std::cout<<"Output column name: "<<frame.get_column(i).name()<<std::endl;
-	// 	print_gdf_column(frame.get_column(i).get_gdf_column());
-	// }
+	this->prepare_frame(frame);
 
-	// std::cout<<"printed update token columns"<<std::endl;
+	{
+		std::lock_guard<std::mutex> guard(state->mutex);
+		if(state->freed) {
+			// freed by the client or expired while the query ran
+			this->free_frame(frame);
+			return;
+		}
+		state->result = {true, frame, duration, errorMsg, 0, memory, profile};
+		state->last_update = std::chrono::steady_clock::now();
+	}
+	state->changed.notify_all();
+}
 
+void result_set_repository::prepare_frame(blazing_frame & frame) {
 	// lets deduplicate before we put into the results repo, because we wont be able to reopen an ipc
 	frame.deduplicate();
 
@@ -93,24 +166,62 @@ void result_set_repository::update_token(
 		if(column_token == 0) {
 			column_token = gen_token<column_token_t>();
 			frame.get_column(i).set_column_token(column_token);
-			this->precalculated_columns[column_token] = frame.get_column(i);
+			column_shard & shard = get_shard(this->column_shards, column_token);
+			std::lock_guard<std::mutex> guard(shard.mutex);
+			shard.columns[column_token] = frame.get_column(i);
+			get_result_bytes_gauge().add(get_column_bytes(frame.get_column(i)));
 		}
 	}
+}
 
-	{
-		std::lock_guard<std::mutex> guard(this->repo_mutex);
-		this->result_sets[token] = {true, frame, duration, errorMsg, 0};
+void result_set_repository::free_frame(blazing_frame & frame) {
+	for(size_t i = 0; i < frame.get_width(); i++) {
+		column_token_t column_token = frame.get_column(i).get_column_token();
+		{
+			column_shard & shard = get_shard(this->column_shards, column_token);
+			std::lock_guard<std::mutex> guard(shard.mutex);
+			auto column = shard.columns.find(column_token);
+			if(column != shard.columns.end()) {
+				get_result_bytes_gauge().add(-get_column_bytes(column->second));
+				shard.columns.erase(column);
+			}
+		}
+		GDFRefCounter::getInstance()->free(frame.get_column(i).get_gdf_column());
 	}
+}
 
-	// for(size_t i = 0; i < frame.get_width(); i++){
-	// 	std::cout<<"Output column name: "<<frame.get_column(i).name()<<std::endl;
-	// 	print_gdf_column(frame.get_column(i).get_gdf_column());
-	// }
+size_t result_set_repository::evict_expired_results() {
+	const std::chrono::seconds ttl = get_result_ttl();
+	if(ttl.count() <= 0) {
+		return 0;
+	}
 
-	// std::cout<<"Completed update token"<<std::endl;
+	const auto now = std::chrono::steady_clock::now();
+	std::vector<std::pair<connection_id_t, query_token_t>> expired;
+	for(token_shard & shard : this->token_shards) {
+		std::lock_guard<std::mutex> guard(shard.mutex);
+		for(auto & entry : shard.tokens) {
+			token_state & state = *entry.second;
+			std::lock_guard<std::mutex> state_guard(state.mutex);
+			if(state.result.is_ready && !state.claimed && state.result.ref_counter == 0 && now - state.last_update > ttl) {
+				expired.emplace_back(state.connection, entry.first);
+			}
+		}
+	}
 
+	for(auto & token : expired) {
+		this->free_result(token.first, token.second);
+	}
+	return expired.size();
+}
 
-	cv.notify_all();
+void result_set_repository::maybe_evict_expired_results() {
+	int64_t now =
+		std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	int64_t last = this->last_eviction;
+	if(now > last && this->last_eviction.compare_exchange_strong(last, now)) {
+		this->evict_expired_results();
+	}
 }
 
 // ToDo uuid instead dummy random
@@ -122,106 +233,155 @@ connection_id_t result_set_repository::init_session() {
 
 	connection_id_t session = dis(gen);
 
-	if(this->connection_result_sets.find(session) != this->connection_result_sets.end()) {
+	connection_shard & shard = get_shard(this->connection_shards, session);
+	std::lock_guard<std::mutex> guard(shard.mutex);
+	if(shard.tokens.find(session) != shard.tokens.end()) {
 		throw std::runtime_error{"Connection already exists"};
 	}
-
-	std::lock_guard<std::mutex> guard(this->repo_mutex);
-	std::vector<query_token_t> empty_tokens;
-	this->connection_result_sets[session] = empty_tokens;
+	shard.tokens[session] = std::vector<query_token_t>();
 	return session;
 }
 
 void result_set_repository::free_result(connection_id_t connection, query_token_t token) {
-	std::vector<query_token_t> & tokens = this->connection_result_sets[connection];
-	tokens.erase(std::remove(tokens.begin(), tokens.end(), token), tokens.end());  // remove
-
-	blazing_frame output_frame = this->result_sets[token].result_frame;
+	{
+		connection_shard & shard = get_shard(this->connection_shards, connection);
+		std::lock_guard<std::mutex> guard(shard.mutex);
+		auto tokens = shard.tokens.find(connection);
+		if(tokens != shard.tokens.end()) {
+			tokens->second.erase(
+				std::remove(tokens->second.begin(), tokens->second.end(), token), tokens->second.end());  // remove
+		}
+	}
 
-	for(size_t i = 0; i < output_frame.get_width(); i++) {
-		GDFRefCounter::getInstance()->free(output_frame.get_column(i).get_gdf_column());
+	std::shared_ptr<token_state> state;
+	{
+		token_shard & shard = get_shard(this->token_shards, token);
+		std::lock_guard<std::mutex> guard(shard.mutex);
+		auto found = shard.tokens.find(token);
+		if(found == shard.tokens.end()) {
+			return;
+		}
+		state = found->second;
+		shard.tokens.erase(found);
+		get_result_sets_gauge().add(-1);
 	}
 
-	this->result_sets.erase(token);
+	{
+		std::lock_guard<std::mutex> guard(state->mutex);
+		state->freed = true;
+		this->free_frame(state->result.result_frame);
+	}
+	// clients waiting on it fail
+	state->changed.notify_all();
 }
 
 void result_set_repository::remove_all_connection_tokens(connection_id_t connection) {
-	if(this->connection_result_sets.find(connection) == this->connection_result_sets.end()) {
-		// TODO percy uncomment this later
-		// WARNING uncomment this ... avoid leaks
-		// throw std::runtime_error{"Closing a connection that did not exist"};
+	std::vector<query_token_t> tokens;
+	{
+		connection_shard & shard = get_shard(this->connection_shards, connection);
+		std::lock_guard<std::mutex> guard(shard.mutex);
+		auto found = shard.tokens.find(connection);
+		if(found == shard.tokens.end()) {
+			// TODO percy uncomment this later
+			// WARNING uncomment this ... avoid leaks
+			// throw std::runtime_error{"Closing a connection that did not exist"};
+			return;
+		}
+		tokens = found->second;
+		shard.tokens.erase(found);
 	}
 
-	std::lock_guard<std::mutex> guard(this->repo_mutex);
-	for(query_token_t token : this->connection_result_sets[connection]) {
-		if(this->result_sets[token].ref_counter == 0) {
+	for(query_token_t token : tokens) {
+		std::shared_ptr<token_state> state = this->find_token(token);
+		if(state == nullptr) {
+			continue;
+		}
+		bool referenced;
+		{
+			std::lock_guard<std::mutex> guard(state->mutex);
+			referenced = state->result.ref_counter > 0;
+		}
+		if(!referenced) {
 			this->free_result(connection, token);
 		}
 	}
-	this->connection_result_sets.erase(connection);
 }
 
 bool result_set_repository::try_free_result(connection_id_t connection, query_token_t token) {
-	std::lock_guard<std::mutex> guard(this->repo_mutex);
-
-	if(this->connection_result_sets.find(connection) == this->connection_result_sets.end()) {
+	if(!this->has_connection(connection)) {
 		throw std::runtime_error{"Connection does not exist"};
 	}
 
-	if(this->result_sets.find(token) != this->result_sets.end()) {
-		if(this->result_sets[token].ref_counter == 1) {  // this is the last one reference
-			this->free_result(connection, token);
-		} else {  // it is being referenced yet
-			this->result_sets[token].ref_counter--;
+	std::shared_ptr<token_state> state = this->find_token(token);
+	if(state == nullptr) {
+		return false;
+	}
+
+	{
+		std::lock_guard<std::mutex> guard(state->mutex);
+		if(state->result.ref_counter > 1) {  // it is being referenced yet
+			state->result.ref_counter--;
+			return true;
 		}
-		return true;
 	}
-	return false;
+	// this is the last one reference
+	this->free_result(connection, token);
+	return true;
 }
 
 result_set_t result_set_repository::get_result(connection_id_t connection, query_token_t token) {
-	if(this->connection_result_sets.find(connection) == this->connection_result_sets.end()) {
+	if(!this->has_connection(connection)) {
 		throw std::runtime_error{"Connection does not exist"};
 	}
 
-	if(this->result_sets.find(token) == this->result_sets.end()) {
+	std::shared_ptr<token_state> state = this->find_token(token);
+	if(state == nullptr) {
 		throw std::runtime_error{"Result set does not exist"};
 	}
-	{
-		// scope the lockguard here
-		std::unique_lock<std::mutex> lock(this->repo_mutex);
-		cv.wait(lock, [this, token]() { return this->result_sets[token].is_ready; });
 
-		this->result_sets[token].ref_counter++;
+	std::unique_lock<std::mutex> lock(state->mutex);
+	state->claimed = true;
+	state->changed.wait(lock, [&state]() { return state->freed || state->result.is_ready; });
+	if(state->freed) {
+		throw std::runtime_error{"Result set does not exist"};
+	}
 
-		blazing_frame output_frame = this->result_sets[token].result_frame;
+	state->result.ref_counter++;
 
-		for(size_t i = 0; i < output_frame.get_width(); i++) {
-			GDFRefCounter::getInstance()->deregister_column(output_frame.get_column(i).get_gdf_column());
-		}
+	blazing_frame output_frame = state->result.result_frame;
 
-		return this->result_sets[token];
+	for(size_t i = 0; i < output_frame.get_width(); i++) {
+		GDFRefCounter::getInstance()->deregister_column(output_frame.get_column(i).get_gdf_column());
 	}
+
+	return state->result;
 }
 
 // WARNING do not call this on anything that will be ipced!!!
 gdf_column_cpp result_set_repository::get_column(connection_id_t connection, column_token_t columnToken) {
-	if(this->connection_result_sets.find(connection) == this->connection_result_sets.end()) {
+	if(!this->has_connection(connection)) {
 		throw std::runtime_error{"Connection does not exist"};
 	}
 
-	if(this->precalculated_columns.find(columnToken) == this->precalculated_columns.end()) {
-		throw std::runtime_error{"Column does not exist"};
+	gdf_column_cpp column;
+	{
+		column_shard & shard = get_shard(this->column_shards, columnToken);
+		std::lock_guard<std::mutex> guard(shard.mutex);
+		auto found = shard.columns.find(columnToken);
+		if(found == shard.columns.end()) {
+			throw std::runtime_error{"Column does not exist"};
+		}
+		column = found->second;
 	}
-	if(this->precalculated_columns[columnToken].dtype() == GDF_STRING) {
+
+	if(column.dtype() == GDF_STRING) {
 		gdf_column_cpp temp_column;  // allocar convertir a NVCategory
-		NVStrings * strings = static_cast<NVStrings *>(this->precalculated_columns[columnToken].data());
+		NVStrings * strings = static_cast<NVStrings *>(column.data());
 		NVCategory * category =
 			strings ? NVCategory::create_from_strings(*strings) : NVCategory::create_from_array(nullptr, 0);
-		temp_column.create_gdf_column(
-			category, this->precalculated_columns[columnToken].size(), this->precalculated_columns[columnToken].name());
+		temp_column.create_gdf_column(category, column.size(), column.name());
 		return temp_column;
 	} else {
-		return this->precalculated_columns[columnToken];
+		return column;
 	}
 }
@@ -10,10 +10,17 @@
 
 #include "DataFrame.h"
 #include "Types.h"
+#include "profile/QueryProfile.h"
+#include <array>
+#include <atomic>
+#include <blazingdb/manager/MemoryTracker.h>
+#include <chrono>
 #include <condition_variable>
-#include <map>
+#include <functional>
+#include <memory>
 #include <mutex>
 #include <random>
+#include <unordered_map>
 #include <vector>
 
 typedef void * response_descriptor;  // this shoudl be substituted for something that can generate a response
@@ -24,9 +31,11 @@ struct result_set_t {
 	double duration;
 	std::string errorMsg;
 	size_t ref_counter;
+	std::shared_ptr<blazingdb::manager::MemoryTracker> memory;  // peak and per operator usage of the query, if any
+	std::shared_ptr<const ral::profile::query_profile> profile;  // what every operator of the query did, if any
 };
 
-// singleton class
+// singleton class. Holds the results of the queries until their clients fetch and free them.
 class result_set_repository {
 public:
 	bool try_free_result(connection_id_t connection, query_token_t token);
@@ -39,7 +48,22 @@ public:
 	}
 
 	query_token_t register_query(connection_id_t connection, query_token_t token);
-	void update_token(query_token_t token, blazing_frame frame, double duration, std::string errorMsg = "");
+	void update_token(query_token_t token,
+		blazing_frame frame,
+		double duration,
+		std::string errorMsg = "",
+		std::shared_ptr<blazingdb::manager::MemoryTracker> memory = nullptr,
+		std::shared_ptr<const ral::profile::query_profile> profile = nullptr);
+
+	// Results ready for longer than the ttl without any client fetching them are freed, 0 keeps them until their
+	// connection closes. 10 minutes by default.
+	static void set_result_ttl(std::chrono::seconds ttl);
+
+	static std::chrono::seconds get_result_ttl();
+
+	// Frees the results that expired, returns how many
+	size_t evict_expired_results();
+
 	connection_id_t init_session();
 	void remove_all_connection_tokens(connection_id_t connection);
 	result_set_t get_result(connection_id_t connection, query_token_t token);
@@ -49,14 +73,63 @@ public:
 	void operator=(result_set_repository const &) = delete;
 
 private:
-	std::map<query_token_t, result_set_t> result_sets;
-	std::map<connection_id_t, std::vector<query_token_t>> connection_result_sets;
-	std::map<column_token_t, gdf_column_cpp> precalculated_columns;
+	static const size_t NUM_SHARDS = 64;
+
+	// A registered query and the clients waiting on it. Waiting on its own condition, a client only wakes when its
+	// query changes.
+	struct token_state {
+		std::mutex mutex;
+		std::condition_variable changed;  // the result got ready or it was freed
+		result_set_t result;
+		connection_id_t connection;
+		bool claimed = false;  // a client fetched it, it is not evicted
+		bool freed = false;
+		std::chrono::steady_clock::time_point last_update;
+	};
+
+	// tokens, connections and columns are split by their value so concurrent sessions rarely share a lock
+	struct token_shard {
+		std::mutex mutex;
+		std::unordered_map<query_token_t, std::shared_ptr<token_state>> tokens;
+	};
+
+	struct connection_shard {
+		std::mutex mutex;
+		std::unordered_map<connection_id_t, std::vector<query_token_t>> tokens;
+	};
+
+	struct column_shard {
+		std::mutex mutex;
+		std::unordered_map<column_token_t, gdf_column_cpp> columns;
+	};
+
+	template <typename Shard>
+	static Shard & get_shard(std::array<Shard, NUM_SHARDS> & shards, uint64_t key) {
+		return shards[std::hash<uint64_t>{}(key) % NUM_SHARDS];
+	}
+
+	// nullptr when the token is not registered or was freed
+	std::shared_ptr<token_state> find_token(query_token_t token);
+
+	bool has_connection(connection_id_t connection);
 
 	void add_token(query_token_t token, connection_id_t connection);
-	std::map<query_token_t, response_descriptor> requested_responses;
-	std::mutex repo_mutex;
-	std::condition_variable cv;
+
+	// deregisters the columns of a result before they are ipced, converting string categories to strings
+	void prepare_frame(blazing_frame & frame);
+
+	// frees the columns of a result the repository holds
+	void free_frame(blazing_frame & frame);
+
+	// evicts expired results at most once a second, from the calls that register queries
+	void maybe_evict_expired_results();
+
+	std::array<token_shard, NUM_SHARDS> token_shards;
+	std::array<connection_shard, NUM_SHARDS> connection_shards;
+	std::array<column_shard, NUM_SHARDS> column_shards;
+	std::atomic<int64_t> last_eviction{0};
+
+	static std::atomic<int64_t> result_ttl_seconds;
 };
 
 template <typename T>
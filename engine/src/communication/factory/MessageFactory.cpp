@@ -28,6 +28,13 @@ std::shared_ptr<Message> Factory::createPartitionPivotsMessage(const std::string
 	return std::make_shared<PartitionPivotsMessage>(message_token, context_token, sender_node, columns);
 }
 
+std::shared_ptr<Message> Factory::createTraceSpansMessage(const std::string & message_token,
+	const ContextToken & context_token,
+	std::shared_ptr<Node> & sender_node,
+	std::vector<gdf_column_cpp> columns) {
+	return std::make_shared<TraceSpansMessage>(message_token, context_token, sender_node, columns);
+}
+
 }  // namespace messages
 }  // namespace communication
 }  // namespace ral
@@ -29,6 +29,11 @@ struct Factory {
 		const ContextToken & context_token,
 		std::shared_ptr<Node> & sender_node,
 		std::vector<gdf_column_cpp> columns);
+
+	static std::shared_ptr<Message> createTraceSpansMessage(const std::string & message_token,
+		const ContextToken & context_token,
+		std::shared_ptr<Node> & sender_node,
+		std::vector<gdf_column_cpp> columns);
 };
 
 }  // namespace messages
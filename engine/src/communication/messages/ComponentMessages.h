@@ -66,6 +66,26 @@ struct PartitionPivotsMessage : GPUComponentMessage {
 	}
 };
 
+// The spans a node recorded for a query, serialized by its trace as one GDF_INT8 column
+struct TraceSpansMessage : GPUComponentMessage {
+	TraceSpansMessage(const std::string & message_token,
+		const uint32_t & context_token,
+		std::shared_ptr<Node> & sender_node,
+		std::vector<gdf_column_cpp> & samples)
+		: GPUComponentMessage(message_token, context_token, sender_node, samples) {}
+
+	DefineClassName(TraceSpansMessage);
+
+	std::vector<gdf_column_cpp> getColumns() { return this->samples; }
+
+	static std::shared_ptr<GPUMessage> MakeFrom(const Message::MetaData & message_metadata,
+		const Address::MetaData & address_metadata,
+		const std::vector<ColumnTransport> & columns_offsets,
+		const std::vector<char *> & raw_buffers) {
+		return GPUComponentMessage::MakeFrom(message_metadata, address_metadata, columns_offsets, raw_buffers);
+	}
+};
+
 }  // namespace messages
 }  // namespace communication
 }  // namespace ral
@@ -1,5 +1,7 @@
 #include "communication/network/Client.h"
 #include "config/GPUManager.cuh"
+#include "profile/QueryTrace.h"
+#include <blazingdb/io/Library/Metrics/MetricsRegistry.h>
 #include <blazingdb/manager/Manager.h>
 #include <blazingdb/transport/Client.h>
 #include <blazingdb/transport/api.h>
@@ -13,8 +15,21 @@ namespace network {
 // concurrent::send
 blazingdb::transport::Status Client::send(const Node & node, GPUMessage & message) {
 	const auto & metadata = node.address()->metadata();
+	ral::profile::trace_scope send_span(
+		message.getContextTokenValue(), ral::profile::span_kind::SEND, message.getMessageTokenValue());
+	message.metadata().trace.spanId = send_span.get_span_id();
+
 	auto ral_client = blazingdb::transport::ClientTCP::Make(metadata.ip, metadata.comunication_port);
-	return ral_client->Send(message);
+	blazingdb::transport::Status status = ral_client->Send(message);
+	send_span.set_bytes(status.Bytes());
+
+	static Library::Metrics::Counter & sent_bytes = Library::Metrics::MetricsRegistry::getInstance().getCounter(
+		"blazing_transport_sent_bytes_total", "Bytes of columns sent to other nodes");
+	static Library::Metrics::Counter & sent_messages = Library::Metrics::MetricsRegistry::getInstance().getCounter(
+		"blazing_transport_sent_messages_total", "Messages sent to other nodes");
+	sent_bytes.increment(status.Bytes());
+	sent_messages.increment();
+	return status;
 }
 
 void Client::closeConnections() {
@@ -2,6 +2,8 @@
 #include "communication/messages/ComponentMessages.h"
 #include "communication/messages/GPUComponentMessage.h"
 #include "config/GPUManager.cuh"
+#include "profile/QueryTrace.h"
+#include <blazingdb/io/Library/Metrics/MetricsRegistry.h>
 
 namespace ral {
 namespace communication {
@@ -10,6 +12,14 @@ namespace network {
 unsigned short Server::port_ = 8000;
 std::map<int, Server *> servers_;
 
+namespace {
+Library::Metrics::Histogram & get_message_wait_seconds() {
+	static Library::Metrics::Histogram & histogram = Library::Metrics::MetricsRegistry::getInstance().getHistogram(
+		"blazing_transport_message_wait_seconds", "Time spent waiting for a message from another node", 1e-6);
+	return histogram;
+}
+}  // namespace
+
 // [static]
 void Server::start(unsigned short port) {
 	port_ = port;
@@ -27,6 +37,15 @@ Server & Server::getInstance() { return *servers_[port_]; }
 
 Server::Server() {
 	comm_server = CommServer::TCP(port_);
+	Library::Metrics::MetricsRegistry & registry = Library::Metrics::MetricsRegistry::getInstance();
+	Library::Metrics::Counter & received_bytes = registry.getCounter(
+		"blazing_transport_received_bytes_total", "Bytes of columns received from other nodes");
+	Library::Metrics::Counter & received_messages =
+		registry.getCounter("blazing_transport_received_messages_total", "Messages received from other nodes");
+	comm_server->setReceiveCallback([&received_bytes, &received_messages](std::size_t bytes) {
+		received_bytes.increment(bytes);
+		received_messages.increment();
+	});
 	setEndPoints();
 	comm_server->Run();
 }
@@ -39,7 +58,46 @@ void Server::deregisterContext(const ContextToken context_token) { comm_server->
 
 std::shared_ptr<GPUMessage> Server::getMessage(
 	const ContextToken & token_value, const MessageTokenType & messageToken) {
-	return comm_server->getMessage(token_value, messageToken);
+	std::shared_ptr<GPUMessage> message;
+	{
+		ral::profile::trace_scope wait_span(token_value, ral::profile::span_kind::WAIT, messageToken);
+		Library::Metrics::ScopedLatency wait(get_message_wait_seconds());
+		message = comm_server->getMessage(token_value, messageToken);
+		wait_span.set_link_id(message->metadata().trace.spanId);
+	}
+	traceReceived(token_value, message);
+	return message;
+}
+
+std::shared_ptr<GPUMessage> Server::getMessage(
+	const ContextToken & token_value, const MessageTokenType & messageToken, std::chrono::milliseconds timeout) {
+	std::shared_ptr<GPUMessage> message;
+	{
+		ral::profile::trace_scope wait_span(token_value, ral::profile::span_kind::WAIT, messageToken);
+		Library::Metrics::ScopedLatency wait(get_message_wait_seconds());
+		message = comm_server->getMessage(token_value, messageToken, timeout);
+		if(message == nullptr) {
+			return nullptr;
+		}
+		wait_span.set_link_id(message->metadata().trace.spanId);
+	}
+	traceReceived(token_value, message);
+	return message;
+}
+
+// the server read the message before it was queued, its span goes to the trace once a query thread takes it
+void Server::traceReceived(const ContextToken & token_value, const std::shared_ptr<GPUMessage> & message) {
+	std::shared_ptr<ral::profile::query_trace> trace = ral::profile::find_trace(token_value);
+	if(trace != nullptr) {
+		const blazingdb::transport::Message::TraceMetaData & message_trace = message->metadata().trace;
+		trace->add_span(ral::profile::span_kind::RECEIVE,
+			message->getMessageTokenValue(),
+			message_trace.receiveBeginUs,
+			message_trace.receiveEndUs,
+			trace->next_span_id(),
+			message_trace.spanId,
+			message_trace.receivedBytes);
+	}
 }
 
 void Server::setEndPoints() {
@@ -65,6 +123,13 @@ void Server::setEndPoints() {
 		comm_server->registerMessageForEndPoint(
 			ral::communication::messages::PartitionPivotsMessage::MakeFrom, endpoint);
 	}
+
+	// message TraceSpansMessage
+	{
+		const std::string endpoint = messages::TraceSpansMessage::MessageID();
+		comm_server->registerEndPoint(endpoint);
+		comm_server->registerMessageForEndPoint(ral::communication::messages::TraceSpansMessage::MakeFrom, endpoint);
+	}
 }
 
 }  // namespace network
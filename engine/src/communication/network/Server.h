@@ -2,6 +2,7 @@
 
 #include <blazingdb/transport/Message.h>
 #include <blazingdb/transport/Server.h>
+#include <chrono>
 #include <thread>
 
 namespace ral {
@@ -34,6 +35,10 @@ public:
 public:
 	std::shared_ptr<GPUMessage> getMessage(const ContextToken & token_value, const MessageTokenType & messageToken);
 
+	// nullptr when the message did not arrive before timeout
+	std::shared_ptr<GPUMessage> getMessage(
+		const ContextToken & token_value, const MessageTokenType & messageToken, std::chrono::milliseconds timeout);
+
 private:
 	Server(Server &&) = delete;
 
@@ -44,6 +49,9 @@ private:
 	Server & operator=(const Server &) = delete;
 
 private:
+	// adds the receive span of a message a query thread took to the trace of its query
+	void traceReceived(const ContextToken & token_value, const std::shared_ptr<GPUMessage> & message);
+
 	void setEndPoints();
 
 private:
@@ -1,6 +1,11 @@
 #include "cuDF/Allocator.h"
 #include "rmm/rmm.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
 #include <rmm/rmm.h>
+#include <unordered_map>
 
 namespace cuDF {
 namespace Allocator {
@@ -9,12 +14,87 @@ const std::string BASE_MESSAGE{"ERROR, cuDF::Allocator, "};
 
 void throwException(rmmError_t error, const std::string & during_msg);
 
+namespace {
+
+class rmm_memory_resource : public memory_resource {
+public:
+	void allocate(void ** pointer, std::size_t size, cudaStream_t stream) override {
+		auto error = RMM_ALLOC(pointer, size, stream);
+
+		if(error != RMM_SUCCESS) {
+			std::string during_msg = "During allocate of size: " + std::to_string(size);
+			throwException(error, during_msg);
+		}
+	}
+
+	void deallocate(void * pointer, cudaStream_t stream) override {
+		auto error = RMM_FREE(pointer, stream);
+
+		// commenting out this error handling because deallocate can fail during clean up of other caught errors,
+		// where if we throw an error during an error handling, it can make it really crash if (error != RMM_SUCCESS) {
+		//     std::string during_msg = "During deallocate";
+		//     if (pointer == nullptr)
+		//         during_msg = "During deallocate of nullptr";
+		//     throwException(error, during_msg);
+		// }
+	}
+};
+
+std::shared_ptr<memory_resource> resource = std::make_shared<rmm_memory_resource>();
+
+std::atomic<std::size_t> default_query_memory_budget{0};
+
+thread_local memory_attribution current_attribution;
+
+// The allocations accounted to a query, so they are released from it when freed. Split by pointer so concurrent
+// queries rarely share a lock.
+struct accounted_allocation {
+	std::size_t size;
+	memory_attribution attribution;
+};
+
+struct allocations_shard {
+	std::mutex mutex;
+	std::unordered_map<void *, accounted_allocation> allocations;
+};
+
+const std::size_t NUM_ALLOCATION_SHARDS = 64;
+
+allocations_shard & get_allocations_shard(void * pointer) {
+	static std::array<allocations_shard, NUM_ALLOCATION_SHARDS> shards;
+	return shards[(reinterpret_cast<std::uintptr_t>(pointer) >> 8) % NUM_ALLOCATION_SHARDS];
+}
+
+}  // namespace
+
 void allocate(void ** pointer, std::size_t size, cudaStream_t stream) {
-	auto error = RMM_ALLOC(pointer, size, stream);
+	const memory_attribution & attribution = memory_scope::current();
+	blazingdb::manager::MemoryTracker * tracker = attribution.tracker.get();
+
+	if(tracker != nullptr && !tracker->tryReserve(size, attribution.operator_name)) {
+		throw QueryMemoryExceeded("During allocate of size: " + std::to_string(size) + " in " +
+								  attribution.operator_name + ", the query holds " +
+								  std::to_string(tracker->getCurrent()) + " bytes of its budget of " +
+								  std::to_string(tracker->getBudget()));
+	}
+
+	try {
+		get_memory_resource()->allocate(pointer, size, stream);
+	} catch(...) {
+		if(tracker != nullptr) {
+			tracker->release(size, attribution.operator_name);
+		}
+		throw;
+	}
 
-	if(error != RMM_SUCCESS) {
-		std::string during_msg = "During allocate of size: " + std::to_string(size);
-		throwException(error, during_msg);
+	if(tracker != nullptr) {
+		if(*pointer == nullptr) {
+			tracker->release(size, attribution.operator_name);
+			return;
+		}
+		allocations_shard & shard = get_allocations_shard(*pointer);
+		std::lock_guard<std::mutex> lock(shard.mutex);
+		shard.allocations[*pointer] = accounted_allocation{size, attribution};
 	}
 }
 
@@ -31,17 +111,60 @@ void reallocate(void ** pointer, std::size_t size, cudaStream_t stream) {
 }
 
 void deallocate(void * pointer, cudaStream_t stream) {
-	auto error = RMM_FREE(pointer, stream);
-
-	// commenting out this error handling because deallocate can fail during clean up of other caught errors, where if
-	// we throw an error during an error handling, it can make it really crash if (error != RMM_SUCCESS) {
-	//     std::string during_msg = "During deallocate";
-	//     if (pointer == nullptr)
-	//         during_msg = "During deallocate of nullptr";
-	//     throwException(error, during_msg);
-	// }
+	if(pointer != nullptr) {
+		accounted_allocation allocation{0, {}};
+		{
+			allocations_shard & shard = get_allocations_shard(pointer);
+			std::lock_guard<std::mutex> lock(shard.mutex);
+			auto it = shard.allocations.find(pointer);
+			if(it != shard.allocations.end()) {
+				allocation = std::move(it->second);
+				shard.allocations.erase(it);
+			}
+		}
+		if(allocation.attribution.tracker != nullptr) {
+			allocation.attribution.tracker->release(allocation.size, allocation.attribution.operator_name);
+		}
+	}
+
+	get_memory_resource()->deallocate(pointer, stream);
+}
+
+void adopt(void * pointer, std::size_t size) {
+	const memory_attribution & attribution = memory_scope::current();
+	if(pointer == nullptr || size == 0 || attribution.tracker == nullptr) {
+		return;
+	}
+
+	allocations_shard & shard = get_allocations_shard(pointer);
+	std::lock_guard<std::mutex> lock(shard.mutex);
+	if(shard.allocations.count(pointer) == 0) {
+		attribution.tracker->reserve(size, attribution.operator_name);
+		shard.allocations[pointer] = accounted_allocation{size, attribution};
+	}
+}
+
+void set_memory_resource(std::shared_ptr<memory_resource> new_resource) { std::atomic_store(&resource, new_resource); }
+
+std::shared_ptr<memory_resource> get_memory_resource() { return std::atomic_load(&resource); }
+
+void set_default_query_memory_budget(std::size_t budget) { default_query_memory_budget = budget; }
+
+std::size_t get_default_query_memory_budget() { return default_query_memory_budget; }
+
+memory_scope::memory_scope(std::shared_ptr<blazingdb::manager::MemoryTracker> tracker, std::string operator_name)
+	: previous(std::move(current_attribution)) {
+	current_attribution = memory_attribution{std::move(tracker), std::move(operator_name)};
 }
 
+memory_scope::memory_scope(memory_attribution attribution) : previous(std::move(current_attribution)) {
+	current_attribution = std::move(attribution);
+}
+
+memory_scope::~memory_scope() { current_attribution = std::move(previous); }
+
+const memory_attribution & memory_scope::current() { return current_attribution; }
+
 void throwException(rmmError_t error, const std::string & during_msg) {
 	switch(error) {
 	case RMM_ERROR_CUDA_ERROR: throw CudaError(during_msg);
@@ -83,5 +206,8 @@ InputOutput::InputOutput(const std::string & during_msg)
 	: CudfAllocatorError(
 		  BASE_MESSAGE + "RMM_ERROR_IO:" + std::to_string(RMM_ERROR_IO) + ", Stats output error " + during_msg) {}
 
+QueryMemoryExceeded::QueryMemoryExceeded(const std::string & during_msg)
+	: CudfAllocatorError(BASE_MESSAGE + "The query went over its memory budget " + during_msg) {}
+
 }  // namespace Allocator
 }  // namespace cuDF
@@ -1,18 +1,74 @@
 #pragma once
 
+#include <blazingdb/manager/MemoryTracker.h>
 #include <cuda_runtime_api.h>
 #include <exception>
+#include <memory>
 #include <string>
 
 namespace cuDF {
 namespace Allocator {
 
+// Allocates with the memory resource, after reserving the size in the memory tracker of the query this thread runs
+// for. Throws QueryMemoryExceeded when the query has no room left for it.
 void allocate(void ** pointer, std::size_t size, cudaStream_t stream = 0);
 
 void reallocate(void ** pointer, std::size_t size, cudaStream_t stream = 0);
 
 void deallocate(void * pointer, cudaStream_t stream = 0);
 
+// Accounts device memory allocated outside of allocate, like the columns cudf readers return, by its size to the query
+// this thread runs for, so deallocate releases it. Memory already accounted is left alone. It is accounted even past
+// the budget, the next allocation of the query is refused instead.
+void adopt(void * pointer, std::size_t size);
+
+// Where the memory comes from, RMM unless replaced, for example by a host allocator in tests
+class memory_resource {
+public:
+	virtual ~memory_resource() = default;
+
+	// Throws a CudfAllocatorError when the memory could not be allocated
+	virtual void allocate(void ** pointer, std::size_t size, cudaStream_t stream) = 0;
+
+	virtual void deallocate(void * pointer, cudaStream_t stream) = 0;
+};
+
+void set_memory_resource(std::shared_ptr<memory_resource> resource);
+
+std::shared_ptr<memory_resource> get_memory_resource();
+
+// Budget of every query that does not set its own, 0 (the default) leaves queries unbounded
+void set_default_query_memory_budget(std::size_t budget);
+
+std::size_t get_default_query_memory_budget();
+
+// The query and operator the allocations of a thread are accounted to
+struct memory_attribution {
+	std::shared_ptr<blazingdb::manager::MemoryTracker> tracker;
+	std::string operator_name;
+};
+
+// Accounts the allocations this thread makes, until the scope ends, to the tracker of a query and one of its
+// operators. Scopes nest, the previous attribution is back once a scope ends. The allocations are released from the
+// same tracker and operator whichever thread frees them.
+class memory_scope {
+public:
+	memory_scope(std::shared_ptr<blazingdb::manager::MemoryTracker> tracker, std::string operator_name);
+
+	// Carries an attribution over to another thread, like a task of a thread pool
+	explicit memory_scope(memory_attribution attribution);
+
+	~memory_scope();
+
+	static const memory_attribution & current();
+
+	memory_scope(const memory_scope &) = delete;
+	memory_scope & operator=(const memory_scope &) = delete;
+
+private:
+	memory_attribution previous;
+};
+
 
 class CudfAllocatorError : public std::exception {
 public:
@@ -53,5 +109,10 @@ public:
 	Unknown(const std::string & during_msg);
 };
 
+class QueryMemoryExceeded : public CudfAllocatorError {
+public:
+	QueryMemoryExceeded(const std::string & during_msg);
+};
+
 }  // namespace Allocator
 }  // namespace cuDF
@@ -12,7 +12,7 @@
 #include "../io/data_parser/ParquetParser.h"
 #include "../io/data_parser/ParserUtil.h"
 #include "../io/data_provider/DummyProvider.h"
-#include "../io/data_provider/UriDataProvider.h"
+#include "../io/data_provider/PrefetchingDataProvider.h"
 #include "../skip_data/SkipDataProcessor.h"
 #include "communication/network/Server.h"
 #include <numeric>
@@ -45,6 +45,15 @@ void make_sure_output_is_not_input_gdf(
 	}
 }
 
+// partition values are only taken from the directories below the paths the table was registered with
+ral::io::directory_expansion_options get_expansion_options(const TableSchema & tableSchema) {
+	ral::io::directory_expansion_options options;
+	for(const std::string & root : tableSchema.datasource) {
+		options.partition_roots.push_back(Uri{root});
+	}
+	return options;
+}
+
 
 ResultSet runQuery(int32_t masterIndex,
 	std::vector<NodeMetaDataTCP> tcpMetadata,
@@ -119,8 +128,13 @@ ResultSet runQuery(int32_t masterIndex,
 			provider = std::make_shared<ral::io::dummy_data_provider>();
 		} else {
 			// is file (this includes the case where fileType is UNDEFINED too)
-			provider = std::make_shared<ral::io::uri_data_provider>(
-				uris, uri_values[i], string_values[i], is_column_string[i]);
+			provider = std::make_shared<ral::io::prefetching_data_provider>(uris,
+				uri_values[i],
+				string_values[i],
+				is_column_string[i],
+				ral::io::prefetching_data_provider::get_default_files_in_flight(),
+				ral::io::prefetching_data_provider::get_default_io_pool(),
+				get_expansion_options(tableSchema));
 		}
 		ral::io::data_loader loader(parser, provider);
 		input_loaders.push_back(loader);
@@ -143,7 +157,9 @@ ResultSet runQuery(int32_t masterIndex,
 
 		// Execute query
 
-		blazing_frame frame = evaluate_query(input_loaders, schemas, tableNames, query, accessToken, queryContext);
+		std::shared_ptr<const ral::profile::query_profile> profile;
+		blazing_frame frame =
+			evaluate_query(input_loaders, schemas, tableNames, query, accessToken, queryContext, &profile);
 		make_sure_output_is_not_input_gdf(frame, tableSchemas, fileTypes);
 		std::vector<gdf_column *> columns;
 		std::vector<std::string> names;
@@ -153,7 +169,7 @@ ResultSet runQuery(int32_t masterIndex,
 			names.push_back(column.name());
 		}
 
-		ResultSet result = {columns, names};
+		ResultSet result = {columns, names, profile->to_json()};
 		//    std::cout<<"result looks ok"<<std::endl;
 		return result;
 	} catch(const std::exception & e) {
@@ -239,8 +255,13 @@ ResultSet runSkipData(int32_t masterIndex,
 			provider = std::make_shared<ral::io::dummy_data_provider>();
 		} else {
 			// is file (this includes the case where fileType is UNDEFINED too)
-			provider = std::make_shared<ral::io::uri_data_provider>(
-				uris, uri_values[i], string_values[i], is_column_string[i]);
+			provider = std::make_shared<ral::io::prefetching_data_provider>(uris,
+				uri_values[i],
+				string_values[i],
+				is_column_string[i],
+				ral::io::prefetching_data_provider::get_default_files_in_flight(),
+				ral::io::prefetching_data_provider::get_default_io_pool(),
+				get_expansion_options(tableSchema));
 		}
 		ral::io::data_loader loader(parser, provider);
 		input_loaders.push_back(loader);
@@ -23,8 +23,13 @@
 #include <blazingdb/io/Util/StringUtil.h>
 
 #include <blazingdb/io/Config/BlazingContext.h>
+#include <blazingdb/io/FileSystem/FileSystemManager.h>
+#include <blazingdb/io/FileSystem/private/BlockCache.h>
+#include <blazingdb/io/Library/Logging/AsyncOutput.h>
 #include <blazingdb/io/Library/Logging/FileOutput.h>
 #include <blazingdb/io/Library/Logging/Logger.h>
+#include <blazingdb/io/Library/Metrics/MetricsRegistry.h>
+#include <blazingdb/io/Library/Metrics/MetricsServer.h>
 #include "blazingdb/io/Library/Logging/ServiceLogging.h"
 #include "utilities/StringUtils.h"
 
@@ -33,12 +38,23 @@
 
 #include "config/BlazingConfig.h"
 #include "config/GPUManager.cuh"
+#include "cuDF/Allocator.h"
 
 #include "communication/CommunicationData.h"
 #include "communication/network/Client.h"
 #include "communication/network/Server.h"
+#include "io/DataLoader.h"
+#include "io/data_parser/CSVParser.h"
+#include "io/data_parser/RowGroupDecoder.h"
+#include "io/data_provider/PrefetchingDataProvider.h"
+#include "ResultSetRepository.h"
+#include "profile/QueryProfile.h"
+#include "profile/QueryTrace.h"
+#include "spill/SpillManager.h"
 #include <blazingdb/manager/Context.h>
 
+// serves the metrics of the process to Prometheus when a metrics port is set
+std::unique_ptr<Library::Metrics::MetricsServer> metrics_server;
 
 std::string get_ip(const std::string & iface_name = "eth0") {
 	int fd;
@@ -107,7 +123,15 @@ void initialize(int ralId,
 	// NOTE IMPORTANT PERCY aqui es que pyblazing se entera que este es el ip del RAL en el _send de pyblazing
 	config.setLogName(loggingName).setSocketPath(ralHost);
 
-	auto output = new Library::Logging::FileOutput(config.getLogName(), false);
+	// the least severe level logged, every level is logged unless it is set
+	const char * env_logging_level = std::getenv("BLAZING_LOGGING_LEVEL");
+	Library::Logging::LoggingLevel logging_level;
+	if(env_logging_level != nullptr && Library::Logging::getLevelByName(env_logging_level, logging_level)) {
+		Library::Logging::BlazingLogger::setMinimumLevel(logging_level);
+	}
+
+	// queries only queue their log lines, a background thread writes them to the file in batches
+	auto output = new Library::Logging::AsyncOutput(new Library::Logging::FileOutput(config.getLogName(), false));
 	Library::Logging::ServiceLogging::getInstance().setLogOutput(output);
 	Library::Logging::ServiceLogging::getInstance().setNodeIdentifier(ralId);
 	
@@ -116,9 +140,106 @@ void initialize(int ralId,
 
 	// Init AWS S3 ... TODO see if we need to call shutdown and avoid leaks from s3 percy
 	BlazingContext::getInstance()->initExternalSystems();
+
+	// opt-in zero copy reads of local files
+	const char * env_local_mmap = std::getenv("BLAZING_LOCAL_MMAP");
+	if(env_local_mmap != nullptr && (std::string(env_local_mmap) == "1" || std::string(env_local_mmap) == "true")) {
+		BlazingContext::getInstance()->getFileSystemManager()->setMemoryMappedLocalReads(true);
+	}
+
+	// bytes of remote file blocks cached in memory across queries, with an optional local directory they are evicted
+	// to, no cache unless it is set
+	const char * env_block_cache_bytes = std::getenv("BLAZING_BLOCK_CACHE_BYTES");
+	if(env_block_cache_bytes != nullptr && std::atoll(env_block_cache_bytes) > 0) {
+		BlockCacheOptions options;
+		options.memoryCapacity = std::atoll(env_block_cache_bytes);
+		const char * env_block_cache_directory = std::getenv("BLAZING_BLOCK_CACHE_DIRECTORY");
+		if(env_block_cache_directory != nullptr) {
+			options.spillDirectory = env_block_cache_directory;
+		}
+		BlockCache::setDefaultInstance(std::make_shared<BlockCache>(options));
+	}
+
+	// bounds of the threads that open, parse and decode the row groups of the files of a table scan and of the files
+	// opened ahead
+	const char * env_io_threads = std::getenv("BLAZING_IO_THREADS");
+	if(env_io_threads != nullptr && std::atoi(env_io_threads) > 0) {
+		ral::io::prefetching_data_provider::set_default_io_threads(std::atoi(env_io_threads));
+	}
+	const char * env_parse_threads = std::getenv("BLAZING_PARSE_THREADS");
+	if(env_parse_threads != nullptr && std::atoi(env_parse_threads) > 0) {
+		ral::io::data_loader::set_parse_threads(std::atoi(env_parse_threads));
+	}
+	const char * env_decode_threads = std::getenv("BLAZING_DECODE_THREADS");
+	if(env_decode_threads != nullptr && std::atoi(env_decode_threads) > 0) {
+		ral::io::set_decode_threads(std::atoi(env_decode_threads));
+	}
+	const char * env_csv_range_size = std::getenv("BLAZING_CSV_RANGE_SIZE");
+	if(env_csv_range_size != nullptr && std::atoll(env_csv_range_size) > 0) {
+		ral::io::csv_parser::set_range_size(std::atoll(env_csv_range_size));
+	}
+	const char * env_files_in_flight = std::getenv("BLAZING_FILES_IN_FLIGHT");
+	if(env_files_in_flight != nullptr && std::atoi(env_files_in_flight) > 0) {
+		ral::io::prefetching_data_provider::set_default_files_in_flight(std::atoi(env_files_in_flight));
+	}
+
+	// bytes of device memory a query can hold at once, a query going over it fails instead of starving the others
+	const char * env_query_memory_budget = std::getenv("BLAZING_QUERY_MEMORY_BUDGET");
+	if(env_query_memory_budget != nullptr && std::atoll(env_query_memory_budget) > 0) {
+		cuDF::Allocator::set_default_query_memory_budget(std::atoll(env_query_memory_budget));
+	}
+
+	// seconds a result nobody fetched is kept before it is freed, 0 keeps it until its connection closes
+	const char * env_result_ttl = std::getenv("BLAZING_RESULT_TTL_SECONDS");
+	if(env_result_ttl != nullptr && std::atoll(env_result_ttl) >= 0) {
+		result_set_repository::set_result_ttl(std::chrono::seconds(std::atoll(env_result_ttl)));
+	}
+
+	// where every query writes the profile of its operators as JSON, none are written unless it is set
+	const char * env_profile_directory = std::getenv("BLAZING_PROFILE_DIRECTORY");
+	if(env_profile_directory != nullptr && std::string(env_profile_directory) != "") {
+		ral::profile::set_profile_directory(env_profile_directory);
+	}
+	// where the master writes the timeline of every query across the cluster, every node must set it or none
+	const char * env_trace_directory = std::getenv("BLAZING_TRACE_DIRECTORY");
+	if(env_trace_directory != nullptr && std::string(env_trace_directory) != "") {
+		ral::profile::set_trace_directory(env_trace_directory);
+	}
+	// milliseconds the master waits for the traces of the other nodes before it writes the timeline without them
+	const char * env_trace_wait = std::getenv("BLAZING_TRACE_WAIT_MS");
+	if(env_trace_wait != nullptr && std::atoll(env_trace_wait) >= 0) {
+		ral::profile::set_trace_wait(std::chrono::milliseconds(std::atoll(env_trace_wait)));
+	}
+
+	// where sort and join spill what does not fit in the budget of the query, once the pinned host memory is used up
+	const char * env_spill_directory = std::getenv("BLAZING_SPILL_DIRECTORY");
+	if(env_spill_directory != nullptr && std::string(env_spill_directory) != "") {
+		ral::spill::set_default_spill_directory(env_spill_directory);
+	}
+	const char * env_spill_host_bytes = std::getenv("BLAZING_SPILL_HOST_BYTES");
+	if(env_spill_host_bytes != nullptr && std::atoll(env_spill_host_bytes) >= 0) {
+		ral::spill::set_default_host_limit(std::atoll(env_spill_host_bytes));
+	}
+
+	// every RAL serves its metrics on that port plus its id, on loopback unless another host address is given
+	const char * env_metrics_port = std::getenv("BLAZING_METRICS_PORT");
+	if(env_metrics_port != nullptr && std::atoi(env_metrics_port) > 0) {
+		const char * env_metrics_host = std::getenv("BLAZING_METRICS_HOST");
+		const std::string metrics_host =
+			env_metrics_host != nullptr && std::string(env_metrics_host) != "" ? env_metrics_host : "127.0.0.1";
+		const int metrics_port = std::atoi(env_metrics_port) + ralId;
+		try {
+			metrics_server.reset(new Library::Metrics::MetricsServer(
+				Library::Metrics::MetricsRegistry::getInstance(), metrics_port, metrics_host));
+		} catch(const std::exception & e) {
+			Library::Logging::Logger().logError("Could not serve the metrics on " + metrics_host + ":" +
+												std::to_string(metrics_port) + ": " + e.what());
+		}
+	}
 }
 
 void finalize() {
+	metrics_server.reset();
 	ral::communication::network::Client::closeConnections();
 	ral::communication::network::Server::getInstance().close();
 	cudaDeviceReset();
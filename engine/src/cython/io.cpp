@@ -8,7 +8,7 @@
 #include "../io/data_parser/OrcParser.h"
 #include "../io/data_parser/ParquetParser.h"
 #include "../io/data_parser/ParserUtil.h"
-#include "../io/data_provider/UriDataProvider.h"
+#include "../io/data_provider/PrefetchingDataProvider.h"
 
 #include <blazingdb/io/Config/BlazingContext.h>
 #include <blazingdb/io/FileSystem/FileSystemConnection.h>
@@ -50,7 +50,7 @@ TableSchema parseSchema(std::vector<std::string> files,
 	for(auto file_path : files) {
 		uris.push_back(Uri{file_path});
 	}
-	auto provider = std::make_shared<ral::io::uri_data_provider>(uris);
+	auto provider = std::make_shared<ral::io::prefetching_data_provider>(uris);
 	auto loader = std::make_shared<ral::io::data_loader>(parser, provider);
 
 	ral::io::Schema schema;
@@ -160,7 +160,7 @@ TableSchema parseMetadata(std::vector<std::string> files,
 	for(auto file_path : files) {
 		uris.push_back(Uri{file_path});
 	}
-	auto provider = std::make_shared<ral::io::uri_data_provider>(uris);
+	auto provider = std::make_shared<ral::io::prefetching_data_provider>(uris);
 	auto loader = std::make_shared<ral::io::data_loader>(parser, provider);
 
 	ral::io::Metadata metadata({}, offset);
@@ -15,6 +15,7 @@
 #include "legacy/groupby.hpp"
 #include "legacy/reduction.hpp"
 #include "operators/GroupBy.h"
+#include "profile/QueryProfile.h"
 #include "utilities/RalColumn.h"
 #include "utilities/StringUtils.h"
 #include "utilities/TableWrapper.h"
@@ -185,6 +186,11 @@ std::vector<gdf_column_cpp> generatePartitionPlans(
 
 	std::vector<gdf_column_cpp> concatSamples = ral::utilities::concatTables(tables);
 
+	return generatePivots(concatSamples, sortOrderTypes, context.getTotalNodes());
+}
+
+std::vector<gdf_column_cpp> generatePivots(
+	std::vector<gdf_column_cpp> & concatSamples, std::vector<int8_t> & sortOrderTypes, gdf_size_type numPartitions) {
 	gdf_size_type outputRowSize = concatSamples[0].size();
 
 	std::vector<gdf_column *> rawConcatSamples(concatSamples.size());
@@ -245,7 +251,7 @@ std::vector<gdf_column_cpp> generatePartitionPlans(
 	}
 
 	// Gather
-	gdf_size_type pivotsSize = outputRowSize > 0 ? context.getTotalNodes() - 1 : 0;
+	gdf_size_type pivotsSize = outputRowSize > 0 ? numPartitions - 1 : 0;
 	std::vector<gdf_column_cpp> pivots(sortedSamples.size());
 	for(size_t i = 0; i < sortedSamples.size(); i++) {
 		auto & col = sortedSamples[i];
@@ -271,11 +277,11 @@ std::vector<gdf_column_cpp> generatePartitionPlans(
 		cudf::table srcTable = ral::utilities::create_table(sortedSamples);
 		cudf::table destTable = ral::utilities::create_table(pivots);
 
-		int step = outputRowSize / context.getTotalNodes();
+		int step = outputRowSize / numPartitions;
 		gdf_column_cpp gatherMap;
 		gatherMap.create_gdf_column(GDF_INT32,
 			gdf_dtype_extra_info{TIME_UNIT_NONE, nullptr},
-			context.getTotalNodes() - 1,
+			numPartitions - 1,
 			nullptr,
 			ral::traits::get_dtype_size_in_bytes(GDF_INT32),
 			"");
@@ -321,28 +327,35 @@ std::vector<gdf_column_cpp> getPartitionPlan(const Context & context) {
 	return concreteMessage->getColumns();
 }
 
-std::vector<NodeColumns> split_data_into_NodeColumns(
-	const Context & context, const std::vector<gdf_column_cpp> & table, const gdf_column_cpp & indexes) {
-	std::vector<std::vector<gdf_column *>> split_table(table.size());  // this will be [colInd][splitInd]
+// splits the table at the indexes, into indexes.size() + 1 tables
+std::vector<std::vector<gdf_column_cpp>> split_table(
+	const std::vector<gdf_column_cpp> & table, const gdf_column_cpp & indexes) {
+	std::vector<std::vector<gdf_column *>> split_columns(table.size());  // this will be [colInd][splitInd]
 	for(std::size_t k = 0; k < table.size(); ++k) {
-		split_table[k] =
+		split_columns[k] =
 			cudf::split(*(table[k].get_gdf_column()), static_cast<gdf_index_type *>(indexes.data()), indexes.size());
 	}
 
+	std::vector<std::vector<gdf_column_cpp>> tables(indexes.size() + 1);
+	for(std::size_t i = 0; i < tables.size(); ++i) {
+		tables[i].resize(table.size());
+		for(std::size_t k = 0; k < table.size(); ++k) {
+			split_columns[k][i]->col_name = nullptr;
+			tables[i][k].create_gdf_column(split_columns[k][i]);
+			tables[i][k].set_name(table[k].name());
+		}
+	}
+	return tables;
+}
+
+std::vector<NodeColumns> to_NodeColumns(const Context & context, std::vector<std::vector<gdf_column_cpp>> & tables) {
 	// get nodes
 	auto nodes = context.getAllNodes();
 
 	// generate NodeColumns
 	std::vector<NodeColumns> array_node_columns;
 	for(std::size_t i = 0; i < nodes.size(); ++i) {
-		std::vector<gdf_column_cpp> columns(table.size());
-		for(std::size_t k = 0; k < table.size(); ++k) {
-			split_table[k][i]->col_name = nullptr;
-			columns[k].create_gdf_column(split_table[k][i]);
-			columns[k].set_name(table[k].name());
-		}
-
-		array_node_columns.emplace_back(*nodes[i], columns);
+		array_node_columns.emplace_back(*nodes[i], tables[i]);
 	}
 	return array_node_columns;
 }
@@ -381,14 +394,23 @@ std::vector<NodeColumns> partitionData(const Context & context,
 		}
 	}
 
+	std::vector<std::vector<gdf_column_cpp>> partitions =
+		rangePartition(table, searchColIndices, pivots, isTableSorted, sortOrderTypes);
+	return to_NodeColumns(context, partitions);
+}
+
+std::vector<std::vector<gdf_column_cpp>> rangePartition(std::vector<gdf_column_cpp> & table,
+	std::vector<int> & searchColIndices,
+	std::vector<gdf_column_cpp> & pivots,
+	bool isTableSorted,
+	std::vector<int8_t> sortOrderTypes) {
+	if(pivots.size() == 0 || pivots.size() != searchColIndices.size()) {
+		throw std::runtime_error("There must be one pivot column per search column");
+	}
+
 	gdf_size_type table_row_size = table[0].size();
 	if(table_row_size == 0) {
-		std::vector<NodeColumns> array_node_columns;
-		auto nodes = context.getAllNodes();
-		for(std::size_t i = 0; i < nodes.size(); ++i) {
-			array_node_columns.emplace_back(*nodes[i], table);
-		}
-		return array_node_columns;
+		return std::vector<std::vector<gdf_column_cpp>>(pivots[0].size() + 1, table);
 	}
 
 	if(sortOrderTypes.size() == 0) {
@@ -516,9 +538,28 @@ std::vector<NodeColumns> partitionData(const Context & context,
 	indexes.create_gdf_column(raw_indexes);
 	sort_indices(indexes);
 
-	return split_data_into_NodeColumns(context, table, indexes);
+	return split_table(table, indexes);
 }
 
+namespace {
+
+// device bytes of the columns that go through the network, the characters of string columns aside
+std::size_t get_shuffled_bytes(const std::vector<gdf_column_cpp> & columns) {
+	std::size_t bytes = 0;
+	for(const gdf_column_cpp & column : columns) {
+		if(column.get_gdf_column() == nullptr || column.dtype() == GDF_STRING) {
+			continue;
+		}
+		bytes += ral::traits::get_data_size_in_bytes(column);
+		if(column.valid() != nullptr) {
+			bytes += ral::traits::get_bitmask_size_in_bytes(column.size());
+		}
+	}
+	return bytes;
+}
+
+}  // namespace
+
 void distributePartitions(const Context & context, std::vector<NodeColumns> & partitions) {
 	using ral::communication::CommunicationData;
 	using ral::communication::messages::ColumnDataMessage;
@@ -536,6 +577,7 @@ void distributePartitions(const Context & context, std::vector<NodeColumns> & pa
 			continue;
 		}
 		std::vector<gdf_column_cpp> columns = nodeColumn.getColumns();
+		ral::profile::add_bytes_shuffled(get_shuffled_bytes(columns));
 		auto destination_node = nodeColumn.getNode();
 		threads.push_back(std::thread([message_id, context_token, self_node, destination_node, columns]() mutable {
 			auto message = Factory::createColumnDataMessage(message_id, context_token, self_node, columns);
@@ -586,6 +628,7 @@ std::vector<NodeColumns> collectSomePartitions(const Context & context, int num_
 				"ERROR: Already received collectSomePartitions from node " + std::to_string(node_idx)));
 		}
 		node_columns.emplace_back(*node, column_message->getColumns());
+		ral::profile::add_bytes_shuffled(get_shuffled_bytes(node_columns.back().getColumns()));
 		received[node_idx] = true;
 	}
 	return node_columns;
@@ -718,7 +761,7 @@ std::vector<gdf_column_cpp> generatePartitionPlansGroupBy(const Context & contex
 	gdf_size_type outputRowSize = sortedSamples[0].size();
 
 	// Gather
-	gdf_size_type pivotsSize = outputRowSize > 0 ? context.getTotalNodes() - 1 : 0;
+	gdf_size_type pivotsSize = outputRowSize > 0 ? numPartitions - 1 : 0;
 	std::vector<gdf_column_cpp> pivots{sortedSamples.size()};
 	for(size_t i = 0; i < sortedSamples.size(); i++) {
 		auto & col = sortedSamples[i];
@@ -900,6 +943,59 @@ void collectLeftRightNumRows(const Context & context,
 	}
 }
 
+void sendTraceToMaster(const Context & context, const std::vector<char> & trace) {
+	using ral::communication::CommunicationData;
+	using ral::communication::messages::Factory;
+	using ral::communication::messages::TraceSpansMessage;
+	using ral::communication::network::Client;
+
+	const uint32_t context_comm_token = context.getContextCommunicationToken();
+	const uint32_t context_token = context.getContextToken();
+	const std::string message_id = TraceSpansMessage::MessageID() + "_" + std::to_string(context_comm_token);
+
+	std::vector<gdf_column_cpp> columns(1);
+	columns[0].create_gdf_column(GDF_INT8,
+		gdf_dtype_extra_info{TIME_UNIT_NONE, nullptr},
+		trace.size(),
+		const_cast<char *>(trace.data()),
+		ral::traits::get_dtype_size_in_bytes(GDF_INT8),
+		"");
+
+	auto self_node = CommunicationData::getInstance().getSharedSelfNode();
+	auto message = Factory::createTraceSpansMessage(message_id, context_token, self_node, columns);
+	Client::send(context.getMasterNode(), *message);
+}
+
+std::vector<std::vector<char>> collectTraces(const Context & context, std::chrono::milliseconds wait) {
+	using ral::communication::messages::TraceSpansMessage;
+	using ral::communication::network::Server;
+
+	const uint32_t context_comm_token = context.getContextCommunicationToken();
+	const uint32_t context_token = context.getContextToken();
+	const std::string message_id = TraceSpansMessage::MessageID() + "_" + std::to_string(context_comm_token);
+
+	const auto deadline = std::chrono::steady_clock::now() + wait;
+	std::vector<std::vector<char>> traces;
+	for(int i = 0; i < context.getTotalNodes() - 1; ++i) {
+		auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+			deadline - std::chrono::steady_clock::now());
+		auto message = Server::getInstance().getMessage(
+			context_token, message_id, std::max(remaining, std::chrono::milliseconds(0)));
+		if(message == nullptr) {
+			break;
+		}
+		if(message->getMessageTokenValue() != message_id) {
+			throw createMessageMismatchException(__FUNCTION__, message_id, message->getMessageTokenValue());
+		}
+		auto concrete_message = std::static_pointer_cast<TraceSpansMessage>(message);
+		gdf_column * column = concrete_message->getColumns()[0].get_gdf_column();
+		std::vector<char> trace(column->size);
+		CUDA_TRY(cudaMemcpy(trace.data(), column->data, trace.size(), cudaMemcpyDeviceToHost));
+		traces.push_back(std::move(trace));
+	}
+	return traces;
+}
+
 
 }  // namespace distribution
 }  // namespace ral
@@ -924,16 +1020,16 @@ std::vector<gdf_column_cpp> generateOutputColumns(
 
 std::vector<NodeColumns> generateJoinPartitions(
 	const Context & context, std::vector<gdf_column_cpp> & table, std::vector<int> & columnIndices) {
+	std::vector<std::vector<gdf_column_cpp>> partitions = hashPartition(table, columnIndices, context.getTotalNodes());
+	return to_NodeColumns(context, partitions);
+}
+
+std::vector<std::vector<gdf_column_cpp>> hashPartition(
+	std::vector<gdf_column_cpp> & table, std::vector<int> & columnIndices, gdf_size_type num_partitions) {
 	assert(table.size() != 0);
 
 	if(table[0].size() == 0) {
-		std::vector<NodeColumns> result;
-		auto nodes = context.getAllNodes();
-		for(gdf_size_type k = 0; k < nodes.size(); ++k) {
-			std::vector<gdf_column_cpp> columns = table;
-			result.emplace_back(*nodes[k], columns);
-		}
-		return result;
+		return std::vector<std::vector<gdf_column_cpp>>(num_partitions, table);
 	}
 
 	// Support for GDF_STRING_CATEGORY. We need the string hashes not the category indices
@@ -973,8 +1069,7 @@ std::vector<NodeColumns> generateJoinPartitions(
 	cudf::table input_table_wrapper(raw_input_table_col_ptrs);
 
 	// Generate partition offset vector
-	gdf_size_type number_nodes = context.getTotalNodes();
-	std::vector<gdf_index_type> partition_offset(number_nodes);
+	std::vector<gdf_index_type> partition_offset(num_partitions);
 
 	// Preallocate output columns
 	std::vector<gdf_column_cpp> output_columns =
@@ -1000,7 +1095,7 @@ std::vector<NodeColumns> generateJoinPartitions(
 		input_table_wrapper.begin(),
 		temp_input_col_indices.data(),
 		temp_input_col_indices.size(),
-		number_nodes,
+		num_partitions,
 		output_table_wrapper.begin(),
 		partition_offset.data(),
 		gdf_hash_func::GDF_HASH_MURMUR3));
@@ -1023,13 +1118,13 @@ std::vector<NodeColumns> generateJoinPartitions(
 	gdf_column_cpp indexes;
 	indexes.create_gdf_column(GDF_INT32,
 		gdf_dtype_extra_info{TIME_UNIT_NONE, nullptr},
-		number_nodes - 1,
+		num_partitions - 1,
 		partition_offset.data() + 1,
 		nullptr,
 		ral::traits::get_dtype_size_in_bytes(GDF_INT32),
 		"");
 
-	return split_data_into_NodeColumns(context, temp_output_columns, indexes);
+	return split_table(temp_output_columns, indexes);
 }
 
 
@@ -7,6 +7,7 @@
 #include "communication/factory/MessageFactory.h"
 #include "distribution/NodeColumns.h"
 #include "distribution/NodeSamples.h"
+#include <chrono>
 #include <vector>
 
 namespace ral {
@@ -49,6 +50,10 @@ std::vector<NodeSamples> collectSamples(const Context & context);
 std::vector<gdf_column_cpp> generatePartitionPlans(
 	const Context & context, std::vector<NodeSamples> & samples, std::vector<int8_t> & sortOrderTypes);
 
+// Sorts the samples and picks numPartitions - 1 evenly spaced rows of them as pivots
+std::vector<gdf_column_cpp> generatePivots(
+	std::vector<gdf_column_cpp> & samples, std::vector<int8_t> & sortOrderTypes, gdf_size_type numPartitions);
+
 void distributePartitionPlan(const Context & context, std::vector<gdf_column_cpp> & pivots);
 
 std::vector<gdf_column_cpp> getPartitionPlan(const Context & context);
@@ -80,6 +85,16 @@ std::vector<NodeColumns> partitionData(const Context & context,
 	bool isTableSorted,
 	std::vector<int8_t> sortOrderTypes = {});
 
+/**
+ * Splits a table into pivots.size() + 1 tables by the pivots, like partitionData does for the nodes of a query. Used
+ * on a single node to split a table into ranges that can be sorted one at a time.
+ */
+std::vector<std::vector<gdf_column_cpp>> rangePartition(std::vector<gdf_column_cpp> & table,
+	std::vector<int> & searchColIndices,
+	std::vector<gdf_column_cpp> & pivots,
+	bool isTableSorted,
+	std::vector<int8_t> sortOrderTypes = {});
+
 void distributePartitions(const Context & context, std::vector<NodeColumns> & partitions);
 
 std::vector<NodeColumns> collectPartitions(const Context & context);
@@ -107,6 +122,13 @@ void collectLeftRightNumRows(const Context & context,
 	std::vector<gdf_size_type> & node_num_rows_left,
 	std::vector<gdf_size_type> & node_num_rows_right);
 
+// Sends the serialized trace of this node for the query to the master
+void sendTraceToMaster(const Context & context, const std::vector<char> & trace);
+
+// The serialized traces of the other nodes for the query, called by the master. Only those that arrived within wait,
+// a node that failed before it sent its trace is not waited for forever.
+std::vector<std::vector<char>> collectTraces(const Context & context, std::chrono::milliseconds wait);
+
 // multi-threaded message sender
 void broadcastMessage(
 	std::vector<std::shared_ptr<Node>> nodes, std::shared_ptr<communication::messages::Message> message);
@@ -133,6 +155,13 @@ namespace distribution {
 std::vector<NodeColumns> generateJoinPartitions(
 	const Context & context, std::vector<gdf_column_cpp> & table, std::vector<int> & columnIndices);
 
+/**
+ * Splits a table into num_partitions tables by the hash of the columns in columnIndices, like generateJoinPartitions
+ * does for the nodes of a query. Rows with equal keys land in the same partition. The input table will be deleted.
+ */
+std::vector<std::vector<gdf_column_cpp>> hashPartition(
+	std::vector<gdf_column_cpp> & table, std::vector<int> & columnIndices, gdf_size_type num_partitions);
+
 }  // namespace distribution
 }  // namespace ral
 
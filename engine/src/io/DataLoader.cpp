@@ -1,13 +1,20 @@
 
 #include "DataLoader.h"
+#include "CalciteExpressionParsing.h"
 #include "Traits/RuntimeTraits.h"
 #include "config/GPUManager.cuh"
+#include "cuDF/Allocator.h"
 #include "cudf/legacy/filling.hpp"
+#include "profile/QueryProfile.h"
 #include "rmm/thrust_rmm_allocator.h"
 #include "utilities/CommonOperations.h"
 #include "utilities/StringUtils.h"
 #include <CodeTimer.h>
 #include <blazingdb/io/Library/Logging/Logger.h>
+#include <blazingdb/io/Library/Metrics/MetricsRegistry.h>
+#include <algorithm>
+#include <cstdlib>
+#include <mutex>
 #include <thread>
 
 namespace ral {
@@ -23,86 +30,179 @@ data_loader::data_loader(std::shared_ptr<data_parser> _parser, std::shared_ptr<d
 
 data_loader::~data_loader() {}
 
+namespace {
+std::mutex parse_pool_mutex;
+std::shared_ptr<ThreadPool> parse_pool;
+
+// integer when every value is one, floating point when every value is a number and strings otherwise
+gdf_dtype infer_partition_dtype(const std::vector<std::string> & values) {
+	bool integers = true;
+	bool numbers = true;
+	for(const std::string & value : values) {
+		char * end = nullptr;
+		std::strtoll(value.c_str(), &end, 10);
+		integers = integers && !value.empty() && *end == '\0';
+		std::strtod(value.c_str(), &end);
+		numbers = numbers && !value.empty() && *end == '\0';
+	}
+	return integers ? GDF_INT64 : numbers ? GDF_FLOAT64 : GDF_STRING_CATEGORY;
+}
+
+gdf_column_cpp create_partition_column(
+	const std::string & name, const std::string & value, gdf_dtype dtype, gdf_time_unit time_unit, size_t num_rows) {
+	gdf_column_cpp column;
+	if(dtype == GDF_STRING_CATEGORY || dtype == GDF_STRING || dtype == GDF_CATEGORY) {
+		NVCategory * category = repeated_string_category(value, num_rows);
+		column.create_gdf_column(category, num_rows, name);
+	} else {
+		gdf_scalar scalar = get_scalar_from_string(value, dtype, gdf_dtype_extra_info{time_unit});
+		column.create_gdf_column(dtype,
+			gdf_dtype_extra_info{time_unit},
+			num_rows,
+			nullptr,
+			ral::traits::get_dtype_size_in_bytes(dtype),
+			name);
+		cudf::fill(column.get_gdf_column(), scalar, 0, num_rows);
+	}
+	return column;
+}
+
+// what the loaders of every query parsed
+struct loader_metrics {
+	Library::Metrics::Counter & files_parsed;
+	Library::Metrics::Counter & rows_parsed;
+	Library::Metrics::Histogram & parse_seconds;
+};
+
+loader_metrics & get_loader_metrics() {
+	static loader_metrics metrics = [] {
+		Library::Metrics::MetricsRegistry & registry = Library::Metrics::MetricsRegistry::getInstance();
+		return loader_metrics{registry.getCounter("blazing_loader_files_parsed_total", "Files parsed by the loaders"),
+			registry.getCounter("blazing_loader_rows_parsed_total", "Rows parsed from the files by the loaders"),
+			registry.getHistogram("blazing_loader_parse_seconds", "Time spent parsing a file", 1e-6)};
+	}();
+	return metrics;
+}
+}  // namespace
+
+std::shared_ptr<ThreadPool> data_loader::get_parse_pool() {
+	std::lock_guard<std::mutex> lock(parse_pool_mutex);
+	if(parse_pool == nullptr) {
+		parse_pool = std::make_shared<ThreadPool>(std::max(std::thread::hardware_concurrency(), 1u));
+	}
+	return parse_pool;
+}
+
+void data_loader::set_parse_threads(size_t num_threads) {
+	// loads that already got the previous pool keep it until they finish
+	std::lock_guard<std::mutex> lock(parse_pool_mutex);
+	parse_pool = std::make_shared<ThreadPool>(std::max<size_t>(num_threads, 1));
+}
+
 
 void data_loader::load_data(const Context & context,
 	std::vector<gdf_column_cpp> & columns,
 	const std::vector<size_t> & column_indices,
 	const Schema & schema) {
-	static CodeTimer timer;
-	timer.reset();
+	CodeTimer timer;
+
+	std::vector<std::future<std::vector<gdf_column_cpp>>> parsed_files;
+	std::shared_ptr<ThreadPool> parse_pool = get_parse_pool();
+	// the files are parsed for the operator that loads them
+	const cuDF::Allocator::memory_attribution attribution = cuDF::Allocator::memory_scope::current();
+
+	// every file goes to the parse pool as soon as the provider returns it, a prefetching provider keeps opening the
+	// next files meanwhile
+	try {
+		while(this->provider->has_next()) {
+			const size_t file_index = parsed_files.size();
+			// a file handle that we can use in case errors occur to tell the user which file had parsing issues
+			std::string user_readable_file_handle = this->provider->get_current_user_readable_file_handle();
+			data_handle file = this->provider->get_next();
+			int64_t file_size = 0;
+			if(file.fileHandle != nullptr && file.fileHandle->GetSize(&file_size).ok()) {
+				ral::profile::add_bytes_read(file_size);
+			}
 
-	std::vector<std::vector<gdf_column_cpp>> columns_per_file;  // stores all of the columns parsed from each file
-	std::vector<std::string> user_readable_file_handles;
-	std::vector<data_handle> files;
-
-	// iterates through files and parses them into columns
-	while(this->provider->has_next()) {
-		// std::cout<<"pushing back files!"<<std::endl;
-		// a file handle that we can use in case errors occur to tell the user which file had parsing issues
-		user_readable_file_handles.push_back(this->provider->get_current_user_readable_file_handle());
-		files.push_back(this->provider->get_next());
-	}
-	// std::cout<<"pushed back"<<std::endl;
-
-	columns_per_file.resize(files.size());
-	// TODO NOTE percy c.gonzales rommel fix our concurrent reads here (better use of thread)
-	// make sure cudf supports concurrent reads
-	std::vector<std::thread> threads;
-
-	for(int file_index = 0; file_index < files.size(); file_index++) {
-		threads.push_back(std::thread([&, file_index]() {
-			// std::cout<<"starting file thread"<<std::endl;
-			std::vector<gdf_column_cpp> converted_data;
-			// std::cout<<"converted data"<<std::endl;
-
-			if(files[file_index].fileHandle != nullptr) {
-				// std::cout<<"get num columns==>"<<schema.get_num_columns()<<std::endl;
-				// std::cout<<"file is "<< user_readable_file_handles[file_index]<<" with uri
-				// "<<files[file_index].uri.getPath().toString()<<std::endl;
-				Schema fileSchema = schema.fileSchema(file_index);
-				parser->parse(files[file_index].fileHandle,
-					user_readable_file_handles[file_index],
-					converted_data,
-					fileSchema,
-					column_indices);
-				// std::cout<<"parsed file got "<<converted_data.size()<<" columns!"<<std::endl;
-				for(int i = 0; i < schema.get_num_columns(); i++) {
-					if(!schema.get_in_file()[i]) {
-						// std::cout<<"creating column!"<<std::endl;
-						auto num_rows = converted_data[0].size();
-						std::string name = schema.get_name(i);
-						if(files[file_index].is_column_string[name]) {
-							std::string string_value = files[file_index].string_values[name];
-							NVCategory * category = repeated_string_category(string_value, num_rows);
-							gdf_column_cpp column;
-							column.create_gdf_column(category, num_rows, name);
-							converted_data.push_back(column);
-						} else {
-							gdf_scalar scalar = files[file_index].column_values[name];
-
-							gdf_column_cpp column;
-							column.create_gdf_column(scalar.dtype,
-								gdf_dtype_extra_info{TIME_UNIT_ms},
-								num_rows,
-								nullptr,
-								ral::traits::get_dtype_size_in_bytes(scalar.dtype),
-								name);
-							cudf::fill(column.get_gdf_column(), scalar, 0, num_rows);
-							converted_data.push_back(column);
+			parsed_files.push_back(parse_pool->submit([&, file_index, user_readable_file_handle, file]() mutable {
+				cuDF::Allocator::memory_scope task_scope(attribution);
+				std::vector<gdf_column_cpp> converted_data;
+
+				if(file.fileHandle != nullptr) {
+					Schema fileSchema = schema.fileSchema(file_index);
+					loader_metrics & metrics = get_loader_metrics();
+					{
+						Library::Metrics::ScopedLatency parse_latency(metrics.parse_seconds);
+						parser->parse(file.fileHandle,
+							user_readable_file_handle,
+							file.status,
+							converted_data,
+							fileSchema,
+							column_indices);
+					}
+					metrics.files_parsed.increment();
+					if(!converted_data.empty()) {
+						metrics.rows_parsed.increment(converted_data[0].size());
+					}
+					for(int i = 0; i < schema.get_num_columns(); i++) {
+						if(!schema.get_in_file()[i]) {
+							auto num_rows = converted_data[0].size();
+							std::string name = schema.get_name(i);
+							auto partition_value = file.partition_values.find(name);
+							if(file.column_values.count(name) == 0 && file.string_values.count(name) == 0 &&
+								partition_value != file.partition_values.end()) {
+								converted_data.push_back(create_partition_column(name,
+									partition_value->second,
+									schema.get_dtypes()[i],
+									schema.get_time_units()[i],
+									num_rows));
+							} else if(file.is_column_string[name]) {
+								std::string string_value = file.string_values[name];
+								NVCategory * category = repeated_string_category(string_value, num_rows);
+								gdf_column_cpp column;
+								column.create_gdf_column(category, num_rows, name);
+								converted_data.push_back(column);
+							} else {
+								if(file.column_values.count(name) == 0) {
+									throw std::runtime_error("No value for the column " + name + " of the file " +
+															 user_readable_file_handle);
+								}
+								gdf_scalar scalar = file.column_values[name];
+
+								gdf_column_cpp column;
+								column.create_gdf_column(scalar.dtype,
+									gdf_dtype_extra_info{TIME_UNIT_ms},
+									num_rows,
+									nullptr,
+									ral::traits::get_dtype_size_in_bytes(scalar.dtype),
+									name);
+								cudf::fill(column.get_gdf_column(), scalar, 0, num_rows);
+								converted_data.push_back(column);
+							}
 						}
-						// std::cout<<"created column!"<<std::endl;
 					}
+				} else {
+					Library::Logging::Logger().logError(ral::utilities::buildLogString(
+						"", "", "", "ERROR: Was unable to open " + user_readable_file_handle));
 				}
-
-				columns_per_file[file_index] = converted_data;
-			} else {
-				Library::Logging::Logger().logError(ral::utilities::buildLogString(
-					"", "", "", "ERROR: Was unable to open " + user_readable_file_handles[file_index]));
-			}
-		}));
+				return converted_data;
+			}));
+		}
+	} catch(...) {
+		// the parses still running use the arguments of this call
+		for(auto & parsed_file : parsed_files) {
+			parsed_file.wait();
+		}
+		throw;
 	}
 
-	std::for_each(threads.begin(), threads.end(), [](std::thread & this_thread) { this_thread.join(); });
+	for(auto & parsed_file : parsed_files) {
+		parsed_file.wait();
+	}
+	std::vector<std::vector<gdf_column_cpp>> columns_per_file;  // stores all of the columns parsed from each file
+	for(auto & parsed_file : parsed_files) {
+		columns_per_file.push_back(parsed_file.get());
+	}
 	// std::cout<<"finished loading!"<<std::endl;
 	Library::Logging::Logger().logInfo(timer.logDuration(context, "data_loader::load_data part 1 parse"));
 	timer.reset();
@@ -149,33 +249,47 @@ void data_loader::load_data(const Context & context,
 
 void data_loader::get_schema(Schema & schema, std::vector<std::pair<std::string, gdf_dtype>> non_file_columns) {
 	std::vector<std::shared_ptr<arrow::io::RandomAccessFile>> files;
+	std::vector<std::string> user_readable_file_handles;
 	bool firstIteration = true;
 	std::vector<data_handle> handles = this->provider->get_all();
 	for(auto handle : handles) {
 		files.push_back(handle.fileHandle);
+		user_readable_file_handles.push_back(handle.uri.toString());
 	}
-	this->parser->parse_schema(files, schema);
+	this->parser->parse_schema(files, user_readable_file_handles, schema);
 
+	std::map<std::string, std::vector<std::string>> partition_values;
 	for(auto handle : handles) {
 		schema.add_file(handle.uri.toString(true));
+		for(auto partition_value : handle.partition_values) {
+			partition_values[partition_value.first].push_back(partition_value.second);
+		}
 	}
 
 	for(auto extra_column : non_file_columns) {
 		schema.add_column(extra_column.first, extra_column.second, 0, false);
 	}
+
+	// the partition directories found in the paths become columns, unless the files or the caller already have them
+	for(auto partition_column : partition_values) {
+		std::vector<std::string> names = schema.get_names();
+		if(std::find(names.begin(), names.end(), partition_column.first) == names.end()) {
+			schema.add_column(partition_column.first, infer_partition_dtype(partition_column.second), 0, false);
+		}
+	}
 }
 
 void data_loader::get_metadata(Metadata & metadata, std::vector<std::pair<std::string, gdf_dtype>> non_file_columns) {
 	std::vector<std::shared_ptr<arrow::io::RandomAccessFile>> files;
-	// std::vector<std::string> user_readable_file_handles;
+	std::vector<std::string> user_readable_file_handles;
 
 	bool firstIteration = true;
 	std::vector<data_handle> handles = this->provider->get_all();
 	for(auto handle : handles) {
 		files.push_back(handle.fileHandle);
-		// user_readable_file_handles.push_back(handle.uri.toString());
+		user_readable_file_handles.push_back(handle.uri.toString());
 	}
-	if (this->parser->get_metadata(files,  metadata) == false) {
+	if (this->parser->get_metadata(files, user_readable_file_handles, metadata) == false) {
 		throw std::runtime_error("No metadata for this data file");
 	}
 	//TODO, non_file_columns hive feature, @percy
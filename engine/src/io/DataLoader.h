@@ -13,6 +13,7 @@
 #include "data_parser/DataParser.h"
 #include "data_provider/DataProvider.h"
 #include <arrow/io/interfaces.h>
+#include <blazingdb/io/Util/ThreadPool.h>
 #include <blazingdb/manager/Context.h>
 #include <vector>
 
@@ -56,6 +57,12 @@ public:
 
 	void get_metadata(Metadata & metadata, std::vector<std::pair<std::string, gdf_dtype>> non_file_columns);
 
+	/**
+	 * pool shared by every loader that parses the files, bounds how many files are parsed at the same time
+	 */
+	static std::shared_ptr<ThreadPool> get_parse_pool();
+	static void set_parse_threads(size_t num_threads);
+
 private:
 	/**
 	 * DataProviders are able to serve up one or more arrow::io::RandomAccessFile objects
@@ -106,6 +106,13 @@ size_t Schema::get_file_index(size_t schema_index) const {
 
 size_t Schema::get_num_row_groups(size_t file_index) const { return this->num_row_groups[file_index]; }
 
+std::vector<int> Schema::get_rowgroup_ids(size_t file_index) const {
+	if(file_index >= this->row_groups_ids.size()) {
+		return {};
+	}
+	return this->row_groups_ids[file_index];
+}
+
 size_t Schema::get_num_columns() const { return this->names.size(); }
 
 std::vector<bool> Schema::get_in_file() const { return this->in_file; }
@@ -138,9 +145,8 @@ Schema Schema::fileSchema(size_t current_file_index) const {
 			schema.add_column(this->names[i], this->types[i], file_index);
 		}
 	}
-	// Just get the associated row_groups for current_file_index
-	// TODO, @alex
-	// schema.row_groups_ids.push_back(this->row_groups_ids.at(current_file_index));
+	// the file schema only describes the current file, so its row groups are the ones of file 0
+	schema.row_groups_ids.push_back(this->get_rowgroup_ids(current_file_index));
 	return schema;
 }
 
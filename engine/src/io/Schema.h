@@ -64,6 +64,11 @@ public:
 
 	size_t get_num_row_groups(size_t file_index) const;
 
+	/**
+	 * row groups of the file chosen by skip-data, empty when every row group is read
+	 */
+	std::vector<int> get_rowgroup_ids(size_t file_index) const;
+
 	size_t get_num_columns() const;
 
 	void add_column(gdf_column_cpp column, size_t file_index);
@@ -92,6 +92,7 @@ columns_out = columns;
 }
 
 void arrow_parser::parse_schema(std::vector<std::shared_ptr<arrow::io::RandomAccessFile> > files,
+		const std::vector<std::string> & user_readable_file_handles,
 		ral::io::Schema & schema){
 	std::vector<std::string> names;
 	std::vector<gdf_dtype> types;
@@ -31,6 +31,7 @@ public:
 
 
 	void parse_schema(std::vector<std::shared_ptr<arrow::io::RandomAccessFile> > files,
+			const std::vector<std::string> & user_readable_file_handles,
 			ral::io::Schema & schema);
 
 ;
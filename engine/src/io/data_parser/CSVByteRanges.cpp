@@ -0,0 +1,354 @@
+#include "CSVByteRanges.h"
+#include <algorithm>
+#include <array>
+#include <future>
+#include <stdexcept>
+#include <string>
+
+namespace ral {
+namespace io {
+
+namespace {
+
+// the first row after an edge is searched for in steps this size
+const int64_t SEARCH_STEP_SIZE = 64 * 1024;
+
+// bytes after an edge read to tell whether it is inside a quoted field
+const int64_t RESYNC_WINDOW_SIZE = 1024 * 1024;
+
+void read_at(const std::shared_ptr<arrow::io::RandomAccessFile> & file, int64_t position, int64_t num_bytes,
+	char * buffer) {
+	int64_t total_read = 0;
+	while(total_read < num_bytes) {
+		int64_t bytes_read = 0;
+		arrow::Status status = file->ReadAt(position + total_read, num_bytes - total_read, &bytes_read,
+			buffer + total_read);
+		if(!status.ok() || bytes_read <= 0) {
+			throw std::runtime_error("Could not read bytes " + std::to_string(position) + " to " +
+									 std::to_string(position + num_bytes) + " of csv file: " + status.ToString());
+		}
+		total_read += bytes_read;
+	}
+}
+
+const int NOT_FOUND = -1;
+
+/**
+ * what a block of the file says about where rows start, for both states the block can start in: outside ([0]) or
+ * inside ([1]) a quoted field
+ */
+struct block_scan {
+	bool odd_quotes = false;  // the state at the end of the block is the one at its start flipped
+	// first line terminator of the block outside quotes
+	std::array<int64_t, 2> first_terminator{{NOT_FOUND, NOT_FOUND}};
+	// per search position of the block, the first line terminator outside quotes at or after it in the block
+	std::vector<std::array<int64_t, 2>> terminators;
+};
+
+block_scan scan_block(const std::shared_ptr<arrow::io::RandomAccessFile> & file,
+	int64_t block_start,
+	int64_t block_end,
+	const std::vector<int64_t> & search_positions,
+	const csv_row_format & format) {
+	std::vector<char> buffer(block_end - block_start);
+	read_at(file, block_start, buffer.size(), buffer.data());
+
+	block_scan scan;
+	scan.terminators.resize(search_positions.size(), {{NOT_FOUND, NOT_FOUND}});
+	std::array<size_t, 2> unresolved{{0, 0}};  // search positions before these were resolved for each state
+
+	int quotes = 0;  // parity of the quotes of the block so far
+	for(size_t i = 0; i < buffer.size(); i++) {
+		if(buffer[i] == format.quotechar && format.quotechar != '\0') {
+			quotes ^= 1;
+		} else if(buffer[i] == format.lineterminator) {
+			// the terminator is outside quotes when the block started in the state that its quotes cancel
+			const int state = quotes;
+			const int64_t position = block_start + i;
+			if(scan.first_terminator[state] == NOT_FOUND) {
+				scan.first_terminator[state] = position;
+			}
+			while(unresolved[state] < search_positions.size() && search_positions[unresolved[state]] <= position) {
+				scan.terminators[unresolved[state]][state] = position;
+				unresolved[state]++;
+			}
+		}
+	}
+	scan.odd_quotes = quotes == 1;
+	return scan;
+}
+
+/**
+ * first byte of the first row that starts at or after each of the edges (sorted, inside the file), following the
+ * state of the quotes from the start of the file
+ */
+std::vector<int64_t> find_quoted_row_starts(const std::shared_ptr<arrow::io::RandomAccessFile> & file,
+	int64_t file_size,
+	const std::vector<int64_t> & edges,
+	const csv_row_format & format,
+	ThreadPool & scan_pool,
+	int64_t block_size) {
+	std::vector<int64_t> row_starts(edges.size(), file_size);
+	if(edges.empty()) {
+		return row_starts;
+	}
+
+	// a row starts at an edge when the byte before it is a line terminator
+	const int64_t num_blocks = (file_size + block_size - 1) / block_size;
+	const int64_t edge_blocks = (edges.back() - 1) / block_size + 1;
+
+	std::vector<size_t> waiting_edges;  // not found in the block of their edge, they start in a later block
+	size_t next_edge = 0;
+	int state = 0;
+	int64_t next_block = 0;
+	while(next_block < num_blocks && (next_block < edge_blocks || !waiting_edges.empty())) {
+		// the blocks up to the last edge are scanned at once, the rest only while a row still has not started
+		const int64_t last_block =
+			std::min(num_blocks, std::max(edge_blocks, next_block + static_cast<int64_t>(scan_pool.size())));
+
+		std::vector<std::vector<size_t>> block_edges;
+		std::vector<std::future<block_scan>> scans;
+		for(int64_t block = next_block; block < last_block; block++) {
+			const int64_t block_start = block * block_size;
+			const int64_t block_end = std::min(file_size, block_start + block_size);
+			std::vector<int64_t> search_positions;
+			block_edges.emplace_back();
+			while(next_edge < edges.size() && edges[next_edge] - 1 < block_end) {
+				search_positions.push_back(edges[next_edge] - 1);
+				block_edges.back().push_back(next_edge);
+				next_edge++;
+			}
+			scans.push_back(scan_pool.submit([&file, block_start, block_end, search_positions, &format]() {
+				return scan_block(file, block_start, block_end, search_positions, format);
+			}));
+		}
+		for(auto & scan : scans) {
+			scan.wait();
+		}
+
+		for(size_t i = 0; i < scans.size(); i++) {
+			block_scan scan = scans[i].get();
+			if(scan.first_terminator[state] != NOT_FOUND) {
+				for(size_t edge : waiting_edges) {
+					row_starts[edge] = scan.first_terminator[state] + 1;
+				}
+				waiting_edges.clear();
+			}
+			for(size_t j = 0; j < block_edges[i].size(); j++) {
+				if(scan.terminators[j][state] != NOT_FOUND) {
+					row_starts[block_edges[i][j]] = scan.terminators[j][state] + 1;
+				} else {
+					waiting_edges.push_back(block_edges[i][j]);
+				}
+			}
+			state ^= scan.odd_quotes ? 1 : 0;
+		}
+		next_block = last_block;
+	}
+	// the edges still waiting are in the last row of the file, which ends with it
+	return row_starts;
+}
+
+// a quote that opens a field follows one of these and a quote that closes one is followed by one of them
+bool is_field_edge(char c, const csv_row_format & format) {
+	return c == format.delimiter || c == format.lineterminator || c == format.quotechar || c == '\r' || c == ' ';
+}
+
+/**
+ * first byte of the first row that starts at or after edge found from the bytes after it only, NOT_FOUND when they
+ * do not tell. Both states the edge can be in are followed at once: in the wrong one the quotes that open fields
+ * close them and the other way around, and it soon has a quote that does not follow or is not followed by a field
+ * edge. A start is only returned once a quote rules the other state out: a window without quotes could be inside a
+ * quoted field longer than it, and with quotes in unquoted fields both states go wrong, those edges are left to the
+ * full scan.
+ */
+int64_t resync_row_start(const std::shared_ptr<arrow::io::RandomAccessFile> & file,
+	int64_t file_size,
+	int64_t edge,
+	const csv_row_format & format) {
+	const int64_t search_position = edge - 1;
+	const int64_t window_end = std::min(file_size, search_position + RESYNC_WINDOW_SIZE);
+
+	std::array<bool, 2> inside{{false, true}};
+	std::array<bool, 2> valid{{true, true}};
+	std::array<bool, 2> closed{{false, false}};  // the previous byte closed a quoted field
+	std::array<int64_t, 2> row_start{{NOT_FOUND, NOT_FOUND}};
+	char previous = format.lineterminator;  // the start of the file is a field edge
+	std::vector<char> buffer;
+	for(int64_t position = std::max<int64_t>(search_position - 1, 0); position < window_end;
+		position += buffer.size()) {
+		buffer.resize(std::min(SEARCH_STEP_SIZE, window_end - position));
+		read_at(file, position, buffer.size(), buffer.data());
+		for(size_t i = 0; i < buffer.size(); i++) {
+			const char c = buffer[i];
+			if(position + static_cast<int64_t>(i) >= search_position) {
+				for(int state = 0; state < 2; state++) {
+					if(closed[state] && !is_field_edge(c, format)) {
+						valid[state] = false;
+					}
+					closed[state] = false;
+					if(c == format.quotechar) {
+						if(inside[state]) {
+							closed[state] = true;
+						} else if(!is_field_edge(previous, format)) {
+							valid[state] = false;
+						}
+						inside[state] = !inside[state];
+					} else if(c == format.lineterminator && !inside[state] && row_start[state] == NOT_FOUND) {
+						row_start[state] = position + i + 1;
+					}
+				}
+				if(!valid[0] && !valid[1]) {
+					return NOT_FOUND;
+				}
+				if(valid[0] != valid[1] && row_start[valid[0] ? 0 : 1] != NOT_FOUND) {
+					return row_start[valid[0] ? 0 : 1];
+				}
+			}
+			previous = c;
+		}
+	}
+
+	// the last row of the file ends with it
+	if(window_end == file_size && valid[0] != valid[1]) {
+		return file_size;
+	}
+	return NOT_FOUND;
+}
+
+/**
+ * with quotes the edges that a quote after them settles are resynced on their own, the others need the state of the
+ * quotes from the start of the file
+ */
+std::vector<int64_t> find_resynced_row_starts(const std::shared_ptr<arrow::io::RandomAccessFile> & file,
+	int64_t file_size,
+	const std::vector<int64_t> & edges,
+	const csv_row_format & format,
+	ThreadPool & scan_pool,
+	int64_t block_size) {
+	std::vector<std::future<int64_t>> resyncs;
+	for(int64_t edge : edges) {
+		resyncs.push_back(scan_pool.submit(
+			[&file, file_size, edge, &format]() { return resync_row_start(file, file_size, edge, format); }));
+	}
+	for(auto & resync : resyncs) {
+		resync.wait();
+	}
+
+	std::vector<int64_t> row_starts;
+	std::vector<int64_t> unresolved_edges;
+	for(size_t i = 0; i < resyncs.size(); i++) {
+		row_starts.push_back(resyncs[i].get());
+		if(row_starts.back() == NOT_FOUND) {
+			unresolved_edges.push_back(edges[i]);
+		}
+	}
+	if(unresolved_edges.empty()) {
+		return row_starts;
+	}
+
+	std::vector<int64_t> scanned_row_starts =
+		find_quoted_row_starts(file, file_size, unresolved_edges, format, scan_pool, block_size);
+	for(size_t i = 0, j = 0; i < row_starts.size(); i++) {
+		if(row_starts[i] == NOT_FOUND) {
+			row_starts[i] = scanned_row_starts[j++];
+		}
+	}
+	return row_starts;
+}
+
+/**
+ * without quotes every line terminator ends a row, so each edge only needs the bytes from it to the next terminator
+ */
+std::vector<int64_t> find_row_starts(const std::shared_ptr<arrow::io::RandomAccessFile> & file,
+	int64_t file_size,
+	const std::vector<int64_t> & edges,
+	const csv_row_format & format,
+	ThreadPool & scan_pool) {
+	std::vector<std::future<int64_t>> searches;
+	for(int64_t edge : edges) {
+		searches.push_back(scan_pool.submit([&file, file_size, edge, &format]() {
+			std::vector<char> buffer;
+			for(int64_t position = edge - 1; position < file_size; position += buffer.size()) {
+				buffer.resize(std::min(SEARCH_STEP_SIZE, file_size - position));
+				read_at(file, position, buffer.size(), buffer.data());
+				auto terminator = std::find(buffer.begin(), buffer.end(), format.lineterminator);
+				if(terminator != buffer.end()) {
+					return position + (terminator - buffer.begin()) + 1;
+				}
+			}
+			return file_size;
+		}));
+	}
+	for(auto & search : searches) {
+		search.wait();
+	}
+
+	std::vector<int64_t> row_starts;
+	for(auto & search : searches) {
+		row_starts.push_back(search.get());
+	}
+	return row_starts;
+}
+
+}  // namespace
+
+int get_num_csv_byte_ranges(int64_t file_size, int64_t range_size) {
+	if(range_size <= 0 || file_size <= range_size) {
+		return 1;
+	}
+	return static_cast<int>((file_size + range_size - 1) / range_size);
+}
+
+std::vector<csv_byte_range> get_csv_byte_ranges(std::shared_ptr<arrow::io::RandomAccessFile> file,
+	int64_t range_size,
+	const std::vector<int> & range_ids,
+	const csv_row_format & format,
+	ThreadPool & scan_pool,
+	int64_t block_size) {
+	int64_t file_size;
+	arrow::Status status = file->GetSize(&file_size);
+	if(!status.ok()) {
+		throw std::runtime_error("Could not get the size of csv file: " + status.ToString());
+	}
+	const int num_ranges = get_num_csv_byte_ranges(file_size, range_size);
+
+	// the first row starts the file and the last one ends it, only the edges in between are searched
+	auto get_edge = [&](int range_id) {
+		return range_id >= num_ranges ? file_size : std::min(file_size, static_cast<int64_t>(range_id) * range_size);
+	};
+	std::vector<int64_t> edges;
+	for(int range_id : range_ids) {
+		if(range_id < 0 || range_id >= num_ranges) {
+			throw std::runtime_error("Range " + std::to_string(range_id) + " is not in a csv file of " +
+									 std::to_string(num_ranges) + " ranges");
+		}
+		for(int64_t edge : {get_edge(range_id), get_edge(range_id + 1)}) {
+			if(edge > 0 && edge < file_size) {
+				edges.push_back(edge);
+			}
+		}
+	}
+	std::sort(edges.begin(), edges.end());
+	edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+	std::vector<int64_t> row_starts =
+		format.quotechar == '\0'
+			? find_row_starts(file, file_size, edges, format, scan_pool)
+			: find_resynced_row_starts(file, file_size, edges, format, scan_pool, std::max<int64_t>(block_size, 1));
+
+	auto get_row_start = [&](int64_t edge) {
+		if(edge <= 0 || edge >= file_size) {
+			return std::max<int64_t>(0, std::min(edge, file_size));
+		}
+		return row_starts[std::lower_bound(edges.begin(), edges.end(), edge) - edges.begin()];
+	};
+	std::vector<csv_byte_range> ranges;
+	for(int range_id : range_ids) {
+		ranges.push_back(csv_byte_range{get_row_start(get_edge(range_id)), get_row_start(get_edge(range_id + 1))});
+	}
+	return ranges;
+}
+
+} /* namespace io */
+} /* namespace ral */
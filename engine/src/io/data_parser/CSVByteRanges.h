@@ -0,0 +1,66 @@
+/*
+ * CSVByteRanges.h
+ *
+ * Splits a csv into byte ranges of whole rows so a single large file can be parsed in parallel and spread across
+ * nodes the way the row groups of a parquet file are. Range i holds the rows that start in the bytes
+ * [i * range_size, (i + 1) * range_size), a row that starts in a range is parsed there even if it ends in the next
+ * one. Rows start after a line terminator that is not inside a quoted field, quoted fields can hold line terminators.
+ */
+
+#ifndef CSVBYTERANGES_H_
+#define CSVBYTERANGES_H_
+
+#include "arrow/io/interfaces.h"
+#include <blazingdb/io/Util/ThreadPool.h>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace ral {
+namespace io {
+
+struct csv_byte_range {
+	int64_t start;  // first byte of the first row of the range
+	int64_t end;	// first byte after the last row, equal to start when no row starts in the range
+};
+
+struct csv_row_format {
+	char lineterminator = '\n';
+	char delimiter = ',';
+	/**
+	 * '\0' when fields are never quoted. A doubled quote inside a quoted field leaves and enters the field again, so
+	 * it needs no special handling to find where rows start.
+	 */
+	char quotechar = '"';
+};
+
+/**
+ * each scan task reads a block this size, small enough that a pool of them does not hold much memory
+ */
+const int64_t DEFAULT_CSV_SCAN_BLOCK_SIZE = 8 * 1024 * 1024;
+
+/**
+ * number of ranges of range_size bytes of a file of file_size bytes, an empty file still has one empty range
+ */
+int get_num_csv_byte_ranges(int64_t file_size, int64_t range_size);
+
+/**
+ * finds where the rows of the ranges range_ids (sorted, as returned by get_row_groups_to_decode) start and end.
+ * Without quotes only the bytes around the edges of the ranges are read. With quotes whether an edge is inside a
+ * quoted field depends on every byte before it, but where the quotes sit in the bytes after the edge usually tells,
+ * so those are read first. Only for the edges they do not settle the file is scanned from its start up to the last
+ * of them in blocks that run in parallel on scan_pool, each block is scanned once for both states it can start in.
+ *
+ * Must not be called from a task of scan_pool.
+ */
+std::vector<csv_byte_range> get_csv_byte_ranges(std::shared_ptr<arrow::io::RandomAccessFile> file,
+	int64_t range_size,
+	const std::vector<int> & range_ids,
+	const csv_row_format & format,
+	ThreadPool & scan_pool,
+	int64_t block_size = DEFAULT_CSV_SCAN_BLOCK_SIZE);
+
+} /* namespace io */
+} /* namespace ral */
+
+#endif /* CSVBYTERANGES_H_ */
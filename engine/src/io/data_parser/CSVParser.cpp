@@ -8,14 +8,19 @@
 #include "CSVParser.h"
 #include "../Utils.cuh"
 #include "cudf/legacy/io_types.hpp"
+#include "io/data_parser/CSVByteRanges.h"
 #include "io/data_parser/ParserUtil.h"
+#include "io/data_parser/RowGroupDecoder.h"
+#include "utilities/CommonOperations.h"
 #include <arrow/buffer.h>
 #include <arrow/io/interfaces.h>
 #include <arrow/io/memory.h>
+#include <blazingdb/io/FileSystem/MappedReadableFile.h>
 #include <iostream>
 #include <numeric>
 
 #include <algorithm>
+#include <atomic>
 #include <numeric>
 #define checkError(error, txt)                                                                                         \
 	if(error != GDF_SUCCESS) {                                                                                         \
@@ -53,10 +58,85 @@ cudf::table read_csv_arg_arrow(cudf::csv_read_arg args,
 }
 
 
+namespace {
+
+const int64_t DEFAULT_RANGE_SIZE = 256 * 1024 * 1024;
+
+std::atomic<int64_t> range_size(DEFAULT_RANGE_SIZE);
+
+bool ends_with(const std::string & text, const std::string & suffix) {
+	return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// a range can be parsed by itself unless the rows to read depend on the ones before it, or the bytes of the file are
+// not the bytes of the csv
+bool can_split_in_ranges(const cudf::csv_read_arg & args, const std::string & user_readable_file_handle) {
+	if(args.nrows >= 0 || args.skiprows > 0 || args.skipfooter > 0 || args.byte_range_offset > 0 ||
+		args.byte_range_size > 0) {
+		return false;
+	}
+	// a comment can hold a quote the scan for the rows would take for the start of a quoted field
+	if(args.comment != '\0') {
+		return false;
+	}
+	if(args.compression == "infer") {
+		for(const char * extension : {".gz", ".bz2", ".zip", ".xz"}) {
+			if(ends_with(user_readable_file_handle, extension)) {
+				return false;
+			}
+		}
+		return true;
+	}
+	return args.compression == "none";
+}
+
+int get_num_ranges(const cudf::csv_read_arg & args,
+	const std::string & user_readable_file_handle,
+	std::shared_ptr<arrow::io::RandomAccessFile> file) {
+	int64_t num_bytes;
+	if(!can_split_in_ranges(args, user_readable_file_handle) || !file->GetSize(&num_bytes).ok()) {
+		return 1;
+	}
+	return get_num_csv_byte_ranges(num_bytes, range_size);
+}
+
+std::vector<gdf_column_cpp> to_gdf_columns(cudf::table & table_out, const std::vector<size_t> & column_indices) {
+	assert(table_out.num_columns() > 0);
+
+	// column_indices may be requested in a specific order (not necessarily sorted), but read_csv will output the
+	// columns in the sorted order, so we need to put them back into the order we want
+	std::vector<size_t> idx(column_indices.size());
+	std::iota(idx.begin(), idx.end(), 0);
+	// sort indexes based on comparing values in column_indices
+	std::sort(idx.begin(), idx.end(), [&column_indices](size_t i1, size_t i2) {
+		return column_indices[i1] < column_indices[i2];
+	});
+
+	std::vector<gdf_column_cpp> columns_out(column_indices.size());
+	for(size_t i = 0; i < columns_out.size(); i++) {
+		if(table_out.get_column(i)->dtype == GDF_STRING) {
+			NVStrings * strs = static_cast<NVStrings *>(table_out.get_column(i)->data);
+			NVCategory * category = NVCategory::create_from_strings(*strs);
+			std::string column_name(table_out.get_column(i)->col_name);
+			columns_out[idx[i]].create_gdf_column(category, table_out.get_column(i)->size, column_name);
+			gdf_column_free(table_out.get_column(i));
+		} else {
+			columns_out[idx[i]].create_gdf_column(table_out.get_column(i));
+		}
+	}
+	return columns_out;
+}
+
+}  // namespace
+
 csv_parser::csv_parser(cudf::csv_read_arg arg) : csv_arg{arg} {}
 
 csv_parser::~csv_parser() {}
 
+int64_t csv_parser::get_range_size() { return range_size; }
+
+void csv_parser::set_range_size(int64_t new_range_size) { range_size = new_range_size; }
+
 // schema is not really necessary yet here, but we want it to maintain compatibility
 void csv_parser::parse(std::shared_ptr<arrow::io::RandomAccessFile> file,
 	const std::string & user_readable_file_handle,
@@ -80,48 +160,114 @@ void csv_parser::parse(std::shared_ptr<arrow::io::RandomAccessFile> file,
 		csv_arg.use_cols_indexes.resize(column_indices.size());
 		csv_arg.use_cols_indexes.assign(column_indices.begin(), column_indices.end());
 
-		cudf::table table_out = read_csv_arg_arrow(csv_arg, file);
-
-		assert(table_out.num_columns() > 0);
-
-		// column_indices may be requested in a specific order (not necessarily sorted), but read_csv will output the
-		// columns in the sorted order, so we need to put them back into the order we want
-		std::vector<size_t> idx(column_indices.size());
-		std::iota(idx.begin(), idx.end(), 0);
-		// sort indexes based on comparing values in column_indices
-		std::sort(idx.begin(), idx.end(), [&column_indices](size_t i1, size_t i2) {
-			return column_indices[i1] < column_indices[i2];
-		});
-
-		columns_out.resize(column_indices.size());
-		for(size_t i = 0; i < columns_out.size(); i++) {
-			if(table_out.get_column(i)->dtype == GDF_STRING) {
-				NVStrings * strs = static_cast<NVStrings *>(table_out.get_column(i)->data);
-				NVCategory * category = NVCategory::create_from_strings(*strs);
-				std::string column_name(table_out.get_column(i)->col_name);
-				columns_out[idx[i]].create_gdf_column(category, table_out.get_column(i)->size, column_name);
-				gdf_column_free(table_out.get_column(i));
-			} else {
-				columns_out[idx[i]].create_gdf_column(table_out.get_column(i));
+		// every byte of a csv is parsed whatever the projection is
+		auto mapped_file = std::dynamic_pointer_cast<MappedReadableFile>(file);
+		if(mapped_file) {
+			int64_t size;
+			mapped_file->GetSize(&size);
+			mapped_file->Advise(0, size, MappedFileAdvice::SEQUENTIAL);
+		}
+
+		const int num_ranges = get_num_ranges(csv_arg, user_readable_file_handle, file);
+		const std::vector<int> range_ids = get_row_groups_to_decode(schema.get_rowgroup_ids(0), num_ranges);
+		if(num_ranges == 1 && range_ids.size() == 1) {
+			cudf::table table_out = read_csv_arg_arrow(csv_arg, file);
+			columns_out = to_gdf_columns(table_out, column_indices);
+			return;
+		}
+
+		csv_row_format format;
+		format.lineterminator = csv_arg.lineterminator;
+		format.delimiter = csv_arg.delimiter;
+		format.quotechar = csv_arg.quotechar;
+		std::shared_ptr<ThreadPool> decode_pool = get_decode_pool();
+		std::vector<csv_byte_range> ranges;
+		for(const csv_byte_range & range :
+			get_csv_byte_ranges(file, range_size, range_ids, format, *decode_pool)) {
+			if(range.start < range.end) {
+				ranges.push_back(range);
 			}
 		}
+		if(ranges.empty()) {
+			file->Close();
+			columns_out =
+				create_empty_columns(schema.get_names(), schema.get_dtypes(), schema.get_time_units(), column_indices);
+			return;
+		}
+
+		// the types are the ones of the whole file, a range inferring its own could not be concatenated with the others
+		std::vector<std::string> names(schema.get_num_columns());
+		std::vector<std::string> types(schema.get_num_columns());
+		for(size_t i = 0; i < schema.get_num_columns(); i++) {
+			names[schema.get_file_index(i)] = schema.get_name(i);
+			types[schema.get_file_index(i)] = schema.get_type(i);
+		}
+		if(csv_arg.dtype.empty()) {
+			csv_arg.dtype = types;
+		}
+		csv_arg.source = cudf::source_info(file);
+
+		std::vector<int> range_indices(ranges.size());
+		std::iota(range_indices.begin(), range_indices.end(), 0);
+		std::vector<std::vector<gdf_column_cpp>> columns_per_range = decode_row_groups(range_indices,
+			[&](int range_index) {
+				const csv_byte_range & range = ranges[range_index];
+				cudf::csv_read_arg range_arg = csv_arg;
+				if(range.start == 0) {
+					range_arg.byte_range_offset = 0;
+				} else {
+					// cudf starts a range after the first line terminator it finds, the one that ends the previous row
+					range_arg.byte_range_offset = range.start - 1;
+					range_arg.header = -1;
+					range_arg.names = names;
+				}
+				// cudf reads whole every row that starts before the end of the range
+				range_arg.byte_range_size = range.end - range_arg.byte_range_offset;
+				cudf::table table_out = read_csv(range_arg);
+				return to_gdf_columns(table_out, column_indices);
+			},
+			*decode_pool);
+		file->Close();
+
+		if(columns_per_range.size() == 1) {
+			columns_out = columns_per_range[0];
+		} else {
+			columns_out = ral::utilities::concatTables(columns_per_range);
+		}
 	}
 }
 
 
-void csv_parser::parse_schema(
-	std::vector<std::shared_ptr<arrow::io::RandomAccessFile>> files, ral::io::Schema & schema) {
+void csv_parser::parse_schema(std::vector<std::shared_ptr<arrow::io::RandomAccessFile>> files,
+	const std::vector<std::string> & user_readable_file_handles,
+	ral::io::Schema & schema) {
+	// the ranges of each file are its row groups, so skip-data and the nodes can split a large file like a parquet one
+	std::vector<size_t> num_row_groups(files.size());
+	for(size_t file_index = 0; file_index < files.size(); file_index++) {
+		const std::string file_handle =
+			file_index < user_readable_file_handles.size() ? user_readable_file_handles[file_index] : "";
+		num_row_groups[file_index] = get_num_ranges(csv_arg, file_handle, files[file_index]);
+	}
+
 	cudf::table table_out = read_csv_arg_arrow(csv_arg, files[0], true);
 
 	assert(table_out.num_columns() > 0);
 
+	std::vector<std::string> names;
+	std::vector<size_t> column_indices;
+	std::vector<gdf_dtype> dtypes;
+	std::vector<gdf_time_unit> time_units;
 	for(size_t i = 0; i < table_out.num_columns(); i++) {
 		gdf_column_cpp c;
 		c.create_gdf_column(table_out.get_column(i));
 		if(i < csv_arg.names.size())
 			c.set_name(csv_arg.names[i]);
-		schema.add_column(c, i);
+		names.push_back(c.name());
+		column_indices.push_back(i);
+		dtypes.push_back(c.dtype());
+		time_units.push_back(c.dtype_info().time_unit);
 	}
+	schema = ral::io::Schema(names, column_indices, dtypes, time_units, num_row_groups);
 }
 
 } /* namespace io */
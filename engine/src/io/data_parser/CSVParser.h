@@ -30,7 +30,16 @@ public:
 		const Schema & schema,
 		std::vector<size_t> column_indices_requested);
 
-	void parse_schema(std::vector<std::shared_ptr<arrow::io::RandomAccessFile>> files, ral::io::Schema & schema);
+	void parse_schema(std::vector<std::shared_ptr<arrow::io::RandomAccessFile>> files,
+		const std::vector<std::string> & user_readable_file_handles,
+		ral::io::Schema & schema);
+
+	/**
+	 * a file larger than this is split in ranges of about this many bytes of whole rows, its row groups. They are
+	 * parsed in parallel on the decode pool and can be spread across nodes like the row groups of a parquet file.
+	 */
+	static int64_t get_range_size();
+	static void set_range_size(int64_t range_size);
 
 private:
 	cudf::csv_read_arg csv_arg{cudf::source_info{""}};
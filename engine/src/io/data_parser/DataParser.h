@@ -12,7 +12,9 @@
 #include "../Schema.h"
 #include "GDFColumn.cuh"
 #include "arrow/io/interfaces.h"
+#include <blazingdb/io/FileSystem/FileStatus.h>
 #include <memory>
+#include <string>
 #include <vector>
 
 namespace ral {
@@ -31,11 +33,29 @@ public:
 		const Schema & schema,
 		std::vector<size_t> column_indices) = 0;
 
+	/**
+	 * parses a file a provider found, file_status is its status as the provider found it. Parsers that key what they
+	 * cache by the identity of the file take it from there instead of asking the filesystem again.
+	 */
+	virtual void parse(std::shared_ptr<arrow::io::RandomAccessFile> file,
+		const std::string & user_readable_file_handle,
+		const FileStatus & file_status,
+		std::vector<gdf_column_cpp> & columns,
+		const Schema & schema,
+		std::vector<size_t> column_indices) {
+		parse(file, user_readable_file_handle, columns, schema, column_indices);
+	}
 
-	virtual void parse_schema(
-		std::vector<std::shared_ptr<arrow::io::RandomAccessFile>> files, ral::io::Schema & schema) = 0;
+	/**
+	 * user_readable_file_handles are the uris the files were opened from, in the same order
+	 */
+	virtual void parse_schema(std::vector<std::shared_ptr<arrow::io::RandomAccessFile>> files,
+		const std::vector<std::string> & user_readable_file_handles,
+		ral::io::Schema & schema) = 0;
 
-	virtual bool get_metadata(std::vector<std::shared_ptr<arrow::io::RandomAccessFile>> files, ral::io::Metadata & metadata) {
+	virtual bool get_metadata(std::vector<std::shared_ptr<arrow::io::RandomAccessFile>> files,
+		const std::vector<std::string> & user_readable_file_handles,
+		ral::io::Metadata & metadata) {
 		return false;
 	}
 };
@@ -58,8 +58,9 @@ void gdf_parser::parse(std::shared_ptr<arrow::io::RandomAccessFile> file,
 	columns_out = columns;
 }
 
-void gdf_parser::parse_schema(
-	std::vector<std::shared_ptr<arrow::io::RandomAccessFile>> files, ral::io::Schema & schema) {
+void gdf_parser::parse_schema(std::vector<std::shared_ptr<arrow::io::RandomAccessFile>> files,
+	const std::vector<std::string> & user_readable_file_handles,
+	ral::io::Schema & schema) {
 	std::vector<std::string> names;
 	std::vector<gdf_dtype> types;
 	std::vector<gdf_time_unit> time_units;
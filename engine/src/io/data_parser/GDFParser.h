@@ -29,7 +29,9 @@ public:
 		std::vector<size_t> column_indices_requested);
 
 
-	void parse_schema(std::vector<std::shared_ptr<arrow::io::RandomAccessFile>> files, ral::io::Schema & schema);
+	void parse_schema(std::vector<std::shared_ptr<arrow::io::RandomAccessFile>> files,
+		const std::vector<std::string> & user_readable_file_handles,
+		ral::io::Schema & schema);
 
 	;
 
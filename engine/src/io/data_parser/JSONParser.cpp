@@ -111,8 +111,9 @@ void json_parser::parse(std::shared_ptr<arrow::io::RandomAccessFile> file,
 	}
 }
 
-void json_parser::parse_schema(
-	std::vector<std::shared_ptr<arrow::io::RandomAccessFile>> files, ral::io::Schema & schema_out) {
+void json_parser::parse_schema(std::vector<std::shared_ptr<arrow::io::RandomAccessFile>> files,
+	const std::vector<std::string> & user_readable_file_handles,
+	ral::io::Schema & schema_out) {
 	cudf::table table_out = read_json_arrow(files[0], this->args.lines, this->args, true);
 	assert(table_out.num_columns() > 0);
 
@@ -29,7 +29,9 @@ public:
 		const Schema & schema,
 		std::vector<size_t> column_indices_requested);
 
-	void parse_schema(std::vector<std::shared_ptr<arrow::io::RandomAccessFile>> files, Schema & schema);
+	void parse_schema(std::vector<std::shared_ptr<arrow::io::RandomAccessFile>> files,
+		const std::vector<std::string> & user_readable_file_handles,
+		Schema & schema);
 
 private:
 	cudf::json_read_arg args;
@@ -71,8 +71,9 @@ void orc_parser::parse(std::shared_ptr<arrow::io::RandomAccessFile> file,
 }
 
 
-void orc_parser::parse_schema(
-	std::vector<std::shared_ptr<arrow::io::RandomAccessFile>> files, ral::io::Schema & schema_out) {
+void orc_parser::parse_schema(std::vector<std::shared_ptr<arrow::io::RandomAccessFile>> files,
+	const std::vector<std::string> & user_readable_file_handles,
+	ral::io::Schema & schema_out) {
 	orc_args.source = cudf::source_info(files[0]);
 	orc_args.num_rows = 1;
 
@@ -0,0 +1,178 @@
+#include "ParquetFooterCache.h"
+#include "Config/BlazingContext.h"
+#include <algorithm>
+#include <exception>
+#include <parquet/file_reader.h>
+#include <stdexcept>
+
+namespace ral {
+namespace io {
+
+namespace {
+
+std::shared_ptr<parquet::FileMetaData> read_footer(std::shared_ptr<arrow::io::RandomAccessFile> file) {
+	if(file == nullptr) {
+		throw std::runtime_error("Could not read the footer of a parquet file that was not opened");
+	}
+	std::unique_ptr<parquet::ParquetFileReader> parquet_reader = parquet::ParquetFileReader::Open(file);
+	std::shared_ptr<parquet::FileMetaData> file_metadata = parquet_reader->metadata();
+	parquet_reader->Close();
+	return file_metadata;
+}
+
+}  // namespace
+
+parquet_footer_cache::parquet_footer_cache(parquet_footer_cache_options options) : options(options), use_counter(0) {}
+
+std::shared_ptr<parquet_footer_cache> parquet_footer_cache::get_default_instance() {
+	static std::shared_ptr<parquet_footer_cache> cache = std::make_shared<parquet_footer_cache>();
+	return cache;
+}
+
+std::shared_ptr<parquet::FileMetaData> parquet_footer_cache::get_footer(const std::string & path,
+	std::shared_ptr<arrow::io::RandomAccessFile> file,
+	const FileStatus & known_status) {
+	std::string key;
+	auto expiration = std::chrono::steady_clock::time_point::max();
+	try {
+		auto fs_manager = BlazingContext::getInstance()->getFileSystemManager();
+		if(!path.empty() && fs_manager) {
+			const Uri uri{path};
+			const FileStatus status = known_status.isFile() ? known_status : fs_manager->getFileStatus(uri);
+			int64_t size = -1;
+			// the size of the opened file guards against a path that names something else, like a directory
+			if(status.isFile() && file != nullptr && file->GetSize(&size).ok() &&
+				size == static_cast<int64_t>(status.getFileSize())) {
+				key = uri.toString(true) + "|" + std::to_string(size) + "|" +
+					  std::to_string(status.getModificationTime());
+				if(status.getModificationTime() == 0) {
+					expiration = std::chrono::steady_clock::now() + this->options.unknown_modification_time_to_live;
+				}
+			}
+		}
+	} catch(...) {
+		// a file whose status can not be read is still read, its footer is just not cached
+		key.clear();
+	}
+
+	if(key.empty()) {
+		{
+			std::lock_guard<std::mutex> lock(this->mutex);
+			this->stats.uncached++;
+		}
+		return read_footer(file);
+	}
+	return this->get(key, expiration, [file]() { return read_footer(file); });
+}
+
+std::vector<std::shared_ptr<parquet::FileMetaData>> parquet_footer_cache::get_footers(
+	const std::vector<std::string> & paths,
+	const std::vector<std::shared_ptr<arrow::io::RandomAccessFile>> & files,
+	ThreadPool & io_pool) {
+	std::vector<std::future<std::shared_ptr<parquet::FileMetaData>>> reading;
+	for(size_t file_index = 0; file_index < files.size(); file_index++) {
+		const std::string path = file_index < paths.size() ? paths[file_index] : "";
+		std::shared_ptr<arrow::io::RandomAccessFile> file = files[file_index];
+		reading.push_back(io_pool.submit([this, path, file]() { return this->get_footer(path, file); }));
+	}
+
+	// the reads still running use the files of the caller
+	for(auto & footer : reading) {
+		footer.wait();
+	}
+	std::vector<std::shared_ptr<parquet::FileMetaData>> footers;
+	for(auto & footer : reading) {
+		footers.push_back(footer.get());
+	}
+	return footers;
+}
+
+std::shared_ptr<parquet::FileMetaData> parquet_footer_cache::get(const std::string & key,
+	std::chrono::steady_clock::time_point expiration,
+	const std::function<std::shared_ptr<parquet::FileMetaData>()> & read_footer) {
+	std::shared_ptr<std::promise<std::shared_ptr<parquet::FileMetaData>>> promise;
+	std::shared_future<std::shared_ptr<parquet::FileMetaData>> footer;
+	uint64_t read_id = 0;
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		const auto now = std::chrono::steady_clock::now();
+		const uint64_t use = ++this->use_counter;
+
+		auto found = this->entries.find(key);
+		if(found != this->entries.end() && found->second.expiration > now) {
+			found->second.last_use = use;
+			footer = found->second.footer;
+			if(footer.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+				this->stats.hits++;
+			} else {
+				this->stats.coalesced++;
+			}
+		} else {
+			this->stats.misses++;
+			promise = std::make_shared<std::promise<std::shared_ptr<parquet::FileMetaData>>>();
+			footer = promise->get_future().share();
+			read_id = use;
+			this->entries[key] = entry{footer, expiration, use, read_id};
+			this->evict(now);
+		}
+	}
+
+	if(promise) {
+		try {
+			promise->set_value(read_footer());
+		} catch(...) {
+			{
+				std::lock_guard<std::mutex> lock(this->mutex);
+				auto found = this->entries.find(key);
+				if(found != this->entries.end() && found->second.read_id == read_id) {
+					this->entries.erase(found);
+				}
+			}
+			promise->set_exception(std::current_exception());
+		}
+	}
+
+	return footer.get();
+}
+
+void parquet_footer_cache::evict(std::chrono::steady_clock::time_point now) {
+	if(this->entries.size() <= this->options.max_footers) {
+		return;
+	}
+
+	for(auto found = this->entries.begin(); found != this->entries.end();) {
+		if(found->second.expiration <= now) {
+			found = this->entries.erase(found);
+		} else {
+			++found;
+		}
+	}
+	if(this->entries.size() <= this->options.max_footers) {
+		return;
+	}
+
+	// a tenth of the bound goes at once, so a table larger than the cache does not scan it on every footer
+	std::vector<std::pair<uint64_t, std::string>> uses;
+	for(const auto & cached : this->entries) {
+		uses.emplace_back(cached.second.last_use, cached.first);
+	}
+	const size_t keep = this->options.max_footers - this->options.max_footers / 10;
+	const size_t num_evicted = uses.size() - std::min(keep, uses.size());
+	std::nth_element(uses.begin(), uses.begin() + num_evicted, uses.end());
+	for(size_t i = 0; i < num_evicted; i++) {
+		this->entries.erase(uses[i].second);
+	}
+}
+
+void parquet_footer_cache::clear() {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->entries.clear();
+}
+
+parquet_footer_cache_stats parquet_footer_cache::get_stats() {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return this->stats;
+}
+
+} /* namespace io */
+} /* namespace ral */
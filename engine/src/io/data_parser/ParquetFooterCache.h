@@ -0,0 +1,113 @@
+/*
+ * ParquetFooterCache.h
+ *
+ * Cache of the parsed footers of parquet files, shared by the schema inference, the skip-data metadata and the
+ * parsing of the files, so registering and then querying a table reads each footer once. A footer is keyed by the
+ * identity of its file: path, size and modification time.
+ */
+
+#ifndef PARQUETFOOTERCACHE_H_
+#define PARQUETFOOTERCACHE_H_
+
+#include <arrow/io/interfaces.h>
+#include <blazingdb/io/FileSystem/FileStatus.h>
+#include <blazingdb/io/Util/ThreadPool.h>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace parquet {
+class FileMetaData;
+}
+
+namespace ral {
+namespace io {
+
+struct parquet_footer_cache_options {
+	/**
+	 * bound of the footers kept, the least recently used go first
+	 */
+	size_t max_footers = 20000;
+	/**
+	 * filesystems that do not report modification times can rewrite a file keeping its size, so those footers are only
+	 * served for this long
+	 */
+	std::chrono::milliseconds unknown_modification_time_to_live = std::chrono::seconds(30);
+};
+
+struct parquet_footer_cache_stats {
+	int64_t hits = 0;
+	int64_t misses = 0;
+	int64_t coalesced = 0;  // requests that waited for the read another request made
+	int64_t uncached = 0;   // reads of files whose identity could not be established
+};
+
+class parquet_footer_cache {
+public:
+	explicit parquet_footer_cache(parquet_footer_cache_options options = parquet_footer_cache_options());
+
+	/**
+	 * cache shared by every parquet_parser
+	 */
+	static std::shared_ptr<parquet_footer_cache> get_default_instance();
+
+	/**
+	 * footer of file, whose uri is path. A file that is not found under path as a regular file of the same size is
+	 * read every time, as is any file when path is empty. The status of the file is the one given when it is a file,
+	 * like the one its data provider found it with, otherwise it is asked to the filesystem.
+	 */
+	std::shared_ptr<parquet::FileMetaData> get_footer(const std::string & path,
+		std::shared_ptr<arrow::io::RandomAccessFile> file,
+		const FileStatus & known_status = FileStatus());
+
+	/**
+	 * footers of files in their order, the ones not cached are read in parallel on io_pool, so at most as many files
+	 * as it has threads are read at the same time. Must not be called from a task of io_pool.
+	 */
+	std::vector<std::shared_ptr<parquet::FileMetaData>> get_footers(const std::vector<std::string> & paths,
+		const std::vector<std::shared_ptr<arrow::io::RandomAccessFile>> & files,
+		ThreadPool & io_pool);
+
+	void clear();
+
+	parquet_footer_cache_stats get_stats();
+
+private:
+	struct entry {
+		std::shared_future<std::shared_ptr<parquet::FileMetaData>> footer;
+		std::chrono::steady_clock::time_point expiration;
+		uint64_t last_use;
+		uint64_t read_id;
+	};
+
+	/**
+	 * returns the footer of key, calling read_footer when it is missing or expired. Errors thrown by read_footer reach
+	 * every request waiting for it and are not cached.
+	 */
+	std::shared_ptr<parquet::FileMetaData> get(const std::string & key,
+		std::chrono::steady_clock::time_point expiration,
+		const std::function<std::shared_ptr<parquet::FileMetaData>()> & read_footer);
+
+	/**
+	 * must be called with the mutex held
+	 */
+	void evict(std::chrono::steady_clock::time_point now);
+
+	parquet_footer_cache_options options;
+
+	std::mutex mutex;
+	std::unordered_map<std::string, entry> entries;
+	uint64_t use_counter;
+	parquet_footer_cache_stats stats;
+};
+
+} /* namespace io */
+} /* namespace ral */
+
+#endif /* PARQUETFOOTERCACHE_H_ */
@@ -3,6 +3,7 @@
 
 #include "ParquetParser.h"
 #include "config/GPUManager.cuh"
+#include <blazingdb/io/FileSystem/MappedReadableFile.h>
 #include <blazingdb/io/Util/StringUtil.h>
 #include <cudf/legacy/column.hpp>
 #include <cudf/legacy/io_functions.hpp>
@@ -13,6 +14,7 @@
 #include <unordered_map>
 #include <vector>
 #include <memory>
+#include <mutex>
 #include <algorithm>
 #include <numeric>
 #include <string>
@@ -40,13 +42,97 @@
 #include "../Schema.h"
 #include "../Metadata.h"
 
+#include "io/data_parser/ParquetFooterCache.h"
 #include "io/data_parser/ParserUtil.h"
+#include "io/data_parser/RowGroupDecoder.h"
+#include "io/data_provider/PrefetchingDataProvider.h"
+#include "utilities/CommonOperations.h"
 
 #include <numeric>
 
 namespace ral {
 namespace io {
 
+namespace {
+
+// Only the column chunks of the projected columns are read, so read-ahead over the mapping would mostly bring in the
+// pages of the other columns. Read-ahead is turned off and the chunks that will be read are requested up front.
+void advise_projected_column_chunks(std::shared_ptr<MappedReadableFile> file,
+	std::shared_ptr<parquet::FileMetaData> file_metadata,
+	const std::vector<std::string> & column_names,
+	const std::vector<int> & row_groups) {
+	int64_t size;
+	file->GetSize(&size);
+	file->Advise(0, size, MappedFileAdvice::RANDOM);
+
+	for(const std::string & column_name : column_names) {
+		const int column_index = file_metadata->schema()->ColumnIndex(column_name);
+		if(column_index < 0) {
+			continue;
+		}
+
+		for(int row_group_index : row_groups) {
+			std::unique_ptr<parquet::ColumnChunkMetaData> column_chunk =
+				file_metadata->RowGroup(row_group_index)->ColumnChunk(column_index);
+			const int64_t start = column_chunk->has_dictionary_page() ? column_chunk->dictionary_page_offset()
+																	   : column_chunk->data_page_offset();
+			file->Advise(start, column_chunk->total_compressed_size(), MappedFileAdvice::WILLNEED);
+		}
+	}
+}
+
+// Building a reader parses the footer of the file again, so the row groups of a file share their readers: a reader
+// decodes one row group at a time and goes back to the pool for the next one, there are never more readers than row
+// groups decoded at once.
+class parquet_reader_pool {
+public:
+	parquet_reader_pool(std::shared_ptr<arrow::io::RandomAccessFile> file, cudf::io::parquet::reader_options options)
+		: file(file), options(options) {}
+
+	std::unique_ptr<cudf::io::parquet::reader> acquire() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if(!readers.empty()) {
+				std::unique_ptr<cudf::io::parquet::reader> reader = std::move(readers.back());
+				readers.pop_back();
+				return reader;
+			}
+		}
+		return std::make_unique<cudf::io::parquet::reader>(file, options);
+	}
+
+	void release(std::unique_ptr<cudf::io::parquet::reader> reader) {
+		std::lock_guard<std::mutex> lock(mutex);
+		readers.push_back(std::move(reader));
+	}
+
+private:
+	std::shared_ptr<arrow::io::RandomAccessFile> file;
+	cudf::io::parquet::reader_options options;
+	std::mutex mutex;
+	std::vector<std::unique_ptr<cudf::io::parquet::reader>> readers;
+};
+
+std::vector<gdf_column_cpp> to_gdf_columns(cudf::table & table_out) {
+	assert(table_out.num_columns() > 0);
+
+	std::vector<gdf_column_cpp> columns_out(table_out.num_columns());
+	for(size_t i = 0; i < columns_out.size(); i++) {
+		if(table_out.get_column(i)->dtype == GDF_STRING) {
+			NVStrings * strs = static_cast<NVStrings *>(table_out.get_column(i)->data);
+			NVCategory * category = NVCategory::create_from_strings(*strs);
+			std::string column_name(table_out.get_column(i)->col_name);
+			columns_out[i].create_gdf_column(category, table_out.get_column(i)->size, column_name);
+			gdf_column_free(table_out.get_column(i));
+		} else {
+			columns_out[i].create_gdf_column(table_out.get_column(i));
+		}
+	}
+	return columns_out;
+}
+
+}  // namespace
+
 parquet_parser::parquet_parser() {
 	// TODO Auto-generated constructor stub
 }
@@ -60,6 +146,15 @@ void parquet_parser::parse(std::shared_ptr<arrow::io::RandomAccessFile> file,
 	std::vector<gdf_column_cpp> & columns_out,
 	const Schema & schema,
 	std::vector<size_t> column_indices) {
+	parse(file, user_readable_file_handle, FileStatus(), columns_out, schema, column_indices);
+}
+
+void parquet_parser::parse(std::shared_ptr<arrow::io::RandomAccessFile> file,
+	const std::string & user_readable_file_handle,
+	const FileStatus & file_status,
+	std::vector<gdf_column_cpp> & columns_out,
+	const Schema & schema,
+	std::vector<size_t> column_indices) {
 	if(column_indices.size() == 0) {  // including all columns by default
 		column_indices.resize(schema.get_num_columns());
 		std::iota(column_indices.begin(), column_indices.end(), 0);
@@ -80,25 +175,44 @@ void parquet_parser::parse(std::shared_ptr<arrow::io::RandomAccessFile> file,
 		for(size_t column_i = 0; column_i < column_indices.size(); column_i++) {
 			pq_args.columns[column_i] = schema.get_name(column_indices[column_i]);
 		}
-		// TODO: Use schema.row_groups_ids to read only some row_groups
-		cudf::io::parquet::reader parquet_reader(file, pq_args);
-
-		cudf::table table_out = parquet_reader.read_all();
-
-		assert(table_out.num_columns() > 0);
-
-		columns_out.resize(column_indices.size());
-		for(size_t i = 0; i < columns_out.size(); i++) {
-			if(table_out.get_column(i)->dtype == GDF_STRING) {
-				NVStrings * strs = static_cast<NVStrings *>(table_out.get_column(i)->data);
-				NVCategory * category = NVCategory::create_from_strings(*strs);
-				std::string column_name(table_out.get_column(i)->col_name);
-				columns_out[i].create_gdf_column(category, table_out.get_column(i)->size, column_name);
-				gdf_column_free(table_out.get_column(i));
-			} else {
-				columns_out[i].create_gdf_column(table_out.get_column(i));
+
+		std::shared_ptr<parquet::FileMetaData> file_metadata =
+			parquet_footer_cache::get_default_instance()->get_footer(user_readable_file_handle, file, file_status);
+
+		// the schema given to a parser is the one of this file, so its row groups are the ones of file 0
+		std::vector<int> row_groups;
+		for(int row_group : get_row_groups_to_decode(schema.get_rowgroup_ids(0), file_metadata->num_row_groups())) {
+			if(file_metadata->RowGroup(row_group)->num_rows() > 0) {
+				row_groups.push_back(row_group);
 			}
 		}
+		if(row_groups.empty()) {
+			columns_out = create_empty_columns(
+				schema.get_names(), schema.get_dtypes(), schema.get_time_units(), column_indices);
+			return;
+		}
+
+		auto mapped_file = std::dynamic_pointer_cast<MappedReadableFile>(file);
+		if(mapped_file) {
+			advise_projected_column_chunks(mapped_file, file_metadata, pq_args.columns, row_groups);
+		}
+
+		// the readers only share the file, whose ReadAt leaves its position alone. One that threw is not reused.
+		auto readers = std::make_shared<parquet_reader_pool>(file, pq_args);
+		std::vector<std::vector<gdf_column_cpp>> columns_per_row_group = decode_row_groups(row_groups,
+			[readers](int row_group) {
+				std::unique_ptr<cudf::io::parquet::reader> parquet_reader = readers->acquire();
+				cudf::table table_out = parquet_reader->read_row_group(row_group);
+				readers->release(std::move(parquet_reader));
+				return to_gdf_columns(table_out);
+			},
+			*get_decode_pool());
+
+		if(columns_per_row_group.size() == 1) {
+			columns_out = columns_per_row_group[0];
+		} else {
+			columns_out = ral::utilities::concatTables(columns_per_row_group);
+		}
 	}
 }
 
@@ -146,26 +260,19 @@ constexpr std::pair<gdf_dtype, gdf_dtype_extra_info> to_dtype(parquet::Type::typ
 	return std::make_pair(GDF_invalid, gdf_dtype_extra_info{TIME_UNIT_NONE});
 }
 
-void parquet_parser::parse_schema(
-	std::vector<std::shared_ptr<arrow::io::RandomAccessFile>> files, ral::io::Schema & schema_out) {
+void parquet_parser::parse_schema(std::vector<std::shared_ptr<arrow::io::RandomAccessFile>> files,
+	const std::vector<std::string> & user_readable_file_handles,
+	ral::io::Schema & schema_out) {
+	std::vector<std::shared_ptr<parquet::FileMetaData>> footers =
+		parquet_footer_cache::get_default_instance()->get_footers(
+			user_readable_file_handles, files, *prefetching_data_provider::get_default_io_pool());
 
 	std::vector<size_t> num_row_groups(files.size());
-	std::thread threads[files.size()];
-	for(int file_index = 0; file_index < files.size(); file_index++) {
-		threads[file_index] = std::thread([&, file_index]() {
-			std::unique_ptr<parquet::ParquetFileReader> parquet_reader =
-				parquet::ParquetFileReader::Open(files[file_index]);
-			std::shared_ptr<parquet::FileMetaData> file_metadata = parquet_reader->metadata();
-			const parquet::SchemaDescriptor * schema = file_metadata->schema();
-			num_row_groups[file_index] = file_metadata->num_row_groups();
-			parquet_reader->Close();
-		});
-	}
-
-	for(int file_index = 0; file_index < files.size(); file_index++) {
-		threads[file_index].join();
+	for(size_t file_index = 0; file_index < files.size(); file_index++) {
+		num_row_groups[file_index] = footers[file_index]->num_row_groups();
 	}
 
+	// the types come from the reader itself so they match what parse returns, one row of one file is enough
 	cudf::io::parquet::reader_options pq_args;
 	pq_args.strings_to_categorical = false;
 	cudf::io::parquet::reader cudf_parquet_reader(files[0], pq_args);
@@ -192,32 +299,20 @@ void parquet_parser::parse_schema(
 }
 
 
-bool parquet_parser::get_metadata(std::vector<std::shared_ptr<arrow::io::RandomAccessFile>> files, ral::io::Metadata & metadata){
-	std::vector<size_t> num_row_groups(files.size());
-	std::thread threads[files.size()];
-	std::vector<std::unique_ptr<parquet::ParquetFileReader>> parquet_readers(files.size());
-	for(int file_index = 0; file_index < files.size(); file_index++) {
-		threads[file_index] = std::thread([&, file_index]() {
-		  parquet_readers[file_index] =
-			  parquet::ParquetFileReader::Open(files[file_index]);
-		  std::shared_ptr<parquet::FileMetaData> file_metadata = parquet_readers[file_index]->metadata();
-		  const parquet::SchemaDescriptor * schema = file_metadata->schema();
-		  num_row_groups[file_index] = file_metadata->num_row_groups();
-		});
-	}
+bool parquet_parser::get_metadata(std::vector<std::shared_ptr<arrow::io::RandomAccessFile>> files,
+	const std::vector<std::string> & user_readable_file_handles,
+	ral::io::Metadata & metadata) {
+	// registering the table already read these footers for its schema, they are served from the cache
+	std::vector<std::shared_ptr<parquet::FileMetaData>> footers =
+		parquet_footer_cache::get_default_instance()->get_footers(
+			user_readable_file_handles, files, *prefetching_data_provider::get_default_io_pool());
 
-	for(int file_index = 0; file_index < files.size(); file_index++) {
-		threads[file_index].join();
+	size_t total_num_row_groups = 0;
+	for(const auto & footer : footers) {
+		total_num_row_groups += footer->num_row_groups();
 	}
 
-	size_t total_num_row_groups =
-		std::accumulate(num_row_groups.begin(), num_row_groups.end(), size_t(0));
-
-	std::vector<gdf_column_cpp> minmax_metadata_table = get_minmax_metadata(parquet_readers, total_num_row_groups, metadata.offset());
-	for (auto &reader : parquet_readers) {
-		reader->Close();
-	}
-	metadata.metadata_ =  minmax_metadata_table;
+	metadata.metadata_ = get_minmax_metadata(footers, total_num_row_groups, metadata.offset());
 	return true;
 }
 
@@ -28,10 +28,20 @@ public:
 		const Schema & schema,
 		std::vector<size_t> column_indices_requested);
 
-	void parse_schema(std::vector<std::shared_ptr<arrow::io::RandomAccessFile>> files, Schema & schema);
+	void parse(std::shared_ptr<arrow::io::RandomAccessFile> file,
+		const std::string & user_readable_file_handle,
+		const FileStatus & file_status,
+		std::vector<gdf_column_cpp> & columns_out,
+		const Schema & schema,
+		std::vector<size_t> column_indices_requested);
 
-	bool get_metadata(std::vector<std::shared_ptr<arrow::io::RandomAccessFile>> files, ral::io::Metadata & metadata);
+	void parse_schema(std::vector<std::shared_ptr<arrow::io::RandomAccessFile>> files,
+		const std::vector<std::string> & user_readable_file_handles,
+		Schema & schema);
 
+	bool get_metadata(std::vector<std::shared_ptr<arrow::io::RandomAccessFile>> files,
+		const std::vector<std::string> & user_readable_file_handles,
+		ral::io::Metadata & metadata);
 };
 
 } /* namespace io */
@@ -0,0 +1,53 @@
+#include "RowGroupDecoder.h"
+#include <algorithm>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace ral {
+namespace io {
+
+namespace {
+std::mutex decode_pool_mutex;
+std::shared_ptr<ThreadPool> decode_pool;
+}  // namespace
+
+std::shared_ptr<ThreadPool> get_decode_pool() {
+	std::lock_guard<std::mutex> lock(decode_pool_mutex);
+	if(decode_pool == nullptr) {
+		decode_pool = std::make_shared<ThreadPool>(std::max(std::thread::hardware_concurrency(), 1u));
+	}
+	return decode_pool;
+}
+
+void set_decode_threads(size_t num_threads) {
+	// parses that already got the previous pool keep it until they finish
+	std::lock_guard<std::mutex> lock(decode_pool_mutex);
+	decode_pool = std::make_shared<ThreadPool>(std::max<size_t>(num_threads, 1));
+}
+
+std::vector<int> get_row_groups_to_decode(const std::vector<int> & row_group_ids, int num_row_groups) {
+	std::vector<int> row_groups;
+	if(row_group_ids.empty()) {
+		for(int row_group = 0; row_group < num_row_groups; row_group++) {
+			row_groups.push_back(row_group);
+		}
+		return row_groups;
+	}
+
+	for(int row_group : row_group_ids) {
+		if(row_group < 0 || row_group >= num_row_groups) {
+			throw std::runtime_error("Row group " + std::to_string(row_group) + " was selected but the file has " +
+									 std::to_string(num_row_groups) + " row groups");
+		}
+	}
+	// skip-data returns the row groups grouped by file but not necessarily sorted, the rows keep their file order
+	row_groups = row_group_ids;
+	std::sort(row_groups.begin(), row_groups.end());
+	row_groups.erase(std::unique(row_groups.begin(), row_groups.end()), row_groups.end());
+	return row_groups;
+}
+
+} /* namespace io */
+} /* namespace ral */
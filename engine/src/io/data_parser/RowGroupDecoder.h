@@ -0,0 +1,72 @@
+/*
+ * RowGroupDecoder.h
+ *
+ * Splits the decoding of a file into its row groups so a few large files can keep a whole pool of decoders busy. The
+ * row groups are decoded in parallel and handed back in file order, ready to be concatenated.
+ */
+
+#ifndef ROWGROUPDECODER_H_
+#define ROWGROUPDECODER_H_
+
+#include "cuDF/Allocator.h"
+#include <blazingdb/io/Util/ThreadPool.h>
+#include <exception>
+#include <future>
+#include <memory>
+#include <vector>
+
+namespace ral {
+namespace io {
+
+/**
+ * pool shared by every parser that splits its files, the row groups of a parquet file or the byte ranges of a csv, so
+ * a few large files still use all of its threads
+ */
+std::shared_ptr<ThreadPool> get_decode_pool();
+void set_decode_threads(size_t num_threads);
+
+/**
+ * the row groups of a file to decode in file order: the ids chosen by skip-data, or every row group of the file when
+ * none were chosen. Repeated ids are read once, ids that are not in the file throw.
+ */
+std::vector<int> get_row_groups_to_decode(const std::vector<int> & row_group_ids, int num_row_groups);
+
+/**
+ * decodes every row group with decode(row_group), which returns the decoded row group. The calls run on decode_pool
+ * when there is more than one row group. The results come back in the order of row_groups no matter which one
+ * finished first, the first error is rethrown once every call finished. The memory allocated by the calls is accounted
+ * to the operator of the calling thread.
+ *
+ * Must not be called from a task of decode_pool, the calls could end up queued behind the caller waiting for them.
+ */
+template <typename decode_function>
+auto decode_row_groups(const std::vector<int> & row_groups, decode_function decode, ThreadPool & decode_pool)
+	-> std::vector<decltype(decode(0))> {
+	std::vector<decltype(decode(0))> decoded_row_groups;
+	if(row_groups.size() == 1) {
+		decoded_row_groups.push_back(decode(row_groups[0]));
+		return decoded_row_groups;
+	}
+
+	// what the row groups allocate is accounted to the operator of the caller
+	const cuDF::Allocator::memory_attribution attribution = cuDF::Allocator::memory_scope::current();
+	std::vector<std::future<decltype(decode(0))>> decoding;
+	for(int row_group : row_groups) {
+		decoding.push_back(decode_pool.submit([decode, row_group, attribution]() {
+			cuDF::Allocator::memory_scope task_scope(attribution);
+			return decode(row_group);
+		}));
+	}
+	for(auto & row_group : decoding) {
+		row_group.wait();
+	}
+	for(auto & row_group : decoding) {
+		decoded_row_groups.push_back(row_group.get());
+	}
+	return decoded_row_groups;
+}
+
+} /* namespace io */
+} /* namespace ral */
+
+#endif /* ROWGROUPDECODER_H_ */
@@ -255,16 +255,16 @@ void set_gdf_column(gdf_column_cpp &p_column, std::basic_string<char> &vector, u
 }
 
 std::vector<gdf_column_cpp> get_minmax_metadata(
-	std::vector<std::unique_ptr<parquet::ParquetFileReader>> &parquet_readers,
+	const std::vector<std::shared_ptr<parquet::FileMetaData>> &footers,
 	size_t total_num_row_groups, int metadata_offset) {
 
-	if (parquet_readers.size() == 0)
+	if (footers.size() == 0)
 		return {};
 
 	std::vector<std::vector<int64_t>> minmax_metadata_table;
 	std::vector<gdf_column_cpp> minmax_metadata_gdf_table;
 
-	std::shared_ptr<parquet::FileMetaData> file_metadata = parquet_readers[0]->metadata();
+	std::shared_ptr<parquet::FileMetaData> file_metadata = footers[0];
 
 	// initialize minmax_metadata_table
 	// T(min, max), (file_handle, row_group)
@@ -275,12 +275,8 @@ std::vector<gdf_column_cpp> get_minmax_metadata(
 	const parquet::SchemaDescriptor *schema = file_metadata->schema();
 
 	if (num_row_groups > 0) {
-		auto row_group_index = 0;
-		auto groupReader = parquet_readers[0]->RowGroup(row_group_index);
-		auto *rowGroupMetadata = groupReader->metadata();
 		for (int colIndex = 0; colIndex < file_metadata->num_columns(); colIndex++) {
 			const parquet::ColumnDescriptor *column = schema->Column(colIndex);
-			auto columnMetaData = rowGroupMetadata->ColumnChunk(colIndex);
 			auto physical_type = column->physical_type();
 			auto logical_type = column->converted_type();
 			gdf_dtype dtype;
@@ -302,46 +298,34 @@ std::vector<gdf_column_cpp> get_minmax_metadata(
 		minmax_metadata_gdf_table[minmax_metadata_gdf_table.size() - 1].create_empty(GDF_INT32, "row_group_index", TIME_UNIT_NONE);
 	}
 
-	size_t file_index = 0;
-	std::vector<std::thread> threads(parquet_readers.size());
-	std::mutex guard;
-	for (size_t file_index = 0; file_index < parquet_readers.size(); file_index++){
-		threads[file_index] = std::thread([&guard, metadata_offset,  &parquet_readers, file_index, &minmax_metadata_table ](){
-		  std::shared_ptr<parquet::FileMetaData> file_metadata = parquet_readers[file_index]->metadata();
+	// the footers are already in memory, going over them in order keeps the rows of each row group together and
+	// sorted by file and row group
+	for (size_t file_index = 0; file_index < footers.size(); file_index++){
+		std::shared_ptr<parquet::FileMetaData> file_metadata = footers[file_index];
 
-		  int num_row_groups = file_metadata->num_row_groups();
-		  const parquet::SchemaDescriptor *schema = file_metadata->schema();
+		int num_row_groups = file_metadata->num_row_groups();
+		const parquet::SchemaDescriptor *schema = file_metadata->schema();
 
-		  for (int row_group_index = 0; row_group_index < num_row_groups; row_group_index++) {
-			  auto groupReader = parquet_readers[file_index]->RowGroup(row_group_index);
-			  auto *rowGroupMetadata = groupReader->metadata();
-			  for (int colIndex = 0; colIndex < file_metadata->num_columns();
-				   colIndex++) {
-				  const parquet::ColumnDescriptor *column = schema->Column(colIndex);
-				  auto columnMetaData = rowGroupMetadata->ColumnChunk(colIndex);
-				  if (columnMetaData->is_stats_set()) {
-					  auto statistics = columnMetaData->statistics();
-					  if (statistics->HasMinMax()) {
-						  guard.lock();
-						  set_min_max(minmax_metadata_table,
-						  	colIndex * 2,
-							  	     column->physical_type(),
-							  	     column->converted_type(),
-									 statistics);
-						  guard.unlock();
-					  }
-				  }
-			  }
-			  guard.lock();
-			  minmax_metadata_table[minmax_metadata_table.size() - 2].push_back(metadata_offset + file_index);
-			  minmax_metadata_table[minmax_metadata_table.size() - 1].push_back(row_group_index);
-			  guard.unlock();
-		  }
-		});
-	}
-
-	for (size_t file_index = 0; file_index < parquet_readers.size(); file_index++){
-		threads[file_index].join();
+		for (int row_group_index = 0; row_group_index < num_row_groups; row_group_index++) {
+			auto rowGroupMetadata = file_metadata->RowGroup(row_group_index);
+			for (int colIndex = 0; colIndex < file_metadata->num_columns();
+				 colIndex++) {
+				const parquet::ColumnDescriptor *column = schema->Column(colIndex);
+				auto columnMetaData = rowGroupMetadata->ColumnChunk(colIndex);
+				if (columnMetaData->is_stats_set()) {
+					auto statistics = columnMetaData->statistics();
+					if (statistics->HasMinMax()) {
+						set_min_max(minmax_metadata_table,
+							colIndex * 2,
+							column->physical_type(),
+							column->converted_type(),
+							statistics);
+					}
+				}
+			}
+			minmax_metadata_table[minmax_metadata_table.size() - 2].push_back(metadata_offset + file_index);
+			minmax_metadata_table[minmax_metadata_table.size() - 1].push_back(row_group_index);
+		}
 	}
 
 	for (size_t index = 0; index < 	minmax_metadata_table.size(); index++) {
@@ -13,7 +13,7 @@
 #include "GDFColumn.cuh"
 
 std::vector<gdf_column_cpp> get_minmax_metadata(
-	std::vector<std::unique_ptr<parquet::ParquetFileReader>> &parquet_readers,
+	const std::vector<std::shared_ptr<parquet::FileMetaData>> &footers,
 	size_t total_num_row_groups, int metadata_offset);
 
 #endif	// BLAZINGDB_RAL_SRC_IO_DATA_PARSER_METADATA_PARQUET_METADATA_H_
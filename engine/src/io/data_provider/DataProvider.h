@@ -14,6 +14,7 @@
 #include <memory>
 #include <vector>
 
+#include <blazingdb/io/FileSystem/FileStatus.h>
 #include <blazingdb/io/FileSystem/Uri.h>
 
 namespace ral {
@@ -26,6 +27,13 @@ struct data_handle {
 
 	std::map<std::string, gdf_scalar> column_values;  // allows us to add hive values
 	Uri uri;										  // in case the data was loaded from a file
+
+	// values of the hive partition directories (key=value) the file was found under, for the partition columns that
+	// were not given in column_values or string_values
+	std::map<std::string, std::string> partition_values;
+
+	// status of the file as the provider found it, FileType::UNDEFINED when it did not look it up
+	FileStatus status;
 };
 
 /**
@@ -0,0 +1,289 @@
+#include "DirectoryExpander.h"
+#include "Config/BlazingContext.h"
+#include <algorithm>
+#include <cctype>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <iostream>
+#include <iterator>
+#include <mutex>
+
+namespace ral {
+namespace io {
+
+namespace {
+
+std::string get_missing_path_message(const Uri & uri) {
+	return "Path '" + uri.toString() +
+		   "' does not exist. File or directory paths are expected to be in one of the following formats: " +
+		   "For local file paths: '/folder0/folder1/fileName.extension'    " +
+		   "For local file paths with wildcard: '/folder0/folder1/*fileName*.*'    " +
+		   "For local directory paths: '/folder0/folder1/'    " +
+		   "For s3 file paths: 's3://registeredFileSystemName/folder0/folder1/fileName.extension'    " +
+		   "For s3 file paths with wildcard: '/folder0/folder1/*fileName*.*'    " +
+		   "For s3 directory paths: 's3://registeredFileSystemName/folder0/folder1/'    " +
+		   "For gs file paths: 'gs://registeredFileSystemName/folder0/folder1/fileName.extension'    " +
+		   "For gs file paths with wildcard: '/folder0/folder1/*fileName*.*'    " +
+		   "For gs directory paths: 'gs://registeredFileSystemName/folder0/folder1/'    " +
+		   "For HDFS file paths: 'hdfs://registeredFileSystemName/folder0/folder1/fileName.extension'    " +
+		   "For HDFS file paths with wildcard: '/folder0/folder1/*fileName*.*'    " +
+		   "For HDFS directory paths: 'hdfs://registeredFileSystemName/folder0/folder1/'";
+}
+
+// hive escapes the characters of partition values that are not valid in a path as %XX
+std::string unescape_partition_value(const std::string & value) {
+	std::string unescaped;
+	for(size_t i = 0; i < value.size(); i++) {
+		if(value[i] == '%' && i + 2 < value.size() && std::isxdigit(static_cast<unsigned char>(value[i + 1])) &&
+			std::isxdigit(static_cast<unsigned char>(value[i + 2]))) {
+			unescaped.push_back(static_cast<char>(std::stoi(value.substr(i + 1, 2), nullptr, 16)));
+			i += 2;
+		} else {
+			unescaped.push_back(value[i]);
+		}
+	}
+	return unescaped;
+}
+
+Uri as_directory(const Uri & uri) {
+	if(uri.getPath().hasTrailingSlash()) {
+		return uri;
+	}
+	return Uri(uri.getScheme(), uri.getAuthority(), Path(uri.getPath().toString() + "/"));
+}
+
+bool accepts(const std::vector<FileFilter> & filters, const FileStatus & status) {
+	return std::all_of(
+		filters.begin(), filters.end(), [&status](const FileFilter & filter) { return filter(status); });
+}
+
+}  // namespace
+
+std::map<std::string, std::string> get_path_partition_values(const Uri & uri, const std::vector<Uri> & roots) {
+	std::map<std::string, std::string> partition_values;
+	const std::string file = uri.toString(true);
+	std::string root_directory;
+	for(const Uri & root : roots) {
+		if(root.toString(true) == file) {
+			continue;
+		}
+		// the files of a wildcard are under the directory of the wildcard
+		const std::string candidate =
+			(root.getPath().hasWildcard()
+					? Uri(root.getScheme(), root.getAuthority(), root.getPath().getParentPath())
+					: as_directory(root))
+				.toString(true);
+		if(candidate.size() > root_directory.size() && file.compare(0, candidate.size(), candidate) == 0) {
+			root_directory = candidate;
+		}
+	}
+	if(root_directory.empty()) {
+		return partition_values;
+	}
+
+	const std::string parent = Uri(uri.getScheme(), uri.getAuthority(), uri.getPath().getParentPath()).toString(true);
+	const std::string directory = parent.size() > root_directory.size() ? parent.substr(root_directory.size()) : "";
+	size_t start = 0;
+	while(start < directory.size()) {
+		size_t end = directory.find('/', start);
+		if(end == std::string::npos) {
+			end = directory.size();
+		}
+		const std::string name = directory.substr(start, end - start);
+		const size_t separator = name.find('=');
+		if(separator != std::string::npos && separator > 0) {
+			partition_values[unescape_partition_value(name.substr(0, separator))] =
+				unescape_partition_value(name.substr(separator + 1));
+		}
+		start = end + 1;
+	}
+	return partition_values;
+}
+
+std::vector<FileFilter> get_default_file_filters() {
+	return {[](const FileStatus & status) {
+		const std::string name = status.getUri().getPath().getResourceName();
+		const std::string checksum = ".crc";
+		const bool is_checksum = name.size() >= checksum.size() &&
+								 name.compare(name.size() - checksum.size(), checksum.size(), checksum) == 0;
+		return !is_checksum && name.find("_copy_") == std::string::npos;
+	}};
+}
+
+std::vector<FileFilter> get_default_directory_filters() {
+	return {[](const FileStatus & status) {
+		const std::string name = status.getUri().getPath().getResourceName();
+		return name.empty() || (name[0] != '_' && name[0] != '.');
+	}};
+}
+
+struct directory_expander::state {
+	// the expander keeps the pool alive, a listing must never hold the last reference or the pool would be destroyed
+	// from one of its own workers
+	std::weak_ptr<ThreadPool> io_pool;
+	directory_expansion_options options;
+
+	std::mutex mutex;
+	std::condition_variable changed;
+	std::deque<pending_directory> directories;  // waiting for a listing slot
+	size_t listings_in_flight = 0;
+	std::vector<expanded_file> files;  // found and not returned yet
+	std::exception_ptr error;
+	bool cancelled = false;
+};
+
+directory_expander::directory_expander(
+	const Uri & uri, std::shared_ptr<ThreadPool> io_pool, directory_expansion_options options)
+	: io_pool(io_pool), shared_state(std::make_shared<state>()) {
+	this->shared_state->io_pool = io_pool;
+	this->shared_state->options = options;
+	this->shared_state->options.max_listings_in_flight = std::max<size_t>(options.max_listings_in_flight, 1);
+
+	std::lock_guard<std::mutex> lock(this->shared_state->mutex);
+	this->shared_state->directories.push_back(pending_directory{uri, {}, true});
+	schedule(this->shared_state);
+}
+
+directory_expander::~directory_expander() {
+	std::lock_guard<std::mutex> lock(this->shared_state->mutex);
+	this->shared_state->cancelled = true;
+	this->shared_state->directories.clear();
+}
+
+void directory_expander::schedule(const std::shared_ptr<state> & shared_state) {
+	// called with the mutex held, so the expander and its reference to the pool can not go away meanwhile
+	std::shared_ptr<ThreadPool> io_pool = shared_state->io_pool.lock();
+	while(io_pool != nullptr && !shared_state->cancelled && shared_state->error == nullptr &&
+		  !shared_state->directories.empty() &&
+		  shared_state->listings_in_flight < shared_state->options.max_listings_in_flight) {
+		pending_directory directory = std::move(shared_state->directories.front());
+		shared_state->directories.pop_front();
+		shared_state->listings_in_flight++;
+		io_pool->submit([shared_state, directory]() { list_directory(shared_state, directory); });
+	}
+}
+
+void directory_expander::list_directory(std::shared_ptr<state> shared_state, pending_directory directory) {
+	std::vector<expanded_file> found_files;
+	std::vector<pending_directory> found_directories;
+	std::exception_ptr error;
+
+	try {
+		auto fs_manager = BlazingContext::getInstance()->getFileSystemManager();
+		Uri target_uri = directory.uri;
+		std::string wildcard;
+		bool list_target = true;
+
+		if(directory.root) {
+			if(directory.uri.getPath().hasWildcard()) {
+				// the files matched are under the partitions between the table root and the directory of the wildcard
+				directory.partition_values =
+					get_path_partition_values(directory.uri, shared_state->options.partition_roots);
+				wildcard = directory.uri.getPath().getResourceName();
+				target_uri = Uri(directory.uri.getScheme(),
+					directory.uri.getAuthority(),
+					directory.uri.getPath().getParentPath());
+			}
+
+			if(!fs_manager || !fs_manager->exists(target_uri)) {
+				std::string message = get_missing_path_message(target_uri);
+				std::cerr << message << std::endl;
+				throw std::runtime_error(message);
+			}
+
+			const FileStatus status = fs_manager->getFileStatus(target_uri);
+			// a file is returned as is, anything else that is not a directory is a file we cannot parse apparently
+			list_target = status.isDirectory();
+			if(status.isFile()) {
+				found_files.push_back(expanded_file{directory.uri,
+					get_path_partition_values(directory.uri, shared_state->options.partition_roots),
+					status});
+			}
+		}
+
+		if(list_target) {
+			const std::string pattern = wildcard.empty() ? "" : (target_uri.getPath() + wildcard).toString(true);
+			const directory_expansion_options & options = shared_state->options;
+			const bool recursive = options.recursive;
+
+			std::vector<FileStatus> entries = fs_manager->list(target_uri, [&](const FileStatus & status) {
+				if(!pattern.empty() && !WildcardFilter::match(status.getUri().getPath().toString(true), pattern)) {
+					return false;
+				}
+				if(status.isDirectory()) {
+					return recursive && accepts(options.directory_filters, status);
+				}
+				return accepts(options.file_filters, status);
+			});
+
+			// listings can come in any order, sorting keeps the order of the files of a directory stable
+			std::sort(entries.begin(), entries.end(), [](const FileStatus & a, const FileStatus & b) {
+				return a.getUri().toString() < b.getUri().toString();
+			});
+
+			for(const FileStatus & entry : entries) {
+				if(entry.isDirectory()) {
+					pending_directory subdirectory{as_directory(entry.getUri()), directory.partition_values, false};
+					const std::string name = entry.getUri().getPath().getResourceName();
+					const size_t separator = name.find('=');
+					if(separator != std::string::npos && separator > 0) {
+						subdirectory.partition_values[unescape_partition_value(name.substr(0, separator))] =
+							unescape_partition_value(name.substr(separator + 1));
+					}
+					found_directories.push_back(std::move(subdirectory));
+				} else {
+					found_files.push_back(expanded_file{entry.getUri(), directory.partition_values, entry});
+				}
+			}
+		}
+	} catch(...) {
+		error = std::current_exception();
+	}
+
+	std::lock_guard<std::mutex> lock(shared_state->mutex);
+	shared_state->listings_in_flight--;
+	if(error != nullptr && shared_state->error == nullptr) {
+		shared_state->error = error;
+	}
+	if(!shared_state->cancelled) {
+		std::move(found_files.begin(), found_files.end(), std::back_inserter(shared_state->files));
+		std::move(
+			found_directories.begin(), found_directories.end(), std::back_inserter(shared_state->directories));
+		schedule(shared_state);
+	}
+	shared_state->changed.notify_all();
+}
+
+bool directory_expander::next(std::vector<expanded_file> & files, bool wait) {
+	std::unique_lock<std::mutex> lock(this->shared_state->mutex);
+	auto finished = [this]() {
+		return this->shared_state->error != nullptr ||
+			   (this->shared_state->listings_in_flight == 0 && this->shared_state->directories.empty());
+	};
+
+	if(wait) {
+		this->shared_state->changed.wait(
+			lock, [&]() { return !this->shared_state->files.empty() || finished(); });
+	}
+
+	if(this->shared_state->error != nullptr) {
+		std::rethrow_exception(this->shared_state->error);
+	}
+
+	std::move(this->shared_state->files.begin(), this->shared_state->files.end(), std::back_inserter(files));
+	this->shared_state->files.clear();
+	return !finished();
+}
+
+std::vector<expanded_file> directory_expander::expand(
+	const Uri & uri, std::shared_ptr<ThreadPool> io_pool, directory_expansion_options options) {
+	directory_expander expander(uri, io_pool, options);
+	std::vector<expanded_file> files;
+	while(expander.next(files, true)) {
+	}
+	return files;
+}
+
+} /* namespace io */
+} /* namespace ral */
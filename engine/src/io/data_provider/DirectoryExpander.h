@@ -0,0 +1,136 @@
+/*
+ * DirectoryExpander.h
+ *
+ * Breadth first expansion of a uri into the files under it. The directories found are listed in parallel on an I/O
+ * pool and the files of a directory are handed out as soon as it is listed, so the first files can be opened and
+ * parsed while the rest of the tree is still being listed. Files under hive style partition directories
+ * (year=2019/month=01/) come with the values of those directories.
+ */
+
+#ifndef DIRECTORYEXPANDER_H_
+#define DIRECTORYEXPANDER_H_
+
+#include <blazingdb/io/FileSystem/FileFilter.h>
+#include <blazingdb/io/FileSystem/FileStatus.h>
+#include <blazingdb/io/FileSystem/Uri.h>
+#include <blazingdb/io/Util/ThreadPool.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ral {
+namespace io {
+
+struct expanded_file {
+	Uri uri;
+	/**
+	 * values of the key=value directories between the expanded uri and the file, keyed by partition column
+	 */
+	std::map<std::string, std::string> partition_values;
+	/**
+	 * as the listing or the status call that found the file returned it, its size and modification time identify it
+	 */
+	FileStatus status;
+};
+
+/**
+ * values of the key=value directories between the deepest of roots (the uris a table was registered from) that the
+ * file is under and the file, none when it is under none of them. The directories above the root are not partitions
+ * of the table. A file given on its own, like the files of a table registered from a directory and queried through
+ * its file list, gets the values of its partitions this way.
+ */
+std::map<std::string, std::string> get_path_partition_values(const Uri & uri, const std::vector<Uri> & roots);
+
+/**
+ * skips the .crc checksum files and the _copy_ files hive leaves behind
+ */
+std::vector<FileFilter> get_default_file_filters();
+
+/**
+ * skips the directories whose name starts with _ or . (i.e. _temporary or .hive-staging)
+ */
+std::vector<FileFilter> get_default_directory_filters();
+
+struct directory_expansion_options {
+	/**
+	 * a file found in a directory is returned when every filter accepts it
+	 */
+	std::vector<FileFilter> file_filters = get_default_file_filters();
+	/**
+	 * a subdirectory is expanded when every filter accepts it
+	 */
+	std::vector<FileFilter> directory_filters = get_default_directory_filters();
+	/**
+	 * when false only the files directly under the uri are returned
+	 */
+	bool recursive = true;
+	/**
+	 * bound of the listings of one expansion queued on the I/O pool, so opens queued on the same pool are not stuck
+	 * behind the listing of a whole tree
+	 */
+	size_t max_listings_in_flight = 8;
+	/**
+	 * the uris the table was registered from, the files and wildcards expanded on their own take the values of the
+	 * partitions between them and these
+	 */
+	std::vector<Uri> partition_roots;
+};
+
+class directory_expander {
+public:
+	/**
+	 * starts the expansion of uri, which can be a file, a directory or a path with a wildcard in its last component
+	 */
+	directory_expander(const Uri & uri,
+		std::shared_ptr<ThreadPool> io_pool,
+		directory_expansion_options options = directory_expansion_options());
+	/**
+	 * directories that were not listed yet are dropped, listings in flight finish on their own
+	 */
+	~directory_expander();
+
+	directory_expander(const directory_expander &) = delete;
+	directory_expander & operator=(const directory_expander &) = delete;
+
+	/**
+	 * appends the files found since the last call to files. When wait is set it blocks until a file is found or the
+	 * expansion finishes. Returns false once there is nothing else to find. Errors of the expansion, like a path that
+	 * does not exist, are rethrown here.
+	 */
+	bool next(std::vector<expanded_file> & files, bool wait);
+
+	/**
+	 * expands uri and waits for all of its files
+	 */
+	static std::vector<expanded_file> expand(const Uri & uri,
+		std::shared_ptr<ThreadPool> io_pool,
+		directory_expansion_options options = directory_expansion_options());
+
+private:
+	struct pending_directory {
+		Uri uri;
+		std::map<std::string, std::string> partition_values;
+		bool root;  // the uri the expansion started from, it can be a file or have a wildcard
+	};
+
+	/**
+	 * shared with the listings in flight, which can outlive the expander
+	 */
+	struct state;
+
+	static void list_directory(std::shared_ptr<state> shared_state, pending_directory directory);
+
+	/**
+	 * queues listings of pending directories while there are free slots, must be called with the mutex held
+	 */
+	static void schedule(const std::shared_ptr<state> & shared_state);
+
+	std::shared_ptr<ThreadPool> io_pool;
+	std::shared_ptr<state> shared_state;
+};
+
+} /* namespace io */
+} /* namespace ral */
+
+#endif /* DIRECTORYEXPANDER_H_ */
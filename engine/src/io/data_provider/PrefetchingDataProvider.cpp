@@ -0,0 +1,192 @@
+#include "PrefetchingDataProvider.h"
+#include "Config/BlazingContext.h"
+#include <algorithm>
+#include <mutex>
+
+namespace ral {
+namespace io {
+
+namespace {
+
+const size_t DEFAULT_IO_THREADS = 16;
+const size_t DEFAULT_FILES_IN_FLIGHT = 64;
+
+std::mutex defaults_mutex;
+std::shared_ptr<ThreadPool> default_io_pool;
+size_t default_files_in_flight = DEFAULT_FILES_IN_FLIGHT;
+
+}  // namespace
+
+prefetching_data_provider::prefetching_data_provider(std::vector<Uri> uris,
+	std::vector<std::map<std::string, gdf_scalar>> uri_scalars,
+	std::vector<std::map<std::string, std::string>> string_scalars,
+	std::vector<std::map<std::string, bool>> is_column_string,
+	size_t max_files_in_flight,
+	std::shared_ptr<ThreadPool> io_pool,
+	directory_expansion_options expansion_options)
+	: data_provider(), file_uris(uris), uri_scalars(uri_scalars), string_scalars(string_scalars),
+	  is_column_string(is_column_string), max_files_in_flight(std::max<size_t>(max_files_in_flight, 1)),
+	  io_pool(io_pool), expansion_options(expansion_options), next_uri(0), next_expanded_uri(0) {
+	this->fill(false);
+}
+
+prefetching_data_provider::prefetching_data_provider(std::vector<Uri> uris)
+	: prefetching_data_provider(uris, {}, {}, {}) {}
+
+prefetching_data_provider::~prefetching_data_provider() {
+	// the opens still in flight only hold copies of their uris and the listings hold their own state, so they can
+	// finish after the provider is gone
+	for(size_t file_index = 0; file_index < this->opened_files.size(); file_index++) {
+		if(this->opened_files[file_index] != nullptr) {
+			this->opened_files[file_index]->Close();
+		}
+	}
+}
+
+std::shared_ptr<ThreadPool> prefetching_data_provider::get_default_io_pool() {
+	std::lock_guard<std::mutex> lock(defaults_mutex);
+	if(default_io_pool == nullptr) {
+		default_io_pool = std::make_shared<ThreadPool>(DEFAULT_IO_THREADS);
+	}
+	return default_io_pool;
+}
+
+void prefetching_data_provider::set_default_io_threads(size_t num_threads) {
+	// providers that already got the previous pool keep it until they go out of scope
+	std::lock_guard<std::mutex> lock(defaults_mutex);
+	default_io_pool = std::make_shared<ThreadPool>(std::max<size_t>(num_threads, 1));
+}
+
+size_t prefetching_data_provider::get_default_files_in_flight() {
+	std::lock_guard<std::mutex> lock(defaults_mutex);
+	return default_files_in_flight;
+}
+
+void prefetching_data_provider::set_default_files_in_flight(size_t max_files_in_flight) {
+	std::lock_guard<std::mutex> lock(defaults_mutex);
+	default_files_in_flight = std::max<size_t>(max_files_in_flight, 1);
+}
+
+void prefetching_data_provider::fill(bool wait) {
+	while(true) {
+		// files are taken from the expansions in the order of the uris, the later expansions keep listing meanwhile
+		while(!this->expansions.empty()) {
+			const bool block = wait && this->opening_files.empty() && this->unopened_files.empty();
+			const size_t uri_index = this->next_expanded_uri;
+			std::vector<expanded_file> found_files;
+			bool more_files;
+			try {
+				more_files = this->expansions.front()->next(found_files, block);
+			} catch(...) {
+				if(!wait || !this->opening_files.empty() || !this->unopened_files.empty()) {
+					// the files of the previous uris are returned first, the expansion throws again when it is reached
+					break;
+				}
+				this->expansions.pop_front();
+				this->next_expanded_uri++;
+				throw;
+			}
+
+			for(expanded_file & found_file : found_files) {
+				this->unopened_files.push_back(pending_file{std::move(found_file), uri_index, {}});
+			}
+			if(more_files) {
+				break;
+			}
+			this->expansions.pop_front();
+			this->next_expanded_uri++;
+		}
+
+		while(!this->unopened_files.empty() &&
+			  this->opening_files.size() + this->expansions.size() < this->max_files_in_flight) {
+			pending_file file = std::move(this->unopened_files.front());
+			this->unopened_files.pop_front();
+
+			const Uri uri = file.file.uri;
+			file.handle = this->io_pool->submit(
+				[uri]() { return BlazingContext::getInstance()->getFileSystemManager()->openReadable(uri); });
+			this->opening_files.push_back(std::move(file));
+		}
+
+		// the next uris are only expanded once the files already found are being opened
+		while(this->unopened_files.empty() && this->next_uri < this->file_uris.size() &&
+			  this->opening_files.size() + this->expansions.size() < this->max_files_in_flight) {
+			this->expansions.push_back(std::make_shared<directory_expander>(
+				this->file_uris[this->next_uri], this->io_pool, this->expansion_options));
+			this->next_uri++;
+		}
+
+		if(!wait || !this->opening_files.empty() || this->expansions.empty()) {
+			return;
+		}
+	}
+}
+
+bool prefetching_data_provider::has_next() {
+	this->fill(true);
+	return !this->opening_files.empty();
+}
+
+void prefetching_data_provider::reset() {
+	this->expansions.clear();
+	this->unopened_files.clear();
+	this->opening_files.clear();
+	this->next_uri = 0;
+	this->next_expanded_uri = 0;
+}
+
+data_handle prefetching_data_provider::get_next() {
+	this->fill(true);
+	if(this->opening_files.empty()) {
+		return data_handle();
+	}
+
+	pending_file next = std::move(this->opening_files.front());
+	this->opening_files.pop_front();
+	// the slot of this file goes to the next one before waiting for its open
+	this->fill(false);
+
+	std::shared_ptr<arrow::io::RandomAccessFile> file = next.handle.get();
+	this->opened_files.push_back(file);
+
+	data_handle handle;
+	handle.uri = next.file.uri;
+	handle.fileHandle = file;
+	handle.partition_values = next.file.partition_values;
+	handle.status = next.file.status;
+	if(this->uri_scalars.size() != 0) {
+		handle.column_values = this->uri_scalars[next.uri_index];
+		handle.string_values = this->string_scalars[next.uri_index];
+		handle.is_column_string = this->is_column_string[next.uri_index];
+	}
+	return handle;
+}
+
+data_handle prefetching_data_provider::get_first() {
+	this->reset();
+	data_handle handle = this->get_next();
+	this->reset();
+	return handle;
+}
+
+std::vector<data_handle> prefetching_data_provider::get_all() {
+	std::vector<data_handle> file_handles;
+	while(this->has_next()) {
+		file_handles.push_back(this->get_next());
+	}
+
+	return file_handles;
+}
+
+std::string prefetching_data_provider::get_current_user_readable_file_handle() {
+	this->fill(true);
+	if(this->opening_files.empty()) {
+		return "";
+	}
+	return this->opening_files.front().file.uri.toString();
+}
+
+std::vector<std::string> prefetching_data_provider::get_errors() { return this->errors; }
+
+} /* namespace io */
+} /* namespace ral */
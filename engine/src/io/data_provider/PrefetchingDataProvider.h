@@ -0,0 +1,129 @@
+/*
+ * PrefetchingDataProvider.h
+ *
+ * Provider for the same uris as uri_data_provider that expands and opens them on a bounded pool of I/O threads. It
+ * keeps a number of files in flight ahead of the one get_next returns, so the status, list and open calls of the next
+ * files overlap with the parsing of the files already returned. The files of a uri are returned as its directories
+ * are listed, so their order within the uri can change from one expansion to the next.
+ */
+
+#ifndef PREFETCHINGDATAPROVIDER_H_
+#define PREFETCHINGDATAPROVIDER_H_
+
+#include "DataProvider.h"
+#include "DirectoryExpander.h"
+#include <arrow/io/interfaces.h>
+#include <blazingdb/io/FileSystem/Uri.h>
+#include <blazingdb/io/Util/ThreadPool.h>
+#include <deque>
+#include <future>
+#include <memory>
+#include <vector>
+
+namespace ral {
+namespace io {
+
+class prefetching_data_provider : public data_provider {
+public:
+	prefetching_data_provider(std::vector<Uri> uris,
+		std::vector<std::map<std::string, gdf_scalar>> uri_scalars,
+		std::vector<std::map<std::string, std::string>> string_scalars,
+		std::vector<std::map<std::string, bool>> is_column_string,
+		size_t max_files_in_flight = get_default_files_in_flight(),
+		std::shared_ptr<ThreadPool> io_pool = get_default_io_pool(),
+		directory_expansion_options expansion_options = directory_expansion_options());
+	prefetching_data_provider(std::vector<Uri> uris);
+	virtual ~prefetching_data_provider();
+	/**
+	 * tells us if there are more files to be provided, waits for the expansion of the next uris when needed
+	 */
+	bool has_next();
+	/**
+	 *  Starts over from the first uri, the files that were still being opened are dropped and the expansions and opens
+	 *  are queued again the next time a file is asked for
+	 */
+	void reset();
+	/**
+	 * gets the next file, waiting for its open if it is still in flight, and queues the open of another one
+	 */
+	data_handle get_next();
+	/**
+	 * gets the first file
+	 */
+	data_handle get_first();
+	/**
+	 * returns any errors that were encountered when opening arrow::io::RandomAccessFile
+	 */
+	std::vector<std::string> get_errors();
+	/**
+	 * returns a string that the user should be able to use to identify the file get_next returns next
+	 */
+	std::string get_current_user_readable_file_handle();
+	/**
+	 * returns all of the file handles, opening them in parallel
+	 */
+	std::vector<data_handle> get_all();
+
+	/**
+	 * pool shared by the providers that are not given one, so the calls in flight stay bounded across queries
+	 */
+	static std::shared_ptr<ThreadPool> get_default_io_pool();
+	static void set_default_io_threads(size_t num_threads);
+
+	static size_t get_default_files_in_flight();
+	static void set_default_files_in_flight(size_t max_files_in_flight);
+
+private:
+	struct pending_file {
+		expanded_file file;
+		size_t uri_index;  // index of the uri the file was expanded from, selects its hive values
+		std::future<std::shared_ptr<arrow::io::RandomAccessFile>> handle;  // valid once its open is queued
+	};
+
+	/**
+	 * takes the files the expansions found so far and queues expansions and opens up to max_files_in_flight. When
+	 * wait is set it blocks until there is a file being opened to return or nothing is left.
+	 */
+	void fill(bool wait);
+
+	std::vector<Uri> file_uris;
+	std::vector<std::map<std::string, gdf_scalar>> uri_scalars;
+	std::vector<std::map<std::string, std::string>> string_scalars;
+	std::vector<std::map<std::string, bool>> is_column_string;
+
+	size_t max_files_in_flight;
+	std::shared_ptr<ThreadPool> io_pool;
+	directory_expansion_options expansion_options;
+
+	/**
+	 * index of the next uri to queue the expansion of
+	 */
+	size_t next_uri;
+	/**
+	 * index of the uri expansions.front() belongs to
+	 */
+	size_t next_expanded_uri;
+	/**
+	 * an expansion in flight counts as one file in flight no matter how many directories it is listing
+	 */
+	std::deque<std::shared_ptr<directory_expander>> expansions;
+	/**
+	 * files that were found but whose open is not queued yet
+	 */
+	std::deque<pending_file> unopened_files;
+	/**
+	 * files whose open is queued, in the order get_next returns them
+	 */
+	std::deque<pending_file> opening_files;
+
+	/**
+	 * stores the files that were returned by the provider to be closed when it goes out of scope
+	 */
+	std::vector<std::shared_ptr<arrow::io::RandomAccessFile>> opened_files;
+	std::vector<std::string> errors;
+};
+
+} /* namespace io */
+} /* namespace ral */
+
+#endif /* PREFETCHINGDATAPROVIDER_H_ */
@@ -10,8 +10,8 @@
 #include "UriDataProvider.h"
 #include "Config/BlazingContext.h"
 #include "ExceptionHandling/BlazingException.h"
+#include "PrefetchingDataProvider.h"
 #include "arrow/status.h"
-#include <blazingdb/io/Util/StringUtil.h>
 #include <iostream>
 
 namespace ral {
@@ -19,15 +19,16 @@ namespace io {
 
 uri_data_provider::uri_data_provider(std::vector<Uri> uris)
 	: data_provider(), file_uris(uris), uri_scalars({}), string_scalars({}), is_column_string({}), opened_files({}),
-	  current_file(0), errors({}), directory_uris({}), directory_current_file(0) {}
+	  current_file(0), errors({}), directory_files({}), directory_current_file(0) {}
 
 uri_data_provider::uri_data_provider(std::vector<Uri> uris,
 	std::vector<std::map<std::string, gdf_scalar>> uri_scalars,
 	std::vector<std::map<std::string, std::string>> string_scalars,
-	std::vector<std::map<std::string, bool>> is_column_string)
+	std::vector<std::map<std::string, bool>> is_column_string,
+	directory_expansion_options options)
 	: data_provider(), file_uris(uris), uri_scalars(uri_scalars), string_scalars(string_scalars),
-	  is_column_string(is_column_string), opened_files({}), current_file(0), errors({}), directory_uris({}),
-	  directory_current_file(0) {
+	  is_column_string(is_column_string), opened_files({}), current_file(0), errors({}), directory_files({}),
+	  directory_current_file(0), options(options) {
 	// thanks to c++11 we no longer have anything interesting to do here :)
 }
 
@@ -42,10 +43,10 @@ uri_data_provider::~uri_data_provider() {
 }
 
 std::string uri_data_provider::get_current_user_readable_file_handle() {
-	if(directory_uris.size() == 0) {
+	if(directory_files.size() == 0) {
 		return this->file_uris[this->current_file].toString();
 	} else {
-		return this->directory_uris[this->directory_current_file].toString();
+		return this->directory_files[this->directory_current_file].uri.toString();
 	}
 }
 
@@ -53,6 +54,7 @@ bool uri_data_provider::has_next() { return this->current_file < this->file_uris
 
 void uri_data_provider::reset() {
 	this->current_file = 0;
+	this->directory_files = {};
 	this->directory_current_file = 0;
 }
 
@@ -70,127 +72,53 @@ data_handle uri_data_provider::get_next() {
 	// the uri is in a valid state otherwise throw an exception
 	// because openReadable doens't  validate it and just return a nullptr
 
-	if(this->directory_uris.size() > 0 && this->directory_current_file < this->directory_uris.size()) {
-		auto fileStatus = BlazingContext::getInstance()->getFileSystemManager()->getFileStatus(
-			this->directory_uris[this->directory_current_file]);
+	if(this->directory_files.size() == 0) {
+		// files are returned from directory_files, a file uri expands to itself
+		this->directory_files = directory_expander::expand(
+			this->file_uris[this->current_file], prefetching_data_provider::get_default_io_pool(), this->options);
+		this->directory_current_file = 0;
 
-		std::shared_ptr<arrow::io::RandomAccessFile> file =
-			BlazingContext::getInstance()->getFileSystemManager()->openReadable(
-				this->directory_uris[this->directory_current_file]);
-
-		data_handle handle;
-		handle.uri = this->directory_uris[this->directory_current_file];
-		if(this->uri_scalars.size() != 0) {
-			handle.column_values = this->uri_scalars[this->current_file];
-			handle.string_values = this->string_scalars[this->current_file];
-			handle.is_column_string = this->is_column_string[this->current_file];
-		}
-
-		this->opened_files.push_back(file);
-
-		this->directory_current_file++;
-		if(this->directory_current_file >= directory_uris.size()) {
-			this->directory_uris = {};
+		if(this->directory_files.size() == 0) {
+			// nothing we can parse in this uri
 			this->current_file++;
-		}
-
-		handle.fileHandle = file;
-		return handle;
-	} else {
-		FileStatus fileStatus;
-		auto current_uri = this->file_uris[this->current_file];
-		const bool hasWildcard = current_uri.getPath().hasWildcard();
-		Uri target_uri = current_uri;
-
-		try {
-			auto fs_manager = BlazingContext::getInstance()->getFileSystemManager();
-
-			if(hasWildcard) {
-				const Path final_path = current_uri.getPath().getParentPath();
-				target_uri = Uri(current_uri.getScheme(), current_uri.getAuthority(), final_path);
+			if(this->has_next()) {
+				return get_next();
 			}
-
-			if(fs_manager && fs_manager->exists(target_uri)) {
-				fileStatus = BlazingContext::getInstance()->getFileSystemManager()->getFileStatus(target_uri);
-			} else {
-				throw std::runtime_error(
-					"Path '" + target_uri.toString() +
-					"' does not exist. File or directory paths are expected to be in one of the following formats: " +
-					"For local file paths: '/folder0/folder1/fileName.extension'    " +
-					"For local file paths with wildcard: '/folder0/folder1/*fileName*.*'    " +
-					"For local directory paths: '/folder0/folder1/'    " +
-					"For s3 file paths: 's3://registeredFileSystemName/folder0/folder1/fileName.extension'    " +
-					"For s3 file paths with wildcard: '/folder0/folder1/*fileName*.*'    " +
-					"For s3 directory paths: 's3://registeredFileSystemName/folder0/folder1/'    " +
-					"For gs file paths: 'gs://registeredFileSystemName/folder0/folder1/fileName.extension'    " +
-					"For gs file paths with wildcard: '/folder0/folder1/*fileName*.*'    " +
-					"For gs directory paths: 'gs://registeredFileSystemName/folder0/folder1/'    " +
-					"For HDFS file paths: 'hdfs://registeredFileSystemName/folder0/folder1/fileName.extension'    " +
-					"For HDFS file paths with wildcard: '/folder0/folder1/*fileName*.*'    " +
-					"For HDFS directory paths: 'hdfs://registeredFileSystemName/folder0/folder1/'");
-			}
-		} catch(const std::exception & e) {
-			std::cerr << e.what() << std::endl;
-			throw;
-		} catch(...) {
-			throw;
+			return data_handle();
 		}
+	}
 
-		if(fileStatus.isDirectory()) {
-			if(hasWildcard) {
-				const std::string wildcard = current_uri.getPath().getResourceName();
-
-				this->directory_uris =
-					BlazingContext::getInstance()->getFileSystemManager()->list(target_uri, wildcard);
-
-			} else {
-				this->directory_uris = BlazingContext::getInstance()->getFileSystemManager()->list(target_uri);
-			}
+	const expanded_file & directory_file = this->directory_files[this->directory_current_file];
+	std::shared_ptr<arrow::io::RandomAccessFile> file =
+		BlazingContext::getInstance()->getFileSystemManager()->openReadable(directory_file.uri);
+
+	data_handle handle;
+	handle.uri = directory_file.uri;
+	handle.partition_values = directory_file.partition_values;
+	handle.status = directory_file.status;
+	if(this->uri_scalars.size() != 0) {
+		handle.column_values = this->uri_scalars[this->current_file];
+		handle.string_values = this->string_scalars[this->current_file];
+		handle.is_column_string = this->is_column_string[this->current_file];
+	}
 
-			std::string ender = ".crc";
-			std::string hive_copies = "_copy_";
-			std::vector<Uri> new_uris;
-			for(int i = 0; i < this->directory_uris.size(); i++) {
-				std::string fileName = this->directory_uris[i].getPath().toString();
+	this->opened_files.push_back(file);
 
-				if(!StringUtil::endsWith(fileName, ender) && !StringUtil::contains(fileName, hive_copies)) {
-					//  std::cout<<" orig is "<<fileName<<std::endl;
-					new_uris.push_back(this->directory_uris[i]);
-				}
-			}
-			this->directory_uris = new_uris;
-
-			this->directory_current_file = 0;
-			return get_next();
-
-		} else if(fileStatus.isFile()) {
-			std::shared_ptr<arrow::io::RandomAccessFile> file =
-				BlazingContext::getInstance()->getFileSystemManager()->openReadable(current_uri);
-
-			this->opened_files.push_back(file);
-			data_handle handle;
-			handle.uri = current_uri;
-			handle.fileHandle = file;
-			if(this->uri_scalars.size() != 0) {
-				handle.column_values = this->uri_scalars[this->current_file];
-				handle.string_values = this->string_scalars[this->current_file];
-				handle.is_column_string = this->is_column_string[this->current_file];
-			}
-
-			this->current_file++;
-			return handle;
-		} else {
-			// this is a file we cannot parse apparently
-			return get_next();
-		}
+	this->directory_current_file++;
+	if(this->directory_current_file >= directory_files.size()) {
+		this->directory_files = {};
+		this->current_file++;
 	}
+
+	handle.fileHandle = file;
+	return handle;
 }
 
 data_handle uri_data_provider::get_first() {
 	this->reset();
 	data_handle handle = this->get_next();
 	this->reset();
-	this->directory_uris = {};
+	this->directory_files = {};
 	return handle;
 }
 
@@ -9,6 +9,7 @@
 #define URIDATAPROVIDER_H_
 
 #include "DataProvider.h"
+#include "DirectoryExpander.h"
 #include <arrow/io/interfaces.h>
 #include <blazingdb/io/FileSystem/Uri.h>
 #include <vector>
@@ -28,7 +29,8 @@ public:
 	uri_data_provider(std::vector<Uri> uris,
 		std::vector<std::map<std::string, gdf_scalar>> uri_scalars,
 		std::vector<std::map<std::string, std::string>> string_scalars,
-		std::vector<std::map<std::string, bool>> is_column_string);
+		std::vector<std::map<std::string, bool>> is_column_string,
+		directory_expansion_options options = directory_expansion_options());
 	uri_data_provider(std::vector<Uri> uris);
 	virtual ~uri_data_provider();
 	/**
@@ -95,8 +97,12 @@ private:
 	std::vector<std::map<std::string, gdf_scalar>> uri_scalars;
 	std::vector<std::map<std::string, std::string>> string_scalars;
 	std::vector<std::map<std::string, bool>> is_column_string;
-	std::vector<Uri> directory_uris;
+	/**
+	 * files found under file_uris[current_file], directories are expanded in parallel and with their subdirectories
+	 */
+	std::vector<expanded_file> directory_files;
 	size_t directory_current_file;
+	directory_expansion_options options;
 };
 
 } /* namespace io */
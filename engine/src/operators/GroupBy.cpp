@@ -7,6 +7,7 @@
 #include "Traits/RuntimeTraits.h"
 #include "communication/CommunicationData.h"
 #include "config/GPUManager.cuh"
+#include "cuDF/Allocator.h"
 #include "distribution/primitives.h"
 #include "utilities/CommonOperations.h"
 #include "utilities/RalColumn.h"
@@ -140,8 +141,7 @@ void single_node_groupby_without_aggregations(blazing_frame & input, std::vector
 void distributed_groupby_without_aggregations(
 	Context & queryContext, blazing_frame & input, std::vector<int> & group_column_indices) {
 	using ral::communication::CommunicationData;
-	static CodeTimer timer;
-	timer.reset();
+	CodeTimer timer;
 
 	std::vector<gdf_column_cpp> group_columns(group_column_indices.size());
 	for(size_t i = 0; i < group_column_indices.size(); i++) {
@@ -159,14 +159,19 @@ void distributed_groupby_without_aggregations(
 		timer.logDuration(queryContext, "distributed_groupby_without_aggregations part 0 generateSample"));
 	timer.reset();
 
+	// the task allocates for the operator this thread runs, so it is charged to the same query and operator
+	const cuDF::Allocator::memory_attribution attribution = cuDF::Allocator::memory_scope::current();
 	auto groupByTask = std::async(
 		std::launch::async,
-		[](Context & queryContext, std::vector<gdf_column_cpp> & input, const std::vector<int> & group_column_indices) {
-			static CodeTimer timer2;
+		[attribution](Context & queryContext,
+			std::vector<gdf_column_cpp> & input,
+			const std::vector<int> & group_column_indices) {
+			cuDF::Allocator::memory_scope task_scope(attribution);
+			CodeTimer timer2;
 			std::vector<gdf_column_cpp> result = groupby_without_aggregations(input, group_column_indices);
-			Library::Logging::Logger().logInfo(timer.logDuration(
+			Library::Logging::Logger().logInfo(timer2.logDuration(
 				queryContext, "distributed_groupby_without_aggregations part 1 async groupby_without_aggregations"));
-			timer.reset();
+			timer2.reset();
 			return result;
 		},
 		std::ref(queryContext),
@@ -517,8 +522,7 @@ void distributed_aggregations_with_groupby(Context & queryContext,
 	std::vector<std::string> & aggregation_input_expressions,
 	std::vector<std::string> & aggregation_column_assigned_aliases) {
 	using ral::communication::CommunicationData;
-	static CodeTimer timer;
-	timer.reset();
+	CodeTimer timer;
 
 	if(std::find(aggregation_types.begin(), aggregation_types.end(), GDF_AVG) != aggregation_types.end()) {
 		throw std::runtime_error{
@@ -537,23 +541,25 @@ void distributed_aggregations_with_groupby(Context & queryContext,
 		timer.logDuration(queryContext, "distributed_aggregations_with_groupby part 0 generateSample"));
 	timer.reset();
 
+	const cuDF::Allocator::memory_attribution attribution = cuDF::Allocator::memory_scope::current();
 	auto aggregationTask = std::async(
 		std::launch::async,
-		[](Context & queryContext,
+		[attribution](Context & queryContext,
 			blazing_frame & input,
 			std::vector<int> & group_column_indices,
 			std::vector<gdf_agg_op> & aggregation_types,
 			std::vector<std::string> & aggregation_input_expressions,
 			std::vector<std::string> & aggregation_column_assigned_aliases) {
-			static CodeTimer timer2;
+			cuDF::Allocator::memory_scope task_scope(attribution);
+			CodeTimer timer2;
 			std::vector<gdf_column_cpp> result = compute_aggregations(input,
 				group_column_indices,
 				aggregation_types,
 				aggregation_input_expressions,
 				aggregation_column_assigned_aliases);
 			Library::Logging::Logger().logInfo(
-				timer.logDuration(queryContext, "distributed_aggregations_with_groupby async compute_aggregations"));
-			timer.reset();
+				timer2.logDuration(queryContext, "distributed_aggregations_with_groupby async compute_aggregations"));
+			timer2.reset();
 			return result;
 		},
 		std::ref(queryContext),
@@ -633,8 +639,7 @@ void distributed_aggregations_without_groupby(Context & queryContext,
 	std::vector<std::string> & aggregation_input_expressions,
 	std::vector<std::string> & aggregation_column_assigned_aliases) {
 	using ral::communication::CommunicationData;
-	static CodeTimer timer;
-	timer.reset();
+	CodeTimer timer;
 
 	std::vector<gdf_column_cpp> aggregatedTable = compute_aggregations(input,
 		group_column_indices,
@@ -9,6 +9,8 @@
 #include "distribution/NodeColumns.h"
 #include "distribution/primitives.h"
 #include "exception/RalException.h"
+#include "profile/QueryProfile.h"
+#include "spill/SpillableTable.h"
 #include "utilities/CommonOperations.h"
 #include "utilities/RalColumn.h"
 #include "utilities/StringUtils.h"
@@ -41,6 +43,11 @@ protected:
 
 	void materialize_column(blazing_frame & input, bool is_inner_join);
 
+	// Device limit to join the input a partition at a time under, 0 when the join fits in the budget of the query
+	std::size_t get_external_join_limit(blazing_frame & input);
+
+	blazing_frame external_join(blazing_frame & input, const std::string & query, std::size_t device_limit);
+
 protected:
 	Context * context_;
 	CodeTimer timer_;
@@ -162,9 +169,107 @@ void JoinOperator::materialize_column(blazing_frame & input, bool is_inner_join)
 }
 
 
+std::size_t JoinOperator::get_external_join_limit(blazing_frame & input) {
+	if(context_ == nullptr || input.get_num_rows_in_table(0) == 0 || input.get_num_rows_in_table(1) == 0) {
+		return 0;
+	}
+
+	// roughly the hash table built on one side and the materialized output, at least as big as the inputs
+	std::size_t working_set = 2 * (ral::spill::spillable_table::get_device_size(input.get_table(0)) +
+									  ral::spill::spillable_table::get_device_size(input.get_table(1)));
+	return ral::spill::get_out_of_core_device_limit(*context_->getMemoryTracker(), working_set);
+}
+
+// Joins two tables that do not fit in the budget of the query. Both are cut into chunks, each chunk is hash partitioned
+// on the join keys and the partitions are put aside in a spill manager. Rows with equal keys land in the same
+// partition, so joining each pair of partitions by itself and concatenating the results gives the whole join, outer
+// joins included.
+blazing_frame JoinOperator::external_join(blazing_frame & input, const std::string & query, std::size_t device_limit) {
+	std::vector<int> globalColumnIndices;
+	parseJoinConditionToColumnIndices(get_named_expression(query, "condition"), globalColumnIndices);
+
+	std::vector<std::vector<gdf_column_cpp>> tables = input.get_columns();
+	input.clear();
+
+	// a pair of partitions and its output have to fit in the device limit
+	std::size_t input_size = ral::spill::spillable_table::get_device_size(tables[0]) +
+							 ral::spill::spillable_table::get_device_size(tables[1]);
+	gdf_size_type num_partitions = ral::spill::get_out_of_core_partitions(input_size, device_limit, "external_join");
+
+	ral::spill::spill_manager manager(device_limit);
+	std::vector<std::vector<std::vector<std::shared_ptr<ral::spill::spillable_table>>>> partitions(
+		tables.size(), std::vector<std::vector<std::shared_ptr<ral::spill::spillable_table>>>(num_partitions));
+	int processedColumns = 0;
+	for(size_t t = 0; t < tables.size(); t++) {
+		// Get col indices relative to a table, similar to blazing_frame::get_column
+		std::vector<int> localIndices;
+		for(int i : globalColumnIndices) {
+			if(i >= processedColumns && i < processedColumns + tables[t].size()) {
+				localIndices.push_back(i - processedColumns);
+			}
+		}
+		processedColumns += tables[t].size();
+
+		gdf_size_type num_rows = tables[t][0].size();
+		gdf_size_type chunk_rows = (num_rows + num_partitions - 1) / num_partitions;
+		for(gdf_size_type start = 0; start < num_rows; start += chunk_rows) {
+			std::vector<gdf_column_cpp> chunk =
+				ral::utilities::sliceTable(tables[t], start, std::min(chunk_rows, num_rows - start));
+			std::vector<std::vector<gdf_column_cpp>> chunk_partitions =
+				ral::distribution::hashPartition(chunk, localIndices, num_partitions);
+			for(gdf_size_type p = 0; p < num_partitions; p++) {
+				partitions[t][p].push_back(ral::spill::spillable_table::make(manager, chunk_partitions[p]));
+			}
+		}
+		tables[t].clear();
+	}
+	Library::Logging::Logger().logInfo(timer_.logDuration(*context_, "external_join part 1 hashPartition"));
+	timer_.reset();
+
+	bool is_inner_join = get_named_expression(query, "joinType") == INNER_JOIN;
+	std::vector<std::shared_ptr<ral::spill::spillable_table>> joined;
+	for(gdf_size_type p = 0; p < num_partitions; p++) {
+		blazing_frame partition_frame;
+		for(size_t t = 0; t < partitions.size(); t++) {
+			std::vector<std::vector<gdf_column_cpp>> pieces;
+			for(auto & piece : partitions[t][p]) {
+				pieces.push_back(piece->take());
+			}
+			partitions[t][p].clear();
+			partition_frame.add_table(ral::utilities::concatTables(pieces));
+		}
+
+		evaluate_join(partition_frame, query);
+		materialize_column(partition_frame, is_inner_join);
+		joined.push_back(ral::spill::spillable_table::make(manager, partition_frame.get_table(0)));
+	}
+
+	std::vector<std::vector<gdf_column_cpp>> joined_tables;
+	for(auto & partition : joined) {
+		joined_tables.push_back(partition->take());
+	}
+	joined.clear();
+
+	blazing_frame output;
+	output.add_table(ral::utilities::concatTables(joined_tables));
+	Library::Logging::Logger().logInfo(timer_.logDuration(*context_,
+		"external_join part 2 join " + std::to_string(num_partitions) + " partitions, " +
+			std::to_string(manager.get_bytes_spilled()) + " bytes spilled, " +
+			std::to_string(manager.get_bytes_written_to_disk()) + " written to disk"));
+	ral::profile::add_bytes_spilled(manager.get_bytes_spilled(), manager.get_bytes_written_to_disk());
+	timer_.reset();
+	return output;
+}
+
+
 LocalJoinOperator::LocalJoinOperator(Context * context) : JoinOperator(context) {}
 
 blazing_frame LocalJoinOperator::operator()(blazing_frame & input, const std::string & query) {
+	std::size_t device_limit = get_external_join_limit(input);
+	if(device_limit > 0) {
+		return external_join(input, query, device_limit);
+	}
+
 	// Evaluate join
 	evaluate_join(input, query);
 	Library::Logging::Logger().logInfo(timer_.logDuration(*context_, "LocalJoinOperator part 1 evaluate_join"));
@@ -194,6 +299,11 @@ blazing_frame DistributedJoinOperator::operator()(blazing_frame & frame, const s
 		timer_.logDuration(*context_, "DistributedJoinOperator part 1 process_distribution"));
 	timer_.reset();
 
+	std::size_t device_limit = get_external_join_limit(frame);
+	if(device_limit > 0) {
+		return external_join(frame, query, device_limit);
+	}
+
 	// Evaluate join
 	evaluate_join(frame, query);
 	Library::Logging::Logger().logInfo(timer_.logDuration(*context_, "DistributedJoinOperator part 2 evaluate_join"));
@@ -8,8 +8,12 @@
 #include "Traits/RuntimeTraits.h"
 #include "communication/CommunicationData.h"
 #include "config/GPUManager.cuh"
+#include "cuDF/Allocator.h"
 #include "cuDF/safe_nvcategory_gather.hpp"
 #include "distribution/primitives.h"
+#include "profile/QueryProfile.h"
+#include "spill/SpillableTable.h"
+#include "utilities/CommonOperations.h"
 #include <algorithm>
 #include <blazingdb/io/Library/Logging/Logger.h>
 #include <blazingdb/io/Util/StringUtil.h>
@@ -26,6 +30,9 @@ const std::string LOGICAL_SORT_TEXT = "LogicalSort";
 const std::string ASCENDING_ORDER_SORT_TEXT = "ASC";
 const std::string DESCENDING_ORDER_SORT_TEXT = "DESC";
 
+// rows sampled per range when picking the pivots of an external sort
+const std::size_t EXTERNAL_SORT_SAMPLES_PER_RANGE = 100;
+
 bool is_sort(std::string query_part) { return (query_part.find(LOGICAL_SORT_TEXT) != std::string::npos); }
 
 int count_string_occurrence(std::string haystack, std::string needle) {
@@ -92,8 +99,7 @@ void sort(const Context & queryContext,
 	std::vector<gdf_column *> & rawCols,
 	std::vector<int8_t> & sortOrderTypes,
 	std::vector<gdf_column_cpp> & sortedTable) {
-	static CodeTimer timer;
-	timer.reset();
+	CodeTimer timer;
 
 	gdf_column_cpp asc_desc_col;
 	asc_desc_col.create_gdf_column(GDF_INT8,
@@ -163,6 +169,100 @@ void single_node_sort(const Context & queryContext,
 	input.add_table(sortedTable);
 }
 
+// Device limit to sort the input a range of keys at a time under, 0 when the sort fits in the budget of the query
+std::size_t get_external_sort_limit(const Context * queryContext, blazing_frame & input) {
+	gdf_size_type num_rows = input.get_num_rows_in_table(0);
+	if(queryContext == nullptr || num_rows < 2) {
+		return 0;
+	}
+
+	// gdf_order_by needs an index per row, materializing needs a sorted copy of the table
+	std::size_t working_set =
+		ral::spill::spillable_table::get_device_size(input.get_table(0)) + num_rows * sizeof(gdf_index_type);
+	return ral::spill::get_out_of_core_device_limit(*queryContext->getMemoryTracker(), working_set);
+}
+
+// Sorts a table that does not fit in the budget of the query. The input is cut into chunks, each chunk is split by
+// sampled pivots into ranges of keys that are put aside in a spill manager. Then each range is brought back, sorted by
+// itself and put aside again. The sorted ranges are concatenated in order.
+void external_sort(const Context & queryContext,
+	blazing_frame & input,
+	std::vector<gdf_column_cpp> & cols,
+	std::vector<int8_t> & sortOrderTypes,
+	std::vector<int> & sortColIndices,
+	std::size_t device_limit) {
+	CodeTimer timer;
+
+	std::vector<gdf_column_cpp> table = input.get_table(0);
+	gdf_size_type num_rows = table[0].size();
+
+	// a range and its sorted copy have to fit in the device limit
+	std::size_t table_size = ral::spill::spillable_table::get_device_size(table);
+	gdf_size_type num_ranges = std::min<std::size_t>(
+		ral::spill::get_out_of_core_partitions(table_size, device_limit, "external_sort"), num_rows);
+	gdf_size_type chunk_rows = (num_rows + num_ranges - 1) / num_ranges;
+
+	std::vector<gdf_column_cpp> samples = ral::distribution::sampling::generateSample(
+		cols, std::min<std::size_t>(num_rows, num_ranges * EXTERNAL_SORT_SAMPLES_PER_RANGE));
+	std::vector<gdf_column_cpp> pivots = ral::distribution::generatePivots(samples, sortOrderTypes, num_ranges);
+	samples.clear();
+
+	ral::spill::spill_manager manager(device_limit);
+	std::vector<std::vector<std::shared_ptr<ral::spill::spillable_table>>> ranges(num_ranges);
+	for(gdf_size_type start = 0; start < num_rows; start += chunk_rows) {
+		std::vector<gdf_column_cpp> chunk =
+			ral::utilities::sliceTable(table, start, std::min(chunk_rows, num_rows - start));
+		std::vector<std::vector<gdf_column_cpp>> partitions =
+			ral::distribution::rangePartition(chunk, sortColIndices, pivots, false, sortOrderTypes);
+		for(size_t i = 0; i < partitions.size(); i++) {
+			ranges[i].push_back(ral::spill::spillable_table::make(manager, partitions[i]));
+		}
+	}
+	table.clear();
+	input.clear();
+
+	Library::Logging::Logger().logInfo(timer.logDuration(queryContext, "external_sort part 1 rangePartition"));
+	timer.reset();
+
+	std::vector<std::shared_ptr<ral::spill::spillable_table>> sortedRanges;
+	for(auto & range : ranges) {
+		std::vector<std::vector<gdf_column_cpp>> pieces;
+		for(auto & piece : range) {
+			pieces.push_back(piece->take());
+		}
+		range.clear();
+
+		blazing_frame rangeFrame;
+		rangeFrame.add_table(ral::utilities::concatTables(pieces));
+		pieces.clear();
+
+		if(rangeFrame.get_num_rows_in_table(0) > 0) {
+			std::vector<gdf_column_cpp> rangeCols(sortColIndices.size());
+			std::vector<gdf_column *> rangeRawCols(sortColIndices.size());
+			for(size_t i = 0; i < sortColIndices.size(); i++) {
+				rangeCols[i] = rangeFrame.get_column(sortColIndices[i]).clone();
+				rangeRawCols[i] = rangeCols[i].get_gdf_column();
+			}
+			single_node_sort(queryContext, rangeFrame, rangeRawCols, sortOrderTypes);
+		}
+		sortedRanges.push_back(ral::spill::spillable_table::make(manager, rangeFrame.get_table(0)));
+	}
+
+	std::vector<std::vector<gdf_column_cpp>> sortedTables;
+	for(auto & range : sortedRanges) {
+		sortedTables.push_back(range->take());
+	}
+	sortedRanges.clear();
+	input.add_table(ral::utilities::concatTables(sortedTables));
+
+	Library::Logging::Logger().logInfo(timer.logDuration(queryContext,
+		"external_sort part 2 sort " + std::to_string(num_ranges) + " ranges, " +
+			std::to_string(manager.get_bytes_spilled()) + " bytes spilled, " +
+			std::to_string(manager.get_bytes_written_to_disk()) + " written to disk"));
+	ral::profile::add_bytes_spilled(manager.get_bytes_spilled(), manager.get_bytes_written_to_disk());
+	timer.reset();
+}
+
 void distributed_sort(Context & queryContext,
 	blazing_frame & input,
 	std::vector<gdf_column_cpp> & cols,
@@ -170,8 +270,7 @@ void distributed_sort(Context & queryContext,
 	std::vector<int8_t> & sortOrderTypes,
 	std::vector<int> & sortColIndices) {
 	using ral::communication::CommunicationData;
-	static CodeTimer timer;
-	timer.reset();
+	CodeTimer timer;
 
 	std::vector<gdf_column_cpp> sortedTable(input.get_size_column(0));
 	for(int i = 0; i < sortedTable.size(); i++) {
@@ -201,12 +300,15 @@ void distributed_sort(Context & queryContext,
 	Library::Logging::Logger().logInfo(timer.logDuration(queryContext, "distributed_sort part 1 generateSample"));
 	timer.reset();
 
-	std::thread sortThread{[](Context & queryContext,
+	// the sort allocates for this operator, so it is charged to the same query and operator
+	const cuDF::Allocator::memory_attribution attribution = cuDF::Allocator::memory_scope::current();
+	std::thread sortThread{[attribution](Context & queryContext,
 							   blazing_frame & input,
 							   std::vector<gdf_column *> & rawCols,
 							   std::vector<int8_t> & sortOrderTypes,
 							   std::vector<gdf_column_cpp> & sortedTable) {
-							   static CodeTimer timer2;
+							   cuDF::Allocator::memory_scope task_scope(attribution);
+							   CodeTimer timer2;
 							   sort(queryContext, input, rawCols, sortOrderTypes, sortedTable);
 							   Library::Logging::Logger().logInfo(
 								   timer2.logDuration(queryContext, "distributed_sort part 2 async sort"));
@@ -299,7 +401,12 @@ void process_sort(blazing_frame & input, std::string query_part, Context * query
 
 	if(!queryContext || queryContext->getTotalNodes() <= 1) {
 		if(num_sort_columns > 0) {
-			single_node_sort(*queryContext, input, rawCols, sortOrderTypes);
+			std::size_t device_limit = get_external_sort_limit(queryContext, input);
+			if(device_limit > 0) {
+				external_sort(*queryContext, input, cols, sortOrderTypes, sortColIndices, device_limit);
+			} else {
+				single_node_sort(*queryContext, input, rawCols, sortOrderTypes);
+			}
 		}
 		if(!limitRowsStr.empty()) {
 			limit_table(input, std::stoi(limitRowsStr));
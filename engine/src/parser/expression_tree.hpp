@@ -1,9 +1,11 @@
 #pragma once
 #include "parser/expression_utils.hpp"
 #include <algorithm>
+#include <cassert>
 #include <blazingdb/io/Util/StringUtil.h>
 #include <cstring>
 #include <iostream>
+#include <memory>
 #include <sstream>
 #include <stack>
 #include <stdio.h>
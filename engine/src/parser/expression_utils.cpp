@@ -13,7 +13,11 @@ bool is_unary_operator_token(const std::string & token) {
 
 bool is_string(const std::string & token) { return token[0] == '\'' && token[token.size() - 1] == '\''; }
 
+// the regexes below run for every token of every expression, so tokens that can't match are rejected up front
 bool is_number(const std::string & token) {
+	if(token.empty() || std::string("+-.0123456789").find(token[0]) == std::string::npos) {
+		return false;
+	}
 	static const std::regex re{R""(^[-+]?[0-9]*\.?[0-9]+([eE][-+]?[0-9]+)?$)""};
 	return std::regex_match(token, re);
 }
@@ -21,16 +25,25 @@ bool is_number(const std::string & token) {
 bool is_null(const std::string & token) { return token == "null"; }
 
 bool is_date(const std::string & token) {
+	if(token.size() != 10) {
+		return false;
+	}
 	static const std::regex re{R"([12]\d{3}-(0[1-9]|1[0-2])-(0[1-9]|[12]\d|3[01]))"};
 	return std::regex_match(token, re);
 }
 
 bool is_hour(const std::string & token) {
+	if(token.size() != 8) {
+		return false;
+	}
 	static const std::regex re{"([0-9]{2}):([0-9]{2}):([0-9]{2})"};
 	return std::regex_match(token, re);
 }
 
 bool is_timestamp(const std::string & token) {
+	if(token.size() != 19) {
+		return false;
+	}
 	static const std::regex re("([0-9]{4})-([0-9]{2})-([0-9]{2}) ([0-9]{2}):([0-9]{2}):([0-9]{2})");
 	bool ret = std::regex_match(token, re);
 	return ret;
@@ -0,0 +1,225 @@
+#include "QueryProfile.h"
+#include "cuDF/Allocator.h"
+#include <blazingdb/io/Config/BlazingContext.h>
+#include <blazingdb/io/FileSystem/FileSystemManager.h>
+#include <blazingdb/io/FileSystem/Uri.h>
+#include <cstdio>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+
+namespace ral {
+namespace profile {
+
+namespace {
+
+thread_local query_profile * current_query = nullptr;
+thread_local operator_profile * current_operator = nullptr;
+
+std::mutex profile_directory_mutex;
+std::string profile_directory;
+
+double elapsed_ms(std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// usage of the operator the allocations of this thread are accounted to
+blazingdb::manager::MemoryTracker::OperatorUsage get_operator_usage() {
+	const cuDF::Allocator::memory_attribution & attribution = cuDF::Allocator::memory_scope::current();
+	if(attribution.tracker == nullptr) {
+		return {0, 0, 0};
+	}
+	auto usage = attribution.tracker->getOperatorUsage();
+	auto found = usage.find(attribution.operator_name);
+	return found != usage.end() ? found->second : blazingdb::manager::MemoryTracker::OperatorUsage{0, 0, 0};
+}
+
+void append_json(std::ostringstream & json, const operator_profile & profile) {
+	json << "{\"relational_expression\":";
+	append_json_string(json, profile.relational_expression);
+	json << ",\"wall_time_ms\":" << profile.wall_time_ms << ",\"self_time_ms\":" << profile.self_time_ms
+		 << ",\"rows_in\":" << profile.rows_in << ",\"rows_out\":" << profile.rows_out
+		 << ",\"bytes_read\":" << profile.bytes_read << ",\"bytes_shuffled\":" << profile.bytes_shuffled
+		 << ",\"bytes_copied\":" << profile.bytes_copied
+		 << ",\"bytes_allocated\":" << profile.bytes_allocated << ",\"peak_bytes\":" << profile.peak_bytes
+		 << ",\"bytes_spilled\":" << profile.bytes_spilled
+		 << ",\"bytes_spilled_to_disk\":" << profile.bytes_spilled_to_disk << ",\"children\":[";
+	for(std::size_t i = 0; i < profile.children.size(); i++) {
+		if(i > 0) {
+			json << ',';
+		}
+		append_json(json, *profile.children[i]);
+	}
+	json << "]}";
+}
+
+}  // namespace
+
+void append_json_string(std::ostringstream & json, const std::string & value) {
+	json << '"';
+	for(char c : value) {
+		switch(c) {
+		case '"': json << "\\\""; break;
+		case '\\': json << "\\\\"; break;
+		case '\n': json << "\\n"; break;
+		case '\t': json << "\\t"; break;
+		case '\r': json << "\\r"; break;
+		default:
+			if(static_cast<unsigned char>(c) < 0x20) {
+				char escaped[7];
+				std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+				json << escaped;
+			} else {
+				json << c;
+			}
+		}
+	}
+	json << '"';
+}
+
+query_profile::query_profile(uint32_t context_token) : context_token(context_token) {}
+
+std::string query_profile::to_json() const {
+	std::ostringstream json;
+	json << "{\"context_token\":" << this->context_token << ",\"wall_time_ms\":" << this->wall_time_ms
+		 << ",\"peak_bytes\":" << this->peak_bytes << ",\"plan\":";
+	if(this->root != nullptr) {
+		append_json(json, *this->root);
+	} else {
+		json << "null";
+	}
+	json << '}';
+	return json.str();
+}
+
+query_scope::query_scope(query_profile & profile, std::shared_ptr<blazingdb::manager::MemoryTracker> tracker)
+	: profile(profile), tracker(std::move(tracker)), start(std::chrono::steady_clock::now()),
+	  previous_query(current_query), previous_operator(current_operator) {
+	current_query = &profile;
+	current_operator = nullptr;
+}
+
+query_scope::~query_scope() {
+	this->profile.wall_time_ms = elapsed_ms(this->start);
+	if(this->tracker != nullptr) {
+		this->profile.peak_bytes = this->tracker->getPeak();
+	}
+	current_query = this->previous_query;
+	current_operator = this->previous_operator;
+}
+
+operator_scope::operator_scope(std::string relational_expression)
+	: profile(nullptr), parent(current_operator), start(std::chrono::steady_clock::now()) {
+	if(current_query == nullptr) {
+		return;
+	}
+
+	std::unique_ptr<operator_profile> new_profile(new operator_profile);
+	new_profile->relational_expression = std::move(relational_expression);
+	this->profile = new_profile.get();
+	if(this->parent != nullptr) {
+		this->parent->children.push_back(std::move(new_profile));
+	} else {
+		current_query->root = std::move(new_profile);
+	}
+	this->allocated_at_start = get_operator_usage().total;
+	current_operator = this->profile;
+}
+
+operator_scope::~operator_scope() {
+	if(this->profile == nullptr) {
+		return;
+	}
+
+	operator_profile & profile = *this->profile;
+	profile.wall_time_ms = elapsed_ms(this->start);
+	profile.self_time_ms = profile.wall_time_ms;
+	for(const auto & child : profile.children) {
+		profile.self_time_ms -= child->wall_time_ms;
+		profile.rows_in += child->rows_out;
+	}
+
+	// siblings with the same operator name run one after the other, the total grew by what this one allocated
+	blazingdb::manager::MemoryTracker::OperatorUsage usage = get_operator_usage();
+	profile.bytes_allocated = usage.total - this->allocated_at_start;
+	profile.peak_bytes = usage.peak;
+
+	current_operator = this->parent;
+}
+
+void operator_scope::set_rows_out(int64_t rows) {
+	if(this->profile != nullptr) {
+		this->profile->rows_out = rows;
+	}
+}
+
+void add_rows_in(int64_t rows) {
+	if(current_operator != nullptr) {
+		current_operator->rows_in += rows;
+	}
+}
+
+void add_bytes_read(std::size_t bytes) {
+	if(current_operator != nullptr) {
+		current_operator->bytes_read += bytes;
+	}
+}
+
+void add_bytes_shuffled(std::size_t bytes) {
+	if(current_operator != nullptr) {
+		current_operator->bytes_shuffled += bytes;
+	}
+}
+
+void add_bytes_copied(std::size_t bytes) {
+	if(current_operator != nullptr) {
+		current_operator->bytes_copied += bytes;
+	}
+}
+
+void add_bytes_spilled(std::size_t bytes, std::size_t bytes_to_disk) {
+	if(current_operator != nullptr) {
+		current_operator->bytes_spilled += bytes;
+		current_operator->bytes_spilled_to_disk += bytes_to_disk;
+	}
+}
+
+void set_profile_directory(const std::string & directory) {
+	std::lock_guard<std::mutex> lock(profile_directory_mutex);
+	profile_directory = directory;
+}
+
+std::string get_profile_directory() {
+	std::lock_guard<std::mutex> lock(profile_directory_mutex);
+	return profile_directory;
+}
+
+void write_profile(const query_profile & profile) {
+	const std::string directory = get_profile_directory();
+	if(directory.empty()) {
+		return;
+	}
+
+	std::shared_ptr<FileSystemManager> file_system_manager = BlazingContext::getInstance()->getFileSystemManager();
+	const Uri directory_uri(FileSystemType::LOCAL, "local", Path(directory));
+	if(!file_system_manager->exists(directory_uri)) {
+		file_system_manager->makeDirectory(directory_uri);
+	}
+
+	const std::string file = "query-" + std::to_string(profile.get_context_token()) + ".json";
+	std::shared_ptr<arrow::io::OutputStream> stream = file_system_manager->openWriteable(directory_uri + ("/" + file));
+	if(stream == nullptr) {
+		throw std::runtime_error("Could not open the profile file " + file + " in " + directory);
+	}
+	const std::string json = profile.to_json();
+	arrow::Status status = stream->Write(json.data(), json.size());
+	if(status.ok()) {
+		status = stream->Close();
+	}
+	if(!status.ok()) {
+		throw std::runtime_error("Could not write the profile file " + file + ": " + status.ToString());
+	}
+}
+
+}  // namespace profile
+}  // namespace ral
@@ -0,0 +1,132 @@
+/*
+ * QueryProfile.h
+ *
+ * What every operator of a query did, as a tree matching the plan: wall time, rows in and out and the bytes it read,
+ * shuffled, copied, allocated and spilled. The operators report to the profile of the query their thread runs, code
+ * deeper down adds its counters to the operator it runs for without the profile being passed around.
+ */
+
+#ifndef PROFILE_QUERYPROFILE_H_
+#define PROFILE_QUERYPROFILE_H_
+
+#include <blazingdb/manager/MemoryTracker.h>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace ral {
+namespace profile {
+
+// One operator of the plan, the operators it takes its input from are its children
+struct operator_profile {
+	std::string relational_expression;
+	double wall_time_ms = 0;  // including its children
+	double self_time_ms = 0;
+	int64_t rows_in = 0;  // rows loaded by a scan, otherwise the rows out of its children
+	int64_t rows_out = 0;
+	std::size_t bytes_read = 0;		  // of the files scanned
+	std::size_t bytes_shuffled = 0;	  // sent to and received from other nodes
+	std::size_t bytes_copied = 0;	  // by filters gathering the rows they keep
+	std::size_t bytes_allocated = 0;  // device memory, freed or not
+	std::size_t peak_bytes = 0;		  // of device memory held by the operator
+	std::size_t bytes_spilled = 0;	  // moved out of device memory to run out of core
+	std::size_t bytes_spilled_to_disk = 0;
+	std::vector<std::unique_ptr<operator_profile>> children;
+};
+
+class query_profile {
+public:
+	explicit query_profile(uint32_t context_token);
+
+	uint32_t get_context_token() const { return context_token; }
+
+	// the top operator of the plan, nullptr until the query ran
+	const operator_profile * get_root() const { return root.get(); }
+
+	double get_wall_time_ms() const { return wall_time_ms; }
+
+	// of device memory held by the whole query
+	std::size_t get_peak_bytes() const { return peak_bytes; }
+
+	std::string to_json() const;
+
+private:
+	friend class query_scope;
+	friend class operator_scope;
+
+	const uint32_t context_token;
+	std::unique_ptr<operator_profile> root;
+	double wall_time_ms = 0;
+	std::size_t peak_bytes = 0;
+};
+
+// Profiles the operators this thread runs, until the scope ends, into a query profile. The wall time and the peak of
+// the memory tracker of the query are recorded when it ends.
+class query_scope {
+public:
+	query_scope(query_profile & profile, std::shared_ptr<blazingdb::manager::MemoryTracker> tracker);
+
+	~query_scope();
+
+	query_scope(const query_scope &) = delete;
+	query_scope & operator=(const query_scope &) = delete;
+
+private:
+	query_profile & profile;
+	std::shared_ptr<blazingdb::manager::MemoryTracker> tracker;
+	std::chrono::steady_clock::time_point start;
+	query_profile * previous_query;
+	operator_profile * previous_operator;
+};
+
+// Profiles one operator, as a child of the operator this thread runs for or as the root of the query. Opened after the
+// memory scope of the operator, its allocations are read from the memory tracker. Does nothing outside a query scope.
+class operator_scope {
+public:
+	explicit operator_scope(std::string relational_expression);
+
+	~operator_scope();
+
+	void set_rows_out(int64_t rows);
+
+	operator_scope(const operator_scope &) = delete;
+	operator_scope & operator=(const operator_scope &) = delete;
+
+private:
+	operator_profile * profile;
+	operator_profile * parent;
+	std::chrono::steady_clock::time_point start;
+	std::size_t allocated_at_start = 0;
+};
+
+// counters of the operator this thread runs for, ignored outside a query scope
+void add_rows_in(int64_t rows);
+
+void add_bytes_read(std::size_t bytes);
+
+void add_bytes_shuffled(std::size_t bytes);
+
+void add_bytes_copied(std::size_t bytes);
+
+void add_bytes_spilled(std::size_t bytes, std::size_t bytes_to_disk);
+
+// Where every query writes its profile as query-<context token>.json, a local directory. Empty (the default) writes
+// none.
+void set_profile_directory(const std::string & directory);
+
+std::string get_profile_directory();
+
+// writes the profile to the profile directory, if there is one
+void write_profile(const query_profile & profile);
+
+// a JSON string with the escapes it needs
+void append_json_string(std::ostringstream & json, const std::string & value);
+
+}  // namespace profile
+}  // namespace ral
+
+#endif /* PROFILE_QUERYPROFILE_H_ */
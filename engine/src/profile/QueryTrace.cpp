@@ -0,0 +1,319 @@
+#include "QueryTrace.h"
+#include "QueryProfile.h"
+#include <algorithm>
+#include <blazingdb/io/Config/BlazingContext.h>
+#include <blazingdb/io/FileSystem/FileSystemManager.h>
+#include <blazingdb/io/FileSystem/Uri.h>
+#include <chrono>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+namespace ral {
+namespace profile {
+
+namespace {
+
+const uint32_t TRACE_MAGIC = 0x52544c42;  // "BLTR"
+const uint32_t TRACE_VERSION = 1;
+
+struct trace_header {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t num_spans;
+	uint32_t num_names;
+};
+
+std::mutex traces_mutex;
+std::map<uint32_t, std::shared_ptr<query_trace>> traces;
+std::atomic<int> num_traces{0};
+
+std::mutex trace_directory_mutex;
+std::string trace_directory;
+
+std::atomic<int64_t> trace_wait_ms{30000};
+
+const char * get_kind_name(span_kind kind) {
+	switch(kind) {
+	case span_kind::OPERATOR: return "operator";
+	case span_kind::SEND: return "send";
+	case span_kind::WAIT: return "wait";
+	case span_kind::RECEIVE: return "receive";
+	}
+	return "unknown";
+}
+
+template <typename T>
+void append_bytes(std::vector<char> & buffer, const T & value) {
+	const char * bytes = reinterpret_cast<const char *>(&value);
+	buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+template <typename T>
+T read_bytes(const char * buffer, std::size_t size, std::size_t & offset) {
+	if(size - offset < sizeof(T)) {
+		throw std::runtime_error("The trace buffer ends at " + std::to_string(size) + " bytes");
+	}
+	T value;
+	std::memcpy(&value, buffer + offset, sizeof(T));
+	offset += sizeof(T);
+	return value;
+}
+
+void append_flow_event(std::ostringstream & json, char phase, const trace_span & span, uint64_t id) {
+	json << ",\n{\"name\":\"message\",\"cat\":\"message\",\"ph\":\"" << phase << "\",\"id\":" << id
+		 << ",\"ts\":" << span.begin_us << ",\"pid\":" << span.node << ",\"tid\":" << span.thread;
+	if(phase == 'f') {
+		json << ",\"bp\":\"e\"";
+	}
+	json << '}';
+}
+
+}  // namespace
+
+query_trace::query_trace(uint32_t context_token, int32_t node) : context_token(context_token), node(node) {}
+
+uint64_t query_trace::next_span_id() {
+	// below 2^53 while there are less than 2^21 nodes, so the ids survive the doubles of a JSON reader
+	return (static_cast<uint64_t>(this->node + 1) << 32) | ++this->last_span_id;
+}
+
+void query_trace::add_span(span_kind kind,
+	const std::string & name,
+	int64_t begin_us,
+	int64_t end_us,
+	uint64_t span_id,
+	uint64_t link_id,
+	uint64_t bytes) {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	const int32_t thread = kind == span_kind::RECEIVE ? 0 : this->get_thread_index();
+	this->spans.push_back(
+		trace_span{begin_us, end_us, span_id, link_id, bytes, this->node, thread, kind, this->get_name_index(name)});
+}
+
+std::vector<trace_span> query_trace::get_spans() const {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return this->spans;
+}
+
+std::string query_trace::get_name(const trace_span & span) const {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return span.name >= 0 && span.name < static_cast<int32_t>(this->names.size()) ? this->names[span.name] : "";
+}
+
+std::vector<char> query_trace::serialize() const {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	std::vector<char> buffer;
+	append_bytes(buffer,
+		trace_header{TRACE_MAGIC,
+			TRACE_VERSION,
+			static_cast<uint32_t>(this->spans.size()),
+			static_cast<uint32_t>(this->names.size())});
+	const char * spans = reinterpret_cast<const char *>(this->spans.data());
+	buffer.insert(buffer.end(), spans, spans + this->spans.size() * sizeof(trace_span));
+	for(const std::string & name : this->names) {
+		append_bytes(buffer, static_cast<uint32_t>(name.size()));
+		buffer.insert(buffer.end(), name.begin(), name.end());
+	}
+	return buffer;
+}
+
+void query_trace::merge(const char * buffer, std::size_t size) {
+	std::size_t offset = 0;
+	const trace_header header = read_bytes<trace_header>(buffer, size, offset);
+	if(header.magic != TRACE_MAGIC || header.version != TRACE_VERSION) {
+		throw std::runtime_error("The buffer is not a trace of version " + std::to_string(TRACE_VERSION));
+	}
+	// the counts are checked against what is left of the buffer before anything is sized by them
+	if((size - offset) / sizeof(trace_span) < header.num_spans) {
+		throw std::runtime_error("The trace buffer ends at " + std::to_string(size) + " bytes");
+	}
+	std::vector<trace_span> merged(header.num_spans);
+	for(trace_span & span : merged) {
+		span = read_bytes<trace_span>(buffer, size, offset);
+	}
+
+	std::lock_guard<std::mutex> lock(this->mutex);
+	// the names of the other node are interned again in this trace
+	if((size - offset) / sizeof(uint32_t) < header.num_names) {
+		throw std::runtime_error("The trace buffer ends at " + std::to_string(size) + " bytes");
+	}
+	std::vector<int32_t> name_indices(header.num_names);
+	for(int32_t & index : name_indices) {
+		const uint32_t length = read_bytes<uint32_t>(buffer, size, offset);
+		if(size - offset < length) {
+			throw std::runtime_error("The trace buffer ends at " + std::to_string(size) + " bytes");
+		}
+		index = this->get_name_index(std::string(buffer + offset, length));
+		offset += length;
+	}
+	for(trace_span & span : merged) {
+		if(span.name < 0 || span.name >= static_cast<int32_t>(name_indices.size())) {
+			throw std::runtime_error("A span of the trace names " + std::to_string(span.name) + " of " +
+									 std::to_string(name_indices.size()) + " names");
+		}
+		span.name = name_indices[span.name];
+		this->spans.push_back(span);
+	}
+}
+
+std::string query_trace::to_chrome_json() const {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	std::ostringstream json;
+	json << "{\"displayTimeUnit\":\"ms\",\"otherData\":{\"context_token\":" << this->context_token
+		 << "},\"traceEvents\":[";
+
+	std::vector<int32_t> nodes;
+	for(const trace_span & span : this->spans) {
+		nodes.push_back(span.node);
+	}
+	std::sort(nodes.begin(), nodes.end());
+	nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+	for(int32_t node : nodes) {
+		if(node != nodes.front()) {
+			json << ',';
+		}
+		json << "\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << node << ",\"tid\":0,\"args\":{\"name\":\"node "
+			 << node << "\"}},\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << node
+			 << ",\"tid\":0,\"args\":{\"name\":\"message server\"}}";
+	}
+
+	std::unordered_map<uint64_t, const trace_span *> sends;
+	for(const trace_span & span : this->spans) {
+		if(span.kind == span_kind::SEND) {
+			sends[span.span_id] = &span;
+		}
+	}
+	for(const trace_span & span : this->spans) {
+		// every span follows the names of its node
+		json << ",\n{\"name\":";
+		append_json_string(json, this->names[span.name]);
+		json << ",\"cat\":\"" << get_kind_name(span.kind) << "\",\"ph\":\"X\",\"ts\":" << span.begin_us
+			 << ",\"dur\":" << std::max<int64_t>(span.end_us - span.begin_us, 0) << ",\"pid\":" << span.node
+			 << ",\"tid\":" << span.thread << ",\"args\":{\"span_id\":" << span.span_id;
+		if(span.link_id != 0) {
+			json << ",\"link_id\":" << span.link_id;
+		}
+		if(span.kind == span_kind::SEND || span.kind == span_kind::RECEIVE) {
+			json << ",\"bytes\":" << span.bytes;
+		}
+		json << "}}";
+
+		auto send = sends.find(span.link_id);
+		if(span.kind == span_kind::RECEIVE && send != sends.end()) {
+			append_flow_event(json, 's', *send->second, span.link_id);
+			append_flow_event(json, 'f', span, span.link_id);
+		}
+	}
+	json << "\n]}";
+	return json.str();
+}
+
+int32_t query_trace::get_name_index(const std::string & name) {
+	auto found = this->name_indices.find(name);
+	if(found != this->name_indices.end()) {
+		return found->second;
+	}
+	const int32_t index = this->names.size();
+	this->names.push_back(name);
+	this->name_indices[name] = index;
+	return index;
+}
+
+int32_t query_trace::get_thread_index() {
+	auto inserted = this->threads.emplace(std::this_thread::get_id(), this->threads.size() + 1);
+	return inserted.first->second;
+}
+
+int64_t now_us() {
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch())
+		.count();
+}
+
+void start_trace(uint32_t context_token, int32_t node) {
+	std::lock_guard<std::mutex> lock(traces_mutex);
+	traces[context_token] = std::make_shared<query_trace>(context_token, node);
+	num_traces = traces.size();
+}
+
+std::shared_ptr<query_trace> find_trace(uint32_t context_token) {
+	if(num_traces == 0) {
+		return nullptr;
+	}
+	std::lock_guard<std::mutex> lock(traces_mutex);
+	auto found = traces.find(context_token);
+	return found != traces.end() ? found->second : nullptr;
+}
+
+std::shared_ptr<query_trace> end_trace(uint32_t context_token) {
+	std::lock_guard<std::mutex> lock(traces_mutex);
+	auto found = traces.find(context_token);
+	if(found == traces.end()) {
+		return nullptr;
+	}
+	std::shared_ptr<query_trace> trace = found->second;
+	traces.erase(found);
+	num_traces = traces.size();
+	return trace;
+}
+
+trace_scope::trace_scope(uint32_t context_token, span_kind kind, std::string name)
+	: trace(find_trace(context_token)), kind(kind) {
+	if(this->trace == nullptr) {
+		return;
+	}
+	this->name = std::move(name);
+	this->span_id = this->trace->next_span_id();
+	this->begin_us = now_us();
+}
+
+trace_scope::~trace_scope() {
+	if(this->trace != nullptr) {
+		this->trace->add_span(
+			this->kind, this->name, this->begin_us, now_us(), this->span_id, this->link_id, this->bytes);
+	}
+}
+
+void set_trace_directory(const std::string & directory) {
+	std::lock_guard<std::mutex> lock(trace_directory_mutex);
+	trace_directory = directory;
+}
+
+std::string get_trace_directory() {
+	std::lock_guard<std::mutex> lock(trace_directory_mutex);
+	return trace_directory;
+}
+
+void set_trace_wait(std::chrono::milliseconds wait) { trace_wait_ms = wait.count(); }
+
+std::chrono::milliseconds get_trace_wait() { return std::chrono::milliseconds(trace_wait_ms.load()); }
+
+void write_trace(const query_trace & trace) {
+	const std::string directory = get_trace_directory();
+	if(directory.empty()) {
+		return;
+	}
+
+	std::shared_ptr<FileSystemManager> file_system_manager = BlazingContext::getInstance()->getFileSystemManager();
+	const Uri directory_uri(FileSystemType::LOCAL, "local", Path(directory));
+	if(!file_system_manager->exists(directory_uri)) {
+		file_system_manager->makeDirectory(directory_uri);
+	}
+
+	const std::string file = "trace-" + std::to_string(trace.get_context_token()) + ".json";
+	std::shared_ptr<arrow::io::OutputStream> stream = file_system_manager->openWriteable(directory_uri + ("/" + file));
+	if(stream == nullptr) {
+		throw std::runtime_error("Could not open the trace file " + file + " in " + directory);
+	}
+	const std::string json = trace.to_chrome_json();
+	arrow::Status status = stream->Write(json.data(), json.size());
+	if(status.ok()) {
+		status = stream->Close();
+	}
+	if(!status.ok()) {
+		throw std::runtime_error("Could not write the trace file " + file + ": " + status.ToString());
+	}
+}
+
+}  // namespace profile
+}  // namespace ral
@@ -0,0 +1,154 @@
+/*
+ * QueryTrace.h
+ *
+ * Spans of what every node did for a query: the operators it ran, the messages it sent, the time it waited for
+ * messages and the time its server spent reading them. A send stamps its span id on the metadata of its message, the
+ * node reading the message links its receive to it. Every node keeps its spans in a flat buffer that is shipped as it
+ * is, the master merges the buffers of the other nodes when the query ends and writes one timeline in the Chrome trace
+ * event format. The times are microseconds of the system clock of each node, the timeline lines up as well as the
+ * clocks of the nodes do.
+ */
+
+#ifndef PROFILE_QUERYTRACE_H_
+#define PROFILE_QUERYTRACE_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace ral {
+namespace profile {
+
+enum class span_kind : int32_t { OPERATOR, SEND, WAIT, RECEIVE };
+
+// Fixed size, the spans of a node are shipped to the master as they are kept
+struct trace_span {
+	int64_t begin_us;  // since the epoch
+	int64_t end_us;
+	uint64_t span_id;  // unique in the cluster
+	uint64_t link_id;  // of a wait or a receive, the span id of the send of its message
+	uint64_t bytes;	   // of the columns sent or received
+	int32_t node;	   // index of the node in the context of the query
+	int32_t thread;	   // index of the thread in the trace of its node, 0 is the server reading the messages
+	span_kind kind;
+	int32_t name;  // index of the name in the trace of its node
+};
+
+class query_trace {
+public:
+	query_trace(uint32_t context_token, int32_t node);
+
+	uint32_t get_context_token() const { return context_token; }
+
+	int32_t get_node() const { return node; }
+
+	uint64_t next_span_id();
+
+	// Records a span of the calling thread, a receive is recorded on the thread of the server
+	void add_span(span_kind kind,
+		const std::string & name,
+		int64_t begin_us,
+		int64_t end_us,
+		uint64_t span_id,
+		uint64_t link_id = 0,
+		uint64_t bytes = 0);
+
+	// of this node and of the nodes merged into it
+	std::vector<trace_span> get_spans() const;
+
+	std::string get_name(const trace_span & span) const;
+
+	// the spans and their names as one buffer
+	std::vector<char> serialize() const;
+
+	// Adds the spans of another node, as serialized by its trace. Throws std::runtime_error when the buffer is not a
+	// trace.
+	void merge(const char * buffer, std::size_t size);
+
+	// the Chrome trace event format, a process per node and a flow from every send to the receive of its message
+	std::string to_chrome_json() const;
+
+private:
+	int32_t get_name_index(const std::string & name);
+
+	int32_t get_thread_index();
+
+	const uint32_t context_token;
+	const int32_t node;
+	std::atomic<uint64_t> last_span_id{0};
+
+	mutable std::mutex mutex;
+	std::vector<trace_span> spans;
+	std::vector<std::string> names;
+	std::unordered_map<std::string, int32_t> name_indices;
+	std::map<std::thread::id, int32_t> threads;
+};
+
+// microseconds of the system clock since the epoch
+int64_t now_us();
+
+// Records the spans of the query on this node until the trace is ended, node is the index of this node in the
+// context of the query
+void start_trace(uint32_t context_token, int32_t node);
+
+// nullptr when the query is not traced
+std::shared_ptr<query_trace> find_trace(uint32_t context_token);
+
+// stops recording, nullptr when the query was not traced
+std::shared_ptr<query_trace> end_trace(uint32_t context_token);
+
+// Records a span of a traced query, from the creation of the scope to its destruction. Does nothing when the query is
+// not traced.
+class trace_scope {
+public:
+	trace_scope(uint32_t context_token, span_kind kind, std::string name);
+
+	~trace_scope();
+
+	// 0 when the query is not traced
+	uint64_t get_span_id() const { return span_id; }
+
+	void set_link_id(uint64_t link_id) { this->link_id = link_id; }
+
+	void set_bytes(uint64_t bytes) { this->bytes = bytes; }
+
+	trace_scope(const trace_scope &) = delete;
+	trace_scope & operator=(const trace_scope &) = delete;
+
+private:
+	std::shared_ptr<query_trace> trace;
+	span_kind kind;
+	std::string name;
+	int64_t begin_us = 0;
+	uint64_t span_id = 0;
+	uint64_t link_id = 0;
+	uint64_t bytes = 0;
+};
+
+// Where the master writes the trace of every query as trace-<context token>.json, a local directory. Empty (the
+// default) traces no query. Every node of a cluster must trace or none, the master waits for the traces of the others.
+void set_trace_directory(const std::string & directory);
+
+std::string get_trace_directory();
+
+// How long the master waits for the traces of the other nodes once its query finished, 30 seconds by default. A node
+// that failed before it sent its trace is left out of the timeline written with those that arrived.
+void set_trace_wait(std::chrono::milliseconds wait);
+
+std::chrono::milliseconds get_trace_wait();
+
+// writes the trace to the trace directory, if there is one
+void write_trace(const query_trace & trace);
+
+}  // namespace profile
+}  // namespace ral
+
+#endif /* PROFILE_QUERYTRACE_H_ */
@@ -0,0 +1,379 @@
+#include "SpillManager.h"
+#include "cuDF/Allocator.h"
+#include <algorithm>
+#include <blazingdb/io/Config/BlazingContext.h>
+#include <cuda_runtime_api.h>
+#include <iterator>
+#include <random>
+#include <stdexcept>
+
+namespace ral {
+namespace spill {
+
+namespace {
+
+// bytes spilled straight from device memory to disk, or read back, go through a host buffer this size
+const std::size_t STAGING_SIZE = 8 << 20;
+
+void check_cuda(cudaError_t error, const std::string & during) {
+	if(error != cudaSuccess) {
+		throw std::runtime_error("Spilling failed during " + during + ": " + cudaGetErrorString(error));
+	}
+}
+
+class pinned_host_memory : public host_memory {
+public:
+	void * allocate(std::size_t size) override {
+		void * pointer = nullptr;
+		check_cuda(cudaMallocHost(&pointer, size), "allocate of " + std::to_string(size) + " bytes of pinned memory");
+		return pointer;
+	}
+
+	void deallocate(void * pointer) override { cudaFreeHost(pointer); }
+
+	void copy_to_host(void * host, const void * device, std::size_t size) override {
+		check_cuda(cudaMemcpy(host, device, size, cudaMemcpyDeviceToHost), "copy to host");
+	}
+
+	void copy_to_device(void * device, const void * host, std::size_t size) override {
+		check_cuda(cudaMemcpy(device, host, size, cudaMemcpyHostToDevice), "copy to device");
+	}
+};
+
+std::shared_ptr<host_memory> default_host_memory = std::make_shared<pinned_host_memory>();
+
+std::atomic<std::size_t> default_host_limit{std::size_t(1) << 30};
+
+std::mutex default_spill_directory_mutex;
+std::string default_spill_directory = "/tmp";
+
+std::string make_file_prefix() {
+	std::random_device random;
+	std::mt19937_64 generator(random());
+	return "blazing-spill-" + std::to_string(generator()) + "-";
+}
+
+// frees a host buffer of the manager when it goes out of scope
+struct host_buffer {
+	host_buffer(host_memory & memory, std::size_t size) : memory(memory), data(memory.allocate(size)) {}
+	~host_buffer() { memory.deallocate(data); }
+
+	host_memory & memory;
+	void * data;
+};
+
+}  // namespace
+
+void set_host_memory(std::shared_ptr<host_memory> memory) { std::atomic_store(&default_host_memory, memory); }
+
+std::shared_ptr<host_memory> get_host_memory() { return std::atomic_load(&default_host_memory); }
+
+void set_default_host_limit(std::size_t limit) { default_host_limit = limit; }
+
+std::size_t get_default_host_limit() { return default_host_limit; }
+
+void set_default_spill_directory(const std::string & directory) {
+	std::lock_guard<std::mutex> lock(default_spill_directory_mutex);
+	default_spill_directory = directory;
+}
+
+std::string get_default_spill_directory() {
+	std::lock_guard<std::mutex> lock(default_spill_directory_mutex);
+	return default_spill_directory;
+}
+
+std::size_t get_out_of_core_device_limit(const blazingdb::manager::MemoryTracker & tracker, std::size_t working_set) {
+	const std::size_t budget = tracker.getBudget();
+	const std::size_t current = tracker.getCurrent();
+	if(budget == 0 || tracker.fits(working_set)) {
+		return 0;
+	}
+	return std::max<std::size_t>((current < budget ? budget - current : 0) / 2, 1);
+}
+
+std::size_t get_out_of_core_partitions(
+	std::size_t input_size, std::size_t device_limit, const std::string & operator_name) {
+	const std::size_t num_partitions = std::max<std::size_t>(2 * input_size / device_limit + 1, 2);
+	if(num_partitions <= MAX_OUT_OF_CORE_PARTITIONS) {
+		return num_partitions;
+	}
+
+	const std::size_t partition_size = (input_size + MAX_OUT_OF_CORE_PARTITIONS - 1) / MAX_OUT_OF_CORE_PARTITIONS;
+	if(partition_size > device_limit) {
+		throw cuDF::Allocator::QueryMemoryExceeded("in " + operator_name + ", a partition of " +
+												   std::to_string(2 * partition_size) + " bytes out of an input of " +
+												   std::to_string(input_size) + " does not fit in the " +
+												   std::to_string(2 * device_limit) + " bytes left");
+	}
+	return MAX_OUT_OF_CORE_PARTITIONS;
+}
+
+spilled_bytes::spilled_bytes(spill_manager & manager, std::size_t num_bytes)
+	: manager(manager), num_bytes(num_bytes), host_data(nullptr) {}
+
+spilled_bytes::~spilled_bytes() {
+	std::lock_guard<std::recursive_mutex> lock(this->manager.mutex);
+	if(this->host_data != nullptr) {
+		this->manager.host_bytes_list.erase(this->host_position);
+		this->manager.memory->deallocate(this->host_data);
+		this->manager.host_bytes -= this->num_bytes;
+	} else if(!this->file.empty()) {
+		this->manager.remove_file(this->file);
+		this->manager.disk_bytes -= this->num_bytes;
+	}
+}
+
+void spilled_bytes::copy_to_device(void * device) const {
+	std::lock_guard<std::recursive_mutex> lock(this->manager.mutex);
+	if(this->host_data != nullptr) {
+		this->manager.memory->copy_to_device(device, this->host_data, this->num_bytes);
+	} else if(this->num_bytes > 0) {
+		this->manager.read_from_disk(*this, device);
+	}
+}
+
+spillable::spillable(spill_manager & manager, std::size_t size) : manager(manager), size(size) {}
+
+spillable::~spillable() {
+	std::lock_guard<std::recursive_mutex> lock(this->manager.mutex);
+	if(this->managed) {
+		this->manager.spillables.erase(this->position);
+		if(!this->spilled) {
+			this->manager.device_bytes -= this->size;
+		}
+	}
+}
+
+bool spillable::is_spilled() const {
+	std::lock_guard<std::recursive_mutex> lock(this->manager.mutex);
+	return this->spilled;
+}
+
+void spillable::take_back() {
+	std::lock_guard<std::recursive_mutex> lock(this->manager.mutex);
+	if(!this->managed) {
+		return;
+	}
+
+	if(this->spilled) {
+		// this one is not on device, making room never picks it
+		this->manager.make_room(this->size);
+		this->load();
+		this->spilled = false;
+	} else {
+		this->manager.device_bytes -= this->size;
+	}
+	this->manager.spillables.erase(this->position);
+	this->managed = false;
+}
+
+std::unique_ptr<spilled_bytes> spillable::copy_out(const void * device, std::size_t size) {
+	return this->manager.spill_bytes(device, size);
+}
+
+spill_manager::spill_manager(std::size_t device_limit,
+	std::size_t host_limit,
+	const Uri & spill_directory,
+	std::shared_ptr<FileSystemManager> file_system_manager)
+	: device_limit(device_limit), host_limit(host_limit), spill_directory(spill_directory),
+	  file_system_manager(file_system_manager != nullptr ? file_system_manager
+														 : BlazingContext::getInstance()->getFileSystemManager()),
+	  file_prefix(make_file_prefix()), memory(get_host_memory()) {}
+
+spill_manager::~spill_manager() {}
+
+void spill_manager::add(const std::shared_ptr<spillable> & spillable) {
+	std::lock_guard<std::recursive_mutex> lock(this->mutex);
+	if(spillable->managed) {
+		return;
+	}
+
+	this->make_room(spillable->size);
+	this->spillables.push_back(spillable);
+	spillable->position = std::prev(this->spillables.end());
+	spillable->managed = true;
+	this->device_bytes += spillable->size;
+}
+
+std::size_t spill_manager::get_device_bytes() const {
+	std::lock_guard<std::recursive_mutex> lock(this->mutex);
+	return this->device_bytes;
+}
+
+std::size_t spill_manager::get_host_bytes() const {
+	std::lock_guard<std::recursive_mutex> lock(this->mutex);
+	return this->host_bytes;
+}
+
+std::size_t spill_manager::get_disk_bytes() const {
+	std::lock_guard<std::recursive_mutex> lock(this->mutex);
+	return this->disk_bytes;
+}
+
+void spill_manager::make_room(std::size_t size) {
+	auto it = this->spillables.begin();
+	while(this->device_bytes + size > this->device_limit && it != this->spillables.end()) {
+		// keeps the spillable alive while it spills, the list entry it leaves behind if it goes away is already passed
+		std::shared_ptr<spillable> oldest = it->lock();
+		++it;
+		if(oldest == nullptr || oldest->spilled) {
+			continue;
+		}
+
+		oldest->spill();
+		oldest->spilled = true;
+		this->device_bytes -= oldest->size;
+		this->bytes_spilled += oldest->size;
+	}
+}
+
+std::unique_ptr<spilled_bytes> spill_manager::spill_bytes(const void * device, std::size_t size) {
+	std::lock_guard<std::recursive_mutex> lock(this->mutex);
+	std::unique_ptr<spilled_bytes> bytes(new spilled_bytes(*this, size));
+	if(size == 0) {
+		return bytes;
+	}
+
+	if(size > this->host_limit) {
+		this->write_to_disk(*bytes, device, true);
+		return bytes;
+	}
+
+	this->make_host_room(size);
+	bytes->host_data = this->memory->allocate(size);
+	try {
+		this->memory->copy_to_host(bytes->host_data, device, size);
+	} catch(...) {
+		this->memory->deallocate(bytes->host_data);
+		bytes->host_data = nullptr;
+		throw;
+	}
+	this->host_bytes_list.push_back(bytes.get());
+	bytes->host_position = std::prev(this->host_bytes_list.end());
+	this->host_bytes += size;
+	return bytes;
+}
+
+void spill_manager::make_host_room(std::size_t size) {
+	while(this->host_bytes + size > this->host_limit && !this->host_bytes_list.empty()) {
+		spilled_bytes & oldest = *this->host_bytes_list.front();
+		this->write_to_disk(oldest, oldest.host_data, false);
+
+		this->host_bytes_list.pop_front();
+		this->memory->deallocate(oldest.host_data);
+		oldest.host_data = nullptr;
+		this->host_bytes -= oldest.num_bytes;
+	}
+}
+
+void spill_manager::write_to_disk(spilled_bytes & bytes, const void * data, bool on_device) {
+	if(!this->spill_directory_ready) {
+		if(!this->file_system_manager->exists(this->spill_directory)) {
+			this->file_system_manager->makeDirectory(this->spill_directory);
+		}
+		this->spill_directory_ready = true;
+	}
+
+	const std::string file = this->file_prefix + std::to_string(this->num_files++);
+	std::shared_ptr<arrow::io::OutputStream> stream =
+		this->file_system_manager->openWriteable(this->spill_directory + ("/" + file));
+	if(stream == nullptr) {
+		throw std::runtime_error("Could not open the spill file " + file + " in " + this->spill_directory.toString());
+	}
+
+	arrow::Status status;
+	if(on_device) {
+		host_buffer staging(*this->memory, std::min(bytes.num_bytes, STAGING_SIZE));
+		for(std::size_t offset = 0; offset < bytes.num_bytes && status.ok(); offset += STAGING_SIZE) {
+			const std::size_t chunk = std::min(bytes.num_bytes - offset, STAGING_SIZE);
+			this->memory->copy_to_host(staging.data, static_cast<const char *>(data) + offset, chunk);
+			status = stream->Write(staging.data, chunk);
+		}
+	} else {
+		status = stream->Write(data, bytes.num_bytes);
+	}
+	if(status.ok()) {
+		status = stream->Close();
+	}
+	if(!status.ok()) {
+		this->remove_file(file);
+		throw std::runtime_error("Could not write the spill file " + file + ": " + status.ToString());
+	}
+
+	bytes.file = file;
+	this->disk_bytes += bytes.num_bytes;
+	this->bytes_written_to_disk += bytes.num_bytes;
+}
+
+void spill_manager::read_from_disk(const spilled_bytes & bytes, void * device) const {
+	std::shared_ptr<arrow::io::RandomAccessFile> file =
+		this->file_system_manager->openReadable(this->spill_directory + ("/" + bytes.file));
+	if(file == nullptr) {
+		throw std::runtime_error("Could not open the spill file " + bytes.file);
+	}
+
+	host_buffer staging(*this->memory, std::min(bytes.num_bytes, STAGING_SIZE));
+	for(std::size_t offset = 0; offset < bytes.num_bytes;) {
+		const std::size_t chunk = std::min(bytes.num_bytes - offset, STAGING_SIZE);
+		int64_t bytes_read = 0;
+		arrow::Status status = file->ReadAt(offset, chunk, &bytes_read, staging.data);
+		if(!status.ok() || bytes_read <= 0) {
+			throw std::runtime_error("Could not read the spill file " + bytes.file + ": " + status.ToString());
+		}
+		this->memory->copy_to_device(static_cast<char *>(device) + offset, staging.data, bytes_read);
+		offset += bytes_read;
+	}
+	file->Close();
+}
+
+void spill_manager::remove_file(const std::string & file) const {
+	try {
+		this->file_system_manager->remove(this->spill_directory + ("/" + file));
+	} catch(const std::exception &) {
+		// a file left behind only takes disk space, it must not fail the query
+	}
+}
+
+std::shared_ptr<spillable_buffer> spillable_buffer::make(spill_manager & manager, void * device, std::size_t size) {
+	std::shared_ptr<spillable_buffer> buffer(new spillable_buffer(manager, device, size));
+	manager.add(buffer);
+	return buffer;
+}
+
+spillable_buffer::spillable_buffer(spill_manager & manager, void * device, std::size_t size)
+	: spillable(manager, size), device(device) {}
+
+spillable_buffer::~spillable_buffer() {
+	if(this->device != nullptr) {
+		cuDF::Allocator::deallocate(this->device);
+	}
+}
+
+void * spillable_buffer::take() {
+	this->take_back();
+	void * taken = this->device;
+	this->device = nullptr;
+	this->bytes.reset();
+	return taken;
+}
+
+void spillable_buffer::spill() {
+	this->bytes = this->copy_out(this->device, this->get_size());
+	cuDF::Allocator::deallocate(this->device);
+	this->device = nullptr;
+}
+
+void spillable_buffer::load() {
+	cuDF::Allocator::allocate(&this->device, this->get_size());
+	try {
+		this->bytes->copy_to_device(this->device);
+	} catch(...) {
+		cuDF::Allocator::deallocate(this->device);
+		this->device = nullptr;
+		throw;
+	}
+	this->bytes.reset();
+}
+
+}  // namespace spill
+}  // namespace ral
@@ -0,0 +1,238 @@
+/*
+ * SpillManager.h
+ *
+ * Moves the intermediate results of an operator out of device memory while the operator does not need them, so an
+ * input larger than the device can be processed a partition at a time. Spilled bytes go to pinned host memory first
+ * and, once the host memory set aside for spilling is used up, to files written through the FileSystemManager. They
+ * come back to device memory when the operator takes them.
+ */
+
+#ifndef SPILL_SPILLMANAGER_H_
+#define SPILL_SPILLMANAGER_H_
+
+#include <blazingdb/io/FileSystem/FileSystemManager.h>
+#include <blazingdb/io/FileSystem/Uri.h>
+#include <blazingdb/manager/MemoryTracker.h>
+#include <atomic>
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace ral {
+namespace spill {
+
+// Pinned host memory and the copies between it and device memory, replaced by plain host memory in tests
+class host_memory {
+public:
+	virtual ~host_memory() = default;
+
+	virtual void * allocate(std::size_t size) = 0;
+
+	virtual void deallocate(void * pointer) = 0;
+
+	virtual void copy_to_host(void * host, const void * device, std::size_t size) = 0;
+
+	virtual void copy_to_device(void * device, const void * host, std::size_t size) = 0;
+};
+
+void set_host_memory(std::shared_ptr<host_memory> memory);
+
+std::shared_ptr<host_memory> get_host_memory();
+
+// Pinned host memory every spill manager can hold before it writes to disk, 1GB by default
+void set_default_host_limit(std::size_t limit);
+
+std::size_t get_default_host_limit();
+
+// Where spilled bytes that do not fit in host memory are written, a local directory, /tmp by default
+void set_default_spill_directory(const std::string & directory);
+
+std::string get_default_spill_directory();
+
+// For an operator that needs working_set more bytes of device memory to run in memory: 0 when they fit in the budget
+// of the query, otherwise the device limit to process its input a partition at a time under, half of what is left of
+// the budget so the partition it works on has the other half
+std::size_t get_out_of_core_device_limit(const blazingdb::manager::MemoryTracker & tracker, std::size_t working_set);
+
+// Most partitions an operator cuts its input into out of core, every chunk of the input is split into that many pieces
+const std::size_t MAX_OUT_OF_CORE_PARTITIONS = 256;
+
+// Partitions to process input_size bytes in under device_limit when a partition takes twice its size while it is
+// worked on, at least 2 and at most MAX_OUT_OF_CORE_PARTITIONS. Once clamped a partition can go over the device limit
+// into the half of the budget left to the partition being worked on; throws cuDF::Allocator::QueryMemoryExceeded when
+// it does not fit in that either.
+std::size_t get_out_of_core_partitions(
+	std::size_t input_size, std::size_t device_limit, const std::string & operator_name);
+
+enum class location { device, host, disk };
+
+class spill_manager;
+
+// Bytes copied out of device memory, in pinned host memory of their manager or in a file once the manager ran out of
+// it. Only used under the lock of the manager.
+class spilled_bytes {
+public:
+	~spilled_bytes();
+
+	std::size_t size() const { return num_bytes; }
+
+	location get_location() const { return host_data != nullptr ? location::host : location::disk; }
+
+	void copy_to_device(void * device) const;
+
+	spilled_bytes(const spilled_bytes &) = delete;
+	spilled_bytes & operator=(const spilled_bytes &) = delete;
+
+private:
+	friend class spill_manager;
+
+	spilled_bytes(spill_manager & manager, std::size_t num_bytes);
+
+	spill_manager & manager;
+	std::size_t num_bytes;
+	void * host_data;
+	std::string file;									// set once on disk
+	std::list<spilled_bytes *>::iterator host_position;	// in the host list of the manager while in host memory
+};
+
+// Something holding device memory that its manager can move out while nobody uses it. Subclasses copy their device
+// memory out with copy_out and back with spilled_bytes::copy_to_device. The manager spills the oldest ones first when
+// it needs room.
+class spillable {
+public:
+	virtual ~spillable();
+
+	bool is_spilled() const;
+
+	// bytes of device memory it holds when on device
+	std::size_t get_size() const { return size; }
+
+	spillable(const spillable &) = delete;
+	spillable & operator=(const spillable &) = delete;
+
+protected:
+	spillable(spill_manager & manager, std::size_t size);
+
+	// Brings the device memory back if it was spilled, making room for it first, and stops managing it: the caller
+	// owns the device memory from then on. Subclasses call it before handing their device memory over.
+	void take_back();
+
+	// copies device memory out to host memory or disk, only from spill()
+	std::unique_ptr<spilled_bytes> copy_out(const void * device, std::size_t size);
+
+	// Copies the device memory out with copy_out and frees it, called with the lock of the manager held
+	virtual void spill() = 0;
+
+	// Allocates device memory and copies the spilled bytes back into it, called with the lock of the manager held
+	virtual void load() = 0;
+
+	spill_manager & manager;
+
+private:
+	friend class spill_manager;
+
+	const std::size_t size;
+	bool spilled = false;
+	bool managed = false;
+	std::list<std::weak_ptr<spillable>>::iterator position;	 // in the list of the manager while managed
+};
+
+// The spillables of an operator. Those on device are kept under a device limit by spilling the oldest ones, the bytes
+// spilled are kept under a host limit by writing the oldest ones to disk. Must outlive its spillables.
+class spill_manager {
+public:
+	spill_manager(std::size_t device_limit,
+		std::size_t host_limit = get_default_host_limit(),
+		const Uri & spill_directory = Uri(FileSystemType::LOCAL, "local", Path(get_default_spill_directory())),
+		std::shared_ptr<FileSystemManager> file_system_manager = nullptr);
+
+	~spill_manager();
+
+	// Starts managing a spillable that is on device, spilling older ones first when it does not fit
+	void add(const std::shared_ptr<spillable> & spillable);
+
+	std::size_t get_device_limit() const { return device_limit; }
+
+	// bytes of the spillables that are on device
+	std::size_t get_device_bytes() const;
+
+	std::size_t get_host_bytes() const;
+
+	std::size_t get_disk_bytes() const;
+
+	// bytes moved out of device memory and written to disk since the manager was created
+	std::size_t get_bytes_spilled() const { return bytes_spilled; }
+
+	std::size_t get_bytes_written_to_disk() const { return bytes_written_to_disk; }
+
+	spill_manager(const spill_manager &) = delete;
+	spill_manager & operator=(const spill_manager &) = delete;
+
+private:
+	friend class spilled_bytes;
+	friend class spillable;
+
+	// spills the oldest spillables on device until size more bytes fit in the device limit, or none is left
+	void make_room(std::size_t size);
+
+	std::unique_ptr<spilled_bytes> spill_bytes(const void * device, std::size_t size);
+
+	// writes the oldest spilled bytes in host memory to disk until size more bytes fit in the host limit
+	void make_host_room(std::size_t size);
+
+	// writes bytes from host memory, or from device memory through a small host buffer
+	void write_to_disk(spilled_bytes & bytes, const void * data, bool on_device);
+
+	void read_from_disk(const spilled_bytes & bytes, void * device) const;
+
+	void remove_file(const std::string & file) const;
+
+	const std::size_t device_limit;
+	const std::size_t host_limit;
+	const Uri spill_directory;
+	std::shared_ptr<FileSystemManager> file_system_manager;
+	const std::string file_prefix;	// unique to the manager
+	std::shared_ptr<host_memory> memory;
+
+	// spillables call back into the manager while it spills them
+	mutable std::recursive_mutex mutex;
+	std::list<std::weak_ptr<spillable>> spillables;	 // oldest first
+	std::list<spilled_bytes *> host_bytes_list;		 // oldest first
+	std::size_t device_bytes = 0;
+	std::size_t host_bytes = 0;
+	std::size_t disk_bytes = 0;
+	std::size_t num_files = 0;
+	bool spill_directory_ready = false;
+	std::atomic<std::size_t> bytes_spilled{0};
+	std::atomic<std::size_t> bytes_written_to_disk{0};
+};
+
+// Device memory allocated with cuDF::Allocator, spillable as it is
+class spillable_buffer : public spillable {
+public:
+	// takes over device memory allocated with cuDF::Allocator::allocate and adds it to the manager
+	static std::shared_ptr<spillable_buffer> make(spill_manager & manager, void * device, std::size_t size);
+
+	~spillable_buffer();
+
+	// Hands the device memory over, to be freed with cuDF::Allocator::deallocate. The buffer is empty afterwards.
+	void * take();
+
+protected:
+	void spill() override;
+
+	void load() override;
+
+private:
+	spillable_buffer(spill_manager & manager, void * device, std::size_t size);
+
+	void * device;
+	std::unique_ptr<spilled_bytes> bytes;
+};
+
+}  // namespace spill
+}  // namespace ral
+
+#endif /* SPILL_SPILLMANAGER_H_ */
@@ -0,0 +1,118 @@
+#include "SpillableTable.h"
+#include "Traits/RuntimeTraits.h"
+#include "cuDF/Allocator.h"
+#include <cudf.h>
+
+namespace ral {
+namespace spill {
+
+namespace {
+
+bool is_spillable(const gdf_column_cpp & column) {
+	return column.get_gdf_column() != nullptr && column.dtype() != GDF_STRING &&
+		   column.dtype() != GDF_STRING_CATEGORY;
+}
+
+std::size_t get_data_size(const gdf_column_cpp & column) {
+	return static_cast<std::size_t>(column.size()) * ral::traits::get_dtype_size_in_bytes(column.dtype());
+}
+
+std::size_t get_valid_size(const gdf_column_cpp & column) {
+	return column.valid() != nullptr ? gdf_valid_allocation_size(column.size()) : 0;
+}
+
+}  // namespace
+
+std::shared_ptr<spillable_table> spillable_table::make(
+	spill_manager & manager, const std::vector<gdf_column_cpp> & columns) {
+	std::shared_ptr<spillable_table> table(new spillable_table(manager, columns));
+	manager.add(table);
+	return table;
+}
+
+std::size_t spillable_table::get_device_size(const std::vector<gdf_column_cpp> & columns) {
+	std::size_t size = 0;
+	for(const gdf_column_cpp & column : columns) {
+		if(is_spillable(column)) {
+			size += get_data_size(column) + get_valid_size(column);
+		}
+	}
+	return size;
+}
+
+spillable_table::spillable_table(spill_manager & manager, const std::vector<gdf_column_cpp> & columns)
+	: spillable(manager, get_device_size(columns)), columns(columns), spilled_columns(columns.size()),
+	  num_rows(columns.empty() ? 0 : columns[0].size()) {}
+
+std::vector<gdf_column_cpp> spillable_table::take() {
+	this->take_back();
+	std::vector<gdf_column_cpp> taken;
+	taken.swap(this->columns);
+	this->spilled_columns.clear();
+	return taken;
+}
+
+void spillable_table::spill() {
+	for(std::size_t i = 0; i < this->columns.size(); i++) {
+		gdf_column_cpp & column = this->columns[i];
+		if(!is_spillable(column) || this->spilled_columns[i] != nullptr) {
+			continue;
+		}
+
+		std::unique_ptr<spilled_column> spilled(new spilled_column);
+		spilled->data = this->copy_out(column.data(), get_data_size(column));
+		if(column.valid() != nullptr) {
+			spilled->valid = this->copy_out(column.valid(), get_valid_size(column));
+		}
+		spilled->dtype = column.dtype();
+		spilled->dtype_info = column.dtype_info();
+		spilled->size = column.size();
+		spilled->null_count = column.get_gdf_column()->null_count;
+		spilled->name = column.name();
+
+		// dropping the only reference frees the device memory
+		column = gdf_column_cpp();
+		this->spilled_columns[i] = std::move(spilled);
+	}
+}
+
+void spillable_table::load() {
+	for(std::size_t i = 0; i < this->columns.size(); i++) {
+		// columns loaded before a load that failed are still on device
+		if(this->spilled_columns[i] == nullptr) {
+			continue;
+		}
+		const spilled_column & spilled = *this->spilled_columns[i];
+
+		void * data = nullptr;
+		gdf_valid_type * valid = nullptr;
+		try {
+			if(spilled.data->size() > 0) {
+				cuDF::Allocator::allocate(&data, spilled.data->size());
+				spilled.data->copy_to_device(data);
+			}
+			if(spilled.valid != nullptr) {
+				cuDF::Allocator::allocate(reinterpret_cast<void **>(&valid), spilled.valid->size());
+				spilled.valid->copy_to_device(valid);
+			}
+		} catch(...) {
+			if(data != nullptr) {
+				cuDF::Allocator::deallocate(data);
+			}
+			if(valid != nullptr) {
+				cuDF::Allocator::deallocate(valid);
+			}
+			throw;
+		}
+
+		gdf_column * column = new gdf_column{};
+		gdf_column_view_augmented(
+			column, data, valid, spilled.size, spilled.dtype, spilled.null_count, spilled.dtype_info, nullptr);
+		this->columns[i].create_gdf_column(column);
+		this->columns[i].set_name(spilled.name);
+		this->spilled_columns[i].reset();
+	}
+}
+
+}  // namespace spill
+}  // namespace ral
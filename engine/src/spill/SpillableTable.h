@@ -0,0 +1,61 @@
+/*
+ * SpillableTable.h
+ *
+ * A table an operator put aside while it works on other partitions, spilled column by column when its spill manager
+ * needs the device memory.
+ */
+
+#ifndef SPILL_SPILLABLETABLE_H_
+#define SPILL_SPILLABLETABLE_H_
+
+#include "GDFColumn.cuh"
+#include "spill/SpillManager.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ral {
+namespace spill {
+
+// Columns of fixed width types are spilled. String columns stay on device, their memory belongs to the NVCategory or
+// NVStrings and is not counted against the device limit.
+class spillable_table : public spillable {
+public:
+	// Adds the columns to the manager. They should not be referenced anywhere else, or spilling them frees nothing.
+	static std::shared_ptr<spillable_table> make(spill_manager & manager, const std::vector<gdf_column_cpp> & columns);
+
+	// bytes of device memory of the columns that can be spilled
+	static std::size_t get_device_size(const std::vector<gdf_column_cpp> & columns);
+
+	gdf_size_type get_num_rows() const { return num_rows; }
+
+	// Hands the columns over, loading them back first if they were spilled. The table is empty afterwards.
+	std::vector<gdf_column_cpp> take();
+
+protected:
+	void spill() override;
+
+	void load() override;
+
+private:
+	struct spilled_column {
+		std::unique_ptr<spilled_bytes> data;
+		std::unique_ptr<spilled_bytes> valid;
+		gdf_dtype dtype;
+		gdf_dtype_extra_info dtype_info;
+		gdf_size_type size;
+		gdf_size_type null_count;
+		std::string name;
+	};
+
+	spillable_table(spill_manager & manager, const std::vector<gdf_column_cpp> & columns);
+
+	std::vector<gdf_column_cpp> columns;
+	std::vector<std::unique_ptr<spilled_column>> spilled_columns;  // by column, empty for the ones on device
+	const gdf_size_type num_rows;
+};
+
+}  // namespace spill
+}  // namespace ral
+
+#endif /* SPILL_SPILLABLETABLE_H_ */
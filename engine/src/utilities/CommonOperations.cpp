@@ -3,7 +3,11 @@
 
 #include "CalciteExpressionParsing.h"
 #include "Traits/RuntimeTraits.h"
+#include "Utils.cuh"
+#include "cuDF/safe_nvcategory_gather.hpp"
+#include "cudf/legacy/copying.hpp"
 #include "cudf/legacy/unary.hpp"
+#include "utilities/RalColumn.h"
 #include <algorithm>
 #include <blazingdb/io/Library/Logging/Logger.h>
 #include <cudf/legacy/column.hpp>
@@ -154,5 +158,53 @@ std::vector<gdf_column_cpp> normalizeColumnTypes(std::vector<gdf_column_cpp> col
 	return columns_out;
 }
 
+std::vector<gdf_column_cpp> sliceTable(
+	const std::vector<gdf_column_cpp> & table, gdf_size_type start, gdf_size_type num_rows) {
+	std::vector<gdf_column_cpp> slice(table.size());
+	for(size_t i = 0; i < table.size(); i++) {
+		const gdf_column_cpp & col = table[i];
+		if(col.valid()) {
+			slice[i].create_gdf_column(col.dtype(),
+				col.dtype_info(),
+				num_rows,
+				nullptr,
+				ral::traits::get_dtype_size_in_bytes(col.dtype()),
+				col.name());
+		} else {
+			slice[i].create_gdf_column(col.dtype(),
+				col.dtype_info(),
+				num_rows,
+				nullptr,
+				nullptr,
+				ral::traits::get_dtype_size_in_bytes(col.dtype()),
+				col.name());
+		}
+	}
+	if(num_rows == 0) {
+		return slice;
+	}
+
+	gdf_column_cpp gatherMap;
+	gatherMap.create_gdf_column(GDF_INT32,
+		gdf_dtype_extra_info{TIME_UNIT_NONE, nullptr},
+		num_rows,
+		nullptr,
+		ral::traits::get_dtype_size_in_bytes(GDF_INT32),
+		"");
+	gdf_sequence(static_cast<int32_t *>(gatherMap.data()), num_rows, start, 1);
+
+	cudf::table srcTable = create_table(table);
+	cudf::table destTable = create_table(slice);
+	cudf::gather(&srcTable, static_cast<gdf_index_type *>(gatherMap.data()), &destTable);
+
+	for(size_t i = 0; i < slice.size(); i++) {
+		if(slice[i].dtype() == GDF_STRING_CATEGORY) {
+			ral::safe_nvcategory_gather_for_string_category(slice[i].get_gdf_column(), table[i].dtype_info().category);
+		}
+		slice[i].update_null_count();
+	}
+	return slice;
+}
+
 }  // namespace utilities
 }  // namespace ral
@@ -12,6 +12,10 @@ namespace utilities {
 std::vector<gdf_column_cpp> concatTables(const std::vector<std::vector<gdf_column_cpp>> & tables);
 std::vector<gdf_column_cpp> normalizeColumnTypes(std::vector<gdf_column_cpp> columns);
 
+// Copies num_rows rows of the table from start on, string categories get a category of their own
+std::vector<gdf_column_cpp> sliceTable(
+	const std::vector<gdf_column_cpp> & table, gdf_size_type start, gdf_size_type num_rows);
+
 
 }  // namespace utilities
 }  // namespace ral
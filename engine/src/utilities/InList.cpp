@@ -0,0 +1,168 @@
+#include "InList.h"
+
+#include "parser/expression_tree.hpp"
+#include <cerrno>
+#include <cstdlib>
+#include <map>
+
+namespace ral {
+namespace utilities {
+
+namespace {
+
+using ral::parser::operad_node;
+using ral::parser::parse_node;
+
+// Gets the column and literal out of =($n, literal) or =(literal, $n) for op, null literals are left out
+bool get_column_literal_comparison(
+	const parse_node * node, const std::string & op, std::string & column, std::string & literal) {
+	if(node->type != ral::parser::OPERATOR || node->value != op || node->children.size() != 2) {
+		return false;
+	}
+
+	const parse_node * left = node->children[0].get();
+	const parse_node * right = node->children[1].get();
+	if(left->type != ral::parser::OPERAND || right->type != ral::parser::OPERAND) {
+		return false;
+	}
+
+	if(is_var_column(left->value) && is_literal(right->value)) {
+		column = left->value;
+		literal = right->value;
+	} else if(is_var_column(right->value) && is_literal(left->value)) {
+		column = right->value;
+		literal = left->value;
+	} else {
+		return false;
+	}
+	return !is_null(literal);
+}
+
+bool rewrite_in_lists_helper(std::unique_ptr<parse_node> & node,
+	const std::function<std::string(const in_list &)> & evaluate,
+	std::size_t min_size) {
+	if(node->type != ral::parser::OPERATOR) {
+		return false;
+	}
+
+	bool rewritten = false;
+	for(auto && child : node->children) {
+		rewritten = rewrite_in_lists_helper(child, evaluate, min_size) || rewritten;
+	}
+
+	bool negated = node->value == "AND";
+	if(node->value != "OR" && !negated) {
+		return rewritten;
+	}
+
+	// children that compare a column against a literal, by column
+	std::map<std::string, std::vector<std::size_t>> children_by_column;
+	std::vector<std::string> literals(node->children.size());
+	for(std::size_t i = 0; i < node->children.size(); i++) {
+		std::string column;
+		if(get_column_literal_comparison(node->children[i].get(), negated ? "<>" : "=", column, literals[i])) {
+			children_by_column[column].push_back(i);
+		}
+	}
+
+	std::vector<bool> replaced(node->children.size(), false);
+	std::vector<std::unique_ptr<parse_node>> new_children;
+	for(auto && column_children : children_by_column) {
+		if(column_children.second.size() < min_size) {
+			continue;
+		}
+
+		in_list list{column_children.first, {}, negated};
+		list.literals.reserve(column_children.second.size());
+		for(std::size_t i : column_children.second) {
+			list.literals.push_back(literals[i]);
+		}
+
+		std::string operand = evaluate(list);
+		if(operand.empty()) {
+			continue;
+		}
+
+		for(std::size_t i : column_children.second) {
+			replaced[i] = true;
+		}
+		new_children.emplace_back(new operad_node(operand));
+	}
+
+	if(new_children.empty()) {
+		return rewritten;
+	}
+
+	for(std::size_t i = 0; i < node->children.size(); i++) {
+		if(!replaced[i]) {
+			new_children.push_back(std::move(node->children[i]));
+		}
+	}
+
+	if(new_children.size() == 1) {
+		node = std::move(new_children[0]);
+	} else {
+		node->children = std::move(new_children);
+	}
+	return true;
+}
+
+}  // namespace
+
+std::string rewrite_in_lists(const std::string & expression,
+	const std::function<std::string(const in_list &)> & evaluate,
+	std::size_t min_size) {
+	if(expression.find("OR(") == std::string::npos && expression.find("AND(") == std::string::npos) {
+		return expression;
+	}
+
+	ral::parser::parse_tree tree;
+	tree.build(expression);
+	if(!rewrite_in_lists_helper(tree.root, evaluate, min_size)) {
+		return expression;
+	}
+	return tree.rebuildExpression();
+}
+
+bool parse_integer_literal(const std::string & literal, int64_t & value) {
+	if(literal.empty()) {
+		return false;
+	}
+
+	char * end;
+	errno = 0;
+	value = std::strtoll(literal.c_str(), &end, 10);
+	return errno == 0 && *end == '\0';
+}
+
+bool parse_floating_literal(const std::string & literal, double & value) {
+	if(literal.empty()) {
+		return false;
+	}
+
+	char * end;
+	errno = 0;
+	value = std::strtod(literal.c_str(), &end);
+	return errno == 0 && *end == '\0';
+}
+
+bool parse_in_list_datetimes(const std::vector<std::string> & literals,
+	const std::function<int64_t(const std::string &)> & parse,
+	std::vector<int64_t> & values) {
+	values.clear();
+	values.reserve(literals.size());
+	for(const std::string & literal : literals) {
+		const std::string value = is_string(literal) ? literal.substr(1, literal.size() - 2) : literal;
+		if(!is_date(value) && !is_timestamp(value)) {
+			return false;
+		}
+		values.push_back(parse(value));
+	}
+
+	std::sort(values.begin(), values.end());
+	values.erase(std::unique(values.begin(), values.end()), values.end());
+	return true;
+}
+
+}  // namespace utilities
+}  // namespace ral
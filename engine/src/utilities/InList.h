@@ -0,0 +1,87 @@
+#ifndef _BLAZINGDB_RAL_IN_LIST_H
+#define _BLAZINGDB_RAL_IN_LIST_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace ral {
+namespace utilities {
+
+/**
+ * A SQL IN list as Calcite hands it out, OR(=($n, lit1), =($n, lit2), ...), or NOT IN as AND(<>($n, lit1), ...).
+ */
+struct in_list {
+	std::string column;					// the $n operand
+	std::vector<std::string> literals;  // as they appear in the expression, strings still quoted
+	bool negated;						// NOT IN
+};
+
+// Shorter lists are cheaper to evaluate as comparisons inside the interpreter kernel
+const std::size_t MIN_IN_LIST_SIZE = 8;
+
+/**
+ * Finds every IN list with at least min_size literals on the same column and replaces it with the operand returned
+ * by evaluate, i.e. the $n of a precomputed boolean column. evaluate returns an empty string to leave a list as it
+ * is. Comparisons on other columns or with a null literal stay in the expression. The expression must already have
+ * gone through replace_calcite_regex, it is returned unchanged when there is nothing to replace.
+ */
+std::string rewrite_in_lists(const std::string & expression,
+	const std::function<std::string(const in_list &)> & evaluate,
+	std::size_t min_size = MIN_IN_LIST_SIZE);
+
+bool parse_integer_literal(const std::string & literal, int64_t & value);
+
+bool parse_floating_literal(const std::string & literal, double & value);
+
+/**
+ * Parses the literals of a list once into sorted and unique values of the column type, ready for a binary search.
+ * Integers that do not fit in T can never match and are dropped. Returns false if some literal is not a number of
+ * the right kind, i.e. 1.5 for an integer column.
+ */
+template <typename T>
+bool parse_in_list_values(const std::vector<std::string> & literals, std::vector<T> & values) {
+	values.clear();
+	values.reserve(literals.size());
+	for(const std::string & literal : literals) {
+		if(std::is_integral<T>::value) {
+			int64_t value;
+			if(!parse_integer_literal(literal, value)) {
+				return false;
+			}
+			if(value < static_cast<int64_t>(std::numeric_limits<T>::min()) ||
+				value > static_cast<int64_t>(std::numeric_limits<T>::max())) {
+				continue;
+			}
+			values.push_back(static_cast<T>(value));
+		} else {
+			double value;
+			if(!parse_floating_literal(literal, value)) {
+				return false;
+			}
+			values.push_back(static_cast<T>(value));
+		}
+	}
+
+	std::sort(values.begin(), values.end());
+	values.erase(std::unique(values.begin(), values.end()), values.end());
+	return true;
+}
+
+/**
+ * Parses the date and timestamp literals of a list once with parse, into sorted and unique values. The literals may
+ * still be quoted, as the timestamps of a filter are. Returns false if some literal is not a date or a timestamp.
+ */
+bool parse_in_list_datetimes(const std::vector<std::string> & literals,
+	const std::function<int64_t(const std::string &)> & parse,
+	std::vector<int64_t> & values);
+
+}  // namespace utilities
+}  // namespace ral
+
+#endif  //_BLAZINGDB_RAL_IN_LIST_H
@@ -0,0 +1,186 @@
+#include "LikePattern.h"
+
+#include <cstring>
+
+namespace ral {
+namespace utilities {
+
+namespace {
+
+void append_literal(std::vector<like_token> & tokens, char c) {
+	if(tokens.empty() || tokens.back().kind != like_token_kind::LITERAL) {
+		tokens.push_back({like_token_kind::LITERAL, ""});
+	}
+	tokens.back().text += c;
+}
+
+std::string escape_regex_literal(const std::string & literal) {
+	static const std::string regex_meta_chars = "\\^$.|?*+()[]{}";
+
+	std::string escaped;
+	escaped.reserve(literal.size() * 2);
+	for(char c : literal) {
+		if(regex_meta_chars.find(c) != std::string::npos) {
+			escaped += '\\';
+		}
+		escaped += c;
+	}
+	return escaped;
+}
+
+std::string build_regex(const std::vector<like_token> & tokens) {
+	if(tokens.empty()) {
+		return "^$";
+	}
+
+	std::string re = tokens.front().kind == like_token_kind::ANY_STRING ? "" : "^";
+	for(std::size_t i = 0; i < tokens.size(); i++) {
+		switch(tokens[i].kind) {
+		case like_token_kind::LITERAL: re += escape_regex_literal(tokens[i].text); break;
+		case like_token_kind::ANY_CHAR: re += "."; break;
+		case like_token_kind::ANY_STRING:
+			// leading and trailing '%' are expressed by leaving the regex unanchored
+			if(i != 0 && i != tokens.size() - 1) {
+				re += ".*";
+			}
+			break;
+		}
+	}
+	if(tokens.back().kind != like_token_kind::ANY_STRING) {
+		re += "$";
+	}
+	return re;
+}
+
+like_pattern_kind classify(const std::vector<like_token> & tokens, std::string & literal) {
+	auto is = [&tokens](std::size_t i, like_token_kind kind) { return tokens[i].kind == kind; };
+
+	switch(tokens.size()) {
+	case 0: literal = ""; return like_pattern_kind::EXACT;
+	case 1:
+		if(is(0, like_token_kind::ANY_STRING)) {
+			return like_pattern_kind::MATCH_ALL;
+		}
+		if(is(0, like_token_kind::LITERAL)) {
+			literal = tokens[0].text;
+			return like_pattern_kind::EXACT;
+		}
+		break;
+	case 2:
+		if(is(0, like_token_kind::LITERAL) && is(1, like_token_kind::ANY_STRING)) {
+			literal = tokens[0].text;
+			return like_pattern_kind::PREFIX;
+		}
+		if(is(0, like_token_kind::ANY_STRING) && is(1, like_token_kind::LITERAL)) {
+			literal = tokens[1].text;
+			return like_pattern_kind::SUFFIX;
+		}
+		break;
+	case 3:
+		if(is(0, like_token_kind::ANY_STRING) && is(1, like_token_kind::LITERAL) &&
+			is(2, like_token_kind::ANY_STRING)) {
+			literal = tokens[1].text;
+			return like_pattern_kind::CONTAINS;
+		}
+		break;
+	}
+	return like_pattern_kind::REGEX;
+}
+
+// Wildcard matching with backtracking to the last '%', every other token has a fixed width
+bool match_tokens(const std::vector<like_token> & tokens, const char * str, std::size_t length) {
+	const std::size_t npos = static_cast<std::size_t>(-1);
+	std::size_t token_ind = 0;
+	std::size_t pos = 0;
+	std::size_t star_token_ind = npos;
+	std::size_t star_pos = 0;
+
+	while(token_ind < tokens.size() || pos < length) {
+		if(token_ind < tokens.size()) {
+			const like_token & token = tokens[token_ind];
+			if(token.kind == like_token_kind::ANY_STRING) {
+				star_token_ind = token_ind;
+				star_pos = pos;
+				token_ind++;
+				continue;
+			}
+			if(token.kind == like_token_kind::ANY_CHAR && pos < length) {
+				pos++;
+				token_ind++;
+				continue;
+			}
+			if(token.kind == like_token_kind::LITERAL && pos + token.text.size() <= length &&
+				std::memcmp(str + pos, token.text.data(), token.text.size()) == 0) {
+				pos += token.text.size();
+				token_ind++;
+				continue;
+			}
+		}
+		if(star_token_ind != npos && star_pos < length) {
+			star_pos++;
+			pos = star_pos;
+			token_ind = star_token_ind + 1;
+			continue;
+		}
+		return false;
+	}
+	return true;
+}
+
+}  // namespace
+
+bool like_pattern::matches(const char * str, std::size_t length) const {
+	switch(kind) {
+	case like_pattern_kind::MATCH_ALL: return true;
+	case like_pattern_kind::EXACT:
+		return length == literal.size() && std::memcmp(str, literal.data(), length) == 0;
+	case like_pattern_kind::PREFIX:
+		return length >= literal.size() && std::memcmp(str, literal.data(), literal.size()) == 0;
+	case like_pattern_kind::SUFFIX:
+		return length >= literal.size() &&
+			   std::memcmp(str + length - literal.size(), literal.data(), literal.size()) == 0;
+	case like_pattern_kind::CONTAINS:
+		return literal.empty() || memmem(str, length, literal.data(), literal.size()) != nullptr;
+	case like_pattern_kind::REGEX: return match_tokens(tokens, str, length);
+	}
+	return false;
+}
+
+like_pattern compile_like_pattern(const std::string & like_exp, char escape) {
+	like_pattern pattern;
+
+	for(std::size_t i = 0; i < like_exp.size(); i++) {
+		char c = like_exp[i];
+		if(c == escape && i + 1 < like_exp.size()) {
+			append_literal(pattern.tokens, like_exp[++i]);
+		} else if(c == '%') {
+			if(pattern.tokens.empty() || pattern.tokens.back().kind != like_token_kind::ANY_STRING) {
+				pattern.tokens.push_back({like_token_kind::ANY_STRING, ""});
+			}
+		} else if(c == '_') {
+			pattern.tokens.push_back({like_token_kind::ANY_CHAR, ""});
+		} else {
+			append_literal(pattern.tokens, c);
+		}
+	}
+
+	pattern.kind = classify(pattern.tokens, pattern.literal);
+	pattern.regex = build_regex(pattern.tokens);
+
+	return pattern;
+}
+
+std::string like_pattern_kind_to_string(like_pattern_kind kind) {
+	switch(kind) {
+	case like_pattern_kind::MATCH_ALL: return "MATCH_ALL";
+	case like_pattern_kind::EXACT: return "EXACT";
+	case like_pattern_kind::PREFIX: return "PREFIX";
+	case like_pattern_kind::SUFFIX: return "SUFFIX";
+	case like_pattern_kind::CONTAINS: return "CONTAINS";
+	case like_pattern_kind::REGEX: return "REGEX";
+	}
+	return "";
+}
+
+}  // namespace utilities
+}  // namespace ral
@@ -0,0 +1,58 @@
+#ifndef _BLAZINGDB_RAL_LIKE_PATTERN_H
+#define _BLAZINGDB_RAL_LIKE_PATTERN_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace ral {
+namespace utilities {
+
+/**
+ * Shape of a compiled SQL LIKE pattern. Everything except REGEX can be answered with a plain
+ * prefix, suffix or substring search, so the regex engine is only used as a fallback.
+ */
+enum class like_pattern_kind {
+	MATCH_ALL,  // '%'
+	EXACT,		// 'abc'
+	PREFIX,		// 'abc%'
+	SUFFIX,		// '%abc'
+	CONTAINS,	// '%abc%'
+	REGEX		// anything else, i.e. '_' wildcards or several literal segments
+};
+
+enum class like_token_kind { LITERAL, ANY_CHAR, ANY_STRING };
+
+struct like_token {
+	like_token_kind kind;
+	std::string text;  // only used by LITERAL tokens, already unescaped
+};
+
+struct like_pattern {
+	like_pattern_kind kind;
+
+	// unescaped literal to search for, meaningful for EXACT, PREFIX, SUFFIX and CONTAINS
+	std::string literal;
+
+	// equivalent anchored regex, always filled so any caller can fall back to it
+	std::string regex;
+
+	// consecutive literals merged and consecutive '%' collapsed
+	std::vector<like_token> tokens;
+
+	bool matches(const char * str, std::size_t length) const;
+	bool matches(const std::string & str) const { return matches(str.data(), str.size()); }
+};
+
+/**
+ * Parses a SQL LIKE pattern where '%' matches any sequence, '_' matches any single character and
+ * the escape character makes the next character a literal.
+ */
+like_pattern compile_like_pattern(const std::string & like_exp, char escape = '\\');
+
+std::string like_pattern_kind_to_string(like_pattern_kind kind);
+
+}  // namespace utilities
+}  // namespace ral
+
+#endif  //_BLAZINGDB_RAL_LIKE_PATTERN_H
@@ -152,6 +152,110 @@ LogicalProject(z=[$2])\n\
   }
 }
 
+TEST_F(calcite_interpreter_TEST, where_chained_filters) {
+
+  { // select x + y from (select x, y from hr.emps where y > 5) where x > 10
+    std::string query = "\
+LogicalProject(EXPR$0=[+($0, $1)])\n\
+  LogicalFilter(condition=[>($0, 10)])\n\
+    LogicalProject(x=[$0], y=[$1])\n\
+      LogicalFilter(condition=[>($1, 5)])\n\
+        LogicalTableScan(table=[[hr, emps]])";
+
+    gdf_error err =
+        evaluate_query(input_tables, table_names, column_names, query, outputs);
+    EXPECT_TRUE(err == GDF_SUCCESS);
+    EXPECT_TRUE(outputs.size() == 1);
+
+    int cur = 0;
+    int32_t *host_output = new int32_t[num_values];
+    for (std::size_t i = 0; i < num_values; i++) {
+      if (input2[i] > 5 && input1[i] > 10) {
+        host_output[cur] = input1[i] + input2[i];
+        cur++;
+      }
+    }
+
+    EXPECT_EQ(outputs[0].size(), cur);
+    Check(outputs[0], host_output, cur);
+  }
+}
+
+TEST_F(calcite_interpreter_TEST, wide_projection_split_in_passes) {
+
+  { // select x + y + 0, x + y + 1, ... x + y + 69 from hr.emps
+    const int num_expressions = 70;
+    std::string query = "LogicalProject(";
+    for (int i = 0; i < num_expressions; i++) {
+      query += (i > 0 ? ", " : "") + std::string("EXPR$") + std::to_string(i) +
+               "=[+(+($0, $1), " + std::to_string(i) + ")]";
+    }
+    query += ")\n\
+  LogicalTableScan(table=[[hr, emps]])";
+
+    // two inputs, one temp and one register per output do not fit 70 outputs in a single kernel
+    blazing_frame bz_frame;
+    bz_frame.add_table(input_tables[0]);
+    project_plan_params params = parse_project_plan(bz_frame, StringUtil::split(query, "\n")[0]);
+    EXPECT_EQ(params.num_expressions_out, num_expressions);
+    EXPECT_EQ(params.passes.size(), 2);
+
+    gdf_error err =
+        evaluate_query(input_tables, table_names, column_names, query, outputs);
+    EXPECT_TRUE(err == GDF_SUCCESS);
+    EXPECT_EQ(outputs.size(), num_expressions);
+
+    int32_t *host_output = new int32_t[num_values];
+    for (int expression = 0; expression < num_expressions; expression++) {
+      for (std::size_t i = 0; i < num_values; i++) {
+        host_output[i] = input1[i] + input2[i] + expression;
+      }
+      Check(outputs[expression], host_output);
+    }
+  }
+}
+
+TEST_F(calcite_interpreter_TEST, where_in_list) {
+
+  { // select z from hr.emps where x in (0, 2, 4, ... 38) and y > 5
+    const int num_literals = 20;
+    std::string in_list = "OR(";
+    for (int i = 0; i < num_literals; i++) {
+      in_list += (i > 0 ? ", =($0, " : "=($0, ") + std::to_string(2 * i) + ")";
+    }
+    in_list += ")";
+    std::string query = "\
+LogicalProject(z=[$2])\n\
+  LogicalFilter(condition=[AND(" + in_list + ", >($1, 5))])\n\
+    LogicalTableScan(table=[[hr, emps]])";
+
+    // the list is evaluated as one boolean column instead of twenty comparisons
+    blazing_frame bz_frame;
+    bz_frame.add_table(input_tables[0]);
+    size_t num_columns = bz_frame.get_size_column();
+    EXPECT_EQ(evaluate_in_lists(bz_frame, "AND(" + in_list + ", >($1, 5))"),
+              "AND($" + std::to_string(num_columns) + ", >($1, 5))");
+    EXPECT_EQ(bz_frame.get_size_column(), num_columns + 1);
+
+    gdf_error err =
+        evaluate_query(input_tables, table_names, column_names, query, outputs);
+    EXPECT_TRUE(err == GDF_SUCCESS);
+    EXPECT_TRUE(outputs.size() == 1);
+
+    int cur = 0;
+    int32_t *host_output = new int32_t[num_values];
+    for (std::size_t i = 0; i < num_values; i++) {
+      if (input1[i] >= 0 && input1[i] < 2 * num_literals && input1[i] % 2 == 0 && input2[i] > 5) {
+        host_output[cur] = input3[i];
+        cur++;
+      }
+    }
+
+    EXPECT_EQ(outputs[0].size(), cur);
+    Check(outputs[0], host_output, cur);
+  }
+}
+
 // ToDo: fix both literals returns invalid_api_call
 TEST_F(calcite_interpreter_TEST, DISABLED_processing_project51) {
 
@@ -75,6 +75,37 @@ TEST_F(GdfColumnCppTest, AssignOperatorInGdfCounter) {
   ASSERT_TRUE(counter_instance->contains_column(gdf_col_3) == false);
 }
 
+TEST_F(GdfColumnCppTest, DeregisteredColumnOutlivesItsReferences) {
+  gdf_column *gdf_col{};
+  ASSERT_EQ(counter_instance->get_map_size(), 0);
+
+  {
+    gdf_column_cpp cpp_col_1;
+    gdf_dtype_extra_info extra_info{TIME_UNIT_NONE};
+    cpp_col_1.create_gdf_column(GDF_INT32, extra_info, 16, nullptr, 4, "sample");
+    gdf_col = cpp_col_1.get_gdf_column();
+
+    gdf_column_cpp cpp_col_2 = cpp_col_1;
+    ASSERT_EQ(counter_instance->column_ref_value(gdf_col), 2);
+
+    // wrapping the same gdf_column again shares its references
+    gdf_column_cpp cpp_col_3;
+    cpp_col_3.create_gdf_column(gdf_col);
+    ASSERT_EQ(counter_instance->column_ref_value(gdf_col), 3);
+
+    counter_instance->deregister_column(gdf_col);
+    ASSERT_EQ(counter_instance->column_ref_value(gdf_col), 0);
+    ASSERT_TRUE(counter_instance->contains_column(gdf_col));
+  }
+
+  // the references are gone but the column belongs to whoever deregistered it
+  ASSERT_EQ(counter_instance->get_map_size(), 1);
+  ASSERT_TRUE(counter_instance->contains_column(gdf_col));
+
+  counter_instance->free(gdf_col);
+  ASSERT_EQ(counter_instance->get_map_size(), 0);
+}
+
 // void gdf_column_cpp::create_gdf_column(gdf_dtype type,
 //                                        size_t num_values,
 //                                        void * input_data,
@@ -0,0 +1,98 @@
+#include "utilities/InList.h"
+#include <gtest/gtest.h>
+
+using namespace ral::utilities;
+
+struct InListTest : public ::testing::Test {
+	InListTest() {}
+
+	~InListTest() {}
+
+	// OR(=($column, 0), =($column, 1), ...)
+	std::string make_in_list(const std::string & column, int num_literals) {
+		std::string expression = "OR(";
+		for(int i = 0; i < num_literals; i++) {
+			expression += (i > 0 ? ", =(" : "=(") + column + ", " + std::to_string(i) + ")";
+		}
+		return expression + ")";
+	}
+};
+
+TEST_F(InListTest, rewrite_whole_list) {
+	std::vector<in_list> lists;
+	std::string rewritten = rewrite_in_lists(make_in_list("$2", 10), [&lists](const in_list & list) {
+		lists.push_back(list);
+		return std::string("$5");
+	});
+
+	EXPECT_EQ(rewritten, "$5");
+	ASSERT_EQ(lists.size(), 1);
+	EXPECT_EQ(lists[0].column, "$2");
+	EXPECT_FALSE(lists[0].negated);
+	ASSERT_EQ(lists[0].literals.size(), 10);
+	EXPECT_EQ(lists[0].literals[0], "0");
+	EXPECT_EQ(lists[0].literals[9], "9");
+}
+
+TEST_F(InListTest, rewrite_keeps_other_operands) {
+	// a short list, a comparison on another column and a null literal stay as they are
+	std::string expression = "AND(>($1, 3), " + make_in_list("$0", 3) + ", OR(=($0, null), =('a', $3), =('b', $3), =('c', $3)))";
+	std::string rewritten = rewrite_in_lists(
+		expression, [](const in_list & list) { return std::string("$9"); }, 3);
+	EXPECT_EQ(rewritten, "AND(>($1, 3), $9, OR($9, =($0, null)))");
+
+	std::string not_in = "AND(<>($4, 'a'), <>($4, 'b'), <>($4, 'c'), >($1, 3))";
+	bool negated = false;
+	rewritten = rewrite_in_lists(
+		not_in,
+		[&negated](const in_list & list) {
+			negated = list.negated;
+			return std::string("$7");
+		},
+		3);
+	EXPECT_EQ(rewritten, "AND($7, >($1, 3))");
+	EXPECT_TRUE(negated);
+}
+
+TEST_F(InListTest, rewrite_declined) {
+	std::string expression = make_in_list("$0", 20);
+	EXPECT_EQ(rewrite_in_lists(expression, [](const in_list & list) { return std::string(); }), expression);
+	EXPECT_EQ(rewrite_in_lists(make_in_list("$0", 2), [](const in_list & list) { return std::string("$1"); }),
+		make_in_list("$0", 2));
+	EXPECT_EQ(rewrite_in_lists("+($0, $1)", [](const in_list & list) { return std::string("$1"); }), "+($0, $1)");
+}
+
+TEST_F(InListTest, parse_values) {
+	std::vector<int32_t> ints;
+	EXPECT_TRUE(parse_in_list_values<int32_t>({"7", "-3", "7", "10000000000", "+2"}, ints));
+	EXPECT_EQ(ints, (std::vector<int32_t>{-3, 2, 7}));
+
+	std::vector<int8_t> bytes;
+	EXPECT_TRUE(parse_in_list_values<int8_t>({"1", "300"}, bytes));
+	EXPECT_EQ(bytes, (std::vector<int8_t>{1}));
+
+	EXPECT_FALSE(parse_in_list_values<int32_t>({"1", "1.5"}, ints));
+	EXPECT_FALSE(parse_in_list_values<int32_t>({"'1'"}, ints));
+
+	std::vector<double> doubles;
+	EXPECT_TRUE(parse_in_list_values<double>({"1.5", "1", "-2e3"}, doubles));
+	EXPECT_EQ(doubles, (std::vector<double>{-2000.0, 1.0, 1.5}));
+	EXPECT_FALSE(parse_in_list_values<double>({"2019-01-01"}, doubles));
+}
+
+TEST_F(InListTest, parse_datetimes) {
+	std::vector<std::string> parsed;
+	auto parse = [&parsed](const std::string & literal) {
+		parsed.push_back(literal);
+		return static_cast<int64_t>(std::stoll(literal.substr(8, 2)));
+	};
+
+	std::vector<int64_t> values;
+	EXPECT_TRUE(parse_in_list_datetimes({"2019-01-03", "'2019-01-01 10:00:00'", "2019-01-03"}, parse, values));
+	EXPECT_EQ(values, (std::vector<int64_t>{1, 3}));
+	// every literal is parsed once, without its quotes
+	EXPECT_EQ(parsed, (std::vector<std::string>{"2019-01-03", "2019-01-01 10:00:00", "2019-01-03"}));
+
+	EXPECT_FALSE(parse_in_list_datetimes({"2019-01-01", "7"}, parse, values));
+	EXPECT_FALSE(parse_in_list_datetimes({"'a'"}, parse, values));
+}
@@ -0,0 +1,130 @@
+#include "Interpreter/interpreter_valids.h"
+#include <cstdlib>
+#include <gtest/gtest.h>
+#include <vector>
+
+struct InterpreterValidsTest : public ::testing::Test {
+	InterpreterValidsTest() {}
+
+	~InterpreterValidsTest() {}
+
+	gdf_column make_column(std::vector<int64_t> & valid, gdf_size_type null_count) {
+		gdf_column column{};
+		column.valid = valid.empty() ? nullptr : reinterpret_cast<gdf_valid_type *>(valid.data());
+		column.size = valid.size() * 64;
+		column.null_count = null_count;
+		return column;
+	}
+};
+
+// ($0 + $1) * $2 into register 3, with register 4 as temp
+struct arithmetic_plan {
+	std::vector<column_index_type> left_inputs = {0, 4};
+	std::vector<column_index_type> right_inputs = {1, 2};
+	std::vector<column_index_type> outputs = {4, 3};
+	std::vector<gdf_binary_operator_exp> operators = {BLZ_ADD, BLZ_MUL};
+	std::vector<gdf_unary_operator> unary_operators = {BLZ_INVALID_UNARY, BLZ_INVALID_UNARY};
+};
+
+TEST_F(InterpreterValidsTest, all_valid_when_inputs_have_no_nulls) {
+	std::vector<int64_t> nullable = {-1};
+	std::vector<int64_t> no_valid;
+	gdf_column a = make_column(nullable, 0);
+	gdf_column b = make_column(no_valid, 0);
+	gdf_column c = make_column(nullable, 0);
+	arithmetic_plan plan;
+
+	EXPECT_EQ(get_interpreter_valid_mode(
+				  {&a, &b, &c}, plan.left_inputs, plan.right_inputs, plan.operators, plan.unary_operators),
+		interpreter_valid_mode::ALL_VALID);
+
+	// the placeholder operand of a string function is not a null literal
+	std::vector<column_index_type> left_inputs = {0};
+	std::vector<column_index_type> right_inputs = {-3};
+	std::vector<gdf_binary_operator_exp> operators = {BLZ_STR_LIKE};
+	std::vector<gdf_unary_operator> unary_operators = {BLZ_INVALID_UNARY};
+	EXPECT_EQ(get_interpreter_valid_mode({&a}, left_inputs, right_inputs, operators, unary_operators),
+		interpreter_valid_mode::ALL_VALID);
+}
+
+TEST_F(InterpreterValidsTest, wordwise_and_per_row_modes) {
+	std::vector<int64_t> nullable = {0x0F};
+	gdf_column a = make_column(nullable, 60);
+	gdf_column b = make_column(nullable, 0);
+	gdf_column c = make_column(nullable, 0);
+	arithmetic_plan plan;
+
+	EXPECT_EQ(get_interpreter_valid_mode(
+				  {&a, &b, &c}, plan.left_inputs, plan.right_inputs, plan.operators, plan.unary_operators),
+		interpreter_valid_mode::WORDWISE);
+
+	// a null literal makes outputs null even when the columns have no nulls
+	std::vector<column_index_type> left_inputs = {-3};
+	std::vector<column_index_type> right_inputs = {1};
+	std::vector<gdf_binary_operator_exp> operators = {BLZ_ADD};
+	std::vector<gdf_unary_operator> unary_operators = {BLZ_INVALID_UNARY};
+	EXPECT_EQ(get_interpreter_valid_mode({&b, &c}, left_inputs, right_inputs, operators, unary_operators),
+		interpreter_valid_mode::WORDWISE);
+
+	operators = {BLZ_COALESCE};
+	left_inputs = {0};
+	EXPECT_EQ(get_interpreter_valid_mode({&a, &b}, left_inputs, right_inputs, operators, unary_operators),
+		interpreter_valid_mode::PER_ROW);
+
+	operators = {BLZ_INVALID_BINARY};
+	right_inputs = {-1};
+	unary_operators = {BLZ_IS_NULL};
+	EXPECT_EQ(get_interpreter_valid_mode({&a}, left_inputs, right_inputs, operators, unary_operators),
+		interpreter_valid_mode::PER_ROW);
+}
+
+TEST_F(InterpreterValidsTest, combine_valid_words) {
+	int64_t left = 0x00FF00FF00FF00FFll;
+	int64_t right = 0x0F0F0F0F0F0F0F0Fll;
+
+	EXPECT_EQ(combine_valid_words(BLZ_ADD, BLZ_INVALID_UNARY, left, right), left & right);
+	EXPECT_EQ(combine_valid_words(BLZ_GREATER, BLZ_INVALID_UNARY, left, right), left & right);
+	EXPECT_EQ(combine_valid_words(BLZ_COALESCE, BLZ_INVALID_UNARY, left, right), left | right);
+	EXPECT_EQ(combine_valid_words(BLZ_STR_LIKE, BLZ_INVALID_UNARY, left, 0), left);
+	EXPECT_EQ(combine_valid_words(BLZ_INVALID_BINARY, BLZ_SIN, left, -1), left);
+	EXPECT_EQ(combine_valid_words(BLZ_INVALID_BINARY, BLZ_IS_NULL, left, -1), -1);
+
+	int64_t valid_words[] = {left};
+	EXPECT_EQ(get_operand_valid_word(valid_words, 0), left);
+	EXPECT_EQ(get_operand_valid_word(valid_words, -2), -1);
+	EXPECT_EQ(get_operand_valid_word(valid_words, -3), 0);
+}
+
+TEST_F(InterpreterValidsTest, wordwise_matches_per_row) {
+	// ($0 + $1) * $2 and $0 + 5 into registers 3 and 4, with register 5 as temp
+	std::vector<column_index_type> left_inputs = {0, 5, 0};
+	std::vector<column_index_type> right_inputs = {1, 2, -2};
+	std::vector<column_index_type> outputs = {5, 3, 4};
+	std::vector<gdf_binary_operator_exp> operators = {BLZ_ADD, BLZ_MUL, BLZ_ADD};
+	std::vector<gdf_unary_operator> unary_operators = {BLZ_INVALID_UNARY, BLZ_INVALID_UNARY, BLZ_INVALID_UNARY};
+
+	std::srand(7);
+	for(int block = 0; block < 100; block++) {
+		int64_t valid_words[6];
+		for(int input = 0; input < 3; input++) {
+			valid_words[input] = (static_cast<int64_t>(std::rand()) << 32) ^ std::rand();
+		}
+
+		std::vector<int64_t> inputs(valid_words, valid_words + 3);
+		process_valid_words(operators.size(),
+			left_inputs.data(),
+			right_inputs.data(),
+			outputs.data(),
+			operators.data(),
+			unary_operators.data(),
+			valid_words);
+
+		for(int row = 0; row < 64; row++) {
+			bool a = (inputs[0] >> row) & 1;
+			bool b = (inputs[1] >> row) & 1;
+			bool c = (inputs[2] >> row) & 1;
+			EXPECT_EQ(static_cast<bool>((valid_words[3] >> row) & 1), a && b && c);
+			EXPECT_EQ(static_cast<bool>((valid_words[4] >> row) & 1), a);
+		}
+	}
+}
@@ -112,24 +112,15 @@ TEST_F(EvaluateQueryTest, TEST_01)
     //perform operations
     if (params.num_expressions_out > 0)
     {
-        perform_operation(params.output_columns,
-                                params.input_columns,
-                                params.left_inputs,
-                                params.right_inputs,
-                                params.outputs,
-                                params.final_output_positions,
-                                params.operators,
-                                params.unary_operators,
-                                params.left_scalars,
-                                params.right_scalars,
-                                params.new_column_indices);
+        perform_project_plan(params);
     }
 
     //params.output_columns
     std::vector<gdf_column_cpp> output_columns_cpp;
 
     std::cout<< "interops_solution\n";
-    for (gdf_column *col : params.output_columns)
+    for (auto &pass : params.passes)
+    for (gdf_column *col : pass.output_columns)
     {
         gdf_column_cpp gdf_col;
         print_gdf_column(col);
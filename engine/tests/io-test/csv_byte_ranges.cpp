@@ -0,0 +1,237 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <arrow/io/file.h>
+
+#include "io/data_parser/CSVByteRanges.h"
+#include "io/data_parser/RowGroupDecoder.h"
+
+namespace {
+
+using csv_rows = std::vector<std::vector<std::string>>;
+
+// what a csv reader that honors quotes makes of the bytes of a range
+csv_rows parse_on_host(const std::string & text, char quotechar = '"') {
+	csv_rows rows;
+	std::vector<std::string> row;
+	std::string field;
+	bool quoted = false;
+	bool row_started = false;
+	for(size_t i = 0; i < text.size(); i++) {
+		const char c = text[i];
+		row_started = true;
+		if(quoted) {
+			if(c == quotechar && i + 1 < text.size() && text[i + 1] == quotechar) {
+				field.push_back(c);
+				i++;
+			} else if(c == quotechar) {
+				quoted = false;
+			} else {
+				field.push_back(c);
+			}
+		} else if(c == quotechar && quotechar != '\0') {
+			quoted = true;
+		} else if(c == ',') {
+			row.push_back(field);
+			field.clear();
+		} else if(c == '\n') {
+			if(!field.empty() && field.back() == '\r') {
+				field.pop_back();
+			}
+			row.push_back(field);
+			rows.push_back(row);
+			row.clear();
+			field.clear();
+			row_started = false;
+		} else {
+			field.push_back(c);
+		}
+	}
+	if(row_started) {
+		row.push_back(field);
+		rows.push_back(row);
+	}
+	return rows;
+}
+
+}  // namespace
+
+struct CSVByteRangesTest : public ::testing::Test {
+	CSVByteRangesTest() : filename("/tmp/csv_byte_ranges_test.csv") {}
+
+	void TearDown() { std::remove(filename.c_str()); }
+
+	std::shared_ptr<arrow::io::RandomAccessFile> write_file(const std::string & contents) {
+		text = contents;
+		std::ofstream(filename, std::ios::binary) << contents;
+		std::shared_ptr<arrow::io::ReadableFile> file;
+		EXPECT_TRUE(arrow::io::ReadableFile::Open(filename, &file).ok());
+		return file;
+	}
+
+	csv_rows parse_ranges(const std::vector<ral::io::csv_byte_range> & ranges, char quotechar = '"') const {
+		csv_rows rows;
+		for(const ral::io::csv_byte_range & range : ranges) {
+			EXPECT_LE(range.start, range.end);
+			csv_rows range_rows = parse_on_host(text.substr(range.start, range.end - range.start), quotechar);
+			rows.insert(rows.end(), range_rows.begin(), range_rows.end());
+		}
+		return rows;
+	}
+
+	const std::string filename;
+	std::string text;
+};
+
+TEST_F(CSVByteRangesTest, number_of_ranges) {
+	EXPECT_EQ(ral::io::get_num_csv_byte_ranges(0, 100), 1);
+	EXPECT_EQ(ral::io::get_num_csv_byte_ranges(100, 100), 1);
+	EXPECT_EQ(ral::io::get_num_csv_byte_ranges(101, 100), 2);
+	EXPECT_EQ(ral::io::get_num_csv_byte_ranges(1000, 0), 1);
+}
+
+TEST_F(CSVByteRangesTest, quoted_terminators_and_doubled_quotes) {
+	std::string contents = "id,comment,value\n";
+	for(int row = 0; row < 500; row++) {
+		switch(row % 4) {
+		case 0: contents += std::to_string(row) + ",plain," + std::to_string(row * 3) + "\n"; break;
+		case 1: contents += std::to_string(row) + ",\"spans\nthree\nlines\"," + std::to_string(row) + "\n"; break;
+		case 2: contents += std::to_string(row) + ",\"says \"\"hi,\n\"\" twice\",x\r\n"; break;
+		case 3: contents += std::to_string(row) + ",\"\"," + std::string(row % 50, 'z') + "\n"; break;
+		}
+	}
+	auto file = write_file(contents);
+	const csv_rows expected = parse_on_host(contents);
+	ASSERT_EQ(expected.size(), 501);
+
+	ThreadPool scan_pool(4);
+	for(int64_t range_size : {7, 64, 333, 4096}) {
+		for(int64_t block_size : {5, 37, 1024}) {
+			const int num_ranges = ral::io::get_num_csv_byte_ranges(contents.size(), range_size);
+			auto ranges = ral::io::get_csv_byte_ranges(
+				file, range_size, ral::io::get_row_groups_to_decode({}, num_ranges), {}, scan_pool, block_size);
+			ASSERT_EQ(ranges.size(), num_ranges);
+			EXPECT_EQ(ranges.front().start, 0);
+			EXPECT_EQ(ranges.back().end, contents.size());
+			for(size_t i = 1; i < ranges.size(); i++) {
+				EXPECT_EQ(ranges[i].start, ranges[i - 1].end);
+			}
+			EXPECT_EQ(parse_ranges(ranges), expected) << "range size " << range_size << " block size " << block_size;
+		}
+	}
+}
+
+TEST_F(CSVByteRangesTest, chosen_ranges_on_several_nodes) {
+	std::string contents;
+	for(int row = 0; row < 1000; row++) {
+		contents += std::to_string(row) + ",\"a,\nb\"\n";
+	}
+	auto file = write_file(contents);
+	const int64_t range_size = 100;
+	const int num_ranges = ral::io::get_num_csv_byte_ranges(contents.size(), range_size);
+
+	// every node finds its own ranges, together they have every row once
+	ThreadPool scan_pool(2);
+	csv_rows rows;
+	for(int node = 0; node < 3; node++) {
+		std::vector<int> node_ranges;
+		for(int range_id = node; range_id < num_ranges; range_id += 3) {
+			node_ranges.push_back(range_id);
+		}
+		auto ranges = ral::io::get_csv_byte_ranges(file, range_size, node_ranges, {}, scan_pool, 64);
+		for(size_t i = 0; i < ranges.size(); i++) {
+			auto whole = ral::io::get_csv_byte_ranges(file, range_size, {node_ranges[i]}, {}, scan_pool);
+			EXPECT_EQ(ranges[i].start, whole[0].start);
+			EXPECT_EQ(ranges[i].end, whole[0].end);
+			csv_rows range_rows = parse_ranges({ranges[i]});
+			rows.insert(rows.end(), range_rows.begin(), range_rows.end());
+		}
+	}
+	std::sort(rows.begin(), rows.end());
+	csv_rows expected = parse_on_host(contents);
+	std::sort(expected.begin(), expected.end());
+	EXPECT_EQ(rows, expected);
+
+	EXPECT_THROW(ral::io::get_csv_byte_ranges(file, range_size, {num_ranges}, {}, scan_pool), std::runtime_error);
+}
+
+TEST_F(CSVByteRangesTest, rows_longer_than_a_range) {
+	const std::string long_row = "1,\"" + std::string(1000, 'x') + "\n" + std::string(1000, 'y') + "\"\n";
+	auto file = write_file(long_row + "2,short\n" + long_row);
+
+	ThreadPool scan_pool(3);
+	const int num_ranges = ral::io::get_num_csv_byte_ranges(text.size(), 100);
+	auto ranges = ral::io::get_csv_byte_ranges(
+		file, 100, ral::io::get_row_groups_to_decode({}, num_ranges), {}, scan_pool, 128);
+
+	// no row starts in most of the ranges, they come back empty. The short row and the one after it start in the
+	// same range.
+	int non_empty = 0;
+	for(const ral::io::csv_byte_range & range : ranges) {
+		non_empty += range.start < range.end ? 1 : 0;
+	}
+	EXPECT_EQ(non_empty, 2);
+	EXPECT_EQ(parse_ranges(ranges), parse_on_host(text));
+}
+
+TEST_F(CSVByteRangesTest, without_quotes_or_final_terminator) {
+	auto file = write_file("a,\"b\n1,\"2\n3,4\n5,6");
+
+	ral::io::csv_row_format format;
+	format.quotechar = '\0';
+	ThreadPool scan_pool(2);
+	auto ranges = ral::io::get_csv_byte_ranges(file, 3, ral::io::get_row_groups_to_decode({}, 6), format, scan_pool);
+	EXPECT_EQ(parse_ranges(ranges, '\0'), csv_rows({{"a", "\"b"}, {"1", "\"2"}, {"3", "4"}, {"5", "6"}}));
+}
+
+// quotes inside unquoted fields leave the state of an edge open, those edges are found from the start of the file
+TEST_F(CSVByteRangesTest, quotes_inside_unquoted_fields) {
+	std::string contents;
+	for(int row = 0; row < 200; row++) {
+		if(row % 2 == 0) {
+			contents += std::to_string(row) + ",\"a,\nb\"\n";
+		} else {
+			contents += std::to_string(row) + ",5\"2 and 3\"x\n";
+		}
+	}
+	auto file = write_file(contents);
+	const csv_rows expected = parse_on_host(contents);
+
+	ThreadPool scan_pool(3);
+	for(int64_t range_size : {11, 256}) {
+		const int num_ranges = ral::io::get_num_csv_byte_ranges(contents.size(), range_size);
+		auto ranges = ral::io::get_csv_byte_ranges(
+			file, range_size, ral::io::get_row_groups_to_decode({}, num_ranges), {}, scan_pool, 100);
+		EXPECT_EQ(parse_ranges(ranges), expected) << "range size " << range_size;
+	}
+}
+
+// no quote near the edges inside the quoted field tells their state, they must not be taken to be outside quotes
+TEST_F(CSVByteRangesTest, quoted_field_longer_than_the_resync_window) {
+	std::string contents = "id,payload\n1,\"";
+	for(int line = 0; line < 200000; line++) {
+		contents += "line of text\n";
+	}
+	contents += "\"\n2,x\n3,y\n";
+	auto file = write_file(contents);
+	ASSERT_EQ(contents.size(), 2600024);
+
+	ThreadPool scan_pool(2);
+	const int64_t range_size = 1024 * 1024;
+	const int num_ranges = ral::io::get_num_csv_byte_ranges(contents.size(), range_size);
+	auto ranges = ral::io::get_csv_byte_ranges(
+		file, range_size, ral::io::get_row_groups_to_decode({}, num_ranges), {}, scan_pool);
+	ASSERT_EQ(ranges.size(), 3);
+	EXPECT_EQ(ranges[0].start, 0);
+	EXPECT_EQ(ranges[0].end, 2600016);
+	EXPECT_EQ(ranges[1].start, 2600016);
+	EXPECT_EQ(ranges[1].end, 2600016);
+	EXPECT_EQ(ranges[2].start, 2600016);
+	EXPECT_EQ(ranges[2].end, 2600024);
+	EXPECT_EQ(parse_ranges(ranges), parse_on_host(contents));
+}
@@ -0,0 +1,191 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <future>
+#include <map>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+#include "io/data_provider/DirectoryExpander.h"
+
+struct DirectoryExpanderTest : public ::testing::Test {
+	void SetUp() {
+		char name[] = "/tmp/directory_expander_testXXXXXX";
+		root = mkdtemp(name);
+		io_pool = std::make_shared<ThreadPool>(4);
+	}
+
+	void TearDown() { std::system(("rm -rf " + root).c_str()); }
+
+	std::string write_file(const std::string & path) {
+		std::string directory = root;
+		size_t start = 0;
+		for(size_t separator = path.find('/'); separator != std::string::npos; separator = path.find('/', start)) {
+			directory += "/" + path.substr(start, separator - start);
+			mkdir(directory.c_str(), 0700);
+			start = separator + 1;
+		}
+		std::ofstream file(root + "/" + path);
+		file << path << std::endl;
+		return root + "/" + path;
+	}
+
+	static std::vector<std::string> get_paths(std::vector<ral::io::expanded_file> files) {
+		std::vector<std::string> paths;
+		for(const ral::io::expanded_file & file : files) {
+			paths.push_back(file.uri.getPath().toString());
+		}
+		std::sort(paths.begin(), paths.end());
+		return paths;
+	}
+
+	std::string root;
+	std::shared_ptr<ThreadPool> io_pool;
+};
+
+TEST_F(DirectoryExpanderTest, nested_partitions) {
+	std::vector<std::string> expected;
+	for(int year = 2018; year <= 2019; year++) {
+		for(int month = 1; month <= 12; month++) {
+			expected.push_back(
+				write_file("year=" + std::to_string(year) + "/month=" + std::to_string(month) + "/part-0.parquet"));
+		}
+	}
+	write_file("year=2018/month=1/part-0.parquet.crc");
+	write_file("year=2018/_temporary/part-1.parquet");
+	write_file("_SUCCESS/part-2.parquet");
+	std::sort(expected.begin(), expected.end());
+
+	auto files = ral::io::directory_expander::expand(Uri{root + "/"}, io_pool);
+	EXPECT_EQ(get_paths(files), expected);
+
+	for(const ral::io::expanded_file & file : files) {
+		const std::string path = file.uri.getPath().toString();
+		ASSERT_EQ(file.partition_values.size(), 2);
+		EXPECT_NE(path.find("year=" + file.partition_values.at("year") + "/"), std::string::npos);
+		EXPECT_NE(path.find("month=" + file.partition_values.at("month") + "/"), std::string::npos);
+	}
+}
+
+TEST_F(DirectoryExpanderTest, escaped_values_and_wildcards) {
+	const std::string file = write_file("country=United%20States/part-0.csv");
+	write_file("country=Peru/part-0.csv");
+
+	auto files = ral::io::directory_expander::expand(Uri{root + "/country=United*"}, io_pool);
+	ASSERT_EQ(get_paths(files), std::vector<std::string>({file}));
+	EXPECT_EQ(files[0].partition_values.at("country"), "United States");
+}
+
+// the file list of a table registered from a directory is expanded file by file at query time
+TEST_F(DirectoryExpanderTest, files_keep_the_partitions_of_their_path) {
+	const std::string file = write_file("year=2019/month=United%20States/part-0.parquet");
+	write_file("year=2019/month=1/part-0.parquet");
+
+	ral::io::directory_expansion_options options;
+	options.partition_roots = {Uri{root}};
+	auto files = ral::io::directory_expander::expand(Uri{file}, io_pool, options);
+	ASSERT_EQ(get_paths(files), std::vector<std::string>({file}));
+	EXPECT_EQ(files[0].partition_values,
+		(std::map<std::string, std::string>{{"year", "2019"}, {"month", "United States"}}));
+	// the parsers key their caches by the status the file was found with
+	EXPECT_TRUE(files[0].status.isFile());
+	EXPECT_EQ(files[0].status.getFileSize(), std::string("year=2019/month=United%20States/part-0.parquet\n").size());
+
+	files = ral::io::directory_expander::expand(Uri{root + "/year=2019/month=1/*.parquet"}, io_pool, options);
+	ASSERT_EQ(files.size(), 1);
+	EXPECT_EQ(files[0].partition_values, (std::map<std::string, std::string>{{"year", "2019"}, {"month", "1"}}));
+	EXPECT_TRUE(files[0].status.isFile());
+	EXPECT_EQ(files[0].status.getFileSize(), std::string("year=2019/month=1/part-0.parquet\n").size());
+}
+
+TEST_F(DirectoryExpanderTest, directories_above_the_table_root_are_not_partitions) {
+	const std::string table = root + "/env=prod/table";
+	const std::string file = write_file("env=prod/table/year=2019/part-0.parquet");
+
+	ral::io::directory_expansion_options options;
+	options.partition_roots = {Uri{table + "/"}};
+	auto files = ral::io::directory_expander::expand(Uri{file}, io_pool, options);
+	ASSERT_EQ(files.size(), 1);
+	EXPECT_EQ(files[0].partition_values, (std::map<std::string, std::string>{{"year", "2019"}}));
+
+	files = ral::io::directory_expander::expand(Uri{table + "/year=2019/*.parquet"}, io_pool, options);
+	ASSERT_EQ(files.size(), 1);
+	EXPECT_EQ(files[0].partition_values, (std::map<std::string, std::string>{{"year", "2019"}}));
+
+	files = ral::io::directory_expander::expand(Uri{table}, io_pool);
+	ASSERT_EQ(files.size(), 1);
+	EXPECT_EQ(files[0].partition_values, (std::map<std::string, std::string>{{"year", "2019"}}));
+
+	// a table registered from the file itself, or from no root at all, has no partitions
+	options.partition_roots = {Uri{file}};
+	files = ral::io::directory_expander::expand(Uri{file}, io_pool, options);
+	ASSERT_EQ(files.size(), 1);
+	EXPECT_TRUE(files[0].partition_values.empty());
+
+	files = ral::io::directory_expander::expand(Uri{file}, io_pool);
+	ASSERT_EQ(files.size(), 1);
+	EXPECT_TRUE(files[0].partition_values.empty());
+}
+
+TEST_F(DirectoryExpanderTest, pluggable_filters) {
+	const std::string csv = write_file("a/part-0.csv");
+	write_file("a/part-0.json");
+	write_file("b/part-1.csv");
+	const std::string top = write_file("part-2.csv");
+
+	ral::io::directory_expansion_options options;
+	options.file_filters.push_back(
+		[](const FileStatus & status) { return status.getUri().getPath().getFileExtension() == "csv"; });
+	options.directory_filters.push_back(
+		[](const FileStatus & status) { return status.getUri().getPath().getResourceName() != "b"; });
+	options.max_listings_in_flight = 1;
+	EXPECT_EQ(get_paths(ral::io::directory_expander::expand(Uri{root + "/"}, io_pool, options)),
+		std::vector<std::string>({csv, top}));
+
+	options.recursive = false;
+	EXPECT_EQ(get_paths(ral::io::directory_expander::expand(Uri{root + "/"}, io_pool, options)),
+		std::vector<std::string>({top}));
+}
+
+TEST_F(DirectoryExpanderTest, next_does_not_wait_for_the_listings) {
+	for(int i = 0; i < 200; i++) {
+		write_file("day=" + std::to_string(i) + "/part-0.csv");
+	}
+
+	// the only worker of the pool is busy until the gate opens, so nothing is listed before that
+	auto pool = std::make_shared<ThreadPool>(1);
+	std::promise<void> gate;
+	std::shared_future<void> gate_opened = gate.get_future().share();
+	pool->submit([gate_opened]() { gate_opened.wait(); });
+
+	ral::io::directory_expansion_options options;
+	options.max_listings_in_flight = 2;
+	ral::io::directory_expander expander(Uri{root + "/"}, pool, options);
+
+	std::vector<ral::io::expanded_file> files;
+	EXPECT_TRUE(expander.next(files, false));
+	EXPECT_TRUE(files.empty());
+
+	gate.set_value();
+	while(expander.next(files, true)) {
+	}
+	EXPECT_EQ(files.size(), 200);
+}
+
+TEST_F(DirectoryExpanderTest, missing_path_throws) {
+	ral::io::directory_expander expander(Uri{root + "/missing/"}, io_pool);
+	std::vector<ral::io::expanded_file> files;
+	EXPECT_THROW(expander.next(files, true), std::exception);
+}
+
+TEST_F(DirectoryExpanderTest, expander_can_go_before_its_listings) {
+	for(int i = 0; i < 50; i++) {
+		write_file("day=" + std::to_string(i) + "/part-0.csv");
+	}
+	{ ral::io::directory_expander expander(Uri{root + "/"}, io_pool); }
+	io_pool.reset();
+}
@@ -0,0 +1,170 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <string>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include <arrow/io/file.h>
+#include <parquet/api/reader.h>
+#include <parquet/api/writer.h>
+
+#include "Config/BlazingContext.h"
+#include "io/data_parser/ParquetFooterCache.h"
+
+struct ParquetFooterCacheTest : public ::testing::Test {
+	void SetUp() {
+		char name[] = "/tmp/parquet_footer_cache_testXXXXXX";
+		directory = mkdtemp(name);
+	}
+
+	void TearDown() {
+		for(const std::string & path : files) {
+			std::remove(path.c_str());
+		}
+		rmdir(directory.c_str());
+	}
+
+	std::string write_file(const std::string & name, int num_row_groups) {
+		const std::string path = directory + "/" + name;
+		std::shared_ptr<::arrow::io::FileOutputStream> stream;
+		PARQUET_THROW_NOT_OK(::arrow::io::FileOutputStream::Open(path, &stream));
+
+		auto schema = std::static_pointer_cast<::parquet::schema::GroupNode>(::parquet::schema::GroupNode::Make(
+			"schema",
+			::parquet::Repetition::REQUIRED,
+			::parquet::schema::NodeVector{::parquet::schema::PrimitiveNode::Make(
+				"value", ::parquet::Repetition::REQUIRED, ::parquet::Type::INT64, ::parquet::ConvertedType::NONE)}));
+		std::shared_ptr<::parquet::ParquetFileWriter> file_writer =
+			::parquet::ParquetFileWriter::Open(stream, schema, ::parquet::WriterProperties::Builder().build());
+		for(int row_group = 0; row_group < num_row_groups; row_group++) {
+			auto * int64_writer = static_cast<::parquet::Int64Writer *>(file_writer->AppendRowGroup(1)->NextColumn());
+			std::int64_t value = row_group;
+			int64_writer->WriteBatch(1, nullptr, nullptr, &value);
+		}
+		file_writer->Close();
+		EXPECT_TRUE(stream->Close().ok());
+
+		files.push_back(path);
+		return path;
+	}
+
+	static std::shared_ptr<arrow::io::RandomAccessFile> open(const std::string & path) {
+		return BlazingContext::getInstance()->getFileSystemManager()->openReadable(Uri{path});
+	}
+
+	std::string directory;
+	std::vector<std::string> files;
+};
+
+TEST_F(ParquetFooterCacheTest, footer_is_read_once) {
+	const std::string path = write_file("file.parquet", 3);
+	ral::io::parquet_footer_cache cache;
+
+	EXPECT_EQ(cache.get_footer(path, open(path))->num_row_groups(), 3);
+	EXPECT_EQ(cache.get_footer(path, open(path))->num_row_groups(), 3);
+
+	ral::io::parquet_footer_cache_stats stats = cache.get_stats();
+	EXPECT_EQ(stats.misses, 1);
+	EXPECT_EQ(stats.hits, 1);
+}
+
+TEST_F(ParquetFooterCacheTest, rewritten_file_is_read_again) {
+	const std::string path = write_file("file.parquet", 3);
+	ral::io::parquet_footer_cache cache;
+	EXPECT_EQ(cache.get_footer(path, open(path))->num_row_groups(), 3);
+
+	write_file("file.parquet", 5);
+	EXPECT_EQ(cache.get_footer(path, open(path))->num_row_groups(), 5);
+	EXPECT_EQ(cache.get_stats().misses, 2);
+}
+
+TEST_F(ParquetFooterCacheTest, footers_in_file_order) {
+	std::vector<std::string> paths;
+	std::vector<std::shared_ptr<arrow::io::RandomAccessFile>> opened;
+	for(int i = 0; i < 20; i++) {
+		paths.push_back(write_file("part_" + std::to_string(i) + ".parquet", 1 + i % 4));
+		opened.push_back(open(paths.back()));
+	}
+	// the same file twice in a table is read once
+	paths.push_back(paths[0]);
+	opened.push_back(open(paths[0]));
+
+	ral::io::parquet_footer_cache cache;
+	ThreadPool io_pool(4);
+	auto footers = cache.get_footers(paths, opened, io_pool);
+	ASSERT_EQ(footers.size(), paths.size());
+	for(size_t i = 0; i < 20; i++) {
+		EXPECT_EQ(footers[i]->num_row_groups(), 1 + i % 4);
+	}
+	EXPECT_EQ(footers[20]->num_row_groups(), 1);
+
+	ral::io::parquet_footer_cache_stats stats = cache.get_stats();
+	EXPECT_EQ(stats.misses, 20);
+	EXPECT_EQ(stats.hits + stats.coalesced, 1);
+
+	cache.get_footers(paths, opened, io_pool);
+	EXPECT_EQ(cache.get_stats().misses, 20);
+}
+
+TEST_F(ParquetFooterCacheTest, files_without_identity_are_not_cached) {
+	const std::string path = write_file("file.parquet", 2);
+	ral::io::parquet_footer_cache cache;
+
+	// a directory, like the handle of the first file of a directory uri, never names the file it was given
+	EXPECT_EQ(cache.get_footer(directory, open(path))->num_row_groups(), 2);
+	EXPECT_EQ(cache.get_footer("", open(path))->num_row_groups(), 2);
+
+	ral::io::parquet_footer_cache_stats stats = cache.get_stats();
+	EXPECT_EQ(stats.uncached, 2);
+	EXPECT_EQ(stats.misses, 0);
+}
+
+TEST_F(ParquetFooterCacheTest, known_status_identifies_the_file) {
+	const std::string path = write_file("file.parquet", 2);
+	const FileStatus status = BlazingContext::getInstance()->getFileSystemManager()->getFileStatus(Uri{path});
+	ral::io::parquet_footer_cache cache;
+
+	// the status the provider found the file with keys it, the filesystem is not asked again
+	const FileStatus listed(status.getUri(), FileType::FILE, status.getFileSize(), 1000);
+	EXPECT_EQ(cache.get_footer(path, open(path), listed)->num_row_groups(), 2);
+	EXPECT_EQ(cache.get_footer(path, open(path), listed)->num_row_groups(), 2);
+	EXPECT_EQ(cache.get_stats().misses, 1);
+	EXPECT_EQ(cache.get_stats().hits, 1);
+
+	const FileStatus relisted(status.getUri(), FileType::FILE, status.getFileSize(), 2000);
+	cache.get_footer(path, open(path), relisted);
+	EXPECT_EQ(cache.get_stats().misses, 2);
+
+	// a status that is not the one of a file is looked up
+	cache.get_footer(path, open(path), FileStatus());
+	EXPECT_EQ(cache.get_stats().misses, 3);
+}
+
+TEST_F(ParquetFooterCacheTest, least_recently_used_are_evicted) {
+	ral::io::parquet_footer_cache_options options;
+	options.max_footers = 2;
+	ral::io::parquet_footer_cache cache(options);
+
+	const std::string first = write_file("first.parquet", 1);
+	const std::string second = write_file("second.parquet", 1);
+	const std::string third = write_file("third.parquet", 1);
+	cache.get_footer(first, open(first));
+	cache.get_footer(second, open(second));
+	cache.get_footer(first, open(first));
+	cache.get_footer(third, open(third));
+
+	cache.get_footer(first, open(first));
+	EXPECT_EQ(cache.get_stats().misses, 3);
+	cache.get_footer(second, open(second));
+	EXPECT_EQ(cache.get_stats().misses, 4);
+}
+
+TEST_F(ParquetFooterCacheTest, missing_file_throws_and_is_not_cached) {
+	ral::io::parquet_footer_cache cache;
+	const std::string path = directory + "/missing.parquet";
+	EXPECT_THROW(cache.get_footer(path, nullptr), std::exception);
+	EXPECT_THROW(cache.get_footer(path, nullptr), std::exception);
+}
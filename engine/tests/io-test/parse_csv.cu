@@ -12,9 +12,11 @@
 #include "io/data_parser/DataParser.h"
 #include "io/data_parser/ParquetParser.h"
 #include "io/data_provider/DataProvider.h"
+#include "io/data_provider/PrefetchingDataProvider.h"
 #include "io/data_provider/UriDataProvider.h"
 #include <DataFrame.h>
 #include <fstream>
+#include <sys/stat.h>
 #include <gdf_wrapper/gdf_wrapper.cuh>
 
 #include <GDFColumn.cuh>
@@ -108,4 +110,57 @@ TEST_F(ParseCSVTest, csv_with_strings) {
               << input_table[column_index].get_gdf_column()->size << std::endl;
     print_gdf_column(input_table[column_index].get_gdf_column());
   }
-}
\ No newline at end of file
+}
+
+// The table is registered from its directory, where the partition columns are found, and queried through the files
+// the directory expanded to, as the python side stores them
+TEST_F(ParseCSVTest, partition_column_through_the_file_list) {
+  char name[] = "/tmp/parse_csv_partitionsXXXXXX";
+  const std::string root = mkdtemp(name);
+  std::vector<Uri> files;
+  for (int year : {2018, 2019}) {
+    const std::string directory = root + "/year=" + std::to_string(year);
+    mkdir(directory.c_str(), 0700);
+    std::ofstream file(directory + "/part-0.psv");
+    file << "1|a\n2|b\n";
+    files.push_back(Uri{directory + "/part-0.psv"});
+  }
+
+  cudf::csv_read_arg args(cudf::source_info{""});
+  args.names = {"id", "name"};
+  args.dtype = {"int32", "str"};
+  args.header = -1;
+  args.delimiter = '|';
+  auto parser = std::make_shared<ral::io::csv_parser>(args);
+
+  ral::io::Schema schema;
+  ral::io::data_loader registering_loader(
+      parser, std::make_shared<ral::io::uri_data_provider>(std::vector<Uri>{Uri{root + "/"}}));
+  registering_loader.get_schema(schema, {});
+  ASSERT_EQ(schema.get_names(), std::vector<std::string>({"id", "name", "year"}));
+
+  // the query carries the root the table was registered from, the partitions are the directories below it
+  ral::io::directory_expansion_options options;
+  options.partition_roots = {Uri{root + "/"}};
+  ral::io::data_loader loader(parser,
+      std::make_shared<ral::io::prefetching_data_provider>(files,
+          std::vector<std::map<std::string, gdf_scalar>>{},
+          std::vector<std::map<std::string, std::string>>{},
+          std::vector<std::map<std::string, bool>>{},
+          ral::io::prefetching_data_provider::get_default_files_in_flight(),
+          ral::io::prefetching_data_provider::get_default_io_pool(),
+          options));
+  Context queryContext{0, std::vector<std::shared_ptr<Node>>(), std::shared_ptr<Node>(), ""};
+  std::vector<gdf_column_cpp> input_table;
+  loader.load_data(queryContext, input_table, {0, 2}, schema);
+
+  ASSERT_EQ(input_table.size(), 2);
+  gdf_column_cpp year = input_table[1];
+  ASSERT_EQ(year.size(), 4);
+  ASSERT_EQ(year.dtype(), GDF_INT64);
+  std::vector<int64_t> years(4);
+  cudaMemcpy(years.data(), year.data(), years.size() * sizeof(int64_t), cudaMemcpyDeviceToHost);
+  EXPECT_EQ(years, std::vector<int64_t>({2018, 2018, 2019, 2019}));
+
+  std::system(("rm -rf " + root).c_str());
+}
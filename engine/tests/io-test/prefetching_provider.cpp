@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+#include "io/data_provider/PrefetchingDataProvider.h"
+#include "io/data_provider/UriDataProvider.h"
+
+struct PrefetchingProviderTest : public ::testing::Test {
+	void SetUp() {
+		char name[] = "/tmp/prefetching_provider_testXXXXXX";
+		directory = mkdtemp(name);
+	}
+
+	void TearDown() {
+		for(const std::string & path : files) {
+			std::remove(path.c_str());
+		}
+		rmdir((directory + "/part").c_str());
+		rmdir(directory.c_str());
+	}
+
+	std::string write_file(const std::string & name) {
+		const std::string path = directory + "/" + name;
+		std::ofstream file(path);
+		file << name << std::endl;
+		files.push_back(path);
+		return path;
+	}
+
+	static std::vector<std::string> get_paths(ral::io::data_provider & provider) {
+		std::vector<std::string> paths;
+		while(provider.has_next()) {
+			ral::io::data_handle handle = provider.get_next();
+			EXPECT_NE(handle.fileHandle, nullptr);
+			paths.push_back(handle.uri.getPath().toString());
+		}
+		return paths;
+	}
+
+	std::string directory;
+	std::vector<std::string> files;
+};
+
+TEST_F(PrefetchingProviderTest, same_files_as_uri_provider) {
+	for(int i = 0; i < 50; i++) {
+		write_file("file_" + std::to_string(i) + ".psv");
+	}
+	write_file("file_0.psv.crc");
+	write_file("file_0_copy_1.psv");
+	const std::string single_file = write_file("single.psv");
+
+	std::vector<Uri> uris = {Uri{directory + "/"}, Uri{single_file}, Uri{directory + "/file_1*"}};
+
+	ral::io::uri_data_provider uri_provider(uris);
+	auto expected = get_paths(uri_provider);
+	EXPECT_EQ(expected.size(), 51 + 1 + 11);
+
+	// a small window and pool so most of the opens have to wait for a free slot
+	ral::io::prefetching_data_provider provider(uris, {}, {}, {}, 4, std::make_shared<ThreadPool>(2));
+	EXPECT_EQ(get_paths(provider), expected);
+	EXPECT_FALSE(provider.has_next());
+
+	provider.reset();
+	EXPECT_EQ(provider.get_all().size(), expected.size());
+}
+
+TEST_F(PrefetchingProviderTest, values_follow_their_uri) {
+	mkdir((directory + "/part").c_str(), 0700);
+	write_file("part/a.psv");
+	write_file("part/b.psv");
+	const std::string other = write_file("other.psv");
+
+	std::vector<std::map<std::string, gdf_scalar>> uri_scalars(2);
+	std::vector<std::map<std::string, std::string>> string_scalars = {{{"key", "part"}}, {{"key", "other"}}};
+	std::vector<std::map<std::string, bool>> is_column_string = {{{"key", true}}, {{"key", true}}};
+
+	ral::io::prefetching_data_provider provider({Uri{directory + "/part/"}, Uri{other}},
+		uri_scalars,
+		string_scalars,
+		is_column_string,
+		1,
+		std::make_shared<ThreadPool>(1));
+
+	std::vector<std::string> values;
+	while(provider.has_next()) {
+		const std::string readable_handle = provider.get_current_user_readable_file_handle();
+		ral::io::data_handle handle = provider.get_next();
+		EXPECT_EQ(readable_handle, handle.uri.toString());
+		values.push_back(handle.string_values["key"]);
+	}
+	EXPECT_EQ(values, std::vector<std::string>({"part", "part", "other"}));
+}
+
+TEST_F(PrefetchingProviderTest, empty_directories_are_skipped) {
+	mkdir((directory + "/part").c_str(), 0700);
+	const std::string file = write_file("file.psv");
+
+	ral::io::prefetching_data_provider provider({Uri{directory + "/part/"}, Uri{file}, Uri{directory + "/part/"}});
+	EXPECT_EQ(get_paths(provider), std::vector<std::string>({file}));
+}
+
+TEST_F(PrefetchingProviderTest, missing_path_throws) {
+	const std::string file = write_file("file.psv");
+
+	ral::io::prefetching_data_provider provider({Uri{file}, Uri{directory + "/missing.psv"}});
+	EXPECT_TRUE(provider.has_next());
+	provider.get_next();
+	EXPECT_THROW(provider.has_next(), std::exception);
+}
@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arrow/io/file.h>
+#include <parquet/api/reader.h>
+#include <parquet/api/writer.h>
+
+#include "io/data_parser/RowGroupDecoder.h"
+
+TEST(RowGroupDecoderTest, every_row_group_when_none_chosen) {
+	EXPECT_EQ(ral::io::get_row_groups_to_decode({}, 4), std::vector<int>({0, 1, 2, 3}));
+	EXPECT_EQ(ral::io::get_row_groups_to_decode({}, 0), std::vector<int>());
+}
+
+TEST(RowGroupDecoderTest, chosen_row_groups_in_file_order) {
+	EXPECT_EQ(ral::io::get_row_groups_to_decode({3, 1, 3, 0}, 4), std::vector<int>({0, 1, 3}));
+	EXPECT_THROW(ral::io::get_row_groups_to_decode({1, 4}, 4), std::runtime_error);
+	EXPECT_THROW(ral::io::get_row_groups_to_decode({-1}, 4), std::runtime_error);
+}
+
+TEST(RowGroupDecoderTest, stitched_in_order) {
+	ThreadPool decode_pool(4);
+	const std::vector<int> row_groups = {0, 2, 3, 5, 6, 7};
+
+	// the first row groups take the longest so they finish last
+	auto decoded = ral::io::decode_row_groups(row_groups,
+		[](int row_group) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(10 * (8 - row_group)));
+			return std::vector<int>(row_group + 1, row_group);
+		},
+		decode_pool);
+
+	ASSERT_EQ(decoded.size(), row_groups.size());
+	for(size_t i = 0; i < row_groups.size(); i++) {
+		EXPECT_EQ(decoded[i], std::vector<int>(row_groups[i] + 1, row_groups[i]));
+	}
+}
+
+TEST(RowGroupDecoderTest, error_after_every_row_group_finished) {
+	ThreadPool decode_pool(2);
+	std::atomic<int> finished(0);
+
+	EXPECT_THROW(ral::io::decode_row_groups({0, 1, 2, 3},
+					 [&finished](int row_group) {
+						 std::this_thread::sleep_for(std::chrono::milliseconds(5));
+						 finished++;
+						 if(row_group == 0) {
+							 throw std::runtime_error("corrupt page");
+						 }
+						 return row_group;
+					 },
+					 decode_pool),
+		std::runtime_error);
+	// the caller can free what the decoders use as soon as the error comes out
+	EXPECT_EQ(finished, 4);
+}
+
+// Decodes on the host with parquet-cpp through the same split and stitch the parser uses on the GPU
+struct RowGroupHostDecodeTest : public ::testing::Test {
+	static constexpr int kGroups = 6;
+	static constexpr int kRowsPerGroup = 1000;
+
+	RowGroupHostDecodeTest() : filename("/tmp/row_group_decoder_test.parquet") {}
+
+	void SetUp() {
+		std::shared_ptr<::arrow::io::FileOutputStream> stream;
+		PARQUET_THROW_NOT_OK(::arrow::io::FileOutputStream::Open(filename, &stream));
+
+		auto schema = std::static_pointer_cast<::parquet::schema::GroupNode>(::parquet::schema::GroupNode::Make(
+			"schema",
+			::parquet::Repetition::REQUIRED,
+			::parquet::schema::NodeVector{::parquet::schema::PrimitiveNode::Make(
+				"value", ::parquet::Repetition::REQUIRED, ::parquet::Type::INT64, ::parquet::ConvertedType::NONE)}));
+		std::shared_ptr<::parquet::ParquetFileWriter> file_writer =
+			::parquet::ParquetFileWriter::Open(stream, schema, ::parquet::WriterProperties::Builder().build());
+
+		for(int row_group = 0; row_group < kGroups; row_group++) {
+			::parquet::RowGroupWriter * row_group_writer = file_writer->AppendRowGroup(kRowsPerGroup);
+			auto * int64_writer = static_cast<::parquet::Int64Writer *>(row_group_writer->NextColumn());
+			for(int row = 0; row < kRowsPerGroup; row++) {
+				std::int64_t value = row_group * kRowsPerGroup + row;
+				int64_writer->WriteBatch(1, nullptr, nullptr, &value);
+			}
+		}
+		file_writer->Close();
+		ASSERT_TRUE(stream->Close().ok());
+	}
+
+	void TearDown() { std::remove(filename.c_str()); }
+
+	std::vector<std::int64_t> decode_on_host(int row_group) const {
+		std::unique_ptr<::parquet::ParquetFileReader> reader = ::parquet::ParquetFileReader::OpenFile(filename, false);
+		auto column = std::static_pointer_cast<::parquet::Int64Reader>(reader->RowGroup(row_group)->Column(0));
+
+		std::vector<std::int64_t> values(reader->metadata()->RowGroup(row_group)->num_rows());
+		size_t num_values = 0;
+		while(column->HasNext() && num_values < values.size()) {
+			std::int64_t values_read = 0;
+			column->ReadBatch(values.size() - num_values, nullptr, nullptr, values.data() + num_values, &values_read);
+			num_values += values_read;
+		}
+		reader->Close();
+		return values;
+	}
+
+	const std::string filename;
+};
+
+TEST_F(RowGroupHostDecodeTest, chosen_row_groups_match_a_serial_read) {
+	ThreadPool decode_pool(4);
+	const std::vector<int> row_groups = ral::io::get_row_groups_to_decode({4, 1, 5}, kGroups);
+
+	auto decoded = ral::io::decode_row_groups(
+		row_groups, [this](int row_group) { return this->decode_on_host(row_group); }, decode_pool);
+
+	std::vector<std::int64_t> values;
+	for(const auto & row_group : decoded) {
+		values.insert(values.end(), row_group.begin(), row_group.end());
+	}
+
+	std::vector<std::int64_t> expected;
+	for(int row_group : {1, 4, 5}) {
+		for(int row = 0; row < kRowsPerGroup; row++) {
+			expected.push_back(row_group * kRowsPerGroup + row);
+		}
+	}
+	EXPECT_EQ(values, expected);
+}
@@ -0,0 +1,116 @@
+#include "utilities/LikePattern.h"
+#include <gtest/gtest.h>
+#include <regex>
+
+using namespace ral::utilities;
+
+struct LikePatternTest : public ::testing::Test {
+	LikePatternTest() {}
+
+	~LikePatternTest() {}
+};
+
+TEST_F(LikePatternTest, classify_simple_patterns) {
+	EXPECT_EQ(compile_like_pattern("abc").kind, like_pattern_kind::EXACT);
+	EXPECT_EQ(compile_like_pattern("abc%").kind, like_pattern_kind::PREFIX);
+	EXPECT_EQ(compile_like_pattern("%abc").kind, like_pattern_kind::SUFFIX);
+	EXPECT_EQ(compile_like_pattern("%abc%").kind, like_pattern_kind::CONTAINS);
+	EXPECT_EQ(compile_like_pattern("%").kind, like_pattern_kind::MATCH_ALL);
+	EXPECT_EQ(compile_like_pattern("%%%").kind, like_pattern_kind::MATCH_ALL);
+	EXPECT_EQ(compile_like_pattern("%%abc%%").kind, like_pattern_kind::CONTAINS);
+	EXPECT_EQ(compile_like_pattern("").kind, like_pattern_kind::EXACT);
+
+	EXPECT_EQ(compile_like_pattern("abc%").literal, "abc");
+	EXPECT_EQ(compile_like_pattern("%abc%").literal, "abc");
+}
+
+TEST_F(LikePatternTest, classify_regex_fallback) {
+	EXPECT_EQ(compile_like_pattern("a_c").kind, like_pattern_kind::REGEX);
+	EXPECT_EQ(compile_like_pattern("a%c").kind, like_pattern_kind::REGEX);
+	EXPECT_EQ(compile_like_pattern("%a%c%").kind, like_pattern_kind::REGEX);
+	EXPECT_EQ(compile_like_pattern("_%").kind, like_pattern_kind::REGEX);
+}
+
+TEST_F(LikePatternTest, escape_handling) {
+	like_pattern pattern = compile_like_pattern("100\\%");
+	EXPECT_EQ(pattern.kind, like_pattern_kind::EXACT);
+	EXPECT_EQ(pattern.literal, "100%");
+	EXPECT_TRUE(pattern.matches("100%"));
+	EXPECT_FALSE(pattern.matches("1000"));
+
+	pattern = compile_like_pattern("a\\_b%");
+	EXPECT_EQ(pattern.kind, like_pattern_kind::PREFIX);
+	EXPECT_EQ(pattern.literal, "a_b");
+	EXPECT_TRUE(pattern.matches("a_bcd"));
+	EXPECT_FALSE(pattern.matches("axbcd"));
+
+	pattern = compile_like_pattern("%\\\\%");
+	EXPECT_EQ(pattern.kind, like_pattern_kind::CONTAINS);
+	EXPECT_EQ(pattern.literal, "\\");
+	EXPECT_TRUE(pattern.matches("a\\b"));
+	EXPECT_FALSE(pattern.matches("ab"));
+
+	pattern = compile_like_pattern("a#%b", '#');
+	EXPECT_EQ(pattern.kind, like_pattern_kind::EXACT);
+	EXPECT_EQ(pattern.literal, "a%b");
+}
+
+TEST_F(LikePatternTest, any_char_wildcard) {
+	like_pattern pattern = compile_like_pattern("a_c");
+	EXPECT_TRUE(pattern.matches("abc"));
+	EXPECT_TRUE(pattern.matches("a_c"));
+	EXPECT_FALSE(pattern.matches("ac"));
+	EXPECT_FALSE(pattern.matches("abbc"));
+
+	pattern = compile_like_pattern("___");
+	EXPECT_TRUE(pattern.matches("xyz"));
+	EXPECT_FALSE(pattern.matches("xy"));
+	EXPECT_FALSE(pattern.matches("wxyz"));
+
+	pattern = compile_like_pattern("%a_c%e");
+	EXPECT_TRUE(pattern.matches("zzabcde"));
+	EXPECT_TRUE(pattern.matches("abcabce"));
+	EXPECT_FALSE(pattern.matches("abcd"));
+}
+
+TEST_F(LikePatternTest, specialized_matchers) {
+	like_pattern prefix = compile_like_pattern("PROMO%");
+	EXPECT_TRUE(prefix.matches("PROMO BRUSHED TIN"));
+	EXPECT_TRUE(prefix.matches("PROMO"));
+	EXPECT_FALSE(prefix.matches("PROM"));
+	EXPECT_FALSE(prefix.matches("SMALL PROMO"));
+
+	like_pattern suffix = compile_like_pattern("%BRASS");
+	EXPECT_TRUE(suffix.matches("LARGE PLATED BRASS"));
+	EXPECT_FALSE(suffix.matches("BRASS PLATED"));
+	EXPECT_FALSE(suffix.matches("RASS"));
+
+	like_pattern contains = compile_like_pattern("%green%");
+	EXPECT_TRUE(contains.matches("forest green lace"));
+	EXPECT_TRUE(contains.matches("green"));
+	EXPECT_FALSE(contains.matches("gree n"));
+
+	like_pattern exact = compile_like_pattern("MAIL");
+	EXPECT_TRUE(exact.matches("MAIL"));
+	EXPECT_FALSE(exact.matches("MAILS"));
+
+	like_pattern empty = compile_like_pattern("");
+	EXPECT_TRUE(empty.matches(""));
+	EXPECT_FALSE(empty.matches("a"));
+}
+
+TEST_F(LikePatternTest, regex_agrees_with_matchers) {
+	std::vector<std::string> patterns = {
+		"abc", "abc%", "%abc", "%abc%", "%", "a_c", "%a%c%", "a.c%", "%(x)%", "a\\%c", "_b%", "%[_]%"};
+	std::vector<std::string> inputs = {
+		"", "abc", "abcd", "zabc", "zabcz", "a.cz", "abz", "(x)", "a%c", "abbc", "[b]", "aXc", "ac"};
+
+	for(const std::string & like_exp : patterns) {
+		like_pattern pattern = compile_like_pattern(like_exp);
+		std::regex re(pattern.regex);
+		for(const std::string & input : inputs) {
+			EXPECT_EQ(pattern.matches(input), std::regex_search(input, re))
+				<< "pattern: " << like_exp << " regex: " << pattern.regex << " input: " << input;
+		}
+	}
+}
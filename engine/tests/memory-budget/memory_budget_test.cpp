@@ -0,0 +1,152 @@
+#include "cuDF/Allocator.h"
+#include <cstdlib>
+#include <gtest/gtest.h>
+#include <thread>
+
+using blazingdb::manager::MemoryTracker;
+namespace Allocator = cuDF::Allocator;
+
+// Host memory in place of RMM, failing on sizes over a limit like a device that ran out of memory
+class host_memory_resource : public Allocator::memory_resource {
+public:
+	void allocate(void ** pointer, std::size_t size, cudaStream_t stream) override {
+		if(size > limit) {
+			throw Allocator::OutOfMemory("During allocate of size: " + std::to_string(size));
+		}
+		*pointer = std::malloc(size);
+	}
+
+	void deallocate(void * pointer, cudaStream_t stream) override { std::free(pointer); }
+
+	std::size_t limit = 1 << 30;
+};
+
+struct MemoryBudgetTest : public ::testing::Test {
+	void SetUp() override {
+		previous = Allocator::get_memory_resource();
+		host = std::make_shared<host_memory_resource>();
+		Allocator::set_memory_resource(host);
+	}
+
+	void TearDown() override { Allocator::set_memory_resource(previous); }
+
+	std::shared_ptr<Allocator::memory_resource> previous;
+	std::shared_ptr<host_memory_resource> host;
+};
+
+TEST_F(MemoryBudgetTest, AllocationsAreAccountedToTheirOperator) {
+	auto tracker = std::make_shared<MemoryTracker>();
+	void * scanned = nullptr;
+	void * joined = nullptr;
+	{
+		Allocator::memory_scope scope(tracker, "1:scan");
+		Allocator::allocate(&scanned, 1000);
+		{
+			Allocator::memory_scope join_scope(tracker, "2:join");
+			Allocator::allocate(&joined, 500);
+		}
+		EXPECT_EQ(Allocator::memory_scope::current().operator_name, "1:scan");
+	}
+	EXPECT_EQ(Allocator::memory_scope::current().tracker, nullptr);
+
+	EXPECT_EQ(tracker->getCurrent(), 1500);
+	auto usage = tracker->getOperatorUsage();
+	EXPECT_EQ(usage["1:scan"].current, 1000);
+	EXPECT_EQ(usage["2:join"].current, 500);
+
+	// freed outside of any scope and by another thread, still released from the query that allocated it
+	std::thread([scanned]() { Allocator::deallocate(scanned); }).join();
+	Allocator::deallocate(joined);
+	EXPECT_EQ(tracker->getCurrent(), 0);
+	EXPECT_EQ(tracker->getPeak(), 1500);
+}
+
+TEST_F(MemoryBudgetTest, QueryOverItsBudgetIsRefused) {
+	auto tracker = std::make_shared<MemoryTracker>(2000);
+	Allocator::memory_scope scope(tracker, "3:join");
+
+	void * first = nullptr;
+	Allocator::allocate(&first, 1500);
+
+	void * second = nullptr;
+	EXPECT_THROW(Allocator::allocate(&second, 1000), Allocator::QueryMemoryExceeded);
+	EXPECT_EQ(second, nullptr);
+	EXPECT_EQ(tracker->getCurrent(), 1500);
+
+	// another query is not affected
+	auto other_tracker = std::make_shared<MemoryTracker>(2000);
+	{
+		Allocator::memory_scope other_scope(other_tracker, "1:scan");
+		Allocator::allocate(&second, 1000);
+	}
+	EXPECT_EQ(other_tracker->getCurrent(), 1000);
+
+	Allocator::deallocate(first);
+	Allocator::deallocate(second);
+	EXPECT_EQ(tracker->getCurrent(), 0);
+	EXPECT_EQ(other_tracker->getCurrent(), 0);
+}
+
+TEST_F(MemoryBudgetTest, FailedAllocationIsNotAccounted) {
+	auto tracker = std::make_shared<MemoryTracker>();
+	Allocator::memory_scope scope(tracker, "1:scan");
+	host->limit = 100;
+
+	void * pointer = nullptr;
+	EXPECT_THROW(Allocator::allocate(&pointer, 1000), Allocator::OutOfMemory);
+	EXPECT_EQ(tracker->getCurrent(), 0);
+}
+
+TEST_F(MemoryBudgetTest, AttributionCarriesOverToAnotherThread) {
+	auto tracker = std::make_shared<MemoryTracker>();
+	Allocator::memory_scope scope(tracker, "1:scan");
+
+	void * pointer = nullptr;
+	Allocator::memory_attribution attribution = Allocator::memory_scope::current();
+	std::thread([&pointer, attribution]() {
+		Allocator::memory_scope task_scope(attribution);
+		Allocator::allocate(&pointer, 800);
+	}).join();
+
+	EXPECT_EQ(tracker->getOperatorUsage()["1:scan"].current, 800);
+	Allocator::deallocate(pointer);
+	EXPECT_EQ(tracker->getCurrent(), 0);
+}
+
+TEST_F(MemoryBudgetTest, AdoptedMemoryIsAccountedUntilFreed) {
+	auto tracker = std::make_shared<MemoryTracker>(2000);
+	Allocator::memory_scope scope(tracker, "1:scan");
+
+	// allocated by a reader, not through the allocator
+	void * read = std::malloc(1500);
+	Allocator::adopt(read, 1500);
+	Allocator::adopt(read, 1500);
+	EXPECT_EQ(tracker->getOperatorUsage()["1:scan"].current, 1500);
+
+	// what the allocator already accounted is not accounted twice
+	void * allocated = nullptr;
+	Allocator::allocate(&allocated, 500);
+	Allocator::adopt(allocated, 500);
+	EXPECT_EQ(tracker->getCurrent(), 2000);
+
+	// adopted past the budget, the next allocation is refused
+	void * large = std::malloc(1000);
+	Allocator::adopt(large, 1000);
+	EXPECT_EQ(tracker->getCurrent(), 3000);
+	void * refused = nullptr;
+	EXPECT_THROW(Allocator::allocate(&refused, 1), Allocator::QueryMemoryExceeded);
+
+	Allocator::deallocate(read);
+	Allocator::deallocate(allocated);
+	Allocator::deallocate(large);
+	EXPECT_EQ(tracker->getCurrent(), 0);
+}
+
+TEST_F(MemoryBudgetTest, AllocationsOutsideOfAQueryAreNotAccounted) {
+	auto tracker = std::make_shared<MemoryTracker>(10);
+
+	void * pointer = nullptr;
+	Allocator::allocate(&pointer, 1000);
+	Allocator::deallocate(pointer);
+	EXPECT_EQ(tracker->getPeak(), 0);
+}
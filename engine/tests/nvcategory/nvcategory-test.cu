@@ -861,6 +861,39 @@ TEST_F(NVCategoryTest, processing_filter_count_group_by) {
   }
 }
 
+TEST_F(NVCategoryTest, processing_filter_like_match_all_nulls) {
+
+  { // select x from hr.emps where y like '%', the null strings do not match
+
+    const gdf_size_type num_rows = 6;
+    const char *string_data[num_rows] = {"a", nullptr, "bc", nullptr, "", "d"};
+    std::vector<int32_t> host_data = {0, 1, 2, 3, 4, 5};
+
+    inputs.resize(2);
+    gdf_dtype_extra_info extra_info{TIME_UNIT_NONE};
+
+    inputs[0].create_gdf_column(GDF_INT32, extra_info, num_rows,
+                                (void *)host_data.data(), sizeof(int32_t), "");
+    inputs[1].create_gdf_column(
+        NVCategory::create_from_array(string_data, num_rows), num_rows, "");
+    ASSERT_EQ(inputs[1].null_count(), 2);
+
+    input_tables.push_back(inputs);
+    input_tables.push_back(inputs);
+
+    std::string query = "LogicalProject(x=[$0])\n\
+	LogicalFilter(condition=[LIKE($1, '%')])\n\
+		LogicalTableScan(table=[[hr, emps]])";
+
+    gdf_error err =
+        evaluate_query(input_tables, table_names, column_names, query, outputs);
+    EXPECT_TRUE(err == GDF_SUCCESS);
+
+    std::vector<int32_t> reference_result = {0, 2, 4, 5};
+    Check(outputs[0], reference_result, reference_result.size());
+  }
+}
+
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
   ::testing::Environment *const env =
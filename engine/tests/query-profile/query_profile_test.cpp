@@ -0,0 +1,148 @@
+#include "cuDF/Allocator.h"
+#include "profile/QueryProfile.h"
+#include <cstdlib>
+#include <gtest/gtest.h>
+#include <thread>
+
+using blazingdb::manager::MemoryTracker;
+namespace Allocator = cuDF::Allocator;
+namespace profile = ral::profile;
+
+class host_memory_resource : public Allocator::memory_resource {
+public:
+	void allocate(void ** pointer, std::size_t size, cudaStream_t stream) override { *pointer = std::malloc(size); }
+
+	void deallocate(void * pointer, cudaStream_t stream) override { std::free(pointer); }
+};
+
+struct QueryProfileTest : public ::testing::Test {
+	void SetUp() override {
+		previous = Allocator::get_memory_resource();
+		Allocator::set_memory_resource(std::make_shared<host_memory_resource>());
+	}
+
+	void TearDown() override { Allocator::set_memory_resource(previous); }
+
+	std::shared_ptr<Allocator::memory_resource> previous;
+};
+
+// Runs a join of two scans the way evaluate_split_query opens its scopes, the right scan named like the left one
+void run_join(std::shared_ptr<MemoryTracker> tracker, int64_t left_rows, int64_t right_rows) {
+	Allocator::memory_scope join_memory(tracker, "LogicalJoin (depth 0)");
+	profile::operator_scope join("LogicalJoin(condition=[=($0, $1)], joinType=[inner])");
+	void * left_data = nullptr;
+	void * right_data = nullptr;
+	{
+		Allocator::memory_scope scan_memory(tracker, "LogicalTableScan (depth 1)");
+		profile::operator_scope scan("LogicalTableScan(table=[[main, left]])");
+		profile::add_rows_in(left_rows);
+		profile::add_bytes_read(4096);
+		Allocator::allocate(&left_data, 1000);
+		scan.set_rows_out(left_rows);
+	}
+	{
+		Allocator::memory_scope scan_memory(tracker, "LogicalTableScan (depth 1)");
+		profile::operator_scope scan("LogicalTableScan(table=[[main, right]])");
+		profile::add_rows_in(right_rows);
+		Allocator::allocate(&right_data, 300);
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		scan.set_rows_out(right_rows);
+	}
+	profile::add_bytes_shuffled(128);
+	profile::add_bytes_copied(256);
+	profile::add_bytes_spilled(64, 32);
+	join.set_rows_out(left_rows);
+	Allocator::deallocate(left_data);
+	Allocator::deallocate(right_data);
+}
+
+TEST_F(QueryProfileTest, TreeMatchesThePlan) {
+	auto tracker = std::make_shared<MemoryTracker>();
+	profile::query_profile query(7);
+	{
+		profile::query_scope scope(query, tracker);
+		run_join(tracker, 100, 40);
+	}
+
+	const profile::operator_profile * join = query.get_root();
+	ASSERT_NE(join, nullptr);
+	ASSERT_EQ(join->children.size(), 2);
+	const profile::operator_profile & left = *join->children[0];
+	const profile::operator_profile & right = *join->children[1];
+
+	EXPECT_EQ(left.relational_expression, "LogicalTableScan(table=[[main, left]])");
+	EXPECT_EQ(left.rows_in, 100);
+	EXPECT_EQ(left.bytes_read, 4096);
+	EXPECT_EQ(left.bytes_allocated, 1000);
+	EXPECT_EQ(right.rows_in, 40);
+	EXPECT_EQ(right.bytes_read, 0);
+	EXPECT_EQ(right.bytes_allocated, 300);
+
+	// the rows in of the join are the rows out of its inputs, its time includes theirs
+	EXPECT_EQ(join->rows_in, 140);
+	EXPECT_EQ(join->rows_out, 100);
+	EXPECT_EQ(join->bytes_shuffled, 128);
+	EXPECT_EQ(join->bytes_copied, 256);
+	EXPECT_EQ(join->bytes_spilled, 64);
+	EXPECT_EQ(join->bytes_spilled_to_disk, 32);
+	EXPECT_GE(right.wall_time_ms, 20);
+	EXPECT_GE(join->wall_time_ms, left.wall_time_ms + right.wall_time_ms);
+	EXPECT_NEAR(join->self_time_ms, join->wall_time_ms - left.wall_time_ms - right.wall_time_ms, 1e-6);
+	EXPECT_GE(query.get_wall_time_ms(), join->wall_time_ms);
+	EXPECT_EQ(query.get_peak_bytes(), 1300);
+}
+
+TEST_F(QueryProfileTest, NothingIsProfiledOutsideAQuery) {
+	profile::operator_scope scan("LogicalTableScan(table=[[main, left]])");
+	profile::add_rows_in(10);
+	profile::add_bytes_read(10);
+	scan.set_rows_out(10);
+
+	profile::query_profile query(1);
+	EXPECT_EQ(query.get_root(), nullptr);
+	EXPECT_EQ(query.to_json(), "{\"context_token\":1,\"wall_time_ms\":0,\"peak_bytes\":0,\"plan\":null}");
+}
+
+// every query thread profiles into its own tree, none of the timings are shared
+TEST_F(QueryProfileTest, ConcurrentQueriesKeepTheirOwnProfiles) {
+	const int num_queries = 8;
+	std::vector<std::unique_ptr<profile::query_profile>> queries;
+	std::vector<std::thread> threads;
+	for(int i = 0; i < num_queries; i++) {
+		queries.emplace_back(new profile::query_profile(i));
+	}
+	for(int i = 0; i < num_queries; i++) {
+		threads.emplace_back([&queries, i]() {
+			auto tracker = std::make_shared<MemoryTracker>();
+			profile::query_scope scope(*queries[i], tracker);
+			run_join(tracker, 1000 * (i + 1), i);
+		});
+	}
+	for(auto & thread : threads) {
+		thread.join();
+	}
+
+	for(int i = 0; i < num_queries; i++) {
+		const profile::operator_profile * join = queries[i]->get_root();
+		ASSERT_NE(join, nullptr);
+		EXPECT_EQ(join->rows_in, 1000 * (i + 1) + i);
+		EXPECT_EQ(join->children[0]->bytes_allocated, 1000);
+		EXPECT_EQ(join->children[1]->bytes_allocated, 300);
+	}
+}
+
+TEST_F(QueryProfileTest, JsonEscapesTheExpressions) {
+	profile::query_profile query(3);
+	{
+		profile::query_scope scope(query, nullptr);
+		profile::operator_scope filter("LogicalFilter(condition=[=($0, 'a\"b\\c')])");
+		filter.set_rows_out(5);
+	}
+
+	std::string json = query.to_json();
+	EXPECT_NE(json.find("\"context_token\":3"), std::string::npos);
+	EXPECT_NE(json.find("\"relational_expression\":\"LogicalFilter(condition=[=($0, 'a\\\"b\\\\c')])\""),
+		std::string::npos);
+	EXPECT_NE(json.find("\"rows_out\":5"), std::string::npos);
+	EXPECT_NE(json.find("\"children\":[]"), std::string::npos);
+}
@@ -0,0 +1,211 @@
+#include "Traits/RuntimeTraits.h"
+#include "communication/CommunicationData.h"
+#include "communication/factory/MessageFactory.h"
+#include "communication/messages/ComponentMessages.h"
+#include "communication/network/Client.h"
+#include "communication/network/Server.h"
+#include "distribution/primitives.h"
+#include "profile/QueryTrace.h"
+#include <algorithm>
+#include <blazingdb/manager/Context.h>
+#include <blazingdb/transport/io/reader_writer.h>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <cuda.h>
+#include <gtest/gtest.h>
+#include <limits>
+#include <rmm/rmm.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+
+using blazingdb::manager::Context;
+using blazingdb::transport::Address;
+using ral::communication::CommunicationData;
+using ral::communication::messages::ColumnDataMessage;
+using ral::communication::messages::Factory;
+using ral::communication::network::Client;
+using ral::communication::network::Node;
+using ral::communication::network::Server;
+namespace profile = ral::profile;
+
+// The trace of node 1 sending a message that node 0 waits for and receives
+struct QueryTraceTest : public ::testing::Test {
+	void SetUp() override {
+		send_id = worker.next_span_id();
+		worker.add_span(profile::span_kind::OPERATOR, "LogicalJoin (depth 0)", 100, 400, worker.next_span_id());
+		worker.add_span(profile::span_kind::SEND, "ColumnDataMessage_1", 200, 300, send_id, 0, 4096);
+
+		master.add_span(profile::span_kind::OPERATOR, "LogicalSort (depth 0)", 90, 500, master.next_span_id());
+		master.add_span(profile::span_kind::WAIT, "ColumnDataMessage_1", 150, 320, master.next_span_id(), send_id);
+		master.add_span(
+			profile::span_kind::RECEIVE, "ColumnDataMessage_1", 250, 310, master.next_span_id(), send_id, 4096);
+	}
+
+	profile::query_trace master{7, 0};
+	profile::query_trace worker{7, 1};
+	uint64_t send_id;
+};
+
+TEST_F(QueryTraceTest, SpanIdsAreUniqueAcrossNodes) {
+	EXPECT_NE(worker.next_span_id() >> 32, master.next_span_id() >> 32);
+	EXPECT_NE(master.next_span_id(), master.next_span_id());
+}
+
+TEST_F(QueryTraceTest, MergeKeepsTheSpansAndNamesOfTheOtherNode) {
+	std::vector<char> buffer = worker.serialize();
+	master.merge(buffer.data(), buffer.size());
+
+	std::vector<profile::trace_span> spans = master.get_spans();
+	ASSERT_EQ(5, spans.size());
+	const profile::trace_span & send = spans[4];
+	EXPECT_EQ(profile::span_kind::SEND, send.kind);
+	EXPECT_EQ(1, send.node);
+	EXPECT_EQ(send_id, send.span_id);
+	EXPECT_EQ(4096, send.bytes);
+	EXPECT_EQ("ColumnDataMessage_1", master.get_name(send));
+	EXPECT_EQ("LogicalJoin (depth 0)", master.get_name(spans[3]));
+
+	const profile::trace_span & receive = spans[2];
+	EXPECT_EQ(profile::span_kind::RECEIVE, receive.kind);
+	EXPECT_EQ(0, receive.thread);
+	EXPECT_EQ(send.span_id, receive.link_id);
+}
+
+TEST_F(QueryTraceTest, ChromeJsonHasAProcessPerNodeAndAFlowPerMessage) {
+	std::vector<char> buffer = worker.serialize();
+	master.merge(buffer.data(), buffer.size());
+	const std::string json = master.to_chrome_json();
+
+	EXPECT_NE(std::string::npos, json.find("\"args\":{\"name\":\"node 0\"}"));
+	EXPECT_NE(std::string::npos, json.find("\"args\":{\"name\":\"node 1\"}"));
+	EXPECT_NE(std::string::npos,
+		json.find("{\"name\":\"LogicalJoin (depth 0)\",\"cat\":\"operator\",\"ph\":\"X\",\"ts\":100,"
+				  "\"dur\":300,\"pid\":1"));
+	const std::string id = std::to_string(send_id);
+	EXPECT_NE(std::string::npos, json.find("\"ph\":\"s\",\"id\":" + id + ",\"ts\":200,\"pid\":1"));
+	EXPECT_NE(
+		std::string::npos, json.find("\"ph\":\"f\",\"id\":" + id + ",\"ts\":250,\"pid\":0,\"tid\":0,\"bp\":\"e\""));
+}
+
+TEST_F(QueryTraceTest, MergeRejectsWhatIsNotATrace) {
+	std::vector<char> buffer = worker.serialize();
+	EXPECT_THROW(master.merge(buffer.data(), buffer.size() - 1), std::runtime_error);
+	buffer[0] = 0;
+	EXPECT_THROW(master.merge(buffer.data(), buffer.size()), std::runtime_error);
+	EXPECT_EQ(3, master.get_spans().size());
+}
+
+TEST_F(QueryTraceTest, MergeRejectsCountsLargerThanTheBuffer) {
+	const uint32_t too_many = std::numeric_limits<uint32_t>::max();
+	for(size_t count_offset : {2 * sizeof(uint32_t), 3 * sizeof(uint32_t)}) {
+		std::vector<char> buffer = worker.serialize();
+		std::memcpy(buffer.data() + count_offset, &too_many, sizeof(too_many));
+		EXPECT_THROW(master.merge(buffer.data(), buffer.size()), std::runtime_error);
+	}
+	EXPECT_EQ(3, master.get_spans().size());
+}
+
+TEST(QueryTraceScopeTest, RecordsOnlyTracedQueries) {
+	{
+		profile::trace_scope scope(11, profile::span_kind::OPERATOR, "LogicalProject (depth 0)");
+		EXPECT_EQ(0, scope.get_span_id());
+	}
+	EXPECT_EQ(nullptr, profile::end_trace(11));
+
+	profile::start_trace(11, 2);
+	{
+		profile::trace_scope scope(11, profile::span_kind::SEND, "ColumnDataMessage_2");
+		EXPECT_EQ(3, scope.get_span_id() >> 32);
+		scope.set_bytes(64);
+	}
+	std::shared_ptr<profile::query_trace> trace = profile::end_trace(11);
+	ASSERT_NE(nullptr, trace);
+	EXPECT_EQ(nullptr, profile::find_trace(11));
+	std::vector<profile::trace_span> spans = trace->get_spans();
+	ASSERT_EQ(1, spans.size());
+	EXPECT_EQ(64, spans[0].bytes);
+	EXPECT_EQ(2, spans[0].node);
+	EXPECT_LE(spans[0].begin_us, spans[0].end_us);
+}
+
+// A cluster of two processes on the loopback: the worker sends a traced message and then its trace to the master, the
+// master links its receive of the message to the send of the worker.
+constexpr uint32_t cluster_context_token = 5231;
+constexpr int16_t master_port = 8010;
+constexpr int16_t worker_port = 8011;
+
+Context make_cluster_context() {
+	auto master_node = Node::Make(Address::TCP("127.0.0.1", master_port, 1234));
+	auto worker_node = Node::Make(Address::TCP("127.0.0.1", worker_port, 1234));
+	return Context(cluster_context_token, {master_node, worker_node}, master_node, "");
+}
+
+void initialize_node(int16_t port) {
+	cuInit(0);
+	rmmInitialize(nullptr);
+	blazingdb::transport::io::setPinnedBufferProvider(1024, 1);
+	CommunicationData::getInstance().initialize(0, "127.0.0.1", 0, "127.0.0.1", port, 1234);
+}
+
+TEST(QueryTraceClusterTest, MasterLinksTheReceiveToTheSendOfTheWorker) {
+	const std::string message_id = ColumnDataMessage::MessageID() + "_" + std::to_string(1);
+	pid_t worker_pid = fork();
+	if(worker_pid == 0) {
+		initialize_node(worker_port);
+		Context context = make_cluster_context();
+		profile::start_trace(cluster_context_token, 1);
+
+		std::vector<int32_t> values(100);
+		std::vector<gdf_column_cpp> columns(1);
+		columns[0].create_gdf_column(GDF_INT32,
+			gdf_dtype_extra_info{TIME_UNIT_NONE, nullptr},
+			values.size(),
+			values.data(),
+			ral::traits::get_dtype_size_in_bytes(GDF_INT32),
+			"");
+		auto self_node = CommunicationData::getInstance().getSharedSelfNode();
+		// the master may not be listening yet
+		std::this_thread::sleep_for(std::chrono::seconds(1));
+		Client::send(context.getMasterNode(),
+			*Factory::createColumnDataMessage(message_id, cluster_context_token, self_node, columns));
+
+		ral::distribution::sendTraceToMaster(context, profile::end_trace(cluster_context_token)->serialize());
+		std::exit(0);
+	}
+
+	initialize_node(master_port);
+	Server::start(master_port);
+	Server::getInstance().registerContext(cluster_context_token);
+	Context context = make_cluster_context();
+	profile::start_trace(cluster_context_token, 0);
+
+	Server::getInstance().getMessage(cluster_context_token, message_id);
+	std::shared_ptr<profile::query_trace> trace = profile::end_trace(cluster_context_token);
+	for(const std::vector<char> & node_trace : ral::distribution::collectTraces(context)) {
+		trace->merge(node_trace.data(), node_trace.size());
+	}
+	Server::getInstance().close();
+	int status = 0;
+	waitpid(worker_pid, &status, 0);
+	EXPECT_EQ(0, status);
+
+	std::vector<profile::trace_span> spans = trace->get_spans();
+	auto find_span = [&spans](profile::span_kind kind, int32_t node) {
+		return std::find_if(spans.begin(), spans.end(), [kind, node](const profile::trace_span & span) {
+			return span.kind == kind && span.node == node;
+		});
+	};
+	auto send = find_span(profile::span_kind::SEND, 1);
+	auto wait = find_span(profile::span_kind::WAIT, 0);
+	auto receive = find_span(profile::span_kind::RECEIVE, 0);
+	ASSERT_NE(spans.end(), send);
+	ASSERT_NE(spans.end(), wait);
+	ASSERT_NE(spans.end(), receive);
+	EXPECT_EQ(send->span_id, wait->link_id);
+	EXPECT_EQ(send->span_id, receive->link_id);
+	EXPECT_LE(100 * sizeof(int32_t), receive->bytes);
+	EXPECT_EQ(message_id, trace->get_name(*send));
+	EXPECT_NE(std::string::npos, trace->to_chrome_json().find("\"ph\":\"f\""));
+}
@@ -7,6 +7,10 @@
 
 #include "../utils/gdf/library/table_group.h"
 #include <DataFrame.h>
+#include <atomic>
+#include <chrono>
+#include <numeric>
+#include <thread>
 #include <vector>
 
 
@@ -99,3 +103,93 @@ TEST_F(ResultSetRepositoryTest, string_resulset_test) {
        delete[] char_array;
   }
 }
+
+static blazing_frame make_int32_frame(gdf_size_type num_rows) {
+  std::vector<int32_t> values(num_rows);
+  std::iota(values.begin(), values.end(), 0);
+  gdf_column_cpp column;
+  column.create_gdf_column(GDF_INT32, gdf_dtype_extra_info{TIME_UNIT_NONE}, num_rows, values.data(), 4, "value");
+  blazing_frame frame;
+  std::vector<gdf_column_cpp> columns;
+  columns.push_back(column);
+  frame.add_table(columns);
+  return frame;
+}
+
+// Thousands of clients blocked on their results across many sessions while the queries finish concurrently: each one
+// wakes up for its own result
+TEST_F(ResultSetRepositoryTest, concurrent_waiters_test) {
+  const int num_sessions = 16;
+  const int queries_per_session = 128;
+  const int num_queries = num_sessions * queries_per_session;
+  const int num_producers = 8;
+
+  std::vector<connection_id_t> sessions;
+  for(int i = 0; i < num_sessions; i++) {
+    sessions.push_back(result_set_repository::get_instance().init_session());
+  }
+  std::vector<query_token_t> tokens;
+  for(int i = 0; i < num_queries; i++) {
+    tokens.push_back(result_set_repository::get_instance().register_query(sessions[i % num_sessions], 1000 + i));
+  }
+
+  std::atomic<int> num_ready{0};
+  std::vector<std::thread> waiters;
+  for(int i = 0; i < num_queries; i++) {
+    waiters.emplace_back([&, i]() {
+      result_set_t result = result_set_repository::get_instance().get_result(sessions[i % num_sessions], tokens[i]);
+      if(result.is_ready && result.result_frame.get_num_rows_in_table(0) == 4) {
+        num_ready++;
+      }
+      result_set_repository::get_instance().try_free_result(sessions[i % num_sessions], tokens[i]);
+    });
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> producers;
+  for(int p = 0; p < num_producers; p++) {
+    producers.emplace_back([&, p]() {
+      for(int i = p; i < num_queries; i += num_producers) {
+        result_set_repository::get_instance().update_token(tokens[i], make_int32_frame(4), .01);
+      }
+    });
+  }
+  for(std::thread & producer : producers) {
+    producer.join();
+  }
+  for(std::thread & waiter : waiters) {
+    waiter.join();
+  }
+  double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  std::cout << num_queries << " waiters served in " << elapsed << " ms" << std::endl;
+
+  EXPECT_EQ(num_ready, num_queries);
+  for(connection_id_t session : sessions) {
+    result_set_repository::get_instance().remove_all_connection_tokens(session);
+  }
+}
+
+TEST_F(ResultSetRepositoryTest, result_ttl_test) {
+  query_token_t unfetched_token = result_set_repository::get_instance().register_query(connection, 1);
+  query_token_t fetched_token = result_set_repository::get_instance().register_query(connection, 2);
+  result_set_repository::get_instance().update_token(unfetched_token, make_int32_frame(4), .01);
+  result_set_repository::get_instance().update_token(fetched_token, make_int32_frame(4), .01);
+  result_set_repository::get_instance().get_result(connection, fetched_token);
+
+  result_set_repository::set_result_ttl(std::chrono::seconds(0));
+  EXPECT_EQ(result_set_repository::get_instance().evict_expired_results(), 0);
+
+  // neither the query still running nor the result a client fetched expire
+  result_set_repository::set_result_ttl(std::chrono::seconds(1));
+  std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+  EXPECT_EQ(result_set_repository::get_instance().evict_expired_results(), 1);
+  result_set_repository::set_result_ttl(std::chrono::seconds(600));
+
+  try {
+    result_set_repository::get_instance().get_result(connection, unfetched_token);
+    EXPECT_TRUE(false);
+  } catch(std::runtime_error const & err) {
+    EXPECT_EQ(err.what(), std::string("Result set does not exist"));
+  }
+  result_set_repository::get_instance().try_free_result(connection, fetched_token);
+}
@@ -0,0 +1,234 @@
+#include "cuDF/Allocator.h"
+#include "spill/SpillManager.h"
+#include <cstdlib>
+#include <cstring>
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+using blazingdb::manager::MemoryTracker;
+using ral::spill::spill_manager;
+using ral::spill::spillable_buffer;
+namespace Allocator = cuDF::Allocator;
+
+// Host memory in place of device memory, so the device is the heap and pinned memory is the heap too
+class host_memory_resource : public Allocator::memory_resource {
+public:
+	void allocate(void ** pointer, std::size_t size, cudaStream_t stream) override { *pointer = std::malloc(size); }
+
+	void deallocate(void * pointer, cudaStream_t stream) override { std::free(pointer); }
+};
+
+class host_spill_memory : public ral::spill::host_memory {
+public:
+	void * allocate(std::size_t size) override { return std::malloc(size); }
+
+	void deallocate(void * pointer) override { std::free(pointer); }
+
+	void copy_to_host(void * host, const void * device, std::size_t size) override { std::memcpy(host, device, size); }
+
+	void copy_to_device(void * device, const void * host, std::size_t size) override {
+		std::memcpy(device, host, size);
+	}
+};
+
+struct SpillManagerTest : public ::testing::Test {
+	void SetUp() override {
+		previous_resource = Allocator::get_memory_resource();
+		Allocator::set_memory_resource(std::make_shared<host_memory_resource>());
+		previous_host_memory = ral::spill::get_host_memory();
+		ral::spill::set_host_memory(std::make_shared<host_spill_memory>());
+
+		char directory_template[] = "/tmp/spill_manager_test_XXXXXX";
+		directory = mkdtemp(directory_template);
+		file_system_manager = std::make_shared<FileSystemManager>();
+	}
+
+	void TearDown() override {
+		Allocator::set_memory_resource(previous_resource);
+		ral::spill::set_host_memory(previous_host_memory);
+		std::system(("rm -rf " + directory).c_str());
+	}
+
+	std::unique_ptr<spill_manager> make_manager(std::size_t device_limit, std::size_t host_limit) {
+		return std::unique_ptr<spill_manager>(new spill_manager(
+			device_limit, host_limit, Uri(FileSystemType::LOCAL, "local", Path(directory)), file_system_manager));
+	}
+
+	// device memory filled with a pattern that starts at seed
+	static void * make_device_data(std::size_t size, char seed) {
+		void * device = nullptr;
+		Allocator::allocate(&device, size);
+		for(std::size_t i = 0; i < size; i++) {
+			static_cast<char *>(device)[i] = static_cast<char>(seed + i);
+		}
+		return device;
+	}
+
+	static bool has_pattern(void * device, std::size_t size, char seed) {
+		for(std::size_t i = 0; i < size; i++) {
+			if(static_cast<char *>(device)[i] != static_cast<char>(seed + i)) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	std::shared_ptr<Allocator::memory_resource> previous_resource;
+	std::shared_ptr<ral::spill::host_memory> previous_host_memory;
+	std::string directory;
+	std::shared_ptr<FileSystemManager> file_system_manager;
+};
+
+TEST_F(SpillManagerTest, OldestBuffersSpillWhenOverTheDeviceLimit) {
+	auto manager = make_manager(3000, 10000);
+	std::vector<std::shared_ptr<spillable_buffer>> buffers;
+	for(char i = 0; i < 4; i++) {
+		buffers.push_back(spillable_buffer::make(*manager, make_device_data(1000, i), 1000));
+	}
+
+	EXPECT_TRUE(buffers[0]->is_spilled());
+	EXPECT_FALSE(buffers[1]->is_spilled());
+	EXPECT_FALSE(buffers[3]->is_spilled());
+	EXPECT_EQ(manager->get_device_bytes(), 3000);
+	EXPECT_EQ(manager->get_host_bytes(), 1000);
+
+	// taking the spilled one back makes room for it, the next oldest goes
+	void * first = buffers[0]->take();
+	EXPECT_TRUE(has_pattern(first, 1000, 0));
+	EXPECT_TRUE(buffers[1]->is_spilled());
+	EXPECT_EQ(manager->get_device_bytes(), 2000);
+	EXPECT_EQ(manager->get_host_bytes(), 1000);
+	Allocator::deallocate(first);
+
+	void * second = buffers[1]->take();
+	EXPECT_TRUE(has_pattern(second, 1000, 1));
+	EXPECT_EQ(manager->get_host_bytes(), 0);
+	EXPECT_EQ(manager->get_bytes_spilled(), 2000);
+	Allocator::deallocate(second);
+}
+
+TEST_F(SpillManagerTest, SpilledBytesGoToDiskOverTheHostLimit) {
+	auto manager = make_manager(1000, 2500);
+	std::vector<std::shared_ptr<spillable_buffer>> buffers;
+	for(char i = 0; i < 5; i++) {
+		buffers.push_back(spillable_buffer::make(*manager, make_device_data(1000, i), 1000));
+	}
+
+	EXPECT_EQ(manager->get_device_bytes(), 1000);
+	EXPECT_EQ(manager->get_host_bytes(), 2000);
+	EXPECT_EQ(manager->get_disk_bytes(), 2000);
+
+	for(char i = 0; i < 5; i++) {
+		void * device = buffers[i]->take();
+		EXPECT_TRUE(has_pattern(device, 1000, i)) << "buffer " << int(i);
+		Allocator::deallocate(device);
+	}
+	EXPECT_EQ(manager->get_host_bytes(), 0);
+	EXPECT_EQ(manager->get_disk_bytes(), 0);
+	// taking the first ones back spilled the newest, which pushed another one to disk
+	EXPECT_EQ(manager->get_bytes_written_to_disk(), 3000);
+	EXPECT_TRUE(file_system_manager->list(Uri(FileSystemType::LOCAL, "local", Path(directory))).empty());
+}
+
+TEST_F(SpillManagerTest, BufferLargerThanTheHostLimitGoesStraightToDisk) {
+	auto manager = make_manager(100, 1000);
+	std::shared_ptr<spillable_buffer> large = spillable_buffer::make(*manager, make_device_data(50000, 7), 50000);
+	std::shared_ptr<spillable_buffer> small = spillable_buffer::make(*manager, make_device_data(10, 3), 10);
+
+	EXPECT_TRUE(large->is_spilled());
+	EXPECT_EQ(manager->get_host_bytes(), 0);
+	EXPECT_EQ(manager->get_disk_bytes(), 50000);
+
+	void * device = large->take();
+	EXPECT_TRUE(has_pattern(device, 50000, 7));
+	Allocator::deallocate(device);
+}
+
+TEST_F(SpillManagerTest, DroppedBuffersFreeTheirHostMemoryAndFiles) {
+	auto manager = make_manager(1000, 1000);
+	{
+		std::vector<std::shared_ptr<spillable_buffer>> buffers;
+		for(char i = 0; i < 4; i++) {
+			buffers.push_back(spillable_buffer::make(*manager, make_device_data(1000, i), 1000));
+		}
+		EXPECT_EQ(manager->get_disk_bytes(), 2000);
+	}
+	EXPECT_EQ(manager->get_device_bytes(), 0);
+	EXPECT_EQ(manager->get_host_bytes(), 0);
+	EXPECT_EQ(manager->get_disk_bytes(), 0);
+	EXPECT_TRUE(file_system_manager->list(Uri(FileSystemType::LOCAL, "local", Path(directory))).empty());
+}
+
+TEST_F(SpillManagerTest, SpillingGivesBackQueryMemory) {
+	// the device limit leaves room in the budget for the run being made
+	auto tracker = std::make_shared<MemoryTracker>(3000);
+	Allocator::memory_scope scope(tracker, "1:sort");
+	auto manager = make_manager(2000, 10000);
+
+	std::vector<std::shared_ptr<spillable_buffer>> runs;
+	for(char i = 0; i < 6; i++) {
+		// without spilling the fourth run would go over the budget of the query
+		runs.push_back(spillable_buffer::make(*manager, make_device_data(1000, i), 1000));
+		EXPECT_LE(tracker->getCurrent(), 2000);
+	}
+
+	for(char i = 0; i < 6; i++) {
+		void * device = runs[i]->take();
+		EXPECT_TRUE(has_pattern(device, 1000, i));
+		Allocator::deallocate(device);
+	}
+	EXPECT_EQ(tracker->getCurrent(), 0);
+	EXPECT_LE(tracker->getPeak(), 3000);
+}
+
+TEST_F(SpillManagerTest, OutOfCoreOnlyWhenTheBudgetIsShort) {
+	MemoryTracker unbounded;
+	EXPECT_EQ(ral::spill::get_out_of_core_device_limit(unbounded, 1 << 30), 0);
+
+	MemoryTracker tracker(10000);
+	ASSERT_TRUE(tracker.tryReserve(4000, "1:scan"));
+	EXPECT_EQ(ral::spill::get_out_of_core_device_limit(tracker, 6000), 0);
+	EXPECT_EQ(ral::spill::get_out_of_core_device_limit(tracker, 6001), 3000);
+
+	ASSERT_TRUE(tracker.tryReserve(6000, "1:scan"));
+	EXPECT_EQ(ral::spill::get_out_of_core_device_limit(tracker, 1), 1);
+}
+
+TEST_F(SpillManagerTest, OutOfCorePartitionsAreClamped) {
+	EXPECT_EQ(ral::spill::get_out_of_core_partitions(1000, 3000, "1:sort"), 2);
+	EXPECT_EQ(ral::spill::get_out_of_core_partitions(10000, 3000, "1:sort"), 7);
+
+	// a partition can take the half of the budget left to the one being worked on
+	const std::size_t max_partitions = ral::spill::MAX_OUT_OF_CORE_PARTITIONS;
+	EXPECT_EQ(ral::spill::get_out_of_core_partitions(max_partitions * 3000, 3000, "1:sort"), max_partitions);
+
+	// with the budget used up the device limit is a single byte
+	EXPECT_THROW(ral::spill::get_out_of_core_partitions(max_partitions * 3000 + 1, 3000, "1:sort"),
+		Allocator::QueryMemoryExceeded);
+	EXPECT_THROW(ral::spill::get_out_of_core_partitions(1 << 30, 1, "1:join"), Allocator::QueryMemoryExceeded);
+}
+
+TEST_F(SpillManagerTest, BuffersAddedAndTakenConcurrently) {
+	auto manager = make_manager(4000, 8000);
+	std::vector<std::thread> threads;
+	for(int t = 0; t < 4; t++) {
+		threads.emplace_back([&, t]() {
+			std::vector<std::shared_ptr<spillable_buffer>> buffers;
+			for(char i = 0; i < 10; i++) {
+				buffers.push_back(spillable_buffer::make(*manager, make_device_data(500, t * 10 + i), 500));
+			}
+			for(char i = 0; i < 10; i++) {
+				void * device = buffers[i]->take();
+				EXPECT_TRUE(has_pattern(device, 500, t * 10 + i));
+				Allocator::deallocate(device);
+			}
+		});
+	}
+	for(auto & thread : threads) {
+		thread.join();
+	}
+	EXPECT_EQ(manager->get_device_bytes(), 0);
+	EXPECT_EQ(manager->get_host_bytes(), 0);
+	EXPECT_EQ(manager->get_disk_bytes(), 0);
+}
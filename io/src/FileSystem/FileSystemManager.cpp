@@ -94,3 +94,15 @@ std::shared_ptr<arrow::io::RandomAccessFile> FileSystemManager::openReadable(con
 std::shared_ptr<arrow::io::OutputStream> FileSystemManager::openWriteable(const Uri & uri) const {
 	return this->pimpl->openWriteable(uri);
 }
+
+void FileSystemManager::setBlockCache(std::shared_ptr<BlockCache> blockCache) {
+	this->pimpl->setBlockCache(blockCache);
+}
+
+void FileSystemManager::setMetadataCache(std::shared_ptr<MetadataCache> metadataCache) {
+	this->pimpl->setMetadataCache(metadataCache);
+}
+
+void FileSystemManager::setMemoryMappedLocalReads(bool enabled) { this->pimpl->setMemoryMappedLocalReads(enabled); }
+
+void FileSystemManager::invalidateCaches(const Uri & uri) const { this->pimpl->invalidateCaches(uri); }
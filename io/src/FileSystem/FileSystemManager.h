@@ -13,6 +13,9 @@
 #include "FileSystem/FileFilter.h"
 #include "FileSystem/FileSystemEntity.h"
 
+class BlockCache;
+class MetadataCache;
+
 class FileSystemManager {
 public:
 	FileSystemManager();
@@ -45,6 +48,21 @@ public:
 	std::shared_ptr<arrow::io::RandomAccessFile> openReadable(const Uri & uri) const;
 	std::shared_ptr<arrow::io::OutputStream> openWriteable(const Uri & uri) const;
 
+	// Files of remote filesystems (S3, GCS, HDFS) are read through this cache, BlockCache::getDefaultInstance() by
+	// default (none unless the process set one) and nullptr disables it
+	void setBlockCache(std::shared_ptr<BlockCache> blockCache);
+
+	// exists, getFileStatus and list of remote filesystems are answered from this cache,
+	// MetadataCache::getDefaultInstance() by default and nullptr disables it
+	void setMetadataCache(std::shared_ptr<MetadataCache> metadataCache);
+
+	// Files of local filesystems are opened as MappedReadableFile, reads of them are zero copy. Disabled by default.
+	void setMemoryMappedLocalReads(bool enabled);
+
+	// Drops the cached blocks, statuses and listings of uri, for changes made without going through this manager.
+	// The writes done through this manager invalidate what they change on their own.
+	void invalidateCaches(const Uri & uri) const;
+
 private:
 	class Private;
 	const std::unique_ptr<Private> pimpl;  // private implementation
@@ -0,0 +1,174 @@
+#include "MappedReadableFile.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// Owns the mapping, it is unmapped when the file and every slice of it are gone
+class Mapping : public arrow::Buffer {
+public:
+	Mapping(uint8_t * data, int64_t size) : arrow::Buffer(data, size) {}
+
+	~Mapping() {
+		if(size_ > 0) {
+			munmap(const_cast<uint8_t *>(data_), size_);
+		}
+	}
+};
+
+int toMadvise(MappedFileAdvice advice) {
+	switch(advice) {
+	case MappedFileAdvice::SEQUENTIAL: return MADV_SEQUENTIAL;
+	case MappedFileAdvice::RANDOM: return MADV_RANDOM;
+	case MappedFileAdvice::WILLNEED: return MADV_WILLNEED;
+	case MappedFileAdvice::DONTNEED: return MADV_DONTNEED;
+	default: return MADV_NORMAL;
+	}
+}
+
+arrow::Status errnoStatus(const std::string & message) {
+	return arrow::Status::IOError(message + ": " + std::strerror(errno));
+}
+
+}  // namespace
+
+arrow::Status MappedReadableFile::Open(
+	const std::string & path, MappedFileAdvice advice, std::shared_ptr<MappedReadableFile> * file) {
+	const int fd = open(path.c_str(), O_RDONLY);
+	if(fd < 0) {
+		return errnoStatus("Unable to open " + path);
+	}
+
+	struct stat stat_buf;
+	if(fstat(fd, &stat_buf) != 0) {
+		close(fd);
+		return errnoStatus("Unable to get the size of " + path);
+	}
+
+	// a zero length mapping is not allowed, empty files get an empty buffer
+	uint8_t * data = nullptr;
+	if(stat_buf.st_size > 0) {
+		void * address = mmap(nullptr, stat_buf.st_size, PROT_READ, MAP_SHARED, fd, 0);
+		if(address == MAP_FAILED) {
+			close(fd);
+			return errnoStatus("Unable to map " + path);
+		}
+		data = static_cast<uint8_t *>(address);
+	}
+	close(fd);  // the mapping holds its own reference to the file
+
+	file->reset(new MappedReadableFile(std::make_shared<Mapping>(data, stat_buf.st_size)));
+	if(advice != MappedFileAdvice::NORMAL) {
+		return (*file)->Advise(0, stat_buf.st_size, advice);
+	}
+	return arrow::Status::OK();
+}
+
+MappedReadableFile::MappedReadableFile(std::shared_ptr<arrow::Buffer> mapping)
+	: mapping(mapping), size(mapping->size()), position(0) {}
+
+MappedReadableFile::~MappedReadableFile() {}
+
+arrow::Status MappedReadableFile::Close() {
+	this->mapping.reset();
+	return arrow::Status::OK();
+}
+
+bool MappedReadableFile::closed() const { return this->mapping == nullptr; }
+
+arrow::Status MappedReadableFile::GetSize(int64_t * size) {
+	*size = this->size;
+	return arrow::Status::OK();
+}
+
+arrow::Status MappedReadableFile::Seek(int64_t position) {
+	if(position < 0) {
+		return arrow::Status::Invalid("Negative position " + std::to_string(position));
+	}
+	this->position = position;
+	return arrow::Status::OK();
+}
+
+arrow::Status MappedReadableFile::Tell(int64_t * position) const {
+	*position = this->position;
+	return arrow::Status::OK();
+}
+
+arrow::Status MappedReadableFile::checkRead(int64_t position, int64_t * nbytes) const {
+	if(this->closed()) {
+		return arrow::Status::IOError("Read of a closed file");
+	}
+	if(position < 0 || *nbytes < 0) {
+		return arrow::Status::Invalid("Invalid read of " + std::to_string(*nbytes) + " bytes at " +
+									  std::to_string(position));
+	}
+	*nbytes = std::min(*nbytes, std::max<int64_t>(this->size - position, 0));
+	return arrow::Status::OK();
+}
+
+arrow::Status MappedReadableFile::Read(int64_t nbytes, int64_t * bytesRead, void * buffer) {
+	arrow::Status status = this->ReadAt(this->position, nbytes, bytesRead, buffer);
+	if(status.ok()) {
+		this->position += *bytesRead;
+	}
+	return status;
+}
+
+arrow::Status MappedReadableFile::Read(int64_t nbytes, std::shared_ptr<arrow::Buffer> * out) {
+	arrow::Status status = this->ReadAt(this->position, nbytes, out);
+	if(status.ok()) {
+		this->position += (*out)->size();
+	}
+	return status;
+}
+
+arrow::Status MappedReadableFile::ReadAt(int64_t position, int64_t nbytes, int64_t * bytesRead, void * buffer) {
+	*bytesRead = 0;
+	arrow::Status status = this->checkRead(position, &nbytes);
+	if(!status.ok()) {
+		return status;
+	}
+
+	if(nbytes > 0) {
+		std::memcpy(buffer, this->mapping->data() + position, nbytes);
+	}
+	*bytesRead = nbytes;
+	return arrow::Status::OK();
+}
+
+arrow::Status MappedReadableFile::ReadAt(int64_t position, int64_t nbytes, std::shared_ptr<arrow::Buffer> * out) {
+	arrow::Status status = this->checkRead(position, &nbytes);
+	if(!status.ok()) {
+		return status;
+	}
+
+	*out = arrow::SliceBuffer(this->mapping, std::min(position, this->size), nbytes);
+	return arrow::Status::OK();
+}
+
+bool MappedReadableFile::supports_zero_copy() const { return true; }
+
+arrow::Status MappedReadableFile::Advise(int64_t position, int64_t nbytes, MappedFileAdvice advice) {
+	int64_t length = nbytes;
+	arrow::Status status = this->checkRead(position, &length);
+	if(!status.ok() || length == 0) {
+		return status;
+	}
+
+	// madvise works on whole pages
+	static const int64_t pageSize = sysconf(_SC_PAGESIZE);
+	const int64_t start = position - position % pageSize;
+	length += position - start;
+
+	uint8_t * address = const_cast<uint8_t *>(this->mapping->data()) + start;
+	if(madvise(address, length, toMadvise(advice)) != 0) {
+		return errnoStatus("madvise failed");
+	}
+	return arrow::Status::OK();
+}
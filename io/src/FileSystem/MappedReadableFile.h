@@ -0,0 +1,72 @@
+/*
+ * MappedReadableFile.h
+ *
+ * Local file read through a memory mapping. Reads into a buffer hand out slices of the mapping instead of copies, and
+ * the slices keep the mapping alive after the file is closed. Readers that know which ranges they are going to touch
+ * (i.e. the column chunks of the projected columns of a parquet file) can tell the kernel with Advise.
+ */
+
+#ifndef _BLAZING_MAPPED_READABLE_FILE_H_
+#define _BLAZING_MAPPED_READABLE_FILE_H_
+
+#include <memory>
+#include <string>
+
+#include "arrow/buffer.h"
+#include "arrow/io/interfaces.h"
+#include "arrow/status.h"
+
+// madvise hints
+enum class MappedFileAdvice : char {
+	NORMAL,
+	SEQUENTIAL,  // aggressive read-ahead, pages behind the reads can be dropped early
+	RANDOM,		 // no read-ahead, for files where only some ranges are read
+	WILLNEED,	// start reading the range in the background
+	DONTNEED
+};
+
+class MappedReadableFile : public arrow::io::RandomAccessFile {
+public:
+	static arrow::Status Open(const std::string & path,
+		MappedFileAdvice advice,
+		std::shared_ptr<MappedReadableFile> * file);
+	~MappedReadableFile();
+
+	arrow::Status Close() override;
+
+	arrow::Status GetSize(int64_t * size) override;
+
+	arrow::Status Read(int64_t nbytes, int64_t * bytesRead, void * buffer) override;
+
+	arrow::Status Read(int64_t nbytes, std::shared_ptr<arrow::Buffer> * out) override;
+
+	// The ReadAt calls leave the position of Read alone, tasks can read parts of the file through it in parallel
+	arrow::Status ReadAt(int64_t position, int64_t nbytes, int64_t * bytesRead, void * buffer) override;
+
+	// out is a slice of the mapping, no bytes are copied
+	arrow::Status ReadAt(int64_t position, int64_t nbytes, std::shared_ptr<arrow::Buffer> * out) override;
+
+	bool supports_zero_copy() const override;
+
+	arrow::Status Seek(int64_t position) override;
+	arrow::Status Tell(int64_t * position) const override;
+
+	bool closed() const override;
+
+	// Applies the hint to the pages of [position, position + nbytes)
+	arrow::Status Advise(int64_t position, int64_t nbytes, MappedFileAdvice advice);
+
+private:
+	explicit MappedReadableFile(std::shared_ptr<arrow::Buffer> mapping);
+
+	// clips the read to the file, fails if the file is closed
+	arrow::Status checkRead(int64_t position, int64_t * nbytes) const;
+
+	std::shared_ptr<arrow::Buffer> mapping;
+	int64_t size;
+	int64_t position;
+
+	ARROW_DISALLOW_COPY_AND_ASSIGN(MappedReadableFile);
+};
+
+#endif /* _BLAZING_MAPPED_READABLE_FILE_H_ */
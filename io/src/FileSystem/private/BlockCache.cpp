@@ -0,0 +1,315 @@
+#include "BlockCache.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <unistd.h>
+
+#include "Library/Logging/Logger.h"
+
+namespace Logging = Library::Logging;
+
+BlockCache::BlockCache(BlockCacheOptions options) : options(options), spillCounter(0) {
+	this->options.blockSize = std::max<int64_t>(this->options.blockSize, 1);
+}
+
+BlockCache::~BlockCache() {
+	for(const DiskEntry & entry : this->diskBlocks) {
+		std::remove(entry.path.c_str());
+	}
+}
+
+namespace {
+
+std::shared_ptr<BlockCache> defaultInstance;
+
+}  // namespace
+
+std::shared_ptr<BlockCache> BlockCache::getDefaultInstance() { return std::atomic_load(&defaultInstance); }
+
+void BlockCache::setDefaultInstance(std::shared_ptr<BlockCache> cache) { std::atomic_store(&defaultInstance, cache); }
+
+std::string BlockCache::getFileKey(const std::string & uri, int64_t size, uint64_t modificationTime) {
+	return uri + "@" + std::to_string(size) + "-" + std::to_string(modificationTime);
+}
+
+std::string BlockCache::getBlockKey(const std::string & fileKey, int64_t blockIndex) {
+	return fileKey + "#" + std::to_string(blockIndex);
+}
+
+arrow::Status BlockCache::getBlocks(const std::string & fileKey,
+	int64_t firstBlock,
+	int64_t lastBlock,
+	const LoadFunction & load,
+	std::vector<std::shared_ptr<const Block>> * blocks) {
+	const size_t numBlocks = lastBlock >= firstBlock ? lastBlock - firstBlock + 1 : 0;
+	blocks->assign(numBlocks, nullptr);
+
+	std::vector<std::string> keys(numBlocks);
+	std::vector<std::shared_future<LoadResult>> pendingLoads(numBlocks);
+	std::vector<std::shared_ptr<std::promise<LoadResult>>> promises(numBlocks);
+	std::vector<DiskEntry> diskReads(numBlocks);
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		for(size_t i = 0; i < numBlocks; i++) {
+			keys[i] = getBlockKey(fileKey, firstBlock + i);
+
+			auto inMemory = this->memoryIndex.find(keys[i]);
+			if(inMemory != this->memoryIndex.end()) {
+				this->memoryBlocks.splice(this->memoryBlocks.begin(), this->memoryBlocks, inMemory->second);
+				(*blocks)[i] = inMemory->second->block;
+				this->stats.memoryHits++;
+				this->stats.bytesSaved += (*blocks)[i]->size();
+				continue;
+			}
+
+			auto loading = this->loadingBlocks.find(keys[i]);
+			if(loading != this->loadingBlocks.end()) {
+				pendingLoads[i] = loading->second;
+				continue;
+			}
+
+			promises[i] = std::make_shared<std::promise<LoadResult>>();
+			this->loadingBlocks[keys[i]] = promises[i]->get_future().share();
+
+			auto onDisk = this->diskIndex.find(keys[i]);
+			if(onDisk != this->diskIndex.end()) {
+				this->diskBlocks.splice(this->diskBlocks.begin(), this->diskBlocks, onDisk->second);
+				diskReads[i] = *onDisk->second;
+			}
+		}
+	}
+
+	// spilled blocks first, the ones that can not be read back are loaded like any other missing block
+	std::vector<LoadResult> results(numBlocks);
+	for(size_t i = 0; i < numBlocks; i++) {
+		if(!promises[i] || diskReads[i].path.empty()) {
+			continue;
+		}
+
+		auto block = std::make_shared<Block>();
+		if(this->readSpillFile(diskReads[i].path, diskReads[i].size, block.get())) {
+			results[i].block = block;
+		}
+
+		std::lock_guard<std::mutex> lock(this->mutex);
+		if(results[i].block) {
+			this->stats.diskHits++;
+			this->stats.bytesSaved += block->size();
+		} else {
+			auto onDisk = this->diskIndex.find(keys[i]);
+			if(onDisk != this->diskIndex.end() && onDisk->second->path == diskReads[i].path) {
+				this->stats.diskBytes -= onDisk->second->size;
+				this->diskBlocks.erase(onDisk->second);
+				this->diskIndex.erase(onDisk);
+			}
+		}
+	}
+
+	for(size_t runStart = 0; runStart < numBlocks;) {
+		if(!promises[runStart] || results[runStart].block) {
+			runStart++;
+			continue;
+		}
+		size_t runEnd = runStart;
+		while(runEnd + 1 < numBlocks && promises[runEnd + 1] && !results[runEnd + 1].block) {
+			runEnd++;
+		}
+
+		std::vector<uint8_t> data;
+		arrow::Status status;
+		try {
+			status = load(firstBlock + runStart, firstBlock + runEnd, &data);
+		} catch(const std::exception & e) {
+			status = arrow::Status::IOError(e.what());
+		}
+
+		const int64_t blockSize = this->options.blockSize;
+		for(size_t i = runStart; i <= runEnd; i++) {
+			const int64_t blockStart = (i - runStart) * blockSize;
+			if(status.ok() && blockStart >= static_cast<int64_t>(data.size())) {
+				status = arrow::Status::IOError("Load of blocks " + std::to_string(firstBlock + runStart) + " to " +
+												std::to_string(firstBlock + runEnd) + " returned " +
+												std::to_string(data.size()) + " bytes");
+			}
+			results[i].status = status;
+			if(status.ok()) {
+				const int64_t blockEnd = std::min<int64_t>(blockStart + blockSize, data.size());
+				results[i].block = std::make_shared<Block>(data.begin() + blockStart, data.begin() + blockEnd);
+			}
+		}
+
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->stats.misses += runEnd - runStart + 1;
+		runStart = runEnd + 1;
+	}
+
+	std::vector<MemoryEntry> spilled;
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		for(size_t i = 0; i < numBlocks; i++) {
+			if(!promises[i]) {
+				continue;
+			}
+			this->loadingBlocks.erase(keys[i]);
+			if(results[i].block) {
+				this->insertInMemory(keys[i], results[i].block, &spilled);
+			}
+		}
+	}
+	for(size_t i = 0; i < numBlocks; i++) {
+		if(promises[i]) {
+			promises[i]->set_value(results[i]);
+		}
+	}
+	this->spill(spilled);
+
+	// blocks loaded by other readers are waited for last, after the ones this call loads are published
+	arrow::Status status;
+	for(size_t i = 0; i < numBlocks; i++) {
+		if(pendingLoads[i].valid()) {
+			results[i] = pendingLoads[i].get();
+			if(results[i].block) {
+				std::lock_guard<std::mutex> lock(this->mutex);
+				this->stats.memoryHits++;
+				this->stats.bytesSaved += results[i].block->size();
+			}
+		}
+
+		if(!results[i].status.ok() && status.ok()) {
+			status = results[i].status;
+		}
+		if(results[i].block) {
+			(*blocks)[i] = results[i].block;
+		}
+	}
+	return status;
+}
+
+void BlockCache::insertInMemory(
+	const std::string & key, std::shared_ptr<const Block> block, std::vector<MemoryEntry> * spilled) {
+	auto inMemory = this->memoryIndex.find(key);
+	if(inMemory != this->memoryIndex.end()) {
+		this->stats.memoryBytes -= inMemory->second->block->size();
+		this->memoryBlocks.erase(inMemory->second);
+		this->memoryIndex.erase(inMemory);
+	}
+
+	this->memoryBlocks.push_front(MemoryEntry{key, block});
+	this->memoryIndex[key] = this->memoryBlocks.begin();
+	this->stats.memoryBytes += block->size();
+
+	while(this->stats.memoryBytes > this->options.memoryCapacity && !this->memoryBlocks.empty()) {
+		MemoryEntry & leastRecentlyUsed = this->memoryBlocks.back();
+		this->stats.memoryBytes -= leastRecentlyUsed.block->size();
+		this->memoryIndex.erase(leastRecentlyUsed.key);
+
+		if(this->diskIndex.count(leastRecentlyUsed.key) == 0) {
+			if(this->options.spillDirectory.empty()) {
+				this->stats.evictions++;
+			} else {
+				spilled->push_back(std::move(leastRecentlyUsed));
+			}
+		}
+		this->memoryBlocks.pop_back();
+	}
+}
+
+void BlockCache::spill(std::vector<MemoryEntry> & spilled) {
+	for(MemoryEntry & entry : spilled) {
+		std::string path;
+		{
+			std::lock_guard<std::mutex> lock(this->mutex);
+			path = this->options.spillDirectory + "/blazing-block-cache-" + std::to_string(getpid()) + "-" +
+				   std::to_string(this->spillCounter++);
+		}
+
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		file.write(reinterpret_cast<const char *>(entry.block->data()), entry.block->size());
+		file.close();
+		if(!file) {
+			Logging::Logger().logWarn("BlockCache could not spill a block to " + path);
+			std::remove(path.c_str());
+
+			std::lock_guard<std::mutex> lock(this->mutex);
+			this->stats.evictions++;
+			continue;
+		}
+
+		std::lock_guard<std::mutex> lock(this->mutex);
+		if(this->diskIndex.count(entry.key) > 0) {
+			std::remove(path.c_str());
+			continue;
+		}
+		const int64_t size = entry.block->size();
+		this->diskBlocks.push_front(DiskEntry{entry.key, path, size});
+		this->diskIndex[entry.key] = this->diskBlocks.begin();
+		this->stats.diskBytes += size;
+		this->evictFromDisk();
+	}
+}
+
+bool BlockCache::readSpillFile(const std::string & path, int64_t size, Block * block) {
+	std::ifstream file(path, std::ios::binary);
+	block->resize(size);
+	file.read(reinterpret_cast<char *>(block->data()), size);
+	return file && file.gcount() == size;
+}
+
+void BlockCache::evictFromDisk() {
+	while(this->stats.diskBytes > this->options.diskCapacity && !this->diskBlocks.empty()) {
+		DiskEntry & leastRecentlyUsed = this->diskBlocks.back();
+		std::remove(leastRecentlyUsed.path.c_str());
+		this->stats.diskBytes -= leastRecentlyUsed.size;
+		if(this->memoryIndex.count(leastRecentlyUsed.key) == 0) {
+			this->stats.evictions++;
+		}
+		this->diskIndex.erase(leastRecentlyUsed.key);
+		this->diskBlocks.pop_back();
+	}
+}
+
+void BlockCache::invalidate(const std::string & uri) {
+	const std::string prefix = uri + "@";
+	auto matches = [&prefix](const std::string & key) { return key.compare(0, prefix.size(), prefix) == 0; };
+
+	std::lock_guard<std::mutex> lock(this->mutex);
+	for(auto entry = this->memoryBlocks.begin(); entry != this->memoryBlocks.end();) {
+		if(matches(entry->key)) {
+			this->stats.memoryBytes -= entry->block->size();
+			this->memoryIndex.erase(entry->key);
+			entry = this->memoryBlocks.erase(entry);
+		} else {
+			++entry;
+		}
+	}
+	for(auto entry = this->diskBlocks.begin(); entry != this->diskBlocks.end();) {
+		if(matches(entry->key)) {
+			std::remove(entry->path.c_str());
+			this->stats.diskBytes -= entry->size;
+			this->diskIndex.erase(entry->key);
+			entry = this->diskBlocks.erase(entry);
+		} else {
+			++entry;
+		}
+	}
+}
+
+void BlockCache::clear() {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	for(const DiskEntry & entry : this->diskBlocks) {
+		std::remove(entry.path.c_str());
+	}
+	this->memoryBlocks.clear();
+	this->memoryIndex.clear();
+	this->diskBlocks.clear();
+	this->diskIndex.clear();
+	this->stats.memoryBytes = 0;
+	this->stats.diskBytes = 0;
+}
+
+BlockCacheStats BlockCache::getStats() {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return this->stats;
+}
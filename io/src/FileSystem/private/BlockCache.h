@@ -0,0 +1,127 @@
+/*
+ * BlockCache.h
+ *
+ * Process wide cache of fixed size blocks of remote files. Blocks live in memory and, when a spill directory is
+ * configured, the ones evicted from memory are kept in local files until the disk tier fills up too. Blocks are keyed
+ * by the file key (uri plus the size and modification time of the file, so a rewritten file never hits stale blocks)
+ * and the block index.
+ */
+
+#ifndef SRC_FILESYSTEM_PRIVATE_BLOCKCACHE_H_
+#define SRC_FILESYSTEM_PRIVATE_BLOCKCACHE_H_
+
+#include "arrow/status.h"
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct BlockCacheOptions {
+	// Files are cached in aligned blocks of this size
+	int64_t blockSize = 1 << 20;
+
+	// Bytes of blocks kept in memory, least recently used blocks are evicted first
+	int64_t memoryCapacity = 1LL << 30;
+
+	// Blocks evicted from memory are written to files in this directory, empty disables the disk tier
+	std::string spillDirectory;
+
+	// Bytes of blocks kept in the spill directory
+	int64_t diskCapacity = 16LL << 30;
+};
+
+struct BlockCacheStats {
+	int64_t memoryHits = 0;
+	int64_t diskHits = 0;
+	int64_t misses = 0;
+	int64_t bytesSaved = 0;  // bytes served by the cache instead of the underlying file
+	int64_t evictions = 0;   // blocks dropped from every tier
+	int64_t memoryBytes = 0;
+	int64_t diskBytes = 0;
+};
+
+class BlockCache {
+public:
+	typedef std::vector<uint8_t> Block;
+
+	// Reads the blocks [firstBlock, lastBlock] of a file into data, every block is blockSize long but the last block of
+	// the file
+	typedef std::function<arrow::Status(int64_t firstBlock, int64_t lastBlock, std::vector<uint8_t> * data)>
+		LoadFunction;
+
+	explicit BlockCache(BlockCacheOptions options = BlockCacheOptions());
+	~BlockCache();  // removes the spill files
+
+	// Cache used by FileSystemManager for the files of remote filesystems. There is none (nullptr) unless one is set:
+	// the remote readers already keep the blocks around their reads, the cache only pays off for files read by many
+	// queries and it holds memoryCapacity bytes for the life of the process.
+	static std::shared_ptr<BlockCache> getDefaultInstance();
+
+	static void setDefaultInstance(std::shared_ptr<BlockCache> cache);
+
+	static std::string getFileKey(const std::string & uri, int64_t size, uint64_t modificationTime);
+
+	// Returns the blocks [firstBlock, lastBlock] of the file. Missing blocks are loaded with one call of load per run of
+	// contiguous missing blocks, and blocks another thread is already loading are waited for instead of loaded again.
+	arrow::Status getBlocks(const std::string & fileKey,
+		int64_t firstBlock,
+		int64_t lastBlock,
+		const LoadFunction & load,
+		std::vector<std::shared_ptr<const Block>> * blocks);
+
+	// Drops every block of every version of the file
+	void invalidate(const std::string & uri);
+
+	void clear();
+
+	BlockCacheStats getStats();
+
+	int64_t getBlockSize() const { return this->options.blockSize; }
+
+private:
+	struct LoadResult {
+		arrow::Status status;
+		std::shared_ptr<const Block> block;
+	};
+
+	struct MemoryEntry {
+		std::string key;
+		std::shared_ptr<const Block> block;
+	};
+
+	struct DiskEntry {
+		std::string key;
+		std::string path;
+		int64_t size;
+	};
+
+	static std::string getBlockKey(const std::string & fileKey, int64_t blockIndex);
+
+	// Must be called with the mutex held, evicted blocks that go to disk are appended to spilled
+	void insertInMemory(const std::string & key, std::shared_ptr<const Block> block, std::vector<MemoryEntry> * spilled);
+
+	void spill(std::vector<MemoryEntry> & spilled);
+
+	bool readSpillFile(const std::string & path, int64_t size, Block * block);
+
+	// Must be called with the mutex held
+	void evictFromDisk();
+
+	BlockCacheOptions options;
+
+	std::mutex mutex;
+	std::list<MemoryEntry> memoryBlocks;  // most recently used first
+	std::unordered_map<std::string, std::list<MemoryEntry>::iterator> memoryIndex;
+	std::list<DiskEntry> diskBlocks;  // most recently used first
+	std::unordered_map<std::string, std::list<DiskEntry>::iterator> diskIndex;
+	std::unordered_map<std::string, std::shared_future<LoadResult>> loadingBlocks;
+	uint64_t spillCounter;
+	BlockCacheStats stats;
+};
+
+#endif /* SRC_FILESYSTEM_PRIVATE_BLOCKCACHE_H_ */
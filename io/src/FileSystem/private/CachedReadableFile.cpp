@@ -0,0 +1,133 @@
+#include "CachedReadableFile.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "arrow/buffer.h"
+#include <arrow/memory_pool.h>
+
+CachedReadableFile::CachedReadableFile(std::shared_ptr<arrow::io::RandomAccessFile> file,
+	std::string fileKey,
+	int64_t size,
+	std::shared_ptr<BlockCache> cache)
+	: file(file), fileKey(fileKey), size(size), cache(cache), position(0) {}
+
+CachedReadableFile::~CachedReadableFile() {}
+
+arrow::Status CachedReadableFile::Close() { return this->file->Close(); }
+
+arrow::Status CachedReadableFile::GetSize(int64_t * size) {
+	*size = this->size;
+	return arrow::Status::OK();
+}
+
+arrow::Status CachedReadableFile::Seek(int64_t position) {
+	this->position = position;
+	return arrow::Status::OK();
+}
+
+arrow::Status CachedReadableFile::Tell(int64_t * position) const {
+	*position = this->position;
+	return arrow::Status::OK();
+}
+
+arrow::Status CachedReadableFile::loadBlocks(int64_t firstBlock, int64_t lastBlock, std::vector<uint8_t> * data) {
+	const int64_t blockSize = this->cache->getBlockSize();
+	const int64_t start = firstBlock * blockSize;
+	const int64_t nbytes = std::min((lastBlock + 1) * blockSize, this->size) - start;
+	data->resize(nbytes);
+
+	int64_t bytesRead = 0;
+	arrow::Status status = this->file->ReadAt(start, nbytes, &bytesRead, data->data());
+	if(status.ok() && bytesRead < nbytes) {
+		return arrow::Status::IOError("Read at " + std::to_string(start) + " returned " + std::to_string(bytesRead) +
+									  " of " + std::to_string(nbytes) + " bytes");
+	}
+	return status;
+}
+
+arrow::Status CachedReadableFile::Read(int64_t nbytes, int64_t * bytesRead, void * buffer) {
+	arrow::Status status = this->ReadAt(this->position, nbytes, bytesRead, buffer);
+	if(status.ok()) {
+		this->position += *bytesRead;
+	}
+	return status;
+}
+
+arrow::Status CachedReadableFile::Read(int64_t nbytes, std::shared_ptr<arrow::Buffer> * out) {
+	arrow::Status status = this->ReadAt(this->position, nbytes, out);
+	if(status.ok()) {
+		this->position += (*out)->size();
+	}
+	return status;
+}
+
+arrow::Status CachedReadableFile::ReadAt(int64_t position, int64_t nbytes, int64_t * bytesRead, void * buffer) {
+	*bytesRead = 0;
+	if(position < 0 || nbytes < 0) {
+		return arrow::Status::Invalid("Invalid read of " + std::to_string(nbytes) + " bytes at " +
+									  std::to_string(position));
+	}
+	nbytes = std::min(nbytes, std::max<int64_t>(this->size - position, 0));
+	if(nbytes == 0) {
+		return arrow::Status::OK();
+	}
+
+	const int64_t blockSize = this->cache->getBlockSize();
+	const int64_t end = position + nbytes;
+	const int64_t firstBlock = position / blockSize;
+
+	std::vector<std::shared_ptr<const BlockCache::Block>> blocks;
+	arrow::Status status = this->cache->getBlocks(this->fileKey,
+		firstBlock,
+		(end - 1) / blockSize,
+		[this](int64_t firstBlock, int64_t lastBlock, std::vector<uint8_t> * data) {
+			return this->loadBlocks(firstBlock, lastBlock, data);
+		},
+		&blocks);
+	if(!status.ok()) {
+		return status;
+	}
+
+	uint8_t * out = static_cast<uint8_t *>(buffer);
+	for(size_t i = 0; i < blocks.size(); i++) {
+		const int64_t blockStart = (firstBlock + i) * blockSize;
+		const int64_t copyStart = std::max(position, blockStart);
+		const int64_t copyEnd = std::min<int64_t>(end, blockStart + blocks[i]->size());
+		if(copyEnd < std::min(end, blockStart + blockSize)) {
+			return arrow::Status::IOError("Cached block " + std::to_string(firstBlock + i) + " of " + this->fileKey +
+										  " is shorter than expected");
+		}
+		std::memcpy(out + (copyStart - position), blocks[i]->data() + (copyStart - blockStart), copyEnd - copyStart);
+	}
+
+	*bytesRead = nbytes;
+	return arrow::Status::OK();
+}
+
+arrow::Status CachedReadableFile::ReadAt(int64_t position, int64_t nbytes, std::shared_ptr<arrow::Buffer> * out) {
+	std::shared_ptr<arrow::ResizableBuffer> buffer;
+	arrow::Status status = AllocateResizableBuffer(arrow::default_memory_pool(), nbytes, &buffer);
+	if(!status.ok()) {
+		return status;
+	}
+
+	int64_t bytesRead = 0;
+	status = this->ReadAt(position, nbytes, &bytesRead, buffer->mutable_data());
+	if(!status.ok()) {
+		return status;
+	}
+
+	if(bytesRead < nbytes) {
+		status = buffer->Resize(bytesRead);
+		if(!status.ok()) {
+			return status;
+		}
+	}
+	*out = buffer;
+	return arrow::Status::OK();
+}
+
+bool CachedReadableFile::supports_zero_copy() const { return false; }
+
+bool CachedReadableFile::closed() const { return this->file->closed(); }
@@ -0,0 +1,56 @@
+/*
+ * CachedReadableFile.h
+ *
+ * RandomAccessFile that serves the reads of another file through a BlockCache. The size comes from the file status
+ * taken when the file was opened, so GetSize never goes to the underlying file.
+ */
+
+#ifndef SRC_FILESYSTEM_PRIVATE_CACHEDREADABLEFILE_H_
+#define SRC_FILESYSTEM_PRIVATE_CACHEDREADABLEFILE_H_
+
+#include "FileSystem/private/BlockCache.h"
+#include "arrow/io/interfaces.h"
+#include "arrow/status.h"
+
+class CachedReadableFile : public arrow::io::RandomAccessFile {
+public:
+	// fileKey identifies the version of the file (see BlockCache::getFileKey)
+	CachedReadableFile(std::shared_ptr<arrow::io::RandomAccessFile> file,
+		std::string fileKey,
+		int64_t size,
+		std::shared_ptr<BlockCache> cache);
+	~CachedReadableFile();
+
+	arrow::Status Close() override;
+
+	arrow::Status GetSize(int64_t * size) override;
+
+	arrow::Status Read(int64_t nbytes, int64_t * bytesRead, void * buffer) override;
+
+	arrow::Status Read(int64_t nbytes, std::shared_ptr<arrow::Buffer> * out) override;
+
+	// The ReadAt calls leave the position of Read alone, tasks can read parts of the file through it in parallel
+	arrow::Status ReadAt(int64_t position, int64_t nbytes, int64_t * bytesRead, void * buffer) override;
+
+	arrow::Status ReadAt(int64_t position, int64_t nbytes, std::shared_ptr<arrow::Buffer> * out) override;
+
+	bool supports_zero_copy() const override;
+
+	arrow::Status Seek(int64_t position) override;
+	arrow::Status Tell(int64_t * position) const override;
+
+	bool closed() const override;
+
+private:
+	arrow::Status loadBlocks(int64_t firstBlock, int64_t lastBlock, std::vector<uint8_t> * data);
+
+	std::shared_ptr<arrow::io::RandomAccessFile> file;
+	std::string fileKey;
+	int64_t size;
+	std::shared_ptr<BlockCache> cache;
+	int64_t position;
+
+	ARROW_DISALLOW_COPY_AND_ASSIGN(CachedReadableFile);
+};
+
+#endif /* SRC_FILESYSTEM_PRIVATE_CACHEDREADABLEFILE_H_ */
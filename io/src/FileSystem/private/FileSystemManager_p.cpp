@@ -7,14 +7,32 @@
 
 #include <iostream>
 
+#include "CachedReadableFile.h"
 #include "ExceptionHandling/BlazingException.h"
+#include "FileSystem/MappedReadableFile.h"
 #include "FileSystemFactory.h"
+#include "InvalidatingOutputStream.h"
+#include "MeteredFileSystem.h"
 #include "Library/Logging/Logger.h"
 #include "Util/FileUtil.h"
 
 namespace Logging = Library::Logging;
 
-FileSystemManager::Private::Private() {}
+namespace {
+
+void invalidate(const Uri & uri, BlockCache * blockCache, MetadataCache * metadataCache) {
+	if(blockCache != nullptr) {
+		blockCache->invalidate(uri.toString());
+	}
+	if(metadataCache != nullptr) {
+		metadataCache->invalidate(uri);
+	}
+}
+
+}  // namespace
+
+FileSystemManager::Private::Private()
+	: useDefaultBlockCache(true), metadataCache(MetadataCache::getDefaultInstance()), memoryMappedLocalReads(false) {}
 
 FileSystemManager::Private::~Private() {}
 
@@ -54,7 +72,7 @@ bool FileSystemManager::Private::registerFileSystem(const FileSystemEntity & fil
 			return false;
 		}
 
-		this->fileSystems.push_back(std::move(fileSystem));
+		this->fileSystems.emplace_back(new MeteredFileSystem(std::move(fileSystem)));
 		this->fileSystemIds[authority] = this->fileSystems.size() - 1;
 	} else {  // only reuse fs that aren't null and were connected
 		Logging::Logger().logTrace("filesystem previously created. It was found and will be reused");
@@ -115,7 +133,9 @@ bool FileSystemManager::Private::exists(const Uri & uri) const {
 	try {
 		const int fileSystemId = this->verifyFileSystemUri(uri);
 
-		const auto ret = this->fileSystems.at(fileSystemId)->exists(uri);
+		const auto & fileSystem = this->fileSystems.at(fileSystemId);
+		const auto ret =
+			this->isCached(*fileSystem) ? this->metadataCache->exists(*fileSystem, uri) : fileSystem->exists(uri);
 
 		return ret;
 	} catch(const std::exception & e) {
@@ -135,7 +155,7 @@ FileStatus FileSystemManager::Private::getFileStatus(const Uri & uri) const {
 
 		// TODO check fileSystemId ... manage error cases
 
-		const auto ret = this->fileSystems.at(fileSystemId)->getFileStatus(uri);
+		const auto ret = this->getFileStatus(*this->fileSystems.at(fileSystemId), uri);
 
 		return ret;
 	} catch(const std::exception & e) {
@@ -155,7 +175,9 @@ std::vector<FileStatus> FileSystemManager::Private::list(const Uri & uri, const
 
 		// TODO check fileSystemId ... manage error cases
 
-		const auto ret = this->fileSystems.at(fileSystemId)->list(uri, filter);
+		const auto & fileSystem = this->fileSystems.at(fileSystemId);
+		const auto ret = this->isCached(*fileSystem) ? this->metadataCache->list(*fileSystem, uri, filter)
+													 : fileSystem->list(uri, filter);
 
 		return ret;
 	} catch(const std::exception & e) {
@@ -194,7 +216,9 @@ std::vector<Uri> FileSystemManager::Private::list(const Uri & uri, const std::st
 
 		// TODO check fileSystemId ... manage error cases
 
-		const auto ret = this->fileSystems.at(fileSystemId)->list(uri, wildcard);
+		const auto & fileSystem = this->fileSystems.at(fileSystemId);
+		const auto ret = this->isCached(*fileSystem) ? this->metadataCache->list(*fileSystem, uri, wildcard)
+													 : fileSystem->list(uri, wildcard);
 
 		return ret;
 	} catch(const std::exception & e) {
@@ -253,6 +277,8 @@ bool FileSystemManager::Private::makeDirectory(const Uri & uri) const {
 
 		// TODO check fileSystemId ... manage error cases
 
+		this->invalidateCaches(uri);
+
 		const auto ret = this->fileSystems.at(fileSystemId)->makeDirectory(uri);
 
 		return ret;
@@ -272,6 +298,8 @@ bool FileSystemManager::Private::remove(const Uri & uri) const {
 
 		// TODO check fileSystemId ... manage error cases
 
+		this->invalidateCaches(uri);
+
 		const auto ret = this->fileSystems.at(fileSystemId)->remove(uri);
 
 		return ret;
@@ -298,6 +326,9 @@ bool FileSystemManager::Private::move(const Uri & src, const Uri & dst) const {
 		const int fileSystemIdSrc = this->verifyFileSystemUri(src);
 		const int fileSystemIdDst = this->verifyFileSystemUri(dst);
 
+		this->invalidateCaches(src);
+		this->invalidateCaches(dst);
+
 		if(fileSystemIdSrc != fileSystemIdDst) {
 			// we need to copy and then delete the original
 			// TODO when we implement the copy operation in the FileSystemManager, we can replace the manual copy step
@@ -328,6 +359,8 @@ bool FileSystemManager::Private::truncateFile(const Uri & uri, long long length)
 
 		// TODO check fileSystemId ... manage error cases
 
+		this->invalidateCaches(uri);
+
 		const auto ret = this->fileSystems.at(fileSystemId)->truncateFile(uri, length);
 
 		return ret;
@@ -347,9 +380,34 @@ std::shared_ptr<arrow::io::RandomAccessFile> FileSystemManager::Private::openRea
 
 		// TODO check fileSystemId ... manage error cases
 
-		const auto ret = this->fileSystems.at(fileSystemId)->openReadable(uri);
+		const auto & fileSystem = this->fileSystems.at(fileSystemId);
+
+		if(this->memoryMappedLocalReads && fileSystem->getFileSystemType() == FileSystemType::LOCAL) {
+			const Path path = fileSystem->getRoot() + uri.getPath().toString();
+			// the pages are read as they are touched, only the open is a request
+			MeteredRequest request(FileSystemMetrics::get(FileSystemType::LOCAL));
+			std::shared_ptr<MappedReadableFile> mappedFile;
+			const arrow::Status status =
+				MappedReadableFile::Open(path.toString(), MappedFileAdvice::NORMAL, &mappedFile);
+			if(!status.ok()) {
+				throw BlazingFileSystemException(
+					"Unable to open " + uri.toString() + " for reading: " + status.ToString());
+			}
+			return mappedFile;
+		}
+
+		const auto ret = fileSystem->openReadable(uri);
 
-		return ret;
+		const std::shared_ptr<BlockCache> blockCache = this->getBlockCache();
+		if(blockCache == nullptr || ret == nullptr || fileSystem->getFileSystemType() == FileSystemType::LOCAL) {
+			return ret;
+		}
+
+		// the size and modification time make the blocks of a rewritten file a different entry
+		const FileStatus fileStatus = this->getFileStatus(*fileSystem, uri);
+		const std::string fileKey =
+			BlockCache::getFileKey(uri.toString(), fileStatus.getFileSize(), fileStatus.getModificationTime());
+		return std::make_shared<CachedReadableFile>(ret, fileKey, fileStatus.getFileSize(), blockCache);
 	} catch(const std::exception & e) {
 		std::string uriStr = uri.toString();
 		Logging::Logger().logError("Caught error in openReadable with Uri: " + uriStr);
@@ -367,9 +425,18 @@ std::shared_ptr<arrow::io::OutputStream> FileSystemManager::Private::openWriteab
 
 		// TODO check fileSystemId ... manage error cases
 
+		this->invalidateCaches(uri);
+
 		const auto ret = this->fileSystems.at(fileSystemId)->openWriteable(uri);
+		if(ret == nullptr) {
+			return ret;
+		}
 
-		return ret;
+		// the object of a remote filesystem only appears once the stream is closed, what was read meanwhile is stale
+		const std::shared_ptr<BlockCache> blockCache = this->getBlockCache();
+		const std::shared_ptr<MetadataCache> metadataCache = this->metadataCache;
+		return std::make_shared<InvalidatingOutputStream>(
+			ret, [uri, blockCache, metadataCache]() { invalidate(uri, blockCache.get(), metadataCache.get()); });
 	} catch(const std::exception & e) {
 		std::string uriStr = uri.toString();
 		Logging::Logger().logError("Caught error in openWriteable with Uri: " + uriStr);
@@ -377,8 +444,36 @@ std::shared_ptr<arrow::io::OutputStream> FileSystemManager::Private::openWriteab
 	}
 }
 
+void FileSystemManager::Private::setBlockCache(std::shared_ptr<BlockCache> blockCache) {
+	this->blockCache = blockCache;
+	this->useDefaultBlockCache = false;
+}
+
+std::shared_ptr<BlockCache> FileSystemManager::Private::getBlockCache() const {
+	return this->useDefaultBlockCache ? BlockCache::getDefaultInstance() : this->blockCache;
+}
+
+void FileSystemManager::Private::setMetadataCache(std::shared_ptr<MetadataCache> metadataCache) {
+	this->metadataCache = metadataCache;
+}
+
+void FileSystemManager::Private::setMemoryMappedLocalReads(bool enabled) { this->memoryMappedLocalReads = enabled; }
+
+void FileSystemManager::Private::invalidateCaches(const Uri & uri) const {
+	invalidate(uri, this->getBlockCache().get(), this->metadataCache.get());
+}
+
 // Private stuff
 
+bool FileSystemManager::Private::isCached(const FileSystemInterface & fileSystem) const {
+	return this->metadataCache != nullptr && fileSystem.getFileSystemType() != FileSystemType::LOCAL;
+}
+
+FileStatus FileSystemManager::Private::getFileStatus(const FileSystemInterface & fileSystem, const Uri & uri) const {
+	return this->isCached(fileSystem) ? this->metadataCache->getFileStatus(fileSystem, uri)
+									  : fileSystem.getFileStatus(uri);
+}
+
 int FileSystemManager::Private::verifyFileSystemUri(const Uri & uri) const {
 	try {
 		const int fileSystemId = this->fileSystemIds.at(uri.getAuthority());
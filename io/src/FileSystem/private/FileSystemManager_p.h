@@ -12,6 +12,8 @@
 
 #include "FileSystem/FileSystemInterface.h"
 #include "FileSystem/FileSystemManager.h"
+#include "FileSystem/private/BlockCache.h"
+#include "FileSystem/private/MetadataCache.h"
 
 // Composite pattern but we don't need to use FileSystemInterface as base class
 class FileSystemManager::Private {
@@ -44,13 +46,29 @@ public:
 	std::shared_ptr<arrow::io::RandomAccessFile> openReadable(const Uri & uri) const;
 	std::shared_ptr<arrow::io::OutputStream> openWriteable(const Uri & uri) const;
 
+	void setBlockCache(std::shared_ptr<BlockCache> blockCache);
+	void setMetadataCache(std::shared_ptr<MetadataCache> metadataCache);
+	void setMemoryMappedLocalReads(bool enabled);
+	void invalidateCaches(const Uri & uri) const;
+
 private:
 	int verifyFileSystemUri(const Uri & uri) const;  // returns FileSystem id if ok, -1 otherwise
 
+	// metadata of local filesystems is not cached, it is cheap to get and changes behind our back often
+	bool isCached(const FileSystemInterface & fileSystem) const;
+
+	// the one set with setBlockCache, otherwise BlockCache::getDefaultInstance() at the time of the call
+	std::shared_ptr<BlockCache> getBlockCache() const;
+	FileStatus getFileStatus(const FileSystemInterface & fileSystem, const Uri & uri) const;
+
 private:
 	std::map<std::string, Path> roots;								// <authority, root>
 	std::map<std::string, int> fileSystemIds;						// <authority, fs id>
 	std::vector<std::unique_ptr<FileSystemInterface>> fileSystems;  // [fs id] = fs
+	std::shared_ptr<BlockCache> blockCache;
+	bool useDefaultBlockCache;
+	std::shared_ptr<MetadataCache> metadataCache;
+	bool memoryMappedLocalReads;
 };
 
 #endif /* _FILESYSTEM_MANAGER_PRIVATE_H_ */
@@ -10,54 +10,59 @@
 #include <arrow/memory_pool.h>
 
 #include <FileSystem/private/GoogleCloudStorageReadableFile.h>
+#include <FileSystem/private/MultipartOutputStream.h>
 
 #include "arrow/buffer.h"
-#include <istream>
-#include <streambuf>
+#include <mutex>
+#include <set>
 
 #include "ExceptionHandling/BlazingException.h"
+#include "Util/StringUtil.h"
 
 #include "Library/Logging/Logger.h"
 
 namespace Logging = Library::Logging;
 
-// TODO: handle the situation when not all data is read
-// const Aws::String FAILED_UPLOAD = "failed-upload";
+namespace {
+// GCS composes at most 32 objects in one request
+const size_t MAX_COMPOSE_SOURCES = 32;
+}  // namespace
+
+// GCS has no multipart upload like S3: every part is uploaded as an object of its own, then the parts are composed into
+// the destination and deleted. The parts go under a prefix of their own next to the destination, whose name starts with
+// '_' so listings of the directory skip it.
 class GoogleCloudStorageOutputStream::GoogleCloudStorageOutputStreamImpl {
 public:
-	//~GoogleCloudStorageOutputStreamImpl();
 	GoogleCloudStorageOutputStreamImpl(
 		const std::string & bucketName, const std::string & objectKey, std::shared_ptr<gcs::Client> gcsClient);
 
 	arrow::Status close();
 	arrow::Status write(const void * buffer, int64_t nbytes);
-	arrow::Status write(const void * buffer, int64_t nbytes, int64_t * bytes_written);
 	arrow::Status flush();
 	arrow::Status tell(int64_t * position) const;
+	bool closed() const;
 
 private:
+	arrow::Status uploadPart(
+		int partNumber, const uint8_t * data, int64_t nbytes, const std::string & md5, std::string * partId);
+	arrow::Status complete(const std::vector<std::string> & partIds);
+	void abort();
+
+	// the parts uploaded so far, to delete them once composed or aborted
+	void deleteParts();
+
+	// errors the service could get past on a later attempt are IOErrors, the stream retries those
+	arrow::Status toStatus(const google::cloud::Status & status, const std::string & problem) const;
+
 	std::shared_ptr<gcs::Client> gcsClient;
 	std::string bucket;
 	std::string key;
+	std::string uploadPrefix;  // where the parts of this upload go
 
-	//		Aws::String uploadId;
-
-	//		std::vector<Aws::GoogleCloudStorage::Model::CompletedPart> completedParts; //just an etag (for response) and a
-	//part number
-	size_t currentPart;
-	int64_t written;
-};
-
-struct membuf : std::streambuf {
-	membuf(char const * base, size_t size) {
-		char * p(const_cast<char *>(base));
-		this->setg(p, p, p + size);
-	}
-};
+	std::mutex partsMutex;
+	std::set<std::string> partNames;
 
-struct imemstream : virtual membuf, std::iostream {
-	imemstream(char const * base, size_t size)
-		: membuf(base, size), std::iostream(static_cast<std::streambuf *>(this)) {}
+	std::unique_ptr<MultipartOutputStream> stream;
 };
 
 GoogleCloudStorageOutputStream::GoogleCloudStorageOutputStreamImpl::GoogleCloudStorageOutputStreamImpl(
@@ -66,110 +71,128 @@ GoogleCloudStorageOutputStream::GoogleCloudStorageOutputStreamImpl::GoogleCloudS
 	this->key = objectKey;
 	this->gcsClient = gcsClient;
 
-	currentPart = 1;
-	written = 0;
-
-	//    Aws::GoogleCloudStorage::Model::CreateMultipartUploadRequest request;
-	//	request.SetBucket(bucket);
-	//	request.SetKey(key);
-	//    Aws::GoogleCloudStorage::Model::CreateMultipartUploadOutcome createMultipartUploadOutcome =
-	//    GoogleCloudStorageClient->CreateMultipartUpload(request);
-	//	if (createMultipartUploadOutcome.IsSuccess()) {
-	//		this->uploadId = createMultipartUploadOutcome.GetResult().GetUploadId();
-	//	} else {
-	//        Logging::Logger().logError("Failed to create Aws::GoogleCloudStorage::Model::CreateMultipartUploadOutcome
-	//        for bucket: " + bucketName + " and key: " + objectKey);
-	//		bool shouldRetry = createMultipartUploadOutcome.GetError().ShouldRetry();
-	//		if (shouldRetry){
-	//			Logging::Logger().logError(createMultipartUploadOutcome.GetError().GetExceptionName() + " : " +
-	//createMultipartUploadOutcome.GetError().GetMessage() + "  SHOULD RETRY"); 		} else {
-	//			Logging::Logger().logError(createMultipartUploadOutcome.GetError().GetExceptionName() + " : " +
-	//createMultipartUploadOutcome.GetError().GetMessage() + "  SHOULD NOT RETRY");
-	//		}
-	//        throw BlazingGoogleCloudStorageException("Failed to create
-	//        Aws::GoogleCloudStorage::Model::CreateMultipartUploadOutcome. Problem was " +
-	//        createMultipartUploadOutcome.GetError().GetExceptionName() + " : " +
-	//        createMultipartUploadOutcome.GetError().GetMessage());
-	//		this->uploadId = FAILED_UPLOAD;
-	//	}
-
-	// start upload here
+	const size_t nameStart = objectKey.rfind('/') + 1;
+	this->uploadPrefix = objectKey.substr(0, nameStart) + "_blazing_upload_" + randomString(16) + "/" +
+						 objectKey.substr(nameStart);
+
+	MultipartUploadFunctions functions;
+	functions.uploadPart =
+		[this](int partNumber, const uint8_t * data, int64_t nbytes, const std::string & md5, std::string * partId) {
+			return this->uploadPart(partNumber, data, nbytes, md5, partId);
+		};
+	functions.complete = [this](const std::vector<std::string> & partIds) { return this->complete(partIds); };
+	functions.abort = [this]() { this->abort(); };
+	this->stream.reset(new MultipartOutputStream(functions));
+}
+
+arrow::Status GoogleCloudStorageOutputStream::GoogleCloudStorageOutputStreamImpl::uploadPart(
+	int partNumber, const uint8_t * data, int64_t nbytes, const std::string & md5, std::string * partId) {
+	const std::string partName = this->uploadPrefix + ".part-" + std::to_string(partNumber);
+	{
+		std::lock_guard<std::mutex> lock(this->partsMutex);
+		this->partNames.insert(partName);
+	}
+
+	// GCS rejects the object when the bytes it got do not match the MD5
+	google::cloud::StatusOr<gcs::ObjectMetadata> objectMetadata = this->gcsClient->InsertObject(
+		this->bucket, partName, std::string((const char *) data, nbytes), gcs::MD5HashValue(md5));
+	if(!objectMetadata) {
+		return this->toStatus(objectMetadata.status(),
+			"Had a trouble uploading part " + std::to_string(partNumber) + " on file " + this->bucket + "/" + key);
+	}
+
+	*partId = partName;
+	return arrow::Status::OK();
+}
+
+arrow::Status GoogleCloudStorageOutputStream::GoogleCloudStorageOutputStreamImpl::complete(
+	const std::vector<std::string> & partIds) {
+	// A single compose creates the destination whole or not at all. More parts are composed 32 at a time into an
+	// object under the upload prefix, which is then copied over the destination, so a failure never leaves the
+	// destination truncated.
+	const bool singleCompose = partIds.size() <= MAX_COMPOSE_SOURCES;
+	const std::string composedName = singleCompose ? this->key : this->uploadPrefix;
+	if(!singleCompose) {
+		std::lock_guard<std::mutex> lock(this->partsMutex);
+		this->partNames.insert(composedName);
+	}
+
+	// every request after the first appends the object composed so far to the next 31 parts
+	for(size_t first = 0; first < partIds.size();) {
+		std::vector<gcs::ComposeSourceObject> sources;
+		if(first > 0) {
+			sources.push_back(gcs::ComposeSourceObject{composedName, {}, {}});
+		}
+		for(; first < partIds.size() && sources.size() < MAX_COMPOSE_SOURCES; first++) {
+			sources.push_back(gcs::ComposeSourceObject{partIds[first], {}, {}});
+		}
+
+		google::cloud::StatusOr<gcs::ObjectMetadata> objectMetadata =
+			this->gcsClient->ComposeObject(this->bucket, sources, composedName);
+		if(!objectMetadata) {
+			Logging::Logger().logError("In closing outputstream. Problem was " + objectMetadata.status().message());
+			return this->toStatus(objectMetadata.status(), "Error closing outputstream " + this->bucket + "/" + key);
+		}
+	}
+
+	if(!singleCompose) {
+		google::cloud::StatusOr<gcs::ObjectMetadata> objectMetadata =
+			this->gcsClient->RewriteObjectBlocking(this->bucket, composedName, this->bucket, this->key);
+		if(!objectMetadata) {
+			Logging::Logger().logError("In closing outputstream. Problem was " + objectMetadata.status().message());
+			return this->toStatus(objectMetadata.status(), "Error closing outputstream " + this->bucket + "/" + key);
+		}
+	}
+
+	this->deleteParts();
+	return arrow::Status::OK();
+}
+
+void GoogleCloudStorageOutputStream::GoogleCloudStorageOutputStreamImpl::abort() { this->deleteParts(); }
+
+void GoogleCloudStorageOutputStream::GoogleCloudStorageOutputStreamImpl::deleteParts() {
+	std::lock_guard<std::mutex> lock(this->partsMutex);
+	for(const std::string & partName : this->partNames) {
+		google::cloud::Status status = this->gcsClient->DeleteObject(this->bucket, partName);
+		if(!status.ok() && status.code() != google::cloud::StatusCode::kNotFound) {
+			Logging::Logger().logWarn("Could not delete the part " + this->bucket + "/" + partName + ". Problem was " +
+									  status.message());
+		}
+	}
+	this->partNames.clear();
+}
+
+arrow::Status GoogleCloudStorageOutputStream::GoogleCloudStorageOutputStreamImpl::toStatus(
+	const google::cloud::Status & status, const std::string & problem) const {
+	const std::string message = problem + ". Problem was " + status.message();
+	switch(status.code()) {
+	case google::cloud::StatusCode::kPermissionDenied:
+	case google::cloud::StatusCode::kUnauthenticated:
+	case google::cloud::StatusCode::kNotFound:
+	case google::cloud::StatusCode::kFailedPrecondition: return arrow::Status::Invalid(message);
+	default: return arrow::Status::IOError(message);
+	}
 }
 
 arrow::Status GoogleCloudStorageOutputStream::GoogleCloudStorageOutputStreamImpl::write(
 	const void * buffer, int64_t nbytes) {
-	//    Aws::GoogleCloudStorage::Model::UploadPartRequest uploadPartRequest;
-	//	uploadPartRequest.SetBucket(bucket);
-	//	uploadPartRequest.SetKey(key);
-	//	uploadPartRequest.SetPartNumber(currentPart);
-	//	uploadPartRequest.SetUploadId(uploadId);
-	//	//char * tempBuffer = (char *) buffer;
-
-	//	//std::shared_ptr<imemstream> membuffer =  std::make_shared<imemstream>(new );
-	//	//   imemstream membuffer((char *) buffer,nbytes);
-
-	////    std::shared_ptr<imemstream> memBufferPtr
-	//	uploadPartRequest.SetBody(std::make_shared < imemstream > ((char *) buffer, nbytes));
-
-	//	// uploadPart1Request.SetContentMD5(HashingUtils::Base64Encode(md5OfStream));
-
-	//	uploadPartRequest.SetContentLength(nbytes);
-
-	//	written += nbytes;
-	//    Aws::GoogleCloudStorage::Model::UploadPartOutcome uploadOutcome =
-	//    GoogleCloudStorageClient->UploadPart(uploadPartRequest);
-	//	if (uploadOutcome.IsSuccess()) {
-	//        Aws::GoogleCloudStorage::Model::CompletedPart completedPart;
-	//		completedPart.SetETag(uploadOutcome.GetResult().GetETag());
-	//		completedPart.SetPartNumber(currentPart);
-	//		this->completedParts.push_back(completedPart);
-	//		currentPart++;
-	//		return arrow::Status::OK();
-	//	} else {
-	//		Logging::Logger().logError("In Write: Uploading part " + std::to_string(currentPart) + " on file " +
-	//this->bucket + "/" + key + ". Problem was " + uploadOutcome.GetError().GetExceptionName() + " : " +
-	//uploadOutcome.GetError().GetMessage()); 		return arrow::Status::IOError("Had a trouble uploading part " +
-	//std::to_string(currentPart) + " on file " + this->bucket + "/" + key + ". Problem was " +
-	//uploadOutcome.GetError().GetExceptionName() + " : " + uploadOutcome.GetError().GetMessage());
-	//	}
+	return this->stream->Write(buffer, nbytes);
 }
 
 arrow::Status GoogleCloudStorageOutputStream::GoogleCloudStorageOutputStreamImpl::flush() {
-	// flush is a pass through in all reality
-	// we are making each write send the contents for now for simplicity of design
-	return arrow::Status::OK();
+	return this->stream->Flush();
 }
 
 arrow::Status GoogleCloudStorageOutputStream::GoogleCloudStorageOutputStreamImpl::close() {
-	//	//flush the buffer
-	//	flush();
-	//    Aws::GoogleCloudStorage::Model::CompleteMultipartUploadRequest completeMultipartUploadRequest;
-
-	//	completeMultipartUploadRequest.SetBucket(bucket);
-	//	completeMultipartUploadRequest.SetKey(key);
-	//	completeMultipartUploadRequest.SetUploadId(uploadId);
-
-	//    Aws::GoogleCloudStorage::Model::CompletedMultipartUpload completedMultipartUpload;
-	//	completedMultipartUpload.SetParts(completedParts);
-	//	completeMultipartUploadRequest.WithMultipartUpload(completedMultipartUpload);
-
-	//    Aws::GoogleCloudStorage::Model::CompleteMultipartUploadOutcome completeMultipartUploadOutcome =
-	//    GoogleCloudStorageClient->CompleteMultipartUpload(completeMultipartUploadRequest);
-	//	if (completeMultipartUploadOutcome.IsSuccess()) {
-	//		return arrow::Status::OK();
-	//	} else {
-	//		Logging::Logger().logError("In closing outputstream. Problem was " +
-	//completeMultipartUploadOutcome.GetError().GetExceptionName() + " : " +
-	//completeMultipartUploadOutcome.GetError().GetMessage()); 		return arrow::Status::IOError("Error closing
-	//outputstream. Problem was " + completeMultipartUploadOutcome.GetError().GetExceptionName() + " : " +
-	//completeMultipartUploadOutcome.GetError().GetMessage());
-
-	//	}
-	////	GoogleCloudStorageClient->CompleteMultipartUpload(uploadCompleteRequest);
+	return this->stream->Close();
 }
 
 arrow::Status GoogleCloudStorageOutputStream::GoogleCloudStorageOutputStreamImpl::tell(int64_t * position) const {
-	*position = written;
+	return this->stream->Tell(position);
+}
+
+bool GoogleCloudStorageOutputStream::GoogleCloudStorageOutputStreamImpl::closed() const {
+	return this->stream->closed();
 }
 
 // BEGIN GoogleCloudStorageOutputStream
@@ -190,11 +213,6 @@ arrow::Status GoogleCloudStorageOutputStream::Flush() { return this->impl_->flus
 
 arrow::Status GoogleCloudStorageOutputStream::Tell(int64_t * position) const { return this->impl_->tell(position); }
 
-bool GoogleCloudStorageOutputStream::closed() const {
-	// Since every file interaction is a request, then the file is never really open. This function is necesary due to
-	// the Apache Arrow interface starting with v12. Depending on who or what uses this function, we may want this to
-	// always return false??
-	return true;
-}
+bool GoogleCloudStorageOutputStream::closed() const { return this->impl_->closed(); }
 
 // END GoogleCloudStorageOutputStream
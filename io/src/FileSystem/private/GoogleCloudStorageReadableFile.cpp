@@ -207,7 +207,6 @@ arrow::Status GoogleCloudStorageReadableFile::ReadAt(
 		// so we avoid read first all the stuff only to get its size (results.gcount() doesnt work)
 		*bytesRead = nbytes;
 		//*bytesRead = nbytes < *bytesRead ? nbytes : *bytesRead;
-		this->position = position + *bytesRead;
 		results.read((char *) buffer, *bytesRead);
 
 		// NOTE percy check for badbit also the user should never read more bytes than the result content size
@@ -261,7 +260,6 @@ arrow::Status GoogleCloudStorageReadableFile::ReadAt(
 		// so we avoid read first all the stuff only to get its size (results.gcount() doesnt work)
 		int64_t bytesRead = nbytes;  // results.gcount();
 		// bytesRead = nbytes < bytesRead ? nbytes : bytesRead;
-		this->position = position + nbytes;
 		// if (bytesRead < nbytes){
 		//    Logging::Logger().logError("Did not read all the bytes at GoogleCloudStorageReadableFile::ReadAt(int64_t
 		//    position, int64_t nbytes, std::shared_ptr<arrow::Buffer>* out)");
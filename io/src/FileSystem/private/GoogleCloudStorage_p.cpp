@@ -133,6 +133,8 @@ FileStatus GoogleCloudStorage::Private::getFileStatus(const Uri & uri) const {
 	if(objectMetadata) {  // if success
 		std::string contentType = objectMetadata->content_type();
 		const long long contentLength = objectMetadata->size();
+		const unsigned long long modificationTime =
+			std::chrono::duration_cast<std::chrono::milliseconds>(objectMetadata->updated().time_since_epoch()).count();
 		FileType fileType = FileType::UNDEFINED;
 
 		if((contentLength == SIZE_OF_OBJECT_DIRECTORY) || (contentLength == 0)) {  // may be a directory
@@ -156,10 +158,10 @@ FileStatus GoogleCloudStorage::Private::getFileStatus(const Uri & uri) const {
 				fileType = FileType::DIRECTORY;
 			}
 
-			const FileStatus fileStatus(uri, fileType, contentLength);
+			const FileStatus fileStatus(uri, fileType, contentLength, modificationTime);
 			return fileStatus;
 		} else {  // is probably a file (e.g. application/octet-stream or text/x-python and so on ...
-			const FileStatus fileStatus(uri, FileType::FILE, contentLength);
+			const FileStatus fileStatus(uri, FileType::FILE, contentLength, modificationTime);
 			return fileStatus;
 		}
 	} else {
@@ -778,16 +780,15 @@ bool GoogleCloudStorage::Private::openReadable(
 
 bool GoogleCloudStorage::Private::openWriteable(
 	const Uri & uri, std::shared_ptr<GoogleCloudStorageOutputStream> * file) const {
-	//	if (uri.isValid() == false) {
-	//		throw BlazingInvalidPathException(uri);
-	//	}
+	if(uri.isValid() == false) {
+		throw BlazingInvalidPathException(uri);
+	}
 
-	//	const Uri uriWithRoot(uri.getScheme(), uri.getAuthority(), this->root + uri.getPath().toString());
-	//	const Path path = uriWithRoot.getPath();
-	//	const std::string objectKey = path.toString(true).substr(1, path.toString(true).size());
-	//	const std::string bucketName = this->getBucketName();
-	//	//TODO: S3Outputstream currentl has no validity check add it and throw errors here
-	//	*file = std::make_shared < S3OutputStream > (bucketName, objectKey, this->s3Client);
+	const Uri uriWithRoot(uri.getScheme(), uri.getAuthority(), this->root + uri.getPath().toString());
+	const Path path = uriWithRoot.getPath();
+	const std::string objectKey = path.toString(true).substr(1, path.toString(true).size());
+	const std::string bucketName = this->getBucketName();
+	*file = std::make_shared<GoogleCloudStorageOutputStream>(bucketName, objectKey, this->gcsClient);
 
 	return true;
 }
@@ -0,0 +1,31 @@
+#include "InvalidatingOutputStream.h"
+
+InvalidatingOutputStream::InvalidatingOutputStream(
+	std::shared_ptr<arrow::io::OutputStream> stream, std::function<void()> invalidate)
+	: stream(stream), invalidate(invalidate) {}
+
+InvalidatingOutputStream::~InvalidatingOutputStream() {
+	if(!this->closed()) {
+		this->Close();
+	}
+}
+
+arrow::Status InvalidatingOutputStream::Close() {
+	const arrow::Status status = this->stream->Close();
+	// even a failed upload may have replaced the object
+	if(this->invalidate) {
+		this->invalidate();
+		this->invalidate = nullptr;
+	}
+	return status;
+}
+
+arrow::Status InvalidatingOutputStream::Write(const void * buffer, int64_t nbytes) {
+	return this->stream->Write(buffer, nbytes);
+}
+
+arrow::Status InvalidatingOutputStream::Flush() { return this->stream->Flush(); }
+
+arrow::Status InvalidatingOutputStream::Tell(int64_t * position) const { return this->stream->Tell(position); }
+
+bool InvalidatingOutputStream::closed() const { return this->stream->closed(); }
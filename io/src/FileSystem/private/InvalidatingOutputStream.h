@@ -0,0 +1,37 @@
+/*
+ * InvalidatingOutputStream.h
+ *
+ * OutputStream that runs a callback once another stream is closed. The objects of S3 and GCS only appear when their
+ * upload completes on Close, the caches of their statuses and listings are invalidated again then.
+ */
+
+#ifndef SRC_FILESYSTEM_PRIVATE_INVALIDATINGOUTPUTSTREAM_H_
+#define SRC_FILESYSTEM_PRIVATE_INVALIDATINGOUTPUTSTREAM_H_
+
+#include <functional>
+#include <memory>
+
+#include "arrow/io/interfaces.h"
+#include "arrow/status.h"
+
+class InvalidatingOutputStream : public arrow::io::OutputStream {
+public:
+	InvalidatingOutputStream(std::shared_ptr<arrow::io::OutputStream> stream, std::function<void()> invalidate);
+	// a stream dropped without Close is closed here, as the streams of the filesystems do on their own
+	~InvalidatingOutputStream();
+
+	arrow::Status Close() override;
+	arrow::Status Write(const void * buffer, int64_t nbytes) override;
+	arrow::Status Flush() override;
+	arrow::Status Tell(int64_t * position) const override;
+
+	bool closed() const override;
+
+private:
+	std::shared_ptr<arrow::io::OutputStream> stream;
+	std::function<void()> invalidate;
+
+	ARROW_DISALLOW_COPY_AND_ASSIGN(InvalidatingOutputStream);
+};
+
+#endif /* SRC_FILESYSTEM_PRIVATE_INVALIDATINGOUTPUTSTREAM_H_ */
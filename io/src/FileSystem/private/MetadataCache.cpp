@@ -0,0 +1,169 @@
+#include "MetadataCache.h"
+
+#include <algorithm>
+#include <exception>
+#include <iterator>
+
+namespace {
+
+// Whether the entry of key has to go when uri changes: the entry is uri itself, is under uri, or is the listing of a
+// directory uri is in
+bool isAffected(const std::string & key, const std::string & uri) {
+	const std::string & shorter = key.size() < uri.size() ? key : uri;
+	const std::string & longer = key.size() < uri.size() ? uri : key;
+	size_t length = shorter.size();
+	while(length > 0 && shorter[length - 1] == '/') {
+		length--;
+	}
+	return longer.compare(0, length, shorter, 0, length) == 0;
+}
+
+}  // namespace
+
+MetadataCache::MetadataCache(MetadataCacheOptions options) : options(options), fetchCounter(0) {}
+
+std::shared_ptr<MetadataCache> MetadataCache::getDefaultInstance() {
+	static std::shared_ptr<MetadataCache> cache = std::make_shared<MetadataCache>();
+	return cache;
+}
+
+template <typename T>
+std::shared_ptr<const T> MetadataCache::get(
+	EntryMap<T> & entries, const std::string & key, const std::function<T()> & fetch) {
+	std::shared_ptr<std::promise<std::shared_ptr<const T>>> promise;
+	std::shared_future<std::shared_ptr<const T>> value;
+	uint64_t fetchId = 0;
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		const auto now = std::chrono::steady_clock::now();
+
+		auto entry = entries.find(key);
+		if(entry != entries.end() && entry->second.expiration > now) {
+			value = entry->second.value;
+			if(value.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+				this->stats.hits++;
+			} else {
+				this->stats.coalesced++;
+			}
+		} else {
+			this->stats.misses++;
+			promise = std::make_shared<std::promise<std::shared_ptr<const T>>>();
+			value = promise->get_future().share();
+			fetchId = ++this->fetchCounter;
+			entries[key] = Entry<T>{value, now + this->options.timeToLive, fetchId};
+			this->evict(entries, now);
+		}
+	}
+
+	if(promise) {
+		try {
+			promise->set_value(std::make_shared<const T>(fetch()));
+		} catch(...) {
+			{
+				std::lock_guard<std::mutex> lock(this->mutex);
+				auto entry = entries.find(key);
+				if(entry != entries.end() && entry->second.fetchId == fetchId) {
+					entries.erase(entry);
+				}
+			}
+			promise->set_exception(std::current_exception());
+		}
+	}
+
+	return value.get();
+}
+
+template <typename T>
+void MetadataCache::evict(EntryMap<T> & entries, std::chrono::steady_clock::time_point now) {
+	for(auto entry = entries.begin(); entry != entries.end() && entries.size() > this->options.maxEntries;) {
+		if(entry->second.expiration <= now) {
+			entry = entries.erase(entry);
+		} else {
+			++entry;
+		}
+	}
+
+	while(entries.size() > this->options.maxEntries) {
+		auto firstToExpire = std::min_element(entries.begin(),
+			entries.end(),
+			[](const typename EntryMap<T>::value_type & a, const typename EntryMap<T>::value_type & b) {
+				return a.second.expiration < b.second.expiration;
+			});
+		entries.erase(firstToExpire);
+	}
+}
+
+template <typename T>
+void MetadataCache::invalidate(EntryMap<T> & entries, const std::string & uri) {
+	for(auto entry = entries.begin(); entry != entries.end();) {
+		if(isAffected(entry->first, uri)) {
+			entry = entries.erase(entry);
+		} else {
+			++entry;
+		}
+	}
+}
+
+bool MetadataCache::exists(const FileSystemInterface & fileSystem, const Uri & uri) {
+	return *this->get<bool>(
+		this->existence, uri.toString(true), [&fileSystem, &uri]() { return fileSystem.exists(uri); });
+}
+
+FileStatus MetadataCache::getFileStatus(const FileSystemInterface & fileSystem, const Uri & uri) {
+	return *this->get<FileStatus>(
+		this->statuses, uri.toString(true), [&fileSystem, &uri]() { return fileSystem.getFileStatus(uri); });
+}
+
+std::vector<FileStatus> MetadataCache::list(
+	const FileSystemInterface & fileSystem, const Uri & uri, const FileFilter & filter) {
+	auto listing = this->get<std::vector<FileStatus>>(this->statusListings, uri.toString(true), [&fileSystem, &uri]() {
+		return fileSystem.list(uri, [](const FileStatus & fileStatus) { return true; });
+	});
+
+	std::vector<FileStatus> response;
+	std::copy_if(listing->begin(), listing->end(), std::back_inserter(response), filter);
+	return response;
+}
+
+std::vector<Uri> MetadataCache::list(
+	const FileSystemInterface & fileSystem, const Uri & uri, const std::string & wildcard) {
+	auto listing = this->get<std::vector<Uri>>(
+		this->uriListings, uri.toString(true), [&fileSystem, &uri]() { return fileSystem.list(uri, "*"); });
+
+	if(wildcard == "*") {
+		return *listing;
+	}
+
+	// same pattern the filesystems build: the wildcard is relative to the listed directory
+	const std::string finalWildcard = (uri.getPath() + wildcard).toString(true);
+	std::vector<Uri> response;
+	for(const Uri & entry : *listing) {
+		if(WildcardFilter::match(entry.getPath().toString(true), finalWildcard)) {
+			response.push_back(entry);
+		}
+	}
+	return response;
+}
+
+void MetadataCache::invalidate(const Uri & uri) {
+	const std::string key = uri.toString(true);
+
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->invalidate(this->existence, key);
+	this->invalidate(this->statuses, key);
+	this->invalidate(this->statusListings, key);
+	this->invalidate(this->uriListings, key);
+}
+
+void MetadataCache::clear() {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->existence.clear();
+	this->statuses.clear();
+	this->statusListings.clear();
+	this->uriListings.clear();
+}
+
+MetadataCacheStats MetadataCache::getStats() {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return this->stats;
+}
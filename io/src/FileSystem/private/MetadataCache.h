@@ -0,0 +1,93 @@
+/*
+ * MetadataCache.h
+ *
+ * Cache of the file statuses and directory listings of remote filesystems. Entries expire after a time to live and are
+ * invalidated by the writes done through FileSystemManager. Concurrent requests for the same entry wait for a single
+ * call to the filesystem, and wildcard lists are matched against the cached listing of the whole directory.
+ */
+
+#ifndef SRC_FILESYSTEM_PRIVATE_METADATACACHE_H_
+#define SRC_FILESYSTEM_PRIVATE_METADATACACHE_H_
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "FileSystem/FileSystemInterface.h"
+
+struct MetadataCacheOptions {
+	// How long a status or a listing is served before going to the filesystem again
+	std::chrono::milliseconds timeToLive = std::chrono::seconds(30);
+
+	// Bound of the entries of each kind, the ones that expire first are dropped first
+	size_t maxEntries = 10000;
+};
+
+struct MetadataCacheStats {
+	int64_t hits = 0;
+	int64_t misses = 0;
+	int64_t coalesced = 0;  // requests that waited for the call another request made
+};
+
+class MetadataCache {
+public:
+	explicit MetadataCache(MetadataCacheOptions options = MetadataCacheOptions());
+
+	// Cache used by FileSystemManager for remote filesystems
+	static std::shared_ptr<MetadataCache> getDefaultInstance();
+
+	bool exists(const FileSystemInterface & fileSystem, const Uri & uri);
+
+	FileStatus getFileStatus(const FileSystemInterface & fileSystem, const Uri & uri);
+
+	std::vector<FileStatus> list(const FileSystemInterface & fileSystem, const Uri & uri, const FileFilter & filter);
+
+	std::vector<Uri> list(const FileSystemInterface & fileSystem, const Uri & uri, const std::string & wildcard);
+
+	// Drops the entries of uri, of everything under it and the listings of its parent directories
+	void invalidate(const Uri & uri);
+
+	void clear();
+
+	MetadataCacheStats getStats();
+
+private:
+	template <typename T>
+	struct Entry {
+		std::shared_future<std::shared_ptr<const T>> value;
+		std::chrono::steady_clock::time_point expiration;
+		uint64_t fetchId;
+	};
+
+	template <typename T>
+	using EntryMap = std::unordered_map<std::string, Entry<T>>;
+
+	// Returns the entry of key, calling fetch when it is missing or expired. Errors thrown by fetch reach every
+	// request waiting for it and are not cached.
+	template <typename T>
+	std::shared_ptr<const T> get(EntryMap<T> & entries, const std::string & key, const std::function<T()> & fetch);
+
+	template <typename T>
+	void invalidate(EntryMap<T> & entries, const std::string & uri);
+
+	template <typename T>
+	void evict(EntryMap<T> & entries, std::chrono::steady_clock::time_point now);
+
+	MetadataCacheOptions options;
+
+	std::mutex mutex;
+	EntryMap<bool> existence;
+	EntryMap<FileStatus> statuses;
+	EntryMap<std::vector<FileStatus>> statusListings;
+	EntryMap<std::vector<Uri>> uriListings;
+	uint64_t fetchCounter;
+	MetadataCacheStats stats;
+};
+
+#endif /* SRC_FILESYSTEM_PRIVATE_METADATACACHE_H_ */
@@ -0,0 +1,142 @@
+#include "MeteredFileSystem.h"
+
+#include <array>
+
+#include "MeteredOutputStream.h"
+#include "MeteredReadableFile.h"
+#include "Library/Metrics/MetricsRegistry.h"
+
+namespace Metrics = Library::Metrics;
+
+FileSystemMetrics & FileSystemMetrics::get(FileSystemType fileSystemType) {
+	static const FileSystemType fileSystemTypes[] = {FileSystemType::UNDEFINED,
+		FileSystemType::LOCAL,
+		FileSystemType::HDFS,
+		FileSystemType::S3,
+		FileSystemType::NFS4,
+		FileSystemType::GOOGLE_CLOUD_STORAGE};
+	static std::array<std::unique_ptr<FileSystemMetrics>, 6> metrics = [] {
+		Metrics::MetricsRegistry & registry = Metrics::MetricsRegistry::getInstance();
+		std::array<std::unique_ptr<FileSystemMetrics>, 6> metrics;
+		for(FileSystemType fileSystemType : fileSystemTypes) {
+			const Metrics::MetricsRegistry::Labels labels{{"scheme", getScheme(fileSystemType)}};
+			metrics[static_cast<int>(fileSystemType)].reset(new FileSystemMetrics{
+				registry.getCounter(
+					"blazing_filesystem_requests_total", "Requests made to the file systems", labels),
+				registry.getHistogram("blazing_filesystem_request_seconds",
+					"Latency of the requests made to the file systems, reads and writes included",
+					1e-6,
+					labels),
+				registry.getCounter("blazing_filesystem_read_bytes_total", "Bytes read from the file systems", labels),
+				registry.getCounter(
+					"blazing_filesystem_written_bytes_total", "Bytes written to the file systems", labels)});
+		}
+		return metrics;
+	}();
+	return *metrics[static_cast<int>(fileSystemType)];
+}
+
+std::string FileSystemMetrics::getScheme(FileSystemType fileSystemType) {
+	switch(fileSystemType) {
+	case FileSystemType::LOCAL: return "local";
+	case FileSystemType::HDFS: return "hdfs";
+	case FileSystemType::S3: return "s3";
+	case FileSystemType::NFS4: return "nfs4";
+	case FileSystemType::GOOGLE_CLOUD_STORAGE: return "gs";
+	default: return "undefined";
+	}
+}
+
+MeteredFileSystem::MeteredFileSystem(std::unique_ptr<FileSystemInterface> fileSystem)
+	: fileSystem(std::move(fileSystem)), metrics(FileSystemMetrics::get(this->fileSystem->getFileSystemType())) {}
+
+MeteredFileSystem::~MeteredFileSystem() {}
+
+FileSystemType MeteredFileSystem::getFileSystemType() const noexcept { return this->fileSystem->getFileSystemType(); }
+
+FileSystemConnection MeteredFileSystem::getFileSystemConnection() const noexcept {
+	return this->fileSystem->getFileSystemConnection();
+}
+
+Path MeteredFileSystem::getRoot() const noexcept { return this->fileSystem->getRoot(); }
+
+bool MeteredFileSystem::exists(const Uri & uri) const {
+	MeteredRequest request(this->metrics);
+	return this->fileSystem->exists(uri);
+}
+
+FileStatus MeteredFileSystem::getFileStatus(const Uri & uri) const {
+	MeteredRequest request(this->metrics);
+	return this->fileSystem->getFileStatus(uri);
+}
+
+std::vector<FileStatus> MeteredFileSystem::list(const Uri & uri, const FileFilter & filter) const {
+	MeteredRequest request(this->metrics);
+	return this->fileSystem->list(uri, filter);
+}
+
+std::vector<FileStatus> MeteredFileSystem::list(
+	const Uri & uri, FileType fileType, const std::string & wildcard) const {
+	MeteredRequest request(this->metrics);
+	return this->fileSystem->list(uri, fileType, wildcard);
+}
+
+std::vector<Uri> MeteredFileSystem::list(const Uri & uri, const std::string & wildcard) const {
+	MeteredRequest request(this->metrics);
+	return this->fileSystem->list(uri, wildcard);
+}
+
+std::vector<std::string> MeteredFileSystem::listResourceNames(
+	const Uri & uri, FileType fileType, const std::string & wildcard) const {
+	MeteredRequest request(this->metrics);
+	return this->fileSystem->listResourceNames(uri, fileType, wildcard);
+}
+
+std::vector<std::string> MeteredFileSystem::listResourceNames(const Uri & uri, const std::string & wildcard) const {
+	MeteredRequest request(this->metrics);
+	return this->fileSystem->listResourceNames(uri, wildcard);
+}
+
+bool MeteredFileSystem::makeDirectory(const Uri & uri) const {
+	MeteredRequest request(this->metrics);
+	return this->fileSystem->makeDirectory(uri);
+}
+
+bool MeteredFileSystem::remove(const Uri & uri) const {
+	MeteredRequest request(this->metrics);
+	return this->fileSystem->remove(uri);
+}
+
+bool MeteredFileSystem::move(const Uri & src, const Uri & dst) const {
+	MeteredRequest request(this->metrics);
+	return this->fileSystem->move(src, dst);
+}
+
+bool MeteredFileSystem::truncateFile(const Uri & uri, long long length) const {
+	MeteredRequest request(this->metrics);
+	return this->fileSystem->truncateFile(uri, length);
+}
+
+std::shared_ptr<arrow::io::RandomAccessFile> MeteredFileSystem::openReadable(const Uri & uri) const {
+	std::shared_ptr<arrow::io::RandomAccessFile> file;
+	{
+		MeteredRequest request(this->metrics);
+		file = this->fileSystem->openReadable(uri);
+	}
+	if(file == nullptr) {
+		return file;
+	}
+	return std::make_shared<MeteredReadableFile>(file, this->metrics);
+}
+
+std::shared_ptr<arrow::io::OutputStream> MeteredFileSystem::openWriteable(const Uri & uri) const {
+	std::shared_ptr<arrow::io::OutputStream> stream;
+	{
+		MeteredRequest request(this->metrics);
+		stream = this->fileSystem->openWriteable(uri);
+	}
+	if(stream == nullptr) {
+		return stream;
+	}
+	return std::make_shared<MeteredOutputStream>(stream, this->metrics);
+}
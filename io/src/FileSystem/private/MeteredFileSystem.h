@@ -0,0 +1,81 @@
+/*
+ * MeteredFileSystem.h
+ *
+ * FileSystemInterface that counts the requests made to another file system and how long they took, in the metrics of
+ * its scheme. The files it opens count the bytes read and written and the latency of every read and write.
+ */
+
+#ifndef SRC_FILESYSTEM_PRIVATE_METEREDFILESYSTEM_H_
+#define SRC_FILESYSTEM_PRIVATE_METEREDFILESYSTEM_H_
+
+#include <memory>
+#include <string>
+
+#include "FileSystem/FileSystemInterface.h"
+#include "Library/Metrics/Counter.h"
+#include "Library/Metrics/Histogram.h"
+
+// The metrics of the file systems of one type, labeled with their scheme (local, hdfs, s3, nfs4, gs)
+struct FileSystemMetrics {
+	Library::Metrics::Counter & requests;
+	Library::Metrics::Histogram & requestSeconds;
+	Library::Metrics::Counter & readBytes;
+	Library::Metrics::Counter & writtenBytes;
+
+	// registered the first time they are asked for, no lock is taken afterwards
+	static FileSystemMetrics & get(FileSystemType fileSystemType);
+
+	static std::string getScheme(FileSystemType fileSystemType);
+};
+
+// Counts one request and records its latency when it ends
+class MeteredRequest {
+public:
+	explicit MeteredRequest(FileSystemMetrics & metrics) : latency(metrics.requestSeconds) {
+		metrics.requests.increment();
+	}
+
+	MeteredRequest(const MeteredRequest &) = delete;
+
+	MeteredRequest & operator=(const MeteredRequest &) = delete;
+
+private:
+	Library::Metrics::ScopedLatency latency;
+};
+
+class MeteredFileSystem : public FileSystemInterface {
+public:
+	explicit MeteredFileSystem(std::unique_ptr<FileSystemInterface> fileSystem);
+	~MeteredFileSystem();
+
+	FileSystemType getFileSystemType() const noexcept override;
+
+	FileSystemConnection getFileSystemConnection() const noexcept override;
+
+	Path getRoot() const noexcept override;
+
+	bool exists(const Uri & uri) const override;
+	FileStatus getFileStatus(const Uri & uri) const override;
+
+	std::vector<FileStatus> list(const Uri & uri, const FileFilter & filter) const override;
+	std::vector<FileStatus> list(
+		const Uri & uri, FileType fileType, const std::string & wildcard = "*") const override;
+	std::vector<Uri> list(const Uri & uri, const std::string & wildcard = "*") const override;
+	std::vector<std::string> listResourceNames(
+		const Uri & uri, FileType fileType, const std::string & wildcard = "*") const override;
+	std::vector<std::string> listResourceNames(const Uri & uri, const std::string & wildcard = "*") const override;
+
+	bool makeDirectory(const Uri & uri) const override;
+	bool remove(const Uri & uri) const override;
+	bool move(const Uri & src, const Uri & dst) const override;
+	bool truncateFile(const Uri & uri, long long length) const override;
+
+	std::shared_ptr<arrow::io::RandomAccessFile> openReadable(const Uri & uri) const override;
+	std::shared_ptr<arrow::io::OutputStream> openWriteable(const Uri & uri) const override;
+
+private:
+	std::unique_ptr<FileSystemInterface> fileSystem;
+	FileSystemMetrics & metrics;
+};
+
+#endif /* SRC_FILESYSTEM_PRIVATE_METEREDFILESYSTEM_H_ */
@@ -0,0 +1,29 @@
+#include "MeteredOutputStream.h"
+
+MeteredOutputStream::MeteredOutputStream(std::shared_ptr<arrow::io::OutputStream> stream, FileSystemMetrics & metrics)
+	: stream(stream), metrics(metrics) {}
+
+MeteredOutputStream::~MeteredOutputStream() {}
+
+arrow::Status MeteredOutputStream::Close() {
+	MeteredRequest request(this->metrics);
+	return this->stream->Close();
+}
+
+arrow::Status MeteredOutputStream::Write(const void * buffer, int64_t nbytes) {
+	MeteredRequest request(this->metrics);
+	const arrow::Status status = this->stream->Write(buffer, nbytes);
+	if(status.ok()) {
+		this->metrics.writtenBytes.increment(nbytes);
+	}
+	return status;
+}
+
+arrow::Status MeteredOutputStream::Flush() {
+	MeteredRequest request(this->metrics);
+	return this->stream->Flush();
+}
+
+arrow::Status MeteredOutputStream::Tell(int64_t * position) const { return this->stream->Tell(position); }
+
+bool MeteredOutputStream::closed() const { return this->stream->closed(); }
@@ -0,0 +1,34 @@
+/*
+ * MeteredOutputStream.h
+ *
+ * OutputStream that counts the writes, flushes and the close of another stream as requests of its file system, with
+ * the bytes written.
+ */
+
+#ifndef SRC_FILESYSTEM_PRIVATE_METEREDOUTPUTSTREAM_H_
+#define SRC_FILESYSTEM_PRIVATE_METEREDOUTPUTSTREAM_H_
+
+#include "FileSystem/private/MeteredFileSystem.h"
+#include "arrow/io/interfaces.h"
+#include "arrow/status.h"
+
+class MeteredOutputStream : public arrow::io::OutputStream {
+public:
+	MeteredOutputStream(std::shared_ptr<arrow::io::OutputStream> stream, FileSystemMetrics & metrics);
+	~MeteredOutputStream();
+
+	arrow::Status Close() override;
+	arrow::Status Write(const void * buffer, int64_t nbytes) override;
+	arrow::Status Flush() override;
+	arrow::Status Tell(int64_t * position) const override;
+
+	bool closed() const override;
+
+private:
+	std::shared_ptr<arrow::io::OutputStream> stream;
+	FileSystemMetrics & metrics;
+
+	ARROW_DISALLOW_COPY_AND_ASSIGN(MeteredOutputStream);
+};
+
+#endif /* SRC_FILESYSTEM_PRIVATE_METEREDOUTPUTSTREAM_H_ */
@@ -0,0 +1,57 @@
+#include "MeteredReadableFile.h"
+
+#include "arrow/buffer.h"
+
+MeteredReadableFile::MeteredReadableFile(
+	std::shared_ptr<arrow::io::RandomAccessFile> file, FileSystemMetrics & metrics)
+	: file(file), metrics(metrics) {}
+
+MeteredReadableFile::~MeteredReadableFile() {}
+
+arrow::Status MeteredReadableFile::Close() { return this->file->Close(); }
+
+arrow::Status MeteredReadableFile::GetSize(int64_t * size) { return this->file->GetSize(size); }
+
+arrow::Status MeteredReadableFile::Read(int64_t nbytes, int64_t * bytesRead, void * buffer) {
+	MeteredRequest request(this->metrics);
+	const arrow::Status status = this->file->Read(nbytes, bytesRead, buffer);
+	if(status.ok()) {
+		this->metrics.readBytes.increment(*bytesRead);
+	}
+	return status;
+}
+
+arrow::Status MeteredReadableFile::Read(int64_t nbytes, std::shared_ptr<arrow::Buffer> * out) {
+	MeteredRequest request(this->metrics);
+	const arrow::Status status = this->file->Read(nbytes, out);
+	if(status.ok()) {
+		this->metrics.readBytes.increment((*out)->size());
+	}
+	return status;
+}
+
+arrow::Status MeteredReadableFile::ReadAt(int64_t position, int64_t nbytes, int64_t * bytesRead, void * buffer) {
+	MeteredRequest request(this->metrics);
+	const arrow::Status status = this->file->ReadAt(position, nbytes, bytesRead, buffer);
+	if(status.ok()) {
+		this->metrics.readBytes.increment(*bytesRead);
+	}
+	return status;
+}
+
+arrow::Status MeteredReadableFile::ReadAt(int64_t position, int64_t nbytes, std::shared_ptr<arrow::Buffer> * out) {
+	MeteredRequest request(this->metrics);
+	const arrow::Status status = this->file->ReadAt(position, nbytes, out);
+	if(status.ok()) {
+		this->metrics.readBytes.increment((*out)->size());
+	}
+	return status;
+}
+
+bool MeteredReadableFile::supports_zero_copy() const { return this->file->supports_zero_copy(); }
+
+arrow::Status MeteredReadableFile::Seek(int64_t position) { return this->file->Seek(position); }
+
+arrow::Status MeteredReadableFile::Tell(int64_t * position) const { return this->file->Tell(position); }
+
+bool MeteredReadableFile::closed() const { return this->file->closed(); }
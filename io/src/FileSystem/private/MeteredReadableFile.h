@@ -0,0 +1,45 @@
+/*
+ * MeteredReadableFile.h
+ *
+ * RandomAccessFile that counts the reads of another file as requests of its file system, with the bytes they read.
+ */
+
+#ifndef SRC_FILESYSTEM_PRIVATE_METEREDREADABLEFILE_H_
+#define SRC_FILESYSTEM_PRIVATE_METEREDREADABLEFILE_H_
+
+#include "FileSystem/private/MeteredFileSystem.h"
+#include "arrow/io/interfaces.h"
+#include "arrow/status.h"
+
+class MeteredReadableFile : public arrow::io::RandomAccessFile {
+public:
+	MeteredReadableFile(std::shared_ptr<arrow::io::RandomAccessFile> file, FileSystemMetrics & metrics);
+	~MeteredReadableFile();
+
+	arrow::Status Close() override;
+
+	arrow::Status GetSize(int64_t * size) override;
+
+	arrow::Status Read(int64_t nbytes, int64_t * bytesRead, void * buffer) override;
+
+	arrow::Status Read(int64_t nbytes, std::shared_ptr<arrow::Buffer> * out) override;
+
+	arrow::Status ReadAt(int64_t position, int64_t nbytes, int64_t * bytesRead, void * buffer) override;
+
+	arrow::Status ReadAt(int64_t position, int64_t nbytes, std::shared_ptr<arrow::Buffer> * out) override;
+
+	bool supports_zero_copy() const override;
+
+	arrow::Status Seek(int64_t position) override;
+	arrow::Status Tell(int64_t * position) const override;
+
+	bool closed() const override;
+
+private:
+	std::shared_ptr<arrow::io::RandomAccessFile> file;
+	FileSystemMetrics & metrics;
+
+	ARROW_DISALLOW_COPY_AND_ASSIGN(MeteredReadableFile);
+};
+
+#endif /* SRC_FILESYSTEM_PRIVATE_METEREDREADABLEFILE_H_ */
@@ -0,0 +1,211 @@
+#include "MultipartOutputStream.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+#include "Library/Logging/Logger.h"
+#include "Util/ChecksumUtil.h"
+
+namespace Logging = Library::Logging;
+
+namespace {
+const size_t DEFAULT_UPLOAD_THREADS = 16;
+}
+
+struct MultipartOutputStream::State {
+	MultipartUploadFunctions functions;
+	MultipartOutputStreamOptions options;
+
+	std::mutex mutex;
+	std::condition_variable changed;
+	int numParts = 0;
+	int partsInFlight = 0;
+	std::vector<std::string> partIds;  // by part number - 1, set as each part finishes
+	arrow::Status error;			   // the first part that failed for good, later writes and parts stop at it
+	std::atomic<int64_t> numUploads{0};
+};
+
+MultipartOutputStream::MultipartOutputStream(
+	MultipartUploadFunctions functions, std::shared_ptr<ThreadPool> uploadPool, MultipartOutputStreamOptions options)
+	: uploadPool(uploadPool), state(std::make_shared<State>()), position(0), partsWritten(0), isClosed(false) {
+	this->state->functions = functions;
+	this->state->options = options;
+	this->state->options.partSize = std::max<int64_t>(options.partSize, 1);
+	this->state->options.maxPartsInFlight = std::max(options.maxPartsInFlight, 1);
+	this->state->options.maxAttempts = std::max(options.maxAttempts, 1);
+}
+
+MultipartOutputStream::~MultipartOutputStream() {
+	if(this->isClosed) {
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(this->state->mutex);
+		if(this->state->error.ok()) {
+			this->state->error = arrow::Status::IOError("The stream was destroyed before it was closed");
+		}
+	}
+	// the functions can point to the client of the store, no part can use them once the stream is gone
+	this->waitForParts();
+	if(this->state->functions.abort) {
+		this->state->functions.abort();
+	}
+}
+
+std::shared_ptr<ThreadPool> MultipartOutputStream::getDefaultUploadPool() {
+	static std::shared_ptr<ThreadPool> pool = std::make_shared<ThreadPool>(DEFAULT_UPLOAD_THREADS);
+	return pool;
+}
+
+arrow::Status MultipartOutputStream::Write(const void * data, int64_t nbytes) {
+	if(this->isClosed) {
+		return arrow::Status::IOError("Write on a closed stream");
+	}
+
+	const uint8_t * bytes = static_cast<const uint8_t *>(data);
+	while(nbytes > 0) {
+		// S3 takes up to 10000 parts, growing the parts every 1000 keeps large objects under that
+		const int64_t partSize = this->state->options.partSize << std::min(this->partsWritten / 1000, 10);
+		if(this->buffer == nullptr) {
+			this->buffer = std::make_shared<std::vector<uint8_t>>();
+			this->buffer->reserve(partSize);
+		}
+		const int64_t bytesToCopy = std::min<int64_t>(nbytes, partSize - this->buffer->size());
+		this->buffer->insert(this->buffer->end(), bytes, bytes + bytesToCopy);
+		bytes += bytesToCopy;
+		nbytes -= bytesToCopy;
+		this->position += bytesToCopy;
+
+		if(static_cast<int64_t>(this->buffer->size()) == partSize) {
+			this->submitPart();
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(this->state->mutex);
+	return this->state->error;
+}
+
+void MultipartOutputStream::submitPart() {
+	std::shared_ptr<std::vector<uint8_t>> part = std::move(this->buffer);
+	this->buffer = nullptr;
+	this->partsWritten++;
+
+	std::unique_lock<std::mutex> lock(this->state->mutex);
+	this->state->changed.wait(lock, [this]() {
+		return this->state->partsInFlight < this->state->options.maxPartsInFlight || !this->state->error.ok();
+	});
+	if(!this->state->error.ok()) {
+		return;
+	}
+
+	const int partNumber = ++this->state->numParts;
+	this->state->partIds.resize(partNumber);
+	this->state->partsInFlight++;
+	lock.unlock();
+
+	std::shared_ptr<State> sharedState = this->state;
+	this->uploadPool->submit(
+		[sharedState, partNumber, part]() mutable { uploadPart(sharedState, partNumber, std::move(part)); });
+}
+
+void MultipartOutputStream::uploadPart(
+	std::shared_ptr<State> state, int partNumber, std::shared_ptr<std::vector<uint8_t>> part) {
+	const std::string md5 = ChecksumUtil::toBase64(ChecksumUtil::md5(part->data(), part->size()));
+	const MultipartOutputStreamOptions & options = state->options;
+
+	arrow::Status status;
+	std::string partId;
+	for(int attempt = 0; attempt < options.maxAttempts; attempt++) {
+		if(attempt > 0) {
+			{
+				std::lock_guard<std::mutex> lock(state->mutex);
+				if(!state->error.ok()) {
+					// the stream already failed, retrying this part would be of no use
+					break;
+				}
+			}
+			Logging::Logger().logWarn("Retrying the upload of part " + std::to_string(partNumber) + " after " +
+									  status.ToString());
+			std::this_thread::sleep_for(std::chrono::milliseconds(int64_t(options.retryDelayMs) << (attempt - 1)));
+		}
+
+		state->numUploads++;
+		try {
+			status = state->functions.uploadPart(partNumber, part->data(), part->size(), md5, &partId);
+		} catch(const std::exception & e) {
+			status = arrow::Status::IOError(e.what());
+		}
+		if(status.ok() || !status.IsIOError()) {
+			break;
+		}
+	}
+	// the memory of the part is free before a waiting write can allocate the next one
+	part.reset();
+
+	std::lock_guard<std::mutex> lock(state->mutex);
+	state->partsInFlight--;
+	if(status.ok()) {
+		state->partIds[partNumber - 1] = partId;
+	} else if(state->error.ok()) {
+		Logging::Logger().logError("Uploading part " + std::to_string(partNumber) + " failed: " + status.ToString());
+		state->error = arrow::Status::IOError("Uploading part " + std::to_string(partNumber) +
+											  " failed: " + status.ToString());
+	}
+	state->changed.notify_all();
+}
+
+arrow::Status MultipartOutputStream::waitForParts() {
+	std::unique_lock<std::mutex> lock(this->state->mutex);
+	this->state->changed.wait(lock, [this]() { return this->state->partsInFlight == 0; });
+	return this->state->error;
+}
+
+arrow::Status MultipartOutputStream::Flush() {
+	if(this->isClosed) {
+		return arrow::Status::OK();
+	}
+	return this->waitForParts();
+}
+
+arrow::Status MultipartOutputStream::Close() {
+	if(this->isClosed) {
+		return arrow::Status::OK();
+	}
+
+	// an empty object still needs a part
+	if(this->buffer != nullptr || this->state->numParts == 0) {
+		if(this->buffer == nullptr) {
+			this->buffer = std::make_shared<std::vector<uint8_t>>();
+		}
+		this->submitPart();
+	}
+	arrow::Status status = this->waitForParts();
+	this->isClosed = true;
+
+	if(status.ok()) {
+		try {
+			status = this->state->functions.complete(this->state->partIds);
+		} catch(const std::exception & e) {
+			status = arrow::Status::IOError(e.what());
+		}
+	}
+	if(!status.ok() && this->state->functions.abort) {
+		this->state->functions.abort();
+	}
+	return status;
+}
+
+arrow::Status MultipartOutputStream::Tell(int64_t * position) const {
+	*position = this->position;
+	return arrow::Status::OK();
+}
+
+bool MultipartOutputStream::closed() const { return this->isClosed; }
+
+int64_t MultipartOutputStream::getNumUploads() const { return this->state->numUploads; }
@@ -0,0 +1,105 @@
+/*
+ * MultipartOutputStream.h
+ *
+ * Write-behind output stream for object stores that assemble an object from parts (S3 multipart uploads, GCS
+ * composed objects). Writes are buffered into parts that upload in parallel while the caller keeps writing, with at
+ * most a bounded number of parts in memory. Each part carries the MD5 of its bytes so the store rejects it when it got
+ * corrupted on the way, and a part that fails is retried by itself instead of rewriting the whole object. The store is
+ * reached through plain functions, so the stream can be tested with an in memory store.
+ */
+
+#ifndef SRC_FILESYSTEM_PRIVATE_MULTIPARTOUTPUTSTREAM_H_
+#define SRC_FILESYSTEM_PRIVATE_MULTIPARTOUTPUTSTREAM_H_
+
+#include "Util/ThreadPool.h"
+#include "arrow/io/interfaces.h"
+#include "arrow/status.h"
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct MultipartOutputStreamOptions {
+	// Writes are uploaded in parts of this size, S3 needs at least 5MB for every part but the last one. The size
+	// doubles every 1000 parts so an object of a few TB still fits in the 10000 parts S3 takes.
+	int64_t partSize = 8 << 20;
+
+	// Parts waiting for an upload or uploading, a write blocks while there are this many. The memory of a stream is
+	// bounded by partSize times one more than this, the part being written.
+	int maxPartsInFlight = 4;
+
+	// Uploads of a part before the stream gives up on it
+	int maxAttempts = 5;
+
+	// Wait before the second upload of a part, doubled for every later one
+	int retryDelayMs = 100;
+};
+
+struct MultipartUploadFunctions {
+	// Uploads a part (numbered from 1) along with the base64 MD5 of its bytes and sets partId to what the store needs
+	// to assemble the object with it (an S3 ETag, the name of a GCS part object). An IOError is retried, any other
+	// error fails the stream right away.
+	std::function<arrow::Status(
+		int partNumber, const uint8_t * data, int64_t nbytes, const std::string & md5, std::string * partId)>
+		uploadPart;
+
+	// Assembles the object from every part in order
+	std::function<arrow::Status(const std::vector<std::string> & partIds)> complete;
+
+	// Drops the parts uploaded so far, called once when the stream fails or is destroyed before Close. Optional.
+	std::function<void()> abort;
+};
+
+class MultipartOutputStream : public arrow::io::OutputStream {
+public:
+	MultipartOutputStream(MultipartUploadFunctions functions,
+		std::shared_ptr<ThreadPool> uploadPool = getDefaultUploadPool(),
+		MultipartOutputStreamOptions options = MultipartOutputStreamOptions());
+
+	// A stream that was not closed aborts its upload, an object is never left half written
+	~MultipartOutputStream();
+
+	// Blocks only while maxPartsInFlight parts are already in memory. Fails once a part failed for good.
+	arrow::Status Write(const void * data, int64_t nbytes) override;
+
+	// Waits for the parts already full, the bytes of a part that is not full yet stay buffered since a store can
+	// reject small parts
+	arrow::Status Flush() override;
+
+	// Uploads the last part, waits for every part and assembles the object
+	arrow::Status Close() override;
+
+	arrow::Status Tell(int64_t * position) const override;
+
+	bool closed() const override;
+
+	// parts uploaded including retries, for tests and logs
+	int64_t getNumUploads() const;
+
+	// Pool shared by every multipart stream so the number of uploads in flight stays bounded
+	static std::shared_ptr<ThreadPool> getDefaultUploadPool();
+
+private:
+	struct State;
+
+	// hands the part being written to the upload pool once there is room for it
+	void submitPart();
+
+	// uploads with retries, runs on the upload pool and only touches the shared state
+	static void uploadPart(std::shared_ptr<State> state, int partNumber, std::shared_ptr<std::vector<uint8_t>> part);
+
+	// waits for every part handed to the pool and returns the error of the stream
+	arrow::Status waitForParts();
+
+	std::shared_ptr<ThreadPool> uploadPool;
+	std::shared_ptr<State> state;
+	std::shared_ptr<std::vector<uint8_t>> buffer;  // the part being written
+	int64_t position;
+	int partsWritten;
+	bool isClosed;
+
+	ARROW_DISALLOW_COPY_AND_ASSIGN(MultipartOutputStream);
+};
+
+#endif /* SRC_FILESYSTEM_PRIVATE_MULTIPARTOUTPUTSTREAM_H_ */
@@ -0,0 +1,234 @@
+#include "RangeReader.h"
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+
+namespace {
+
+const size_t DEFAULT_IO_THREADS = 16;
+
+arrow::Status fetchCompletely(const RangeReader::FetchFunction & fetch,
+	int64_t position,
+	int64_t nbytes,
+	uint8_t * out) {
+	int64_t bytesRead = 0;
+	arrow::Status status;
+	try {
+		status = fetch(position, nbytes, &bytesRead, out);
+	} catch(const std::exception & e) {
+		return arrow::Status::IOError(e.what());
+	}
+
+	if(status.ok() && bytesRead < nbytes) {
+		return arrow::Status::IOError("Range request at " + std::to_string(position) + " returned " +
+									  std::to_string(bytesRead) + " of " + std::to_string(nbytes) + " bytes");
+	}
+	return status;
+}
+
+}  // namespace
+
+RangeReader::RangeReader(
+	FetchFunction fetch, int64_t size, std::shared_ptr<ThreadPool> ioPool, RangeReaderOptions options)
+	: fetch(fetch), size(size), ioPool(ioPool), options(options), stats(std::make_shared<Stats>()), useCounter(0),
+	  nextSequentialPosition(0) {
+	this->options.blockSize = std::max<int64_t>(this->options.blockSize, 1);
+	this->options.maxRequestSize = std::max(this->options.maxRequestSize, this->options.blockSize);
+}
+
+std::shared_ptr<ThreadPool> RangeReader::getDefaultIoPool() {
+	static std::shared_ptr<ThreadPool> pool = std::make_shared<ThreadPool>(DEFAULT_IO_THREADS);
+	return pool;
+}
+
+int64_t RangeReader::getBlockSize(int64_t blockIndex) const {
+	const int64_t start = blockIndex * this->options.blockSize;
+	return std::min(start + this->options.blockSize, this->size) - start;
+}
+
+void RangeReader::fetchBlocks(int64_t firstBlock, int64_t lastBlock) {
+	const int64_t blocksPerRequest = this->options.maxRequestSize / this->options.blockSize;
+
+	for(int64_t requestFirst = firstBlock; requestFirst <= lastBlock; requestFirst += blocksPerRequest) {
+		const int64_t requestLast = std::min(requestFirst + blocksPerRequest - 1, lastBlock);
+
+		std::vector<std::shared_ptr<std::promise<std::shared_ptr<Block>>>> promises;
+		for(int64_t blockIndex = requestFirst; blockIndex <= requestLast; blockIndex++) {
+			auto promise = std::make_shared<std::promise<std::shared_ptr<Block>>>();
+			this->blocks[blockIndex] = CachedBlock{promise->get_future().share(), ++this->useCounter};
+			promises.push_back(promise);
+		}
+
+		// the task only holds copies so it can outlive the reader
+		const FetchFunction fetch = this->fetch;
+		const std::shared_ptr<Stats> stats = this->stats;
+		const int64_t blockSize = this->options.blockSize;
+		const int64_t position = requestFirst * blockSize;
+		const int64_t nbytes = std::min((requestLast + 1) * blockSize, this->size) - position;
+		this->ioPool->submit([fetch, stats, blockSize, position, nbytes, promises]() {
+			stats->numRequests++;
+			stats->bytesRequested += nbytes;
+
+			std::vector<uint8_t> buffer(nbytes);
+			const arrow::Status status = fetchCompletely(fetch, position, nbytes, buffer.data());
+
+			for(size_t i = 0; i < promises.size(); i++) {
+				auto block = std::make_shared<Block>();
+				block->status = status;
+				if(status.ok()) {
+					const int64_t blockStart = i * blockSize;
+					const int64_t blockEnd = std::min(blockStart + blockSize, nbytes);
+					block->data.assign(buffer.begin() + blockStart, buffer.begin() + blockEnd);
+				}
+				promises[i]->set_value(block);
+			}
+		});
+	}
+}
+
+void RangeReader::evictBlocks() {
+	while(this->blocks.size() > this->options.maxCachedBlocks) {
+		auto leastRecentlyUsed = std::min_element(this->blocks.begin(),
+			this->blocks.end(),
+			[](const std::pair<const int64_t, CachedBlock> & a, const std::pair<const int64_t, CachedBlock> & b) {
+				return a.second.lastUsed < b.second.lastUsed;
+			});
+		this->blocks.erase(leastRecentlyUsed);
+	}
+}
+
+arrow::Status RangeReader::ReadAt(int64_t position, int64_t nbytes, int64_t * bytesRead, uint8_t * out) {
+	*bytesRead = 0;
+	if(position < 0 || nbytes < 0) {
+		return arrow::Status::Invalid("Invalid read of " + std::to_string(nbytes) + " bytes at " +
+									  std::to_string(position));
+	}
+	if(position >= this->size || nbytes == 0) {
+		return arrow::Status::OK();
+	}
+
+	nbytes = std::min(nbytes, this->size - position);
+	const int64_t end = position + nbytes;
+	const int64_t blockSize = this->options.blockSize;
+	const int64_t firstBlock = position / blockSize;
+	const int64_t lastBlock = (end - 1) / blockSize;
+
+	// blocks the read covers completely are fetched straight into out, the partially covered ones go through the
+	// cache so the reads next to this one find them
+	std::vector<std::pair<int64_t, int64_t>> directRanges;
+	std::vector<std::pair<int64_t, std::shared_future<std::shared_ptr<Block>>>> cachedBlocks;
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+
+		int64_t directStart = -1;
+		for(int64_t blockIndex = firstBlock; blockIndex <= lastBlock + 1; blockIndex++) {
+			const int64_t blockStart = blockIndex * blockSize;
+			const bool covered = blockIndex <= lastBlock && blockStart >= position &&
+								 blockStart + this->getBlockSize(blockIndex) <= end;
+			auto cached = blockIndex <= lastBlock ? this->blocks.find(blockIndex) : this->blocks.end();
+
+			if(covered && cached == this->blocks.end()) {
+				if(directStart < 0) {
+					directStart = blockStart;
+				}
+				continue;
+			}
+
+			if(directStart >= 0) {
+				const int64_t directEnd = std::min(blockStart, end);
+				for(int64_t start = directStart; start < directEnd; start += this->options.maxRequestSize) {
+					directRanges.emplace_back(start, std::min(start + this->options.maxRequestSize, directEnd) - start);
+				}
+				directStart = -1;
+			}
+
+			if(blockIndex > lastBlock) {
+				break;
+			}
+
+			if(cached == this->blocks.end()) {
+				this->fetchBlocks(blockIndex, blockIndex);
+				cached = this->blocks.find(blockIndex);
+			}
+			cached->second.lastUsed = ++this->useCounter;
+			cachedBlocks.emplace_back(blockIndex, cached->second.block);
+		}
+
+		if(this->options.readAheadBlocks > 0 && position == this->nextSequentialPosition) {
+			const int64_t lastAheadBlock =
+				std::min(lastBlock + this->options.readAheadBlocks, (this->size - 1) / blockSize);
+			int64_t missingStart = -1;
+			for(int64_t blockIndex = lastBlock + 1; blockIndex <= lastAheadBlock + 1; blockIndex++) {
+				const bool missing = blockIndex <= lastAheadBlock && this->blocks.count(blockIndex) == 0;
+				if(missing && missingStart < 0) {
+					missingStart = blockIndex;
+				} else if(!missing && missingStart >= 0) {
+					this->fetchBlocks(missingStart, blockIndex - 1);
+					missingStart = -1;
+				}
+			}
+		}
+		this->nextSequentialPosition = end;
+
+		this->evictBlocks();
+	}
+
+	// the first direct range runs on the calling thread while the pool takes the others
+	std::vector<std::future<arrow::Status>> directReads;
+	for(size_t i = 1; i < directRanges.size(); i++) {
+		const FetchFunction fetch = this->fetch;
+		const std::shared_ptr<Stats> stats = this->stats;
+		const int64_t start = directRanges[i].first;
+		const int64_t length = directRanges[i].second;
+		uint8_t * destination = out + (start - position);
+		directReads.push_back(this->ioPool->submit([fetch, stats, start, length, destination]() {
+			stats->numRequests++;
+			stats->bytesRequested += length;
+			return fetchCompletely(fetch, start, length, destination);
+		}));
+	}
+
+	arrow::Status status;
+	if(!directRanges.empty()) {
+		this->stats->numRequests++;
+		this->stats->bytesRequested += directRanges[0].second;
+		status = fetchCompletely(
+			this->fetch, directRanges[0].first, directRanges[0].second, out + (directRanges[0].first - position));
+	}
+
+	for(auto & directRead : directReads) {
+		arrow::Status directStatus = directRead.get();
+		if(status.ok()) {
+			status = directStatus;
+		}
+	}
+
+	for(auto & cachedBlock : cachedBlocks) {
+		std::shared_ptr<Block> block = cachedBlock.second.get();
+		if(!block->status.ok()) {
+			// drop the failed block so the next read retries it
+			std::lock_guard<std::mutex> lock(this->mutex);
+			auto cached = this->blocks.find(cachedBlock.first);
+			if(cached != this->blocks.end() && cached->second.block.get() == block) {
+				this->blocks.erase(cached);
+			}
+			if(status.ok()) {
+				status = block->status;
+			}
+			continue;
+		}
+
+		const int64_t blockStart = cachedBlock.first * blockSize;
+		const int64_t copyStart = std::max(position, blockStart);
+		const int64_t copyEnd = std::min(end, blockStart + static_cast<int64_t>(block->data.size()));
+		if(copyEnd > copyStart) {
+			std::memcpy(out + (copyStart - position), block->data.data() + (copyStart - blockStart), copyEnd - copyStart);
+		}
+	}
+
+	if(status.ok()) {
+		*bytesRead = nbytes;
+	}
+	return status;
+}
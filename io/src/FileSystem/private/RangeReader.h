@@ -0,0 +1,97 @@
+/*
+ * RangeReader.h
+ *
+ * Turns the reads of a remote object into range requests that are coalesced, split and prefetched. Each request is
+ * one blocking call of a fetch function (i.e. an S3 GetObject with a Range header), so the reader is independent of
+ * the object store and can be tested with an in memory fetch.
+ */
+
+#ifndef SRC_FILESYSTEM_PRIVATE_RANGEREADER_H_
+#define SRC_FILESYSTEM_PRIVATE_RANGEREADER_H_
+
+#include "Util/ThreadPool.h"
+#include "arrow/status.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+struct RangeReaderOptions {
+	// Reads are fetched and kept in aligned blocks of this size, so small reads close to each other share one request
+	int64_t blockSize = 1 << 20;
+
+	// Larger reads are split into requests of at most this size that run in parallel
+	int64_t maxRequestSize = 4 << 20;
+
+	// Blocks fetched ahead of a sequential read, 0 disables read-ahead
+	int readAheadBlocks = 4;
+
+	// Bound of the memory used by blocks, least recently used blocks are dropped first
+	size_t maxCachedBlocks = 64;
+};
+
+class RangeReader {
+public:
+	// Reads nbytes at position into out, bytesRead can be less than nbytes only at the end of the object
+	typedef std::function<arrow::Status(int64_t position, int64_t nbytes, int64_t * bytesRead, uint8_t * out)>
+		FetchFunction;
+
+	RangeReader(FetchFunction fetch,
+		int64_t size,
+		std::shared_ptr<ThreadPool> ioPool,
+		RangeReaderOptions options = RangeReaderOptions());
+
+	arrow::Status ReadAt(int64_t position, int64_t nbytes, int64_t * bytesRead, uint8_t * out);
+
+	int64_t getSize() const { return this->size; }
+
+	// fetch calls issued so far, prefetches included
+	int64_t getNumRequests() const { return this->stats->numRequests; }
+
+	int64_t getBytesRequested() const { return this->stats->bytesRequested; }
+
+	// Pool shared by every remote readable file so the number of requests in flight stays bounded
+	static std::shared_ptr<ThreadPool> getDefaultIoPool();
+
+private:
+	struct Block {
+		arrow::Status status;
+		std::vector<uint8_t> data;  // shorter than blockSize only for the last block of the object
+	};
+
+	struct CachedBlock {
+		std::shared_future<std::shared_ptr<Block>> block;
+		uint64_t lastUsed;
+	};
+
+	struct Stats {
+		std::atomic<int64_t> numRequests{0};
+		std::atomic<int64_t> bytesRequested{0};
+	};
+
+	// Queues the fetch of the blocks [firstBlock, lastBlock] into the cache, one request per maxRequestSize.
+	// Must be called with the mutex held.
+	void fetchBlocks(int64_t firstBlock, int64_t lastBlock);
+
+	void evictBlocks();
+
+	int64_t getBlockSize(int64_t blockIndex) const;
+
+	FetchFunction fetch;
+	int64_t size;
+	std::shared_ptr<ThreadPool> ioPool;
+	RangeReaderOptions options;
+
+	std::shared_ptr<Stats> stats;
+
+	std::mutex mutex;
+	std::map<int64_t, CachedBlock> blocks;
+	uint64_t useCounter;
+	int64_t nextSequentialPosition;
+};
+
+#endif /* SRC_FILESYSTEM_PRIVATE_RANGEREADER_H_ */
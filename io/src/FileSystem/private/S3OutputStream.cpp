@@ -20,10 +20,12 @@
 #include <aws/s3/model/BucketLocationConstraint.h>
 #include <aws/s3/model/GetBucketLocationRequest.h>
 
+#include <aws/s3/model/AbortMultipartUploadRequest.h>
 #include <aws/s3/model/CompleteMultipartUploadRequest.h>
 #include <aws/s3/model/CreateMultipartUploadRequest.h>
 #include <aws/s3/model/Object.h>
 
+#include <FileSystem/private/MultipartOutputStream.h>
 #include <FileSystem/private/S3ReadableFile.h>
 #include <aws/s3/model/CompletedMultipartUpload.h>
 #include <aws/s3/model/UploadPartRequest.h>
@@ -41,26 +43,29 @@ namespace Logging = Library::Logging;
 const Aws::String FAILED_UPLOAD = "failed-upload";
 class S3OutputStream::S3OutputStreamImpl {
 public:
-	//~S3OutputStreamImpl();
 	S3OutputStreamImpl(
 		const std::string & bucketName, const std::string & objectKey, std::shared_ptr<Aws::S3::S3Client> s3Client);
 
 	arrow::Status close();
 	arrow::Status write(const void * buffer, int64_t nbytes);
-	arrow::Status write(const void * buffer, int64_t nbytes, int64_t * bytes_written);
 	arrow::Status flush();
 	arrow::Status tell(int64_t * position) const;
+	bool closed() const;
 
 private:
+	arrow::Status uploadPart(
+		int partNumber, const uint8_t * data, int64_t nbytes, const std::string & md5, std::string * partId);
+	arrow::Status complete(const std::vector<std::string> & partIds);
+	void abort();
+
 	std::shared_ptr<Aws::S3::S3Client> s3Client;
 	std::string bucket;
 	std::string key;
 
 	Aws::String uploadId;
 
-	std::vector<Aws::S3::Model::CompletedPart> completedParts;  // just an etag (for response) and a part number
-	size_t currentPart;
-	int64_t written;
+	// buffers the writes into parts that upload in parallel, retried and checked one by one
+	std::unique_ptr<MultipartOutputStream> stream;
 };
 
 struct membuf : std::streambuf {
@@ -81,9 +86,6 @@ S3OutputStream::S3OutputStreamImpl::S3OutputStreamImpl(
 	this->key = objectKey;
 	this->s3Client = s3Client;
 
-	currentPart = 1;
-	written = 0;
-
 	Aws::S3::Model::CreateMultipartUploadRequest request;
 	request.SetBucket(bucket);
 	request.SetKey(key);
@@ -108,57 +110,53 @@ S3OutputStream::S3OutputStreamImpl::S3OutputStreamImpl(
 		this->uploadId = FAILED_UPLOAD;
 	}
 
-	// start upload here
+	MultipartUploadFunctions functions;
+	functions.uploadPart =
+		[this](int partNumber, const uint8_t * data, int64_t nbytes, const std::string & md5, std::string * partId) {
+			return this->uploadPart(partNumber, data, nbytes, md5, partId);
+		};
+	functions.complete = [this](const std::vector<std::string> & partIds) { return this->complete(partIds); };
+	functions.abort = [this]() { this->abort(); };
+	this->stream.reset(new MultipartOutputStream(functions));
 }
 
-arrow::Status S3OutputStream::S3OutputStreamImpl::write(const void * buffer, int64_t nbytes) {
+arrow::Status S3OutputStream::S3OutputStreamImpl::uploadPart(
+	int partNumber, const uint8_t * data, int64_t nbytes, const std::string & md5, std::string * partId) {
 	Aws::S3::Model::UploadPartRequest uploadPartRequest;
 	uploadPartRequest.SetBucket(bucket);
 	uploadPartRequest.SetKey(key);
-	uploadPartRequest.SetPartNumber(currentPart);
+	uploadPartRequest.SetPartNumber(partNumber);
 	uploadPartRequest.SetUploadId(uploadId);
-	// char * tempBuffer = (char *) buffer;
-
-	// std::shared_ptr<imemstream> membuffer =  std::make_shared<imemstream>(new );
-	//   imemstream membuffer((char *) buffer,nbytes);
-
-	//    std::shared_ptr<imemstream> memBufferPtr
-	uploadPartRequest.SetBody(std::make_shared<imemstream>((char *) buffer, nbytes));
-
-	// uploadPart1Request.SetContentMD5(HashingUtils::Base64Encode(md5OfStream));
-
+	uploadPartRequest.SetBody(std::make_shared<imemstream>((char *) data, nbytes));
 	uploadPartRequest.SetContentLength(nbytes);
+	// S3 rejects the part with BadDigest when the bytes it got do not match
+	uploadPartRequest.SetContentMD5(md5);
 
-	written += nbytes;
 	Aws::S3::Model::UploadPartOutcome uploadOutcome = s3Client->UploadPart(uploadPartRequest);
 	if(uploadOutcome.IsSuccess()) {
-		Aws::S3::Model::CompletedPart completedPart;
-		completedPart.SetETag(uploadOutcome.GetResult().GetETag());
-		completedPart.SetPartNumber(currentPart);
-		this->completedParts.push_back(completedPart);
-		currentPart++;
+		*partId = uploadOutcome.GetResult().GetETag();
 		return arrow::Status::OK();
-	} else {
-		Logging::Logger().logError("In Write: Uploading part " + std::to_string(currentPart) + " on file " +
-								   this->bucket + "/" + key + ". Problem was " +
-								   uploadOutcome.GetError().GetExceptionName() + " : " +
-								   uploadOutcome.GetError().GetMessage());
-		return arrow::Status::IOError("Had a trouble uploading part " + std::to_string(currentPart) + " on file " +
-									  this->bucket + "/" + key + ". Problem was " +
-									  uploadOutcome.GetError().GetExceptionName() + " : " +
-									  uploadOutcome.GetError().GetMessage());
 	}
-}
 
-arrow::Status S3OutputStream::S3OutputStreamImpl::flush() {
-	// flush is a pass through in all reality
-	// we are making each write send the contents for now for simplicity of design
-	return arrow::Status::OK();
+	const std::string problem = "Had a trouble uploading part " + std::to_string(partNumber) + " on file " +
+								this->bucket + "/" + key + ". Problem was " +
+								uploadOutcome.GetError().GetExceptionName() + " : " +
+								uploadOutcome.GetError().GetMessage();
+	if(uploadOutcome.GetError().ShouldRetry() || uploadOutcome.GetError().GetExceptionName() == "BadDigest") {
+		return arrow::Status::IOError(problem);
+	}
+	return arrow::Status::Invalid(problem);
 }
 
-arrow::Status S3OutputStream::S3OutputStreamImpl::close() {
-	// flush the buffer
-	flush();
+arrow::Status S3OutputStream::S3OutputStreamImpl::complete(const std::vector<std::string> & partIds) {
+	std::vector<Aws::S3::Model::CompletedPart> completedParts;  // just an etag (for response) and a part number
+	for(size_t i = 0; i < partIds.size(); i++) {
+		Aws::S3::Model::CompletedPart completedPart;
+		completedPart.SetETag(partIds[i]);
+		completedPart.SetPartNumber(i + 1);
+		completedParts.push_back(completedPart);
+	}
+
 	Aws::S3::Model::CompleteMultipartUploadRequest completeMultipartUploadRequest;
 
 	completeMultipartUploadRequest.SetBucket(bucket);
@@ -181,10 +179,37 @@ arrow::Status S3OutputStream::S3OutputStreamImpl::close() {
 									  completeMultipartUploadOutcome.GetError().GetExceptionName() + " : " +
 									  completeMultipartUploadOutcome.GetError().GetMessage());
 	}
-	//	s3Client->CompleteMultipartUpload(uploadCompleteRequest);
 }
 
-arrow::Status S3OutputStream::S3OutputStreamImpl::tell(int64_t * position) const { *position = written; }
+void S3OutputStream::S3OutputStreamImpl::abort() {
+	// otherwise S3 keeps (and bills) the parts of the upload until a lifecycle rule drops them
+	Aws::S3::Model::AbortMultipartUploadRequest abortMultipartUploadRequest;
+	abortMultipartUploadRequest.SetBucket(bucket);
+	abortMultipartUploadRequest.SetKey(key);
+	abortMultipartUploadRequest.SetUploadId(uploadId);
+
+	Aws::S3::Model::AbortMultipartUploadOutcome abortMultipartUploadOutcome =
+		s3Client->AbortMultipartUpload(abortMultipartUploadRequest);
+	if(!abortMultipartUploadOutcome.IsSuccess()) {
+		Logging::Logger().logError("Could not abort the upload of " + this->bucket + "/" + key + ". Problem was " +
+								   abortMultipartUploadOutcome.GetError().GetExceptionName() + " : " +
+								   abortMultipartUploadOutcome.GetError().GetMessage());
+	}
+}
+
+arrow::Status S3OutputStream::S3OutputStreamImpl::write(const void * buffer, int64_t nbytes) {
+	return this->stream->Write(buffer, nbytes);
+}
+
+arrow::Status S3OutputStream::S3OutputStreamImpl::flush() { return this->stream->Flush(); }
+
+arrow::Status S3OutputStream::S3OutputStreamImpl::close() { return this->stream->Close(); }
+
+arrow::Status S3OutputStream::S3OutputStreamImpl::tell(int64_t * position) const {
+	return this->stream->Tell(position);
+}
+
+bool S3OutputStream::S3OutputStreamImpl::closed() const { return this->stream->closed(); }
 
 // BEGIN S3OutputStream
 
@@ -202,11 +227,6 @@ arrow::Status S3OutputStream::Flush() { return this->impl_->flush(); }
 
 arrow::Status S3OutputStream::Tell(int64_t * position) const { return this->impl_->tell(position); }
 
-bool S3OutputStream::closed() const {
-	// Since every file interaction is a request, then the file is never really open. This function is necesary due to
-	// the Apache Arrow interface starting with v12. Depending on who or what uses this function, we may want this to
-	// always return false??
-	return true;
-}
+bool S3OutputStream::closed() const { return this->impl_->closed(); }
 
 // END S3OutputStream
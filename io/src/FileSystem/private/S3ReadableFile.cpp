@@ -20,16 +20,67 @@
 #include "Library/Logging/Logger.h"
 namespace Logging = Library::Logging;
 
-// TODO: handle the situation when not all data is read
+namespace {
+
+const int MAX_GET_OBJECT_ATTEMPTS = 3;
+
+// One GetObject with a Range header, retried while S3 says it should be. It doesn't reference the file because
+// read-ahead requests can still be running after the file is gone.
+arrow::Status getObjectRange(const std::shared_ptr<Aws::S3::S3Client> & s3Client,
+	const std::string & bucketName,
+	const std::string & key,
+	int64_t position,
+	int64_t nbytes,
+	int64_t * bytesRead,
+	uint8_t * out) {
+	Aws::S3::Model::GetObjectRequest object_request;
+
+	object_request.SetBucket(bucketName);
+	object_request.SetKey(key);
+	// the end of an http range is inclusive
+	object_request.SetRange("bytes=" + std::to_string(position) + "-" + std::to_string(position + nbytes - 1));
+
+	for(int attempt = 1;; attempt++) {
+		auto results = s3Client->GetObject(object_request);
+
+		if(results.IsSuccess()) {
+			*bytesRead = results.GetResult().GetContentLength();
+			*bytesRead = nbytes < *bytesRead ? nbytes : *bytesRead;
+			results.GetResult().GetBody().read((char *) out, *bytesRead);
+			return arrow::Status::OK();
+		}
+
+		Logging::Logger().logWarn(
+			"S3ReadableFile::ReadAt, GetObject failed for bucketName: " + bucketName + " key " + key);
+		if(results.GetError().ShouldRetry() && attempt < MAX_GET_OBJECT_ATTEMPTS) {
+			Logging::Logger().logTrace("retrying");
+			continue;
+		}
+
+		*bytesRead = 0;
+		Logging::Logger().logError(
+			results.GetError().GetExceptionName() + " : " + results.GetError().GetMessage() + "  SHOULD NOT RETRY");
+		return arrow::Status::IOError(results.GetError().GetExceptionName() + " : " + results.GetError().GetMessage());
+	}
+}
+
+}  // namespace
 
 S3ReadableFile::~S3ReadableFile() {}
 
 
-S3ReadableFile::S3ReadableFile(std::shared_ptr<Aws::S3::S3Client> s3Client, std::string bucketName, std::string key) {
+S3ReadableFile::S3ReadableFile(std::shared_ptr<Aws::S3::S3Client> s3Client,
+	std::string bucketName,
+	std::string key,
+	RangeReaderOptions readerOptions,
+	std::shared_ptr<ThreadPool> ioPool) {
 	this->key = key;
 	this->bucketName = bucketName;
 	this->s3Client = s3Client;
+	this->readerOptions = readerOptions;
+	this->ioPool = ioPool;
 	position = 0;
+	size = -1;
 	valid = true;
 }
 
@@ -48,6 +99,14 @@ arrow::Status S3ReadableFile::Close() {
 }
 
 arrow::Status S3ReadableFile::GetSize(int64_t * size) {
+	{
+		std::lock_guard<std::mutex> lock(this->readerMutex);
+		if(this->size >= 0) {
+			*size = this->size;
+			return arrow::Status::OK();
+		}
+	}
+
 	Aws::S3::Model::HeadObjectRequest request;
 
 	request.SetBucket(bucketName);
@@ -58,6 +117,8 @@ arrow::Status S3ReadableFile::GetSize(int64_t * size) {
 	if(results.IsSuccess()) {
 		*size = results.GetResult().GetContentLength();
 
+		std::lock_guard<std::mutex> lock(this->readerMutex);
+		this->size = *size;
 	} else {
 		*size = -1;
 		Logging::Logger().logWarn("S3ReadableFile::GetSize, HeadObject failed");
@@ -76,198 +137,87 @@ arrow::Status S3ReadableFile::GetSize(int64_t * size) {
 	return arrow::Status::OK();
 }
 
-arrow::Status S3ReadableFile::Read(int64_t nbytes, int64_t * bytesRead, void * buffer) {
-	//	std::cout<<"S3ReadableFile::Read " + std::to_string(nbytes)<<std::endl;
-	Aws::S3::Model::GetObjectRequest object_request;
-
-	object_request.SetBucket(bucketName);
-	object_request.SetKey(key);
-	object_request.SetRange("bytes=" + std::to_string(position) + "-" + std::to_string(position + nbytes));
-
-	auto results = this->s3Client->GetObject(object_request);
+arrow::Status S3ReadableFile::getReader(std::shared_ptr<RangeReader> * reader) {
+	int64_t size;
+	arrow::Status status = this->GetSize(&size);
+	if(!status.ok()) {
+		return status;
+	}
 
-	if(!results.IsSuccess()) {
-		// TODO: Make bad arrow status here
-		Logging::Logger().logWarn(
-			"S3ReadableFile::Read, GetObject failed for bucketName: " + bucketName + " key " + key);
-		bool shouldRetry = results.GetError().ShouldRetry();
+	std::lock_guard<std::mutex> lock(this->readerMutex);
+	if(!this->reader) {
+		this->reader = std::make_shared<RangeReader>(
+			[s3Client = this->s3Client, bucketName = this->bucketName, key = this->key](
+				int64_t position, int64_t nbytes, int64_t * bytesRead, uint8_t * out) {
+				return getObjectRange(s3Client, bucketName, key, position, nbytes, bytesRead, out);
+			},
+			size,
+			this->ioPool,
+			this->readerOptions);
+	}
+	*reader = this->reader;
+	return arrow::Status::OK();
+}
 
-		if(shouldRetry) {
-			Logging::Logger().logTrace("retrying");
-			return this->Read(nbytes, bytesRead, buffer);
-		} else {
-			*bytesRead = 0;
-			Logging::Logger().logError(
-				results.GetError().GetExceptionName() + " : " + results.GetError().GetMessage() + "  SHOULD NOT RETRY");
-		}
+int64_t S3ReadableFile::getNumRequests() {
+	std::lock_guard<std::mutex> lock(this->readerMutex);
+	return this->reader ? this->reader->getNumRequests() : 0;
+}
 
-		return arrow::Status::IOError(results.GetError().GetExceptionName() + " : " + results.GetError().GetMessage());
-	} else {
-		*bytesRead = results.GetResult().GetContentLength();
-		*bytesRead = nbytes < *bytesRead ? nbytes : *bytesRead;
-		results.GetResult().GetBody().read((char *) buffer, *bytesRead);
-		position += *bytesRead;
-		return arrow::Status::OK();
+arrow::Status S3ReadableFile::Read(int64_t nbytes, int64_t * bytesRead, void * buffer) {
+	arrow::Status status = this->ReadAt(this->position, nbytes, bytesRead, buffer);
+	if(status.ok()) {
+		this->position += *bytesRead;
 	}
+	return status;
 }
 
 arrow::Status S3ReadableFile::Read(int64_t nbytes, std::shared_ptr<arrow::Buffer> * out) {
-	//	std::cout<<"S3ReadableFile::Read " + std::to_string(nbytes)<<std::endl;
-	Aws::S3::Model::GetObjectRequest object_request;
-
-	object_request.SetBucket(bucketName);
-	object_request.SetKey(key);
-	object_request.SetRange("bytes=" + std::to_string(position) + "-" + std::to_string(position + nbytes));
-
-	auto results = this->s3Client->GetObject(object_request);
-
-	if(!results.IsSuccess()) {
-		// TODO: Make bad arrow status here
-
-		Logging::Logger().logWarn(
-			"S3ReadableFile::Read, GetObject failed for bucketName: " + bucketName + " key " + key);
-		bool shouldRetry = results.GetError().ShouldRetry();
-		if(shouldRetry) {
-			Logging::Logger().logTrace("retrying");
-			return this->Read(nbytes, out);
-		} else {
-			Logging::Logger().logError(
-				results.GetError().GetExceptionName() + " : " + results.GetError().GetMessage() + "  SHOULD NOT RETRY");
-		}
-
-		return arrow::Status::IOError(results.GetError().GetExceptionName() + " : " + results.GetError().GetMessage());
-	} else {
-		// old implementation
-		/*
-std::shared_ptr<arrow::ResizableBuffer> buffer;
-AllocateResizableBuffer(arrow::default_memory_pool(), nbytes, &buffer);
-
-int64_t bytesRead = results.GetResult().GetContentLength();
-
-memcpy(buffer->mutable_data(), results.GetResult().GetBody().rdbuf(), bytesRead);
-
-position += bytesRead;
-*out = buffer;
-return arrow::Status::OK();
-*/
-
-		int64_t bytesRead = results.GetResult().GetContentLength();
-		bytesRead = nbytes < bytesRead ? nbytes : bytesRead;
-		position += bytesRead;
-		if(bytesRead < nbytes) {
-			Logging::Logger().logError(
-				"Did not read all the bytes at S3ReadableFile::ReadAt(int64_t position, int64_t nbytes, "
-				"std::shared_ptr<arrow::Buffer>* out)");
-		}
-		//		results.GetResult().GetBody().read((char*)(out->get()->mutable_data()), bytesRead);
-
-		std::shared_ptr<arrow::ResizableBuffer> buffer;
-		AllocateResizableBuffer(arrow::default_memory_pool(), nbytes, &buffer);
-
-		results.GetResult().GetBody().read((char *) (buffer->mutable_data()), bytesRead);
-		*out = buffer;
-
-		return arrow::Status::OK();
+	arrow::Status status = this->ReadAt(this->position, nbytes, out);
+	if(status.ok()) {
+		this->position += (*out)->size();
 	}
+	return status;
 }
 
 arrow::Status S3ReadableFile::ReadAt(int64_t position, int64_t nbytes, int64_t * bytesRead, void * buffer) {
-	//	std::cout<<"S3ReadableFile::ReadAt " + std::to_string(nbytes)<<std::endl;
-
-	Aws::S3::Model::GetObjectRequest object_request;
-
-	object_request.SetBucket(bucketName);
-	object_request.SetKey(key);
-	object_request.SetRange("bytes=" + std::to_string(position) + "-" + std::to_string(position + nbytes));
-
-	auto results = this->s3Client->GetObject(object_request);
-
-	if(!results.IsSuccess()) {
-		// TODO: Make bad arrow status here
-
-		Logging::Logger().logWarn(
-			"S3ReadableFile::ReadAt, GetObject failed for bucketName: " + bucketName + " key " + key);
-		bool shouldRetry = results.GetError().ShouldRetry();
-		if(shouldRetry) {
-			Logging::Logger().logTrace("retrying");
-			return this->ReadAt(position, nbytes, bytesRead, buffer);
-		} else {
-			*bytesRead = 0;
-			Logging::Logger().logError(
-				results.GetError().GetExceptionName() + " : " + results.GetError().GetMessage() + "  SHOULD NOT RETRY");
-		}
-
-		return arrow::Status::IOError(results.GetError().GetExceptionName() + " : " + results.GetError().GetMessage());
-	} else {
-		*bytesRead = results.GetResult().GetContentLength();
-		*bytesRead = nbytes < *bytesRead ? nbytes : *bytesRead;
-		this->position = position + *bytesRead;
-		results.GetResult().GetBody().read((char *) buffer, *bytesRead);
+	std::shared_ptr<RangeReader> reader;
+	arrow::Status status = this->getReader(&reader);
+	if(!status.ok()) {
+		*bytesRead = 0;
+		return status;
+	}
 
-		return arrow::Status::OK();
+	status = reader->ReadAt(position, nbytes, bytesRead, static_cast<uint8_t *>(buffer));
+	if(!status.ok()) {
+		Logging::Logger().logError("S3ReadableFile::ReadAt failed for bucketName: " + bucketName + " key " + key +
+								   " : " + status.ToString());
+		return status;
 	}
+	return arrow::Status::OK();
 }
 
 arrow::Status S3ReadableFile::ReadAt(int64_t position, int64_t nbytes, std::shared_ptr<arrow::Buffer> * out) {
-	//	std::cout<<"S3ReadableFile::ReadAt " + std::to_string(nbytes)<<std::endl;
-
-	Aws::S3::Model::GetObjectRequest object_request;
-
-	object_request.SetBucket(bucketName);
-	object_request.SetKey(key);
-	object_request.SetRange("bytes=" + std::to_string(position) + "-" + std::to_string(position + nbytes));
-
-	auto results = this->s3Client->GetObject(object_request);
-
-	if(!results.IsSuccess()) {
-		// TODO: Make bad arrow status here
-
-		Logging::Logger().logWarn(
-			"S3ReadableFile::ReadAt, GetObject failed for bucketName: " + bucketName + " key " + key);
-		bool shouldRetry = results.GetError().ShouldRetry();
-		if(shouldRetry) {
-			Logging::Logger().logTrace("retrying");
-			return this->ReadAt(position, nbytes, out);
-		} else {
-			Logging::Logger().logError(
-				results.GetError().GetExceptionName() + " : " + results.GetError().GetMessage() + "  SHOULD NOT RETRY");
-		}
-
-		return arrow::Status::IOError(results.GetError().GetExceptionName() + " : " + results.GetError().GetMessage());
-	} else {
-		// old implementation
-		/*
-		//byutes read should always be full amount
-		//should almost always be nBytes
-		std::shared_ptr<arrow::ResizableBuffer> buffer;
-		AllocateResizableBuffer(arrow::default_memory_pool(), nbytes, &buffer);
-
-		int64_t bytesRead = nbytes;
-
-		memcpy(buffer->mutable_data(), results.GetResult().GetBody().rdbuf(), bytesRead);
+	std::shared_ptr<arrow::ResizableBuffer> buffer;
+	arrow::Status status = AllocateResizableBuffer(arrow::default_memory_pool(), nbytes, &buffer);
+	if(!status.ok()) {
+		return status;
+	}
 
-		*out = buffer;
-		return arrow::Status::OK();
-		*/
+	int64_t bytesRead = 0;
+	status = this->ReadAt(position, nbytes, &bytesRead, buffer->mutable_data());
+	if(!status.ok()) {
+		return status;
+	}
 
-		int64_t bytesRead = results.GetResult().GetContentLength();
-		bytesRead = nbytes < bytesRead ? nbytes : bytesRead;
-		this->position = position + nbytes;
-		if(bytesRead < nbytes) {
-			Logging::Logger().logError(
-				"Did not read all the bytes at S3ReadableFile::ReadAt(int64_t position, int64_t nbytes, "
-				"std::shared_ptr<arrow::Buffer>* out)");
+	if(bytesRead < nbytes) {
+		status = buffer->Resize(bytesRead);
+		if(!status.ok()) {
+			return status;
 		}
-		//		results.GetResult().GetBody().read((char*)(out->get()->mutable_data()), bytesRead);
-
-		std::shared_ptr<arrow::ResizableBuffer> buffer;
-		AllocateResizableBuffer(arrow::default_memory_pool(), nbytes, &buffer);
-
-		results.GetResult().GetBody().read((char *) (buffer->mutable_data()), bytesRead);
-		*out = buffer;
-
-		return arrow::Status::OK();
 	}
+	*out = buffer;
+	return arrow::Status::OK();
 }
 
 bool S3ReadableFile::supports_zero_copy() const { return false; }
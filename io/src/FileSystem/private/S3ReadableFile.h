@@ -7,14 +7,20 @@
 #ifndef SRC_UTIL_BLAZINGS3_S3READABLEFILE_H_
 #define SRC_UTIL_BLAZINGS3_S3READABLEFILE_H_
 
+#include "FileSystem/private/RangeReader.h"
 #include "arrow/io/interfaces.h"
 #include "arrow/status.h"
 #include <aws/core/utils/memory/stl/AWSString.h>
 #include <aws/s3/S3Client.h>
+#include <mutex>
 
 class S3ReadableFile : public arrow::io::RandomAccessFile {
 public:
-	S3ReadableFile(std::shared_ptr<Aws::S3::S3Client> s3Client, std::string bucket, std::string key);
+	S3ReadableFile(std::shared_ptr<Aws::S3::S3Client> s3Client,
+		std::string bucket,
+		std::string key,
+		RangeReaderOptions readerOptions = RangeReaderOptions(),
+		std::shared_ptr<ThreadPool> ioPool = RangeReader::getDefaultIoPool());
 	~S3ReadableFile();
 
 	arrow::Status Close() override;
@@ -38,13 +44,25 @@ public:
 
 	bool closed() const override;
 
+	// GetObject requests issued so far
+	int64_t getNumRequests();
+
 private:
+	// Reads go through a RangeReader created on the first read, once the size of the object is known
+	arrow::Status getReader(std::shared_ptr<RangeReader> * reader);
+
 	std::shared_ptr<Aws::S3::S3Client> s3Client;
 	std::string bucketName;
 	std::string key;
 	size_t position;
 	bool valid;
 
+	RangeReaderOptions readerOptions;
+	std::shared_ptr<ThreadPool> ioPool;
+	std::mutex readerMutex;
+	int64_t size;
+	std::shared_ptr<RangeReader> reader;
+
 	ARROW_DISALLOW_COPY_AND_ASSIGN(S3ReadableFile);
 };
 
@@ -0,0 +1,240 @@
+#include "Library/Logging/AsyncOutput.h"
+#include <algorithm>
+#include <ctime>
+
+namespace Library {
+namespace Logging {
+namespace {
+std::atomic<uint64_t> nextOutputId{1};
+
+void appendLine(
+	std::string & lines, const std::string & datetime, int nodeInd, LoggingLevel level, const std::string & log) {
+	lines += datetime;
+	lines += '|';
+	lines += std::to_string(nodeInd);
+	lines += '|';
+	lines += getLevelName(level);
+	lines += '|';
+	lines += log;
+}
+}  // namespace
+
+// Messages of one thread, pushed by that thread and popped by whoever drains the output
+class AsyncOutput::Ring {
+public:
+	explicit Ring(std::size_t capacity) : messages(capacity) {}
+
+	// returns how many messages the ring holds after the push, 0 when it is full
+	std::size_t tryPush(Message && message) {
+		std::size_t tail = this->tail.load(std::memory_order_relaxed);
+		std::size_t head = this->head.load(std::memory_order_acquire);
+		if(tail - head == this->messages.size()) {
+			return 0;
+		}
+		this->messages[tail % this->messages.size()] = std::move(message);
+		this->tail.store(tail + 1, std::memory_order_release);
+		return tail + 1 - head;
+	}
+
+	void popAll(std::vector<Message> & into) {
+		std::size_t head = this->head.load(std::memory_order_relaxed);
+		std::size_t tail = this->tail.load(std::memory_order_acquire);
+		for(; head != tail; head++) {
+			into.push_back(std::move(this->messages[head % this->messages.size()]));
+		}
+		this->head.store(tail, std::memory_order_release);
+	}
+
+	std::size_t capacity() const { return this->messages.size(); }
+
+	std::atomic<bool> abandoned{false};	 // its thread exited
+	std::atomic<bool> closed{false};	 // its output was destroyed
+
+private:
+	std::vector<Message> messages;
+	std::atomic<std::size_t> head{0};
+	char padding[64];  // the thread and the writer do not share a cache line
+	std::atomic<std::size_t> tail{0};
+};
+
+AsyncOutput::AsyncOutput(GenericOutput * output, std::chrono::milliseconds flushInterval, std::size_t ringCapacity)
+	: id(nextOutputId++), output(output), flushInterval(flushInterval),
+	  ringCapacity(std::max<std::size_t>(ringCapacity, 2)) {
+	writer = std::thread(&AsyncOutput::run, this);
+}
+
+AsyncOutput::~AsyncOutput() {
+	{
+		std::lock_guard<std::mutex> lock(wakeMutex);
+		stopping = true;
+	}
+	wake.notify_one();
+	writer.join();
+	drain();
+
+	std::lock_guard<std::mutex> lock(ringsMutex);
+	for(auto & ring : rings) {
+		ring->closed = true;
+	}
+}
+
+void AsyncOutput::flush(std::string && log) {
+	enqueue(Message{std::chrono::system_clock::now(), 0, LoggingLevel::INFO, true, std::move(log)});
+}
+
+void AsyncOutput::flush(const std::string & log) {
+	enqueue(Message{std::chrono::system_clock::now(), 0, LoggingLevel::INFO, true, log});
+}
+
+void AsyncOutput::flush(
+	const int nodeInd, const std::string & datetime, const std::string & level, const std::string & log) {
+	enqueue(Message{std::chrono::system_clock::now(),
+		nodeInd,
+		LoggingLevel::INFO,
+		true,
+		datetime + "|" + std::to_string(nodeInd) + "|" + level + "|" + log});
+}
+
+void AsyncOutput::flush(
+	const int nodeInd, std::chrono::system_clock::time_point time, LoggingLevel level, std::string && log) {
+	enqueue(Message{time, nodeInd, level, false, std::move(log)});
+	if(level == LoggingLevel::FATAL) {
+		sync();
+	} else if(level == LoggingLevel::ERROR) {
+		wakeWriter();
+	}
+}
+
+void AsyncOutput::sync() { drain(); }
+
+std::vector<std::pair<uint64_t, std::shared_ptr<AsyncOutput::Ring>>> & AsyncOutput::getThreadRings() {
+	struct ThreadRings {
+		std::vector<std::pair<uint64_t, std::shared_ptr<Ring>>> rings;
+
+		~ThreadRings() {
+			for(auto & ring : rings) {
+				ring.second->abandoned = true;
+			}
+		}
+	};
+	thread_local ThreadRings threadRings;
+	return threadRings.rings;
+}
+
+AsyncOutput::Ring & AsyncOutput::getRing() {
+	auto & threadRings = getThreadRings();
+	for(auto & ring : threadRings) {
+		if(ring.first == id) {
+			return *ring.second;
+		}
+	}
+
+	// forget the rings of outputs destroyed since
+	threadRings.erase(
+		std::remove_if(threadRings.begin(),
+			threadRings.end(),
+			[](const std::pair<uint64_t, std::shared_ptr<Ring>> & ring) { return ring.second->closed.load(); }),
+		threadRings.end());
+	auto ring = std::make_shared<Ring>(ringCapacity);
+	{
+		std::lock_guard<std::mutex> lock(ringsMutex);
+		rings.push_back(ring);
+	}
+	threadRings.emplace_back(id, ring);
+	return *ring;
+}
+
+void AsyncOutput::enqueue(Message && message) {
+	Ring & ring = getRing();
+	std::size_t size;
+	while((size = ring.tryPush(std::move(message))) == 0) {
+		// a failed push leaves the message as it was
+		wakeWriter();
+		std::this_thread::yield();
+	}
+	if(size == ring.capacity() / 2) {
+		wakeWriter();
+	}
+}
+
+void AsyncOutput::wakeWriter() {
+	{
+		std::lock_guard<std::mutex> lock(wakeMutex);
+		wakeRequested = true;
+	}
+	wake.notify_one();
+}
+
+void AsyncOutput::run() {
+	std::unique_lock<std::mutex> lock(wakeMutex);
+	while(!stopping) {
+		wake.wait_for(lock, flushInterval, [this] { return wakeRequested || stopping; });
+		wakeRequested = false;
+		lock.unlock();
+		drain();
+		lock.lock();
+	}
+}
+
+void AsyncOutput::drain() {
+	std::lock_guard<std::mutex> drainLock(drainMutex);
+
+	std::vector<std::shared_ptr<Ring>> currentRings;
+	{
+		std::lock_guard<std::mutex> lock(ringsMutex);
+		currentRings = rings;
+	}
+	std::vector<std::shared_ptr<Ring>> emptied;
+	for(auto & ring : currentRings) {
+		// nothing is pushed to a ring once it is abandoned, popping after checking empties it for good
+		bool abandoned = ring->abandoned;
+		ring->popAll(batch);
+		if(abandoned) {
+			emptied.push_back(ring);
+		}
+	}
+	if(!emptied.empty()) {
+		std::lock_guard<std::mutex> lock(ringsMutex);
+		rings.erase(std::remove_if(rings.begin(),
+						rings.end(),
+						[&emptied](const std::shared_ptr<Ring> & ring) {
+							return std::find(emptied.begin(), emptied.end(), ring) != emptied.end();
+						}),
+			rings.end());
+	}
+	if(batch.empty()) {
+		return;
+	}
+
+	// each ring is in order already
+	std::stable_sort(batch.begin(), batch.end(), [](const Message & left, const Message & right) {
+		return left.time < right.time;
+	});
+
+	std::string lines;
+	std::time_t datetimeSeconds = -1;
+	std::string datetime;
+	for(const Message & message : batch) {
+		if(&message != &batch.front()) {
+			lines += '\n';
+		}
+		if(message.formatted) {
+			lines += message.log;
+			continue;
+		}
+		std::time_t seconds = std::chrono::system_clock::to_time_t(message.time);
+		if(seconds != datetimeSeconds) {
+			datetimeSeconds = seconds;
+			datetime = formatDatetime(message.time);
+		}
+		appendLine(lines, datetime, message.nodeInd, message.level, message.log);
+	}
+	std::size_t written = batch.size();
+	batch.clear();
+
+	output->flush(std::move(lines));
+	messagesWritten += written;
+	batchesWritten++;
+}
+}  // namespace Logging
+}  // namespace Library
@@ -0,0 +1,106 @@
+#ifndef SRC_LIBRARY_LOGGING_ASYNCOUTPUT_H_
+#define SRC_LIBRARY_LOGGING_ASYNCOUTPUT_H_
+
+#include "Library/Logging/GenericOutput.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace Library {
+namespace Logging {
+// Writes to another output from a background thread. A logging thread only queues its message, in a lock free ring of
+// its own, and the writer formats what every thread queued and writes it to the output in one batch, ordered by time,
+// at most a flush interval after it was logged. Errors wake the writer right away and fatal messages are written
+// before logging them returns.
+class AsyncOutput : public GenericOutput {
+public:
+	// takes ownership of the output, a thread waits for the writer while its ring holds ringCapacity messages
+	AsyncOutput(GenericOutput * output,
+		std::chrono::milliseconds flushInterval = std::chrono::milliseconds(100),
+		std::size_t ringCapacity = 1024);
+
+	// writes what is still queued
+	~AsyncOutput();
+
+public:
+	AsyncOutput(AsyncOutput &&) = delete;
+
+	AsyncOutput(const AsyncOutput &) = delete;
+
+	AsyncOutput & operator=(AsyncOutput &&) = delete;
+
+	AsyncOutput & operator=(const AsyncOutput &) = delete;
+
+public:
+	void flush(std::string && log) override;
+
+	void flush(const std::string & log) override;
+
+	void flush(
+		const int nodeInd, const std::string & datetime, const std::string & level, const std::string & log) override;
+
+	void flush(
+		const int nodeInd, std::chrono::system_clock::time_point time, LoggingLevel level, std::string && log) override;
+
+	// writes everything logged before the call, on the calling thread
+	void sync();
+
+	uint64_t getMessagesWritten() const { return messagesWritten; }
+
+	uint64_t getBatchesWritten() const { return batchesWritten; }
+
+private:
+	struct Message {
+		std::chrono::system_clock::time_point time;
+		int nodeInd;
+		LoggingLevel level;
+		bool formatted;	 // written as it is
+		std::string log;
+	};
+
+	class Ring;
+
+	// the rings of this thread, by the id of their output
+	static std::vector<std::pair<uint64_t, std::shared_ptr<Ring>>> & getThreadRings();
+
+	Ring & getRing();
+
+	void enqueue(Message && message);
+
+	void wakeWriter();
+
+	void run();
+
+	// writes what the rings hold as one batch
+	void drain();
+
+	const uint64_t id;
+	std::unique_ptr<GenericOutput> output;
+	const std::chrono::milliseconds flushInterval;
+	const std::size_t ringCapacity;
+
+	std::mutex ringsMutex;
+	std::vector<std::shared_ptr<Ring>> rings;
+
+	std::mutex drainMutex;
+	std::vector<Message> batch;	 // reused by every drain
+
+	std::mutex wakeMutex;
+	std::condition_variable wake;
+	bool wakeRequested = false;
+	bool stopping = false;
+
+	std::atomic<uint64_t> messagesWritten{0};
+	std::atomic<uint64_t> batchesWritten{0};
+	std::thread writer;
+};
+}  // namespace Logging
+}  // namespace Library
+
+#endif
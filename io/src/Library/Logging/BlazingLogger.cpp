@@ -1,11 +1,26 @@
 #include "Library/Logging/BlazingLogger.h"
 #include "Library/Logging/ServiceLogging.h"
-#include <chrono>
-#include <iomanip>
-#include <sstream>
+#include <utility>
 
 namespace Library {
 namespace Logging {
+std::atomic<unsigned int> BlazingLogger::enabledLevels{~0u};
+
+void BlazingLogger::setMinimumLevel(LoggingLevel minimum) {
+	unsigned int levels = 0;
+	for(LoggingLevel level : {LoggingLevel::INFO,
+			LoggingLevel::WARN,
+			LoggingLevel::TRACE,
+			LoggingLevel::DEBUG,
+			LoggingLevel::ERROR,
+			LoggingLevel::FATAL}) {
+		if(getLevelSeverity(level) >= getLevelSeverity(minimum)) {
+			levels |= 1u << static_cast<unsigned int>(level);
+		}
+	}
+	enabledLevels.store(levels, std::memory_order_relaxed);
+}
+
 BlazingLogger::BlazingLogger() {}
 
 BlazingLogger::~BlazingLogger() {}
@@ -16,37 +31,43 @@ void BlazingLogger::log(std::string && logdata) { sendDataToService(logdata); }
 
 void BlazingLogger::log(const std::string & logdata) { sendDataToService(logdata); }
 
-void BlazingLogger::logInfo(std::string && logdata) { buildLogData(LoggingLevel::INFO, logdata); }
+void BlazingLogger::logInfo(std::string && logdata) { buildLogData(LoggingLevel::INFO, std::move(logdata)); }
 
 void BlazingLogger::logInfo(const std::string & logdata) { buildLogData(LoggingLevel::INFO, logdata); }
 
-void BlazingLogger::logWarn(std::string && logdata) { buildLogData(LoggingLevel::WARN, logdata); }
+void BlazingLogger::logWarn(std::string && logdata) { buildLogData(LoggingLevel::WARN, std::move(logdata)); }
 
 void BlazingLogger::logWarn(const std::string & logdata) { buildLogData(LoggingLevel::WARN, logdata); }
 
-void BlazingLogger::logTrace(std::string && logdata) { buildLogData(LoggingLevel::TRACE, logdata); }
+void BlazingLogger::logTrace(std::string && logdata) { buildLogData(LoggingLevel::TRACE, std::move(logdata)); }
 
 void BlazingLogger::logTrace(const std::string & logdata) { buildLogData(LoggingLevel::TRACE, logdata); }
 
-void BlazingLogger::logDebug(std::string && logdata) { buildLogData(LoggingLevel::DEBUG, logdata); }
+void BlazingLogger::logDebug(std::string && logdata) { buildLogData(LoggingLevel::DEBUG, std::move(logdata)); }
 
 void BlazingLogger::logDebug(const std::string & logdata) { buildLogData(LoggingLevel::DEBUG, logdata); }
 
-void BlazingLogger::logError(std::string && logdata) { buildLogData(LoggingLevel::ERROR, logdata); }
+void BlazingLogger::logError(std::string && logdata) { buildLogData(LoggingLevel::ERROR, std::move(logdata)); }
 
 void BlazingLogger::logError(const std::string & logdata) { buildLogData(LoggingLevel::ERROR, logdata); }
 
-void BlazingLogger::logFatal(std::string && logdata) { buildLogData(LoggingLevel::FATAL, logdata); }
+void BlazingLogger::logFatal(std::string && logdata) { buildLogData(LoggingLevel::FATAL, std::move(logdata)); }
 
 void BlazingLogger::logFatal(const std::string & logdata) { buildLogData(LoggingLevel::FATAL, logdata); }
 
 void BlazingLogger::buildLogData(LoggingLevel level, const std::string & logdata) {
-	auto now = std::chrono::system_clock::now();
-	auto time = std::chrono::system_clock::to_time_t(now);
+	if(!isEnabled(level)) {
+		return;
+	}
+	ServiceLogging::getInstance().setLogData(level, std::string(logdata));
+}
 
-	std::ostringstream ss;
-	ss << std::put_time(std::localtime(&time), "%FT%TZ");
-	ServiceLogging::getInstance().setLogData(ss.str(), getLevelName(level), logdata);
+void BlazingLogger::buildLogData(LoggingLevel level, std::string && logdata) {
+	if(!isEnabled(level)) {
+		return;
+	}
+	// the output formats the time, an asynchronous one does it off the logging thread
+	ServiceLogging::getInstance().setLogData(level, std::move(logdata));
 }
 
 void BlazingLogger::sendDataToService(const std::string & logdata) {
@@ -2,6 +2,7 @@
 #define SRC_LIBRARY_LOGGING_BLAZINGLOGGER_H_
 
 #include "Library/Logging/LoggingLevel.h"
+#include <atomic>
 #include <string>
 
 namespace Library {
@@ -29,6 +30,15 @@ private:
 
 	void * operator new[](size_t, void *) = delete;
 
+public:
+	// Whether messages of that level are logged, cheap enough to check before building a message
+	static bool isEnabled(LoggingLevel level) {
+		return (enabledLevels.load(std::memory_order_relaxed) & (1u << static_cast<unsigned int>(level))) != 0;
+	}
+
+	// logs the messages of that level and the more severe ones only, every level is logged by default
+	static void setMinimumLevel(LoggingLevel level);
+
 public:
 	void log(std::string && logdata);
 
@@ -61,7 +71,11 @@ public:
 private:
 	void buildLogData(LoggingLevel level, const std::string & logdata);
 
+	void buildLogData(LoggingLevel level, std::string && logdata);
+
 	void sendDataToService(const std::string & logdata);
+
+	static std::atomic<unsigned int> enabledLevels;
 };
 }  // namespace Logging
 }  // namespace Library
@@ -0,0 +1,16 @@
+#include "Library/Logging/GenericOutput.h"
+#include <ctime>
+
+namespace Library {
+namespace Logging {
+std::string GenericOutput::formatDatetime(std::chrono::system_clock::time_point time) {
+	std::time_t seconds = std::chrono::system_clock::to_time_t(time);
+	std::tm local;
+	localtime_r(&seconds, &local);
+
+	char datetime[32];
+	std::size_t length = std::strftime(datetime, sizeof(datetime), "%FT%TZ", &local);
+	return std::string(datetime, length);
+}
+}  // namespace Logging
+}  // namespace Library
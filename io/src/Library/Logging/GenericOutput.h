@@ -1,6 +1,8 @@
 #ifndef SRC_LIBRARY_LOGGING_GENERICOUTPUT_H_
 #define SRC_LIBRARY_LOGGING_GENERICOUTPUT_H_
 
+#include "Library/Logging/LoggingLevel.h"
+#include <chrono>
 #include <string>
 
 namespace Library {
@@ -16,6 +18,16 @@ public:
 	virtual void flush(
 		const int nodeInd, const std::string & datetime, const std::string & level, const std::string & log) = 0;
 
+	// A message logged at that time, formatted by the output. Formats the time and writes it with the flush above by
+	// default.
+	virtual void flush(
+		const int nodeInd, std::chrono::system_clock::time_point time, LoggingLevel level, std::string && log) {
+		flush(nodeInd, formatDatetime(time), getLevelName(level), log);
+	}
+
+	// the local time in seconds, as every output writes it
+	static std::string formatDatetime(std::chrono::system_clock::time_point time);
+
 	// virtual void setNodeIdentifier(const unsigned int nodeInd) = 0;
 };
 }  // namespace Logging
@@ -13,5 +13,32 @@ const char * getLevelName(LoggingLevel level) {
 	}
 	return "";
 }
+
+int getLevelSeverity(LoggingLevel level) {
+	switch(level) {
+	case LoggingLevel::TRACE: return 0;
+	case LoggingLevel::DEBUG: return 1;
+	case LoggingLevel::INFO: return 2;
+	case LoggingLevel::WARN: return 3;
+	case LoggingLevel::ERROR: return 4;
+	case LoggingLevel::FATAL: return 5;
+	}
+	return 0;
+}
+
+bool getLevelByName(const std::string & name, LoggingLevel & level) {
+	for(LoggingLevel candidate : {LoggingLevel::INFO,
+			LoggingLevel::WARN,
+			LoggingLevel::TRACE,
+			LoggingLevel::DEBUG,
+			LoggingLevel::ERROR,
+			LoggingLevel::FATAL}) {
+		if(name == getLevelName(candidate)) {
+			level = candidate;
+			return true;
+		}
+	}
+	return false;
+}
 }  // namespace Logging
 }  // namespace Library
@@ -1,11 +1,19 @@
 #ifndef SRC_LIBRARY_LOGGING_LOGGINGLEVEL_H_
 #define SRC_LIBRARY_LOGGING_LOGGINGLEVEL_H_
 
+#include <string>
+
 namespace Library {
 namespace Logging {
 enum class LoggingLevel { INFO, WARN, TRACE, DEBUG, ERROR, FATAL };
 
 const char * getLevelName(LoggingLevel level);
+
+// TRACE < DEBUG < INFO < WARN < ERROR < FATAL, the enum values are not in that order
+int getLevelSeverity(LoggingLevel level);
+
+// the level with that name, as returned by getLevelName. Returns false when there is none.
+bool getLevelByName(const std::string & name, LoggingLevel & level);
 }  // namespace Logging
 }  // namespace Library
 
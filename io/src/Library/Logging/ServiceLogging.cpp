@@ -1,7 +1,9 @@
 #include "Library/Logging/ServiceLogging.h"
 #include "CoutOutput.h"
 #include "Library/Logging/GenericOutput.h"
+#include <chrono>
 #include <stdlib.h>
+#include <utility>
 
 namespace Library {
 namespace Logging {
@@ -28,6 +30,10 @@ void ServiceLogging::setLogData(const std::string & datetime, const std::string
 	output->flush(this->nodeInd, datetime, level, message);
 }
 
+void ServiceLogging::setLogData(LoggingLevel level, std::string && message) {
+	output->flush(this->nodeInd, std::chrono::system_clock::now(), level, std::move(message));
+}
+
 void ServiceLogging::setLogOutput(GenericOutput * value) {
 	if(output) {
 		delete output;
@@ -1,6 +1,7 @@
 #ifndef SRC_LIBRARY_LOGGING_SERVICELOGGING_H_
 #define SRC_LIBRARY_LOGGING_SERVICELOGGING_H_
 
+#include "Library/Logging/LoggingLevel.h"
 #include <string>
 
 namespace Library {
@@ -35,6 +36,9 @@ public:
 
 	void setLogData(const std::string & datetime, const std::string & level, const std::string & message);
 
+	// a message logged now, formatted by the output
+	void setLogData(LoggingLevel level, std::string && message);
+
 	void setLogOutput(GenericOutput * output);
 
 	void setNodeIdentifier(const int nodeInd);
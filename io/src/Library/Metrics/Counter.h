@@ -0,0 +1,22 @@
+#ifndef SRC_LIBRARY_METRICS_COUNTER_H_
+#define SRC_LIBRARY_METRICS_COUNTER_H_
+
+#include <atomic>
+#include <cstdint>
+
+namespace Library {
+namespace Metrics {
+// A total that only goes up, like requests served or bytes sent
+class Counter {
+public:
+	void increment(uint64_t amount = 1) { value.fetch_add(amount, std::memory_order_relaxed); }
+
+	uint64_t get() const { return value.load(std::memory_order_relaxed); }
+
+private:
+	std::atomic<uint64_t> value{0};
+};
+}  // namespace Metrics
+}  // namespace Library
+
+#endif
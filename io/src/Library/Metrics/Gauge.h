@@ -0,0 +1,24 @@
+#ifndef SRC_LIBRARY_METRICS_GAUGE_H_
+#define SRC_LIBRARY_METRICS_GAUGE_H_
+
+#include <atomic>
+#include <cstdint>
+
+namespace Library {
+namespace Metrics {
+// A value that goes up and down, like the results held or the bytes they take
+class Gauge {
+public:
+	void set(int64_t amount) { value.store(amount, std::memory_order_relaxed); }
+
+	void add(int64_t amount) { value.fetch_add(amount, std::memory_order_relaxed); }
+
+	int64_t get() const { return value.load(std::memory_order_relaxed); }
+
+private:
+	std::atomic<int64_t> value{0};
+};
+}  // namespace Metrics
+}  // namespace Library
+
+#endif
@@ -0,0 +1,64 @@
+#include "Library/Metrics/Histogram.h"
+#include <algorithm>
+
+namespace Library {
+namespace Metrics {
+Histogram::Histogram(double unit) : unit(unit) {
+	for(auto & count : counts) {
+		count.store(0, std::memory_order_relaxed);
+	}
+}
+
+int Histogram::getBucket(uint64_t value) {
+	if(value < 2 * NUM_SUB_BUCKETS) {
+		return static_cast<int>(value);
+	}
+	const int exponent = 63 - __builtin_clzll(value);
+	const int subBucket = static_cast<int>(value >> (exponent - SUB_BUCKET_BITS)) & (NUM_SUB_BUCKETS - 1);
+	return (exponent - SUB_BUCKET_BITS + 1) * NUM_SUB_BUCKETS + subBucket;
+}
+
+uint64_t Histogram::getBucketStart(int bucket) {
+	if(bucket < 2 * NUM_SUB_BUCKETS) {
+		return static_cast<uint64_t>(bucket);
+	}
+	const int exponent = bucket / NUM_SUB_BUCKETS + SUB_BUCKET_BITS - 1;
+	const uint64_t subBucket = bucket % NUM_SUB_BUCKETS;
+	return (NUM_SUB_BUCKETS + subBucket) << (exponent - SUB_BUCKET_BITS);
+}
+
+uint64_t Histogram::getCount() const {
+	uint64_t count = 0;
+	for(const auto & bucketCount : counts) {
+		count += bucketCount.load(std::memory_order_relaxed);
+	}
+	return count;
+}
+
+uint64_t Histogram::getCountBelow(uint64_t limit) const {
+	uint64_t count = 0;
+	for(int bucket = 0; bucket < NUM_BUCKETS && getBucketStart(bucket) < limit; bucket++) {
+		count += counts[bucket].load(std::memory_order_relaxed);
+	}
+	return count;
+}
+
+uint64_t Histogram::getValueAtQuantile(double quantile) const {
+	const uint64_t count = getCount();
+	if(count == 0) {
+		return 0;
+	}
+	const uint64_t rank = std::max<uint64_t>(static_cast<uint64_t>(quantile * count + 0.5), 1);
+	uint64_t seen = 0;
+	for(int bucket = 0; bucket < NUM_BUCKETS; bucket++) {
+		seen += counts[bucket].load(std::memory_order_relaxed);
+		if(seen >= rank) {
+			const uint64_t start = getBucketStart(bucket);
+			const uint64_t end = bucket + 1 < NUM_BUCKETS ? getBucketStart(bucket + 1) : UINT64_MAX;
+			return start + (end - start) / 2;
+		}
+	}
+	return getBucketStart(NUM_BUCKETS - 1);
+}
+}  // namespace Metrics
+}  // namespace Library
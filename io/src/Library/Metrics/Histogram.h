@@ -0,0 +1,71 @@
+#ifndef SRC_LIBRARY_METRICS_HISTOGRAM_H_
+#define SRC_LIBRARY_METRICS_HISTOGRAM_H_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace Library {
+namespace Metrics {
+// Counts of recorded values in log-linear buckets, like an HDR histogram with 3 significant bits: every power of two is
+// split in 8 buckets, so a value is known within 12.5% from 0 to 2^64. Recording is two relaxed atomic additions.
+class Histogram {
+public:
+	static const int SUB_BUCKET_BITS = 3;
+	static const int NUM_SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+	static const int NUM_BUCKETS = (64 - SUB_BUCKET_BITS + 1) * NUM_SUB_BUCKETS;
+
+	// unit is what a recorded value is worth in the base unit it is exported in, 1e-6 for microseconds as seconds
+	explicit Histogram(double unit = 1.0);
+
+	void record(uint64_t value) {
+		counts[getBucket(value)].fetch_add(1, std::memory_order_relaxed);
+		sum.fetch_add(value, std::memory_order_relaxed);
+	}
+
+	double getUnit() const { return unit; }
+
+	uint64_t getCount() const;
+
+	uint64_t getSum() const { return sum.load(std::memory_order_relaxed); }
+
+	// values recorded below limit, exact when limit is a power of two or below 2 * NUM_SUB_BUCKETS
+	uint64_t getCountBelow(uint64_t limit) const;
+
+	// the middle of the bucket holding the value at that quantile, 0 when nothing was recorded
+	uint64_t getValueAtQuantile(double quantile) const;
+
+	static int getBucket(uint64_t value);
+
+	// the least value that goes to the bucket
+	static uint64_t getBucketStart(int bucket);
+
+private:
+	const double unit;
+	std::array<std::atomic<uint64_t>, NUM_BUCKETS> counts;
+	std::atomic<uint64_t> sum{0};
+};
+
+// Records the microseconds from its creation to its destruction in a histogram of seconds
+class ScopedLatency {
+public:
+	explicit ScopedLatency(Histogram & histogram) : histogram(histogram), start(std::chrono::steady_clock::now()) {}
+
+	~ScopedLatency() {
+		histogram.record(
+			std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+	}
+
+	ScopedLatency(const ScopedLatency &) = delete;
+
+	ScopedLatency & operator=(const ScopedLatency &) = delete;
+
+private:
+	Histogram & histogram;
+	const std::chrono::steady_clock::time_point start;
+};
+}  // namespace Metrics
+}  // namespace Library
+
+#endif
@@ -0,0 +1,154 @@
+#include "Library/Metrics/MetricsRegistry.h"
+#include <sstream>
+#include <stdexcept>
+
+namespace Library {
+namespace Metrics {
+namespace {
+std::string escape(const std::string & value, bool quotes) {
+	std::string escaped;
+	for(char c : value) {
+		if(c == '\\') {
+			escaped += "\\\\";
+		} else if(c == '\n') {
+			escaped += "\\n";
+		} else if(c == '"' && quotes) {
+			escaped += "\\\"";
+		} else {
+			escaped += c;
+		}
+	}
+	return escaped;
+}
+
+std::string formatLabels(const MetricsRegistry::Labels & labels) {
+	std::string formatted;
+	for(const auto & label : labels) {
+		if(!formatted.empty()) {
+			formatted += ',';
+		}
+		formatted += label.first + "=\"" + escape(label.second, true) + "\"";
+	}
+	return formatted;
+}
+
+// name{labels} or name when there are none
+void appendSample(std::ostringstream & text, const std::string & name, const std::string & labels) {
+	text << name;
+	if(!labels.empty()) {
+		text << '{' << labels << '}';
+	}
+	text << ' ';
+}
+
+std::string formatNumber(double value) {
+	std::ostringstream formatted;
+	formatted.precision(10);
+	formatted << value;
+	return formatted.str();
+}
+}  // namespace
+
+const char * MetricsRegistry::getTypeName(Type type) {
+	switch(type) {
+	case Type::COUNTER: return "counter";
+	case Type::GAUGE: return "gauge";
+	case Type::HISTOGRAM: return "histogram";
+	}
+	return "untyped";
+}
+
+MetricsRegistry::MetricsRegistry() {}
+
+MetricsRegistry::~MetricsRegistry() {}
+
+MetricsRegistry & MetricsRegistry::getInstance() {
+	static MetricsRegistry registry;
+	return registry;
+}
+
+MetricsRegistry::Family & MetricsRegistry::getFamily(const std::string & name, const std::string & help, Type type) {
+	auto found = families.find(name);
+	if(found == families.end()) {
+		Family & family = families[name];
+		family.type = type;
+		family.help = help;
+		return family;
+	}
+	if(found->second.type != type) {
+		throw std::invalid_argument("Metric " + name + " is a " + getTypeName(found->second.type));
+	}
+	return found->second;
+}
+
+Counter & MetricsRegistry::getCounter(const std::string & name, const std::string & help, const Labels & labels) {
+	std::lock_guard<std::mutex> lock(mutex);
+	std::unique_ptr<Counter> & counter = getFamily(name, help, Type::COUNTER).counters[formatLabels(labels)];
+	if(counter == nullptr) {
+		counter.reset(new Counter());
+	}
+	return *counter;
+}
+
+Gauge & MetricsRegistry::getGauge(const std::string & name, const std::string & help, const Labels & labels) {
+	std::lock_guard<std::mutex> lock(mutex);
+	std::unique_ptr<Gauge> & gauge = getFamily(name, help, Type::GAUGE).gauges[formatLabels(labels)];
+	if(gauge == nullptr) {
+		gauge.reset(new Gauge());
+	}
+	return *gauge;
+}
+
+Histogram & MetricsRegistry::getHistogram(
+	const std::string & name, const std::string & help, double unit, const Labels & labels) {
+	std::lock_guard<std::mutex> lock(mutex);
+	std::unique_ptr<Histogram> & histogram = getFamily(name, help, Type::HISTOGRAM).histograms[formatLabels(labels)];
+	if(histogram == nullptr) {
+		histogram.reset(new Histogram(unit));
+	}
+	return *histogram;
+}
+
+std::string MetricsRegistry::toPrometheusText() const {
+	std::ostringstream text;
+
+	std::lock_guard<std::mutex> lock(mutex);
+	for(const auto & entry : families) {
+		const std::string & name = entry.first;
+		const Family & family = entry.second;
+		text << "# HELP " << name << ' ' << escape(family.help, false) << '\n';
+		text << "# TYPE " << name << ' ' << getTypeName(family.type) << '\n';
+
+		for(const auto & counter : family.counters) {
+			appendSample(text, name, counter.first);
+			text << counter.second->get() << '\n';
+		}
+		for(const auto & gauge : family.gauges) {
+			appendSample(text, name, gauge.first);
+			text << gauge.second->get() << '\n';
+		}
+		for(const auto & labeledHistogram : family.histograms) {
+			const std::string & labels = labeledHistogram.first;
+			const Histogram & histogram = *labeledHistogram.second;
+			const std::string bucketLabels = labels.empty() ? "" : labels + ",";
+
+			// the buckets end at powers of two, where buckets of the histogram end too, and count the values below them
+			for(int bucket = 0; bucket < EXPORTED_BUCKETS; bucket++) {
+				const uint64_t limit = uint64_t(1) << bucket;
+				const std::string le = formatNumber(limit * histogram.getUnit());
+				appendSample(text, name + "_bucket", bucketLabels + "le=\"" + le + "\"");
+				text << histogram.getCountBelow(limit) << '\n';
+			}
+			const uint64_t count = histogram.getCount();
+			appendSample(text, name + "_bucket", bucketLabels + "le=\"+Inf\"");
+			text << count << '\n';
+			appendSample(text, name + "_sum", labels);
+			text << formatNumber(histogram.getSum() * histogram.getUnit()) << '\n';
+			appendSample(text, name + "_count", labels);
+			text << count << '\n';
+		}
+	}
+	return text.str();
+}
+}  // namespace Metrics
+}  // namespace Library
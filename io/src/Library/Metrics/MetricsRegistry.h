@@ -0,0 +1,76 @@
+#ifndef SRC_LIBRARY_METRICS_METRICSREGISTRY_H_
+#define SRC_LIBRARY_METRICS_METRICSREGISTRY_H_
+
+#include "Library/Metrics/Counter.h"
+#include "Library/Metrics/Gauge.h"
+#include "Library/Metrics/Histogram.h"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Library {
+namespace Metrics {
+// The metrics of the process by name and labels, exported in the Prometheus text format
+class MetricsRegistry {
+public:
+	using Labels = std::vector<std::pair<std::string, std::string>>;
+
+	// histograms are exported with buckets up to 2^EXPORTED_BUCKETS - 1 units, 67s for microseconds
+	static const int EXPORTED_BUCKETS = 27;
+
+	MetricsRegistry();
+
+	~MetricsRegistry();
+
+	static MetricsRegistry & getInstance();
+
+public:
+	MetricsRegistry(MetricsRegistry &&) = delete;
+
+	MetricsRegistry(const MetricsRegistry &) = delete;
+
+	MetricsRegistry & operator=(MetricsRegistry &&) = delete;
+
+	MetricsRegistry & operator=(const MetricsRegistry &) = delete;
+
+public:
+	// The metric with that name and labels, created the first time it is asked for. It lives as long as the registry,
+	// callers keep the reference instead of looking it up on every update. Throws std::invalid_argument when the name
+	// belongs to a metric of another type.
+	Counter & getCounter(const std::string & name, const std::string & help, const Labels & labels = Labels());
+
+	Gauge & getGauge(const std::string & name, const std::string & help, const Labels & labels = Labels());
+
+	// unit is what a recorded value is worth in the exported base unit, see Histogram
+	Histogram & getHistogram(
+		const std::string & name, const std::string & help, double unit, const Labels & labels = Labels());
+
+	// every metric, ordered by name and labels
+	std::string toPrometheusText() const;
+
+private:
+	enum class Type { COUNTER, GAUGE, HISTOGRAM };
+
+	struct Family {
+		Type type;
+		std::string help;
+		// by their labels as exported, like scheme="s3"
+		std::map<std::string, std::unique_ptr<Counter>> counters;
+		std::map<std::string, std::unique_ptr<Gauge>> gauges;
+		std::map<std::string, std::unique_ptr<Histogram>> histograms;
+	};
+
+	static const char * getTypeName(Type type);
+
+	Family & getFamily(const std::string & name, const std::string & help, Type type);
+
+	mutable std::mutex mutex;
+	std::map<std::string, Family> families;
+};
+}  // namespace Metrics
+}  // namespace Library
+
+#endif
@@ -0,0 +1,127 @@
+#include "Library/Metrics/MetricsServer.h"
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <netinet/in.h>
+#include <poll.h>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+namespace Library {
+namespace Metrics {
+namespace {
+// how often the server thread checks whether it has to stop
+const int POLL_INTERVAL_MS = 100;
+
+const size_t MAX_REQUEST_SIZE = 8192;
+
+void writeAll(int connection, const std::string & data) {
+	size_t written = 0;
+	while(written < data.size()) {
+		ssize_t result = send(connection, data.data() + written, data.size() - written, MSG_NOSIGNAL);
+		if(result < 0 && errno == EINTR) {
+			continue;
+		}
+		if(result <= 0) {
+			return;  // the client went away
+		}
+		written += result;
+	}
+}
+
+std::string buildResponse(const std::string & status, const std::string & contentType, const std::string & body) {
+	return "HTTP/1.1 " + status + "\r\nContent-Type: " + contentType +
+		   "\r\nContent-Length: " + std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+}
+}  // namespace
+
+MetricsServer::MetricsServer(MetricsRegistry & registry, unsigned short port, const std::string & host)
+	: registry(registry), listener(-1), port(port) {
+	sockaddr_in address;
+	std::memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_port = htons(port);
+	if(inet_pton(AF_INET, host.c_str(), &address.sin_addr) != 1) {
+		throw std::runtime_error("Metrics server: invalid address " + host);
+	}
+
+	listener = socket(AF_INET, SOCK_STREAM, 0);
+	if(listener < 0) {
+		throw std::runtime_error(std::string("Metrics server: socket failed: ") + std::strerror(errno));
+	}
+	int reuse = 1;
+	setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+	if(bind(listener, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 || ::listen(listener, 16) != 0) {
+		std::string error = std::strerror(errno);
+		close(listener);
+		throw std::runtime_error(
+			"Metrics server: could not listen on " + host + ":" + std::to_string(port) + ": " + error);
+	}
+
+	socklen_t length = sizeof(address);
+	getsockname(listener, reinterpret_cast<sockaddr *>(&address), &length);
+	this->port = ntohs(address.sin_port);
+
+	thread = std::thread(&MetricsServer::run, this);
+}
+
+MetricsServer::~MetricsServer() {
+	stopping = true;
+	thread.join();
+	close(listener);
+}
+
+void MetricsServer::run() {
+	while(!stopping) {
+		pollfd descriptor{listener, POLLIN, 0};
+		if(poll(&descriptor, 1, POLL_INTERVAL_MS) <= 0 || (descriptor.revents & POLLIN) == 0) {
+			continue;
+		}
+		int connection = accept(listener, nullptr, nullptr);
+		if(connection < 0) {
+			continue;
+		}
+		serve(connection);
+		close(connection);
+	}
+}
+
+void MetricsServer::serve(int connection) {
+	// a client that sends nothing does not hold the server up
+	timeval timeout{1, 0};
+	setsockopt(connection, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+	std::string request;
+	char buffer[1024];
+	while(request.find("\r\n\r\n") == std::string::npos && request.size() < MAX_REQUEST_SIZE) {
+		ssize_t received = recv(connection, buffer, sizeof(buffer), 0);
+		if(received < 0 && errno == EINTR) {
+			continue;
+		}
+		if(received <= 0) {
+			break;
+		}
+		request.append(buffer, received);
+	}
+
+	// only the request line matters, GET /metrics with or without a query string
+	const std::string requestLine = request.substr(0, request.find("\r\n"));
+	const size_t pathStart = requestLine.find(' ');
+	const size_t pathEnd = requestLine.find(' ', pathStart + 1);
+	const std::string method = requestLine.substr(0, pathStart);
+	const std::string path = pathStart == std::string::npos
+								 ? ""
+								 : requestLine.substr(pathStart + 1, pathEnd - pathStart - 1);
+	if(method != "GET") {
+		writeAll(connection, buildResponse("405 Method Not Allowed", "text/plain", "Only GET is supported\n"));
+	} else if(path == "/metrics" || path.compare(0, 9, "/metrics?") == 0) {
+		writeAll(connection,
+			buildResponse("200 OK", "text/plain; version=0.0.4; charset=utf-8", registry.toPrometheusText()));
+	} else {
+		writeAll(connection, buildResponse("404 Not Found", "text/plain", "Metrics are served at /metrics\n"));
+	}
+}
+}  // namespace Metrics
+}  // namespace Library
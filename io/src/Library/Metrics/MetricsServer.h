@@ -0,0 +1,47 @@
+#ifndef SRC_LIBRARY_METRICS_METRICSSERVER_H_
+#define SRC_LIBRARY_METRICS_METRICSSERVER_H_
+
+#include "Library/Metrics/MetricsRegistry.h"
+#include <atomic>
+#include <string>
+#include <thread>
+
+namespace Library {
+namespace Metrics {
+// Serves the metrics of a registry at http://host:port/metrics in the Prometheus text format, for a Prometheus server
+// to scrape. Requests are answered one at a time on a thread of its own.
+class MetricsServer {
+public:
+	// Listens on the port of that local address, port 0 takes a free one. Throws std::runtime_error when it cannot.
+	MetricsServer(MetricsRegistry & registry, unsigned short port, const std::string & host = "127.0.0.1");
+
+	// stops listening
+	~MetricsServer();
+
+public:
+	MetricsServer(MetricsServer &&) = delete;
+
+	MetricsServer(const MetricsServer &) = delete;
+
+	MetricsServer & operator=(MetricsServer &&) = delete;
+
+	MetricsServer & operator=(const MetricsServer &) = delete;
+
+public:
+	unsigned short getPort() const { return port; }
+
+private:
+	void run();
+
+	void serve(int connection);
+
+	MetricsRegistry & registry;
+	int listener;
+	unsigned short port;
+	std::atomic<bool> stopping{false};
+	std::thread thread;
+};
+}  // namespace Metrics
+}  // namespace Library
+
+#endif
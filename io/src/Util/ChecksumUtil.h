@@ -0,0 +1,24 @@
+/*
+ * ChecksumUtil.h
+ *
+ * Checksums sent along with uploads so the object store can reject bytes that were corrupted on the way.
+ */
+
+#ifndef _BZ_CHECKSUMUTIL_H_
+#define _BZ_CHECKSUMUTIL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace ChecksumUtil {
+// The 16 bytes of the MD5 digest of data
+std::string md5(const uint8_t * data, size_t size);
+
+// Base64 with padding, the encoding of Content-MD5 headers and GCS md5Hash fields
+std::string toBase64(const std::string & bytes);
+
+std::string toHex(const std::string & bytes);
+}  // namespace ChecksumUtil
+
+#endif /* _BZ_CHECKSUMUTIL_H_ */
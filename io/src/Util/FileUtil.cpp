@@ -528,11 +528,17 @@ bool FileUtilv2::readCompletely(
 }
 
 bool FileUtilv2::writeCompletely(const Uri & uri, uint8_t * data, unsigned long long dataSize) {
+	// S3 and GCS streams upload in parts and retry a failed part by itself, rewriting the whole object on top of that
+	// would only upload again the parts that made it
+	const bool isMultipart = uri.getFileSystemType() == FileSystemType::S3 ||
+							 uri.getFileSystemType() == FileSystemType::GOOGLE_CLOUD_STORAGE;
+	const int maxWrites = isMultipart ? 1 : 10;
+
 	int count = 0;
 	int errorCount = 0;
 	arrow::Status status;
 	if(dataSize > 0) {
-		while(count < 10) {
+		while(count < maxWrites) {
 			try {
 				std::shared_ptr<arrow::io::OutputStream> outputStream =
 					BlazingContext::getInstance()->getFileSystemManager()->openWriteable(uri);
@@ -561,16 +567,19 @@ bool FileUtilv2::writeCompletely(const Uri & uri, uint8_t * data, unsigned long
 
 
 			} catch(std::exception & e) {
-				if(count > 8 || errorCount > 8) {
+				if(count + 1 >= maxWrites || errorCount > 8) {
 					throw e;
 				}
 				errorCount++;
 			}
 
+			count++;
+			if(count == maxWrites) {
+				break;
+			}
 			int fileRetryDelay = FILE_RETRY_DELAY;
-			const int sleep_milliseconds = (count + 1) * fileRetryDelay;
+			const int sleep_milliseconds = count * fileRetryDelay;
 			std::this_thread::sleep_for(std::chrono::milliseconds(sleep_milliseconds));
-			count++;
 		}
 	}
 
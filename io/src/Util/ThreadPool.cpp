@@ -0,0 +1,46 @@
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(size_t numThreads) : stopping(false) {
+	if(numThreads == 0) {
+		numThreads = 1;
+	}
+
+	this->workers.reserve(numThreads);
+	for(size_t i = 0; i < numThreads; i++) {
+		this->workers.emplace_back(&ThreadPool::work, this);
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->stopping = true;
+	}
+	this->condition.notify_all();
+
+	for(std::thread & worker : this->workers) {
+		worker.join();
+	}
+}
+
+size_t ThreadPool::pending() {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return this->tasks.size();
+}
+
+void ThreadPool::work() {
+	while(true) {
+		std::function<void()> task;
+		{
+			std::unique_lock<std::mutex> lock(this->mutex);
+			this->condition.wait(lock, [this]() { return this->stopping || !this->tasks.empty(); });
+			if(this->tasks.empty()) {
+				return;
+			}
+			task = std::move(this->tasks.front());
+			this->tasks.pop_front();
+		}
+
+		task();
+	}
+}
@@ -0,0 +1,62 @@
+/*
+ * ThreadPool.h
+ *
+ * Fixed size pool of worker threads with a FIFO task queue. Used to bound how many blocking requests (i.e. range GETs)
+ * run at the same time no matter how many callers submit work.
+ */
+
+#ifndef THREADPOOL_H_
+#define THREADPOOL_H_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+class ThreadPool {
+public:
+	explicit ThreadPool(size_t numThreads);
+
+	// Runs every task that was already submitted before joining the workers
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool &) = delete;
+	ThreadPool & operator=(const ThreadPool &) = delete;
+
+	// Queues task and returns a future with its result, exceptions thrown by task are rethrown by the future.
+	// A task must never wait on another task of the same pool or the pool can run out of workers.
+	template <typename Function>
+	std::future<typename std::result_of<Function()>::type> submit(Function task) {
+		typedef typename std::result_of<Function()>::type Result;
+
+		auto packagedTask = std::make_shared<std::packaged_task<Result()>>(std::move(task));
+		std::future<Result> result = packagedTask->get_future();
+		{
+			std::lock_guard<std::mutex> lock(this->mutex);
+			this->tasks.emplace_back([packagedTask]() { (*packagedTask)(); });
+		}
+		this->condition.notify_one();
+		return result;
+	}
+
+	size_t size() const { return this->workers.size(); }
+
+	// tasks waiting for a worker
+	size_t pending();
+
+private:
+	void work();
+
+	std::vector<std::thread> workers;
+	std::deque<std::function<void()>> tasks;
+	std::mutex mutex;
+	std::condition_variable condition;
+	bool stopping;
+};
+
+#endif /* THREADPOOL_H_ */
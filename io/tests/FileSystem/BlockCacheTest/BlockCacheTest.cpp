@@ -0,0 +1,230 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "FileSystem/private/BlockCache.h"
+#include "FileSystem/private/CachedReadableFile.h"
+
+// Stand-in for the readable file of a remote filesystem: serves an in memory object and counts the reads that reach
+// it, which are the requests the cache is meant to save
+class InMemoryReadableFile : public arrow::io::RandomAccessFile {
+public:
+	InMemoryReadableFile(int64_t size, uint8_t seed = 7, int latencyMs = 0)
+		: latencyMs(latencyMs), numReads(0), bytesRead(0), position(0) {
+		data.resize(size);
+		for(int64_t i = 0; i < size; i++) {
+			data[i] = static_cast<uint8_t>(i * 31 + seed);
+		}
+	}
+
+	arrow::Status Close() override { return arrow::Status::OK(); }
+
+	arrow::Status GetSize(int64_t * size) override {
+		*size = data.size();
+		return arrow::Status::OK();
+	}
+
+	arrow::Status Read(int64_t nbytes, int64_t * bytesRead, void * buffer) override {
+		return ReadAt(position, nbytes, bytesRead, buffer);
+	}
+
+	arrow::Status Read(int64_t nbytes, std::shared_ptr<arrow::Buffer> * out) override {
+		return arrow::Status::IOError("not used");
+	}
+
+	arrow::Status ReadAt(int64_t position, int64_t nbytes, int64_t * bytesRead, void * buffer) override {
+		numReads++;
+		if(latencyMs > 0) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(latencyMs));
+		}
+		*bytesRead = std::max<int64_t>(0, std::min<int64_t>(nbytes, data.size() - position));
+		std::copy(data.begin() + position, data.begin() + position + *bytesRead, static_cast<uint8_t *>(buffer));
+		this->bytesRead += *bytesRead;
+		return arrow::Status::OK();
+	}
+
+	arrow::Status ReadAt(int64_t position, int64_t nbytes, std::shared_ptr<arrow::Buffer> * out) override {
+		return arrow::Status::IOError("not used");
+	}
+
+	bool supports_zero_copy() const override { return false; }
+
+	arrow::Status Seek(int64_t position) override {
+		this->position = position;
+		return arrow::Status::OK();
+	}
+
+	arrow::Status Tell(int64_t * position) const override {
+		*position = this->position;
+		return arrow::Status::OK();
+	}
+
+	bool closed() const override { return false; }
+
+	std::vector<uint8_t> data;
+	int latencyMs;
+	std::atomic<int> numReads;
+	std::atomic<int64_t> bytesRead;
+
+private:
+	int64_t position;
+};
+
+class BlockCacheTest : public testing::Test {
+protected:
+	BlockCacheTest() {
+		options.blockSize = 1024;
+		options.memoryCapacity = 16 * 1024;
+	}
+
+	std::shared_ptr<CachedReadableFile> open(
+		std::shared_ptr<InMemoryReadableFile> file, std::shared_ptr<BlockCache> cache, const std::string & uri) {
+		const std::string fileKey = BlockCache::getFileKey(uri, file->data.size(), 1);
+		return std::make_shared<CachedReadableFile>(file, fileKey, file->data.size(), cache);
+	}
+
+	void expectRead(std::shared_ptr<CachedReadableFile> cachedFile,
+		const InMemoryReadableFile & file,
+		int64_t position,
+		int64_t nbytes) {
+		std::vector<uint8_t> buffer(nbytes);
+		int64_t bytesRead;
+		ASSERT_TRUE(cachedFile->ReadAt(position, nbytes, &bytesRead, buffer.data()).ok());
+		ASSERT_EQ(bytesRead, std::min<int64_t>(nbytes, file.data.size() - position));
+		for(int64_t i = 0; i < bytesRead; i++) {
+			ASSERT_EQ(buffer[i], file.data[position + i]) << "at " << position + i;
+		}
+	}
+
+	BlockCacheOptions options;
+};
+
+TEST_F(BlockCacheTest, RepeatedReadsHitTheCache) {
+	auto cache = std::make_shared<BlockCache>(options);
+	auto file = std::make_shared<InMemoryReadableFile>(10000);
+
+	// a footer read, the same one again from another handle of the same file
+	expectRead(open(file, cache, "s3://bucket/a.parquet"), *file, 9990, 10);
+	expectRead(open(file, cache, "s3://bucket/a.parquet"), *file, 9992, 8);
+	EXPECT_EQ(file->numReads, 1);
+
+	// a read over four blocks only loads the three it is missing, with one read
+	const int64_t lastBlockSize = 10000 - 9 * 1024;
+	expectRead(open(file, cache, "s3://bucket/a.parquet"), *file, 7000, 3000);
+	EXPECT_EQ(file->numReads, 2);
+	EXPECT_EQ(file->bytesRead, lastBlockSize + 3 * 1024);
+
+	BlockCacheStats stats = cache->getStats();
+	EXPECT_EQ(stats.misses, 4);
+	EXPECT_EQ(stats.memoryHits, 2);
+	EXPECT_EQ(stats.bytesSaved, 2 * lastBlockSize);
+
+	int64_t size;
+	ASSERT_TRUE(open(file, cache, "s3://bucket/a.parquet")->GetSize(&size).ok());
+	EXPECT_EQ(size, 10000);
+}
+
+TEST_F(BlockCacheTest, NewVersionOfAFileMisses) {
+	auto cache = std::make_shared<BlockCache>(options);
+	auto file = std::make_shared<InMemoryReadableFile>(4096);
+	auto rewritten = std::make_shared<InMemoryReadableFile>(4096, 99);
+
+	expectRead(open(file, cache, "gs://bucket/t.csv"), *file, 0, 100);
+
+	const std::string fileKey = BlockCache::getFileKey("gs://bucket/t.csv", 4096, 2);
+	auto rewrittenFile = std::make_shared<CachedReadableFile>(rewritten, fileKey, 4096, cache);
+	std::vector<uint8_t> buffer(100);
+	int64_t bytesRead;
+	ASSERT_TRUE(rewrittenFile->ReadAt(0, 100, &bytesRead, buffer.data()).ok());
+	EXPECT_EQ(buffer[0], rewritten->data[0]);
+	EXPECT_EQ(rewritten->numReads, 1);
+
+	// invalidation drops every version
+	cache->invalidate("gs://bucket/t.csv");
+	EXPECT_EQ(cache->getStats().memoryBytes, 0);
+	expectRead(open(file, cache, "gs://bucket/t.csv"), *file, 0, 100);
+	EXPECT_EQ(file->numReads, 2);
+}
+
+TEST_F(BlockCacheTest, LeastRecentlyUsedBlocksAreEvicted) {
+	options.memoryCapacity = 2 * 1024;
+	auto cache = std::make_shared<BlockCache>(options);
+	auto file = std::make_shared<InMemoryReadableFile>(64 * 1024);
+	auto cachedFile = open(file, cache, "hdfs://namenode/f");
+
+	for(int64_t block : {0, 1, 0, 2, 0, 1}) {
+		expectRead(cachedFile, *file, block * 1024 + 5, 10);
+	}
+
+	// block 1 was the least recently used one when block 2 came in
+	EXPECT_EQ(file->numReads, 4);
+	BlockCacheStats stats = cache->getStats();
+	EXPECT_LE(stats.memoryBytes, options.memoryCapacity);
+	EXPECT_EQ(stats.evictions, 2);
+}
+
+TEST_F(BlockCacheTest, EvictedBlocksSpillToDisk) {
+	char directory[] = "/tmp/BlockCacheTestXXXXXX";
+	ASSERT_NE(mkdtemp(directory), nullptr);
+	options.memoryCapacity = 2 * 1024;
+	options.spillDirectory = directory;
+	options.diskCapacity = 4 * 1024;
+	auto file = std::make_shared<InMemoryReadableFile>(64 * 1024);
+	{
+		auto cache = std::make_shared<BlockCache>(options);
+		auto cachedFile = open(file, cache, "s3://bucket/b");
+
+		for(int64_t block = 0; block < 6; block++) {
+			expectRead(cachedFile, *file, block * 1024, 1024);
+		}
+		BlockCacheStats stats = cache->getStats();
+		EXPECT_EQ(stats.memoryBytes, 2 * 1024);
+		EXPECT_EQ(stats.diskBytes, 4 * 1024);
+
+		// blocks 2 to 5 are still cached, block 0 and 1 fell off the disk tier
+		expectRead(cachedFile, *file, 2 * 1024, 2 * 1024);
+		EXPECT_EQ(file->numReads, 6);
+		EXPECT_EQ(cache->getStats().diskHits, 2);
+		expectRead(cachedFile, *file, 0, 10);
+		EXPECT_EQ(file->numReads, 7);
+	}
+
+	// the spill files go with the cache
+	EXPECT_EQ(rmdir(directory), 0);
+}
+
+TEST_F(BlockCacheTest, ConcurrentReadersLoadABlockOnce) {
+	auto cache = std::make_shared<BlockCache>(options);
+	auto file = std::make_shared<InMemoryReadableFile>(8 * 1024, 7, 50);
+
+	std::vector<std::thread> readers;
+	for(int i = 0; i < 8; i++) {
+		readers.emplace_back([&]() { expectRead(open(file, cache, "s3://bucket/c"), *file, 100, 1000); });
+	}
+	for(auto & reader : readers) {
+		reader.join();
+	}
+
+	// both blocks of the read come from the same load
+	EXPECT_EQ(file->numReads, 1);
+	BlockCacheStats stats = cache->getStats();
+	EXPECT_EQ(stats.misses, 2);
+	EXPECT_EQ(stats.memoryHits, 7 * 2);
+}
+
+TEST_F(BlockCacheTest, NoDefaultCacheUnlessOneIsSet) {
+	EXPECT_EQ(BlockCache::getDefaultInstance(), nullptr);
+
+	auto cache = std::make_shared<BlockCache>(options);
+	BlockCache::setDefaultInstance(cache);
+	EXPECT_EQ(BlockCache::getDefaultInstance(), cache);
+
+	BlockCache::setDefaultInstance(nullptr);
+	EXPECT_EQ(BlockCache::getDefaultInstance(), nullptr);
+}
@@ -0,0 +1,146 @@
+#include <cstdio>
+#include <fstream>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "FileSystem/MappedReadableFile.h"
+
+class MappedReadableFileTest : public testing::Test {
+protected:
+	MappedReadableFileTest() {
+		char name[] = "/tmp/MappedReadableFileTestXXXXXX";
+		const int fd = mkstemp(name);
+		close(fd);
+		path = name;
+
+		data.resize(3 * 4096 + 100);
+		for(size_t i = 0; i < data.size(); i++) {
+			data[i] = static_cast<uint8_t>(i * 31 + 7);
+		}
+		std::ofstream file(path, std::ios::binary);
+		file.write(reinterpret_cast<const char *>(data.data()), data.size());
+	}
+
+	~MappedReadableFileTest() { std::remove(path.c_str()); }
+
+	std::string path;
+	std::vector<uint8_t> data;
+};
+
+TEST_F(MappedReadableFileTest, ReadsAreSlicesOfTheMapping) {
+	std::shared_ptr<MappedReadableFile> file;
+	ASSERT_TRUE(MappedReadableFile::Open(path, MappedFileAdvice::NORMAL, &file).ok());
+	EXPECT_TRUE(file->supports_zero_copy());
+
+	int64_t size;
+	ASSERT_TRUE(file->GetSize(&size).ok());
+	EXPECT_EQ(size, data.size());
+
+	std::shared_ptr<arrow::Buffer> first;
+	std::shared_ptr<arrow::Buffer> second;
+	ASSERT_TRUE(file->ReadAt(10, 100, &first).ok());
+	ASSERT_TRUE(file->ReadAt(5000, 200, &second).ok());
+	ASSERT_EQ(first->size(), 100);
+	ASSERT_EQ(second->size(), 200);
+	EXPECT_EQ(std::vector<uint8_t>(first->data(), first->data() + 100),
+		std::vector<uint8_t>(data.begin() + 10, data.begin() + 110));
+
+	// both point into the same mapping, nothing was copied
+	EXPECT_EQ(second->data() - first->data(), 5000 - 10);
+
+	// the slices outlive the file
+	ASSERT_TRUE(file->Close().ok());
+	EXPECT_TRUE(file->closed());
+	file.reset();
+	EXPECT_EQ(std::vector<uint8_t>(second->data(), second->data() + 200),
+		std::vector<uint8_t>(data.begin() + 5000, data.begin() + 5200));
+}
+
+TEST_F(MappedReadableFileTest, CopyingReadsAndPosition) {
+	std::shared_ptr<MappedReadableFile> file;
+	ASSERT_TRUE(MappedReadableFile::Open(path, MappedFileAdvice::SEQUENTIAL, &file).ok());
+
+	std::vector<uint8_t> buffer(4096);
+	int64_t bytesRead;
+	int64_t position;
+	ASSERT_TRUE(file->Seek(3 * 4096).ok());
+	ASSERT_TRUE(file->Read(buffer.size(), &bytesRead, buffer.data()).ok());
+	EXPECT_EQ(bytesRead, 100);
+	EXPECT_EQ(buffer[99], data[3 * 4096 + 99]);
+	ASSERT_TRUE(file->Tell(&position).ok());
+	EXPECT_EQ(position, data.size());
+
+	// reads past the end are empty, negative ones and reads of a closed file fail
+	ASSERT_TRUE(file->ReadAt(data.size() + 10, 10, &bytesRead, buffer.data()).ok());
+	EXPECT_EQ(bytesRead, 0);
+	EXPECT_FALSE(file->ReadAt(-1, 10, &bytesRead, buffer.data()).ok());
+	file->Close();
+	EXPECT_FALSE(file->ReadAt(0, 10, &bytesRead, buffer.data()).ok());
+}
+
+// the row groups of a file are read at their offsets by parallel tasks sharing it, while a reader may be going through
+// it with Read
+TEST_F(MappedReadableFileTest, ReadAtLeavesThePositionAlone) {
+	std::shared_ptr<MappedReadableFile> file;
+	ASSERT_TRUE(MappedReadableFile::Open(path, MappedFileAdvice::NORMAL, &file).ok());
+	ASSERT_TRUE(file->Seek(100).ok());
+
+	std::vector<std::thread> tasks;
+	for(int task = 0; task < 4; task++) {
+		tasks.emplace_back([&file, task]() {
+			std::vector<uint8_t> buffer(4096);
+			int64_t bytesRead;
+			std::shared_ptr<arrow::Buffer> slice;
+			for(int i = 0; i < 1000; i++) {
+				file->ReadAt(task * 4096, buffer.size(), &bytesRead, buffer.data());
+				file->ReadAt(task * 4096 + 1, 10, &slice);
+			}
+		});
+	}
+	for(auto & task : tasks) {
+		task.join();
+	}
+
+	int64_t position;
+	ASSERT_TRUE(file->Tell(&position).ok());
+	EXPECT_EQ(position, 100);
+
+	std::vector<uint8_t> buffer(50);
+	int64_t bytesRead;
+	ASSERT_TRUE(file->Read(buffer.size(), &bytesRead, buffer.data()).ok());
+	EXPECT_EQ(buffer[0], data[100]);
+	std::shared_ptr<arrow::Buffer> next;
+	ASSERT_TRUE(file->Read(10, &next).ok());
+	EXPECT_EQ(next->data()[0], data[150]);
+	ASSERT_TRUE(file->Tell(&position).ok());
+	EXPECT_EQ(position, 160);
+}
+
+TEST_F(MappedReadableFileTest, Advice) {
+	std::shared_ptr<MappedReadableFile> file;
+	ASSERT_TRUE(MappedReadableFile::Open(path, MappedFileAdvice::RANDOM, &file).ok());
+
+	// ranges that don't start at a page boundary are widened to whole pages
+	EXPECT_TRUE(file->Advise(100, 5000, MappedFileAdvice::WILLNEED).ok());
+	EXPECT_TRUE(file->Advise(4096 + 1, 10, MappedFileAdvice::SEQUENTIAL).ok());
+	EXPECT_TRUE(file->Advise(0, data.size() + 100, MappedFileAdvice::NORMAL).ok());
+	EXPECT_TRUE(file->Advise(data.size() + 100, 10, MappedFileAdvice::WILLNEED).ok());
+}
+
+TEST_F(MappedReadableFileTest, EmptyAndMissingFiles) {
+	std::ofstream(path, std::ios::trunc);
+	std::shared_ptr<MappedReadableFile> file;
+	ASSERT_TRUE(MappedReadableFile::Open(path, MappedFileAdvice::SEQUENTIAL, &file).ok());
+
+	int64_t size;
+	ASSERT_TRUE(file->GetSize(&size).ok());
+	EXPECT_EQ(size, 0);
+	std::shared_ptr<arrow::Buffer> buffer;
+	ASSERT_TRUE(file->ReadAt(0, 10, &buffer).ok());
+	EXPECT_EQ(buffer->size(), 0);
+
+	EXPECT_FALSE(MappedReadableFile::Open(path + ".missing", MappedFileAdvice::NORMAL, &file).ok());
+}
@@ -0,0 +1,294 @@
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "FileSystem/private/InvalidatingOutputStream.h"
+#include "FileSystem/private/MetadataCache.h"
+
+// Remote filesystem stand-in with a flat directory of objects. It counts the calls that reach it, and the calls can
+// be made slow to simulate the latency of an object store listing.
+class MockFileSystem : public FileSystemInterface {
+public:
+	MockFileSystem(int numObjects, int latencyMs = 0) : latencyMs(latencyMs), failNextCalls(0) {
+		for(int i = 0; i < numObjects; i++) {
+			objects.push_back("/data/part-" + std::to_string(i) + (i % 2 == 0 ? ".parquet" : ".csv"));
+		}
+	}
+
+	FileSystemType getFileSystemType() const noexcept override { return FileSystemType::S3; }
+	FileSystemConnection getFileSystemConnection() const noexcept override { return FileSystemConnection(); }
+	Path getRoot() const noexcept override { return Path("/"); }
+
+	bool exists(const Uri & uri) const override {
+		call(existsCalls);
+		return uri.getPath().toString(true) == "/data/" || findObject(uri) >= 0;
+	}
+
+	FileStatus getFileStatus(const Uri & uri) const override {
+		call(getFileStatusCalls);
+		if(findObject(uri) < 0) {
+			throw std::runtime_error("not found");
+		}
+		return FileStatus(uri, FileType::FILE, 100, 1);
+	}
+
+	std::vector<FileStatus> list(const Uri & uri, const FileFilter & filter) const override {
+		call(listCalls);
+		std::vector<FileStatus> response;
+		for(const std::string & object : objects) {
+			const FileStatus fileStatus(Uri(uri.getScheme(), uri.getAuthority(), Path(object)), FileType::FILE, 100, 1);
+			if(filter(fileStatus)) {
+				response.push_back(fileStatus);
+			}
+		}
+		return response;
+	}
+
+	std::vector<FileStatus> list(const Uri & uri, FileType fileType, const std::string & wildcard) const override {
+		return list(uri, FileTypeWildcardFilter(fileType, wildcard));
+	}
+
+	std::vector<Uri> list(const Uri & uri, const std::string & wildcard) const override {
+		call(listCalls);
+		const std::string finalWildcard = (uri.getPath() + wildcard).toString(true);
+		std::vector<Uri> response;
+		for(const std::string & object : objects) {
+			if(WildcardFilter::match(object, finalWildcard)) {
+				response.push_back(Uri(uri.getScheme(), uri.getAuthority(), Path(object)));
+			}
+		}
+		return response;
+	}
+
+	std::vector<std::string> listResourceNames(
+		const Uri & uri, FileType fileType, const std::string & wildcard) const override {
+		return {};
+	}
+	std::vector<std::string> listResourceNames(const Uri & uri, const std::string & wildcard) const override {
+		return {};
+	}
+
+	bool makeDirectory(const Uri & uri) const override { return false; }
+	bool remove(const Uri & uri) const override { return false; }
+	bool move(const Uri & src, const Uri & dst) const override { return false; }
+	bool truncateFile(const Uri & uri, long long length) const override { return false; }
+
+	std::shared_ptr<arrow::io::RandomAccessFile> openReadable(const Uri & uri) const override { return nullptr; }
+	std::shared_ptr<arrow::io::OutputStream> openWriteable(const Uri & uri) const override { return nullptr; }
+
+	std::vector<std::string> objects;
+	int latencyMs;
+	mutable std::atomic<int> failNextCalls;
+	mutable std::atomic<int> existsCalls{0};
+	mutable std::atomic<int> getFileStatusCalls{0};
+	mutable std::atomic<int> listCalls{0};
+
+private:
+	void call(std::atomic<int> & counter) const {
+		counter++;
+		if(latencyMs > 0) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(latencyMs));
+		}
+		if(failNextCalls > 0) {
+			failNextCalls--;
+			throw std::runtime_error("injected failure");
+		}
+	}
+
+	int findObject(const Uri & uri) const {
+		for(size_t i = 0; i < objects.size(); i++) {
+			if(objects[i] == uri.getPath().toString(true)) {
+				return i;
+			}
+		}
+		return -1;
+	}
+};
+
+// Upload to the mock filesystem, the object only appears once the stream is closed as on S3 and GCS
+class MockOutputStream : public arrow::io::OutputStream {
+public:
+	MockOutputStream(MockFileSystem & fileSystem, const std::string & object)
+		: fileSystem(fileSystem), object(object), position(0), isClosed(false) {}
+
+	arrow::Status Close() override {
+		if(!isClosed) {
+			fileSystem.objects.push_back(object);
+			isClosed = true;
+		}
+		return arrow::Status::OK();
+	}
+
+	arrow::Status Write(const void * buffer, int64_t nbytes) override {
+		position += nbytes;
+		return arrow::Status::OK();
+	}
+
+	arrow::Status Flush() override { return arrow::Status::OK(); }
+
+	arrow::Status Tell(int64_t * position) const override {
+		*position = this->position;
+		return arrow::Status::OK();
+	}
+
+	bool closed() const override { return isClosed; }
+
+private:
+	MockFileSystem & fileSystem;
+	std::string object;
+	int64_t position;
+	bool isClosed;
+};
+
+class MetadataCacheTest : public testing::Test {
+protected:
+	MetadataCacheTest() : directory("s3://bucket/data/") {}
+
+	Uri directory;
+};
+
+TEST_F(MetadataCacheTest, StatusesAndListingsAreCached) {
+	MockFileSystem fileSystem(100);
+	MetadataCache cache;
+
+	// what uri_data_provider does for every table of every query
+	for(int query = 0; query < 3; query++) {
+		EXPECT_TRUE(cache.exists(fileSystem, directory));
+		EXPECT_EQ(cache.list(fileSystem, directory, "*").size(), 100);
+		EXPECT_TRUE(cache.getFileStatus(fileSystem, Uri("s3://bucket/data/part-4.parquet")).isFile());
+	}
+
+	EXPECT_EQ(fileSystem.existsCalls, 1);
+	EXPECT_EQ(fileSystem.listCalls, 1);
+	EXPECT_EQ(fileSystem.getFileStatusCalls, 1);
+	EXPECT_EQ(cache.getStats().misses, 3);
+	EXPECT_EQ(cache.getStats().hits, 6);
+}
+
+TEST_F(MetadataCacheTest, WildcardsAreMatchedAgainstTheCachedListing) {
+	MockFileSystem fileSystem(100);
+	MetadataCache cache;
+
+	std::vector<Uri> parquetFiles = cache.list(fileSystem, directory, "*.parquet");
+	std::vector<Uri> csvFiles = cache.list(fileSystem, directory, "*.csv");
+	std::vector<Uri> oneFile = cache.list(fileSystem, directory, "part-7.csv");
+
+	EXPECT_EQ(fileSystem.listCalls, 1);
+	EXPECT_EQ(parquetFiles, fileSystem.list(directory, "*.parquet"));
+	EXPECT_EQ(csvFiles, fileSystem.list(directory, "*.csv"));
+	ASSERT_EQ(oneFile.size(), 1);
+	EXPECT_EQ(oneFile[0].getPath().toString(true), "/data/part-7.csv");
+
+	// filters run against the cached status listing
+	std::vector<FileStatus> statuses =
+		cache.list(fileSystem, directory, FileTypeWildcardFilter(FileType::FILE, "*.csv"));
+	std::vector<FileStatus> again = cache.list(fileSystem, directory, FilesFilter());
+	EXPECT_EQ(statuses.size(), 50);
+	EXPECT_EQ(again.size(), 100);
+	// the uri listing, the status listing and the two direct calls of the expectations above
+	EXPECT_EQ(fileSystem.listCalls, 4);
+}
+
+TEST_F(MetadataCacheTest, ConcurrentListingsAreCoalesced) {
+	MockFileSystem fileSystem(1000, 100);
+	MetadataCache cache;
+
+	std::vector<std::thread> queries;
+	std::atomic<int> listed{0};
+	for(int i = 0; i < 8; i++) {
+		queries.emplace_back([&]() { listed += cache.list(fileSystem, directory, "*.parquet").size(); });
+	}
+	for(auto & query : queries) {
+		query.join();
+	}
+
+	EXPECT_EQ(fileSystem.listCalls, 1);
+	EXPECT_EQ(listed, 8 * 500);
+	EXPECT_EQ(cache.getStats().misses, 1);
+	EXPECT_EQ(cache.getStats().coalesced + cache.getStats().hits, 7);
+}
+
+TEST_F(MetadataCacheTest, EntriesExpireAndCanBeInvalidated) {
+	MockFileSystem fileSystem(10);
+	MetadataCacheOptions options;
+	options.timeToLive = std::chrono::milliseconds(50);
+	MetadataCache cache(options);
+	const Uri file("s3://bucket/data/part-2.parquet");
+
+	cache.list(fileSystem, directory, "*");
+	cache.getFileStatus(fileSystem, file);
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	cache.list(fileSystem, directory, "*");
+	cache.getFileStatus(fileSystem, file);
+	EXPECT_EQ(fileSystem.listCalls, 2);
+	EXPECT_EQ(fileSystem.getFileStatusCalls, 2);
+
+	// a change to a file drops its status and the listing of its directory, but not the status of other files
+	const Uri otherFile("s3://bucket/data/part-4.parquet");
+	options.timeToLive = std::chrono::seconds(60);
+	MetadataCache longLivedCache(options);
+	longLivedCache.list(fileSystem, directory, "*");
+	longLivedCache.getFileStatus(fileSystem, file);
+	longLivedCache.getFileStatus(fileSystem, otherFile);
+	longLivedCache.invalidate(file);
+	longLivedCache.list(fileSystem, directory, "*");
+	longLivedCache.getFileStatus(fileSystem, file);
+	longLivedCache.getFileStatus(fileSystem, otherFile);
+	EXPECT_EQ(fileSystem.listCalls, 2 + 2);
+	EXPECT_EQ(fileSystem.getFileStatusCalls, 2 + 3);
+}
+
+TEST_F(MetadataCacheTest, WritesAreSeenOnceTheirStreamIsClosed) {
+	MockFileSystem fileSystem(10);
+	MetadataCache cache;
+	const Uri file("s3://bucket/data/new.parquet");
+
+	// what FileSystemManager::openWriteable does, the caches are invalidated when the stream opens and when it closes
+	cache.invalidate(file);
+	InvalidatingOutputStream stream(
+		std::make_shared<MockOutputStream>(fileSystem, "/data/new.parquet"), [&]() { cache.invalidate(file); });
+	ASSERT_TRUE(stream.Write("data", 4).ok());
+
+	// a query reading while the upload is in flight does not find the object yet
+	EXPECT_FALSE(cache.exists(fileSystem, file));
+	EXPECT_EQ(cache.list(fileSystem, directory, "*").size(), 10);
+
+	ASSERT_TRUE(stream.Close().ok());
+	EXPECT_TRUE(cache.exists(fileSystem, file));
+	EXPECT_EQ(cache.list(fileSystem, directory, "*").size(), 11);
+	EXPECT_TRUE(cache.getFileStatus(fileSystem, file).isFile());
+}
+
+TEST_F(MetadataCacheTest, ErrorsAreNotCached) {
+	MockFileSystem fileSystem(10);
+	MetadataCache cache;
+
+	fileSystem.failNextCalls = 1;
+	EXPECT_THROW(cache.list(fileSystem, directory, "*"), std::runtime_error);
+	EXPECT_EQ(cache.list(fileSystem, directory, "*").size(), 10);
+	EXPECT_THROW(cache.getFileStatus(fileSystem, Uri("s3://bucket/data/missing")), std::runtime_error);
+	EXPECT_THROW(cache.getFileStatus(fileSystem, Uri("s3://bucket/data/missing")), std::runtime_error);
+	EXPECT_EQ(fileSystem.listCalls, 2);
+	EXPECT_EQ(fileSystem.getFileStatusCalls, 2);
+}
+
+TEST_F(MetadataCacheTest, NumberOfEntriesIsBounded) {
+	MockFileSystem fileSystem(100);
+	MetadataCacheOptions options;
+	options.maxEntries = 10;
+	MetadataCache cache(options);
+
+	for(int i = 0; i < 100; i++) {
+		const std::string name = "part-" + std::to_string(i) + (i % 2 == 0 ? ".parquet" : ".csv");
+		cache.getFileStatus(fileSystem, Uri("s3://bucket/data/" + name));
+	}
+	// the most recent ones are still there
+	cache.getFileStatus(fileSystem, Uri("s3://bucket/data/part-99.csv"));
+	EXPECT_EQ(fileSystem.getFileStatusCalls, 100);
+	cache.getFileStatus(fileSystem, Uri("s3://bucket/data/part-0.parquet"));
+	EXPECT_EQ(fileSystem.getFileStatusCalls, 101);
+}
@@ -0,0 +1,249 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "FileSystem/private/MultipartOutputStream.h"
+#include "Util/ChecksumUtil.h"
+
+// Stand-in for an S3 compatible store: keeps the parts of one multipart upload in memory and assembles them on
+// complete. Like S3 it rejects a part whose bytes do not match the MD5 sent with it. Uploads can be delayed to
+// simulate the latency of a remote store, fail, or get a byte corrupted on the way.
+class InMemoryMultipartStore {
+public:
+	InMemoryMultipartStore(int latencyMs = 0) : latencyMs(latencyMs) {}
+
+	MultipartUploadFunctions functions() {
+		MultipartUploadFunctions uploadFunctions;
+		uploadFunctions.uploadPart =
+			[this](int partNumber, const uint8_t * data, int64_t nbytes, const std::string & md5, std::string * partId) {
+				return this->uploadPart(partNumber, data, nbytes, md5, partId);
+			};
+		uploadFunctions.complete = [this](const std::vector<std::string> & partIds) { return this->complete(partIds); };
+		uploadFunctions.abort = [this]() { this->aborted++; };
+		return uploadFunctions;
+	}
+
+	arrow::Status uploadPart(
+		int partNumber, const uint8_t * data, int64_t nbytes, const std::string & md5, std::string * partId) {
+		int concurrent = ++inFlight;
+		int previousMax = maxInFlight;
+		while(concurrent > previousMax && !maxInFlight.compare_exchange_weak(previousMax, concurrent)) {
+		}
+		if(latencyMs > 0) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(latencyMs));
+		}
+		--inFlight;
+
+		if(failNextUploads > 0) {
+			failNextUploads--;
+			return arrow::Status::IOError("injected failure");
+		}
+		if(denyUploads) {
+			return arrow::Status::Invalid("AccessDenied");
+		}
+
+		std::vector<uint8_t> received(data, data + nbytes);
+		if(corruptNextUploads > 0 && nbytes > 0) {
+			corruptNextUploads--;
+			received[nbytes / 2] ^= 0xff;
+		}
+		if(ChecksumUtil::toBase64(ChecksumUtil::md5(received.data(), received.size())) != md5) {
+			badDigests++;
+			return arrow::Status::IOError("BadDigest");
+		}
+
+		std::lock_guard<std::mutex> lock(mutex);
+		*partId = "etag-" + std::to_string(partNumber);
+		parts[*partId] = received;
+		return arrow::Status::OK();
+	}
+
+	arrow::Status complete(const std::vector<std::string> & partIds) {
+		std::lock_guard<std::mutex> lock(mutex);
+		object.clear();
+		for(const std::string & partId : partIds) {
+			if(parts.count(partId) == 0) {
+				return arrow::Status::Invalid("InvalidPart " + partId);
+			}
+			object.insert(object.end(), parts[partId].begin(), parts[partId].end());
+		}
+		completed++;
+		return arrow::Status::OK();
+	}
+
+	int latencyMs;
+	std::atomic<int> failNextUploads{0};
+	std::atomic<int> corruptNextUploads{0};
+	std::atomic<bool> denyUploads{false};
+	std::atomic<int> badDigests{0};
+	std::atomic<int> inFlight{0};
+	std::atomic<int> maxInFlight{0};
+	std::atomic<int> completed{0};
+	std::atomic<int> aborted{0};
+	std::vector<uint8_t> object;
+
+private:
+	std::mutex mutex;
+	std::map<std::string, std::vector<uint8_t>> parts;
+};
+
+class MultipartOutputStreamTest : public testing::Test {
+protected:
+	MultipartOutputStreamTest() : uploadPool(std::make_shared<ThreadPool>(8)) {
+		options.partSize = 1000;
+		options.maxPartsInFlight = 3;
+		options.retryDelayMs = 1;
+	}
+
+	static std::vector<uint8_t> makeData(int64_t size) {
+		std::vector<uint8_t> data(size);
+		for(int64_t i = 0; i < size; i++) {
+			data[i] = static_cast<uint8_t>(i * 31 + 7);
+		}
+		return data;
+	}
+
+	// writes data in writes of varying sizes, some within a part and some spanning several
+	static arrow::Status writeAll(MultipartOutputStream & stream, const std::vector<uint8_t> & data) {
+		const int64_t writeSizes[] = {1, 999, 1500, 37, 4000, 250};
+		int64_t position = 0;
+		for(int i = 0; position < static_cast<int64_t>(data.size()); i++) {
+			const int64_t nbytes = std::min<int64_t>(writeSizes[i % 6], data.size() - position);
+			arrow::Status status = stream.Write(data.data() + position, nbytes);
+			if(!status.ok()) {
+				return status;
+			}
+			position += nbytes;
+		}
+		return arrow::Status::OK();
+	}
+
+	std::shared_ptr<ThreadPool> uploadPool;
+	MultipartOutputStreamOptions options;
+};
+
+TEST_F(MultipartOutputStreamTest, PartsAreAssembledInOrder) {
+	InMemoryMultipartStore store(5);
+	const std::vector<uint8_t> data = makeData(20500);
+
+	MultipartOutputStream stream(store.functions(), uploadPool, options);
+	ASSERT_TRUE(writeAll(stream, data).ok());
+	int64_t position;
+	ASSERT_TRUE(stream.Tell(&position).ok());
+	EXPECT_EQ(position, 20500);
+	ASSERT_TRUE(stream.Close().ok());
+
+	EXPECT_EQ(store.object, data);
+	EXPECT_EQ(stream.getNumUploads(), 21);
+	EXPECT_EQ(store.completed, 1);
+	EXPECT_EQ(store.aborted, 0);
+	EXPECT_TRUE(stream.closed());
+}
+
+TEST_F(MultipartOutputStreamTest, PartsUploadConcurrentlyWithBoundedMemory) {
+	InMemoryMultipartStore store(20);
+	const std::vector<uint8_t> data = makeData(12000);
+
+	MultipartOutputStream stream(store.functions(), uploadPool, options);
+	ASSERT_TRUE(writeAll(stream, data).ok());
+	ASSERT_TRUE(stream.Close().ok());
+
+	EXPECT_EQ(store.object, data);
+	EXPECT_GT(store.maxInFlight, 1);
+	EXPECT_LE(store.maxInFlight, options.maxPartsInFlight);
+}
+
+TEST_F(MultipartOutputStreamTest, FailedPartsAreRetriedByThemselves) {
+	InMemoryMultipartStore store;
+	store.failNextUploads = 3;
+	const std::vector<uint8_t> data = makeData(5000);
+
+	MultipartOutputStream stream(store.functions(), uploadPool, options);
+	ASSERT_TRUE(writeAll(stream, data).ok());
+	ASSERT_TRUE(stream.Close().ok());
+
+	EXPECT_EQ(store.object, data);
+	// only the failed uploads were repeated, not the whole object
+	EXPECT_EQ(stream.getNumUploads(), 5 + 3);
+}
+
+TEST_F(MultipartOutputStreamTest, CorruptedPartsAreRejectedAndRetried) {
+	InMemoryMultipartStore store;
+	store.corruptNextUploads = 2;
+	const std::vector<uint8_t> data = makeData(4000);
+
+	MultipartOutputStream stream(store.functions(), uploadPool, options);
+	ASSERT_TRUE(writeAll(stream, data).ok());
+	ASSERT_TRUE(stream.Close().ok());
+
+	EXPECT_EQ(store.badDigests, 2);
+	EXPECT_EQ(store.object, data);
+}
+
+TEST_F(MultipartOutputStreamTest, PartThatKeepsFailingFailsTheStream) {
+	InMemoryMultipartStore store;
+	store.failNextUploads = 1000;
+	options.maxAttempts = 3;
+	const std::vector<uint8_t> data = makeData(10000);
+
+	MultipartOutputStream stream(store.functions(), uploadPool, options);
+	writeAll(stream, data);
+	arrow::Status status = stream.Close();
+
+	EXPECT_TRUE(status.IsIOError());
+	EXPECT_EQ(store.completed, 0);
+	EXPECT_EQ(store.aborted, 1);
+	// the stream stops uploading once a part failed for good
+	EXPECT_LT(stream.getNumUploads(), 10 * options.maxAttempts);
+}
+
+TEST_F(MultipartOutputStreamTest, ErrorsThatAreNotIOErrorsAreNotRetried) {
+	InMemoryMultipartStore store;
+	store.denyUploads = true;
+
+	MultipartOutputStream stream(store.functions(), uploadPool, options);
+	const std::vector<uint8_t> data = makeData(10);
+	ASSERT_TRUE(stream.Write(data.data(), data.size()).ok());
+	EXPECT_FALSE(stream.Close().ok());
+	EXPECT_EQ(stream.getNumUploads(), 1);
+	EXPECT_EQ(store.aborted, 1);
+}
+
+TEST_F(MultipartOutputStreamTest, EmptyObject) {
+	InMemoryMultipartStore store;
+
+	MultipartOutputStream stream(store.functions(), uploadPool, options);
+	ASSERT_TRUE(stream.Close().ok());
+	EXPECT_EQ(store.completed, 1);
+	EXPECT_TRUE(store.object.empty());
+	EXPECT_TRUE(stream.Close().ok());
+}
+
+TEST_F(MultipartOutputStreamTest, FlushWaitsForFullParts) {
+	InMemoryMultipartStore store(5);
+	const std::vector<uint8_t> data = makeData(2500);
+
+	MultipartOutputStream stream(store.functions(), uploadPool, options);
+	ASSERT_TRUE(stream.Write(data.data(), data.size()).ok());
+	ASSERT_TRUE(stream.Flush().ok());
+	EXPECT_EQ(stream.getNumUploads(), 2);
+	ASSERT_TRUE(stream.Close().ok());
+	EXPECT_EQ(store.object, data);
+}
+
+TEST_F(MultipartOutputStreamTest, StreamDestroyedBeforeCloseAborts) {
+	InMemoryMultipartStore store(5);
+	{
+		MultipartOutputStream stream(store.functions(), uploadPool, options);
+		const std::vector<uint8_t> data = makeData(3500);
+		ASSERT_TRUE(stream.Write(data.data(), data.size()).ok());
+	}
+	EXPECT_EQ(store.completed, 0);
+	EXPECT_EQ(store.aborted, 1);
+}
@@ -0,0 +1,213 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "FileSystem/private/RangeReader.h"
+
+// Stand-in for an object store that serves range requests of an in memory object. Requests can be delayed to
+// simulate the latency of a remote store and can be made to fail.
+class InMemoryObject {
+public:
+	InMemoryObject(int64_t size, int latencyMs = 0) : latencyMs(latencyMs), failNextRequests(0) {
+		data.resize(size);
+		for(int64_t i = 0; i < size; i++) {
+			data[i] = static_cast<uint8_t>(i * 31 + 7);
+		}
+	}
+
+	RangeReader::FetchFunction fetchFunction() {
+		return [this](int64_t position, int64_t nbytes, int64_t * bytesRead, uint8_t * out) {
+			return this->fetch(position, nbytes, bytesRead, out);
+		};
+	}
+
+	arrow::Status fetch(int64_t position, int64_t nbytes, int64_t * bytesRead, uint8_t * out) {
+		int concurrent = ++inFlight;
+		int previousMax = maxInFlight;
+		while(concurrent > previousMax && !maxInFlight.compare_exchange_weak(previousMax, concurrent)) {
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			requests.emplace_back(position, nbytes);
+		}
+
+		if(latencyMs > 0) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(latencyMs));
+		}
+
+		--inFlight;
+		if(failNextRequests > 0) {
+			failNextRequests--;
+			*bytesRead = 0;
+			return arrow::Status::IOError("injected failure");
+		}
+
+		*bytesRead = std::max<int64_t>(0, std::min<int64_t>(nbytes, data.size() - position));
+		std::copy(data.begin() + position, data.begin() + position + *bytesRead, out);
+		return arrow::Status::OK();
+	}
+
+	std::vector<std::pair<int64_t, int64_t>> getRequests() {
+		std::lock_guard<std::mutex> lock(mutex);
+		return requests;
+	}
+
+	// waits for the read-ahead requests that run in the background
+	void waitForRequests(size_t numRequests) {
+		for(int i = 0; i < 1000 && getRequests().size() < numRequests; i++) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	}
+
+	std::vector<uint8_t> data;
+	int latencyMs;
+	std::atomic<int> failNextRequests;
+	std::atomic<int> inFlight{0};
+	std::atomic<int> maxInFlight{0};
+
+private:
+	std::mutex mutex;
+	std::vector<std::pair<int64_t, int64_t>> requests;
+};
+
+class RangeReaderTest : public testing::Test {
+protected:
+	RangeReaderTest() : ioPool(std::make_shared<ThreadPool>(4)) {
+		options.blockSize = 1024;
+		options.maxRequestSize = 4096;
+		options.readAheadBlocks = 0;
+		options.maxCachedBlocks = 16;
+	}
+
+	void expectData(const InMemoryObject & object, int64_t position, const std::vector<uint8_t> & buffer) {
+		for(size_t i = 0; i < buffer.size(); i++) {
+			ASSERT_EQ(buffer[i], object.data[position + i]) << "at " << position + i;
+		}
+	}
+
+	std::shared_ptr<ThreadPool> ioPool;
+	RangeReaderOptions options;
+};
+
+TEST_F(RangeReaderTest, SmallReadsAreCoalesced) {
+	InMemoryObject object(10000);
+	RangeReader reader(object.fetchFunction(), object.data.size(), ioPool, options);
+
+	for(int64_t position : {0, 200, 900, 100}) {
+		std::vector<uint8_t> buffer(100);
+		int64_t bytesRead;
+		ASSERT_TRUE(reader.ReadAt(position, buffer.size(), &bytesRead, buffer.data()).ok());
+		EXPECT_EQ(bytesRead, 100);
+		expectData(object, position, buffer);
+	}
+
+	// every read falls in the first block
+	EXPECT_EQ(object.getRequests().size(), 1);
+	EXPECT_EQ(object.getRequests()[0], (std::pair<int64_t, int64_t>(0, 1024)));
+
+	// a read across two blocks only fetches the one it is missing
+	std::vector<uint8_t> buffer(200);
+	int64_t bytesRead;
+	ASSERT_TRUE(reader.ReadAt(950, buffer.size(), &bytesRead, buffer.data()).ok());
+	expectData(object, 950, buffer);
+	EXPECT_EQ(object.getRequests().size(), 2);
+	EXPECT_EQ(object.getRequests()[1], (std::pair<int64_t, int64_t>(1024, 1024)));
+}
+
+TEST_F(RangeReaderTest, LargeReadsAreSplitInParallelRequests) {
+	InMemoryObject object(64 * 1024, 20);
+	RangeReader reader(object.fetchFunction(), object.data.size(), ioPool, options);
+
+	// 100 bytes of a partial block, 14 whole blocks and 100 bytes of another partial block
+	std::vector<uint8_t> buffer(14 * 1024 + 200);
+	int64_t bytesRead;
+	ASSERT_TRUE(reader.ReadAt(1024 - 100, buffer.size(), &bytesRead, buffer.data()).ok());
+	EXPECT_EQ(bytesRead, buffer.size());
+	expectData(object, 1024 - 100, buffer);
+
+	// two cached blocks and the whole blocks in requests of at most 4 blocks
+	std::vector<std::pair<int64_t, int64_t>> requests = object.getRequests();
+	EXPECT_EQ(requests.size(), 2 + 4);
+	for(auto & request : requests) {
+		EXPECT_LE(request.second, options.maxRequestSize);
+	}
+	EXPECT_GT(object.maxInFlight, 1);
+	EXPECT_EQ(reader.getNumRequests(), requests.size());
+}
+
+TEST_F(RangeReaderTest, SequentialReadsArePrefetched) {
+	InMemoryObject object(8 * 1024);
+	options.readAheadBlocks = 2;
+	RangeReader reader(object.fetchFunction(), object.data.size(), ioPool, options);
+
+	std::vector<uint8_t> buffer(1024);
+	int64_t bytesRead;
+	ASSERT_TRUE(reader.ReadAt(0, buffer.size(), &bytesRead, buffer.data()).ok());
+	object.waitForRequests(2);
+
+	// the two blocks after the read are fetched together
+	std::vector<std::pair<int64_t, int64_t>> requests = object.getRequests();
+	std::sort(requests.begin(), requests.end());
+	ASSERT_EQ(requests.size(), 2);
+	EXPECT_EQ(requests[1], (std::pair<int64_t, int64_t>(1024, 2048)));
+
+	// the next reads find their blocks already fetched and every block is requested only once
+	for(int64_t position = 1024; position < 8 * 1024; position += 1024) {
+		ASSERT_TRUE(reader.ReadAt(position, buffer.size(), &bytesRead, buffer.data()).ok());
+		EXPECT_EQ(bytesRead, 1024);
+		expectData(object, position, buffer);
+	}
+	EXPECT_EQ(reader.getBytesRequested(), 8 * 1024);
+
+	// a random read does not trigger read-ahead
+	InMemoryObject randomObject(8 * 1024);
+	RangeReader randomReader(randomObject.fetchFunction(), randomObject.data.size(), ioPool, options);
+	ASSERT_TRUE(randomReader.ReadAt(4096, 10, &bytesRead, buffer.data()).ok());
+	EXPECT_EQ(randomObject.getRequests().size(), 1);
+}
+
+TEST_F(RangeReaderTest, EndOfObjectAndErrors) {
+	InMemoryObject object(3000);
+	RangeReader reader(object.fetchFunction(), object.data.size(), ioPool, options);
+
+	std::vector<uint8_t> buffer(1000);
+	int64_t bytesRead;
+	ASSERT_TRUE(reader.ReadAt(2500, buffer.size(), &bytesRead, buffer.data()).ok());
+	EXPECT_EQ(bytesRead, 500);
+	buffer.resize(bytesRead);
+	expectData(object, 2500, buffer);
+
+	ASSERT_TRUE(reader.ReadAt(3000, 10, &bytesRead, buffer.data()).ok());
+	EXPECT_EQ(bytesRead, 0);
+	EXPECT_FALSE(reader.ReadAt(-1, 10, &bytesRead, buffer.data()).ok());
+
+	// a failed block is not kept, the next read requests it again
+	object.failNextRequests = 1;
+	buffer.resize(10);
+	EXPECT_FALSE(reader.ReadAt(100, 10, &bytesRead, buffer.data()).ok());
+	EXPECT_EQ(bytesRead, 0);
+	ASSERT_TRUE(reader.ReadAt(100, 10, &bytesRead, buffer.data()).ok());
+	expectData(object, 100, buffer);
+}
+
+TEST_F(RangeReaderTest, CachedBlocksAreBounded) {
+	InMemoryObject object(64 * 1024);
+	options.maxCachedBlocks = 2;
+	RangeReader reader(object.fetchFunction(), object.data.size(), ioPool, options);
+
+	std::vector<uint8_t> buffer(10);
+	int64_t bytesRead;
+	for(int64_t block : {0, 1, 2, 0}) {
+		ASSERT_TRUE(reader.ReadAt(block * 1024 + 5, buffer.size(), &bytesRead, buffer.data()).ok());
+		expectData(object, block * 1024 + 5, buffer);
+	}
+
+	// block 0 was the least recently used one when block 2 came in
+	EXPECT_EQ(object.getRequests().size(), 4);
+}
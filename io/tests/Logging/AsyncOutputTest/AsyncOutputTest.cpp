@@ -0,0 +1,189 @@
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "Library/Logging/AsyncOutput.h"
+#include "Library/Logging/BlazingLogger.h"
+#include "Library/Logging/CoutOutput.h"
+#include "Library/Logging/Logger.h"
+#include "Library/Logging/ServiceLogging.h"
+
+using Library::Logging::AsyncOutput;
+using Library::Logging::GenericOutput;
+using Library::Logging::LoggingLevel;
+
+// What an output was asked to write, kept after the asynchronous output that owns it is destroyed
+struct Recorded {
+	std::mutex mutex;
+	std::vector<std::string> lines;
+	int writes = 0;
+
+	std::vector<std::string> getLines() {
+		std::lock_guard<std::mutex> lock(mutex);
+		return lines;
+	}
+};
+
+class RecordingOutput : public GenericOutput {
+public:
+	explicit RecordingOutput(std::shared_ptr<Recorded> recorded) : recorded(recorded) {}
+
+	void flush(std::string && log) override { record(log); }
+
+	void flush(const std::string & log) override { record(log); }
+
+	void flush(
+		const int nodeInd, const std::string & datetime, const std::string & level, const std::string & log) override {
+		record(datetime + "|" + std::to_string(nodeInd) + "|" + level + "|" + log);
+	}
+
+private:
+	void record(const std::string & log) {
+		std::lock_guard<std::mutex> lock(recorded->mutex);
+		recorded->writes++;
+		std::size_t start = 0;
+		for(std::size_t end = log.find('\n'); end != std::string::npos; end = log.find('\n', start)) {
+			recorded->lines.push_back(log.substr(start, end - start));
+			start = end + 1;
+		}
+		recorded->lines.push_back(log.substr(start));
+	}
+
+	std::shared_ptr<Recorded> recorded;
+};
+
+const std::chrono::milliseconds never(std::chrono::hours(1));
+
+TEST(AsyncOutputTest, FormatsLikeTheOtherOutputs) {
+	auto recorded = std::make_shared<Recorded>();
+	AsyncOutput output(new RecordingOutput(recorded), never);
+
+	auto time = std::chrono::system_clock::now();
+	output.flush(3, time, LoggingLevel::WARN, "disk is slow");
+	output.flush("Node index 3");
+	output.sync();
+
+	std::vector<std::string> lines = recorded->getLines();
+	ASSERT_EQ(lines.size(), 2);
+	EXPECT_EQ(lines[0], GenericOutput::formatDatetime(time) + "|3|WARN|disk is slow");
+	EXPECT_EQ(lines[1], "Node index 3");
+}
+
+TEST(AsyncOutputTest, WritesABatchInOrderOfTime) {
+	auto recorded = std::make_shared<Recorded>();
+	AsyncOutput output(new RecordingOutput(recorded), never);
+
+	auto start = std::chrono::system_clock::now();
+	std::thread first([&] { output.flush(0, start + std::chrono::milliseconds(3), LoggingLevel::INFO, "third"); });
+	first.join();
+	std::thread second([&] {
+		output.flush(0, start + std::chrono::milliseconds(1), LoggingLevel::INFO, "first");
+		output.flush(0, start + std::chrono::milliseconds(2), LoggingLevel::INFO, "second");
+	});
+	second.join();
+	output.sync();
+
+	std::vector<std::string> lines = recorded->getLines();
+	ASSERT_EQ(lines.size(), 3);
+	EXPECT_EQ(lines[0].substr(lines[0].rfind('|') + 1), "first");
+	EXPECT_EQ(lines[1].substr(lines[1].rfind('|') + 1), "second");
+	EXPECT_EQ(lines[2].substr(lines[2].rfind('|') + 1), "third");
+	EXPECT_EQ(recorded->writes, 1);
+	EXPECT_EQ(output.getBatchesWritten(), 1);
+}
+
+TEST(AsyncOutputTest, LosesNoMessageOfManyThreads) {
+	const int numThreads = 8;
+	const int messagesPerThread = 5000;
+	auto recorded = std::make_shared<Recorded>();
+	{
+		// small rings so threads wait for the writer
+		AsyncOutput output(new RecordingOutput(recorded), std::chrono::milliseconds(1), 64);
+		std::vector<std::thread> threads;
+		for(int thread = 0; thread < numThreads; thread++) {
+			threads.emplace_back([&output, thread] {
+				for(int i = 0; i < messagesPerThread; i++) {
+					output.flush(thread, std::chrono::system_clock::now(), LoggingLevel::DEBUG, std::to_string(i));
+				}
+			});
+		}
+		for(std::thread & thread : threads) {
+			thread.join();
+		}
+		output.sync();
+		EXPECT_EQ(output.getMessagesWritten(), numThreads * messagesPerThread);
+		EXPECT_LT(output.getBatchesWritten(), numThreads * messagesPerThread);
+	}
+
+	// each thread in the order it logged
+	std::vector<int> next(numThreads, 0);
+	for(const std::string & line : recorded->getLines()) {
+		std::size_t levelEnd = line.rfind('|');
+		std::size_t nodeEnd = line.rfind('|', levelEnd - 1);
+		int thread = std::stoi(line.substr(line.find('|') + 1, nodeEnd - line.find('|') - 1));
+		ASSERT_EQ(std::stoi(line.substr(levelEnd + 1)), next[thread]);
+		next[thread]++;
+	}
+	for(int thread = 0; thread < numThreads; thread++) {
+		EXPECT_EQ(next[thread], messagesPerThread);
+	}
+}
+
+TEST(AsyncOutputTest, WritesFatalMessagesBeforeReturning) {
+	auto recorded = std::make_shared<Recorded>();
+	AsyncOutput output(new RecordingOutput(recorded), never);
+
+	output.flush(0, std::chrono::system_clock::now(), LoggingLevel::INFO, "before");
+	EXPECT_TRUE(recorded->getLines().empty());
+	output.flush(0, std::chrono::system_clock::now(), LoggingLevel::FATAL, "crashing");
+	EXPECT_EQ(recorded->getLines().size(), 2);
+}
+
+TEST(AsyncOutputTest, WritesErrorsWithoutWaitingForTheInterval) {
+	auto recorded = std::make_shared<Recorded>();
+	AsyncOutput output(new RecordingOutput(recorded), never);
+
+	output.flush(0, std::chrono::system_clock::now(), LoggingLevel::ERROR, "failed");
+	for(int i = 0; i < 1000 && recorded->getLines().empty(); i++) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	}
+	EXPECT_EQ(recorded->getLines().size(), 1);
+}
+
+TEST(AsyncOutputTest, WritesWhatIsQueuedWhenDestroyed) {
+	auto recorded = std::make_shared<Recorded>();
+	{
+		AsyncOutput output(new RecordingOutput(recorded), never);
+		output.flush(0, std::chrono::system_clock::now(), LoggingLevel::INFO, "pending");
+	}
+	EXPECT_EQ(recorded->getLines().size(), 1);
+}
+
+TEST(AsyncOutputTest, SkipsLevelsBelowTheMinimum) {
+	auto recorded = std::make_shared<Recorded>();
+	auto output = new AsyncOutput(new RecordingOutput(recorded), never);
+	Library::Logging::ServiceLogging::getInstance().setLogOutput(output);
+
+	Library::Logging::BlazingLogger::setMinimumLevel(LoggingLevel::WARN);
+	EXPECT_FALSE(Library::Logging::BlazingLogger::isEnabled(LoggingLevel::TRACE));
+	EXPECT_FALSE(Library::Logging::BlazingLogger::isEnabled(LoggingLevel::INFO));
+	EXPECT_TRUE(Library::Logging::BlazingLogger::isEnabled(LoggingLevel::WARN));
+	EXPECT_TRUE(Library::Logging::BlazingLogger::isEnabled(LoggingLevel::FATAL));
+	Library::Logging::Logger().logDebug("skipped");
+	Library::Logging::Logger().logInfo("skipped");
+	Library::Logging::Logger().logWarn("written");
+	output->sync();
+
+	Library::Logging::BlazingLogger::setMinimumLevel(LoggingLevel::TRACE);
+	EXPECT_TRUE(Library::Logging::BlazingLogger::isEnabled(LoggingLevel::TRACE));
+	Library::Logging::ServiceLogging::getInstance().setLogOutput(new Library::Logging::CoutOutput());
+
+	std::vector<std::string> lines = recorded->getLines();
+	ASSERT_EQ(lines.size(), 1);
+	EXPECT_NE(lines[0].find("|WARN|written"), std::string::npos);
+}
@@ -0,0 +1,107 @@
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "Library/Metrics/MetricsRegistry.h"
+
+using Library::Metrics::Counter;
+using Library::Metrics::Gauge;
+using Library::Metrics::Histogram;
+using Library::Metrics::MetricsRegistry;
+
+TEST(MetricsRegistryTest, CountsAcrossThreads) {
+	MetricsRegistry registry;
+	const int numThreads = 8;
+	const int increments = 100000;
+
+	std::vector<std::thread> threads;
+	for(int thread = 0; thread < numThreads; thread++) {
+		threads.emplace_back([&registry] {
+			Counter & counter = registry.getCounter("requests_total", "Requests");
+			for(int i = 0; i < increments; i++) {
+				counter.increment();
+			}
+		});
+	}
+	for(std::thread & thread : threads) {
+		thread.join();
+	}
+
+	EXPECT_EQ(registry.getCounter("requests_total", "Requests").get(), numThreads * increments);
+}
+
+TEST(MetricsRegistryTest, KeepsAMetricPerLabels) {
+	MetricsRegistry registry;
+	Gauge & s3 = registry.getGauge("open_files", "Open files", {{"scheme", "s3"}});
+	Gauge & local = registry.getGauge("open_files", "Open files", {{"scheme", "local"}});
+	EXPECT_NE(&s3, &local);
+	EXPECT_EQ(&s3, &registry.getGauge("open_files", "Open files", {{"scheme", "s3"}}));
+
+	s3.add(3);
+	s3.add(-1);
+	local.set(7);
+	EXPECT_EQ(s3.get(), 2);
+	EXPECT_EQ(local.get(), 7);
+}
+
+TEST(MetricsRegistryTest, RejectsANameOfAnotherType) {
+	MetricsRegistry registry;
+	registry.getCounter("bytes", "Bytes");
+	EXPECT_THROW(registry.getGauge("bytes", "Bytes"), std::invalid_argument);
+	EXPECT_THROW(registry.getHistogram("bytes", "Bytes", 1.0), std::invalid_argument);
+}
+
+TEST(MetricsRegistryTest, BucketsHoldTheirValuesWithinAnEighth) {
+	for(uint64_t value = 0; value < 100000; value++) {
+		const int bucket = Histogram::getBucket(value);
+		const uint64_t start = Histogram::getBucketStart(bucket);
+		const uint64_t end = Histogram::getBucketStart(bucket + 1);
+		ASSERT_LE(start, value);
+		ASSERT_LT(value, end);
+		ASSERT_LE(end - start, std::max<uint64_t>(start / Histogram::NUM_SUB_BUCKETS, 1));
+	}
+	EXPECT_EQ(Histogram::getBucket(UINT64_MAX), Histogram::NUM_BUCKETS - 1);
+	EXPECT_EQ(Histogram::getBucket(uint64_t(1) << 40), Histogram::getBucket((uint64_t(1) << 40) - 1) + 1);
+}
+
+TEST(MetricsRegistryTest, EstimatesQuantiles) {
+	Histogram histogram(1e-6);
+	for(uint64_t value = 1; value <= 10000; value++) {
+		histogram.record(value);
+	}
+
+	EXPECT_EQ(histogram.getCount(), 10000);
+	EXPECT_EQ(histogram.getSum(), 10000 * 10001 / 2);
+	EXPECT_NEAR(histogram.getValueAtQuantile(0.5), 5000, 5000 / 8);
+	EXPECT_NEAR(histogram.getValueAtQuantile(0.99), 9900, 9900 / 8);
+	EXPECT_EQ(histogram.getCountBelow(1024), 1023);
+	EXPECT_EQ(Histogram().getValueAtQuantile(0.5), 0);
+}
+
+TEST(MetricsRegistryTest, ExportsThePrometheusTextFormat) {
+	MetricsRegistry registry;
+	registry.getCounter("blazing_sent_bytes_total", "Bytes sent", {{"node", "a\"b"}}).increment(42);
+	registry.getGauge("blazing_result_sets", "Results held").set(-2);
+	Histogram & latency = registry.getHistogram("blazing_wait_seconds", "Time waited", 1e-6, {{"scheme", "s3"}});
+	latency.record(3);
+	latency.record(1500);
+
+	const std::string text = registry.toPrometheusText();
+	EXPECT_NE(text.find("# HELP blazing_sent_bytes_total Bytes sent\n# TYPE blazing_sent_bytes_total counter\n"
+						"blazing_sent_bytes_total{node=\"a\\\"b\"} 42\n"),
+		std::string::npos);
+	EXPECT_NE(text.find("# TYPE blazing_result_sets gauge\nblazing_result_sets -2\n"), std::string::npos);
+	EXPECT_NE(text.find("# TYPE blazing_wait_seconds histogram\n"), std::string::npos);
+	EXPECT_NE(text.find("blazing_wait_seconds_bucket{scheme=\"s3\",le=\"2e-06\"} 0\n"), std::string::npos);
+	EXPECT_NE(text.find("blazing_wait_seconds_bucket{scheme=\"s3\",le=\"4e-06\"} 1\n"), std::string::npos);
+	EXPECT_NE(text.find("blazing_wait_seconds_bucket{scheme=\"s3\",le=\"0.002048\"} 2\n"), std::string::npos);
+	EXPECT_NE(text.find("blazing_wait_seconds_bucket{scheme=\"s3\",le=\"+Inf\"} 2\n"), std::string::npos);
+	EXPECT_NE(text.find("blazing_wait_seconds_sum{scheme=\"s3\"} 0.001503\n"), std::string::npos);
+	EXPECT_NE(text.find("blazing_wait_seconds_count{scheme=\"s3\"} 2\n"), std::string::npos);
+
+	// families in order of name
+	EXPECT_LT(text.find("blazing_result_sets"), text.find("blazing_sent_bytes_total"));
+	EXPECT_LT(text.find("blazing_sent_bytes_total"), text.find("blazing_wait_seconds"));
+}
@@ -0,0 +1,101 @@
+#include <arpa/inet.h>
+#include <atomic>
+#include <cstring>
+#include <netinet/in.h>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+#include "gtest/gtest.h"
+
+#include "Library/Metrics/MetricsServer.h"
+
+using Library::Metrics::MetricsRegistry;
+using Library::Metrics::MetricsServer;
+
+// sends the request to the server on loopback and returns the whole response
+std::string scrape(unsigned short port, const std::string & request) {
+	int connection = socket(AF_INET, SOCK_STREAM, 0);
+	sockaddr_in address;
+	std::memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_port = htons(port);
+	inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+	if(connect(connection, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0) {
+		close(connection);
+		return "";
+	}
+
+	send(connection, request.data(), request.size(), MSG_NOSIGNAL);
+	std::string response;
+	char buffer[4096];
+	ssize_t received;
+	while((received = recv(connection, buffer, sizeof(buffer), 0)) > 0) {
+		response.append(buffer, received);
+	}
+	close(connection);
+	return response;
+}
+
+std::string getBody(const std::string & response) { return response.substr(response.find("\r\n\r\n") + 4); }
+
+const std::string GET_METRICS = "GET /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n";
+
+TEST(MetricsServerTest, ServesTheMetricsOnLoopback) {
+	MetricsRegistry registry;
+	registry.getCounter("blazing_files_parsed_total", "Files parsed").increment(5);
+	MetricsServer server(registry, 0);
+	ASSERT_NE(server.getPort(), 0);
+
+	const std::string response = scrape(server.getPort(), GET_METRICS);
+	EXPECT_EQ(response.compare(0, 15, "HTTP/1.1 200 OK"), 0);
+	EXPECT_NE(response.find("Content-Type: text/plain; version=0.0.4"), std::string::npos);
+	EXPECT_EQ(getBody(response), registry.toPrometheusText());
+	EXPECT_NE(getBody(response).find("blazing_files_parsed_total 5\n"), std::string::npos);
+}
+
+TEST(MetricsServerTest, AnswersOtherRequestsWithAnError) {
+	MetricsRegistry registry;
+	MetricsServer server(registry, 0);
+
+	EXPECT_EQ(scrape(server.getPort(), "GET / HTTP/1.1\r\n\r\n").compare(0, 22, "HTTP/1.1 404 Not Found"), 0);
+	EXPECT_EQ(scrape(server.getPort(), "POST /metrics HTTP/1.1\r\n\r\n").compare(0, 12, "HTTP/1.1 405"), 0);
+	// still serving
+	EXPECT_EQ(scrape(server.getPort(), GET_METRICS).compare(0, 15, "HTTP/1.1 200 OK"), 0);
+}
+
+TEST(MetricsServerTest, ScrapesWhileTheMetricsChange) {
+	MetricsRegistry registry;
+	MetricsServer server(registry, 0);
+	std::atomic<bool> done{false};
+	std::thread writer([&] {
+		Library::Metrics::Counter & counter = registry.getCounter("blazing_bytes_total", "Bytes");
+		Library::Metrics::Histogram & histogram = registry.getHistogram("blazing_read_seconds", "Reads", 1e-6);
+		for(uint64_t i = 0; !done; i++) {
+			counter.increment(10);
+			histogram.record(i % 5000);
+		}
+	});
+
+	uint64_t last = 0;
+	for(int i = 0; i < 20; i++) {
+		const std::string body = getBody(scrape(server.getPort(), GET_METRICS));
+		const size_t sample = body.find("\nblazing_bytes_total ");
+		if(sample == std::string::npos) {
+			continue;  // not registered yet
+		}
+		const uint64_t value = std::stoull(body.substr(sample + 21));
+		EXPECT_GE(value, last);
+		last = value;
+	}
+	done = true;
+	writer.join();
+	EXPECT_GT(last, 0);
+}
+
+TEST(MetricsServerTest, FailsWhenThePortIsTaken) {
+	MetricsRegistry registry;
+	MetricsServer server(registry, 0);
+	EXPECT_THROW(MetricsServer(registry, server.getPort()), std::runtime_error);
+}
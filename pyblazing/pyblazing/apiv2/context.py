@@ -286,7 +286,7 @@ class BlazingTable(object):
         # metadata, this is computed in create table, after call get_metadata
         self.metadata = metadata 
         # row_groups_ids, vector<vector<int>> one vector of row_groups per file
-        self.row_groups_id = []
+        self.row_groups_ids = []
         # a pair of values with the startIndex and batchSize info for each slice
         self.offset = (0,0)
 
@@ -331,6 +331,8 @@ class BlazingTable(object):
             for i in range(0, numSlices):
                 nodeFilesList.append(BlazingTable(self.input, self.fileType))
             return nodeFilesList
+        if self.fileType == DataType.CSV and self.num_row_groups is not None and len(self.files) < numSlices:
+            return self.getRowGroupSlices(numSlices)
         remaining = len(self.files)
         startIndex = 0
         for i in range(0, numSlices):
@@ -349,6 +351,7 @@ class BlazingTable(object):
                 bt = BlazingTable(self.input,
                                                   self.fileType,
                                                   files=tempFiles,
+                                                  datasource=self.datasource,
                                                   calcite_to_file_indices=self.calcite_to_file_indices,
                                                   num_row_groups=self.num_row_groups[startIndex: startIndex + batchSize],
                                                   uri_values=uri_values,
@@ -361,6 +364,7 @@ class BlazingTable(object):
                         self.input,
                         self.fileType,
                         files=tempFiles,
+                        datasource=self.datasource,
                         calcite_to_file_indices=self.calcite_to_file_indices,
                         uri_values=uri_values,
                         args=self.args,
@@ -371,6 +375,39 @@ class BlazingTable(object):
             remaining = remaining - batchSize
         return nodeFilesList 
 
+    def getRowGroupSlices(self, numSlices):
+        # fewer csv files than nodes are split by their byte ranges, the row groups of a csv, so every node parses some
+        row_groups = [(file_index, row_group)
+                      for file_index in range(len(self.files))
+                      for row_group in range(self.num_row_groups[file_index])]
+        nodeFilesList = []
+        remaining = len(row_groups)
+        startIndex = 0
+        for i in range(0, numSlices):
+            batchSize = int(remaining / (numSlices - i))
+            slice_row_groups = row_groups[startIndex: startIndex + batchSize]
+            file_indices = sorted(set(file_index for file_index, _ in slice_row_groups))
+
+            bt = BlazingTable(
+                    self.input,
+                    self.fileType,
+                    files=[self.files[file_index] for file_index in file_indices],
+                    datasource=self.datasource,
+                    calcite_to_file_indices=self.calcite_to_file_indices,
+                    num_row_groups=[self.num_row_groups[file_index] for file_index in file_indices],
+                    uri_values=[self.uri_values[file_index] for file_index in file_indices
+                                if file_index < len(self.uri_values)],
+                    args=self.args,
+                    metadata=self.metadata)
+            bt.row_groups_ids = [[row_group for slice_file_index, row_group in slice_row_groups
+                                  if slice_file_index == file_index] for file_index in file_indices]
+            if len(file_indices) > 0:
+                bt.offset = (file_indices[0], len(file_indices))
+            nodeFilesList.append(bt)
+            startIndex = startIndex + batchSize
+            remaining = remaining - batchSize
+        return nodeFilesList
+
     def get_partitions(self, worker):
         return self.dask_mapping[worker]
 